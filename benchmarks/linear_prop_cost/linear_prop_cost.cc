@@ -7,7 +7,12 @@
 //   (time(copies) - time(1)) / (props(copies) - props(1))
 // is the marginal cost of one constraint's propagation: its coarse wake plus one
 // sweep. Select the sweep path with GCS_LINEAR_INCREMENTAL_THRESHOLD (0 =
-// incremental/folded, a huge value = stateless).
+// incremental/folded, a huge value = stateless), and turn the vectorised sum
+// and slack kernels off with a huge GCS_LINEAR_KERNEL_MIN_TERMS.
+//
+// `--lens 16,64,256,1024` runs once per constraint length instead, and prints
+// the time per propagation for each, so running it with and without the
+// kernels shows where they start to pay for themselves.
 
 #include <gcs/gcs.hh>
 
@@ -35,6 +40,35 @@ using std::println;
 using fmt::println;
 #endif
 
+namespace
+{
+    struct Result
+    {
+        unsigned long long recursions, propagations;
+        double wall;
+    };
+
+    auto run(int n, int d, int len, int copies, int bn, int bd, long long cap) -> Result
+    {
+        Problem p;
+        auto vars = p.create_integer_variable_vector(static_cast<size_t>(n), 0_i, Integer{d});
+        WeightedSum base;
+        for (int i = 0; i < len; ++i)
+            base += 1_i * vars[i];
+        Integer budget{static_cast<long long>(len) * d * bn / bd};
+        for (int k = 0; k < copies; ++k)
+            p.post(LinearLessThanEqual{WeightedSum{base}, budget});
+
+        long long sols = 0;
+        auto start = std::chrono::steady_clock::now();
+        auto stats = solve_with(p,
+            SolveCallbacks{.solution = [&](const CurrentState &) -> bool { return ++sols < cap; },
+                .branch = branch_with(variable_order::in_order(vars), value_order::smallest_first())});
+        auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        return Result{stats.recursions, stats.propagations, elapsed};
+    }
+}
+
 auto main(int argc, char * argv[]) -> int
 {
     cxxopts::Options options("linear_prop_cost", "Per-propagation cost of a single linear <= constraint");
@@ -46,6 +80,7 @@ auto main(int argc, char * argv[]) -> int
         ("budget-num", "Budget numerator", cxxopts::value<int>()->default_value("70"))                 //
         ("budget-den", "Budget denominator", cxxopts::value<int>()->default_value("100"))              //
         ("cap", "Stop after this many solutions", cxxopts::value<long long>()->default_value("50000")) //
+        ("lens", "One run per length, as both --len and --vars", cxxopts::value<vector<int>>())        //
         ("help", "Display help");
     auto o = options.parse(argc, argv);
     if (o.contains("help")) {
@@ -55,25 +90,18 @@ auto main(int argc, char * argv[]) -> int
     int n = o["vars"].as<int>(), d = o["domain"].as<int>(), len = o["len"].as<int>(), copies = o["copies"].as<int>();
     int bn = o["budget-num"].as<int>(), bd = o["budget-den"].as<int>();
     long long cap = o["cap"].as<long long>();
+    if (o.contains("lens")) {
+        for (auto l : o["lens"].as<vector<int>>()) {
+            auto r = run(l, d, l, copies, bn, bd, cap);
+            println("len={} copies={} recursions={} propagations={} wall={:.4f}s ns_per_propagation={:.1f}", l, copies, r.recursions,
+                r.propagations, r.wall, r.propagations ? 1e9 * r.wall / r.propagations : 0.0);
+        }
+        return EXIT_SUCCESS;
+    }
+
     if (len > n)
         len = n;
-
-    Problem p;
-    auto vars = p.create_integer_variable_vector(static_cast<size_t>(n), 0_i, Integer{d});
-    WeightedSum base;
-    for (int i = 0; i < len; ++i)
-        base += 1_i * vars[i];
-    Integer budget{static_cast<long long>(len) * d * bn / bd};
-    for (int k = 0; k < copies; ++k)
-        p.post(LinearLessThanEqual{WeightedSum{base}, budget});
-
-    long long sols = 0;
-    auto start = std::chrono::steady_clock::now();
-    auto stats = solve_with(p,
-        SolveCallbacks{.solution = [&](const CurrentState &) -> bool { return ++sols < cap; },
-            .branch = branch_with(variable_order::in_order(vars), value_order::smallest_first())});
-    auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
-
-    println("len={} copies={} recursions={} propagations={} wall={:.4f}s", len, copies, stats.recursions, stats.propagations, elapsed);
+    auto r = run(n, d, len, copies, bn, bd, cap);
+    println("len={} copies={} recursions={} propagations={} wall={:.4f}s", len, copies, r.recursions, r.propagations, r.wall);
     return EXIT_SUCCESS;
 }
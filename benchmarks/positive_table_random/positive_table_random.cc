@@ -6,6 +6,7 @@
 #include <cstdlib>
 #include <optional>
 #include <random>
+#include <string>
 #include <vector>
 
 #include <version>
@@ -23,6 +24,7 @@ using namespace gcs;
 using std::mt19937;
 using std::nullopt;
 using std::optional;
+using std::string;
 using std::uniform_int_distribution;
 using std::vector;
 
@@ -38,6 +40,8 @@ using fmt::println;
 // each of the d*d value pairs independently with probability `tightness`. Fixed
 // (deterministic) search, so the search tree is identical regardless of how the
 // propagator is triggered -- the interesting number is solve time / time-per-node.
+// --algorithm picks the Table propagator, and a large --domain gives large
+// tables (each has about (1 - tightness) * domain^2 tuples) for comparing them.
 auto main(int argc, char * argv[]) -> int
 {
     cxxopts::Options options("positive_table_random", "Random allowed-tuple (Table) benchmark");
@@ -47,6 +51,7 @@ auto main(int argc, char * argv[]) -> int
         ("constraints", "Number of binary allowed-tuple tables", cxxopts::value<int>()->default_value("180"))                           //
         ("tightness", "Probability each value pair is forbidden (allowed = 1 - this)", cxxopts::value<double>()->default_value("0.34")) //
         ("seed", "Random seed", cxxopts::value<unsigned>()->default_value("1"))                                                         //
+        ("algorithm", "Table propagator: scan or compact", cxxopts::value<string>()->default_value("scan"))                             //
         ("first", "Stop at the first solution instead of enumerating all")                                                              //
         ("timeout", "Timeout in seconds (0 = none)", cxxopts::value<double>()->default_value("0"))                                      //
         ("help", "Display help");
@@ -63,6 +68,16 @@ auto main(int argc, char * argv[]) -> int
     auto seed = options_vars["seed"].as<unsigned>();
     auto first_only = options_vars.contains("first");
 
+    TableAlgorithm algorithm;
+    if (options_vars["algorithm"].as<string>() == "scan")
+        algorithm = table::Scan{};
+    else if (options_vars["algorithm"].as<string>() == "compact")
+        algorithm = table::CompactTable{};
+    else {
+        println("unknown --algorithm {}", options_vars["algorithm"].as<string>());
+        return EXIT_FAILURE;
+    }
+
     mt19937 rng(seed);
     uniform_int_distribution<int> pick_var(0, n - 1);
     std::uniform_real_distribution<double> unit(0.0, 1.0);
@@ -82,7 +97,7 @@ auto main(int argc, char * argv[]) -> int
             for (int v = 0; v < d; ++v)
                 if (unit(rng) >= tightness)
                     allowed.push_back({Integer{u}, Integer{v}});
-        p.post(Table{{vars[a], vars[b]}, move(allowed)});
+        p.post(Table{{vars[a], vars[b]}, move(allowed)}.with_algorithm(algorithm));
     }
 
     unsigned long long solutions = 0;
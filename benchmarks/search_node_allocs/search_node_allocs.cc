@@ -0,0 +1,119 @@
+// Count the heap allocations made per search node, on the n-queens model from
+// minicp_benchmarks/n_queens.
+//
+// Replacing the global operator new lets us count every allocation the
+// program makes. Counting is switched on only around the solve, and the
+// setup that solve_with() does before search begins (creating the state and
+// the propagators) is counted separately, by stopping at the first node, so
+// that what is left is what search itself costs. The branching heuristics'
+// coroutine frames come from the search arena rather than from the heap, so
+// the allocations it served are reported too.
+
+#include <gcs/constraints/equals.hh>
+#include <gcs/problem.hh>
+#include <gcs/search_heuristics.hh>
+#include <gcs/solve.hh>
+
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <string>
+
+#include <version>
+#if defined(__cpp_lib_print) && defined(__cpp_lib_format)
+#include <print>
+#else
+#include <fmt/core.h>
+#endif
+
+#include <cxxopts.hpp>
+
+using namespace gcs;
+
+using std::size_t;
+using std::string;
+
+#if defined(__cpp_lib_print) && defined(__cpp_lib_format)
+using std::println;
+#else
+using fmt::println;
+#endif
+
+namespace
+{
+    bool counting = false;
+    unsigned long long allocations = 0;
+}
+
+auto operator new(size_t size) -> void *
+{
+    if (counting)
+        ++allocations;
+    if (auto result = std::malloc(size ? size : 1))
+        return result;
+    throw std::bad_alloc{};
+}
+
+auto operator delete(void * p) noexcept -> void
+{
+    std::free(p);
+}
+
+auto operator delete(void * p, size_t) noexcept -> void
+{
+    std::free(p);
+}
+
+namespace
+{
+    auto solve_queens(int size, bool all, bool stop_at_first_node) -> Stats
+    {
+        Problem p;
+        auto queens = p.create_integer_variable_vector(size, 0_i, Integer{size - 1}, "queen");
+        for (int i = 0; i < size; ++i)
+            for (int j = i + 1; j < size; ++j) {
+                p.post(NotEquals{queens[i], queens[j]});
+                p.post(NotEquals{queens[i] + Integer{j - i}, queens[j]});
+                p.post(NotEquals{queens[i] + -Integer{j - i}, queens[j]});
+            }
+
+        counting = true;
+        auto stats = solve_with(p,
+            SolveCallbacks{.solution = [&](const CurrentState &) -> bool { return all; },
+                .trace = [&](const CurrentState &) -> bool { return ! stop_at_first_node; },
+                .branch = branch_with(variable_order::dom(queens), value_order::smallest_in())});
+        counting = false;
+        return stats;
+    }
+}
+
+auto main(int argc, char * argv[]) -> int
+{
+    cxxopts::Options options("search_node_allocs", "Heap allocations made per search node");
+    options.add_options()                                                                    //
+        ("size", "Number of queens", cxxopts::value<int>()->default_value("28"))             //
+        ("all", "Find all solutions, rather than stopping at the first")                     //
+        ("help", "Display help");
+    auto o = options.parse(argc, argv);
+    if (o.contains("help")) {
+        println("{}", options.help());
+        return EXIT_SUCCESS;
+    }
+
+    int size = o["size"].as<int>();
+    bool all = o.contains("all");
+
+    allocations = 0;
+    (void)solve_queens(size, all, true);
+    auto setup = allocations;
+
+    allocations = 0;
+    auto stats = solve_queens(size, all, false);
+    auto search = allocations > setup ? allocations - setup : 0;
+
+    println("n_queens size={} recursions={} solutions={}", size, stats.recursions, stats.solutions);
+    println("  allocations before search={} during search={} per recursion={:.4f}", setup, search,
+        stats.recursions ? static_cast<double>(search) / static_cast<double>(stats.recursions) : 0.0);
+    println("  search arena allocations={} from the heap={}", stats.search_arena_allocations, stats.search_arena_heap_allocations);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,274 @@
+// Count the heap allocations made by iterating over a variable's values, and
+// by each propagation of the extensional (Table) propagator, which iterates
+// over values in its inner loops.
+//
+// Replacing the global operator new lets us count every allocation the
+// program makes, and counting is switched on only around the code being
+// measured. The first part walks domains of a few shapes through each way
+// State offers of iterating over values. A snapshot (each_value_mutable())
+// only allocates once a domain has more holes than IntervalSet keeps inline,
+// so the number of holes is a parameter. The second part solves a random
+// binary CSP made of tables, installed through the same propagate_extensional()
+// call that Table uses, and reports allocations per propagation. Each
+// selector has values knocked out of the middle of its domain before search,
+// so that it has more holes than IntervalSet keeps inline from the start, as
+// it would after a while on a real instance. Apart from the first call, which
+// sets up the residues, and any call whose scratch has to grow, allocations
+// per propagation should be zero.
+
+#include <gcs/gcs.hh>
+
+#include <gcs/constraint.hh>
+#include <gcs/constraints/equals/equals.hh>
+#include <gcs/constraints/extensional_utils.hh>
+#include <gcs/innards/inference_tracker.hh>
+#include <gcs/innards/propagators.hh>
+#include <gcs/innards/state.hh>
+
+#include <cstddef>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <version>
+#if defined(__cpp_lib_print) && defined(__cpp_lib_format)
+#include <print>
+#else
+#include <fmt/core.h>
+#endif
+
+#include <cxxopts.hpp>
+
+using namespace gcs;
+using namespace gcs::innards;
+
+using std::make_shared;
+using std::make_unique;
+using std::move;
+using std::mt19937;
+using std::shared_ptr;
+using std::size_t;
+using std::string;
+using std::uniform_real_distribution;
+using std::unique_ptr;
+using std::vector;
+
+#if defined(__cpp_lib_print) && defined(__cpp_lib_format)
+using std::println;
+#else
+using fmt::println;
+#endif
+
+namespace
+{
+    bool counting = false;
+    unsigned long long allocations = 0;
+}
+
+auto operator new(size_t size) -> void *
+{
+    if (counting)
+        ++allocations;
+    if (auto result = std::malloc(size ? size : 1))
+        return result;
+    throw std::bad_alloc{};
+}
+
+auto operator delete(void * p) noexcept -> void
+{
+    std::free(p);
+}
+
+auto operator delete(void * p, size_t) noexcept -> void
+{
+    std::free(p);
+}
+
+namespace
+{
+    // Runs f with allocation counting switched on, and returns how many
+    // allocations it made.
+    template <typename F_>
+    auto allocations_made_by(F_ && f) -> unsigned long long
+    {
+        auto before = allocations;
+        counting = true;
+        try {
+            f();
+        }
+        catch (...) {
+            counting = false;
+            throw;
+        }
+        counting = false;
+        return allocations - before;
+    }
+
+    struct Counts
+    {
+        unsigned long long calls = 0, allocations = 0;
+    };
+
+    class CountedTable : public Constraint
+    {
+        IntegerVariableID _selector;
+        vector<IntegerVariableID> _vars;
+        SimpleTuples _tuples;
+        shared_ptr<Counts> _counts;
+
+    public:
+        CountedTable(IntegerVariableID selector, vector<IntegerVariableID> vars, SimpleTuples tuples, shared_ptr<Counts> counts) :
+            _selector(selector),
+            _vars(move(vars)),
+            _tuples(move(tuples)),
+            _counts(move(counts))
+        {
+        }
+
+        auto clone() const -> unique_ptr<Constraint> override
+        {
+            return make_unique<CountedTable>(_selector, _vars, _tuples, _counts);
+        }
+
+        auto constraint_type() const -> string override
+        {
+            return "counted_table";
+        }
+
+        auto s_expr(const ProofModel * const) const -> SExpr override
+        {
+            return SExpr::atom("counted_table");
+        }
+
+        auto install_propagators(Propagators & propagators) -> void override
+        {
+            Triggers triggers;
+            for (auto & v : _vars)
+                triggers.on_change.push_back(v);
+            triggers.on_change.push_back(_selector);
+
+            propagators.install(
+                constraint_id(),
+                [table = ExtensionalData{_selector, move(_vars), ArrayParam<SimpleTuples>{move(_tuples)}}, counts = _counts](
+                    const State & state, auto & inference, ProofLogger * const logger, const DomainDelta & delta) -> PropagatorState {
+                    auto result = PropagatorState::Enable;
+                    ++counts->calls;
+                    // A call that ends in a contradiction throws, and isn't
+                    // counted, since the exception is what it allocates.
+                    counts->allocations += allocations_made_by(
+                        [&]() { result = propagate_extensional(table, state, inference, logger, delta, NoHint{}); });
+                    return result;
+                },
+                triggers);
+        }
+    };
+
+    auto iteration_allocations(int domain, int holes, int repeats) -> void
+    {
+        State state;
+        auto x = state.allocate_integer_variable_with_state(0_i, Integer{domain - 1});
+        for (int h = 0; h < holes; ++h)
+            (void)state.infer_not_equal(x, Integer{(h + 1) * domain / (holes + 1)});
+        IntegerVariableID plain{x}, negated = -IntegerVariableID{x} + 3_i;
+
+        long long sink = 0;
+        auto report = [&](const string & what, auto && iterate) {
+            auto made = allocations_made_by([&]() {
+                for (int r = 0; r < repeats; ++r)
+                    iterate();
+            });
+            println("  {:<48} allocations per call={:.3f}", what, static_cast<double>(made) / repeats);
+        };
+
+        println("domain 0..{} with {} holes:", domain - 1, holes);
+        for (auto & [name, var] : vector<std::pair<string, IntegerVariableID>>{{"plain", plain}, {"negated view", negated}}) {
+            report(name + " each_value_immutable()", [&]() {
+                for (auto v : state.each_value_immutable(var))
+                    sink += v.raw_value;
+            });
+            report(name + " each_value_mutable()", [&]() {
+                for (auto v : state.each_value_mutable(var))
+                    sink += v.raw_value;
+            });
+            report(name + " for_each_value_immutable()", [&]() { state.for_each_value_immutable(var, [&](Integer v) { sink += v.raw_value; }); });
+            report(name + " for_each_value_reversed_immutable()",
+                [&]() { state.for_each_value_reversed_immutable(var, [&](Integer v) { sink += v.raw_value; }); });
+            report(name + " for_each_interval_immutable()",
+                [&]() { state.for_each_interval_immutable(var, [&](Integer l, Integer u) { sink += (u - l).raw_value; }); });
+        }
+        println("  (sum of the values seen, so that none of the loops is optimised away: {})", sink);
+    }
+
+    auto solve_tables(int n, int d, int constraints, double tightness, int selector_holes, unsigned seed, long long cap) -> void
+    {
+        mt19937 rand(seed);
+        uniform_real_distribution<double> coin(0.0, 1.0);
+
+        auto counts = make_shared<Counts>();
+        Problem p;
+        auto vars = p.create_integer_variable_vector(static_cast<size_t>(n), 0_i, Integer{d - 1});
+        for (int c = 0; c < constraints; ++c) {
+            auto a = static_cast<size_t>(rand() % n), b = static_cast<size_t>(rand() % (n - 1));
+            if (b >= a)
+                ++b;
+            SimpleTuples tuples;
+            for (int i = 0; i < d; ++i)
+                for (int j = 0; j < d; ++j)
+                    if (coin(rand) >= tightness)
+                        tuples.push_back({Integer{i}, Integer{j}});
+            if (tuples.empty())
+                continue;
+            auto size = static_cast<long long>(tuples.size());
+            auto selector = p.create_integer_variable(0_i, Integer{size - 1});
+            // Evenly spaced interior values, so that each one makes a hole.
+            for (int h = 0; h < selector_holes; ++h)
+                if (auto k = (h + 1) * size / (selector_holes + 1); k > 0 && k < size - 1)
+                    p.post(NotEquals{selector, constant_variable(Integer{k})});
+            p.post(CountedTable{selector, {vars[a], vars[b]}, move(tuples), counts});
+        }
+
+        long long sols = 0;
+        auto stats = solve_with(p,
+            SolveCallbacks{.solution = [&](const CurrentState &) -> bool { return ++sols < cap; },
+                .branch = branch_with(variable_order::in_order(vars), value_order::smallest_first())});
+
+        println("tables: vars={} domain=0..{} constraints={} tightness={} selector holes={} seed={}", n, d - 1, constraints, tightness,
+            selector_holes, seed);
+        println("  recursions={} solutions={} propagations={}", stats.recursions, stats.solutions, counts->calls);
+        println("  allocations={} allocations per propagation={:.4f}", counts->allocations,
+            counts->calls ? static_cast<double>(counts->allocations) / static_cast<double>(counts->calls) : 0.0);
+    }
+}
+
+auto main(int argc, char * argv[]) -> int
+{
+    cxxopts::Options options("value_iteration_allocs", "Heap allocations made by value iteration and by table propagation");
+    options.add_options()                                                                                                  //
+        ("domain", "Domain size for the iteration part", cxxopts::value<int>()->default_value("100"))                      //
+        ("repeats", "Iterations per measurement", cxxopts::value<int>()->default_value("1000"))                            //
+        ("vars", "Number of variables for the table part", cxxopts::value<int>()->default_value("16"))                     //
+        ("table-domain", "Domain size for the table part", cxxopts::value<int>()->default_value("8"))                      //
+        ("constraints", "Number of binary tables", cxxopts::value<int>()->default_value("60"))                             //
+        ("tightness", "Probability each value pair is forbidden", cxxopts::value<double>()->default_value("0.4"))          //
+        ("selector-holes", "Values to knock out of each selector", cxxopts::value<int>()->default_value("4"))              //
+        ("seed", "Random seed", cxxopts::value<unsigned>()->default_value("1"))                                            //
+        ("cap", "Stop after this many solutions", cxxopts::value<long long>()->default_value("10000"))                     //
+        ("help", "Display help");
+    auto o = options.parse(argc, argv);
+    if (o.contains("help")) {
+        println("{}", options.help());
+        return EXIT_SUCCESS;
+    }
+
+    int domain = o["domain"].as<int>(), repeats = o["repeats"].as<int>();
+    for (int holes : {0, 1, 4})
+        iteration_allocations(domain, holes, repeats);
+
+    solve_tables(o["vars"].as<int>(), o["table-domain"].as<int>(), o["constraints"].as<int>(), o["tightness"].as<double>(),
+        o["selector-holes"].as<int>(), o["seed"].as<unsigned>(), o["cap"].as<long long>());
+    return EXIT_SUCCESS;
+}
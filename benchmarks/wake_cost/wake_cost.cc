@@ -10,6 +10,18 @@
 // divided by the wake count is the amortised end-to-end cost of one wake: the
 // requeue scan, the firing bookkeeping, the propagator dispatch, and -- for
 // refined -- the watch-index edit and its backtrack replay.
+//
+// Two more coarse runs spread the observers over every PropagatorCost, once
+// with the queue ordering woken propagators by cost and once with it plain
+// first-in first-out. The wakes are the same in both, so the difference in
+// time over the wake count is what ordering by cost adds to each dispatch.
+//
+// A last coarse run adds a counter variable, which the observers also watch,
+// and a propagator that walks the counter's upper bound down one step at a
+// time, several steps per wake. The counter never constrains the pool, so the
+// tree is unchanged, but every wake of that propagator makes several
+// inferences on one variable, which is the case folding a run's inferences
+// into one batch of events per variable is for.
 
 #include <gcs/gcs.hh>
 
@@ -62,15 +74,20 @@ namespace
         vector<IntegerVariableID> _vars;
         Mode _mode;
         shared_ptr<long long> _wakes;
+        PropagatorCost _cost;
 
     public:
-        Observer(vector<IntegerVariableID> vars, Mode mode, shared_ptr<long long> wakes) : _vars(move(vars)), _mode(mode), _wakes(move(wakes))
+        Observer(vector<IntegerVariableID> vars, Mode mode, shared_ptr<long long> wakes, PropagatorCost cost) :
+            _vars(move(vars)),
+            _mode(mode),
+            _wakes(move(wakes)),
+            _cost(cost)
         {
         }
 
         auto clone() const -> std::unique_ptr<Constraint> override
         {
-            return std::make_unique<Observer>(_vars, _mode, _wakes);
+            return std::make_unique<Observer>(_vars, _mode, _wakes, _cost);
         }
 
         auto constraint_type() const -> std::string override
@@ -96,7 +113,7 @@ namespace
                         ++*wakes;
                         return PropagatorState::Enable;
                     },
-                    triggers);
+                    triggers, _cost);
             }
             else {
                 Triggers triggers;
@@ -134,24 +151,86 @@ namespace
                         }
                         return PropagatorState::Enable;
                     },
-                    triggers);
+                    triggers, _cost);
             }
         }
     };
 
-    auto run(int n, int d, int m, long long cap, Mode mode) -> std::tuple<double, unsigned long long, long long>
+    // Keeps counter <= steps * (the number of unfixed vars), lowering the
+    // bound one step per inference.
+    class Narrower : public Constraint
+    {
+        vector<IntegerVariableID> _vars;
+        IntegerVariableID _counter;
+        int _steps;
+
+    public:
+        Narrower(vector<IntegerVariableID> vars, IntegerVariableID counter, int steps) :
+            _vars(move(vars)),
+            _counter(counter),
+            _steps(steps)
+        {
+        }
+
+        auto clone() const -> std::unique_ptr<Constraint> override
+        {
+            return std::make_unique<Narrower>(_vars, _counter, _steps);
+        }
+
+        auto constraint_type() const -> std::string override
+        {
+            return "narrower";
+        }
+
+        auto s_expr(const ProofModel * const) const -> SExpr override
+        {
+            return SExpr::atom("narrower");
+        }
+
+        auto install_propagators(Propagators & propagators) -> void override
+        {
+            Triggers triggers;
+            for (const auto & v : _vars)
+                triggers.on_instantiated.push_back(v);
+            propagators.install(
+                constraint_id(),
+                [vars = _vars, counter = _counter, steps = _steps](
+                    const State & state, auto & inference, ProofLogger * const logger) -> PropagatorState {
+                    long long unfixed = 0;
+                    for (const auto & v : vars)
+                        unfixed += ! state.has_single_value(v);
+                    auto target = Integer{steps * unfixed};
+                    for (auto upper = state.upper_bound(counter); upper > target; upper = state.upper_bound(counter))
+                        inference.infer(logger, counter < upper, NoJustificationNeeded{}, NoReason{});
+                    return PropagatorState::Enable;
+                },
+                triggers);
+        }
+    };
+
+    auto run(int n, int d, int m, long long cap, Mode mode, bool spread_costs = false, bool order_by_cost = true, int narrowing_steps = 0)
+        -> std::tuple<double, unsigned long long, long long>
     {
         auto wakes = make_shared<long long>(0);
         Problem p;
         auto vars = p.create_integer_variable_vector(static_cast<size_t>(n), 0_i, Integer{d});
+        vector<IntegerVariableID> observed(vars.begin(), vars.end());
+        if (0 != narrowing_steps) {
+            auto counter = p.create_integer_variable(0_i, Integer{static_cast<long long>(narrowing_steps) * n});
+            observed.push_back(counter);
+            p.post(Narrower{vector<IntegerVariableID>(vars.begin(), vars.end()), counter, narrowing_steps});
+        }
         if (mode != Mode::None)
-            for (int k = 0; k < m; ++k)
-                p.post(Observer{vector<IntegerVariableID>(vars.begin(), vars.end()), mode, wakes});
+            for (int k = 0; k < m; ++k) {
+                auto cost = spread_costs ? static_cast<PropagatorCost>(k % number_of_propagator_costs) : PropagatorCost::Linear;
+                p.post(Observer{observed, mode, wakes, cost});
+            }
         long long sols = 0;
         auto start = std::chrono::steady_clock::now();
         auto stats = solve_with(p,
             SolveCallbacks{.solution = [&](const CurrentState &) -> bool { return ++sols < cap; },
-                .branch = branch_with(variable_order::in_order(vars), value_order::smallest_first())});
+                .branch = branch_with(variable_order::in_order(vars), value_order::smallest_first()),
+                .order_propagation_by_cost = order_by_cost});
         auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
         return {elapsed, stats.recursions, *wakes};
     }
@@ -165,6 +244,7 @@ auto main(int argc, char * argv[]) -> int
         ("domain", "Domain 0..d", cxxopts::value<int>()->default_value("3"))                            //
         ("observers", "Number of observer constraints", cxxopts::value<int>()->default_value("32"))     //
         ("cap", "Stop after this many solutions", cxxopts::value<long long>()->default_value("100000")) //
+        ("steps", "Narrowing steps per wake", cxxopts::value<int>()->default_value("10"))               //
         ("help", "Display help");
     auto o = options.parse(argc, argv);
     if (o.contains("help")) {
@@ -173,13 +253,18 @@ auto main(int argc, char * argv[]) -> int
     }
     int n = o["vars"].as<int>(), d = o["domain"].as<int>(), m = o["observers"].as<int>();
     long long cap = o["cap"].as<long long>();
+    int steps = o["steps"].as<int>();
 
     auto [t0, r0, w0] = run(n, d, m, cap, Mode::None);
     auto [tc, rc, wc] = run(n, d, m, cap, Mode::Coarse);
     auto [tr, rr, wr] = run(n, d, m, cap, Mode::Refined);
+    auto [tf, rf, wf] = run(n, d, m, cap, Mode::Coarse, true, false);
+    auto [tb, rb, wb] = run(n, d, m, cap, Mode::Coarse, true, true);
+    auto [tn0, rn0, wn0] = run(n, d, m, cap, Mode::None, false, true, steps);
+    auto [tn, rn, wn] = run(n, d, m, cap, Mode::Coarse, false, true, steps);
 
     println("vars={} domain=0..{} observers={} cap={}", n, d, m, cap);
-    println("recursions (must match): none={} coarse={} refined={}", r0, rc, rr);
+    println("recursions (must match): none={} coarse={} refined={} fifo={} by-cost={} narrowing={}/{}", r0, rc, rr, rf, rb, rn0, rn);
     println("baseline (no observers):        wall={:.4f}s", t0);
     println("coarse  triggers: wall={:.4f}s wakes={} overhead={:.4f}s per-wake={:.1f}ns", tc, wc, tc - t0,
         wc ? (tc - t0) / static_cast<double>(wc) * 1e9 : 0.0);
@@ -187,5 +272,13 @@ auto main(int argc, char * argv[]) -> int
         wr ? (tr - t0) / static_cast<double>(wr) * 1e9 : 0.0);
     if (wc && wr && (tc - t0) > 0)
         println("refined per-wake / coarse per-wake = {:.2f}x", ((tr - t0) / static_cast<double>(wr)) / ((tc - t0) / static_cast<double>(wc)));
+    println("coarse, observers spread over every cost:");
+    println("  first-in first-out: wall={:.4f}s wakes={} per-wake={:.1f}ns", tf, wf, wf ? (tf - t0) / static_cast<double>(wf) * 1e9 : 0.0);
+    println("  ordered by cost:    wall={:.4f}s wakes={} per-wake={:.1f}ns", tb, wb, wb ? (tb - t0) / static_cast<double>(wb) * 1e9 : 0.0);
+    if (wb)
+        println("  ordering by cost adds {:.1f}ns per wake", (tb - tf) / static_cast<double>(wb) * 1e9);
+    println("coarse, with a propagator narrowing one observed variable {} steps per wake:", steps);
+    println("  baseline (no observers): wall={:.4f}s", tn0);
+    println("  observers:               wall={:.4f}s wakes={} per-wake={:.1f}ns", tn, wn, wn ? (tn - tn0) / static_cast<double>(wn) * 1e9 : 0.0);
     return EXIT_SUCCESS;
 }
@@ -425,6 +425,19 @@ auto main(int argc, char * argv[]) -> int
                 "Branching value order: smallest (default) or split, which bisects a start " //
                 "time's domain rather than enumerating it",                                  //
                 cxxopts::value<string>()->default_value("smallest"))                         //
+            ("lns",
+                "Minimise the makespan by large neighbourhood search, fixing part of the best " //
+                "schedule so far and searching the rest, until this many iterations have been " //
+                "done (0, the default, uses complete branch and bound instead). Cannot be "     //
+                "combined with --prove",                                                        //
+                cxxopts::value<unsigned long long>()->default_value("0"))                       //
+            ("objective-search",
+                "How to minimise the makespan: descent (the default, branch and bound, always " //
+                "looking for a better schedule than the last), dichotomic (probing the middle " //
+                "of the gap between the bound and the best schedule so far), or "               //
+                "lower-bounding (probing at the bound). Cannot be combined with --lns, "       //
+                "--all or --deadline",                                                          //
+                cxxopts::value<string>()->default_value("descent"))                             //
             ("unary",
                 "How to post a renewable resource whose capacity is one: cumulative (the "     //
                 "default, so every resource is handled the same way and a variant comparison " //
@@ -941,6 +954,30 @@ auto main(int argc, char * argv[]) -> int
         return EXIT_FAILURE;
     }
 
+    // Large neighbourhood search only makes sense when there is an objective,
+    // and it fixes only the start times, from which everything else follows.
+    optional<LargeNeighbourhoodSearch> lns;
+    if (auto iterations = options_vars["lns"].as<unsigned long long>(); 0 != iterations && ! all && ! deadline)
+        lns = LargeNeighbourhoodSearch{.variables = starts, .iteration_limit = iterations};
+
+    optional<ObjectiveSearch> objective_search;
+    if (auto strategy = options_vars["objective-search"].as<string>(); strategy == "dichotomic")
+        objective_search = ObjectiveSearch{.strategy = ObjectiveStrategy::Dichotomic};
+    else if (strategy == "lower-bounding")
+        objective_search = ObjectiveSearch{.strategy = ObjectiveStrategy::LowerBounding};
+    else if (strategy != "descent") {
+        println(cerr, "Error: unknown --objective-search value '{}'.", strategy);
+        return EXIT_FAILURE;
+    }
+    if (objective_search && lns) {
+        println(cerr, "Error: --objective-search and --lns cannot be combined.");
+        return EXIT_FAILURE;
+    }
+    if (objective_search && (all || deadline)) {
+        println(cerr, "Error: --objective-search needs the makespan to minimise, so it cannot be combined with --all or --deadline.");
+        return EXIT_FAILURE;
+    }
+
     optional<Integer> best_makespan;
     vector<Integer> best_starts;
     bool proven = false;
@@ -958,7 +995,9 @@ auto main(int argc, char * argv[]) -> int
                            return all || ! deadline.has_value();
                        },
             .branch = branch_with(*var_order, *val_order),
-            .completed = [&]() { proven = true; }},
+            .completed = [&]() { proven = true; },
+            .lns = lns,
+            .objective_search = objective_search},
         options_vars.contains("prove") ? make_optional<ProofOptions>(options_vars["proof-files-basename"].as<string>()) : nullopt);
 
     string status;
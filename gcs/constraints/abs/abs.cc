@@ -278,7 +278,7 @@ auto Abs::install_propagators(Propagators & propagators) -> void
 
             return PropagatorState::Enable;
         },
-        triggers);
+        triggers, PropagatorCost::Binary);
 }
 
 auto Abs::constraint_type() const -> std::string
@@ -122,11 +122,11 @@ auto AllDifferent::prepare(Propagators &, State & initial_state, ProofModel * co
     // enough for staging to pay. Skipped otherwise: an unused constraint
     // state would still be saved and restored at every search node.
     if (holds_alternative<consistency::VC>(_level) || _gac_staged) {
-        NonGacAllDifferentUnassigned unassigned{};
+        vector<IntegerVariableID> unassigned;
         for (auto & var : _sanitised_vars)
             if (! initial_state.has_single_value(var))
                 unassigned.push_back(var);
-        _unassigned_handle = initial_state.add_constraint_state(unassigned);
+        _unassigned_handle = NonGacAllDifferentUnassigned{initial_state.reversible_trail(), move(unassigned)};
     }
 
     return true;
@@ -158,7 +158,10 @@ auto AllDifferent::install_propagators(Propagators & propagators) -> void
                 constraint_id(),
                 [vars = move(_sanitised_vars), vals = move(_compressed_vals), value_am1_constraint_numbers = move(value_am1_constraint_numbers),
                     scratch = make_gac_all_different_scratch(), staged = _gac_staged, unassigned_handle = _unassigned_handle, reasons = move(reasons),
-                    constraint_id = constraint_id()](const State & state, auto & inference, ProofLogger * const logger) -> PropagatorState {
+                    constraint_id = constraint_id()](
+                    const State & state, auto & inference, ProofLogger * const logger, const DomainDelta & delta) -> PropagatorState {
+                    note_gac_all_different_delta(*scratch, delta);
+
                     // Stage 1, cheap (only when the constraint is big enough
                     // for staging to pay; see min_var_val_pairs_for_staged_gac):
                     // push newly assigned values through the clique -- the same
@@ -209,7 +212,7 @@ auto AllDifferent::install_propagators(Propagators & propagators) -> void
                     // caught by the install-time downgrade.
                     return PropagatorState::EnableButIdempotent;
                 },
-                triggers);
+                triggers, PropagatorCost::Quadratic);
         },
         [&](const consistency::VC &) {
             auto reasons = build_single_value_reasons(_sanitised_vars);
@@ -52,6 +52,7 @@ using std::optional;
 using std::pair;
 using std::shared_ptr;
 using std::string;
+using std::swap;
 using std::tuple;
 using std::unique_ptr;
 using std::variant;
@@ -113,6 +114,18 @@ namespace gcs::innards
         std::vector<std::pair<Left, Right>> edges;
         std::vector<std::size_t> var_edges_begin;
         std::vector<std::size_t> phantom_plus_one_of_var;
+
+        // the previous wake's edges, which note_gac_all_different_delta lets
+        // the next wake reuse: a variable not marked in var_changed has the
+        // same real edges as last time, so they are copied rather than rebuilt
+        // from its domain. previous_edges_valid is cleared whenever the delta
+        // cannot say what changed, and delta_noted says whether the caller has
+        // given a delta since the last wake at all.
+        std::vector<std::pair<Left, Right>> previous_edges;
+        std::vector<std::size_t> previous_var_edges_begin;
+        std::vector<uint8_t> var_changed;
+        bool previous_edges_valid = false;
+        bool delta_noted = false;
         std::vector<uint8_t> left_covered;
         std::vector<std::optional<Right>> matching;
 
@@ -170,6 +183,21 @@ namespace gcs::innards
     {
         return make_shared<GacAllDifferentScratch>();
     }
+
+    auto note_gac_all_different_delta(GacAllDifferentScratch & scratch, const DomainDelta & delta) -> void
+    {
+        scratch.delta_noted = true;
+        if (delta.everything_changed() || delta.backtracked()) {
+            scratch.previous_edges_valid = false;
+            return;
+        }
+
+        for (const auto & entry : delta.changed()) {
+            if (entry.position >= scratch.var_changed.size())
+                scratch.var_changed.resize(entry.position + 1, 0);
+            scratch.var_changed[entry.position] = 1;
+        }
+    }
 }
 
 namespace
@@ -700,10 +728,29 @@ auto gcs::innards::propagate_gac_all_different(const ConstraintID & constraint_i
     const vector<Integer> & vals, const vector<Integer> & excluded, map<Integer, ProofLine> & value_am1_constraint_numbers,
     GacAllDifferentScratch & scratch, const State & state, auto & tracker, ProofLogger * const logger) -> void
 {
-    // find a matching to check feasibility
+    // find a matching to check feasibility. Changes noted since the last
+    // wake accumulate until this runs, so a caller may note a delta on a wake
+    // that never gets this far.
+    bool reuse_edges = scratch.delta_noted && scratch.previous_edges_valid;
+    if (reuse_edges) {
+        swap(scratch.edges, scratch.previous_edges);
+        swap(scratch.var_edges_begin, scratch.previous_var_edges_begin);
+        scratch.var_changed.resize(vars.size(), 0);
+    }
     auto & edges = scratch.edges;
     edges.clear();
 
+    // copy a variable's real edges from the previous wake, if it is known not
+    // to have changed since
+    auto reuse_edges_of = [&](vector<IntegerVariableID>::size_type var_idx) -> bool {
+        if (! reuse_edges || scratch.var_changed[var_idx])
+            return false;
+        const auto b = scratch.previous_edges.begin() + static_cast<std::ptrdiff_t>(scratch.previous_var_edges_begin[var_idx]);
+        const auto e = scratch.previous_edges.begin() + static_cast<std::ptrdiff_t>(scratch.previous_var_edges_begin[var_idx + 1]);
+        edges.insert(edges.end(), b, e);
+        return true;
+    };
+
     if (! scratch.val_lookup_initialised) {
         // vals is fixed for an installed propagator, so decide once whether
         // to build the value -> index lookup. If the value set is too narrow
@@ -737,6 +784,8 @@ auto gcs::innards::propagate_gac_all_different(const ConstraintID & constraint_i
         auto & vals_in_domain = scratch.vals_in_domain;
         for (const auto & [var_idx, var] : enumerate(vars)) {
             var_edges_begin[var_idx] = edges.size();
+            if (reuse_edges_of(var_idx))
+                continue;
             vals_in_domain.assign(vals.size(), 0);
             state.for_each_value_immutable(var, [&](Integer val) -> void {
                 if (val < min_val)
@@ -753,6 +802,8 @@ auto gcs::innards::propagate_gac_all_different(const ConstraintID & constraint_i
     else {
         for (const auto & [var_idx, var] : enumerate(vars)) {
             var_edges_begin[var_idx] = edges.size();
+            if (reuse_edges_of(var_idx))
+                continue;
             for (const auto & [val_idx, val] : enumerate(vals))
                 if (state.in_domain(var, val))
                     edges.emplace_back(Left{var_idx}, Right{val_idx});
@@ -760,6 +811,12 @@ auto gcs::innards::propagate_gac_all_different(const ConstraintID & constraint_i
     }
     var_edges_begin[vars.size()] = edges.size();
 
+    // the next wake may start from these, whatever happens from here on:
+    // changes this wake makes are reported by the next wake's delta too
+    scratch.previous_edges_valid = true;
+    scratch.delta_noted = false;
+    scratch.var_changed.assign(vars.size(), 0);
+
     // Add a private phantom right-vertex per variable that has any excluded
     // value still in its current domain. The phantom edge represents "this
     // variable opts out of the alldifferent by taking an excluded value", so
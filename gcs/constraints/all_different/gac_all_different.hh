@@ -6,6 +6,7 @@
 #include <gcs/innards/inference_tracker-fwd.hh>
 #include <gcs/innards/proofs/proof_logger.hh>
 #include <gcs/innards/proofs/proof_only_variables.hh>
+#include <gcs/innards/propagators-fwd.hh>
 #include <gcs/variable_id.hh>
 
 #include <map>
@@ -33,6 +34,22 @@ namespace gcs
          */
         [[nodiscard]] auto make_gac_all_different_scratch() -> std::shared_ptr<GacAllDifferentScratch>;
 
+        /**
+         * \brief Tell propagate_gac_all_different's scratch what a DomainDelta
+         * says has changed, so that its next call rebuilds the edges of only
+         * those variables.
+         *
+         * The delta's positions must be the indices of the variables passed to
+         * propagate_gac_all_different, which is what a Triggers with exactly
+         * those variables in on_change gives. Call this on every run of the
+         * propagator, whether or not that run goes on to call
+         * propagate_gac_all_different. A caller that never calls this gets a
+         * full rebuild every time.
+         *
+         * \ingroup Innards
+         */
+        auto note_gac_all_different_delta(GacAllDifferentScratch & scratch, const DomainDelta & delta) -> void;
+
         auto propagate_gac_all_different(const ConstraintID & constraint_id, const std::vector<IntegerVariableID> & vars,
             const std::vector<Integer> & vals, const std::vector<Integer> & excluded, std::map<Integer, ProofLine> & value_am1_constraint_numbers,
             GacAllDifferentScratch & scratch, const State & state, auto & inference_tracker, ProofLogger * const logger) -> void;
@@ -52,10 +52,12 @@ using fmt::print;
 // non-throwing infer_not_equal_or_stop path so a contradiction does not unwind via
 // an exception -- this propagator fails roughly once per node in circuit-style
 // models, so the throw was a large per-node cost.
-auto gcs::innards::propagate_non_gac_alldifferent(const ConstraintStateHandle & unassigned_handle, const State & state, auto & inference,
+auto gcs::innards::propagate_non_gac_alldifferent(const NonGacAllDifferentUnassigned & unassigned_handle, const State & state, auto & inference,
     ProofLogger * const logger, const ConstraintID & owner, const std::vector<Reason> * single_value_reasons, unsigned long long reason_base) -> bool
 {
-    auto & unassigned = any_cast<NonGacAllDifferentUnassigned &>(state.get_constraint_state(unassigned_handle));
+    auto & trail = state.reversible_trail();
+    const auto & unassigned_vars = unassigned_handle.vars;
+    const auto & unassigned = unassigned_handle.positions;
 
     // The reason every removal cites is "v == val", where v is a variable already
     // fixed to val. When the caller hands us a prebuilt table, look it up by v's own
@@ -73,14 +75,13 @@ auto gcs::innards::propagate_non_gac_alldifferent(const ConstraintStateHandle &
 
     vector<pair<IntegerVariableID, Integer>> to_propagate;
     {
-        // Collect any newly assigned values. Erasing by swap-and-pop (order of
-        // unassigned is irrelevant) keeps this O(1) per removal on a flat container.
-        for (std::size_t k = 0; k < unassigned.size();) {
-            auto s = unassigned[k];
+        // Collect any newly assigned values. Erasing by position swaps the last
+        // member into place (order of unassigned is irrelevant), so do not advance.
+        for (std::size_t k = 0; k < unassigned.size(trail);) {
+            auto s = unassigned_vars[unassigned.at(trail, k)];
             if (auto val = state.optional_single_value(s)) {
                 to_propagate.emplace_back(s, *val);
-                unassigned[k] = unassigned.back();
-                unassigned.pop_back();
+                unassigned.erase_at(trail, k);
             }
             else
                 ++k;
@@ -106,8 +107,8 @@ auto gcs::innards::propagate_non_gac_alldifferent(const ConstraintStateHandle &
             }
         }
 
-        for (std::size_t k = 0; k < unassigned.size();) {
-            auto other = unassigned[k];
+        for (std::size_t k = 0; k < unassigned.size(trail);) {
+            auto other = unassigned_vars[unassigned.at(trail, k)];
             // var is no longer in unassigned (it was popped into to_propagate), so the
             // other != var guard from the list version always held; kept for safety.
             if (other != var) {
@@ -115,8 +116,7 @@ auto gcs::innards::propagate_non_gac_alldifferent(const ConstraintStateHandle &
                     return false;
                 if (auto other_val = state.optional_single_value(other)) {
                     to_propagate.emplace_back(other, *other_val);
-                    unassigned[k] = unassigned.back();
-                    unassigned.pop_back();
+                    unassigned.erase_at(trail, k);
                     continue;
                 }
             }
@@ -127,10 +127,10 @@ auto gcs::innards::propagate_non_gac_alldifferent(const ConstraintStateHandle &
     return true;
 }
 
-template auto gcs::innards::propagate_non_gac_alldifferent(const ConstraintStateHandle & unassigned_handle, const State & state,
+template auto gcs::innards::propagate_non_gac_alldifferent(const NonGacAllDifferentUnassigned & unassigned_handle, const State & state,
     SimpleInferenceTracker & inference_tracker, ProofLogger * const logger, const ConstraintID & owner,
     const std::vector<Reason> * single_value_reasons, unsigned long long reason_base) -> bool;
 
-template auto gcs::innards::propagate_non_gac_alldifferent(const ConstraintStateHandle & unassigned_handle, const State & state,
+template auto gcs::innards::propagate_non_gac_alldifferent(const NonGacAllDifferentUnassigned & unassigned_handle, const State & state,
     EagerProofLoggingInferenceTracker & inference_tracker, ProofLogger * const logger, const ConstraintID & owner,
     const std::vector<Reason> * single_value_reasons, unsigned long long reason_base) -> bool;
@@ -16,20 +16,33 @@ namespace gcs
 {
     namespace innards
     {
-        // The not-yet-assigned variables tracked as backtrackable constraint state by
-        // the non-GAC all_different propagator (and circuit, which shares it). Order is
-        // not significant: the propagators may permute it (swap-and-pop erase), so it is
-        // a flat contiguous container rather than a list, to keep the per-search-node
-        // backtracking copy of the constraint state cheap (one allocation + memcpy, or
-        // none at all, instead of a heap node per element).
-        using NonGacAllDifferentUnassigned = std::vector<IntegerVariableID>;
+        // The not-yet-assigned variables tracked by the non-GAC all_different
+        // propagator (and circuit, which shares it): the variables that might be
+        // unassigned, fixed at install time, and a reversible sparse set of the
+        // positions in that list that still are. Removal is O(1) and only the set's
+        // size is trailed, so a search node costs nothing here however many variables
+        // there are. Order is not significant: removal permutes the set, and
+        // backtracking restores membership but not order.
+        struct NonGacAllDifferentUnassigned
+        {
+            std::vector<IntegerVariableID> vars;
+            ReversibleSparseSet positions;
+
+            NonGacAllDifferentUnassigned() = default;
+
+            explicit NonGacAllDifferentUnassigned(ReversibleTrail & trail, std::vector<IntegerVariableID> v) :
+                vars(std::move(v)),
+                positions(trail, vars.size())
+            {
+            }
+        };
 
         // single_value_reasons, when non-null, is a constraint-owned (not backtracked)
         // table of prebuilt "v == its single value" reasons, indexed by the variable's
         // SimpleIntegerVariableID index minus reason_base, so the hot loops hand back a
         // reference instead of constructing a reason. Variables with no entry (views /
         // constants, or an out-of-range index) fall back to building the reason inline.
-        [[nodiscard]] auto propagate_non_gac_alldifferent(const ConstraintStateHandle & unassigned_handle, const State & state,
+        [[nodiscard]] auto propagate_non_gac_alldifferent(const NonGacAllDifferentUnassigned & unassigned_handle, const State & state,
             auto & inference_tracker, ProofLogger * const logger, const ConstraintID & owner,
             const std::vector<Reason> * single_value_reasons = nullptr, unsigned long long reason_base = 0) -> bool;
     }
@@ -99,8 +99,9 @@ auto AtMostOne::install_propagators(Propagators & propagators) -> void
             const State & state, auto & inference, ProofLogger * const logger) -> PropagatorState {
             // For each candidate value v of `val`: if two or more vars
             // are fixed to v, infer val ≠ v. (RUP from the encoding's
-            // sum ≤ 1 plus the fixedness reasons.)
-            for (auto v : state.each_value_immutable(val)) {
+            // sum ≤ 1 plus the fixedness reasons.) This removes values from
+            // val as it goes, so it walks a snapshot of val's domain.
+            for (auto v : state.each_value_mutable(val)) {
                 int fixed_to_v = 0;
                 for (auto & var : vars) {
                     if (state.optional_single_value(var) == make_optional(v)) {
@@ -24,7 +24,6 @@
 #endif
 
 #include <algorithm>
-#include <any>
 #include <cstdint>
 #include <list>
 #include <map>
@@ -37,7 +36,6 @@
 using namespace gcs;
 using namespace gcs::innards;
 
-using std::any_cast;
 using std::holds_alternative;
 using std::list;
 using std::make_shared;
@@ -56,6 +54,7 @@ using std::unique_ptr;
 using std::unordered_map;
 using std::unordered_set;
 using std::vector;
+using std::ranges::lower_bound;
 using std::ranges::minmax_element;
 using std::ranges::none_of;
 
@@ -81,6 +80,9 @@ namespace
     {
         vector<vector<long long>> nodes_at;
         vector<unordered_set<long long>> node_set;
+        // first_node[i] numbers the nodes of layers before i, so that
+        // first_node[i] + p names position p of nodes_at[i].
+        vector<size_t> first_node;
         vector<vector<long long>> phantoms_at;
         vector<unordered_set<long long>> phantom_set;
 
@@ -143,16 +145,43 @@ namespace
         vector<unordered_map<long long, ProofFlag>> s;
     };
 
-    // Backtrack-restored per-bin dead-state cache. dead[b][i] gathers w values
-    // for which ~S_{b,i,w} has been emitted at the current search depth (or
-    // above); dead_g_dn[b][i] is the same for the variable-load lower-bound
-    // ~g_dn lines (only populated at layer n). Pre-populated by the
-    // initialiser with the statically dead set, so the per-call propagator
-    // never re-emits a line for a node already discharged at Top.
+    // Backtrack-restored dead-state cache for one bin. A node's bit in dead
+    // is set once ~S_{b,i,w} has been emitted at the current search depth (or
+    // above); dead_g_dn is the same for the variable-load lower-bound ~g_dn
+    // lines (only used at layer n). One reversible bit per DAG node, so a
+    // search node pays only for the words it sets, not for a copy of the
+    // whole cache.
     struct DeadCache
     {
-        vector<vector<set<long long>>> dead;
-        vector<vector<set<long long>>> dead_g_dn;
+        const PerBinDag & dag;
+        const ReversibleBitset & dead;
+        const ReversibleBitset & dead_g_dn;
+        ReversibleTrail & trail;
+
+        [[nodiscard]] auto bit_of(size_t i, long long w) const -> size_t
+        {
+            return dag.first_node[i] + static_cast<size_t>(lower_bound(dag.nodes_at[i], w) - dag.nodes_at[i].begin());
+        }
+
+        [[nodiscard]] auto contains(size_t i, long long w) const -> bool
+        {
+            return dead.test(trail, bit_of(i, w));
+        }
+
+        auto insert(size_t i, long long w) -> void
+        {
+            dead.set(trail, bit_of(i, w));
+        }
+
+        [[nodiscard]] auto contains_g_dn(long long w) const -> bool
+        {
+            return dead_g_dn.test(trail, bit_of(dag.nodes_at.size() - 1, w) - dag.first_node.back());
+        }
+
+        auto insert_g_dn(long long w) -> void
+        {
+            dead_g_dn.set(trail, bit_of(dag.nodes_at.size() - 1, w) - dag.first_node.back());
+        }
     };
 
     // Per-bin cap on partial sums: sum of all item sizes.
@@ -215,6 +244,7 @@ namespace
         for (size_t i = 0; i <= n; ++i) {
             dag.nodes_at[i].assign(fwd[i].begin(), fwd[i].end());
             dag.node_set[i].insert(dag.nodes_at[i].begin(), dag.nodes_at[i].end());
+            dag.first_node.push_back(i == 0 ? 0 : dag.first_node.back() + dag.nodes_at[i - 1].size());
         }
 
         // Precompute the static successor-position edges used by the per-call
@@ -636,7 +666,7 @@ namespace
                 for (auto w : dag.nodes_at[i + 1]) {
                     if (growing.contains(w))
                         continue;
-                    if (cache.dead[b][i + 1].contains(w))
+                    if (cache.contains(i + 1, w))
                         continue;
 
                     if (w > load_upper_b && opb_lines.first.has_value()) {
@@ -650,7 +680,7 @@ namespace
 
                     auto s_flag = flags.s[i + 1].at(w);
                     logger->emit_rup_proof_line_under_reason(eager_reason(reason, state), WPBSum{} + 1_i * ! s_flag >= 1_i, ProofLevel::Current);
-                    cache.dead[b][i + 1].insert(w);
+                    cache.insert(i + 1, w);
                 }
             }
 
@@ -665,8 +695,8 @@ namespace
             for (auto it = completed_layers.back().begin(), end = completed_layers.back().end(); it != end;) {
                 if (it->first < state.lower_bound(loads[b]).raw_value) {
                     if (emitting) {
-                        bool need_s = ! cache.dead[b][n].contains(it->first);
-                        bool need_g_dn = ! cache.dead_g_dn[b][n].contains(it->first);
+                        bool need_s = ! cache.contains(n, it->first);
+                        bool need_g_dn = ! cache.contains_g_dn(it->first);
                         if (need_s || need_g_dn) {
                             const auto & cf = flags.coord[n].at(it->first);
                             if (opb_lines.second.has_value()) {
@@ -678,12 +708,12 @@ namespace
                             if (need_g_dn) {
                                 logger->emit_rup_proof_line_under_reason(
                                     eager_reason(reason, state), WPBSum{} + 1_i * ! cf.g_dn >= 1_i, ProofLevel::Current);
-                                cache.dead_g_dn[b][n].insert(it->first);
+                                cache.insert_g_dn(it->first);
                             }
                             if (need_s) {
                                 logger->emit_rup_proof_line_under_reason(
                                     eager_reason(reason, state), WPBSum{} + 1_i * ! flags.s[n].at(it->first) >= 1_i, ProofLevel::Current);
-                                cache.dead[b][n].insert(it->first);
+                                cache.insert(n, it->first);
                             }
                         }
                     }
@@ -696,7 +726,7 @@ namespace
             // Interior holes.
             for (auto it = completed_layers.back().begin(), end = completed_layers.back().end(); it != end;) {
                 if (! state.in_domain(loads[b], Integer{it->first})) {
-                    if (emitting && ! cache.dead[b][n].contains(it->first)) {
+                    if (emitting && ! cache.contains(n, it->first)) {
                         const auto & cf = flags.coord[n].at(it->first);
                         if (opb_lines.first.has_value() && opb_lines.second.has_value()) {
                             PolBuilder{}.add(cf.g_dn_fwd).add(*opb_lines.second).emit(*logger, ProofLevel::Temporary);
@@ -706,7 +736,7 @@ namespace
                         }
                         logger->emit_rup_proof_line_under_reason(
                             eager_reason(reason, state), WPBSum{} + 1_i * ! flags.s[n].at(it->first) >= 1_i, ProofLevel::Current);
-                        cache.dead[b][n].insert(it->first);
+                        cache.insert(n, it->first);
                     }
                     completed_layers.back().erase(it++);
                 }
@@ -784,10 +814,10 @@ namespace
                 if (reached_parents.contains(it->first))
                     ++it;
                 else {
-                    if (emitting && ! cache.dead[b][var_number].contains(it->first)) {
+                    if (emitting && ! cache.contains(var_number, it->first)) {
                         auto s_flag = flags.s[var_number].at(it->first);
                         logger->emit_rup_proof_line_under_reason(eager_reason(reason, state), WPBSum{} + 1_i * ! s_flag >= 1_i, ProofLevel::Current);
-                        cache.dead[b][var_number].insert(it->first);
+                        cache.insert(var_number, it->first);
                     }
                     next(layer)->erase(it++);
                 }
@@ -1041,6 +1071,8 @@ struct BinPacking::DagBridge
     // to match each bin's DAG so the hot path never allocates. The bridge is
     // per-constraint-clone, so a search owns its scratch exclusively.
     vector<Stage3Scratch> stage3_scratch;
+    // Per-bin dead-state caches for the upfront strategy; see DeadCache.
+    vector<ReversibleBitset> dead, dead_g_dn;
 };
 
 BinPacking::BinPacking(vector<IntegerVariableID> items, vector<Integer> sizes, vector<IntegerVariableID> loads) :
@@ -1140,9 +1172,10 @@ auto BinPacking::prepare(Propagators &, State & initial_state, ProofModel * cons
             _bridge->dags.push_back(move(dag));
         }
 
-        DeadCache initial_cache{vector<vector<set<long long>>>(num_bins, vector<set<long long>>(_items.size() + 1)),
-            vector<vector<set<long long>>>(num_bins, vector<set<long long>>(_items.size() + 1))};
-        _dead_cache_idx = initial_state.add_constraint_state(move(initial_cache));
+        for (const auto & dag : _bridge->dags) {
+            _bridge->dead.emplace_back(initial_state.reversible_trail(), dag.first_node.back() + dag.nodes_at.back().size());
+            _bridge->dead_g_dn.emplace_back(initial_state.reversible_trail(), dag.nodes_at.back().size());
+        }
     }
 
     return true;
@@ -1237,17 +1270,18 @@ auto BinPacking::install_propagators(Propagators & propagators) -> void
     propagators.install(
         constraint_id(),
         [items = _items, sizes = _sizes, loads = _loads, capacities = _capacities, have_loads = _have_loads, bounds_only = _bounds_only,
-            bridge = _bridge, dead_cache_handle = _dead_cache_idx, upfront = _upfront_proof, reason = move(stage3_reason),
+            bridge = _bridge, upfront = _upfront_proof, reason = move(stage3_reason),
             owner = constraint_id()](const State & state, auto & inference, ProofLogger * const logger) -> PropagatorState {
             run_stage2(state, inference, logger, items, sizes, loads, capacities, have_loads, owner);
 
             if (! bounds_only && bridge) {
                 auto num_bins = have_loads ? loads.size() : capacities.size();
                 if (upfront) {
-                    auto & cache = any_cast<DeadCache &>(state.get_constraint_state(*dead_cache_handle));
-                    for (size_t b = 0; b < num_bins; ++b)
+                    for (size_t b = 0; b < num_bins; ++b) {
+                        DeadCache cache{bridge->dags[b], bridge->dead[b], bridge->dead_g_dn[b], state.reversible_trail()};
                         propagate_bin(state, inference, logger, items, sizes, have_loads, loads, capacities, b, bridge->dags[b], bridge->flags[b],
                             bridge->opb_lines[b], cache, reason, owner);
+                    }
                 }
                 else {
                     for (size_t b = 0; b < num_bins; ++b)
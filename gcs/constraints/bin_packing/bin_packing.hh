@@ -100,7 +100,6 @@ namespace gcs
         bool _upfront_proof = false;
 
         std::shared_ptr<DagBridge> _bridge;
-        std::optional<innards::ConstraintStateHandle> _dead_cache_idx;
 
         virtual auto prepare(innards::Propagators &, innards::State &, innards::ProofModel * const) -> bool override;
         virtual auto define_proof_model(innards::ProofModel &, const innards::State &) -> void override;
@@ -146,14 +146,11 @@ auto Circuit::prepare(Propagators & propagators, State & initial_state, ProofMod
 
     // Backtrackable state for whichever algorithm install_propagators() picks. Both
     // track the unassigned successors; only Prevent keeps the incremental chain
-    // endpoints, so only Prevent pays for that slot.
-    NonGacAllDifferentUnassigned unassigned{};
-    for (auto v : _succ)
-        unassigned.emplace_back(v);
-    _state_handles.unassigned = initial_state.add_constraint_state(unassigned);
+    // endpoints, so only Prevent allocates them.
+    _state_handles.unassigned = NonGacAllDifferentUnassigned{initial_state.reversible_trail(), _succ};
 
     if (std::holds_alternative<Prevent>(_algorithm))
-        _state_handles.chain = initial_state.add_constraint_state(make_prevent_chain_data(_succ.size()));
+        _state_handles.chain = make_prevent_chain_data(initial_state.reversible_trail(), _succ.size());
 
     return true;
 }
@@ -72,16 +72,18 @@ auto gcs::innards::circuit::output_cycle_to_proof(const vector<IntegerVariableID
 }
 
 auto gcs::innards::circuit::prevent_small_cycles(const vector<IntegerVariableID> & succ, const ConstraintID & owner,
-    const PosVarDataMap & pos_var_data, const ConstraintStateHandle & unassigned_handle, const State & state, auto & inference,
+    const PosVarDataMap & pos_var_data, const NonGacAllDifferentUnassigned & unassigned_handle, const State & state, auto & inference,
     ProofLogger * const logger) -> void
 {
-    auto & unassigned = any_cast<NonGacAllDifferentUnassigned &>(state.get_constraint_state(unassigned_handle));
+    auto & trail = state.reversible_trail();
+    const auto & unassigned = unassigned_handle.positions;
     auto n = succ.size();
     auto end = vector<long>(n, -1);
     auto known_ends = vector<long>{};
     auto chain_lengths = vector<long>{};
 
-    for (auto var : unassigned) {
+    for (std::size_t k = 0; k < unassigned.size(trail); ++k) {
+        auto var = unassigned_handle.vars[unassigned.at(trail, k)];
         for (const auto & val : state.each_value_immutable(var)) {
             auto j0 = val.raw_value;
             auto length = 0;
@@ -122,9 +124,9 @@ auto gcs::innards::circuit::prevent_small_cycles(const vector<IntegerVariableID>
 }
 
 template auto gcs::innards::circuit::prevent_small_cycles(const std::vector<IntegerVariableID> & succ, const ConstraintID & owner,
-    const PosVarDataMap & pos_var_data, const ConstraintStateHandle & unassigned_handle, const State & state,
+    const PosVarDataMap & pos_var_data, const NonGacAllDifferentUnassigned & unassigned_handle, const State & state,
     SimpleInferenceTracker & inference_tracker, ProofLogger * const logger) -> void;
 
 template auto gcs::innards::circuit::prevent_small_cycles(const std::vector<IntegerVariableID> & succ, const ConstraintID & owner,
-    const PosVarDataMap & pos_var_data, const ConstraintStateHandle & unassigned_handle, const State & state,
+    const PosVarDataMap & pos_var_data, const NonGacAllDifferentUnassigned & unassigned_handle, const State & state,
     EagerProofLoggingInferenceTracker & inference_tracker, ProofLogger * const logger) -> void;
@@ -2,6 +2,7 @@
 #define GLASGOW_CONSTRAINT_SOLVER_CIRCUIT_BASE_HH
 
 #include <gcs/constraint.hh>
+#include <gcs/constraints/all_different/vc_all_different.hh>
 #include <gcs/innards/inference_tracker-fwd.hh>
 #include <gcs/innards/proofs/proof_logger.hh>
 #include <gcs/innards/proofs/proof_only_variables.hh>
@@ -45,6 +46,21 @@ namespace gcs::innards::circuit
     using ProofFlagDataMap = std::map<long, std::map<long, ProofFlagData>>;
     using PosVarDataMap = std::map<long, PosVarData>;
 
+    // Incremental "prevent" state: the fixed successor edges partition the nodes into
+    // simple paths (chains). For each node we record the chain it belongs to by its
+    // endpoints. These are maintained in O(1) as edges are fixed and restored on
+    // backtrack (held in the reversible trail, so a search node pays only for the
+    // words it writes), rather than recomputed from scratch each call. orig[v] is
+    // valid when v is a chain *end*, dest[v]/len[v] when v is a chain *start* --
+    // which is exactly how they are queried.
+    struct PreventChainData
+    {
+        ReversibleVector<long> orig;   // start node of the chain ending at this node
+        ReversibleVector<long> dest;   // end node of the chain starting at this node
+        ReversibleVector<long> len;    // number of fixed edges in the chain starting at this node
+        ReversibleSparseSet unspliced; // node indices whose fixed successor edge is not yet folded in
+    };
+
     /**
      * \brief The backtrackable state the circuit propagators keep, allocated by
      * Circuit::prepare() -- allocating is a prepare-phase job -- and handed to
@@ -52,12 +68,12 @@ namespace gcs::innards::circuit
      *
      * `chain` holds the incremental small-cycle chain endpoints, which only
      * circuit::Prevent uses, so it is only allocated when that algorithm is
-     * selected: every constraint-state slot is deep-copied at every search node.
+     * selected.
      */
     struct CircuitStateHandles
     {
-        ConstraintStateHandle unassigned;
-        std::optional<ConstraintStateHandle> chain;
+        NonGacAllDifferentUnassigned unassigned;
+        std::optional<PreventChainData> chain;
     };
 
     struct ShiftedPosDataMaps
@@ -72,7 +88,7 @@ namespace gcs::innards::circuit
         const std::optional<Integer> & prevent_value = std::nullopt) -> void;
 
     auto prevent_small_cycles(const std::vector<IntegerVariableID> & succ, const ConstraintID & owner, const PosVarDataMap & pos_var_data,
-        const ConstraintStateHandle & unassigned_handle, const State & state, auto & inference_tracker, ProofLogger * const logger) -> void;
+        const NonGacAllDifferentUnassigned & unassigned_handle, const State & state, auto & inference_tracker, ProofLogger * const logger) -> void;
 }
 
 #endif // GLASGOW_CONSTRAINT_SOLVER_CIRCUIT_BASE_HH
@@ -6,7 +6,6 @@
 #include <gcs/innards/inference_tracker.hh>
 #include <gcs/innards/propagators.hh>
 
-#include <any>
 #include <utility>
 #include <vector>
 
@@ -14,7 +13,6 @@ using namespace gcs;
 using namespace gcs::innards;
 using namespace gcs::innards::circuit;
 
-using std::any_cast;
 using std::size_t;
 using std::vector;
 
@@ -29,17 +27,17 @@ namespace
     // event whose alldifferent consequences this pass does not handle itself, so the
     // caller knows whether another alldifferent pass is needed.
     auto prevent_small_cycles_incrementally(const vector<IntegerVariableID> & succ, const ConstraintID & owner, const PosVarDataMap & pos_var_data,
-        const ConstraintStateHandle & chain_handle, const State & state, auto & inference, ProofLogger * const logger) -> bool
+        const PreventChainData & chain, const State & state, auto & inference, ProofLogger * const logger) -> bool
     {
         bool fixed_a_successor = false;
-        auto & chain = any_cast<PreventChainData &>(state.get_constraint_state(chain_handle));
+        auto & trail = state.reversible_trail();
         auto n = static_cast<long>(succ.size());
 
         bool progress = true;
         while (progress) {
             progress = false;
-            for (std::size_t k = 0; k < chain.unspliced.size();) {
-                auto i = chain.unspliced[k];
+            for (std::size_t k = 0; k < chain.unspliced.size(trail);) {
+                auto i = chain.unspliced.at(trail, k);
                 auto val = state.optional_single_value(succ[i]);
                 if (! val) {
                     ++k;
@@ -50,27 +48,26 @@ namespace
                 // and fold it in. i was a chain end (its successor had been unfixed);
                 // by all-different j had no predecessor, so j is a chain start.
                 auto j = val->raw_value;
-                chain.unspliced[k] = chain.unspliced.back();
-                chain.unspliced.pop_back();
+                chain.unspliced.erase_at(trail, k);
                 progress = true;
 
-                auto o = chain.orig[i];
+                auto o = chain.orig.get(trail, i);
                 if (j == o) {
                     // This edge closes the chain o..i into a cycle of len[o] + 1 edges.
-                    if (chain.len[o] + 1 < n) {
+                    if (chain.len.get(trail, o) + 1 < n) {
                         if (logger && logger->get_assertion_level() == AssertionLevel::Off)
-                            output_cycle_to_proof(succ, o, chain.len[o] + 1, pos_var_data, state, *logger);
+                            output_cycle_to_proof(succ, o, chain.len.get(trail, o) + 1, pos_var_data, state, *logger);
                         inference.contradiction(logger, JustifyUsingRUP{hints::Circuit{owner}}, generic_reason(succ));
                     }
                     // else: the final edge of the full Hamiltonian cycle -- nothing to infer.
                 }
                 else {
                     // Splice chain (o..i) and chain (j..d) into (o..d).
-                    auto d = chain.dest[j];
-                    auto new_len = chain.len[o] + 1 + chain.len[j];
-                    chain.dest[o] = d;
-                    chain.orig[d] = o;
-                    chain.len[o] = new_len;
+                    auto d = chain.dest.get(trail, j);
+                    auto new_len = chain.len.get(trail, o) + 1 + chain.len.get(trail, j);
+                    chain.dest.set(trail, o, d);
+                    chain.orig.set(trail, d, o);
+                    chain.len.set(trail, o, new_len);
                     if (new_len < n - 1) {
                         auto justf = [&](const ReasonLiterals &) {
                             output_cycle_to_proof(succ, o, new_len, pos_var_data, state, *logger, Integer{d}, Integer{o});
@@ -95,7 +92,7 @@ namespace
 }
 
 auto gcs::innards::circuit::propagate_circuit_using_prevent(const std::vector<IntegerVariableID> & succ, const ConstraintID & owner,
-    const PosVarDataMap & pos_var_data, const ConstraintStateHandle & unassigned_handle, const ConstraintStateHandle & chain_handle,
+    const PosVarDataMap & pos_var_data, const NonGacAllDifferentUnassigned & unassigned_handle, const PreventChainData & chain,
     const State & state, auto & inference, ProofLogger * const logger) -> void
 {
     // Each phase runs its own internal cascade to quiescence, but they feed
@@ -110,30 +107,26 @@ auto gcs::innards::circuit::propagate_circuit_using_prevent(const std::vector<In
     while (true) {
         if (! propagate_non_gac_alldifferent(unassigned_handle, state, inference, logger, owner))
             return; // contradiction: the cycle checks below would read junk state; the loop sees contradicted()
-        if (! prevent_small_cycles_incrementally(succ, owner, pos_var_data, chain_handle, state, inference, logger))
+        if (! prevent_small_cycles_incrementally(succ, owner, pos_var_data, chain, state, inference, logger))
             return;
     }
 }
 
 template auto gcs::innards::circuit::propagate_circuit_using_prevent(const std::vector<IntegerVariableID> & succ, const ConstraintID & owner,
-    const PosVarDataMap & pos_var_data, const ConstraintStateHandle & unassigned_handle, const ConstraintStateHandle & chain_handle,
+    const PosVarDataMap & pos_var_data, const NonGacAllDifferentUnassigned & unassigned_handle, const PreventChainData & chain,
     const State & state, SimpleInferenceTracker & inference, ProofLogger * const logger) -> void;
 
 template auto gcs::innards::circuit::propagate_circuit_using_prevent(const std::vector<IntegerVariableID> & succ, const ConstraintID & owner,
-    const PosVarDataMap & pos_var_data, const ConstraintStateHandle & unassigned_handle, const ConstraintStateHandle & chain_handle,
+    const PosVarDataMap & pos_var_data, const NonGacAllDifferentUnassigned & unassigned_handle, const PreventChainData & chain,
     const State & state, EagerProofLoggingInferenceTracker & inference, ProofLogger * const logger) -> void;
 
-auto gcs::innards::circuit::make_prevent_chain_data(size_t num_nodes) -> PreventChainData
+auto gcs::innards::circuit::make_prevent_chain_data(ReversibleTrail & trail, size_t num_nodes) -> PreventChainData
 {
-    PreventChainData chain;
-    chain.orig.resize(num_nodes);
-    chain.dest.resize(num_nodes);
-    chain.len.assign(num_nodes, 0);
-    chain.unspliced.resize(num_nodes);
+    PreventChainData chain{ReversibleVector<long>{trail, num_nodes, 0}, ReversibleVector<long>{trail, num_nodes, 0},
+        ReversibleVector<long>{trail, num_nodes, 0}, ReversibleSparseSet{trail, num_nodes}};
     for (size_t i = 0; i < num_nodes; ++i) {
-        chain.orig[i] = static_cast<long>(i);
-        chain.dest[i] = static_cast<long>(i);
-        chain.unspliced[i] = static_cast<long>(i);
+        chain.orig.set(trail, i, static_cast<long>(i));
+        chain.dest.set(trail, i, static_cast<long>(i));
     }
     return chain;
 }
@@ -142,15 +135,15 @@ auto gcs::innards::circuit::install_circuit_prevent(Propagators & propagators, c
     PosVarDataMap pos_var_data, const CircuitStateHandles & handles) -> void
 {
     auto unassigned_handle = handles.unassigned;
-    auto chain_handle = handles.chain.value();
+    auto chain = handles.chain.value();
 
     Triggers triggers;
     triggers.on_instantiated = {succ.begin(), succ.end()};
     propagators.install(
         owner,
-        [succ, owner, pvd = std::move(pos_var_data), unassigned_handle = unassigned_handle, chain_handle = chain_handle](
+        [succ, owner, pvd = std::move(pos_var_data), unassigned_handle = unassigned_handle, chain = chain](
             const State & state, auto & inference, ProofLogger * const logger) -> PropagatorState {
-            propagate_circuit_using_prevent(succ, owner, pvd, unassigned_handle, chain_handle, state, inference, logger);
+            propagate_circuit_using_prevent(succ, owner, pvd, unassigned_handle, chain, state, inference, logger);
             // Idempotent: propagate_circuit_using_prevent alternates its
             // alldifferent and small-cycle passes until the latter stops
             // inferring, so at return no unassigned successor is
@@ -1063,20 +1063,20 @@ namespace
 
 auto gcs::innards::circuit::propagate_circuit_using_scc(const State & state, auto & inference, ProofLogger * const logger,
     const ReasonLiterals & reason, const ConstraintID & owner, const std::vector<IntegerVariableID> & succ, const SCCOptions & scc_options,
-    SCCPersistentData & persistent, const ConstraintStateHandle & unassigned_handle) -> void
+    SCCPersistentData & persistent, const NonGacAllDifferentUnassigned & unassigned_handle) -> void
 {
     auto & pos_var_data = persistent.pos_var_data;
     if (! propagate_non_gac_alldifferent(unassigned_handle, state, inference, logger, owner))
         return; // contradiction: the SCC check below would read junk state; the loop sees contradicted()
     auto proof_data = SCCProofData{pos_var_data, persistent.proof_flag_data, persistent.pos_alldiff_data};
     check_sccs(state, inference, logger, reason, owner, succ, scc_options, proof_data);
-    auto & unassigned = any_cast<NonGacAllDifferentUnassigned &>(state.get_constraint_state(unassigned_handle));
-    // Remove any newly assigned vals from unassigned (swap-and-pop; order is irrelevant).
-    for (std::size_t k = 0; k < unassigned.size();) {
-        if (state.optional_single_value(unassigned[k])) {
-            unassigned[k] = unassigned.back();
-            unassigned.pop_back();
-        }
+    // Remove any newly assigned vals from unassigned (erasing by position swaps
+    // the last member into place; order is irrelevant).
+    auto & trail = state.reversible_trail();
+    const auto & unassigned = unassigned_handle.positions;
+    for (std::size_t k = 0; k < unassigned.size(trail);) {
+        if (state.optional_single_value(unassigned_handle.vars[unassigned.at(trail, k)]))
+            unassigned.erase_at(trail, k);
         else
             ++k;
     }
@@ -1085,11 +1085,11 @@ auto gcs::innards::circuit::propagate_circuit_using_scc(const State & state, aut
 
 template auto gcs::innards::circuit::propagate_circuit_using_scc(const State & state, SimpleInferenceTracker & inference, ProofLogger * const logger,
     const ReasonLiterals & reason, const ConstraintID & owner, const std::vector<IntegerVariableID> & succ, const SCCOptions & scc_options,
-    SCCPersistentData & persistent, const ConstraintStateHandle & unassigned_handle) -> void;
+    SCCPersistentData & persistent, const NonGacAllDifferentUnassigned & unassigned_handle) -> void;
 
 template auto gcs::innards::circuit::propagate_circuit_using_scc(const State & state, EagerProofLoggingInferenceTracker & inference,
     ProofLogger * const logger, const ReasonLiterals & reason, const ConstraintID & owner, const std::vector<IntegerVariableID> & succ,
-    const SCCOptions & scc_options, SCCPersistentData & persistent, const ConstraintStateHandle & unassigned_handle) -> void;
+    const SCCOptions & scc_options, SCCPersistentData & persistent, const NonGacAllDifferentUnassigned & unassigned_handle) -> void;
 
 auto gcs::innards::circuit::install_circuit_scc(Propagators & propagators, const ConstraintID & owner, const vector<IntegerVariableID> & succ,
     const SCCOptions & scc_options, PosVarDataMap pos_var_data, const CircuitStateHandles & handles) -> void
@@ -1124,5 +1124,5 @@ auto gcs::innards::circuit::install_circuit_scc(Propagators & propagators, const
             propagate_circuit_using_scc(state, inference, logger, reason, owner, succ, options, *persistent, unassigned_handle);
             return PropagatorState::Enable;
         },
-        triggers);
+        triggers, PropagatorCost::Expensive);
 }
@@ -58,7 +58,7 @@ namespace gcs::innards::circuit
      */
     auto propagate_circuit_using_scc(const State & state, auto & inference, ProofLogger * const logger, const ReasonLiterals & reason,
         const ConstraintID & owner, const std::vector<IntegerVariableID> & succ, const SCCOptions & scc_options, SCCPersistentData & persistent,
-        const ConstraintStateHandle & unassigned_handle) -> void;
+        const NonGacAllDifferentUnassigned & unassigned_handle) -> void;
 
     /**
      * \brief Install the SCC circuit propagator over the backtrackable state
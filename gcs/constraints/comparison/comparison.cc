@@ -237,7 +237,7 @@ auto ReifiedCompareLessThanOrMaybeEqual::install_propagators(Propagators & propa
 
         Triggers triggers{.on_bounds = {_v1, _v2}};
         install_reified_dispatcher(propagators, constraint_id(), _evaluated_cond, _reif_cond, triggers, std::move(enforce_constraint_must_hold),
-            std::move(enforce_constraint_must_not_hold), std::move(infer_cond_when_undecided));
+            std::move(enforce_constraint_must_not_hold), std::move(infer_cond_when_undecided), PropagatorCost::Binary);
     }
 }
 
@@ -258,7 +258,7 @@ auto Count::install_propagators(Propagators & propagators) -> void
                     // Per-voi unconditional lines: emit after all the
                     // conditionals so they have the full set of pairwise
                     // facts to RUP-derive against.
-                    for (const auto & voi : voi_set.each())
+                    for (const auto & voi : voi_set.values())
                         logger->emit_rup_proof_line_under_reason(reason,
                             WPBSum{} + 1_i * (value_of_interest != voi) + 1_i * (how_many < *highest_how_many_might + 1_i) >= 1_i,
                             ProofLevel::Temporary);
@@ -614,7 +614,7 @@ auto Cumulative::install_propagators(Propagators & propagators) -> void
         [inputs = move(inputs)](const State & state, auto & inference, ProofLogger * const logger) -> PropagatorState {
             return propagate_cumulative(inputs, state, inference, logger);
         },
-        triggers);
+        triggers, PropagatorCost::Expensive);
 }
 
 auto gcs::innards::propagate_cumulative(const CumulativeInputs & inputs, const State & state, auto & inference, ProofLogger * const logger)
@@ -387,7 +387,7 @@ auto gcs::innards::install_derived_cumulative(
         [inputs](const State & state, auto & inference, ProofLogger * const logger) -> PropagatorState {
             return propagate_cumulative(*inputs, state, inference, logger);
         },
-        triggers);
+        triggers, PropagatorCost::Expensive);
 
     // Only here, on the success path: every decline above returns without
     // installing anything, and a block saying a constraint was derived when it
@@ -2445,7 +2445,7 @@ auto Disjunctive::install_propagators(Propagators & propagators) -> void
 
             return PropagatorState::Enable;
         },
-        triggers);
+        triggers, PropagatorCost::Expensive);
 }
 
 auto Disjunctive::constraint_type() const -> std::string
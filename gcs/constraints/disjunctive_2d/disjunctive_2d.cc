@@ -500,7 +500,7 @@ auto Disjunctive2D::install_propagators(Propagators & propagators) -> void
 
             return PropagatorState::Enable;
         },
-        triggers);
+        triggers, PropagatorCost::Expensive);
 }
 
 auto Disjunctive2D::constraint_type() const -> std::string
@@ -329,7 +329,8 @@ auto NDimensionalElement<EntryType_, dimensions_>::install_propagators_impl(Prop
             constraint_id(),
             [array = _array, index_vars = index_vars, index_starts = _index_starts, result_var = _result_var, fixed_dim = fixed_dim,
                 array_has_nonconstants = array_has_nonconstants, scope_has_aliasing = scope_has_aliasing,
-                owner = constraint_id()](const State & state, auto & inference, ProofLogger * const logger) -> PropagatorState {
+                owner = constraint_id()](
+                const State & state, auto & inference, ProofLogger * const logger, const DomainDelta & delta) -> PropagatorState {
                 // for each index variable, update it to only contain values where
                 // there's at least one supporting option. The support tests below
                 // only ask "is this value / this array var's domain within
@@ -340,7 +341,7 @@ auto NDimensionalElement<EntryType_, dimensions_>::install_propagators_impl(Prop
                 // (no-SBO) allocation, so skip it when no reason will be read.
                 auto want_reason = inference.want_reasons();
 
-                state.for_each_value_mutable(index_vars.at(fixed_dim), [&](Integer test_val) {
+                auto check_support_for = [&](Integer test_val) {
                     gch::small_vector<size_t, dimensions_> elem;
                     vector<IntegerVariableID> explored_vars;
                     if (want_reason)
@@ -439,7 +440,32 @@ auto NDimensionalElement<EntryType_, dimensions_>::install_propagators_impl(Prop
                                 ThenRUP::Yes, hints::Element{owner}},
                             want_reason ? generic_reason(explored_vars) : Reason{});
                     }
-                });
+                };
+
+                // With one dimension and a variable array, index value i is
+                // supported exactly when array[i] and result intersect, and
+                // every value left had support when this last finished. So if
+                // result has not changed since, only the values whose array
+                // variable has changed can have lost it. Positions count the
+                // array first, then result.
+                if (dimensions_ == 1 && array_has_nonconstants && ! scope_has_aliasing && ! delta.everything_changed()) {
+                    auto result_position = static_cast<std::uint32_t>(get_dimension_size<dimensions_>(0, *array));
+                    bool result_changed = false;
+                    for (const auto & entry : delta.changed())
+                        if (entry.position == result_position)
+                            result_changed = true;
+
+                    if (! result_changed) {
+                        for (const auto & entry : delta.changed()) {
+                            auto test_val = index_starts.at(0) + Integer(entry.position);
+                            if (state.in_domain(index_vars.at(fixed_dim), test_val))
+                                check_support_for(test_val);
+                        }
+                        return PropagatorState::EnableButIdempotent;
+                    }
+                }
+
+                state.for_each_value_mutable(index_vars.at(fixed_dim), check_support_for);
 
                 // Idempotent when the scope has no aliasing: this run writes
                 // only index_vars[fixed_dim], and no support test reads it (a
@@ -619,7 +645,7 @@ auto NDimensionalElement<EntryType_, dimensions_>::install_propagators_impl(Prop
                 };
                 collect_supported_values(collect_supported_values, 0);
 
-                for (auto value : still_to_find_support_for.each()) {
+                for (auto value : still_to_find_support_for.values()) {
                     // index_vars stay a declarative generic_reason, concatenated with
                     // the per-considered-var literals; assembled only when a reason
                     // will be read.
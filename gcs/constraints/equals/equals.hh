@@ -6,6 +6,7 @@
 #include <gcs/innards/proofs/proof_logger-fwd.hh>
 #include <gcs/innards/proofs/reification.hh>
 #include <gcs/innards/reason.hh>
+#include <gcs/lifetime.hh>
 #include <gcs/reification.hh>
 #include <gcs/variable_condition.hh>
 #include <gcs/variable_id.hh>
@@ -39,6 +40,45 @@ namespace gcs
     public:
         ReifiedEquals(const IntegerVariableID v1, const IntegerVariableID v2, ReificationCondition cond, bool neq = false);
 
+        /**
+         * \name Posted arguments, for presolvers.
+         *
+         * These read back the constraint as it was constructed, in the same
+         * spirit as ReifiedCompareLessThanOrMaybeEqual's accessors. Since
+         * clone() returns a ReifiedEquals whatever the derived type was, it is
+         * the reification condition that tells the family apart: a plain
+         * NotEquals is `reif::MustNotHold`, and a plain Equals is
+         * `reif::MustHold`.
+         *
+         * @{
+         */
+
+        /**
+         * \brief The first operand, as posted, which may be a constant or a view.
+         */
+        [[nodiscard]] auto first_variable() const -> IntegerVariableID
+        {
+            return _v1;
+        }
+
+        /**
+         * \brief The second operand, as posted, which may be a constant or a view.
+         */
+        [[nodiscard]] auto second_variable() const -> IntegerVariableID
+        {
+            return _v2;
+        }
+
+        /**
+         * \brief The reification condition, as posted.
+         */
+        [[nodiscard]] auto reification_condition() const GCS_LIFETIME_BOUND -> const ReificationCondition &
+        {
+            return _cond;
+        }
+
+        ///@}
+
         virtual auto clone() const -> std::unique_ptr<Constraint> override;
         [[nodiscard]] virtual auto s_expr(const innards::ProofModel * const) const -> innards::SExpr override;
         [[nodiscard]] virtual auto constraint_type() const -> std::string override;
@@ -39,6 +39,14 @@ namespace gcs::innards
         std::vector<std::vector<std::uint32_t>> support;
         std::vector<long long> base;
         bool initialised = false;
+
+        /// Scratch for the variable positions a call must check, kept here so
+        /// that its storage is reused rather than allocated on every call.
+        std::vector<unsigned> positions_to_check;
+
+        /// Scratch for a copy of a domain that a call walks while removing
+        /// values from it, reused in the same way.
+        std::vector<Integer> values;
     };
 
     /**
@@ -73,6 +81,22 @@ namespace gcs::innards
     template <typename Hint_ = NoHint>
     auto propagate_extensional(
         const ExtensionalData &, const State &, auto & inference_tracker, innards::ProofLogger * const, const Hint_ & hint = {}) -> PropagatorState;
+
+    /**
+     * \brief Propagator for extensional constraints, doing only as much work
+     * as a DomainDelta says is needed.
+     *
+     * The delta's positions must be the table's variables, in order, followed
+     * by its selector, which is what a Triggers with exactly those in on_change
+     * gives. Selectable tuples are only checked against the variables that
+     * changed, and supports are only looked for again if some tuple has been
+     * lost. The inferences are the same as without the delta.
+     *
+     * \sa Table
+     */
+    template <typename Hint_>
+    auto propagate_extensional(const ExtensionalData &, const State &, auto & inference_tracker, innards::ProofLogger * const,
+        const DomainDelta & delta, const Hint_ & hint) -> PropagatorState;
 }
 
 #endif
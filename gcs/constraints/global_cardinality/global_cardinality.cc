@@ -28,7 +28,7 @@ using std::move;
 using std::pair;
 using std::unique_ptr;
 using std::vector;
-using std::ranges::binary_search;
+using std::ranges::lower_bound;
 using std::ranges::sort;
 
 GlobalCardinality::GlobalCardinality(vector<IntegerVariableID> vars, vector<Integer> values, vector<IntegerVariableID> counts) :
@@ -132,16 +132,20 @@ auto GlobalCardinality::install_propagators(Propagators & propagators) -> void
             constraint_id(),
             [vars = _vars, cover = sorted_cover, owner = constraint_id()](
                 const State & state, auto & inference, ProofLogger * const logger) -> PropagatorState {
+                vector<pair<Integer, Integer>> runs;
                 for (const auto & var : vars) {
-                    vector<pair<Integer, Integer>> runs;
-                    for (auto v : state.each_value_immutable(var)) {
-                        if (binary_search(cover, v))
-                            continue;
-                        if (! runs.empty() && runs.back().second + 1_i == v)
-                            runs.back().second = v;
-                        else
-                            runs.emplace_back(v, v);
-                    }
+                    // A whole domain interval at a time: the runs are what is left
+                    // of each interval once the cover values inside it are cut out.
+                    runs.clear();
+                    state.for_each_interval_immutable(var, [&](Integer lo, Integer hi) {
+                        for (auto c = lower_bound(cover, lo); c != cover.end() && *c <= hi; ++c) {
+                            if (lo < *c)
+                                runs.emplace_back(lo, *c - 1_i);
+                            lo = *c + 1_i;
+                        }
+                        if (lo <= hi)
+                            runs.emplace_back(lo, hi);
+                    });
                     for (const auto & [lo, hi] : runs)
                         inference.infer_not_in_range(logger, var, lo, hi, JustifyUsingRUP{hints::GlobalCardinality{owner}}, NoReason{});
                 }
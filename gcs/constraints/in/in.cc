@@ -286,7 +286,7 @@ auto In::install_propagators(Propagators & propagators) -> void
 
             return PropagatorState::Enable;
         },
-        triggers);
+        triggers, PropagatorCost::Unary);
 }
 
 auto In::constraint_type() const -> std::string
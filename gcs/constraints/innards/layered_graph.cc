@@ -0,0 +1,208 @@
+#include <gcs/constraints/innards/layered_graph.hh>
+
+#include <algorithm>
+#include <tuple>
+
+using namespace gcs;
+using namespace gcs::innards;
+
+using std::make_shared;
+using std::move;
+using std::pair;
+using std::size_t;
+using std::tie;
+using std::vector;
+using std::ranges::lower_bound;
+using std::ranges::sort;
+using std::ranges::unique;
+
+struct LayeredGraph::Structure
+{
+    size_t number_of_positions = 0;
+
+    // Nodes are numbered layer by layer: layer i holds the nodes from
+    // layer_start[i] up to layer_start[i + 1].
+    vector<size_t> layer_start, node_layer;
+
+    // Each position's values, sorted, are the slots from slot_start[i] up to
+    // slot_start[i + 1], and a slot's support is its count of live edges.
+    vector<size_t> slot_start;
+    vector<Integer> slot_value;
+
+    vector<size_t> edge_from, edge_to, edge_slot;
+
+    // The edges out of, into, and labelled with each node or slot, flattened:
+    // those of n are the entries from x_start[n] up to x_start[n + 1].
+    vector<size_t> out_start, out_edges, in_start, in_edges, slot_edges_start, slot_edges;
+
+    // Nodes that have died, but whose edges are yet to be removed.
+    vector<size_t> dying;
+
+    [[nodiscard]] auto is_interior(size_t node) const -> bool
+    {
+        return node_layer[node] > 0 && node_layer[node] < number_of_positions;
+    }
+
+    [[nodiscard]] auto slot_of(size_t position, Integer value) const -> size_t
+    {
+        auto first = slot_value.begin() + slot_start[position], last = slot_value.begin() + slot_start[position + 1];
+        auto it = lower_bound(first, last, value);
+        return (it == last || *it != value) ? slot_value.size() : static_cast<size_t>(it - slot_value.begin());
+    }
+};
+
+namespace
+{
+    auto flatten(size_t how_many, const vector<size_t> & owners) -> pair<vector<size_t>, vector<size_t>>
+    {
+        vector<size_t> start(how_many + 1, 0), entries(owners.size());
+        for (auto o : owners)
+            ++start[o + 1];
+        for (size_t n = 0; n < how_many; ++n)
+            start[n + 1] += start[n];
+        auto next = start;
+        for (size_t e = 0; e < owners.size(); ++e)
+            entries[next[owners[e]]++] = e;
+        return pair{move(start), move(entries)};
+    }
+}
+
+LayeredGraph::LayeredGraph(ReversibleTrail & trail, const vector<long> & nodes_per_layer, const vector<vector<Edge>> & edges,
+    const vector<long> & accepting) :
+    _structure(make_shared<Structure>())
+{
+    auto & s = *_structure;
+    s.number_of_positions = edges.size();
+
+    s.layer_start.push_back(0);
+    for (size_t i = 0; i < nodes_per_layer.size(); ++i) {
+        s.layer_start.push_back(s.layer_start.back() + static_cast<size_t>(nodes_per_layer[i]));
+        s.node_layer.resize(s.layer_start.back(), i);
+    }
+
+    s.slot_start.push_back(0);
+    for (const auto & layer : edges) {
+        vector<Integer> values;
+        for (const auto & edge : layer)
+            values.push_back(edge.value);
+        sort(values);
+        values.erase(unique(values).begin(), values.end());
+        s.slot_value.insert(s.slot_value.end(), values.begin(), values.end());
+        s.slot_start.push_back(s.slot_value.size());
+    }
+
+    for (size_t i = 0; i < edges.size(); ++i)
+        for (const auto & edge : edges[i]) {
+            s.edge_from.push_back(s.layer_start[i] + static_cast<size_t>(edge.from));
+            s.edge_to.push_back(s.layer_start[i + 1] + static_cast<size_t>(edge.to));
+            s.edge_slot.push_back(s.slot_of(i, edge.value));
+        }
+
+    auto number_of_nodes = s.node_layer.size();
+    tie(s.out_start, s.out_edges) = flatten(number_of_nodes, s.edge_from);
+    tie(s.in_start, s.in_edges) = flatten(number_of_nodes, s.edge_to);
+    tie(s.slot_edges_start, s.slot_edges) = flatten(s.slot_value.size(), s.edge_slot);
+
+    _alive = ReversibleBitset{trail, s.edge_from.size()};
+    for (size_t e = 0; e < s.edge_from.size(); ++e)
+        _alive.set(trail, e);
+    _in_degree = ReversibleVector<long long>{trail, number_of_nodes, 0};
+    _out_degree = ReversibleVector<long long>{trail, number_of_nodes, 0};
+    for (size_t n = 0; n < number_of_nodes; ++n) {
+        _in_degree.set(trail, n, static_cast<long long>(s.in_start[n + 1] - s.in_start[n]));
+        _out_degree.set(trail, n, static_cast<long long>(s.out_start[n + 1] - s.out_start[n]));
+    }
+    _support = ReversibleVector<long long>{trail, s.slot_value.size(), 0};
+    for (size_t slot = 0; slot < s.slot_value.size(); ++slot)
+        _support.set(trail, slot, static_cast<long long>(s.slot_edges_start[slot + 1] - s.slot_edges_start[slot]));
+
+    // Only the root starts a path, and only an accepting node ends one.
+    // Nothing is watching yet, so nobody needs telling what dies.
+    vector<pair<size_t, Integer>> lost_support;
+    vector<char> is_accepting(static_cast<size_t>(nodes_per_layer.back()), 0);
+    for (auto f : accepting)
+        is_accepting[static_cast<size_t>(f)] = 1;
+    for (size_t n = 0; n < number_of_nodes; ++n) {
+        auto not_a_start = s.node_layer[n] == 0 && n != 0;
+        auto not_an_end = s.node_layer[n] == s.number_of_positions && ! is_accepting[n - s.layer_start[s.number_of_positions]];
+        if (not_a_start || not_an_end) {
+            for (auto k = s.out_start[n]; k < s.out_start[n + 1]; ++k)
+                remove_edge(trail, s.out_edges[k], nullptr, lost_support);
+            for (auto k = s.in_start[n]; k < s.in_start[n + 1]; ++k)
+                remove_edge(trail, s.in_edges[k], nullptr, lost_support);
+        }
+        else if (s.is_interior(n) && (0 == _in_degree.get(trail, n) || 0 == _out_degree.get(trail, n)))
+            s.dying.push_back(n);
+    }
+    remove_dead_nodes(trail, nullptr, lost_support);
+}
+
+auto LayeredGraph::lose_degree(ReversibleTrail & trail, const ReversibleVector<long long> & degree, size_t node, const NodeDied & node_died) const
+    -> void
+{
+    auto & s = *_structure;
+    auto was_alive = ! s.is_interior(node) || (0 != _in_degree.get(trail, node) && 0 != _out_degree.get(trail, node));
+    auto now = degree.get(trail, node) - 1;
+    degree.set(trail, node, now);
+    if (was_alive && 0 == now && s.is_interior(node)) {
+        if (node_died)
+            node_died(s.node_layer[node], static_cast<long>(node - s.layer_start[s.node_layer[node]]));
+        s.dying.push_back(node);
+    }
+}
+
+auto LayeredGraph::remove_edge(ReversibleTrail & trail, size_t edge, const NodeDied & node_died, vector<pair<size_t, Integer>> & lost_support) const
+    -> void
+{
+    auto & s = *_structure;
+    if (! _alive.test(trail, edge))
+        return;
+    _alive.reset(trail, edge);
+
+    auto slot = s.edge_slot[edge];
+    auto support = _support.get(trail, slot) - 1;
+    _support.set(trail, slot, support);
+    if (0 == support)
+        lost_support.emplace_back(s.node_layer[s.edge_from[edge]], s.slot_value[slot]);
+
+    lose_degree(trail, _out_degree, s.edge_from[edge], node_died);
+    lose_degree(trail, _in_degree, s.edge_to[edge], node_died);
+}
+
+auto LayeredGraph::remove_dead_nodes(ReversibleTrail & trail, const NodeDied & node_died, vector<pair<size_t, Integer>> & lost_support) const
+    -> void
+{
+    auto & s = *_structure;
+    while (! s.dying.empty()) {
+        auto node = s.dying.back();
+        s.dying.pop_back();
+        for (auto k = s.out_start[node]; k < s.out_start[node + 1]; ++k)
+            remove_edge(trail, s.out_edges[k], node_died, lost_support);
+        for (auto k = s.in_start[node]; k < s.in_start[node + 1]; ++k)
+            remove_edge(trail, s.in_edges[k], node_died, lost_support);
+    }
+}
+
+auto LayeredGraph::number_of_positions() const -> size_t
+{
+    return _structure->number_of_positions;
+}
+
+auto LayeredGraph::remove_values_not_in_domain(ReversibleTrail & trail, const State & state, size_t position, const IntegerVariableID & var,
+    const NodeDied & node_died, vector<pair<size_t, Integer>> & lost_support) const -> void
+{
+    auto & s = *_structure;
+    for (auto slot = s.slot_start[position]; slot < s.slot_start[position + 1]; ++slot) {
+        if (0 == _support.get(trail, slot) || state.in_domain(var, s.slot_value[slot]))
+            continue;
+        for (auto k = s.slot_edges_start[slot]; k < s.slot_edges_start[slot + 1]; ++k)
+            remove_edge(trail, s.slot_edges[k], node_died, lost_support);
+    }
+    remove_dead_nodes(trail, node_died, lost_support);
+}
+
+auto LayeredGraph::supported(const ReversibleTrail & trail, size_t position, Integer value) const -> bool
+{
+    auto slot = _structure->slot_of(position, value);
+    return slot != _structure->slot_value.size() && 0 != _support.get(trail, slot);
+}
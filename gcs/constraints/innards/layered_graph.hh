@@ -0,0 +1,115 @@
+#ifndef GLASGOW_CONSTRAINT_SOLVER_GUARD_GCS_CONSTRAINTS_INNARDS_LAYERED_GRAPH_HH
+#define GLASGOW_CONSTRAINT_SOLVER_GUARD_GCS_CONSTRAINTS_INNARDS_LAYERED_GRAPH_HH
+
+#include <gcs/innards/reversible.hh>
+#include <gcs/innards/state.hh>
+#include <gcs/integer.hh>
+#include <gcs/variable_id.hh>
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <utility>
+#include <vector>
+
+/**
+ * \file
+ *
+ * The unrolled support graph shared by Regular, RegularBacchus and MDD: one
+ * layer of nodes per position, plus a final one, with an edge labelled v from
+ * node q in layer i to node q' in layer i + 1 whenever reading v in q can lead
+ * to q'. A value keeps its support at a position for as long as some edge
+ * labelled with it lies on a path from the root to an accepting node.
+ */
+
+namespace gcs::innards
+{
+    /**
+     * \brief A layered support graph whose edge set and node degrees are
+     * kept in the ReversibleTrail, so a search node costs only the edges it
+     * removes, rather than a copy of the whole graph.
+     *
+     * The edges are fixed when the graph is built, from the domains at that
+     * point, and everything not on a path from the root (node 0 of layer 0)
+     * to an accepting node of the last layer is removed straight away. After
+     * that, removing the edges labelled with a value that has left its
+     * variable's domain cascades: a node between the first and last layers
+     * that loses all of its in-edges or all of its out-edges dies, taking the
+     * rest of its edges with it.
+     *
+     * A handle, like the reversible primitives it is built from: copies share
+     * the same graph. Its scratch space is not shared between threads, so
+     * each search worker needs its own, which prepare() gives it.
+     *
+     * \ingroup Innards
+     */
+    class LayeredGraph final
+    {
+    public:
+        /**
+         * \brief An edge out of layer i, from node `from` of layer i to node
+         * `to` of layer i + 1, labelled with `value`.
+         */
+        struct Edge
+        {
+            long from;
+            Integer value;
+            long to;
+        };
+
+        /**
+         * \brief Called with the layer and node of each node as it dies, and
+         * before any of its remaining edges is removed.
+         */
+        using NodeDied = std::function<auto(std::size_t layer, long node)->void>;
+
+    private:
+        struct Structure;
+        std::shared_ptr<Structure> _structure;
+        ReversibleBitset _alive;
+        ReversibleVector<long long> _in_degree, _out_degree, _support;
+
+        auto remove_edge(ReversibleTrail &, std::size_t edge, const NodeDied &, std::vector<std::pair<std::size_t, Integer>> &) const -> void;
+        auto lose_degree(ReversibleTrail &, const ReversibleVector<long long> &, std::size_t node, const NodeDied &) const -> void;
+        auto remove_dead_nodes(ReversibleTrail &, const NodeDied &, std::vector<std::pair<std::size_t, Integer>> &) const -> void;
+
+    public:
+        LayeredGraph() = default;
+
+        /**
+         * \brief Build the graph, with nodes_per_layer[i] nodes in layer i
+         * (one more layer than there are positions), edges[i] the edges out
+         * of layer i, and accepting the nodes of the last layer that a path
+         * may end at.
+         *
+         * Must be called outside of search, so that the pruning it does to
+         * reach a consistent starting point is permanent.
+         */
+        explicit LayeredGraph(ReversibleTrail &, const std::vector<long> & nodes_per_layer, const std::vector<std::vector<Edge>> & edges,
+            const std::vector<long> & accepting);
+
+        /**
+         * \brief How many positions, which is one fewer than the number of
+         * layers of nodes.
+         */
+        [[nodiscard]] auto number_of_positions() const -> std::size_t;
+
+        /**
+         * \brief Remove every edge out of this layer that is labelled with a
+         * value no longer in var's domain, and everything that then lies on
+         * no accepting path. Each value at any position that loses its last
+         * edge is appended to lost_support, whether or not it is still in its
+         * variable's domain.
+         */
+        auto remove_values_not_in_domain(ReversibleTrail &, const State &, std::size_t position, const IntegerVariableID & var,
+            const NodeDied &, std::vector<std::pair<std::size_t, Integer>> & lost_support) const -> void;
+
+        /**
+         * \brief Does some edge out of this layer that is labelled with this
+         * value still lie on an accepting path?
+         */
+        [[nodiscard]] auto supported(const ReversibleTrail &, std::size_t position, Integer value) const -> bool;
+    };
+}
+
+#endif
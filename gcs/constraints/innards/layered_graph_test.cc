@@ -0,0 +1,70 @@
+#include <gcs/constraints/innards/layered_graph.hh>
+#include <gcs/innards/state.hh>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+using namespace gcs;
+using namespace gcs::innards;
+
+using std::pair;
+using std::size_t;
+using std::vector;
+
+namespace
+{
+    // Two positions over {0, 1}: the root goes to node 0 on 0 and to node 1 on
+    // 1, then node 0 reads 0 and node 1 reads 1 to reach the accepting node. So
+    // the accepted words are 00 and 11, and node 2 of the middle layer, which
+    // has no way in, is dead from the start.
+    auto make_graph(State & state) -> LayeredGraph
+    {
+        return LayeredGraph{state.reversible_trail(), vector<long>{1, 3, 1},
+            vector<vector<LayeredGraph::Edge>>{
+                {{0, 0_i, 0}, {0, 1_i, 1}},
+                {{0, 0_i, 0}, {1, 1_i, 0}, {2, 0_i, 0}}},
+            vector<long>{0}};
+    }
+}
+
+TEST_CASE("Layered graph removes values, cascades, and backtracks")
+{
+    for (auto mode : {BacktrackingMode::CopyEveryEpoch, BacktrackingMode::Trail}) {
+        State state;
+        state.set_backtracking_mode(mode);
+        auto x = state.allocate_integer_variable_with_state(0_i, 1_i);
+        auto y = state.allocate_integer_variable_with_state(0_i, 1_i);
+        auto graph = make_graph(state);
+        auto & trail = state.reversible_trail();
+
+        CHECK(graph.number_of_positions() == 2);
+        CHECK(graph.supported(trail, 0, 0_i));
+        CHECK(graph.supported(trail, 1, 0_i));
+        CHECK(! graph.supported(trail, 0, 2_i));
+
+        auto timestamp = state.new_epoch();
+        CHECK(state.infer_not_equal(x, 0_i) == Inference::Instantiated);
+
+        vector<pair<size_t, long>> died;
+        vector<pair<size_t, Integer>> lost_support;
+        graph.remove_values_not_in_domain(
+            trail, state, 0, x, [&](size_t layer, long node) { died.emplace_back(layer, node); }, lost_support);
+
+        CHECK(died == vector<pair<size_t, long>>{{1, 0}});
+        CHECK(lost_support == vector<pair<size_t, Integer>>{{0, 0_i}, {1, 0_i}});
+        CHECK(! graph.supported(trail, 1, 0_i));
+        CHECK(graph.supported(trail, 1, 1_i));
+
+        // Nothing else is out of its domain, so nothing more goes.
+        lost_support.clear();
+        graph.remove_values_not_in_domain(trail, state, 1, y, nullptr, lost_support);
+        CHECK(lost_support.empty());
+
+        state.backtrack(timestamp);
+        CHECK(graph.supported(trail, 0, 0_i));
+        CHECK(graph.supported(trail, 1, 0_i));
+    }
+}
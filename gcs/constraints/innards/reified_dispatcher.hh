@@ -113,12 +113,13 @@ namespace gcs::innards
      * usable from `install_propagators()`, which has no `initial_state`.
      *
      * If `initial_evaluated` is Deactivated, no propagator is installed.
+     * Otherwise the propagator is installed with the given PropagatorCost.
      */
     template <typename EnforceMustHold_, typename EnforceMustNotHold_, typename InferCondWhenUndecided_>
     auto install_reified_dispatcher(Propagators & propagators, const ConstraintID & constraint_id,
         const EvaluatedReificationCondition & initial_evaluated, const ReificationCondition & reif_cond, Triggers triggers,
         EnforceMustHold_ enforce_constraint_must_hold, EnforceMustNotHold_ enforce_constraint_must_not_hold,
-        InferCondWhenUndecided_ infer_cond_when_undecided) -> void
+        InferCondWhenUndecided_ infer_cond_when_undecided, PropagatorCost cost = PropagatorCost::Linear) -> void
     {
         if (std::holds_alternative<evaluated_reif::Deactivated>(initial_evaluated))
             return;
@@ -143,7 +144,7 @@ namespace gcs::innards
                 [enforce_constraint_must_hold = std::move(enforce_constraint_must_hold),
                     cond = std::get<evaluated_reif::MustHold>(initial_evaluated).cond](const State & state, auto & inference,
                     ProofLogger * const logger) -> PropagatorState { return enforce_constraint_must_hold(state, inference, logger, cond); },
-                triggers);
+                triggers, cost);
             return;
         }
         if (std::holds_alternative<evaluated_reif::MustNotHold>(initial_evaluated)) {
@@ -152,7 +153,7 @@ namespace gcs::innards
                 [enforce_constraint_must_not_hold = std::move(enforce_constraint_must_not_hold),
                     cond = std::get<evaluated_reif::MustNotHold>(initial_evaluated).cond](const State & state, auto & inference,
                     ProofLogger * const logger) -> PropagatorState { return enforce_constraint_must_not_hold(state, inference, logger, cond); },
-                triggers);
+                triggers, cost);
             return;
         }
 
@@ -206,7 +207,7 @@ namespace gcs::innards
                 }
                     .visit(test_reification_condition(state, reif_cond));
             },
-            triggers);
+            triggers, cost);
     }
 }
 
@@ -24,7 +24,6 @@
 #endif
 
 #include <algorithm>
-#include <any>
 #include <list>
 #include <map>
 #include <optional>
@@ -37,7 +36,6 @@
 using namespace gcs;
 using namespace gcs::innards;
 
-using std::any_cast;
 using std::list;
 using std::make_shared;
 using std::make_unique;
@@ -54,6 +52,7 @@ using std::stringstream;
 using std::unique_ptr;
 using std::unordered_map;
 using std::vector;
+using std::ranges::lower_bound;
 using std::ranges::minmax_element;
 using std::ranges::none_of;
 
@@ -79,6 +78,13 @@ namespace
     {
         vector<vector<vector<Integer>>> nodes_at;
         vector<set<vector<Integer>>> node_set;
+        // first_node[i] numbers the nodes of layers before i, so that
+        // first_node[i] + p names position p of nodes_at[i].
+        vector<size_t> first_node;
+        // The values coordinate x takes over layer n, sorted, numbered from
+        // first_final_coord[x] on.
+        vector<vector<long long>> final_coords;
+        vector<size_t> first_final_coord;
     };
 
     struct CoordFlags
@@ -159,6 +165,16 @@ namespace
                 dag.nodes_at[i].push_back(w);
             std::ranges::sort(dag.nodes_at[i]);
             dag.node_set[i].insert(dag.nodes_at[i].begin(), dag.nodes_at[i].end());
+            dag.first_node.push_back(i == 0 ? 0 : dag.first_node.back() + dag.nodes_at[i - 1].size());
+        }
+
+        dag.final_coords.assign(coeffs.size(), {});
+        for (size_t x = 0; x < coeffs.size(); ++x) {
+            for (const auto & w : dag.nodes_at[n])
+                dag.final_coords[x].push_back(w[x].raw_value);
+            std::ranges::sort(dag.final_coords[x]);
+            dag.final_coords[x].erase(std::ranges::unique(dag.final_coords[x]).begin(), dag.final_coords[x].end());
+            dag.first_final_coord.push_back(x == 0 ? 0 : dag.first_final_coord.back() + dag.final_coords[x - 1].size());
         }
         return dag;
     }
@@ -533,14 +549,46 @@ namespace
     // shallower than the current search depth" cache. Promoting those
     // pure dead-state lines to ProofLevel::Current and skipping their
     // re-emission collapses what would otherwise be hundreds of repeats
-    // per state across the proof.
+    // per state across the proof. One reversible bit per DAG node, and one
+    // per layer-n coordinate value for g_dn, so a search node pays only for
+    // the words it sets, not for a copy of the whole cache.
     struct DeadCache
     {
-        // dead_states[i] = layer-i state vectors already emitted as dead.
-        vector<set<vector<Integer>>> dead_states;
-        // dead_g_dn[i][x] = (layer, coord) values whose g_dn flag is known
-        // to be false (only populated for layer n at the lower-bound filter).
-        vector<vector<set<long long>>> dead_g_dn;
+        const Dag & dag;
+        const ReversibleBitset & dead_states;
+        const ReversibleBitset & dead_g_dn;
+        ReversibleTrail & trail;
+
+        [[nodiscard]] auto bit_of(size_t i, const vector<Integer> & w) const -> size_t
+        {
+            return dag.first_node[i] + static_cast<size_t>(lower_bound(dag.nodes_at[i], w) - dag.nodes_at[i].begin());
+        }
+
+        [[nodiscard]] auto g_dn_bit_of(size_t x, long long coord) const -> size_t
+        {
+            return dag.first_final_coord[x] + static_cast<size_t>(lower_bound(dag.final_coords[x], coord) - dag.final_coords[x].begin());
+        }
+
+        [[nodiscard]] auto contains(size_t i, const vector<Integer> & w) const -> bool
+        {
+            return dead_states.test(trail, bit_of(i, w));
+        }
+
+        auto insert(size_t i, const vector<Integer> & w) -> void
+        {
+            dead_states.set(trail, bit_of(i, w));
+        }
+
+        // Only layer n's g_dn lines are cached.
+        [[nodiscard]] auto contains_g_dn(size_t x, long long coord) const -> bool
+        {
+            return dead_g_dn.test(trail, g_dn_bit_of(x, coord));
+        }
+
+        auto insert_g_dn(size_t x, long long coord) -> void
+        {
+            dead_g_dn.set(trail, g_dn_bit_of(x, coord));
+        }
     };
 
     // Per-call full GAC propagation, with proof emission when proofs are
@@ -642,7 +690,7 @@ namespace
                 for (const auto & w : dag.nodes_at[i + 1]) {
                     if (growing.contains(w))
                         continue;
-                    if (cache.dead_states[i + 1].contains(w))
+                    if (cache.contains(i + 1, w))
                         continue;
 
                     optional<size_t> cap_coord;
@@ -663,7 +711,7 @@ namespace
 
                     ProofFlag s_flag = flags.state_flags[i + 1].at(w);
                     logger->emit_rup_proof_line_under_reason(eager_reason(reason, state), WPBSum{} + 1_i * ! s_flag >= 1_i, ProofLevel::Current);
-                    cache.dead_states[i + 1].insert(w);
+                    cache.insert(i + 1, w);
                 }
             }
 
@@ -688,8 +736,8 @@ namespace
             for (size_t x = 0; x < k; ++x) {
                 if (it->first[x] < state.lower_bound(totals[x])) {
                     if (emitting) {
-                        bool need_s = ! cache.dead_states[n].contains(it->first);
-                        bool need_g_dn = ! cache.dead_g_dn[n][x].contains(it->first[x].raw_value);
+                        bool need_s = ! cache.contains(n, it->first);
+                        bool need_g_dn = ! cache.contains_g_dn(x, it->first[x].raw_value);
                         if (need_s || need_g_dn) {
                             const auto & cf = flags.per_coord_flags[n][x].at(it->first[x].raw_value);
                             PolBuilder b;
@@ -699,13 +747,13 @@ namespace
                             if (need_g_dn) {
                                 logger->emit_rup_proof_line_under_reason(
                                     eager_reason(reason, state), WPBSum{} + 1_i * ! cf.g_dn >= 1_i, ProofLevel::Current);
-                                cache.dead_g_dn[n][x].insert(it->first[x].raw_value);
+                                cache.insert_g_dn(x, it->first[x].raw_value);
                             }
                             if (need_s) {
                                 ProofFlag s_flag = flags.state_flags[n].at(it->first);
                                 logger->emit_rup_proof_line_under_reason(
                                     eager_reason(reason, state), WPBSum{} + 1_i * ! s_flag >= 1_i, ProofLevel::Current);
-                                cache.dead_states[n].insert(it->first);
+                                cache.insert(n, it->first);
                             }
                         }
                     }
@@ -725,7 +773,7 @@ namespace
             bool eliminated = false;
             for (size_t x = 0; x < k; ++x) {
                 if (! state.in_domain(totals[x], it->first[x])) {
-                    if (emitting && ! cache.dead_states[n].contains(it->first)) {
+                    if (emitting && ! cache.contains(n, it->first)) {
                         ProofFlag s_flag = flags.state_flags[n].at(it->first);
                         const auto & cf = flags.per_coord_flags[n][x].at(it->first[x].raw_value);
                         PolBuilder{}.add(cf.g_dn_fwd).add(opb_lines[x].second).emit(*logger, ProofLevel::Temporary);
@@ -733,7 +781,7 @@ namespace
                         logger->emit_rup_proof_line_under_reason(
                             eager_reason(reason, state), WPBSum{} + 1_i * ! s_flag + 1_i * (totals[x] == it->first[x]) >= 1_i, ProofLevel::Temporary);
                         logger->emit_rup_proof_line_under_reason(eager_reason(reason, state), WPBSum{} + 1_i * ! s_flag >= 1_i, ProofLevel::Current);
-                        cache.dead_states[n].insert(it->first);
+                        cache.insert(n, it->first);
                     }
                     completed_layers.back().erase(it++);
                     eliminated = true;
@@ -811,10 +859,10 @@ namespace
                 if (reached.contains(it->first))
                     ++it;
                 else {
-                    if (emitting && ! cache.dead_states[var_number].contains(it->first)) {
+                    if (emitting && ! cache.contains(var_number, it->first)) {
                         ProofFlag s_flag = flags.state_flags[var_number].at(it->first);
                         logger->emit_rup_proof_line_under_reason(eager_reason(reason, state), WPBSum{} + 1_i * ! s_flag >= 1_i, ProofLevel::Current);
-                        cache.dead_states[var_number].insert(it->first);
+                        cache.insert(var_number, it->first);
                     }
                     next(layer)->erase(it++);
                 }
@@ -838,6 +886,7 @@ namespace
         Dag dag;
         Flags flags;
         vector<pair<ProofLine, ProofLine>> opb_lines;
+        ReversibleBitset dead_states, dead_g_dn;
     };
 }
 
@@ -849,7 +898,6 @@ struct gcs::innards::KnapsackUpfrontData
     vector<IntegerVariableID> vars;
     vector<IntegerVariableID> totals;
     shared_ptr<KnapsackUpfrontBridge> bridge;
-    ConstraintStateHandle dead_cache;
 };
 
 auto gcs::innards::knapsack_upfront_prepare(State & initial_state, vector<vector<Integer>> coeffs, vector<IntegerVariableID> vars,
@@ -888,11 +936,11 @@ auto gcs::innards::knapsack_upfront_prepare(State & initial_state, vector<vector
     // already emitted at or above the current search depth, so the
     // per-call propagator can skip the entire pol+RUP scaffolding for
     // a state that's already been proven dead in this subtree.
-    DeadCache initial_cache{
-        vector<set<vector<Integer>>>(vars.size() + 1), vector<vector<set<long long>>>(vars.size() + 1, vector<set<long long>>(totals.size()))};
-    auto dead_cache_handle = initial_state.add_constraint_state(move(initial_cache));
+    const auto & dag = bridge->dag;
+    bridge->dead_states = ReversibleBitset{initial_state.reversible_trail(), dag.first_node.back() + dag.nodes_at.back().size()};
+    bridge->dead_g_dn = ReversibleBitset{initial_state.reversible_trail(), dag.first_final_coord.back() + dag.final_coords.back().size()};
 
-    return make_shared<KnapsackUpfrontData>(move(coeffs), move(vars), move(totals), move(bridge), dead_cache_handle);
+    return make_shared<KnapsackUpfrontData>(move(coeffs), move(vars), move(totals), move(bridge));
 }
 
 auto gcs::innards::knapsack_upfront_define_proof_model(ProofModel & model, const ConstraintID & owner, KnapsackUpfrontData & data) -> void
@@ -919,7 +967,6 @@ auto gcs::innards::knapsack_upfront_install_propagators(
     auto coeffs = data->coeffs;
     auto totals = data->totals;
     auto bridge = data->bridge;
-    auto dead_cache_handle = data->dead_cache;
 
     Triggers triggers;
     triggers.on_change = {vars.begin(), vars.end()};
@@ -945,9 +992,9 @@ auto gcs::innards::knapsack_upfront_install_propagators(
 
     propagators.install(
         owner,
-        [vars = move(vars), coeffs = move(coeffs), totals = move(totals), bridge, dead_cache_handle, owner](
+        [vars = move(vars), coeffs = move(coeffs), totals = move(totals), bridge, owner](
             const State & state, auto & inference, ProofLogger * const logger) -> PropagatorState {
-            auto & cache = any_cast<DeadCache &>(state.get_constraint_state(dead_cache_handle));
+            DeadCache cache{bridge->dag, bridge->dead_states, bridge->dead_g_dn, state.reversible_trail()};
             propagate(state, inference, logger, owner, vars, coeffs, totals, bridge->dag, bridge->flags, bridge->opb_lines, cache);
             return PropagatorState::Enable;
         },
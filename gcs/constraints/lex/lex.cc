@@ -28,7 +28,6 @@
 #include <fmt/ostream.h>
 #endif
 
-using std::any_cast;
 using std::get;
 using std::make_shared;
 using std::min;
@@ -56,11 +55,6 @@ using namespace gcs::innards;
 
 namespace
 {
-    struct LexState
-    {
-        size_t alpha = 0;
-    };
-
     // One propagation pass enforcing vars_1 (>|>=)_lex vars_2. This is the
     // forward direction from the propagator's point of view; for backward
     // (negation) propagation, callers swap vars_1/vars_2 and flip or_equal.
@@ -74,7 +68,7 @@ namespace
     // enough?".
     auto run_lex_pass(const State & state, auto & inference, ProofLogger * const logger, const vector<IntegerVariableID> & vars_1,
         const vector<IntegerVariableID> & vars_2, bool or_equal, const shared_ptr<vector<optional<ProofFlag>>> & prefix_equal_flags,
-        const shared_ptr<vector<ProofFlag>> & decision_at_flags, const Literal & cond, ConstraintStateHandle state_handle, const ConstraintID & owner)
+        const shared_ptr<vector<ProofFlag>> & decision_at_flags, const Literal & cond, Reversible<size_t> alpha_state, const ConstraintID & owner)
         -> PropagatorState
     {
         auto n1 = vars_1.size();
@@ -82,8 +76,8 @@ namespace
         auto n = min(n1, n2);
         bool equal_prefix_satisfies = (n1 > n2) || (or_equal && n1 == n2);
 
-        auto & lex_state = any_cast<LexState &>(state.get_constraint_state(state_handle));
-        auto alpha = lex_state.alpha;
+        auto & trail = state.reversible_trail();
+        auto alpha = alpha_state.get(trail);
 
         // Advance alpha through any newly-forced-equal positions. No
         // inferences happen here: those positions had vars_1[k] = vars_2[k]
@@ -108,7 +102,7 @@ namespace
         // and vars_1-strictly-longer is satisfied (longer wins). Otherwise
         // (strict same-length, or vars_1-shorter) it's infeasible.
         if (alpha == n) {
-            lex_state.alpha = alpha;
+            alpha_state.set(trail, alpha);
             if (equal_prefix_satisfies)
                 return PropagatorState::DisableUntilBacktrack;
 
@@ -215,7 +209,7 @@ namespace
             }
         }
 
-        lex_state.alpha = alpha;
+        alpha_state.set(trail, alpha);
 
         return strict_forced ? PropagatorState::DisableUntilBacktrack : PropagatorState::Enable;
     }
@@ -474,7 +468,7 @@ auto LexCompareGreaterThanOrMaybeEqual::clone() const -> unique_ptr<Constraint>
 auto LexCompareGreaterThanOrMaybeEqual::prepare(Propagators &, State & initial_state, ProofModel * const) -> bool
 {
     _evaluated_cond = test_reification_condition(initial_state, _reif_cond);
-    _state_handle = initial_state.add_constraint_state(LexState{});
+    _alpha = Reversible<size_t>{initial_state.reversible_trail(), 0};
     return true;
 }
 
@@ -550,20 +544,20 @@ auto LexCompareGreaterThanOrMaybeEqual::install_propagators(Propagators & propag
         triggers.on_bounds.push_back(v);
 
     auto enforce_constraint_must_hold = [vars_1 = _vars_1, vars_2 = _vars_2, or_equal, prefix_equal_gt_flags = _prefix_equal_gt_flags,
-                                            decision_at_gt_flags = _decision_at_gt_flags, state_handle = _state_handle,
+                                            decision_at_gt_flags = _decision_at_gt_flags, alpha = _alpha,
                                             owner = constraint_id()](const State & state, auto & inference, ProofLogger * const logger,
                                             const Literal & cond) -> PropagatorState {
         return run_lex_pass(
-            state, inference, logger, vars_1, vars_2, or_equal, prefix_equal_gt_flags, decision_at_gt_flags, cond, state_handle, owner);
+            state, inference, logger, vars_1, vars_2, or_equal, prefix_equal_gt_flags, decision_at_gt_flags, cond, alpha, owner);
     };
 
     auto enforce_constraint_must_not_hold = [vars_1 = _vars_1, vars_2 = _vars_2, or_equal, prefix_equal_lt_flags = _prefix_equal_lt_flags,
-                                                decision_at_lt_flags = _decision_at_lt_flags, state_handle = _state_handle,
+                                                decision_at_lt_flags = _decision_at_lt_flags, alpha = _alpha,
                                                 owner = constraint_id()](const State & state, auto & inference, ProofLogger * const logger,
                                                 const Literal & cond) -> PropagatorState {
         // Negation: enforce vars_2 (>|>=) vars_1 with or_equal flipped.
         return run_lex_pass(
-            state, inference, logger, vars_2, vars_1, ! or_equal, prefix_equal_lt_flags, decision_at_lt_flags, cond, state_handle, owner);
+            state, inference, logger, vars_2, vars_1, ! or_equal, prefix_equal_lt_flags, decision_at_lt_flags, cond, alpha, owner);
     };
 
     auto infer_cond_when_undecided = [vars_1 = move(_vars_1), vars_2 = move(_vars_2), or_equal, prefix_equal_gt_flags = _prefix_equal_gt_flags,
@@ -9,6 +9,7 @@
 #include <gcs/reification.hh>
 #include <gcs/variable_id.hh>
 
+#include <cstddef>
 #include <memory>
 #include <optional>
 #include <vector>
@@ -33,7 +34,7 @@ namespace gcs
      *
      * Uses a stateful propagator that maintains the leftmost not-yet-
      * forced-equal position alpha across calls (restored on backtrack via
-     * State::add_constraint_state). At each call: advance alpha through any
+     * State::reversible_trail()). At each call: advance alpha through any
      * newly-fixed-equal prefix, tighten vars_1[alpha] >= vars_2[alpha], then
      * scan from alpha+1 looking for either a position where strict-greater
      * is feasible (a candidate witness) or a position whose bounds prevent
@@ -85,7 +86,7 @@ namespace gcs
         bool _or_equal;
         bool _vars_swapped;
         innards::EvaluatedReificationCondition _evaluated_cond = innards::evaluated_reif::Deactivated{};
-        innards::ConstraintStateHandle _state_handle;
+        innards::Reversible<std::size_t> _alpha;
         std::shared_ptr<std::vector<std::optional<innards::ProofFlag>>> _prefix_equal_gt_flags;
         std::shared_ptr<std::vector<innards::ProofFlag>> _decision_at_gt_flags;
         std::shared_ptr<std::vector<std::optional<innards::ProofFlag>>> _prefix_equal_lt_flags;
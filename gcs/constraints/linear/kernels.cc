@@ -0,0 +1,127 @@
+#include <gcs/constraints/linear/kernels.hh>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <optional>
+#include <span>
+#include <utility>
+
+using std::nullopt;
+using std::optional;
+using std::pair;
+using std::size_t;
+using std::span;
+using std::uint8_t;
+
+using namespace gcs;
+using namespace gcs::innards;
+
+// Runtime dispatch needs ifunc support, which means an ELF target, and the
+// attribute is GCC and Clang syntax. Anywhere else, the kernels are built once,
+// for whatever the build targets, and the compiler vectorises them as it can.
+#if defined(__x86_64__) && defined(__ELF__) && (defined(__GNUC__) || defined(__clang__))
+#define GCS_LINEAR_KERNEL __attribute__((target_clones("avx512f", "avx2", "default")))
+#else
+#define GCS_LINEAR_KERNEL
+#endif
+
+namespace
+{
+    // Every coefficient and bound must be less than 2^24 in magnitude, and
+    // there must be at most 2^14 terms, so that the sum is less than 2^62 in
+    // magnitude. With the constant, and any fixed part of the sum, less than
+    // 2^60, no remainder propagate_linear() computes from these can overflow
+    // either.
+    constexpr unsigned long long magnitude_limit = 1ull << 24;
+    constexpr size_t terms_limit = 1ull << 14;
+    constexpr long long value_limit = 1ll << 60;
+
+    // 1 if v is outside (-magnitude_limit, magnitude_limit), otherwise 0,
+    // without a branch or any signed overflow. This is a word rather than a
+    // bool so that or-ing it into an accumulator vectorises.
+    inline auto out_of_range(long long v) -> unsigned long long
+    {
+        return static_cast<unsigned long long>(v) + (magnitude_limit - 1) > 2 * (magnitude_limit - 1);
+    }
+
+    GCS_LINEAR_KERNEL auto unit_sum(const pair<Integer, Integer> * bounds, size_t n, bool upper, unsigned long long & sum) -> bool
+    {
+        unsigned long long s = 0, bad = 0;
+        for (size_t i = 0; i < n; ++i) {
+            auto b = upper ? bounds[i].second.raw_value : bounds[i].first.raw_value;
+            bad |= out_of_range(bounds[i].first.raw_value) | out_of_range(bounds[i].second.raw_value);
+            s += static_cast<unsigned long long>(b);
+        }
+        sum = s;
+        return ! bad;
+    }
+
+    GCS_LINEAR_KERNEL auto weighted_sum(const long long * coeffs, const pair<Integer, Integer> * bounds, size_t n, bool upper,
+        unsigned long long & sum) -> bool
+    {
+        unsigned long long s = 0, bad = 0;
+        for (size_t i = 0; i < n; ++i) {
+            auto c = coeffs[i];
+            auto lo = bounds[i].first.raw_value, hi = bounds[i].second.raw_value;
+            bad |= out_of_range(c) | out_of_range(lo) | out_of_range(hi);
+            auto b = ((c >= 0) != upper) ? lo : hi;
+            s += static_cast<unsigned long long>(c) * static_cast<unsigned long long>(b);
+        }
+        sum = s;
+        return ! bad;
+    }
+
+    GCS_LINEAR_KERNEL auto unit_exceeding(const pair<Integer, Integer> * bounds, size_t n, long long slack, uint8_t * result) -> void
+    {
+        for (size_t i = 0; i < n; ++i)
+            result[i] = (bounds[i].second.raw_value - bounds[i].first.raw_value) > slack;
+    }
+
+    GCS_LINEAR_KERNEL auto weighted_exceeding(const long long * coeffs, const pair<Integer, Integer> * bounds, size_t n, long long slack,
+        uint8_t * result) -> void
+    {
+        for (size_t i = 0; i < n; ++i) {
+            auto c = coeffs[i];
+            auto magnitude = c >= 0 ? c : -c;
+            result[i] = (0 == c) | (magnitude * (bounds[i].second.raw_value - bounds[i].first.raw_value) > slack);
+        }
+    }
+}
+
+auto gcs::innards::linear_kernel_min_terms() -> size_t
+{
+    static const size_t min_terms = []() -> size_t {
+        if (const char * e = std::getenv("GCS_LINEAR_KERNEL_MIN_TERMS"))
+            return std::strtoull(e, nullptr, 10);
+        return 16;
+    }();
+    return min_terms;
+}
+
+auto gcs::innards::linear_bound_sum(span<const long long> coeffs, span<const pair<Integer, Integer>> bounds, bool upper) -> optional<Integer>
+{
+    if (bounds.size() > terms_limit)
+        return nullopt;
+
+    unsigned long long sum;
+    bool ok = coeffs.empty() ? unit_sum(bounds.data(), bounds.size(), upper, sum)
+                             : weighted_sum(coeffs.data(), bounds.data(), bounds.size(), upper, sum);
+    if (! ok)
+        return nullopt;
+    return Integer{static_cast<long long>(sum)};
+}
+
+auto gcs::innards::linear_terms_exceeding_slack(span<const long long> coeffs, span<const pair<Integer, Integer>> bounds, Integer slack,
+    span<uint8_t> result) -> void
+{
+    if (coeffs.empty())
+        unit_exceeding(bounds.data(), bounds.size(), slack.raw_value, result.data());
+    else
+        weighted_exceeding(coeffs.data(), bounds.data(), bounds.size(), slack.raw_value, result.data());
+}
+
+auto gcs::innards::linear_kernel_accepts_value(Integer value) -> bool
+{
+    return value.raw_value > -value_limit && value.raw_value < value_limit;
+}
@@ -0,0 +1,73 @@
+#ifndef GLASGOW_CONSTRAINT_SOLVER_GUARD_GCS_CONSTRAINTS_LINEAR_KERNELS_HH
+#define GLASGOW_CONSTRAINT_SOLVER_GUARD_GCS_CONSTRAINTS_LINEAR_KERNELS_HH
+
+#include <gcs/integer.hh>
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <utility>
+
+namespace gcs::innards
+{
+    /**
+     * \brief Rows with fewer terms than this are not handed to the linear
+     * kernels: gathering their coefficients would cost more than the checked
+     * scalar loop it saves.
+     *
+     * The default of 16 can be overridden by the GCS_LINEAR_KERNEL_MIN_TERMS
+     * environment variable, which is how benchmarks compare the two paths (a
+     * huge value turns the kernels off).
+     *
+     * \ingroup Innards
+     */
+    [[nodiscard]] auto linear_kernel_min_terms() -> std::size_t;
+
+    /**
+     * \brief The least (or, if `upper`, the greatest) value that the sum of
+     * `coeffs[i] * x_i` can take, given the bounds of each `x_i`, or nullopt if
+     * the fast path cannot be sure that no partial sum overflows.
+     *
+     * An empty `coeffs` means every coefficient is 1. The sum is accumulated
+     * unchecked, in wrapping unsigned arithmetic so the loop vectorises, and
+     * instead every coefficient and bound is checked once to be small enough
+     * that neither the sum nor anything propagate_linear() derives from it
+     * can overflow. When that check fails, the caller must fall back to the
+     * checked Integer arithmetic, which throws on a genuine overflow just as
+     * it always has. On x86-64 with GCC or Clang, the kernel is compiled for
+     * AVX-512, AVX2 and the baseline, and picked at load time by CPU.
+     *
+     * \ingroup Innards
+     */
+    [[nodiscard]] auto linear_bound_sum(std::span<const long long> coeffs, std::span<const std::pair<Integer, Integer>> bounds, bool upper)
+        -> std::optional<Integer>;
+
+    /**
+     * \brief Set `result[i]` to whether term `i` of a linear sum could have a
+     * bound tightened, given `slack`, which is the distance between the
+     * sum's limit and its least (or, in the other direction, greatest) value.
+     *
+     * That is the case exactly when `|coeffs[i]| * (ub_i - lb_i) > slack`,
+     * which is the test each rounding case of propagate_linear()'s infer()
+     * reduces to, so a term without its flag set is one for which infer()
+     * would do nothing. A zero coefficient is always flagged, so that the
+     * scalar path still reports it. Only valid after linear_bound_sum() has
+     * accepted the same coefficients and bounds.
+     *
+     * \ingroup Innards
+     */
+    auto linear_terms_exceeding_slack(std::span<const long long> coeffs, std::span<const std::pair<Integer, Integer>> bounds, Integer slack,
+        std::span<std::uint8_t> result) -> void;
+
+    /**
+     * \brief Whether a linear constraint's constant, or the part of its sum
+     * that is already fixed, is small enough for the kernels, so that no
+     * remainder derived from it can overflow.
+     *
+     * \ingroup Innards
+     */
+    [[nodiscard]] auto linear_kernel_accepts_value(Integer value) -> bool;
+}
+
+#endif
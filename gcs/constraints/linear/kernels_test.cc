@@ -0,0 +1,80 @@
+#include <gcs/constraints/linear/kernels.hh>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <cstdint>
+#include <optional>
+#include <random>
+#include <utility>
+#include <vector>
+
+using namespace gcs;
+using namespace gcs::innards;
+
+using std::mt19937;
+using std::nullopt;
+using std::optional;
+using std::pair;
+using std::uint8_t;
+using std::uniform_int_distribution;
+using std::vector;
+
+namespace
+{
+    auto checked_sum(const vector<long long> & coeffs, const vector<pair<Integer, Integer>> & bounds, bool upper) -> Integer
+    {
+        Integer result{0};
+        for (unsigned i = 0; i < bounds.size(); ++i) {
+            Integer c{coeffs.empty() ? 1 : coeffs[i]};
+            result += ((c >= 0_i) != upper) ? c * bounds[i].first : c * bounds[i].second;
+        }
+        return result;
+    }
+}
+
+TEST_CASE("Linear kernels agree with checked arithmetic")
+{
+    mt19937 rand{42};
+    for (int round = 0; round < 500; ++round) {
+        auto n = uniform_int_distribution<unsigned>{0, 100}(rand);
+        bool unit = 0 == round % 3;
+        vector<long long> coeffs;
+        vector<pair<Integer, Integer>> bounds;
+        for (unsigned i = 0; i < n; ++i) {
+            if (! unit)
+                coeffs.push_back(uniform_int_distribution<long long>{-1000, 1000}(rand));
+            auto lo = uniform_int_distribution<long long>{-10000, 10000}(rand);
+            bounds.emplace_back(Integer{lo}, Integer{lo + uniform_int_distribution<long long>{0, 100}(rand)});
+        }
+
+        for (bool upper : {false, true}) {
+            auto sum = linear_bound_sum(coeffs, bounds, upper);
+            REQUIRE(sum);
+            CHECK(*sum == checked_sum(coeffs, bounds, upper));
+        }
+
+        auto slack = Integer{uniform_int_distribution<long long>{-10, 20000}(rand)};
+        vector<uint8_t> flags(n);
+        linear_terms_exceeding_slack(coeffs, bounds, slack, flags);
+        for (unsigned i = 0; i < n; ++i) {
+            Integer c{unit ? 1 : coeffs[i]};
+            bool expected = (0_i == c) || (abs(c) * (bounds[i].second - bounds[i].first) > slack);
+            CHECK(bool(flags[i]) == expected);
+        }
+    }
+}
+
+TEST_CASE("Linear kernels refuse what could overflow")
+{
+    vector<pair<Integer, Integer>> bounds{{0_i, 1_i}, {0_i, Integer{1ll << 40}}};
+    CHECK(linear_bound_sum({}, bounds, false) == nullopt);
+    CHECK(linear_bound_sum(vector<long long>{1, 1}, bounds, true) == nullopt);
+
+    vector<pair<Integer, Integer>> small{{0_i, 1_i}, {-5_i, 5_i}};
+    CHECK(linear_bound_sum(vector<long long>{Integer::max_value().raw_value, 1}, small, false) == nullopt);
+    CHECK(linear_bound_sum(vector<long long>{-3, 2}, small, false) == optional{-13_i});
+    CHECK(linear_bound_sum(vector<long long>{-3, 2}, small, true) == optional{10_i});
+
+    CHECK(linear_kernel_accepts_value(1000000_i));
+    CHECK(! linear_kernel_accepts_value(Integer::min_value()));
+}
@@ -181,14 +181,17 @@ auto ReifiedLinearEquality::prepare(Propagators &, State & initial_state, ProofM
     // folding to pay off, and with a branch the dispatcher can reach. Only the
     // must-hold branch folds -- must-not-hold is a different (not-equals) algorithm
     // and the undecided branch only inspects a single residual variable -- so the
-    // state is reachable exactly when the condition may hold. Skipping the
-    // unreachable cases is not just tidiness: State::new_epoch deep-copies every
-    // constraint-state slot at every search node.
+    // state is reachable exactly when the condition may hold. The state is two
+    // reversible words, so an unused one costs next to nothing, but it is not
+    // allocated where it cannot be used either.
     if (! holds_alternative<consistency::Tabulated>(_level)) {
         auto n_terms = visit([](const auto & cv) { return cv.terms.size(); }, _sanitised);
         auto may_hold = holds_alternative<evaluated_reif::MustHold>(_evaluated_cond) || holds_alternative<evaluated_reif::Undecided>(_evaluated_cond);
         if (may_hold && n_terms >= _incremental_threshold.value_or(default_linear_incremental_threshold()))
-            _incremental_handle = initial_state.add_constraint_state(LinearIncrementalState{n_terms, 0_i});
+            _incremental_handle.emplace(initial_state.reversible_trail(), n_terms);
+
+        _unchecked = holds_alternative<evaluated_reif::MustHold>(_evaluated_cond) &&
+            visit([&](const auto & cv) { return linear_arithmetic_cannot_overflow(cv, _value + _modifier, initial_state); }, _sanitised);
     }
 
     return true;
@@ -337,31 +340,40 @@ auto ReifiedLinearEquality::install_propagators(Propagators & propagators) -> vo
                         // Wide enough? Use the incremental propagator (folds instantiated terms
                         // out), which needs backtrackable constraint state set up here. Otherwise
                         // the cheaper stateless path, where folding bookkeeping does not pay off.
-                        if (_incremental_handle) {
-                            auto active = make_shared<vector<std::size_t>>(lin.terms.size());
-                            for (std::size_t i = 0; i != lin.terms.size(); ++i)
-                                (*active)[i] = i;
-                            auto handle = *_incremental_handle;
-                            propagators.install(
-                                constraint_id(),
-                                [modifier = modifier, lin = lin, value = _value, proof_line = _proof_line, reason_from_cond = reif.cond,
-                                    owner = constraint_id(), active = active,
-                                    handle = handle](const State & state, auto & inference, ProofLogger * const logger) {
-                                    return propagate_linear_incremental(lin, value + modifier, state, inference, logger, true, proof_line,
-                                        reason_from_cond, *active, handle, hints::LinearEquality{owner});
-                                },
-                                triggers);
-                        }
-                        else {
-                            propagators.install(
-                                constraint_id(),
-                                [modifier = modifier, lin = lin, value = _value, proof_line = _proof_line, reason_from_cond = reif.cond,
-                                    owner = constraint_id()](const State & state, auto & inference, ProofLogger * const logger) {
-                                    return propagate_linear(lin, value + modifier, state, inference, logger, true, proof_line, reason_from_cond,
-                                        hints::LinearEquality{owner});
-                                },
-                                triggers);
-                        }
+                        // Either way, if prepare() proved the sums cannot overflow, install the
+                        // unchecked instantiation.
+                        auto install_with = [&]<typename Arithmetic_>() {
+                            if (_incremental_handle) {
+                                auto active = make_shared<vector<std::size_t>>(lin.terms.size());
+                                for (std::size_t i = 0; i != lin.terms.size(); ++i)
+                                    (*active)[i] = i;
+                                auto handle = *_incremental_handle;
+                                propagators.install(
+                                    constraint_id(),
+                                    [modifier = modifier, lin = lin, value = _value, proof_line = _proof_line, reason_from_cond = reif.cond,
+                                        owner = constraint_id(), active = active,
+                                        handle = handle](const State & state, auto & inference, ProofLogger * const logger) {
+                                        return propagate_linear_incremental<hints::LinearEquality, Arithmetic_>(lin, value + modifier, state,
+                                            inference, logger, true, proof_line, reason_from_cond, *active, handle, hints::LinearEquality{owner});
+                                    },
+                                    triggers);
+                            }
+                            else {
+                                propagators.install(
+                                    constraint_id(),
+                                    [modifier = modifier, lin = lin, value = _value, proof_line = _proof_line, reason_from_cond = reif.cond,
+                                        owner = constraint_id()](const State & state, auto & inference, ProofLogger * const logger) {
+                                        return propagate_linear<hints::LinearEquality, Arithmetic_>(lin, value + modifier, state, inference, logger,
+                                            true, proof_line, reason_from_cond, hints::LinearEquality{owner});
+                                    },
+                                    triggers);
+                            }
+                        };
+
+                        if (_unchecked)
+                            install_with.template operator()<UncheckedArithmetic>();
+                        else
+                            install_with.template operator()<CheckedArithmetic>();
                     },
                     sanitised_cv);
             }, //
@@ -414,7 +426,7 @@ auto ReifiedLinearEquality::install_propagators(Propagators & propagators) -> vo
                         // neither uses the fold state. The must-hold state runs (repeatedly) only
                         // while the condition is decided true in a subtree, backtracks on its own
                         // handle, and re-folds any terms instantiated while another branch was active.
-                        std::optional<std::pair<std::shared_ptr<vector<std::size_t>>, ConstraintStateHandle>> inc_must_hold;
+                        std::optional<std::pair<std::shared_ptr<vector<std::size_t>>, LinearIncrementalState>> inc_must_hold;
                         if (_incremental_handle) {
                             auto active = make_shared<vector<std::size_t>>(sanitised_cv.terms.size());
                             for (std::size_t i = 0; i != sanitised_cv.terms.size(); ++i)
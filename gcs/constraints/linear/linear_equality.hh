@@ -4,6 +4,7 @@
 #include <gcs/consistency.hh>
 #include <gcs/constraint.hh>
 #include <gcs/constraints/innards/reified_state.hh>
+#include <gcs/constraints/linear/propagate.hh>
 #include <gcs/constraints/linear/utils.hh>
 #include <gcs/expression.hh>
 #include <gcs/innards/literal.hh>
@@ -64,7 +65,13 @@ namespace gcs
         // dispatcher can never reach a branch that would use it. Keeping that
         // conditional matters -- every constraint-state slot is deep-copied at every
         // search node, so one allocated for an unreachable branch is a real cost.
-        std::optional<innards::ConstraintStateHandle> _incremental_handle;
+        std::optional<innards::LinearIncrementalState> _incremental_handle;
+
+        // Whether the bounds-consistent equality's sums are proven, from the
+        // initial domains, never to overflow, so that an unconditional one can be
+        // propagated without the overflow checks. Decided in prepare(), which has
+        // the initial state.
+        bool _unchecked = false;
 
         virtual auto prepare(innards::Propagators &, innards::State &, innards::ProofModel * const) -> bool override;
         virtual auto define_proof_model(innards::ProofModel &, const innards::State &) -> void override;
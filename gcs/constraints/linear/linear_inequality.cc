@@ -107,9 +107,9 @@ auto ReifiedLinearInequality::prepare(Propagators &, State & initial_state, Proo
     // unconditional must-not-hold or a full Iff (a half-reified If/NotIf deactivates
     // rather than enforcing the negation). Within a subtree only one direction runs,
     // and each state backtracks on its own handle, so an under-folded state is still
-    // correct -- it just re-folds on its next run. Allocating one for a direction
-    // that can never run would not be free: State::new_epoch deep-copies every
-    // constraint-state slot at every search node.
+    // correct -- it just re-folds on its next run. A fold state is two reversible
+    // words, so one for a direction that can never run would cost little, but it
+    // would still be allocated for nothing.
     const auto threshold = _incremental_threshold.value_or(default_linear_incremental_threshold());
     const bool und = holds_alternative<evaluated_reif::Undecided>(_evaluated_cond);
     const bool may_must_hold = holds_alternative<evaluated_reif::MustHold>(_evaluated_cond) || und;
@@ -117,9 +117,9 @@ auto ReifiedLinearInequality::prepare(Propagators &, State & initial_state, Proo
         holds_alternative<evaluated_reif::MustNotHold>(_evaluated_cond) || (und && holds_alternative<reif::Iff>(_reif_cond));
 
     if (may_must_hold && n_terms(_sanitised) >= threshold)
-        _incremental_must_hold = initial_state.add_constraint_state(LinearIncrementalState{n_terms(_sanitised), 0_i});
+        _incremental_must_hold.emplace(initial_state.reversible_trail(), n_terms(_sanitised));
     if (may_must_not_hold && n_terms(_sanitised_neg) >= threshold)
-        _incremental_must_not_hold = initial_state.add_constraint_state(LinearIncrementalState{n_terms(_sanitised_neg), 0_i});
+        _incremental_must_not_hold.emplace(initial_state.reversible_trail(), n_terms(_sanitised_neg));
 
     // Slack-based waking, for a direction already decided at install time that is
     // long enough and loose enough that most coarse wakes could not propagate
@@ -143,6 +143,12 @@ auto ReifiedLinearInequality::prepare(Propagators &, State & initial_state, Proo
     if (holds_alternative<evaluated_reif::MustNotHold>(_evaluated_cond))
         _slack_watch_must_not_hold = want_slack(_sanitised_neg, -_value + _neg_modifier - 1_i);
 
+    auto cannot_overflow = [&](const TidiedUpLinear & cv, Integer val) -> bool {
+        return visit([&](const auto & c) { return linear_arithmetic_cannot_overflow(c, val, initial_state); }, cv);
+    };
+    _unchecked_must_hold = may_must_hold && cannot_overflow(_sanitised, _value + _modifier);
+    _unchecked_must_not_hold = may_must_not_hold && cannot_overflow(_sanitised_neg, -_value + _neg_modifier - 1_i);
+
     return true;
 }
 
@@ -251,25 +257,36 @@ auto ReifiedLinearInequality::install_propagators(Propagators & propagators) ->
             // condition is decided one way), so each can fold its own fixed terms away
             // incrementally. The two directions need independent fold states: within any
             // one subtree only one direction runs, and each state backtracks on its own
-            // ConstraintStateHandle, so an under-folded state (vars instantiated while the
+            // reversible words, so an under-folded state (vars instantiated while the
             // other direction was active) is still correct -- it just re-folds them on its
             // next run. prepare() decided which directions get one, and allocated them.
-            auto setup_inc = [&](const auto & cv,
-                                 ConstraintStateHandle handle) -> std::pair<std::shared_ptr<std::vector<std::size_t>>, ConstraintStateHandle> {
+            auto setup_inc = [&](const auto & cv, const LinearIncrementalState & incremental_state)
+                -> std::pair<std::shared_ptr<std::vector<std::size_t>>, LinearIncrementalState> {
                 auto active = make_shared<std::vector<std::size_t>>(cv.terms.size());
                 for (std::size_t i = 0; i != cv.terms.size(); ++i)
                     (*active)[i] = i;
-                return std::pair{active, handle};
+                return std::pair{active, incremental_state};
             };
 
-            std::optional<std::pair<std::shared_ptr<std::vector<std::size_t>>, ConstraintStateHandle>> inc_must_hold, inc_must_not_hold;
+            std::optional<std::pair<std::shared_ptr<std::vector<std::size_t>>, LinearIncrementalState>> inc_must_hold, inc_must_not_hold;
             if (_incremental_must_hold)
                 inc_must_hold = setup_inc(sanitised_cv, *_incremental_must_hold);
             if (_incremental_must_not_hold)
                 inc_must_not_hold = setup_inc(sanitised_neg_cv, *_incremental_must_not_hold);
 
-            auto enforce_constraint_must_hold = [sanitised_cv, value = _value, modifier = modifier, proof_lines, inc_must_hold](const State & state,
-                                                    auto & inference, ProofLogger * const logger, const Literal & cond) -> PropagatorState {
+            // Each direction runs unchecked if prepare() proved that it cannot
+            // overflow. The test is on a captured constant, so it costs one
+            // predictable branch per call.
+            auto enforce_constraint_must_hold = [sanitised_cv, value = _value, modifier = modifier, proof_lines, inc_must_hold,
+                                                    unchecked = _unchecked_must_hold](const State & state, auto & inference,
+                                                    ProofLogger * const logger, const Literal & cond) -> PropagatorState {
+                if (unchecked) {
+                    if (inc_must_hold)
+                        return propagate_linear_incremental<NoHint, UncheckedArithmetic>(sanitised_cv, value + modifier, state, inference, logger,
+                            false, proof_lines, cond, *inc_must_hold->first, inc_must_hold->second);
+                    return propagate_linear<NoHint, UncheckedArithmetic>(
+                        sanitised_cv, value + modifier, state, inference, logger, false, proof_lines, cond);
+                }
                 if (inc_must_hold)
                     return propagate_linear_incremental(sanitised_cv, value + modifier, state, inference, logger, false, proof_lines, cond,
                         *inc_must_hold->first, inc_must_hold->second);
@@ -277,8 +294,15 @@ auto ReifiedLinearInequality::install_propagators(Propagators & propagators) ->
             };
 
             auto enforce_constraint_must_not_hold = [sanitised_neg_cv, value = _value, neg_modifier = neg_modifier, proof_lines_swapped,
-                                                        inc_must_not_hold](const State & state, auto & inference, ProofLogger * const logger,
-                                                        const Literal & cond) -> PropagatorState {
+                                                        inc_must_not_hold, unchecked = _unchecked_must_not_hold](const State & state,
+                                                        auto & inference, ProofLogger * const logger, const Literal & cond) -> PropagatorState {
+                if (unchecked) {
+                    if (inc_must_not_hold)
+                        return propagate_linear_incremental<NoHint, UncheckedArithmetic>(sanitised_neg_cv, -value + neg_modifier - 1_i, state,
+                            inference, logger, false, proof_lines_swapped, cond, *inc_must_not_hold->first, inc_must_not_hold->second);
+                    return propagate_linear<NoHint, UncheckedArithmetic>(
+                        sanitised_neg_cv, -value + neg_modifier - 1_i, state, inference, logger, false, proof_lines_swapped, cond);
+                }
                 if (inc_must_not_hold)
                     return propagate_linear_incremental(sanitised_neg_cv, -value + neg_modifier - 1_i, state, inference, logger, false,
                         proof_lines_swapped, cond, *inc_must_not_hold->first, inc_must_not_hold->second);
@@ -339,15 +363,17 @@ auto ReifiedLinearInequality::install_propagators(Propagators & propagators) ->
             // genuinely-undecided reified case (and equality) keep the coarse path.
             // prepare() made the decision, since sizing the covering set needs the
             // initial domains.
-            auto install_slack_watched = [&](const auto & cv, Integer val, const Literal & cond, const auto & dir_proof_lines) {
+            auto install_slack_watched = [&](const auto & cv, Integer val, const Literal & cond, const auto & dir_proof_lines, bool unchecked) {
                 Triggers slack_triggers;
                 for (const auto & term : cv.terms)
                     slack_triggers.scope_only.push_back(get_var(term));
                 propagators.install(
                     constraint_id(),
-                    [cv, val, cond, dir_proof_lines](
+                    [cv, val, cond, dir_proof_lines, unchecked](
                         const State & state, auto & inference, ProofLogger * const logger, const RefinedWatchContext & ctx) -> PropagatorState {
-                        auto r = propagate_linear(cv, val, state, inference, logger, false, dir_proof_lines, cond);
+                        auto r = unchecked
+                            ? propagate_linear<NoHint, UncheckedArithmetic>(cv, val, state, inference, logger, false, dir_proof_lines, cond)
+                            : propagate_linear(cv, val, state, inference, logger, false, dir_proof_lines, cond);
                         // Re-arm only after a clean sweep; on a contradiction the state
                         // is not safe to read again. scope_only means no coarse re-wake,
                         // so return Enable to stay wakeable by the watches.
@@ -359,11 +385,11 @@ auto ReifiedLinearInequality::install_propagators(Propagators & propagators) ->
             };
 
             if (auto mh = std::get_if<evaluated_reif::MustHold>(&_evaluated_cond); mh && _slack_watch_must_hold) {
-                install_slack_watched(sanitised_cv, _value + modifier, mh->cond, proof_lines);
+                install_slack_watched(sanitised_cv, _value + modifier, mh->cond, proof_lines, _unchecked_must_hold);
                 return;
             }
             if (auto mnh = std::get_if<evaluated_reif::MustNotHold>(&_evaluated_cond); mnh && _slack_watch_must_not_hold) {
-                install_slack_watched(sanitised_neg_cv, -_value + neg_modifier - 1_i, mnh->cond, proof_lines_swapped);
+                install_slack_watched(sanitised_neg_cv, -_value + neg_modifier - 1_i, mnh->cond, proof_lines_swapped, _unchecked_must_not_hold);
                 return;
             }
 
@@ -3,6 +3,7 @@
 
 #include <gcs/constraint.hh>
 #include <gcs/constraints/innards/reified_state.hh>
+#include <gcs/constraints/linear/propagate.hh>
 #include <gcs/constraints/linear/utils.hh>
 #include <gcs/expression.hh>
 #include <gcs/innards/literal.hh>
@@ -60,7 +61,7 @@ namespace gcs
         // dispatcher can actually reach and that is wide enough to pay for folding:
         // every constraint-state slot is deep-copied at every search node, so one
         // allocated for an unreachable direction is a real cost.
-        std::optional<innards::ConstraintStateHandle> _incremental_must_hold, _incremental_must_not_hold;
+        std::optional<innards::LinearIncrementalState> _incremental_must_hold, _incremental_must_not_hold;
 
         // Whether a direction is decided at install time and loose enough to wake on
         // slack watches rather than on every bound of every term. Deciding needs the
@@ -68,6 +69,11 @@ namespace gcs
         // them), so it happens in prepare().
         bool _slack_watch_must_hold = false, _slack_watch_must_not_hold = false;
 
+        // Whether a direction's sums are proven, from the initial domains, never
+        // to overflow, so that its propagator can skip the overflow checks. Also
+        // decided in prepare(), for the same reason.
+        bool _unchecked_must_hold = false, _unchecked_must_not_hold = false;
+
         virtual auto prepare(innards::Propagators &, innards::State &, innards::ProofModel * const) -> bool override;
         virtual auto define_proof_model(innards::ProofModel &, const innards::State &) -> void override;
         virtual auto install_propagators(innards::Propagators &) -> void override;
@@ -1,9 +1,11 @@
 #include <gcs/constraints/linear/hints.hh>
 #include <gcs/constraints/linear/justify.hh>
+#include <gcs/constraints/linear/kernels.hh>
 #include <gcs/constraints/linear/propagate.hh>
 #include <gcs/constraints/linear/utils.hh>
 #include <gcs/innards/assertion_hints.hh>
 #include <gcs/innards/inference_tracker.hh>
+#include <gcs/innards/overflow_proof.hh>
 #include <gcs/innards/proofs/names_and_ids_tracker.hh>
 #include <gcs/innards/proofs/proof_logger.hh>
 #include <gcs/innards/propagators.hh>
@@ -14,9 +16,11 @@
 
 #include <algorithm>
 #include <any>
+#include <cstdint>
 #include <cstdlib>
 #include <limits>
 #include <numeric>
+#include <span>
 #include <sstream>
 #include <string>
 #include <type_traits>
@@ -26,6 +30,7 @@ using std::is_same_v;
 using std::nullopt;
 using std::optional;
 using std::pair;
+using std::span;
 using std::string;
 using std::stringstream;
 using std::variant;
@@ -62,6 +67,17 @@ namespace
         return true;
     }
 
+    // The linear kernels take a sum of plain variables as an empty array of
+    // coefficients, meaning all ones, so there is nothing to add for those.
+    auto add_kernel_coeff(vector<long long> &, const SimpleIntegerVariableID &) -> void
+    {
+    }
+
+    auto add_kernel_coeff(vector<long long> & coeffs, const auto & cv) -> void
+    {
+        coeffs.push_back(get_coeff(cv).raw_value);
+    }
+
     auto linear_bounds_reason(bool want_reason, const auto & coeff_vars, const LinearBounds & bounds, const optional<SimpleIntegerVariableID> & var,
         bool invert, const optional<Literal> & add_to_reason) -> Reason
     {
@@ -97,18 +113,20 @@ namespace
     // negative one) -- the bound can be tighter than requested when it snaps across
     // a hole, and the other side is untouched, so this is exactly the state.bounds()
     // re-read the caller used to do, without the round trip.
+    template <typename Arithmetic_>
     [[nodiscard]] auto infer(auto & inference, ProofLogger * const logger, LinearBounds & bounds, const auto & coeff_vars, int p,
         const SimpleIntegerVariableID & var, Integer remainder, const bool coeff, bool second_constraint_for_equality,
         const optional<pair<optional<ProofLine>, optional<ProofLine>>> & proof_line, const optional<Literal> & add_to_reason, const auto & hint)
         -> bool
     {
+        using Arith = Arithmetic_;
         if (coeff) {
-            if (bounds[p].second >= (1_i + remainder)) {
+            if (bounds[p].second >= Arith::add(1_i, remainder)) {
                 auto justf = [&](const ReasonLiterals &) {
                     justify_linear_bounds(*logger, coeff_vars, bounds, var, second_constraint_for_equality, proof_line.value());
                 };
-                auto landed =
-                    inference.infer_less_than_or_stop_with_updated_bound(logger, var, 1_i + remainder, JustifyExplicitly{justf, ThenRUP::Yes, hint},
+                auto landed = inference.infer_less_than_or_stop_with_updated_bound(logger, var, Arith::add(1_i, remainder),
+                    JustifyExplicitly{justf, ThenRUP::Yes, hint},
                         linear_bounds_reason(inference.want_reasons(), coeff_vars, bounds, var, second_constraint_for_equality, add_to_reason));
                 if (! landed)
                     return false;
@@ -116,11 +134,11 @@ namespace
             }
         }
         else {
-            if (bounds[p].first < -remainder) {
+            if (bounds[p].first < Arith::neg(remainder)) {
                 auto justf = [&](const ReasonLiterals &) {
                     justify_linear_bounds(*logger, coeff_vars, bounds, var, second_constraint_for_equality, proof_line.value());
                 };
-                auto landed = inference.infer_greater_than_or_equal_or_stop_with_updated_bound(logger, var, -remainder,
+                auto landed = inference.infer_greater_than_or_equal_or_stop_with_updated_bound(logger, var, Arith::neg(remainder),
                     JustifyExplicitly{justf, ThenRUP::Yes, hint},
                     linear_bounds_reason(inference.want_reasons(), coeff_vars, bounds, var, second_constraint_for_equality, add_to_reason));
                 if (! landed)
@@ -131,6 +149,7 @@ namespace
         return true;
     }
 
+    template <typename Arithmetic_>
     [[nodiscard]] auto infer(auto & inference, ProofLogger * const logger, LinearBounds & bounds, const auto & coeff_vars, int p,
         const SimpleIntegerVariableID & var, Integer remainder, const Integer coeff, bool second_constraint_for_equality,
         const optional<pair<optional<ProofLine>, optional<ProofLine>>> & proof_line, const optional<Literal> & add_to_reason, const auto & hint)
@@ -140,12 +159,13 @@ namespace
         // tightens the upper bound, a negative one the lower; either way bounds[p]'s
         // tightened side is refreshed in place from where the inference landed (see
         // the bool-coefficient overload above).
+        using Arith = Arithmetic_;
         if (coeff > 0_i && remainder >= 0_i) {
-            if (bounds[p].second >= (1_i + remainder / coeff)) {
+            if (bounds[p].second >= Arith::add(1_i, Arith::div(remainder, coeff))) {
                 auto justf = [&](const ReasonLiterals &) {
                     justify_linear_bounds(*logger, coeff_vars, bounds, var, second_constraint_for_equality, proof_line.value());
                 };
-                auto landed = inference.infer_less_than_or_stop_with_updated_bound(logger, var, 1_i + remainder / coeff,
+                auto landed = inference.infer_less_than_or_stop_with_updated_bound(logger, var, Arith::add(1_i, Arith::div(remainder, coeff)),
                     JustifyExplicitly{justf, ThenRUP::Yes, hint},
                     linear_bounds_reason(inference.want_reasons(), coeff_vars, bounds, var, second_constraint_for_equality, add_to_reason));
                 if (! landed)
@@ -154,12 +174,12 @@ namespace
             }
         }
         else if (coeff > 0_i && remainder < 0_i) {
-            auto div_with_rounding = -((-remainder + coeff - 1_i) / coeff);
-            if (bounds[p].second >= 1_i + div_with_rounding) {
+            auto div_with_rounding = Arith::neg(Arith::div(Arith::sub(Arith::add(Arith::neg(remainder), coeff), 1_i), coeff));
+            if (bounds[p].second >= Arith::add(1_i, div_with_rounding)) {
                 auto justf = [&](const ReasonLiterals &) {
                     justify_linear_bounds(*logger, coeff_vars, bounds, var, second_constraint_for_equality, proof_line.value());
                 };
-                auto landed = inference.infer_less_than_or_stop_with_updated_bound(logger, var, 1_i + div_with_rounding,
+                auto landed = inference.infer_less_than_or_stop_with_updated_bound(logger, var, Arith::add(1_i, div_with_rounding),
                     JustifyExplicitly{justf, ThenRUP::Yes, hint},
                     linear_bounds_reason(inference.want_reasons(), coeff_vars, bounds, var, second_constraint_for_equality, add_to_reason));
                 if (! landed)
@@ -168,11 +188,11 @@ namespace
             }
         }
         else if (coeff < 0_i && remainder >= 0_i) {
-            if (bounds[p].first < remainder / coeff) {
+            if (bounds[p].first < Arith::div(remainder, coeff)) {
                 auto justf = [&](const ReasonLiterals &) {
                     justify_linear_bounds(*logger, coeff_vars, bounds, var, second_constraint_for_equality, proof_line.value());
                 };
-                auto landed = inference.infer_greater_than_or_equal_or_stop_with_updated_bound(logger, var, remainder / coeff,
+                auto landed = inference.infer_greater_than_or_equal_or_stop_with_updated_bound(logger, var, Arith::div(remainder, coeff),
                     JustifyExplicitly{justf, ThenRUP::Yes, hint},
                     linear_bounds_reason(inference.want_reasons(), coeff_vars, bounds, var, second_constraint_for_equality, add_to_reason));
                 if (! landed)
@@ -181,7 +201,7 @@ namespace
             }
         }
         else if (coeff < 0_i && remainder < 0_i) {
-            auto div_with_rounding = (-remainder + -coeff - 1_i) / -coeff;
+            auto div_with_rounding = Arith::div(Arith::sub(Arith::sub(Arith::neg(remainder), coeff), 1_i), Arith::neg(coeff));
             if (bounds[p].first < div_with_rounding) {
                 auto justf = [&](const ReasonLiterals &) {
                     justify_linear_bounds(*logger, coeff_vars, bounds, var, second_constraint_for_equality, proof_line.value());
@@ -200,7 +220,7 @@ namespace
     }
 }
 
-template <typename Hint_>
+template <typename Hint_, typename Arithmetic_>
 auto gcs::innards::propagate_linear(const auto & coeff_vars, Integer value, const State & state, auto & inference, ProofLogger * const logger,
     bool equality, const optional<pair<optional<ProofLine>, optional<ProofLine>>> & proof_line, const optional<Literal> & add_to_reason,
     const Hint_ & hint) -> PropagatorState
@@ -218,8 +238,8 @@ auto gcs::innards::propagate_linear(const auto & coeff_vars, Integer value, cons
         return PropagatorState::DisableUntilBacktrack;
     }
 
-    for (const auto & cv : coeff_vars.terms)
-        bounds.push_back(state.bounds(get_var(cv)));
+    bounds.resize(coeff_vars.terms.size(), pair{0_i, 0_i});
+    state.bounds(coeff_vars.terms, [](const auto & cv) { return get_var(cv); }, span{bounds.data(), bounds.size()});
 
     // lower_sum, the least value the (forward) sum can take, from each term's
     // min contribution. It is invariant within a forward sweep -- the sweep
@@ -227,22 +247,45 @@ auto gcs::innards::propagate_linear(const auto & coeff_vars, Integer value, cons
     // of negative ones, neither of which feeds lower_sum -- so one recompute at
     // the top of each sweep from the current bounds is exact, and picks up any
     // tightening a previous inverse sweep made.
+    using Arith = Arithmetic_;
     auto compute_lower_sum = [&]() -> Integer {
         Integer s{0};
         for (unsigned i = 0, e = coeff_vars.terms.size(); i != e; ++i) {
             const auto & cv = coeff_vars.terms[i];
             if constexpr (is_same_v<decltype(cv), const SimpleIntegerVariableID &>)
-                s += bounds[i].first;
+                s = Arith::add(s, bounds[i].first);
             else if constexpr (is_same_v<decltype(cv), const pair<bool, SimpleIntegerVariableID> &>)
-                s += (cv.first ? bounds[i].first : -bounds[i].second);
+                s = Arith::add(s, cv.first ? bounds[i].first : Arith::neg(bounds[i].second));
             else {
                 auto coeff = get_coeff(cv);
-                s += (coeff >= 0_i) ? (coeff * bounds[i].first) : (coeff * bounds[i].second);
+                s = Arith::add(s, (coeff >= 0_i) ? Arith::mul(coeff, bounds[i].first) : Arith::mul(coeff, bounds[i].second));
             }
         }
         return s;
     };
 
+    // Long rows also go through the vectorised kernels, which compute the
+    // sums with one overflow check for the whole row instead of one per
+    // term, and flag the few terms that could be tightened so that the
+    // sweeps skip the rest without doing their checked arithmetic. When a
+    // kernel cannot rule out overflow, that sweep uses the scalar code.
+    const bool use_kernels = coeff_vars.terms.size() >= linear_kernel_min_terms() && linear_kernel_accepts_value(value);
+    vector<long long> kernel_coeffs;
+    vector<std::uint8_t> can_tighten;
+    if (use_kernels) {
+        can_tighten.resize(coeff_vars.terms.size());
+        for (const auto & cv : coeff_vars.terms)
+            add_kernel_coeff(kernel_coeffs, cv);
+    }
+    auto kernel_bound_sum = [&](bool upper) -> optional<Integer> {
+        if (! use_kernels)
+            return nullopt;
+        return linear_bound_sum(kernel_coeffs, span{bounds.data(), bounds.size()}, upper);
+    };
+    auto flag_terms_that_can_tighten = [&](Integer slack) {
+        linear_terms_exceeding_slack(kernel_coeffs, span{bounds.data(), bounds.size()}, slack, can_tighten);
+    };
+
     // The forward (sum <= value) sweep reaches the <= fixpoint in one pass and is
     // idempotent on its own: a positive-coefficient term is only ever written on
     // its upper bound and only ever read (via lower_sum) on its lower, and vice
@@ -272,20 +315,26 @@ auto gcs::innards::propagate_linear(const auto & coeff_vars, Integer value, cons
     for (bool first = true;; first = false) {
         auto inferences_before_forward = inference.count_inferences();
 
-        Integer lower_sum = compute_lower_sum();
+        auto fast_lower_sum = kernel_bound_sum(false);
+        Integer lower_sum = fast_lower_sum ? *fast_lower_sum : compute_lower_sum();
+        if (fast_lower_sum)
+            flag_terms_that_can_tighten(value - lower_sum);
         for (unsigned p = 0, p_end = coeff_vars.terms.size(); p != p_end; ++p) {
+            if (fast_lower_sum && ! can_tighten[p])
+                continue;
             const auto & cv = coeff_vars.terms[p];
 
             Integer lower_without_me{0_i};
             if constexpr (is_same_v<decltype(cv), const SimpleIntegerVariableID &>)
-                lower_without_me = lower_sum - bounds[p].first;
+                lower_without_me = Arith::sub(lower_sum, bounds[p].first);
             else if constexpr (is_same_v<decltype(cv), const pair<bool, SimpleIntegerVariableID> &>)
-                lower_without_me = lower_sum - (cv.first ? bounds[p].first : -bounds[p].second);
+                lower_without_me = Arith::sub(lower_sum, cv.first ? bounds[p].first : Arith::neg(bounds[p].second));
             else
-                lower_without_me = lower_sum - ((get_coeff(cv) >= 0_i) ? (get_coeff(cv) * bounds[p].first) : (get_coeff(cv) * bounds[p].second));
-            Integer remainder = value - lower_without_me;
+                lower_without_me = Arith::sub(lower_sum,
+                    (get_coeff(cv) >= 0_i) ? Arith::mul(get_coeff(cv), bounds[p].first) : Arith::mul(get_coeff(cv), bounds[p].second));
+            Integer remainder = Arith::sub(value, lower_without_me);
 
-            if (! infer(
+            if (! infer<Arith>(
                     inference, logger, bounds, coeff_vars, p, get_var(cv), remainder, get_coeff_or_bool(cv), false, proof_line, add_to_reason, hint))
                 return PropagatorState::Enable; // contradiction: stop before reading the (now junk) state
             // infer() has refreshed bounds[p]'s tightened side in place.
@@ -297,41 +346,53 @@ auto gcs::innards::propagate_linear(const auto & coeff_vars, Integer value, cons
             break;
 
         auto inferences_before_inverse = inference.count_inferences();
+        auto fast_upper_sum = kernel_bound_sum(true);
         Integer inv_lower_sum{0};
-        for (const auto & [idx, cv] : enumerate(coeff_vars.terms)) {
-            if constexpr (is_same_v<decltype(cv), const SimpleIntegerVariableID &>)
-                inv_lower_sum += -bounds[idx].second;
-            else {
-                auto coeff = get_coeff(cv);
-                inv_lower_sum += (-coeff >= 0_i) ? (-coeff * bounds[idx].first) : (-coeff * bounds[idx].second);
+        if (fast_upper_sum) {
+            inv_lower_sum = -*fast_upper_sum;
+            flag_terms_that_can_tighten(-value - inv_lower_sum);
+        }
+        else {
+            for (const auto & [idx, cv] : enumerate(coeff_vars.terms)) {
+                if constexpr (is_same_v<decltype(cv), const SimpleIntegerVariableID &>)
+                    inv_lower_sum = Arith::sub(inv_lower_sum, bounds[idx].second);
+                else {
+                    auto coeff = Arith::neg(get_coeff(cv));
+                    inv_lower_sum =
+                        Arith::add(inv_lower_sum, (coeff >= 0_i) ? Arith::mul(coeff, bounds[idx].first) : Arith::mul(coeff, bounds[idx].second));
+                }
             }
         }
 
         for (unsigned p = 0, p_end = coeff_vars.terms.size(); p != p_end; ++p) {
+            if (fast_upper_sum && ! can_tighten[p])
+                continue;
             const auto & cv = coeff_vars.terms[p];
             Integer inv_lower_without_me{0_i};
             if constexpr (is_same_v<decltype(cv), const SimpleIntegerVariableID &>)
-                inv_lower_without_me = inv_lower_sum + bounds[p].second;
+                inv_lower_without_me = Arith::add(inv_lower_sum, bounds[p].second);
             else if constexpr (is_same_v<decltype(cv), const pair<bool, SimpleIntegerVariableID> &>)
-                inv_lower_without_me = inv_lower_sum + (! cv.first ? -bounds[p].first : bounds[p].second);
+                inv_lower_without_me = Arith::add(inv_lower_sum, ! cv.first ? Arith::neg(bounds[p].first) : bounds[p].second);
             else
-                inv_lower_without_me =
-                    inv_lower_sum + ((-get_coeff(cv) >= 0_i) ? (get_coeff(cv) * bounds[p].first) : (get_coeff(cv) * bounds[p].second));
+                inv_lower_without_me = Arith::add(inv_lower_sum,
+                    (Arith::neg(get_coeff(cv)) >= 0_i) ? Arith::mul(get_coeff(cv), bounds[p].first) : Arith::mul(get_coeff(cv), bounds[p].second));
 
-            Integer inv_remainder = -value - inv_lower_without_me;
+            Integer inv_remainder = Arith::sub(Arith::neg(value), inv_lower_without_me);
 
-            if (! infer(inference, logger, bounds, coeff_vars, p, get_var(cv), inv_remainder, negate(get_coeff_or_bool(cv)), true, proof_line,
+            if (! infer<Arith>(inference, logger, bounds, coeff_vars, p, get_var(cv), inv_remainder, negate(get_coeff_or_bool(cv)), true, proof_line,
                     add_to_reason, hint))
                 return PropagatorState::Enable; // contradiction: stop before reading the (now junk) state
             // infer() has refreshed bounds[p]'s tightened side in place.
 
             if constexpr (is_same_v<decltype(cv), const SimpleIntegerVariableID &>)
-                inv_lower_sum = inv_lower_without_me - bounds[p].second;
+                inv_lower_sum = Arith::sub(inv_lower_without_me, bounds[p].second);
             else if constexpr (is_same_v<decltype(cv), const pair<bool, SimpleIntegerVariableID> &>)
-                inv_lower_sum = inv_lower_without_me + (! cv.first ? bounds[p].first : -bounds[p].second);
-            else
+                inv_lower_sum = Arith::add(inv_lower_without_me, ! cv.first ? bounds[p].first : Arith::neg(bounds[p].second));
+            else {
+                auto coeff = Arith::neg(get_coeff(cv));
                 inv_lower_sum =
-                    inv_lower_without_me + ((-get_coeff(cv) >= 0_i) ? (-get_coeff(cv) * bounds[p].first) : (-get_coeff(cv) * bounds[p].second));
+                    Arith::add(inv_lower_without_me, (coeff >= 0_i) ? Arith::mul(coeff, bounds[p].first) : Arith::mul(coeff, bounds[p].second));
+            }
         }
 
         // A clean inverse sweep means the forward's last output fed the inverse
@@ -346,11 +407,15 @@ auto gcs::innards::propagate_linear(const auto & coeff_vars, Integer value, cons
 // Two hint instantiations per (coeff-vector type, tracker): hints::LinearEquality
 // for the equality propagator, NoHint for the reified-inequality propagators (which
 // pass no hint). The hint rides the JustifyExplicitly, so it is materialised lazily
-// in assertion mode rather than eagerly at the call site.
-#define GCS_INSTANTIATE_PROPAGATE_LINEAR(CoeffVars, Tracker, Hint)                                                                                   \
-    template auto gcs::innards::propagate_linear(const CoeffVars & coeff_vars, Integer value, const State & state, Tracker &,                        \
+// in assertion mode rather than eagerly at the call site. Each comes checked, and
+// unchecked for instances that linear_arithmetic_cannot_overflow() clears.
+#define GCS_INSTANTIATE_PROPAGATE_LINEAR_WITH(CoeffVars, Tracker, Hint, Arithmetic)                                                                  \
+    template auto gcs::innards::propagate_linear<Hint, Arithmetic>(const CoeffVars & coeff_vars, Integer value, const State & state, Tracker &,      \
         ProofLogger * const logger, bool equality, const optional<pair<optional<ProofLine>, optional<ProofLine>>> & proof_line,                      \
         const optional<Literal> & add_to_reason, const Hint & hint) -> PropagatorState
+#define GCS_INSTANTIATE_PROPAGATE_LINEAR(CoeffVars, Tracker, Hint)                                                                                   \
+    GCS_INSTANTIATE_PROPAGATE_LINEAR_WITH(CoeffVars, Tracker, Hint, CheckedArithmetic);                                                              \
+    GCS_INSTANTIATE_PROPAGATE_LINEAR_WITH(CoeffVars, Tracker, Hint, UncheckedArithmetic)
 
 GCS_INSTANTIATE_PROPAGATE_LINEAR(SumOf<Weighted<SimpleIntegerVariableID>>, SimpleInferenceTracker, hints::LinearEquality);
 GCS_INSTANTIATE_PROPAGATE_LINEAR(SumOf<PositiveOrNegative<SimpleIntegerVariableID>>, SimpleInferenceTracker, hints::LinearEquality);
@@ -367,6 +432,24 @@ GCS_INSTANTIATE_PROPAGATE_LINEAR(SumOf<PositiveOrNegative<SimpleIntegerVariableI
 GCS_INSTANTIATE_PROPAGATE_LINEAR(SumOf<SimpleIntegerVariableID>, EagerProofLoggingInferenceTracker, NoHint);
 
 #undef GCS_INSTANTIATE_PROPAGATE_LINEAR
+#undef GCS_INSTANTIATE_PROPAGATE_LINEAR_WITH
+
+template <typename CoeffVars_>
+auto gcs::innards::linear_arithmetic_cannot_overflow(const CoeffVars_ & coeff_vars, Integer value, const State & state) -> bool
+{
+    OverflowProof proof;
+    proof.add_constant(value);
+    for (const auto & cv : coeff_vars.terms) {
+        auto [lower, upper] = state.bounds(get_var(cv));
+        proof.add_term(get_coeff(cv), lower, upper);
+    }
+    return proof.proven();
+}
+
+template auto gcs::innards::linear_arithmetic_cannot_overflow(const SumOf<Weighted<SimpleIntegerVariableID>> &, Integer, const State &) -> bool;
+template auto gcs::innards::linear_arithmetic_cannot_overflow(const SumOf<PositiveOrNegative<SimpleIntegerVariableID>> &, Integer, const State &)
+    -> bool;
+template auto gcs::innards::linear_arithmetic_cannot_overflow(const SumOf<SimpleIntegerVariableID> &, Integer, const State &) -> bool;
 
 auto gcs::innards::default_linear_incremental_threshold() -> std::size_t
 {
@@ -481,44 +564,49 @@ auto gcs::innards::default_linear_slack_watch_cover_percent() -> std::size_t
     return percent;
 }
 
-template <typename Hint_>
+template <typename Hint_, typename Arithmetic_>
 auto gcs::innards::propagate_linear_incremental(const auto & coeff_vars, Integer value, const State & state, auto & inference,
     ProofLogger * const logger, bool equality, const optional<pair<optional<ProofLine>, optional<ProofLine>>> & proof_line,
-    const optional<Literal> & add_to_reason, std::vector<std::size_t> & active, ConstraintStateHandle state_handle, const Hint_ & hint)
+    const optional<Literal> & add_to_reason, std::vector<std::size_t> & active, const LinearIncrementalState & incremental_state, const Hint_ & hint)
     -> PropagatorState
 {
     // The empty (all-coefficients-cancelled) constraint has no terms to fold; defer to
     // the stateless propagator, which handles the constant-only feasibility check.
     if (coeff_vars.terms.empty())
-        return propagate_linear(coeff_vars, value, state, inference, logger, equality, proof_line, add_to_reason, hint);
+        return propagate_linear<Hint_, Arithmetic_>(coeff_vars, value, state, inference, logger, equality, proof_line, add_to_reason, hint);
 
-    auto & st = std::any_cast<LinearIncrementalState &>(state.get_constraint_state(state_handle));
+    // Read once here and written back once after the fold below: nothing in
+    // between can see them, and a contradiction leaves them untouched.
+    auto & trail = state.reversible_trail();
+    auto n_active = incremental_state.n_active.get(trail);
+    auto fixed_lower = incremental_state.fixed_lower.get(trail);
     const auto n = coeff_vars.terms.size();
     const bool want = inference.want_reasons();
 
     // Per-tier contributions, specialised exactly as the stateless propagate_linear is,
     // so the inferences (and hence the search tree) are identical -- min for the <= half,
     // -(max) for the >= (inverse) half.
+    using Arith = Arithmetic_;
     auto min_contrib = [](const auto & cv, const pair<Integer, Integer> & b) -> Integer {
         using CV = std::decay_t<decltype(cv)>;
         if constexpr (is_same_v<CV, SimpleIntegerVariableID>)
             return b.first;
         else if constexpr (is_same_v<CV, PositiveOrNegative<SimpleIntegerVariableID>>)
-            return cv.positive ? b.first : -b.second;
+            return cv.positive ? b.first : Arith::neg(b.second);
         else {
             auto c = get_coeff(cv);
-            return (c >= 0_i) ? (c * b.first) : (c * b.second);
+            return (c >= 0_i) ? Arith::mul(c, b.first) : Arith::mul(c, b.second);
         }
     };
     auto inv_contrib = [](const auto & cv, const pair<Integer, Integer> & b) -> Integer {
         using CV = std::decay_t<decltype(cv)>;
         if constexpr (is_same_v<CV, SimpleIntegerVariableID>)
-            return -b.second;
+            return Arith::neg(b.second);
         else if constexpr (is_same_v<CV, PositiveOrNegative<SimpleIntegerVariableID>>)
-            return cv.positive ? -b.second : b.first;
+            return cv.positive ? Arith::neg(b.second) : b.first;
         else {
             auto c = get_coeff(cv);
-            return (c >= 0_i) ? -(c * b.second) : -(c * b.first);
+            return (c >= 0_i) ? Arith::neg(Arith::mul(c, b.second)) : Arith::neg(Arith::mul(c, b.first));
         }
     };
 
@@ -526,12 +614,36 @@ auto gcs::innards::propagate_linear_incremental(const auto & coeff_vars, Integer
     // justification will actually read them (proofs / conflict learning).
     LinearBounds bounds;
     bounds.resize(n, pair{0_i, 0_i});
-    for (std::size_t k = 0; k != st.n_active; ++k)
+    for (std::size_t k = 0; k != n_active; ++k)
         bounds[active[k]] = state.bounds(get_var(coeff_vars.terms[active[k]]));
     if (want)
-        for (std::size_t k = st.n_active; k != n; ++k)
+        for (std::size_t k = n_active; k != n; ++k)
             bounds[active[k]] = state.bounds(get_var(coeff_vars.terms[active[k]]));
 
+    // Long rows go through the vectorised kernels, as in propagate_linear,
+    // over a contiguous copy of the active terms' bounds. The fixed part of
+    // the sum must be small enough for the kernels as well as the constant.
+    const bool use_kernels = n_active >= linear_kernel_min_terms() && linear_kernel_accepts_value(value) && linear_kernel_accepts_value(fixed_lower);
+    vector<long long> kernel_coeffs;
+    LinearBounds active_bounds;
+    vector<std::uint8_t> can_tighten;
+    if (use_kernels) {
+        active_bounds.resize(n_active, pair{0_i, 0_i});
+        can_tighten.resize(n_active);
+        for (std::size_t k = 0; k != n_active; ++k)
+            add_kernel_coeff(kernel_coeffs, coeff_vars.terms[active[k]]);
+    }
+    auto kernel_bound_sum = [&](bool upper) -> optional<Integer> {
+        if (! use_kernels)
+            return nullopt;
+        for (std::size_t k = 0; k != n_active; ++k)
+            active_bounds[k] = bounds[active[k]];
+        return linear_bound_sum(kernel_coeffs, span{active_bounds.data(), active_bounds.size()}, upper);
+    };
+    auto flag_terms_that_can_tighten = [&](Integer slack) {
+        linear_terms_exceeding_slack(kernel_coeffs, span{active_bounds.data(), active_bounds.size()}, slack, can_tighten);
+    };
+
     // Alternate the forward (<=) and inverse (>=) sweeps over the active terms
     // to the equality's own fixpoint in a single call, so it can claim
     // idempotence -- see propagate_linear for the read/write reasoning (the
@@ -545,20 +657,28 @@ auto gcs::innards::propagate_linear_incremental(const auto & coeff_vars, Integer
         auto inferences_before_forward = inference.count_inferences();
 
         // Forward (<=): coeff_p * x_p <= value - (lower_sum - contrib_p).
-        Integer lower_sum = st.fixed_lower;
-        for (std::size_t k = 0; k != st.n_active; ++k)
-            lower_sum += min_contrib(coeff_vars.terms[active[k]], bounds[active[k]]);
+        auto fast_lower_sum = kernel_bound_sum(false);
+        Integer lower_sum = fixed_lower;
+        if (fast_lower_sum) {
+            lower_sum += *fast_lower_sum;
+            flag_terms_that_can_tighten(value - lower_sum);
+        }
+        else
+            for (std::size_t k = 0; k != n_active; ++k)
+                lower_sum = Arith::add(lower_sum, min_contrib(coeff_vars.terms[active[k]], bounds[active[k]]));
 
-        for (std::size_t k = 0; k != st.n_active; ++k) {
+        for (std::size_t k = 0; k != n_active; ++k) {
+            if (fast_lower_sum && ! can_tighten[k])
+                continue;
             auto p = active[k];
             const auto & cv = coeff_vars.terms[p];
-            Integer lower_without_me = lower_sum - min_contrib(cv, bounds[p]);
-            Integer remainder = value - lower_without_me;
-            if (! infer(
+            Integer lower_without_me = Arith::sub(lower_sum, min_contrib(cv, bounds[p]));
+            Integer remainder = Arith::sub(value, lower_without_me);
+            if (! infer<Arith>(
                     inference, logger, bounds, coeff_vars, p, get_var(cv), remainder, get_coeff_or_bool(cv), false, proof_line, add_to_reason, hint))
                 return PropagatorState::Enable;
             // infer() has refreshed bounds[p]'s tightened side in place.
-            lower_sum = lower_without_me + min_contrib(cv, bounds[p]);
+            lower_sum = Arith::add(lower_without_me, min_contrib(cv, bounds[p]));
         }
 
         if (! equality || (! first && inference.count_inferences() == inferences_before_forward))
@@ -567,20 +687,28 @@ auto gcs::innards::propagate_linear_incremental(const auto & coeff_vars, Integer
         auto inferences_before_inverse = inference.count_inferences();
 
         // Backward (>=): mirror of the forward pass on the inverse sum.
-        Integer inv_lower_sum = -st.fixed_lower;
-        for (std::size_t k = 0; k != st.n_active; ++k)
-            inv_lower_sum += inv_contrib(coeff_vars.terms[active[k]], bounds[active[k]]);
+        auto fast_upper_sum = kernel_bound_sum(true);
+        Integer inv_lower_sum = -fixed_lower;
+        if (fast_upper_sum) {
+            inv_lower_sum -= *fast_upper_sum;
+            flag_terms_that_can_tighten(-value - inv_lower_sum);
+        }
+        else
+            for (std::size_t k = 0; k != n_active; ++k)
+                inv_lower_sum = Arith::add(inv_lower_sum, inv_contrib(coeff_vars.terms[active[k]], bounds[active[k]]));
 
-        for (std::size_t k = 0; k != st.n_active; ++k) {
+        for (std::size_t k = 0; k != n_active; ++k) {
+            if (fast_upper_sum && ! can_tighten[k])
+                continue;
             auto p = active[k];
             const auto & cv = coeff_vars.terms[p];
-            Integer inv_lower_without_me = inv_lower_sum - inv_contrib(cv, bounds[p]);
-            Integer inv_remainder = -value - inv_lower_without_me;
-            if (! infer(inference, logger, bounds, coeff_vars, p, get_var(cv), inv_remainder, negate(get_coeff_or_bool(cv)), true, proof_line,
+            Integer inv_lower_without_me = Arith::sub(inv_lower_sum, inv_contrib(cv, bounds[p]));
+            Integer inv_remainder = Arith::sub(Arith::neg(value), inv_lower_without_me);
+            if (! infer<Arith>(inference, logger, bounds, coeff_vars, p, get_var(cv), inv_remainder, negate(get_coeff_or_bool(cv)), true, proof_line,
                     add_to_reason, hint))
                 return PropagatorState::Enable;
             // infer() has refreshed bounds[p]'s tightened side in place.
-            inv_lower_sum = inv_lower_without_me + inv_contrib(cv, bounds[p]);
+            inv_lower_sum = Arith::add(inv_lower_without_me, inv_contrib(cv, bounds[p]));
         }
 
         if (inference.count_inferences() == inferences_before_inverse)
@@ -594,16 +722,18 @@ auto gcs::innards::propagate_linear_incremental(const auto & coeff_vars, Integer
     // contradicts via the ordinary per-variable justification. The permutation is
     // persistent (never restored on backtrack); only n_active and fixed_lower are
     // backtracked, which is sound because the loops above are order-independent.
-    for (std::size_t k = 0; k != st.n_active && st.n_active > 1;) {
+    for (std::size_t k = 0; k != n_active && n_active > 1;) {
         auto p = active[k];
         if (auto v = state.optional_single_value(get_var(coeff_vars.terms[p]))) {
-            st.fixed_lower += get_coeff(coeff_vars.terms[p]) * *v;
-            --st.n_active;
-            std::swap(active[k], active[st.n_active]);
+            fixed_lower = Arith::add(fixed_lower, Arith::mul(get_coeff(coeff_vars.terms[p]), *v));
+            --n_active;
+            std::swap(active[k], active[n_active]);
         }
         else
             ++k;
     }
+    incremental_state.n_active.set(trail, n_active);
+    incremental_state.fixed_lower.set(trail, fixed_lower);
 
     // Idempotent for both equality and inequality: the sweeps above ran to the
     // fixpoint, and the fold is internal bookkeeping, not inference -- it moves a
@@ -615,12 +745,16 @@ auto gcs::innards::propagate_linear_incremental(const auto & coeff_vars, Integer
 }
 
 // One instantiation per (coeff vector, tracker, hint): hints::LinearEquality for the
-// equality MustHold path, NoHint for the inequality must-hold path.
+// equality MustHold path, NoHint for the inequality must-hold path; each checked
+// and unchecked, as for propagate_linear.
+#define GCS_INSTANTIATE_PROPAGATE_LINEAR_INCREMENTAL_WITH(CoeffVars, Tracker, Hint, Arithmetic)                                                      \
+    template auto gcs::innards::propagate_linear_incremental<Hint, Arithmetic>(const CoeffVars & coeff_vars, Integer value, const State & state,     \
+        Tracker &, ProofLogger * const logger, bool equality, const optional<pair<optional<ProofLine>, optional<ProofLine>>> & proof_line,           \
+        const optional<Literal> & add_to_reason, std::vector<std::size_t> & active, const LinearIncrementalState & incremental_state,                \
+        const Hint & hint) -> PropagatorState
 #define GCS_INSTANTIATE_PROPAGATE_LINEAR_INCREMENTAL(CoeffVars, Tracker, Hint)                                                                       \
-    template auto gcs::innards::propagate_linear_incremental(const CoeffVars & coeff_vars, Integer value, const State & state, Tracker &,            \
-        ProofLogger * const logger, bool equality, const optional<pair<optional<ProofLine>, optional<ProofLine>>> & proof_line,                      \
-        const optional<Literal> & add_to_reason, std::vector<std::size_t> & active, ConstraintStateHandle state_handle, const Hint & hint)           \
-        -> PropagatorState
+    GCS_INSTANTIATE_PROPAGATE_LINEAR_INCREMENTAL_WITH(CoeffVars, Tracker, Hint, CheckedArithmetic);                                                  \
+    GCS_INSTANTIATE_PROPAGATE_LINEAR_INCREMENTAL_WITH(CoeffVars, Tracker, Hint, UncheckedArithmetic)
 
 GCS_INSTANTIATE_PROPAGATE_LINEAR_INCREMENTAL(SumOf<Weighted<SimpleIntegerVariableID>>, SimpleInferenceTracker, hints::LinearEquality);
 GCS_INSTANTIATE_PROPAGATE_LINEAR_INCREMENTAL(SumOf<PositiveOrNegative<SimpleIntegerVariableID>>, SimpleInferenceTracker, hints::LinearEquality);
@@ -638,6 +772,7 @@ GCS_INSTANTIATE_PROPAGATE_LINEAR_INCREMENTAL(SumOf<PositiveOrNegative<SimpleInte
 GCS_INSTANTIATE_PROPAGATE_LINEAR_INCREMENTAL(SumOf<SimpleIntegerVariableID>, EagerProofLoggingInferenceTracker, NoHint);
 
 #undef GCS_INSTANTIATE_PROPAGATE_LINEAR_INCREMENTAL
+#undef GCS_INSTANTIATE_PROPAGATE_LINEAR_INCREMENTAL_WITH
 
 template <typename Hint_>
 auto gcs::innards::propagate_linear_not_equals(const auto & coeff_vars, Integer value, const State & state, auto & inference,
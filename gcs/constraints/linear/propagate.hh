@@ -6,6 +6,7 @@
 #include <gcs/innards/inference_tracker-fwd.hh>
 #include <gcs/innards/justification.hh>
 #include <gcs/innards/literal.hh>
+#include <gcs/innards/overflow_proof.hh>
 #include <gcs/innards/proofs/proof_logger-fwd.hh>
 #include <gcs/innards/propagators-fwd.hh>
 #include <gcs/innards/state.hh>
@@ -21,9 +22,13 @@ namespace gcs::innards
     /**
      * \brief Propagate a linear equality or inequality.
      *
+     * With UncheckedArithmetic, the sums and remainders are computed without
+     * overflow checks, which is only allowed if linear_arithmetic_cannot_overflow()
+     * said so for these terms and this value.
+     *
      * \ingroup Innards
      */
-    template <typename Hint_ = NoHint>
+    template <typename Hint_ = NoHint, typename Arithmetic_ = CheckedArithmetic>
     auto propagate_linear(const auto & terms, Integer, const State &, auto & inference_tracker, ProofLogger * const logger, bool equality,
         const std::optional<std::pair<std::optional<ProofLine>, std::optional<ProofLine>>> & proof_line, const std::optional<Literal> & add_to_reason,
         const Hint_ & hint = {}) -> PropagatorState;
@@ -92,8 +97,12 @@ namespace gcs::innards
      */
     struct LinearIncrementalState
     {
-        std::size_t n_active;
-        Integer fixed_lower;
+        Reversible<std::size_t> n_active;
+        Reversible<Integer> fixed_lower;
+
+        explicit LinearIncrementalState(ReversibleTrail & trail, std::size_t n_terms) : n_active(trail, n_terms), fixed_lower(trail, 0_i)
+        {
+        }
     };
 
     /**
@@ -110,18 +119,31 @@ namespace gcs::innards
      */
     [[nodiscard]] auto default_linear_incremental_threshold() -> std::size_t;
 
+    /**
+     * \brief Can propagate_linear() and propagate_linear_incremental() use
+     * UncheckedArithmetic for these terms and this value, from here on?
+     *
+     * This is an OverflowProof over the bounds the terms' variables have in
+     * the given state, so call it at install time, from the initial state.
+     * It stays true for the rest of the search, because domains only shrink.
+     *
+     * \ingroup Innards
+     */
+    template <typename CoeffVars_>
+    [[nodiscard]] auto linear_arithmetic_cannot_overflow(const CoeffVars_ & terms, Integer value, const State &) -> bool;
+
     /**
      * \brief Incremental variant of propagate_linear: folds instantiated terms out of
      * the active set so each firing only walks the still-unassigned terms. `active`
      * is a persistent (non-backtracked) permutation of term indices, mutated in place;
-     * `state_handle` refers to a LinearIncrementalState added via add_constraint_state.
+     * `incremental_state` lives in the State's reversible trail.
      *
      * \ingroup Innards
      */
-    template <typename Hint_ = NoHint>
+    template <typename Hint_ = NoHint, typename Arithmetic_ = CheckedArithmetic>
     auto propagate_linear_incremental(const auto & terms, Integer, const State &, auto & inference_tracker, ProofLogger * const logger, bool equality,
         const std::optional<std::pair<std::optional<ProofLine>, std::optional<ProofLine>>> & proof_line, const std::optional<Literal> & add_to_reason,
-        std::vector<std::size_t> & active, ConstraintStateHandle state_handle, const Hint_ & hint = {}) -> PropagatorState;
+        std::vector<std::size_t> & active, const LinearIncrementalState & incremental_state, const Hint_ & hint = {}) -> PropagatorState;
 
     /**
      * \brief Propagate a not-equals
@@ -1,3 +1,4 @@
+#include <gcs/constraints/innards/layered_graph.hh>
 #include <gcs/constraints/mdd/hints.hh>
 #include <gcs/constraints/mdd/mdd.hh>
 #include <gcs/exception.hh>
@@ -17,19 +18,17 @@
 #include <fmt/core.h>
 #endif
 
-#include <any>
+#include <algorithm>
 #include <memory>
 #include <set>
 #include <string>
 #include <unordered_map>
-#include <unordered_set>
 #include <utility>
 #include <vector>
 
 using namespace gcs;
 using namespace gcs::innards;
 
-using std::any_cast;
 using std::cmp_less;
 using std::make_shared;
 using std::make_unique;
@@ -40,8 +39,8 @@ using std::shared_ptr;
 using std::string;
 using std::unique_ptr;
 using std::unordered_map;
-using std::unordered_set;
 using std::vector;
+using std::ranges::max_element;
 using std::ranges::sort;
 
 #if defined(__cpp_lib_print) && defined(__cpp_lib_format)
@@ -60,225 +59,81 @@ namespace
         return it->second;
     }
 
-    struct MDDGraph
-    {
-        // nodes_supporting[i][val] = nodes in layer i that have an outgoing transition on `val`
-        // and currently sit on a root-to-accepting path.
-        vector<unordered_map<Integer, set<long>>> nodes_supporting;
-        // out_edges[i][q] maps target node q' in layer i+1 to the set of values labelling
-        // edges q -> q'.
-        vector<vector<unordered_map<long, unordered_set<Integer>>>> out_edges;
-        vector<vector<long>> out_deg;
-        vector<vector<unordered_map<long, unordered_set<Integer>>>> in_edges;
-        vector<vector<long>> in_deg;
-        // nodes[i] = active nodes in layer i.
-        vector<set<long>> nodes;
-        bool initialised = false;
-
-        explicit MDDGraph(long num_vars, const vector<long> & nodes_per_layer) :
-            nodes_supporting(num_vars), out_edges(num_vars), out_deg(num_vars), in_edges(num_vars + 1), in_deg(num_vars + 1), nodes(num_vars + 1)
-        {
-            for (long i = 0; i < num_vars; ++i) {
-                out_edges[i].assign(nodes_per_layer[i], {});
-                out_deg[i].assign(nodes_per_layer[i], 0L);
-            }
-            for (long i = 0; i <= num_vars; ++i) {
-                in_edges[i].assign(nodes_per_layer[i], {});
-                in_deg[i].assign(nodes_per_layer[i], 0L);
-            }
-        }
-    };
-
     // Per-subtree dead-state cache: tracks which `~state[i][q]` proof lines
     // have already been emitted at or above the current search depth, so
     // the per-call propagator skips re-emission. Pre-populated with the
     // statically-dead set (those emitted at Top by the initialiser) so the
-    // first per-call sweep doesn't redundantly re-derive them.
+    // first per-call sweep doesn't redundantly re-derive them. One reversible
+    // bit per (layer, node), every layer padded to the widest, so a search node
+    // pays only for the words it sets, not for a copy of the whole cache.
     struct DeadCache
     {
-        vector<set<long>> dead;
-    };
+        const ReversibleBitset & dead;
+        long layer_width;
+        ReversibleTrail & trail;
 
-    auto emit_dead_state(ProofLogger * const logger, DeadCache & cache, const vector<vector<ProofFlag>> & state_at_pos_flags, long i, long q,
-        const ReasonLiterals & reason) -> void
-    {
-        if (! logger || logger->get_assertion_level() != AssertionLevel::Off)
-            return;
-        if (cache.dead[i].contains(q))
-            return;
-        logger->emit_rup_proof_line_under_reason(reason, WPBSum{} + 1_i * ! state_at_pos_flags[i][q] >= 1_i, ProofLevel::Current);
-        cache.dead[i].insert(q);
-    }
-
-    auto initialise_graph(MDDGraph & graph, DeadCache & cache, const vector<IntegerVariableID> & vars, const vector<long> & nodes_per_layer,
-        const vector<vector<unordered_map<Integer, long>>> & layer_transitions, const vector<long> & accepting_terminals,
-        const vector<vector<ProofFlag>> & state_at_pos_flags, const State & state, const ReasonLiterals & reason, ProofLogger * const logger)
-    {
-        auto num_vars = vars.size();
-
-        // Forward phase: nodes reachable from the root with the current domains.
-        graph.nodes[0].insert(0);
-        for (size_t i = 0; i < num_vars; ++i) {
-            for (auto val : state.each_value_immutable(vars[i])) {
-                for (const auto & q : graph.nodes[i]) {
-                    auto next_q = find_transition(layer_transitions[i][q], val);
-                    if (next_q != -1) {
-                        graph.nodes_supporting[i][val].insert(q);
-                        graph.nodes[i + 1].insert(next_q);
-                    }
-                }
-            }
-
-            // Nodes at layer i+1 that aren't forward-reachable under current
-            // dom get a single ~state[i+1][next_q] line at Current, gated on
-            // the cache. The initialiser's backward chains (Top) plus the
-            // cached ~state[i][q] lines for parents we already eliminated at
-            // earlier layers let UP close this RUP.
-            for (long next_q = 0; next_q < nodes_per_layer[i + 1]; ++next_q) {
-                if (graph.nodes[i + 1].contains(next_q))
-                    continue;
-                emit_dead_state(logger, cache, state_at_pos_flags, i + 1, next_q, reason);
-            }
+        [[nodiscard]] auto contains(long i, long q) const -> bool
+        {
+            return dead.test(trail, static_cast<size_t>(i * layer_width + q));
         }
 
-        // Restrict the final layer to accepting terminals that are also reachable.
-        set<long> reachable_accepting;
-        for (auto f : accepting_terminals)
-            if (graph.nodes[num_vars].contains(f))
-                reachable_accepting.insert(f);
-
-        // Non-accepting terminals are statically dead and already covered by
-        // the initialiser's Top emission. Anything reachable under current dom
-        // but not accepting was already in `cache.dead` from the static set,
-        // so emit_dead_state is a no-op here for normal MDDs; we still call it
-        // so cases where the static reduction missed something (it shouldn't,
-        // but be safe) are covered.
-        for (const auto & q : graph.nodes[num_vars])
-            if (! reachable_accepting.contains(q))
-                emit_dead_state(logger, cache, state_at_pos_flags, num_vars, q, reason);
-        graph.nodes[num_vars] = reachable_accepting;
-
-        // Backward phase: drop nodes with no path forward to an accepting terminal.
-        for (long i = num_vars - 1; i >= 0; --i) {
-            vector<char> node_is_support(nodes_per_layer[i], 0);
-
-            for (auto val : state.each_value_mutable(vars[i])) {
-                set<long> nodes_for_val = graph.nodes_supporting[i][val];
-                for (const auto & q : nodes_for_val) {
-                    auto next_q = find_transition(layer_transitions[i][q], val);
-                    if (next_q != -1 && graph.nodes[i + 1].contains(next_q)) {
-                        graph.out_edges[i][q][next_q].emplace(val);
-                        graph.out_deg[i][q]++;
-                        graph.in_edges[i + 1][next_q][q].emplace(val);
-                        graph.in_deg[i + 1][next_q]++;
-                        node_is_support[q] = 1;
-                    }
-                    else {
-                        graph.nodes_supporting[i][val].erase(q);
-                    }
-                }
-            }
-
-            set<long> gn = graph.nodes[i];
-            for (const auto & q : gn) {
-                if (! node_is_support[q]) {
-                    graph.nodes[i].erase(q);
-                    emit_dead_state(logger, cache, state_at_pos_flags, i, q, reason);
-                }
-            }
+        auto insert(long i, long q) -> void
+        {
+            dead.set(trail, static_cast<size_t>(i * layer_width + q));
         }
+    };
 
-        graph.initialised = true;
-    }
-
-    auto decrement_outdeg(MDDGraph & graph, DeadCache & cache, const long i, const long k, const vector<vector<ProofFlag>> & state_at_pos_flags,
-        const ReasonLiterals & reason, ProofLogger * const logger) -> void
+    auto widest_layer(const vector<long> & nodes_per_layer) -> long
     {
-        graph.out_deg[i][k]--;
-        if (graph.out_deg[i][k] == 0 && i > 0) {
-            // Emit before recursing to parents at i-1: ~state[i-1][l]'s RUP
-            // (when l's out_deg also hits 0 in the recursion) consumes the
-            // forward chain `state[i-1][l] ∧ x[i-1]=val → state[i][T(l,val)]`
-            // together with ~state[i][T(l,val)], so all dead children at
-            // layer i must be in the proof DB before any layer-(i-1) parent
-            // is derived. emit_dead_state is cache-gated, so the recursion
-            // can still reach this node without re-emission.
-            emit_dead_state(logger, cache, state_at_pos_flags, i, k, reason);
-            for (const auto & edge : graph.in_edges[i][k]) {
-                auto l = edge.first;
-                graph.out_edges[i - 1][l].erase(k);
-                for (const auto & val : edge.second) {
-                    graph.nodes_supporting[i - 1][val].erase(l);
-                    decrement_outdeg(graph, cache, i - 1, l, state_at_pos_flags, reason, logger);
-                }
-            }
-            graph.in_edges[i][k] = {};
-        }
+        return nodes_per_layer.empty() ? 0 : *max_element(nodes_per_layer);
     }
 
-    auto decrement_indeg(MDDGraph & graph, DeadCache & cache, const long i, const long k, const vector<vector<ProofFlag>> & state_at_pos_flags,
-        const ReasonLiterals & reason, ProofLogger * const logger) -> void
+    auto emit_dead_state(ProofLogger * const logger, DeadCache & cache, const vector<vector<ProofFlag>> & state_at_pos_flags, long i, long q,
+        const ReasonLiterals & reason) -> void
     {
-        graph.in_deg[i][k]--;
-        if (graph.in_deg[i][k] == 0 && cmp_less(i, graph.in_deg.size() - 1)) {
-            emit_dead_state(logger, cache, state_at_pos_flags, i, k, reason);
-            for (const auto & edge : graph.out_edges[i][k]) {
-                auto l = edge.first;
-                graph.in_edges[i + 1][l].erase(k);
-                for (const auto & val : edge.second) {
-                    graph.nodes_supporting[i][val].erase(k);
-                    decrement_indeg(graph, cache, i + 1, l, state_at_pos_flags, reason, logger);
-                }
-            }
-            graph.out_edges[i][k] = {};
-        }
+        if (! logger || logger->get_assertion_level() != AssertionLevel::Off)
+            return;
+        if (cache.contains(i, q))
+            return;
+        logger->emit_rup_proof_line_under_reason(reason, WPBSum{} + 1_i * ! state_at_pos_flags[i][q] >= 1_i, ProofLevel::Current);
+        cache.insert(i, q);
     }
 
     auto propagate_mdd(const vector<IntegerVariableID> & vars, const vector<long> & nodes_per_layer,
-        const vector<vector<unordered_map<Integer, long>>> & layer_transitions, const vector<long> & accepting_terminals,
-        const vector<vector<ProofFlag>> & state_at_pos_flags, const ConstraintStateHandle & graph_handle, const ConstraintStateHandle & cache_handle,
-        const State & state, auto & inference, ProofLogger * const logger, const ConstraintID & owner) -> void
+        const vector<vector<ProofFlag>> & state_at_pos_flags, const LayeredGraph & graph, const ReversibleBitset & dead_states, const State & state,
+        auto & inference, ProofLogger * const logger, const DomainDelta & delta, const ConstraintID & owner) -> void
     {
-        auto & graph = any_cast<MDDGraph &>(state.get_constraint_state(graph_handle));
-        auto & cache = any_cast<DeadCache &>(state.get_constraint_state(cache_handle));
+        auto & trail = state.reversible_trail();
+        DeadCache cache{dead_states, widest_layer(nodes_per_layer), trail};
         auto reason = eager_reason(generic_reason(vars), state);
 
-        if (! graph.initialised)
-            initialise_graph(graph, cache, vars, nodes_per_layer, layer_transitions, accepting_terminals, state_at_pos_flags, state, reason, logger);
-
-        for (size_t i = 0; i < graph.nodes_supporting.size(); ++i) {
-            for (const auto & val_and_nodes : graph.nodes_supporting[i]) {
-                auto val = val_and_nodes.first;
-
-                if (! graph.nodes_supporting[i][val].empty() && ! state.in_domain(vars[i], val)) {
-                    for (const auto & q : graph.nodes_supporting[i][val]) {
-                        auto next_q = find_transition(layer_transitions[i][q], val);
-
-                        if (graph.out_edges[i][q].contains(next_q)) {
-                            graph.out_edges[i][q][next_q].erase(val);
-                            if (graph.out_edges[i][q][next_q].empty())
-                                graph.out_edges[i][q].erase(next_q);
-                        }
-                        if (graph.in_edges[i + 1][next_q].contains(q)) {
-                            graph.in_edges[i + 1][next_q][q].erase(val);
-                            if (graph.in_edges[i + 1][next_q][q].empty())
-                                graph.in_edges[i + 1][next_q].erase(q);
-                        }
-
-                        decrement_outdeg(graph, cache, i, q, state_at_pos_flags, reason, logger);
-                        decrement_indeg(graph, cache, i + 1, next_q, state_at_pos_flags, reason, logger);
-                    }
-                    graph.nodes_supporting[i][val] = {};
-                }
-            }
+        // Each dead node's line goes in before any of its edges is removed:
+        // ~state[i-1][l]'s RUP, when l's last out-edge went to this node,
+        // consumes the forward chain `state[i-1][l] ∧ x[i-1]=val →
+        // state[i][T(l,val)]` together with ~state[i][T(l,val)], and
+        // symmetrically for in-edges and the initialiser's backward chains.
+        LayeredGraph::NodeDied node_died;
+        if (logger && logger->get_assertion_level() == AssertionLevel::Off)
+            node_died = [&](size_t i, long q) { emit_dead_state(logger, cache, state_at_pos_flags, static_cast<long>(i), q, reason); };
+
+        // As for Regular: when this last finished, the supported values and the
+        // domains agreed, so only changed layers can have edges to remove.
+        vector<pair<size_t, Integer>> lost_support;
+        if (delta.everything_changed()) {
+            for (size_t i = 0; i < vars.size(); ++i)
+                graph.remove_values_not_in_domain(trail, state, i, vars[i], node_died, lost_support);
+            for (size_t i = 0; i < vars.size(); ++i)
+                for (auto val : state.each_value_mutable(vars[i]))
+                    if (! graph.supported(trail, i, val))
+                        inference.infer_not_equal(logger, vars[i], val, JustifyUsingRUP{hints::MDD{owner}}, reason);
+            return;
         }
 
-        for (size_t i = 0; i < graph.nodes_supporting.size(); ++i) {
-            for (auto val : state.each_value_mutable(vars[i])) {
-                if (graph.nodes_supporting[i][val].empty())
-                    inference.infer_not_equal(logger, vars[i], val, JustifyUsingRUP{hints::MDD{owner}}, reason);
-            }
-        }
+        for (const auto & entry : delta.changed())
+            graph.remove_values_not_in_domain(trail, state, entry.position, vars[entry.position], node_died, lost_support);
+        for (const auto & [i, val] : lost_support)
+            if (state.in_domain(vars[i], val))
+                inference.infer_not_equal(logger, vars[i], val, JustifyUsingRUP{hints::MDD{owner}}, reason);
     }
 
     // Static forward + backward reachability under initial domains. Returns
@@ -432,6 +287,7 @@ struct MDD::Bridge
 {
     vector<vector<ProofFlag>> state_at_pos_flags;
     vector<set<long>> static_dead;
+    LayeredGraph graph;
 };
 
 MDD::MDD(vector<IntegerVariableID> v, vector<vector<unordered_map<Integer, long>>> t, vector<long> npl, vector<long> ats) :
@@ -455,9 +311,17 @@ auto MDD::clone() const -> unique_ptr<Constraint>
 
 auto MDD::prepare(Propagators &, State & initial_state, ProofModel * const) -> bool
 {
+    // The diagram's edges, over the values each variable can take now.
+    vector<vector<LayeredGraph::Edge>> edges(_vars.size());
+    for (size_t i = 0; i < _vars.size(); ++i)
+        for (auto val : initial_state.each_value_immutable(_vars[i]))
+            for (long q = 0; q < _nodes_per_layer[i]; ++q)
+                if (auto next_q = find_transition(_layer_transitions[i][q], val); next_q != -1)
+                    edges[i].push_back(LayeredGraph::Edge{q, val, next_q});
+
     _bridge = make_shared<Bridge>();
-    _graph_idx = initial_state.add_constraint_state(MDDGraph(static_cast<long>(_vars.size()), _nodes_per_layer));
-    _dead_cache_idx = initial_state.add_constraint_state(DeadCache{vector<set<long>>(_nodes_per_layer.size())});
+    _bridge->graph = LayeredGraph{initial_state.reversible_trail(), _nodes_per_layer, edges, _accepting_terminals};
+    _dead_states = ReversibleBitset{initial_state.reversible_trail(), _nodes_per_layer.size() * static_cast<size_t>(widest_layer(_nodes_per_layer))};
 
     // Per-layer OPB alphabet: union of transition-keys for that layer and each variable's
     // initial domain. Values in the domain but with no transition need explicit "no-transition"
@@ -524,21 +388,22 @@ auto MDD::install_propagators(Propagators & propagators) -> void
     // statically-dead nodes. In assertion mode the per-call inferences are
     // asserted under the typed hint instead, so the scaffolding is skipped.
     propagators.install_initialiser([vars = _vars, npl = _nodes_per_layer, t = _layer_transitions, ats = _accepting_terminals, bridge = _bridge,
-                                        dead_cache_handle = _dead_cache_idx](State & state, auto &, ProofLogger * const logger) -> void {
+                                        dead_states = _dead_states](State & state, auto &, ProofLogger * const logger) -> void {
         if (! logger || logger->get_assertion_level() != AssertionLevel::Off)
             return;
         bridge->static_dead = compute_static_dead(vars, npl, t, ats, state);
         emit_top_scaffolding(logger, vars, npl, t, bridge->state_at_pos_flags, state, bridge->static_dead);
-        auto & cache = any_cast<DeadCache &>(state.get_constraint_state(dead_cache_handle));
+        DeadCache cache{dead_states, widest_layer(npl), state.reversible_trail()};
         for (size_t i = 0; i < bridge->static_dead.size(); ++i)
-            cache.dead[i].insert(bridge->static_dead[i].begin(), bridge->static_dead[i].end());
+            for (auto q : bridge->static_dead[i])
+                cache.insert(static_cast<long>(i), q);
     });
 
     propagators.install(
         constraint_id(),
-        [v = _vars, t = _layer_transitions, npl = _nodes_per_layer, ats = _accepting_terminals, g = _graph_idx, dc = _dead_cache_idx,
-            bridge = _bridge, owner = constraint_id()](const State & state, auto & inference, ProofLogger * const logger) -> PropagatorState {
-            propagate_mdd(v, npl, t, ats, bridge->state_at_pos_flags, g, dc, state, inference, logger, owner);
+        [v = _vars, npl = _nodes_per_layer, dc = _dead_states, bridge = _bridge, owner = constraint_id()](
+            const State & state, auto & inference, ProofLogger * const logger, const DomainDelta & delta) -> PropagatorState {
+            propagate_mdd(v, npl, bridge->state_at_pos_flags, bridge->graph, dc, state, inference, logger, delta, owner);
             return PropagatorState::Enable;
         },
         triggers);
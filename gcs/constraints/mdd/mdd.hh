@@ -66,8 +66,7 @@ namespace gcs
         const std::vector<long> _nodes_per_layer;
         const std::vector<long> _accepting_terminals;
         std::shared_ptr<Bridge> _bridge;
-        innards::ConstraintStateHandle _graph_idx;
-        innards::ConstraintStateHandle _dead_cache_idx;
+        innards::ReversibleBitset _dead_states;
         std::vector<std::set<Integer>> _opb_alphabet;
 
         virtual auto prepare(innards::Propagators &, innards::State &, innards::ProofModel * const) -> bool override;
@@ -9,20 +9,30 @@
 #include <gcs/innards/s_expr.hh>
 #include <gcs/innards/state.hh>
 
+#include <util/overloaded.hh>
+
 #include <algorithm>
+#include <atomic>
 #include <cstddef>
 #include <cstdint>
 #include <limits>
+#include <map>
 #include <memory>
 #include <optional>
 #include <utility>
+#include <variant>
 #include <vector>
 
 using namespace gcs;
 using namespace gcs::innards;
 
+using std::atomic;
 using std::make_shared;
 using std::make_unique;
+using std::map;
+using std::memory_order_acquire;
+using std::memory_order_release;
+using std::min;
 using std::nullopt;
 using std::optional;
 using std::pair;
@@ -33,6 +43,7 @@ using std::unique;
 using std::unique_ptr;
 using std::vector;
 using std::ranges::sort;
+using std::ranges::stable_sort;
 
 namespace
 {
@@ -41,15 +52,61 @@ namespace
         if (std::find(vs.begin(), vs.end(), v) == vs.end())
             vs.push_back(v);
     }
+
+    auto distinct_vars_of(const Nogood & nogood) -> vector<IntegerVariableID>
+    {
+        vector<IntegerVariableID> vs;
+        for (const auto & lit : nogood)
+            add_distinct(vs, lit.var);
+        return vs;
+    }
+
+    auto contains(const Nogood & nogood, const IntegerVariableCondition & lit) -> optional<size_t>
+    {
+        for (size_t p = 0; p < nogood.size(); ++p)
+            if (nogood[p] == lit)
+                return p;
+        return nullopt;
+    }
+
+    struct Subsumes
+    {
+    };
+
+    struct Strengthens
+    {
+        size_t position;
+    };
+
+    // Does the clause of a's negations subsume b's, or resolve with it to give
+    // a subset of b's? In nogood terms: is every literal of a in b, or is
+    // every literal but one in b and that one's negation in b instead, in which
+    // case b can lose its negation.
+    auto compare(const Nogood & a, const Nogood & b) -> std::variant<std::monostate, Subsumes, Strengthens>
+    {
+        optional<size_t> flipped;
+        for (const auto & lit : a) {
+            if (contains(b, lit))
+                continue;
+            if (flipped)
+                return std::monostate{};
+            flipped = contains(b, ! lit);
+            if (! flipped)
+                return std::monostate{};
+        }
+        if (flipped)
+            return Strengthens{*flipped};
+        return Subsumes{};
+    }
 }
 
-auto NogoodStore::add(Nogood nogood) -> void
+auto NogoodStore::add(Nogood nogood, optional<ProofLine> proof_line) -> void
 {
-    vector<IntegerVariableID> vs;
-    for (const auto & lit : nogood)
-        add_distinct(vs, lit.var);
-    _vars->push_back(move(vs));
+    _literals += nogood.size();
+    _vars->push_back(distinct_vars_of(nogood));
     _nogoods->push_back(move(nogood));
+    _activity->push_back(0);
+    _proof_lines.push_back(move(proof_line));
 }
 
 auto NogoodStore::size() const -> size_t
@@ -57,6 +114,201 @@ auto NogoodStore::size() const -> size_t
     return _nogoods->size();
 }
 
+auto NogoodStore::literals() const -> size_t
+{
+    return _literals;
+}
+
+auto NogoodStore::nogood(size_t index) const -> const Nogood &
+{
+    return (*_nogoods)[index];
+}
+
+auto NogoodStore::activity(size_t index) const -> unsigned long long
+{
+    return (*_activity)[index];
+}
+
+auto NogoodStore::reduce(const NogoodReduction & policy, size_t protect_from, ProofLogger * const logger) -> Reduced
+{
+    auto & nogoods = *_nogoods;
+    auto & activity = *_activity;
+    protect_from = min(protect_from, nogoods.size());
+
+    Reduced result;
+    vector<bool> deleted(nogoods.size(), false);
+    vector<ProofLine> dead_lines;
+
+    auto remove = [&](size_t n) {
+        deleted[n] = true;
+        ++result.deleted;
+        if (_proof_lines[n])
+            dead_lines.push_back(*_proof_lines[n]);
+    };
+
+    if (policy.minimise) {
+        // A nogood that subsumes or strengthens another mentions only variables
+        // that the other does too, so it need only be tried against those that
+        // mention its least mentioned variable.
+        map<IntegerVariableID, vector<size_t>> occurrences;
+        for (size_t n = 0; n < nogoods.size(); ++n)
+            for (const auto & v : (*_vars)[n])
+                occurrences[v].push_back(n);
+
+        vector<size_t> shortest_first;
+        for (size_t n = 0; n < nogoods.size(); ++n)
+            shortest_first.push_back(n);
+        stable_sort(shortest_first, [&](size_t a, size_t b) { return nogoods[a].size() < nogoods[b].size(); });
+
+        for (auto a : shortest_first) {
+            if (deleted[a] || nogoods[a].empty())
+                continue;
+
+            const vector<size_t> * candidates = nullptr;
+            for (const auto & v : distinct_vars_of(nogoods[a])) {
+                auto & o = occurrences[v];
+                if (! candidates || o.size() < candidates->size())
+                    candidates = &o;
+            }
+
+            for (auto b : *candidates) {
+                if (b == a || b >= protect_from || deleted[b] || nogoods[b].size() < nogoods[a].size())
+                    continue;
+
+                overloaded{
+                    [&](std::monostate) {},
+                    [&](Subsumes) { remove(b); },
+                    [&](Strengthens s) {
+                        // The shorter nogood is RUP from a's and b's lines, so
+                        // derive it before b's line goes.
+                        if (logger && ! _proof_lines[b])
+                            return;
+                        _literals -= nogoods[b].size();
+                        nogoods[b].erase(nogoods[b].begin() + s.position);
+                        _literals += nogoods[b].size();
+                        (*_vars)[b] = distinct_vars_of(nogoods[b]);
+                        if (logger) {
+                            dead_lines.push_back(*_proof_lines[b]);
+                            vector<Literal> decisions(nogoods[b].begin(), nogoods[b].end());
+                            _proof_lines[b] = logger->emit_learned_nogood(decisions);
+                        }
+                        ++result.strengthened;
+                    }}
+                    .visit(compare(nogoods[a], nogoods[b]));
+            }
+        }
+    }
+
+    // Then the least active, never touching short ones, nor any learned since
+    // protect_from that has not yet had the chance to be active.
+    vector<size_t> candidates;
+    for (size_t n = 0; n < protect_from; ++n)
+        if (! deleted[n] && nogoods[n].size() > policy.keep_length)
+            candidates.push_back(n);
+    stable_sort(candidates, [&](size_t a, size_t b) {
+        if (activity[a] != activity[b])
+            return activity[a] < activity[b];
+        return nogoods[a].size() > nogoods[b].size();
+    });
+    auto keep = static_cast<size_t>(static_cast<double>(candidates.size()) * policy.keep_fraction);
+    for (size_t c = 0; c + keep < candidates.size(); ++c)
+        remove(candidates[c]);
+
+    if (0 == result.deleted && 0 == result.strengthened) {
+        for (auto & a : activity)
+            a /= 2;
+        return result;
+    }
+
+    // Compact what survives, keeping its order, and age it.
+    size_t kept = 0;
+    for (size_t n = 0; n < nogoods.size(); ++n) {
+        if (deleted[n]) {
+            _literals -= nogoods[n].size();
+            continue;
+        }
+        if (kept != n) {
+            nogoods[kept] = move(nogoods[n]);
+            (*_vars)[kept] = move((*_vars)[n]);
+            _proof_lines[kept] = move(_proof_lines[n]);
+        }
+        activity[kept] = activity[n] / 2;
+        ++kept;
+    }
+    nogoods.resize(kept);
+    _vars->resize(kept);
+    activity.resize(kept);
+    _proof_lines.resize(kept);
+    nogoods.shrink_to_fit();
+    _vars->shrink_to_fit();
+    activity.shrink_to_fit();
+    _proof_lines.shrink_to_fit();
+
+    // Every index has moved, so the propagator must set its watches up again.
+    ++*_generation;
+
+    if (logger && ! dead_lines.empty())
+        logger->delete_proof_lines(dead_lines);
+
+    return result;
+}
+
+struct NogoodExchange::Slot
+{
+    atomic<bool> ready{false};
+    size_t source = 0;
+    Nogood nogood;
+};
+
+NogoodExchange::NogoodExchange(size_t capacity, size_t max_length) :
+    _slots(make_unique<Slot[]>(capacity)),
+    _capacity(capacity),
+    _max_length(max_length)
+{
+}
+
+NogoodExchange::~NogoodExchange() = default;
+
+auto NogoodExchange::publish(size_t source, const Nogood & nogood) -> bool
+{
+    if (nogood.size() > _max_length)
+        return false;
+
+    // Check first, so that a full log stops claiming and the count cannot
+    // run on without bound.
+    if (_claimed.load() >= _capacity)
+        return false;
+    auto index = _claimed.fetch_add(1);
+    if (index >= _capacity)
+        return false;
+
+    auto & slot = _slots[index];
+    slot.source = source;
+    slot.nogood = nogood;
+    slot.ready.store(true, memory_order_release);
+    return true;
+}
+
+auto NogoodExchange::import_into(size_t reader, size_t & cursor, NogoodStore & store) const -> size_t
+{
+    size_t added = 0;
+    for (auto end = min(_claimed.load(), _capacity); cursor < end; ++cursor) {
+        const auto & slot = _slots[cursor];
+        if (! slot.ready.load(memory_order_acquire))
+            break;
+        if (slot.source != reader) {
+            store.add(slot.nogood);
+            ++added;
+        }
+    }
+    return added;
+}
+
+auto NogoodExchange::size() const -> size_t
+{
+    return min(_claimed.load(), _capacity);
+}
+
 Nogoods::Nogoods(vector<Nogood> nogoods, bool refined) : _store(make_shared<NogoodStore>()), _refined(refined)
 {
     for (auto & nogood : nogoods) {
@@ -100,7 +352,8 @@ namespace
     // and the propagator's lazy catch-up for nogoods learned during search.
     template <typename Inference_>
     auto init_watches_for(size_t ni, const vector<Nogood> & nogoods, const vector<vector<IntegerVariableID>> & nogood_vars,
-        vector<pair<size_t, size_t>> & watches, const State & state, Inference_ & inference, ProofLogger * const logger) -> void
+        vector<unsigned long long> & activity, vector<pair<size_t, size_t>> & watches, const State & state, Inference_ & inference,
+        ProofLogger * const logger) -> void
     {
         const auto & nogood = nogoods[ni];
         const auto & vars = nogood_vars[ni];
@@ -116,11 +369,14 @@ namespace
         };
 
         auto w1 = find_unbroken(no_watch);
-        if (! w1)
+        if (! w1) {
+            ++activity[ni];
             inference.contradiction(logger, JustifyUsingRUP{}, generic_reason(vars));
+        }
 
         auto w2 = find_unbroken(*w1);
         if (! w2) {
+            ++activity[ni];
             inference.infer(logger, ! nogood[*w1], JustifyUsingRUP{}, generic_reason(vars));
             watches.emplace_back(*w1, *w1);
         }
@@ -132,7 +388,8 @@ namespace
     // whole store. Correct but does O(store) work per wake; kept for the growable
     // restart-learning store until that is converted to refined watches (C-2).
     auto install_scan_nogoods(Propagators & propagators, const ConstraintID & id, shared_ptr<vector<Nogood>> nogoods,
-        shared_ptr<vector<vector<IntegerVariableID>>> nogood_vars, const vector<IntegerVariableID> & trigger_vars) -> void
+        shared_ptr<vector<vector<IntegerVariableID>>> nogood_vars, shared_ptr<vector<unsigned long long>> activity,
+        shared_ptr<unsigned long long> generation, const vector<IntegerVariableID> & trigger_vars) -> void
     {
         Triggers triggers;
         for (auto & v : trigger_vars)
@@ -144,19 +401,30 @@ namespace
 
         // Init: set up watches for the nogoods present up front (none, for a store
         // that the restart loop will grow during search).
-        propagators.install_initialiser([nogoods, nogood_vars, watches](const State & state, auto & inference, ProofLogger * const logger) -> void {
-            watches->reserve(nogoods->size());
-            for (size_t ni = 0; ni < nogoods->size(); ++ni)
-                init_watches_for(ni, *nogoods, *nogood_vars, *watches, state, inference, logger);
-        });
+        propagators.install_initialiser(
+            [nogoods, nogood_vars, activity, watches](const State & state, auto & inference, ProofLogger * const logger) -> void {
+                watches->reserve(nogoods->size());
+                for (size_t ni = 0; ni < nogoods->size(); ++ni)
+                    init_watches_for(ni, *nogoods, *nogood_vars, *activity, *watches, state, inference, logger);
+            });
+
+        auto seen_generation = make_shared<unsigned long long>(*generation);
 
         propagators.install(
             id,
-            [nogoods, nogood_vars, watches](const State & state, auto & inference, ProofLogger * const logger) -> PropagatorState {
+            [nogoods, nogood_vars, activity, generation, seen_generation, watches](
+                const State & state, auto & inference, ProofLogger * const logger) -> PropagatorState {
+                // The store was reduced, so the nogoods have been renumbered and
+                // every watch must be set up again.
+                if (*seen_generation != *generation) {
+                    watches->clear();
+                    *seen_generation = *generation;
+                }
+
                 // Catch up: initialise watches for any nogoods learned since the last
                 // fire. (A unit/contradiction is propagated here, on first sight.)
                 for (size_t ni = watches->size(); ni < nogoods->size(); ++ni)
-                    init_watches_for(ni, *nogoods, *nogood_vars, *watches, state, inference, logger);
+                    init_watches_for(ni, *nogoods, *nogood_vars, *activity, *watches, state, inference, logger);
 
                 auto is_broken = [&](const Nogood & nogood, size_t p) -> bool { return state.test_literal(nogood[p]) == LiteralIs::DefinitelyTrue; };
 
@@ -183,11 +451,15 @@ namespace
 
                     if (b1 && b2) {
                         auto new1 = find_unbroken(nogood, no_watch, no_watch);
-                        if (! new1)
+                        if (! new1) {
+                            ++(*activity)[ni];
                             inference.contradiction(logger, JustifyUsingRUP{}, generic_reason(vars));
+                        }
                         auto new2 = find_unbroken(nogood, *new1, no_watch);
-                        if (! new2)
+                        if (! new2) {
+                            ++(*activity)[ni];
                             inference.infer(logger, ! nogood[*new1], JustifyUsingRUP{}, generic_reason(vars));
+                        }
                         else {
                             w.first = *new1;
                             w.second = *new2;
@@ -195,15 +467,19 @@ namespace
                     }
                     else if (b1) {
                         auto new1 = find_unbroken(nogood, w.second, no_watch);
-                        if (! new1)
+                        if (! new1) {
+                            ++(*activity)[ni];
                             inference.infer(logger, ! nogood[w.second], JustifyUsingRUP{}, generic_reason(vars));
+                        }
                         else
                             w.first = *new1;
                     }
                     else {
                         auto new2 = find_unbroken(nogood, w.first, no_watch);
-                        if (! new2)
+                        if (! new2) {
+                            ++(*activity)[ni];
                             inference.infer(logger, ! nogood[w.first], JustifyUsingRUP{}, generic_reason(vars));
+                        }
                         else
                             w.second = *new2;
                     }
@@ -228,18 +504,24 @@ namespace
     // "abandoned fire" -- a watch consumed in a propagate() that a sibling clause's
     // contradiction ends before this propagator runs -- is undone for free by the
     // following backtrack.
+    //
+    // A reduction of the store renumbers the nogoods, after which every watch and
+    // every watch state belongs to the wrong clause. The propagator notices the
+    // store's generation has moved on when it next runs, which is at the root of
+    // the following pass, drops all of its watches and sets them up afresh.
     auto install_refined_nogoods(Propagators & propagators, const ConstraintID & id, shared_ptr<vector<Nogood>> nogoods,
-        shared_ptr<vector<vector<IntegerVariableID>>> nogood_vars) -> void
+        shared_ptr<vector<vector<IntegerVariableID>>> nogood_vars, shared_ptr<vector<unsigned long long>> activity,
+        shared_ptr<unsigned long long> generation, const vector<IntegerVariableID> & trigger_vars) -> void
     {
         // Detect any nogood already unit or violated against the initial domains in
         // initialise(), as the coarse path does, so a root-level contradiction is
         // found before search starts (identical search tree). Discards its bookkeeping.
         auto initial_scratch = make_shared<vector<pair<size_t, size_t>>>();
         propagators.install_initialiser(
-            [nogoods, nogood_vars, initial_scratch](const State & state, auto & inference, ProofLogger * const logger) -> void {
+            [nogoods, nogood_vars, activity, initial_scratch](const State & state, auto & inference, ProofLogger * const logger) -> void {
                 initial_scratch->reserve(nogoods->size());
                 for (size_t ni = 0; ni < nogoods->size(); ++ni)
-                    init_watches_for(ni, *nogoods, *nogood_vars, *initial_scratch, state, inference, logger);
+                    init_watches_for(ni, *nogoods, *nogood_vars, *activity, *initial_scratch, state, inference, logger);
             });
 
         // High-water mark of nogoods whose two watches have been set up. Catch-up
@@ -248,10 +530,11 @@ namespace
         // persistent root epoch (never backtracked between passes) -- so this
         // non-backtrackable counter stays in step with the restored watches.
         auto set_up = make_shared<size_t>(0);
+        auto seen_generation = make_shared<unsigned long long>(*generation);
 
         propagators.install(
             id,
-            [nogoods, nogood_vars, set_up](
+            [nogoods, nogood_vars, activity, generation, seen_generation, set_up, trigger_vars](
                 const State & state, auto & inference, ProofLogger * const logger, const RefinedWatchContext & ctx) -> PropagatorState {
                 auto pack = [](size_t a, size_t b) -> std::uint64_t { return (static_cast<std::uint64_t>(a) << 32) | static_cast<std::uint32_t>(b); };
                 // A non-entailed position other than skip1/skip2 to place a watch on.
@@ -267,7 +550,15 @@ namespace
                     return nullopt;
                 };
 
-                if (ctx.fired_payloads().empty()) {
+                // Any fired payload is stale after a reduction, so is ignored.
+                bool rebuild = *seen_generation != *generation;
+                if (rebuild) {
+                    ctx.clear_watches_on(trigger_vars);
+                    *set_up = 0;
+                    *seen_generation = *generation;
+                }
+
+                if (rebuild || ctx.fired_payloads().empty()) {
                     // Root re-propagation (the only time this propagator runs un-fired):
                     // set up the two watches for clauses not yet done. For the fixed
                     // store this is all of them, once; for the growable store it is the
@@ -279,13 +570,16 @@ namespace
                         const auto & nogood = (*nogoods)[ni];
                         const auto & vars = (*nogood_vars)[ni];
                         auto w1 = find_unbroken(nogood, no_watch, no_watch);
-                        if (! w1)
+                        if (! w1) {
+                            ++(*activity)[ni];
                             inference.contradiction(logger, JustifyUsingRUP{}, generic_reason(vars));
+                        }
                         auto w2 = find_unbroken(nogood, *w1, no_watch);
                         if (! w2) {
                             // Unit at first sight: force the negation. The clause is now
                             // satisfied (a root-level fact that persists), so resting a
                             // single watch on the satisfied survivor is enough.
+                            ++(*activity)[ni];
                             inference.infer(logger, ! nogood[*w1], JustifyUsingRUP{}, generic_reason(vars));
                             ctx.watch(nogood[*w1], static_cast<std::uint32_t>(ni));
                             ctx.set_watch_state(static_cast<std::uint32_t>(ni), pack(*w1, *w1));
@@ -324,13 +618,17 @@ namespace
                         // Both watched literals entailed (both consumed). Find two fresh
                         // non-entailed literals; one short means unit, none means clash.
                         auto new1 = find_unbroken(nogood, no_watch, no_watch);
-                        if (! new1)
+                        if (! new1) {
+                            ++(*activity)[ni];
                             inference.contradiction(logger, JustifyUsingRUP{}, generic_reason(vars));
+                        }
                         auto new2 = find_unbroken(nogood, *new1, no_watch);
-                        if (! new2)
+                        if (! new2) {
                             // Unit: infer; both consumed watches are restored on backtrack,
                             // so leave watch_state at (p, q) to match them.
+                            ++(*activity)[ni];
                             inference.infer(logger, ! nogood[*new1], JustifyUsingRUP{}, generic_reason(vars));
+                        }
                         else {
                             ctx.watch(nogood[*new1], key);
                             ctx.watch(nogood[*new2], key);
@@ -340,8 +638,10 @@ namespace
                     else if (b1) {
                         // Watch at p fired (consumed); q still armed. Move p, or unit on q.
                         auto new1 = find_unbroken(nogood, q, no_watch);
-                        if (! new1)
+                        if (! new1) {
+                            ++(*activity)[ni];
                             inference.infer(logger, ! nogood[q], JustifyUsingRUP{}, generic_reason(vars));
+                        }
                         else {
                             ctx.watch(nogood[*new1], key);
                             ctx.set_watch_state(key, pack(*new1, q));
@@ -350,8 +650,10 @@ namespace
                     else {
                         // Watch at q fired (consumed); p still armed. Move q, or unit on p.
                         auto new2 = find_unbroken(nogood, p, no_watch);
-                        if (! new2)
+                        if (! new2) {
+                            ++(*activity)[ni];
                             inference.infer(logger, ! nogood[p], JustifyUsingRUP{}, generic_reason(vars));
+                        }
                         else {
                             ctx.watch(nogood[*new2], key);
                             ctx.set_watch_state(key, pack(p, *new2));
@@ -368,9 +670,9 @@ auto Nogoods::install_propagators(Propagators & propagators) -> void
 {
     // The nogood data is shared with the store, so additions are visible here.
     if (_refined)
-        install_refined_nogoods(propagators, constraint_id(), _store->_nogoods, _store->_vars);
+        install_refined_nogoods(propagators, constraint_id(), _store->_nogoods, _store->_vars, _store->_activity, _store->_generation, _trigger_vars);
     else
-        install_scan_nogoods(propagators, constraint_id(), _store->_nogoods, _store->_vars, _trigger_vars);
+        install_scan_nogoods(propagators, constraint_id(), _store->_nogoods, _store->_vars, _store->_activity, _store->_generation, _trigger_vars);
 }
 
 auto Nogoods::constraint_type() const -> string
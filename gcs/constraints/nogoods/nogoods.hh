@@ -2,10 +2,15 @@
 #define GLASGOW_CONSTRAINT_SOLVER_GUARD_GCS_CONSTRAINTS_NOGOODS_NOGOODS_HH
 
 #include <gcs/constraint.hh>
+#include <gcs/innards/proofs/proof_line.hh>
+#include <gcs/innards/proofs/proof_logger-fwd.hh>
+#include <gcs/restarts.hh>
 #include <gcs/variable_condition.hh>
 
+#include <atomic>
 #include <cstddef>
 #include <memory>
+#include <optional>
 #include <vector>
 
 namespace gcs
@@ -21,29 +26,141 @@ namespace gcs
      * constraint's propagator and whoever appends to it during search (the
      * restart loop). Held by shared_ptr so a nogood can be added mid-search while
      * the propagator reads the same store; the propagator initialises a newly
-     * added nogood's watches lazily on its next fire.
+     * added nogood's watches lazily on its next fire. The restart loop also
+     * thins it out with reduce(), which renumbers what is left, and the
+     * propagator notices this and sets up every watch afresh.
      *
-     * It is owned by the search driver (or, later, a per-thread parallel worker),
-     * never by user code --- restart nogoods are an internal mechanism.
+     * It is owned by the search driver, or by a per-thread parallel worker, never
+     * by user code --- restart nogoods are an internal mechanism. Workers in a
+     * portfolio pass nogoods between their stores by way of a NogoodExchange.
      *
      * \ingroup Constraints
      */
     class NogoodStore
     {
     public:
+        /**
+         * \brief What one call to reduce() did.
+         */
+        struct Reduced final
+        {
+            /// Nogoods deleted, whether subsumed or inactive.
+            std::size_t deleted = 0;
+
+            /// Nogoods that lost a literal to self-subsuming resolution.
+            std::size_t strengthened = 0;
+        };
+
         /**
          * \brief Append a nogood. Called by the owning search thread between
          * propagations (e.g. at a restart boundary), not concurrently with the
          * propagator.
+         *
+         * \param proof_line the nogood's line in the proof, if it was derived
+         * there, so that reduce() can delete it.
          */
-        auto add(Nogood nogood) -> void;
+        auto add(Nogood nogood, std::optional<innards::ProofLine> proof_line = std::nullopt) -> void;
 
         [[nodiscard]] auto size() const -> std::size_t;
 
+        /**
+         * \brief The total number of literals over every nogood held.
+         */
+        [[nodiscard]] auto literals() const -> std::size_t;
+
+        /**
+         * \brief The nogood at this index, in the order they were added, less
+         * any since deleted by reduce().
+         */
+        [[nodiscard]] auto nogood(std::size_t index) const -> const Nogood &;
+
+        /**
+         * \brief How many times the nogood at this index has propagated or
+         * failed since it was added, halved at each reduce().
+         */
+        [[nodiscard]] auto activity(std::size_t index) const -> unsigned long long;
+
+        /**
+         * \brief Minimise and thin out the nogoods, as described by
+         * NogoodReduction, deleting the proof lines of those deleted.
+         *
+         * Nogoods from \c protect_from onwards are neither deleted nor
+         * strengthened, and stay at the end in the order they were added;
+         * everything before them may move. Called by the owning search thread
+         * at a restart boundary, at the root, where the propagator rebuilds its
+         * watches when it next runs.
+         */
+        auto reduce(const NogoodReduction & policy, std::size_t protect_from, innards::ProofLogger * const logger) -> Reduced;
+
     private:
         friend class Nogoods;
         std::shared_ptr<std::vector<Nogood>> _nogoods = std::make_shared<std::vector<Nogood>>();
         std::shared_ptr<std::vector<std::vector<IntegerVariableID>>> _vars = std::make_shared<std::vector<std::vector<IntegerVariableID>>>();
+        std::shared_ptr<std::vector<unsigned long long>> _activity = std::make_shared<std::vector<unsigned long long>>();
+        std::shared_ptr<unsigned long long> _generation = std::make_shared<unsigned long long>(0);
+        std::vector<std::optional<innards::ProofLine>> _proof_lines;
+        std::size_t _literals = 0;
+    };
+
+    /**
+     * \brief A fixed-capacity, append-only log of nogoods, through which the
+     * threads of a parallel portfolio share what they learn.
+     *
+     * A thread publishes each nogood it learns, and at each of its restart
+     * boundaries reads whatever the other threads have published since it last
+     * looked, adding it to its own NogoodStore. Nothing is ever removed or
+     * overwritten, so a reader needs no lock: a publisher claims a slot with an
+     * atomic increment, fills it, and then marks it ready, and a reader stops at
+     * the first slot that is not yet ready and resumes from there next time.
+     * Once every slot is claimed, further nogoods are simply not shared.
+     *
+     * Only short nogoods are accepted. A reduced nld-nogood holds one decision
+     * from each of a distinct set of levels, so its length is also its literal
+     * block distance, the usual measure of how useful a learned clause is
+     * likely to be; a long one prunes little and costs every reader a watch.
+     *
+     * \ingroup Constraints
+     */
+    class NogoodExchange
+    {
+    public:
+        /**
+         * \brief Room for at most \c capacity nogoods, each of at most
+         * \c max_length literals.
+         */
+        NogoodExchange(std::size_t capacity, std::size_t max_length);
+        ~NogoodExchange();
+
+        NogoodExchange(const NogoodExchange &) = delete;
+        auto operator=(const NogoodExchange &) -> NogoodExchange & = delete;
+
+        /**
+         * \brief Share a nogood learned by thread \c source. Returns false if
+         * it was too long, or if the log is full. Safe to call concurrently.
+         */
+        auto publish(std::size_t source, const Nogood & nogood) -> bool;
+
+        /**
+         * \brief Add to \c store every ready nogood from \c cursor onwards
+         * that was published by a thread other than \c reader, and advance
+         * \c cursor past them. Returns how many were added. Safe to call
+         * concurrently with publish(), and with other readers each with their
+         * own cursor.
+         */
+        auto import_into(std::size_t reader, std::size_t & cursor, NogoodStore & store) const -> std::size_t;
+
+        /**
+         * \brief How many nogoods have been published, including any whose
+         * slots are still being filled.
+         */
+        [[nodiscard]] auto size() const -> std::size_t;
+
+    private:
+        struct Slot;
+        std::unique_ptr<Slot[]> _slots;
+        std::size_t _capacity;
+        std::size_t _max_length;
+        std::atomic<std::size_t> _claimed{0};
     };
 
     /**
@@ -14,6 +14,7 @@
 #include <optional>
 #include <random>
 #include <set>
+#include <thread>
 #include <tuple>
 #include <utility>
 #include <vector>
@@ -37,6 +38,7 @@ using std::nullopt;
 using std::pair;
 using std::set;
 using std::size_t;
+using std::thread;
 using std::tuple;
 using std::uniform_int_distribution;
 using std::vector;
@@ -344,6 +346,80 @@ namespace
             run_differential(domains, nogoods);
         run_random_differentials();
     }
+    // The exchange filters by length, never gives a reader its own nogoods,
+    // and, with several threads publishing at once, loses nothing and
+    // duplicates nothing until it is full.
+    auto run_exchange_tests() -> void
+    {
+        Problem p;
+        auto x = p.create_integer_variable(0_i, 100_i);
+
+        NogoodExchange short_only{10, 2};
+        if (short_only.publish(0, Nogood{x == 1_i, x == 2_i, x == 3_i}) || ! short_only.publish(0, Nogood{x == 1_i}) ||
+            ! short_only.publish(1, Nogood{x == 2_i, x != 3_i}))
+            throw UnexpectedException{"nogood exchange length filter wrong"};
+
+        NogoodStore own_only;
+        size_t cursor = 0;
+        if (short_only.import_into(0, cursor, own_only) != 1 || own_only.size() != 1 || own_only.nogood(0) != Nogood{x == 2_i, x != 3_i} ||
+            cursor != 2 || short_only.import_into(0, cursor, own_only) != 0)
+            throw UnexpectedException{"nogood exchange imported the wrong nogoods"};
+
+        constexpr size_t n_publishers = 4, per_publisher = 50, capacity = 150;
+        NogoodExchange shared{capacity, 1};
+        vector<thread> publishers;
+        for (size_t t = 0; t < n_publishers; ++t)
+            publishers.emplace_back([&, t]() {
+                for (size_t i = 0; i < per_publisher; ++i)
+                    shared.publish(t, Nogood{x == Integer{static_cast<long long>(t * per_publisher + i)}});
+            });
+        for (auto & publisher : publishers)
+            publisher.join();
+
+        NogoodStore everything;
+        cursor = 0;
+        if (shared.size() != capacity || shared.import_into(n_publishers, cursor, everything) != capacity)
+            throw UnexpectedException{"nogood exchange lost or overran nogoods"};
+        set<Integer> values;
+        for (size_t n = 0; n < everything.size(); ++n)
+            values.insert(everything.nogood(n).front().value);
+        if (values.size() != capacity)
+            throw UnexpectedException{"nogood exchange duplicated nogoods"};
+    }
+
+    // Reduction deletes subsumed nogoods, strengthens by self-subsuming
+    // resolution, deletes the least active of the rest, longest first, and
+    // never touches a short nogood or one after protect_from.
+    auto run_reduction_tests() -> void
+    {
+        Problem p;
+        auto x = p.create_integer_variable(0_i, 10_i);
+        auto y = p.create_integer_variable(0_i, 10_i);
+        auto z = p.create_integer_variable(0_i, 10_i);
+
+        NogoodStore minimised;
+        minimised.add(Nogood{x == 1_i, y == 2_i});
+        minimised.add(Nogood{y == 2_i, x == 1_i, z == 3_i});
+        minimised.add(Nogood{x != 1_i, y == 2_i, z != 4_i});
+        minimised.add(Nogood{x == 1_i, y == 2_i, z == 9_i});
+        auto reduced = minimised.reduce(NogoodReduction{.keep_fraction = 1.0}, 3, nullptr);
+        if (reduced.deleted != 1 || reduced.strengthened != 1 || minimised.size() != 3 || minimised.literals() != 7 ||
+            minimised.nogood(0) != Nogood{x == 1_i, y == 2_i} || minimised.nogood(1) != Nogood{y == 2_i, z != 4_i} ||
+            minimised.nogood(2) != Nogood{x == 1_i, y == 2_i, z == 9_i})
+            throw UnexpectedException{"nogood reduction minimised wrongly"};
+
+        NogoodStore thinned;
+        thinned.add(Nogood{x == 1_i, y == 1_i, z == 1_i});
+        thinned.add(Nogood{x == 2_i, y == 2_i, z == 2_i, x != 3_i});
+        thinned.add(Nogood{x == 3_i, y == 3_i});
+        thinned.add(Nogood{x == 4_i, y == 4_i});
+        thinned.add(Nogood{z == 5_i});
+        thinned.add(Nogood{x == 6_i, y == 6_i, z == 6_i, x != 7_i});
+        reduced = thinned.reduce(NogoodReduction{.keep_fraction = 0.5, .keep_length = 1, .minimise = false}, 5, nullptr);
+        if (reduced.deleted != 2 || reduced.strengthened != 0 || thinned.size() != 4 || thinned.nogood(0).front() != (x == 3_i) ||
+            thinned.nogood(1).front() != (x == 4_i) || thinned.nogood(2).front() != (z == 5_i) || thinned.nogood(3).front() != (x == 6_i))
+            throw UnexpectedException{"nogood reduction deleted the wrong nogoods"};
+    }
 }
 
 auto main(int argc, char * argv[]) -> int
@@ -354,6 +430,9 @@ auto main(int argc, char * argv[]) -> int
     // solutions on every instance: a pure same-tree differential (no proof needed).
     run_all_differentials();
 
+    run_exchange_tests();
+    run_reduction_tests();
+
     // Each mode independently checked against the brute-force oracle and the
     // per-node unit-propagation reference, with its proof verified when veripb is
     // available.
@@ -1,3 +1,4 @@
+#include <gcs/constraints/innards/layered_graph.hh>
 #include <gcs/constraints/regular/hints.hh>
 #include <gcs/constraints/regular/regex.hh>
 #include <gcs/constraints/regular/regular.hh>
@@ -24,22 +25,18 @@
 #endif
 
 #include <algorithm>
-#include <any>
 #include <memory>
 #include <optional>
 #include <set>
 #include <sstream>
 #include <string>
 #include <unordered_map>
-#include <unordered_set>
 #include <utility>
 #include <variant>
 
 using namespace gcs;
 using namespace gcs::innards;
 
-using std::any_cast;
-using std::cmp_less;
 using std::make_shared;
 using std::max;
 using std::min;
@@ -53,7 +50,6 @@ using std::string;
 using std::stringstream;
 using std::unique_ptr;
 using std::unordered_map;
-using std::unordered_set;
 using std::vector;
 using std::ranges::sort;
 
@@ -89,41 +85,28 @@ namespace
         return {sym_set.begin(), sym_set.end()};
     }
 
-    struct RegularGraph
-    {
-        // states_supporting[i][val] = states in layer i with an outgoing transition
-        // on val that currently sit on a root-to-accepting path.
-        vector<unordered_map<Integer, set<long>>> states_supporting;
-        // out_edges[i][q] maps target state q' (in layer i+1) to the set of values
-        // labelling edges q -> q'.
-        vector<vector<unordered_map<long, unordered_set<Integer>>>> out_edges;
-        vector<vector<long>> out_deg;
-        vector<vector<unordered_map<long, unordered_set<Integer>>>> in_edges;
-        vector<vector<long>> in_deg;
-        // nodes[i] = active states in layer i.
-        vector<set<long>> nodes;
-        bool initialised = false;
-
-        explicit RegularGraph(long num_vars, long num_states) :
-            states_supporting(vector<unordered_map<Integer, set<long>>>(num_vars)),
-            out_edges(vector<vector<unordered_map<long, unordered_set<Integer>>>>(
-                num_vars, vector<unordered_map<long, unordered_set<Integer>>>(num_states))),
-            out_deg(vector<vector<long>>(num_vars, vector<long>(num_states, 0))),
-            in_edges(vector<vector<unordered_map<long, unordered_set<Integer>>>>(
-                num_vars + 1, vector<unordered_map<long, unordered_set<Integer>>>(num_states))),
-            in_deg(vector<vector<long>>(num_vars + 1, vector<long>(num_states, 0))), nodes(vector<set<long>>(num_vars + 1))
-        {
-        }
-    };
-
     // Per-subtree dead-state cache: tracks which `~state[i][q]` proof lines have
     // already been emitted at or above the current search depth, so the per-call
     // propagator skips re-emission. Pre-populated with the statically-dead set
     // (those emitted at Top by the initialiser) so the first per-call sweep
-    // doesn't redundantly re-derive them.
+    // doesn't redundantly re-derive them. One reversible bit per (layer, state),
+    // so a search node pays only for the words it sets, not for a copy of the
+    // whole cache.
     struct DeadCache
     {
-        vector<set<long>> dead;
+        const ReversibleBitset & dead;
+        long num_states;
+        ReversibleTrail & trail;
+
+        [[nodiscard]] auto contains(long i, long q) const -> bool
+        {
+            return dead.test(trail, static_cast<size_t>(i * num_states + q));
+        }
+
+        auto insert(long i, long q) -> void
+        {
+            dead.set(trail, static_cast<size_t>(i * num_states + q));
+        }
     };
 
     auto emit_dead_state(ProofLogger * const logger, DeadCache & cache, const vector<vector<ProofFlag>> & state_at_pos_flags, long i, long q,
@@ -131,154 +114,15 @@ namespace
     {
         if (! logger || logger->get_assertion_level() != AssertionLevel::Off)
             return;
-        if (cache.dead[i].contains(q))
+        if (cache.contains(i, q))
             return;
         logger->emit_rup_proof_line_under_reason(reason, WPBSum{} + 1_i * ! state_at_pos_flags[i][q] >= 1_i, ProofLevel::Current);
-        cache.dead[i].insert(q);
-    }
-
-    // True if state l at position pos still has a live out-edge labelled val. For
-    // a DFA this is never the case once the single (l, val) edge is gone, but an
-    // NFA may have several edges on the same value.
-    auto still_supports(const RegularGraph & graph, const long pos, const long l, Integer val) -> bool
-    {
-        for (const auto & [next_q, vals] : graph.out_edges[pos][l])
-            if (vals.contains(val))
-                return true;
-        return false;
-    }
-
-    auto initialise_graph(RegularGraph & graph, DeadCache & cache, const vector<IntegerVariableID> & vars, const long num_states,
-        const vector<unordered_map<Integer, set<long>>> & transitions, const vector<long> & final_states,
-        const vector<vector<ProofFlag>> & state_at_pos_flags, const State & state, const ReasonLiterals & reason, ProofLogger * const logger)
-    {
-        auto num_vars = vars.size();
-
-        // Forward phase: states reachable from the root under current domains.
-        graph.nodes[0].insert(0);
-        for (size_t i = 0; i < num_vars; ++i) {
-            for (auto val : state.each_value_immutable(vars[i])) {
-                for (const auto & q : graph.nodes[i]) {
-                    const auto & next_states = find_transitions(transitions[q], val);
-                    if (! next_states.empty()) {
-                        graph.states_supporting[i][val].insert(q);
-                        for (const auto & next_q : next_states)
-                            graph.nodes[i + 1].insert(next_q);
-                    }
-                }
-            }
-
-            // States at layer i+1 not forward-reachable under current dom get a
-            // single ~state[i+1][next_q] line at Current, gated on the cache. The
-            // initialiser's Top backward chains plus the cached ~state[i][q] lines
-            // for parents eliminated at earlier layers let UP close this RUP.
-            for (long next_q = 0; next_q < num_states; ++next_q) {
-                if (graph.nodes[i + 1].contains(next_q))
-                    continue;
-                emit_dead_state(logger, cache, state_at_pos_flags, static_cast<long>(i) + 1, next_q, reason);
-            }
-        }
-
-        // Restrict the final layer to final states that are also reachable.
-        set<long> reachable_final;
-        for (auto f : final_states)
-            if (graph.nodes[num_vars].contains(f))
-                reachable_final.insert(f);
-
-        // Anything reachable under current dom but not in final_states is already
-        // in cache.dead from the static set, so emit_dead_state is a no-op here
-        // for well-formed automata.
-        for (const auto & q : graph.nodes[num_vars])
-            if (! reachable_final.contains(q))
-                emit_dead_state(logger, cache, state_at_pos_flags, static_cast<long>(num_vars), q, reason);
-        graph.nodes[num_vars] = reachable_final;
-
-        // Backward phase: drop states with no path forward to a final state.
-        for (long i = static_cast<long>(num_vars) - 1; i >= 0; --i) {
-            vector<char> state_is_support(num_states, 0);
-
-            for (auto val : state.each_value_mutable(vars[i])) {
-                set<long> states = graph.states_supporting[i][val];
-                for (const auto & q : states) {
-                    bool any_live_target = false;
-                    for (const auto & next_q : find_transitions(transitions[q], val)) {
-                        if (graph.nodes[i + 1].contains(next_q)) {
-                            graph.out_edges[i][q][next_q].emplace(val);
-                            graph.out_deg[i][q]++;
-                            graph.in_edges[i + 1][next_q][q].emplace(val);
-                            graph.in_deg[i + 1][next_q]++;
-                            any_live_target = true;
-                        }
-                    }
-                    if (any_live_target)
-                        state_is_support[q] = 1;
-                    else
-                        graph.states_supporting[i][val].erase(q);
-                }
-            }
-
-            set<long> gn = graph.nodes[i];
-            for (const auto & q : gn) {
-                if (! state_is_support[q]) {
-                    graph.nodes[i].erase(q);
-                    emit_dead_state(logger, cache, state_at_pos_flags, i, q, reason);
-                }
-            }
-        }
-
-        graph.initialised = true;
-    }
-
-    auto decrement_outdeg(RegularGraph & graph, DeadCache & cache, const long i, const long k, const vector<vector<ProofFlag>> & state_at_pos_flags,
-        const ReasonLiterals & reason, ProofLogger * const logger) -> void
-    {
-        graph.out_deg[i][k]--;
-        if (graph.out_deg[i][k] == 0 && i > 0) {
-            // Emit before recursing to parents at i-1: ~state[i-1][l]'s RUP
-            // (when l's out_deg also hits 0 in the recursion) consumes the
-            // forward chain `state[i-1][l] ∧ x[i-1]=val → state[i][T(l,val)]`
-            // together with ~state[i][T(l,val)], so all dead children at
-            // layer i must be in the proof DB before any layer-(i-1) parent
-            // is derived. emit_dead_state is cache-gated, so the recursion
-            // can still reach this node without re-emission.
-            emit_dead_state(logger, cache, state_at_pos_flags, i, k, reason);
-            for (const auto & edge : graph.in_edges[i][k]) {
-                auto l = edge.first;
-                graph.out_edges[i - 1][l].erase(k);
-                for (const auto & val : edge.second) {
-                    // For an NFA, l may still reach a live state on val via
-                    // another edge; only drop support once no such edge remains.
-                    if (! still_supports(graph, i - 1, l, val))
-                        graph.states_supporting[i - 1][val].erase(l);
-                    decrement_outdeg(graph, cache, i - 1, l, state_at_pos_flags, reason, logger);
-                }
-            }
-            graph.in_edges[i][k] = {};
-        }
-    }
-
-    auto decrement_indeg(RegularGraph & graph, DeadCache & cache, const long i, const long k, const vector<vector<ProofFlag>> & state_at_pos_flags,
-        const ReasonLiterals & reason, ProofLogger * const logger) -> void
-    {
-        graph.in_deg[i][k]--;
-        if (graph.in_deg[i][k] == 0 && cmp_less(i, graph.in_deg.size() - 1)) {
-            emit_dead_state(logger, cache, state_at_pos_flags, i, k, reason);
-            for (const auto & edge : graph.out_edges[i][k]) {
-                auto l = edge.first;
-                graph.in_edges[i + 1][l].erase(k);
-                for (const auto & val : edge.second) {
-                    graph.states_supporting[i][val].erase(k);
-                    decrement_indeg(graph, cache, i + 1, l, state_at_pos_flags, reason, logger);
-                }
-            }
-            graph.out_edges[i][k] = {};
-        }
+        cache.insert(i, q);
     }
 
-    auto propagate_regular(const vector<IntegerVariableID> & vars, const long num_states,
-        const vector<unordered_map<Integer, set<long>>> & transitions, const vector<long> & final_states,
-        const vector<vector<ProofFlag>> & state_at_pos_flags, const ConstraintStateHandle & graph_handle, const ConstraintStateHandle & cache_handle,
-        const State & state, auto & inference, ProofLogger * const logger, const ConstraintID & owner, const Reason & reason) -> void
+    auto propagate_regular(const vector<IntegerVariableID> & vars, const long num_states, const vector<long> & final_states,
+        const vector<vector<ProofFlag>> & state_at_pos_flags, const LayeredGraph & graph, const ReversibleBitset & dead_states, const State & state,
+        auto & inference, ProofLogger * const logger, const DomainDelta & delta, const ConstraintID & owner, const Reason & reason) -> void
     {
         // Degenerate empty sequence (issue #254): with no variables there is
         // nothing to propagate over, but the empty word is accepted only if the
@@ -297,55 +141,42 @@ namespace
             return;
         }
 
-        auto & graph = any_cast<RegularGraph &>(state.get_constraint_state(graph_handle));
-        auto & cache = any_cast<DeadCache &>(state.get_constraint_state(cache_handle));
+        auto & trail = state.reversible_trail();
+        DeadCache cache{dead_states, num_states, trail};
         // All manual proof emission happens before any domain change below, so a
         // single materialised snapshot is sound (see MDD, PORTING-NOTES §13).
         auto eager = eager_reason(reason, state);
 
-        if (! graph.initialised)
-            initialise_graph(graph, cache, vars, num_states, transitions, final_states, state_at_pos_flags, state, eager, logger);
-
-        for (size_t i = 0; i < graph.states_supporting.size(); ++i) {
-            for (const auto & val_and_states : graph.states_supporting[i]) {
-                auto val = val_and_states.first;
-
-                if (! graph.states_supporting[i][val].empty() && ! state.in_domain(vars[i], val)) {
-                    for (const auto & q : graph.states_supporting[i][val]) {
-                        // Remove every edge out of q that carries this value; an
-                        // NFA may have several. Collect them first to avoid
-                        // mutating out_edges[i][q] while iterating it.
-                        vector<long> next_qs;
-                        for (const auto & [next_q, vals] : graph.out_edges[i][q])
-                            if (vals.contains(val))
-                                next_qs.push_back(next_q);
-
-                        for (const auto & next_q : next_qs) {
-                            graph.out_edges[i][q][next_q].erase(val);
-                            if (graph.out_edges[i][q][next_q].empty())
-                                graph.out_edges[i][q].erase(next_q);
-
-                            if (graph.in_edges[i + 1][next_q].contains(q)) {
-                                graph.in_edges[i + 1][next_q][q].erase(val);
-                                if (graph.in_edges[i + 1][next_q][q].empty())
-                                    graph.in_edges[i + 1][next_q].erase(q);
-                            }
-
-                            decrement_outdeg(graph, cache, static_cast<long>(i), q, state_at_pos_flags, eager, logger);
-                            decrement_indeg(graph, cache, static_cast<long>(i) + 1, next_q, state_at_pos_flags, eager, logger);
-                        }
-                    }
-                    graph.states_supporting[i][val] = {};
-                }
-            }
+        // Each dead state's line goes in before any of its edges is removed:
+        // ~state[i-1][l]'s RUP, when l's last out-edge went to this state,
+        // consumes the forward chain `state[i-1][l] ∧ x[i-1]=val →
+        // state[i][T(l,val)]` together with ~state[i][T(l,val)], and
+        // symmetrically for in-edges and the initialiser's backward chains.
+        LayeredGraph::NodeDied node_died;
+        if (logger && logger->get_assertion_level() == AssertionLevel::Off)
+            node_died = [&](size_t i, long q) { emit_dead_state(logger, cache, state_at_pos_flags, static_cast<long>(i), q, eager); };
+
+        // The graph lives in the trail, and when this last finished, every value
+        // still supported at a layer was in its variable's domain, and every
+        // value in a domain was supported. So only the layers whose variables
+        // have changed since can have edges to remove, and only the values that
+        // lose their last edge in doing so can need pruning.
+        vector<pair<size_t, Integer>> lost_support;
+        if (delta.everything_changed()) {
+            for (size_t i = 0; i < vars.size(); ++i)
+                graph.remove_values_not_in_domain(trail, state, i, vars[i], node_died, lost_support);
+            for (size_t i = 0; i < vars.size(); ++i)
+                for (auto val : state.each_value_mutable(vars[i]))
+                    if (! graph.supported(trail, i, val))
+                        inference.infer_not_equal(logger, vars[i], val, JustifyUsingRUP{hints::Regular{owner}}, reason);
+            return;
         }
 
-        for (size_t i = 0; i < graph.states_supporting.size(); ++i) {
-            for (auto val : state.each_value_mutable(vars[i])) {
-                if (graph.states_supporting[i][val].empty())
-                    inference.infer_not_equal(logger, vars[i], val, JustifyUsingRUP{hints::Regular{owner}}, reason);
-            }
-        }
+        for (const auto & entry : delta.changed())
+            graph.remove_values_not_in_domain(trail, state, entry.position, vars[entry.position], node_died, lost_support);
+        for (const auto & [i, val] : lost_support)
+            if (state.in_domain(vars[i], val))
+                inference.infer_not_equal(logger, vars[i], val, JustifyUsingRUP{hints::Regular{owner}}, reason);
     }
 
     // Static forward + backward reachability under initial domains. Returns the
@@ -461,6 +292,7 @@ struct Regular::Bridge
 {
     vector<vector<ProofFlag>> state_at_pos_flags;
     vector<set<long>> static_dead;
+    LayeredGraph graph;
 };
 
 Regular::Regular(vector<IntegerVariableID> v, long n, vector<unordered_map<Integer, long>> t, vector<long> f) :
@@ -569,9 +401,17 @@ auto Regular::prepare(Propagators & propagators, State & initial_state, ProofMod
         _symbols = symbols_of(_transitions);
     }
 
+    // The unrolled automaton, over the values each variable can take now.
+    vector<vector<LayeredGraph::Edge>> edges(_vars.size());
+    for (size_t i = 0; i < _vars.size(); ++i)
+        for (auto val : initial_state.each_value_immutable(_vars[i]))
+            for (long q = 0; q < _num_states; ++q)
+                for (auto next_q : find_transitions(_transitions[q], val))
+                    edges[i].push_back(LayeredGraph::Edge{q, val, next_q});
+
     _bridge = make_shared<Bridge>();
-    _graph_idx = initial_state.add_constraint_state(RegularGraph(static_cast<long>(_vars.size()), _num_states));
-    _dead_cache_idx = initial_state.add_constraint_state(DeadCache{vector<set<long>>(_vars.size() + 1)});
+    _bridge->graph = LayeredGraph{initial_state.reversible_trail(), vector<long>(_vars.size() + 1, _num_states), edges, _final_states};
+    _dead_states = ReversibleBitset{initial_state.reversible_trail(), (_vars.size() + 1) * static_cast<size_t>(_num_states)};
 
     // Build the OPB alphabet: the union of transition keys and each var's initial
     // domain. Domain values absent from every transition get a "no transition"
@@ -645,14 +485,15 @@ auto Regular::install_propagators(Propagators & propagators) -> void
     // statically-dead states. In assertion mode the per-call inferences are
     // asserted under the typed hint, so the scaffolding is wasted output.
     propagators.install_initialiser([vars = _vars, ns = _num_states, t = _transitions, fs = _final_states, bridge = _bridge,
-                                        dead_cache_handle = _dead_cache_idx](State & state, auto &, ProofLogger * const logger) -> void {
+                                        dead_states = _dead_states](State & state, auto &, ProofLogger * const logger) -> void {
         if (! logger || logger->get_assertion_level() != AssertionLevel::Off)
             return;
         bridge->static_dead = compute_static_dead(vars, ns, t, fs, state);
         emit_top_scaffolding(logger, vars, ns, t, bridge->state_at_pos_flags, state, bridge->static_dead);
-        auto & cache = any_cast<DeadCache &>(state.get_constraint_state(dead_cache_handle));
+        DeadCache cache{dead_states, ns, state.reversible_trail()};
         for (size_t i = 0; i < bridge->static_dead.size(); ++i)
-            cache.dead[i].insert(bridge->static_dead[i].begin(), bridge->static_dead[i].end());
+            for (auto q : bridge->static_dead[i])
+                cache.insert(static_cast<long>(i), q);
     });
 
     // Whole-scope declarative reason built once and captured; only its per-wake
@@ -661,10 +502,10 @@ auto Regular::install_propagators(Propagators & propagators) -> void
     auto vars_reason = generic_reason(_vars);
     propagators.install(
         constraint_id(),
-        [v = _vars, ns = _num_states, t = _transitions, fs = _final_states, g = _graph_idx, dc = _dead_cache_idx, bridge = _bridge,
-            owner = constraint_id(),
-            reason = std::move(vars_reason)](const State & state, auto & inference, ProofLogger * const logger) -> PropagatorState {
-            propagate_regular(v, ns, t, fs, bridge->state_at_pos_flags, g, dc, state, inference, logger, owner, reason);
+        [v = _vars, ns = _num_states, fs = _final_states, dc = _dead_states, bridge = _bridge, owner = constraint_id(),
+            reason = std::move(vars_reason)](
+            const State & state, auto & inference, ProofLogger * const logger, const DomainDelta & delta) -> PropagatorState {
+            propagate_regular(v, ns, fs, bridge->state_at_pos_flags, bridge->graph, dc, state, inference, logger, delta, owner, reason);
             return PropagatorState::Enable;
         },
         triggers);
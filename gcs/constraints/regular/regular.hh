@@ -76,8 +76,7 @@ namespace gcs
         const std::optional<std::string> _regex;
         std::vector<Integer> _symbols;
         std::shared_ptr<Bridge> _bridge;
-        innards::ConstraintStateHandle _graph_idx;
-        innards::ConstraintStateHandle _dead_cache_idx;
+        innards::ReversibleBitset _dead_states;
         std::set<Integer> _opb_alphabet;
 
         // Copy-style constructor used by clone(): takes the internal multi-target
@@ -1,3 +1,4 @@
+#include <gcs/constraints/innards/layered_graph.hh>
 #include <gcs/constraints/regular/regular_bacchus.hh>
 #include <gcs/exception.hh>
 #include <gcs/innards/inference_tracker.hh>
@@ -18,19 +19,16 @@
 #endif
 
 #include <algorithm>
-#include <any>
 #include <memory>
 #include <set>
 #include <sstream>
 #include <string>
 #include <unordered_map>
-#include <unordered_set>
 #include <utility>
 
 using namespace gcs;
 using namespace gcs::innards;
 
-using std::any_cast;
 using std::make_shared;
 using std::make_unique;
 using std::move;
@@ -41,7 +39,6 @@ using std::string;
 using std::stringstream;
 using std::unique_ptr;
 using std::unordered_map;
-using std::unordered_set;
 using std::vector;
 using std::ranges::sort;
 
@@ -63,151 +60,31 @@ namespace
         return it->second;
     }
 
-    // Per-call support graph: identical layout to Regular's, but we never
-    // emit proof lines from here. The graph is only used by the propagator
-    // to decide which value-prunings to make; the proof DB already contains
-    // the Bacchus encoding from the initialiser, so RUP / NoJustNeeded
-    // closes everything via UP without per-call intermediates.
-    struct RegularGraph
+    // The support graph is Regular's, but we never emit proof lines from
+    // here. It is only used by the propagator to decide which value-prunings
+    // to make; the proof DB already contains the Bacchus encoding from the
+    // initialiser, so RUP / NoJustNeeded closes everything via UP without
+    // per-call intermediates.
+    auto propagate_regular(const vector<IntegerVariableID> & vars, const LayeredGraph & graph, const State & state, auto & inference,
+        ProofLogger * const logger, const DomainDelta & delta) -> void
     {
-        vector<unordered_map<Integer, set<long>>> states_supporting;
-        vector<vector<unordered_map<long, unordered_set<Integer>>>> out_edges;
-        vector<vector<long>> out_deg;
-        vector<vector<unordered_map<long, unordered_set<Integer>>>> in_edges;
-        vector<vector<long>> in_deg;
-        vector<set<long>> nodes;
-        bool initialised = false;
-
-        explicit RegularGraph(long num_vars, long num_states) :
-            states_supporting(num_vars), out_edges(num_vars, vector<unordered_map<long, unordered_set<Integer>>>(num_states)),
-            out_deg(num_vars, vector<long>(num_states, 0)), in_edges(num_vars + 1, vector<unordered_map<long, unordered_set<Integer>>>(num_states)),
-            in_deg(num_vars + 1, vector<long>(num_states, 0)), nodes(num_vars + 1)
-        {
-        }
-    };
-
-    auto initialise_graph(RegularGraph & graph, const vector<IntegerVariableID> & vars, const long num_states,
-        const vector<unordered_map<Integer, long>> & transitions, const vector<long> & final_states, const State & state) -> void
-    {
-        auto num_vars = vars.size();
-
-        graph.nodes[0].insert(0);
-        for (size_t i = 0; i < num_vars; ++i) {
-            for (auto val : state.each_value_immutable(vars[i])) {
-                for (const auto & q : graph.nodes[i]) {
-                    auto next_q = find_transition(transitions[q], val);
-                    if (next_q != -1) {
-                        graph.states_supporting[i][val].insert(q);
-                        graph.nodes[i + 1].insert(next_q);
-                    }
-                }
-            }
-        }
-
-        set<long> reachable_final;
-        for (auto f : final_states)
-            if (graph.nodes[num_vars].contains(f))
-                reachable_final.insert(f);
-        graph.nodes[num_vars] = reachable_final;
-
-        for (long i = static_cast<long>(num_vars) - 1; i >= 0; --i) {
-            vector<char> state_is_support(num_states, 0);
-            for (auto val : state.each_value_mutable(vars[i])) {
-                set<long> states = graph.states_supporting[i][val];
-                for (const auto & q : states) {
-                    auto next_q = find_transition(transitions[q], val);
-                    if (next_q != -1 && graph.nodes[i + 1].contains(next_q)) {
-                        graph.out_edges[i][q][next_q].emplace(val);
-                        graph.out_deg[i][q]++;
-                        graph.in_edges[i + 1][next_q][q].emplace(val);
-                        graph.in_deg[i + 1][next_q]++;
-                        state_is_support[q] = 1;
-                    }
-                    else {
-                        graph.states_supporting[i][val].erase(q);
-                    }
-                }
-            }
-            set<long> gn = graph.nodes[i];
-            for (const auto & q : gn)
-                if (! state_is_support[q])
-                    graph.nodes[i].erase(q);
-        }
-
-        graph.initialised = true;
-    }
-
-    auto decrement_outdeg(RegularGraph & graph, const long i, const long k) -> void
-    {
-        graph.out_deg[i][k]--;
-        if (graph.out_deg[i][k] == 0 && i > 0) {
-            for (const auto & edge : graph.in_edges[i][k]) {
-                auto l = edge.first;
-                graph.out_edges[i - 1][l].erase(k);
-                for (const auto & val : edge.second) {
-                    graph.states_supporting[i - 1][val].erase(l);
-                    decrement_outdeg(graph, i - 1, l);
-                }
-            }
-            graph.in_edges[i][k] = {};
-        }
-    }
-
-    auto decrement_indeg(RegularGraph & graph, const long i, const long k) -> void
-    {
-        graph.in_deg[i][k]--;
-        if (graph.in_deg[i][k] == 0 && std::cmp_less(i, graph.in_deg.size() - 1)) {
-            for (const auto & edge : graph.out_edges[i][k]) {
-                auto l = edge.first;
-                graph.in_edges[i + 1][l].erase(k);
-                for (const auto & val : edge.second) {
-                    graph.states_supporting[i][val].erase(k);
-                    decrement_indeg(graph, i + 1, l);
-                }
-            }
-            graph.out_edges[i][k] = {};
-        }
-    }
-
-    auto propagate_regular(const vector<IntegerVariableID> & vars, const long num_states, const vector<unordered_map<Integer, long>> & transitions,
-        const vector<long> & final_states, const ConstraintStateHandle & graph_handle, const State & state, auto & inference,
-        ProofLogger * const logger) -> void
-    {
-        auto & graph = any_cast<RegularGraph &>(state.get_constraint_state(graph_handle));
-
-        if (! graph.initialised)
-            initialise_graph(graph, vars, num_states, transitions, final_states, state);
-
-        for (size_t i = 0; i < graph.states_supporting.size(); ++i) {
-            for (const auto & val_and_states : graph.states_supporting[i]) {
-                auto val = val_and_states.first;
-                if (! graph.states_supporting[i][val].empty() && ! state.in_domain(vars[i], val)) {
-                    for (const auto & q : graph.states_supporting[i][val]) {
-                        auto next_q = find_transition(transitions[q], val);
-                        if (graph.out_edges[i][q].contains(next_q)) {
-                            graph.out_edges[i][q][next_q].erase(val);
-                            if (graph.out_edges[i][q][next_q].empty())
-                                graph.out_edges[i][q].erase(next_q);
-                        }
-                        if (graph.in_edges[i + 1][next_q].contains(q)) {
-                            graph.in_edges[i + 1][next_q][q].erase(val);
-                            if (graph.in_edges[i + 1][next_q][q].empty())
-                                graph.in_edges[i + 1][next_q].erase(q);
-                        }
-                        decrement_outdeg(graph, static_cast<long>(i), q);
-                        decrement_indeg(graph, static_cast<long>(i) + 1, next_q);
-                    }
-                    graph.states_supporting[i][val] = {};
-                }
-            }
+        auto & trail = state.reversible_trail();
+        vector<pair<size_t, Integer>> lost_support;
+        if (delta.everything_changed()) {
+            for (size_t i = 0; i < vars.size(); ++i)
+                graph.remove_values_not_in_domain(trail, state, i, vars[i], nullptr, lost_support);
+            for (size_t i = 0; i < vars.size(); ++i)
+                for (auto val : state.each_value_mutable(vars[i]))
+                    if (! graph.supported(trail, i, val))
+                        inference.infer_not_equal(logger, vars[i], val, NoJustificationNeeded{}, NoReason{});
+            return;
         }
 
-        for (size_t i = 0; i < graph.states_supporting.size(); ++i) {
-            for (auto val : state.each_value_mutable(vars[i])) {
-                if (graph.states_supporting[i][val].empty())
-                    inference.infer_not_equal(logger, vars[i], val, NoJustificationNeeded{}, NoReason{});
-            }
-        }
+        for (const auto & entry : delta.changed())
+            graph.remove_values_not_in_domain(trail, state, entry.position, vars[entry.position], nullptr, lost_support);
+        for (const auto & [i, val] : lost_support)
+            if (state.in_domain(vars[i], val))
+                inference.infer_not_equal(logger, vars[i], val, NoJustificationNeeded{}, NoReason{});
     }
 }
 
@@ -225,6 +102,7 @@ struct RegularBacchus::Bridge
     //     `~state[i][q] + (vars[i]!=val) + state[i+1][delta(q,val)] >= 1`
     //   (only present where delta(q,val) is defined).
     vector<vector<unordered_map<Integer, ProofLine>>> forward_chain_lines;
+    LayeredGraph graph;
 };
 
 RegularBacchus::RegularBacchus(vector<IntegerVariableID> v, long n, vector<unordered_map<Integer, long>> t, vector<long> f, bool sr) :
@@ -259,8 +137,15 @@ auto RegularBacchus::clone() const -> unique_ptr<Constraint>
 
 auto RegularBacchus::prepare(Propagators &, State & initial_state, ProofModel * const) -> bool
 {
+    vector<vector<LayeredGraph::Edge>> edges(_vars.size());
+    for (size_t i = 0; i < _vars.size(); ++i)
+        for (auto val : initial_state.each_value_immutable(_vars[i]))
+            for (long q = 0; q < _num_states; ++q)
+                if (auto next_q = find_transition(_transitions[q], val); next_q != -1)
+                    edges[i].push_back(LayeredGraph::Edge{q, val, next_q});
+
     _bridge = make_shared<Bridge>();
-    _graph_idx = initial_state.add_constraint_state(RegularGraph(static_cast<long>(_vars.size()), _num_states));
+    _bridge->graph = LayeredGraph{initial_state.reversible_trail(), vector<long>(_vars.size() + 1, _num_states), edges, _final_states};
 
     _opb_alphabet.insert(_symbols.begin(), _symbols.end());
     for (const auto & var : _vars)
@@ -433,9 +318,9 @@ auto RegularBacchus::install_propagators(Propagators & propagators) -> void
 
     propagators.install(
         constraint_id(),
-        [v = _vars, ns = _num_states, t = _transitions, fs = _final_states, g = _graph_idx](
-            const State & state, auto & inference, ProofLogger * const logger) -> PropagatorState {
-            propagate_regular(v, ns, t, fs, g, state, inference, logger);
+        [v = _vars, bridge = _bridge](
+            const State & state, auto & inference, ProofLogger * const logger, const DomainDelta & delta) -> PropagatorState {
+            propagate_regular(v, bridge->graph, state, inference, logger, delta);
             return PropagatorState::Enable;
         },
         triggers);
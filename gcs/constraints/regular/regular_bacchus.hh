@@ -48,7 +48,6 @@ namespace gcs
         const bool _short_reasons;
         std::vector<Integer> _symbols;
         std::shared_ptr<Bridge> _bridge;
-        innards::ConstraintStateHandle _graph_idx;
         std::set<Integer> _opb_alphabet;
 
         virtual auto prepare(innards::Propagators &, innards::State &, innards::ProofModel * const) -> bool override;
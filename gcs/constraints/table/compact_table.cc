@@ -0,0 +1,344 @@
+#include <gcs/constraints/table/compact_table.hh>
+#include <gcs/innards/inference_tracker.hh>
+#include <gcs/innards/justification.hh>
+#include <gcs/innards/proofs/proof_logger.hh>
+#include <gcs/innards/reason.hh>
+#include <gcs/innards/state.hh>
+
+#include <util/overloaded.hh>
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <variant>
+
+using std::countr_zero;
+using std::holds_alternative;
+using std::lower_bound;
+using std::make_shared;
+using std::size_t;
+using std::uint32_t;
+using std::uint64_t;
+using std::vector;
+using std::visit;
+using std::ranges::adjacent_find;
+using std::ranges::sort;
+
+using namespace gcs;
+using namespace gcs::innards;
+
+namespace
+{
+    constexpr size_t bits_per_word = 64;
+
+    auto set_bit(vector<uint64_t> & bits, size_t offset, size_t bit) -> void
+    {
+        bits[offset + bit / bits_per_word] |= uint64_t{1} << (bit % bits_per_word);
+    }
+
+    auto clear_bit(ReversibleTrail & trail, const ReversibleVector<uint64_t> & bits, size_t bit) -> void
+    {
+        auto w = bit / bits_per_word;
+        bits.set(trail, w, bits.get(trail, w) & ~(uint64_t{1} << (bit % bits_per_word)));
+    }
+
+    template <typename Callback_>
+    auto for_each_set_bit(const ReversibleTrail & trail, const ReversibleVector<uint64_t> & bits, Callback_ && cb) -> void
+    {
+        for (size_t w = 0; w < bits.size(); ++w)
+            for (auto word = bits.get(trail, w); word != 0; word &= word - 1)
+                cb(w * bits_per_word + static_cast<size_t>(countr_zero(word)));
+    }
+
+    // Swap a word that has become zero out past the limit. The swap itself is
+    // not trailed: see CompactTableState.
+    auto remove_word(ReversibleTrail & trail, const CompactTableState & ct, CompactTableSupports & supports, uint32_t i, uint32_t & limit) -> void
+    {
+        auto & index = supports.index;
+        auto offset = index[i];
+        index[i] = index[limit - 1];
+        index[limit - 1] = offset;
+        --limit;
+        ct.limit.set(trail, limit);
+    }
+
+    auto add_support(CompactTableSupports & supports, size_t pos, size_t tuple_idx, const Integer & val) -> void
+    {
+        const auto & values = supports.values[pos];
+        auto slot = lower_bound(values.begin(), values.end(), val);
+        if (slot != values.end() && *slot == val) {
+            auto row = static_cast<size_t>(slot - values.begin()) * supports.n_words;
+            set_bit(supports.masks[pos], row, tuple_idx);
+            if (! supports.strict_masks[pos].empty())
+                set_bit(supports.strict_masks[pos], row, tuple_idx);
+        }
+    }
+
+    auto add_support(CompactTableSupports & supports, size_t pos, size_t tuple_idx, const Wildcard &) -> void
+    {
+        for (size_t slot = 0; slot < supports.values[pos].size(); ++slot)
+            set_bit(supports.masks[pos], slot * supports.n_words, tuple_idx);
+    }
+
+    auto is_wildcard(const Integer &) -> bool
+    {
+        return false;
+    }
+
+    auto is_wildcard(const IntegerOrWildcard & val) -> bool
+    {
+        return holds_alternative<Wildcard>(val);
+    }
+
+    auto add_support(CompactTableSupports & supports, size_t pos, size_t tuple_idx, const IntegerOrWildcard & val) -> void
+    {
+        visit([&](const auto & val) { add_support(supports, pos, tuple_idx, val); }, val);
+    }
+
+    // Note which tuples a word has lost, so that their selector values can go.
+    auto note_removed_tuples(CompactTableSupports & supports, size_t offset, uint64_t removed) -> void
+    {
+        for (; removed != 0; removed &= removed - 1)
+            supports.scratch_tuples.push_back(static_cast<uint32_t>(offset * bits_per_word + static_cast<size_t>(countr_zero(removed))));
+    }
+
+    // Clear from the bitset every tuple in the union of the given masks, or (if
+    // intersect) every tuple not in it. Only live words are touched, and a word
+    // that becomes zero is swapped out past the limit.
+    auto apply_masks(ReversibleTrail & trail, const CompactTableState & ct, CompactTableSupports & supports, const vector<uint64_t> & masks,
+        const vector<uint32_t> & slots, bool intersect) -> void
+    {
+        const auto & index = supports.index;
+        auto & scratch = supports.scratch_words;
+        auto limit = ct.limit.get(trail);
+        for (uint32_t i = 0; i < limit; ++i)
+            scratch[index[i]] = 0;
+        for (auto slot : slots) {
+            auto row = static_cast<size_t>(slot) * supports.n_words;
+            for (uint32_t i = 0; i < limit; ++i)
+                scratch[index[i]] |= masks[row + index[i]];
+        }
+
+        for (auto i = limit; i-- > 0;) {
+            auto offset = index[i];
+            auto old_word = ct.words.get(trail, offset);
+            auto word = old_word & (intersect ? scratch[offset] : ~scratch[offset]);
+            if (word == old_word)
+                continue;
+            note_removed_tuples(supports, offset, old_word & ~word);
+            ct.words.set(trail, offset, word);
+            if (0 == word)
+                remove_word(trail, ct, supports, i, limit);
+        }
+    }
+}
+
+auto gcs::innards::prepare_compact_table(
+    const IntegerVariableID & selector, const vector<IntegerVariableID> & vars, const ExtensionalTuples & tuples, State & initial_state)
+    -> CompactTableData
+{
+    auto supports = make_shared<CompactTableSupports>();
+    auto & trail = initial_state.reversible_trail();
+    CompactTableState ct;
+
+    visit(
+        [&](const auto & tuples) {
+            const auto & tuple_data = *tuples;
+            supports->n_words = (tuple_data.size() + bits_per_word - 1) / bits_per_word;
+            supports->values.resize(vars.size());
+            supports->masks.resize(vars.size());
+            supports->residues.resize(vars.size());
+            supports->strict_masks.resize(vars.size());
+            supports->scratch_words.assign(supports->n_words, 0);
+            ct.live_count = ReversibleVector<size_t>{trail, vars.size(), 0};
+
+            for (size_t pos = 0; pos < vars.size(); ++pos) {
+                auto & values = supports->values[pos];
+                initial_state.for_each_value_immutable(vars[pos], [&](Integer val) { values.push_back(val); });
+                // a negated view iterates its values in descending order
+                sort(values);
+                supports->masks[pos].assign(values.size() * supports->n_words, 0);
+                supports->residues[pos].assign(values.size(), CompactTableSupports::no_residue);
+                vector<uint64_t> live((values.size() + bits_per_word - 1) / bits_per_word, 0);
+                for (size_t slot = 0; slot < values.size(); ++slot)
+                    set_bit(live, 0, slot);
+                ct.live.emplace_back(trail, live.size(), 0);
+                for (size_t w = 0; w < live.size(); ++w)
+                    ct.live.back().set(trail, w, live[w]);
+                ct.live_count.set(trail, pos, values.size());
+
+                for (const auto & tuple : tuple_data)
+                    if (is_wildcard(tuple[pos])) {
+                        supports->strict_masks[pos].assign(supports->masks[pos].size(), 0);
+                        break;
+                    }
+            }
+
+            for (size_t tuple_idx = 0; tuple_idx < tuple_data.size(); ++tuple_idx)
+                for (size_t pos = 0; pos < vars.size(); ++pos)
+                    add_support(*supports, pos, tuple_idx, tuple_data[tuple_idx][pos]);
+
+            // A tuple is selectable to begin with if every entry is supported by
+            // some value, i.e. if it is in the union of each position's masks.
+            vector<uint64_t> words(supports->n_words, ~uint64_t{0});
+            if (auto spare = tuple_data.size() % bits_per_word; spare != 0)
+                words.back() = (uint64_t{1} << spare) - 1;
+            vector<uint64_t> any_value(supports->n_words);
+            for (size_t pos = 0; pos < vars.size(); ++pos) {
+                any_value.assign(supports->n_words, 0);
+                for (size_t slot = 0; slot < supports->values[pos].size(); ++slot)
+                    for (size_t w = 0; w < supports->n_words; ++w)
+                        any_value[w] |= supports->masks[pos][slot * supports->n_words + w];
+                for (size_t w = 0; w < supports->n_words; ++w)
+                    words[w] &= any_value[w];
+            }
+
+            ct.words = ReversibleVector<uint64_t>{trail, supports->n_words, 0};
+            for (size_t w = 0; w < supports->n_words; ++w)
+                ct.words.set(trail, w, words[w]);
+
+            for (size_t w = 0; w < supports->n_words; ++w)
+                if (words[w] != 0)
+                    supports->index.push_back(static_cast<uint32_t>(w));
+            ct.limit = Reversible<uint32_t>{trail, static_cast<uint32_t>(supports->index.size())};
+            for (size_t w = 0; w < supports->n_words; ++w)
+                if (0 == words[w])
+                    supports->index.push_back(static_cast<uint32_t>(w));
+
+            for (size_t tuple_idx = 0; tuple_idx < tuple_data.size(); ++tuple_idx)
+                if (0 == (words[tuple_idx / bits_per_word] & (uint64_t{1} << (tuple_idx % bits_per_word))))
+                    supports->unselectable.push_back(static_cast<uint32_t>(tuple_idx));
+            ct.selector_size = Reversible<size_t>{trail, tuple_data.size()};
+            ct.selector_synced = Reversible<bool>{trail, false};
+        },
+        tuples);
+
+    // Two positions over the same variable, directly or through views, make
+    // the propagator non-idempotent.
+    vector<unsigned long long> underlying;
+    for (const auto & var : vars)
+        overloaded{[&](const SimpleIntegerVariableID & v) { underlying.push_back(v.index); },
+            [&](const ViewOfIntegerVariableID & v) { underlying.push_back(v.actual_variable.index); },
+            [&](const ConstantIntegerVariableID &) {}}
+            .visit(var);
+    sort(underlying);
+    bool repeated_variable = adjacent_find(underlying) != underlying.end();
+
+    return CompactTableData{selector, vars, repeated_variable, std::move(supports), std::move(ct), generic_reason(vars)};
+}
+
+auto gcs::innards::propagate_compact_table(
+    const CompactTableData & table, const State & state, auto & inference, ProofLogger * const logger, const hints::Table & hint) -> PropagatorState
+{
+    auto & supports = *table.supports;
+    const auto & ct = table.state;
+    auto & trail = state.reversible_trail();
+
+    supports.scratch_tuples.clear();
+    if (! ct.selector_synced.get(trail)) {
+        supports.scratch_tuples = supports.unselectable;
+        ct.selector_synced.set(trail, true);
+    }
+
+    // A selector value that something else has removed takes its tuple out of
+    // the bitset. This only happens if search branches on the selector.
+    if (static_cast<size_t>(state.domain_size(table.selector).raw_value) != ct.selector_size.get(trail)) {
+        auto limit = ct.limit.get(trail);
+        for (auto i = limit; i-- > 0;) {
+            auto offset = supports.index[i];
+            auto old_word = ct.words.get(trail, offset), word = old_word;
+            for (auto bits = word; bits != 0; bits &= bits - 1) {
+                auto bit = static_cast<size_t>(countr_zero(bits));
+                if (! state.in_domain(table.selector, Integer(static_cast<long long>(offset * bits_per_word + bit))))
+                    word &= ~(uint64_t{1} << bit);
+            }
+            if (word == old_word)
+                continue;
+            ct.words.set(trail, offset, word);
+            if (0 == word)
+                remove_word(trail, ct, supports, i, limit);
+        }
+    }
+
+    // Remove the tuples that lost an entry since the last call. A domain only
+    // shrinks, so an unchanged size means an unchanged domain.
+    for (size_t pos = 0; pos < table.vars.size(); ++pos) {
+        auto live_count = ct.live_count.get(trail, pos);
+        if (static_cast<size_t>(state.domain_size(table.vars[pos]).raw_value) == live_count)
+            continue;
+
+        const auto & values = supports.values[pos];
+        auto & removed = supports.scratch_slots;
+        removed.clear();
+        for_each_set_bit(trail, ct.live[pos], [&](size_t slot) {
+            if (! state.in_domain(table.vars[pos], values[slot]))
+                removed.push_back(static_cast<uint32_t>(slot));
+        });
+        if (removed.empty())
+            continue;
+
+        for (auto slot : removed)
+            clear_bit(trail, ct.live[pos], slot);
+        live_count -= removed.size();
+        ct.live_count.set(trail, pos, live_count);
+
+        // Clearing by the lost values must not touch a wildcard tuple, which a
+        // remaining value still supports, hence the strict masks if there are any.
+        if (removed.size() <= live_count)
+            apply_masks(trail, ct, supports, supports.strict_masks[pos].empty() ? supports.masks[pos] : supports.strict_masks[pos], removed, false);
+        else {
+            removed.clear();
+            for_each_set_bit(trail, ct.live[pos], [&](size_t slot) { removed.push_back(static_cast<uint32_t>(slot)); });
+            apply_masks(trail, ct, supports, supports.masks[pos], removed, true);
+        }
+    }
+
+    // This also catches a table none of whose tuples survived preparation.
+    auto limit = ct.limit.get(trail);
+    if (0 == limit)
+        inference.contradiction(logger, JustifyUsingRUP{hint}, table.reason);
+
+    // Every remaining value needs its mask to meet a selectable tuple. The
+    // residue is the first word tried; failing that, scan the live words.
+    for (size_t pos = 0; pos < table.vars.size(); ++pos) {
+        const auto & values = supports.values[pos];
+        const auto & masks = supports.masks[pos];
+        auto & residues = supports.residues[pos];
+        for_each_set_bit(trail, ct.live[pos], [&](size_t slot) {
+            auto row = slot * supports.n_words;
+            auto residue = residues[slot];
+            if (residue != CompactTableSupports::no_residue && 0 != (ct.words.get(trail, residue) & masks[row + residue]))
+                return;
+
+            for (uint32_t i = 0; i < limit; ++i)
+                if (auto offset = supports.index[i]; 0 != (ct.words.get(trail, offset) & masks[row + offset])) {
+                    residues[slot] = offset;
+                    return;
+                }
+
+            inference.infer(logger, table.vars[pos] != values[slot], JustifyUsingRUP{hint}, table.reason);
+            clear_bit(trail, ct.live[pos], slot);
+            ct.live_count.set(trail, pos, ct.live_count.get(trail, pos) - 1);
+        });
+    }
+
+    // Every tuple that has left the bitset leaves the selector too.
+    for (auto tuple_idx : supports.scratch_tuples)
+        if (Integer selector_value{static_cast<long long>(tuple_idx)}; state.in_domain(table.selector, selector_value))
+            inference.infer(logger, table.selector != selector_value, NoJustificationNeeded{}, NoReason{});
+    ct.selector_size.set(trail, static_cast<size_t>(state.domain_size(table.selector).raw_value));
+
+    // Idempotent when the vars are distinct, for the same reason as
+    // propagate_extensional(): a value survives only if a selectable tuple
+    // matches it, and that tuple's other entries are then all still in domain.
+    // A repeated variable breaks that, because a tuple can match each position
+    // separately and still disagree with itself.
+    return table.repeated_variable ? PropagatorState::Enable : PropagatorState::EnableButIdempotent;
+}
+
+template auto gcs::innards::propagate_compact_table(
+    const CompactTableData &, const State &, SimpleInferenceTracker &, ProofLogger * const, const hints::Table &) -> PropagatorState;
+template auto gcs::innards::propagate_compact_table(
+    const CompactTableData &, const State &, EagerProofLoggingInferenceTracker &, ProofLogger * const, const hints::Table &) -> PropagatorState;
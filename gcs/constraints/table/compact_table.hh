@@ -0,0 +1,158 @@
+#ifndef GLASGOW_CONSTRAINT_SOLVER_GUARD_GCS_CONSTRAINTS_TABLE_COMPACT_TABLE_HH
+#define GLASGOW_CONSTRAINT_SOLVER_GUARD_GCS_CONSTRAINTS_TABLE_COMPACT_TABLE_HH
+
+#include <gcs/constraints/table/hints.hh>
+#include <gcs/extensional.hh>
+#include <gcs/innards/proofs/proof_logger-fwd.hh>
+#include <gcs/innards/propagators-fwd.hh>
+#include <gcs/innards/reason.hh>
+#include <gcs/innards/reversible.hh>
+#include <gcs/innards/state.hh>
+#include <gcs/integer.hh>
+#include <gcs/variable_id.hh>
+
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <vector>
+
+namespace gcs::innards
+{
+    /**
+     * \brief The fixed part of a Compact-Table propagator: for each (variable
+     * position, value) the bitset of tuples that support it.
+     *
+     * Tuples are numbered exactly as Table numbers its selector values, so bit
+     * \c t of a mask stands for `selector == t`. Each position's values are the
+     * ones its variable could take when the constraint was prepared, sorted, and a
+     * value is addressed by its slot in that list; `masks[pos]` holds one row of
+     * \c n_words words per slot, back to back. A wildcard entry sets its tuple's
+     * bit in every slot of that position. A position with any wildcard entry also
+     * gets \c strict_masks, laid out the same way but without the wildcard bits,
+     * which are what a lost value can safely clear; for any other position that
+     * vector is empty and \c masks serves for both.
+     *
+     * The residues are not backtrackable: for each (position, slot) they hold the
+     * word where a support was last found, and a stale residue is simply
+     * re-sought, just as for ExtensionalResidues. Nor is \c index, the order of
+     * the bitset's words, for the reason given for CompactTableState. The
+     * scratch vectors are reused by every call so that a wake allocates nothing.
+     * \c unselectable lists the tuples that preparation ruled out, whose
+     * selector values the first call removes.
+     *
+     * \ingroup Innards
+     */
+    struct CompactTableSupports
+    {
+        static constexpr std::uint32_t no_residue = std::numeric_limits<std::uint32_t>::max();
+
+        std::size_t n_words = 0;
+        std::vector<std::vector<Integer>> values;
+        std::vector<std::vector<std::uint64_t>> masks;
+        std::vector<std::vector<std::uint64_t>> strict_masks;
+        std::vector<std::vector<std::uint32_t>> residues;
+
+        std::vector<std::uint32_t> unselectable;
+
+        std::vector<std::uint32_t> index;
+
+        std::vector<std::uint64_t> scratch_words;
+        std::vector<std::uint32_t> scratch_slots;
+        std::vector<std::uint32_t> scratch_tuples;
+    };
+
+    /**
+     * \brief The backtrackable part of a Compact-Table propagator, held in the
+     * ReversibleTrail so that a search node trails only the words it changes.
+     *
+     * \c words is a reversible sparse bitset over the tuples still selectable:
+     * the first \c limit entries of CompactTableSupports::index name exactly the
+     * words that are not yet zero, so every bitset operation costs only the live
+     * words. Of the two, only \c limit is trailed. A word that becomes zero is
+     * swapped to just before \c limit, and every later swap stays below that,
+     * so restoring \c limit brings back exactly the words that were live, in
+     * some order. \c live holds, per position, the slots whose
+     * values were in the variable's domain at the end of the last call, and
+     * \c live_count their number; comparing these against the current domain
+     * gives the values removed since, which is the delta each call works from.
+     * \c selector_size is the size of the selector's domain at the end of the
+     * last call, so that a call can tell whether anything else has removed a
+     * tuple since, and \c selector_synced says whether the tuples that
+     * preparation ruled out have left the selector yet.
+     *
+     * A handle: copies share the same state.
+     *
+     * \ingroup Innards
+     */
+    struct CompactTableState
+    {
+        ReversibleVector<std::uint64_t> words;
+        Reversible<std::uint32_t> limit;
+        std::vector<ReversibleVector<std::uint64_t>> live;
+        ReversibleVector<std::size_t> live_count;
+        Reversible<std::size_t> selector_size;
+        Reversible<bool> selector_synced;
+    };
+
+    /**
+     * \brief Data for gcs::innards::propagate_compact_table(), built by
+     * gcs::innards::prepare_compact_table().
+     *
+     * \ingroup Innards
+     */
+    struct CompactTableData
+    {
+        IntegerVariableID selector;
+        std::vector<IntegerVariableID> vars;
+        bool repeated_variable;
+        std::shared_ptr<CompactTableSupports> supports;
+        CompactTableState state;
+        Reason reason;
+    };
+
+    /**
+     * \brief Build the support masks for a Table against the initial domains, and
+     * allocate the backtrackable bitset of selectable tuples in the ReversibleTrail.
+     *
+     * Tuples with an entry outside its variable's initial domain start out
+     * unselectable. Must be given at least one tuple, each of the right arity.
+     *
+     * \ingroup Innards
+     * \sa gcs::table::CompactTable
+     */
+    [[nodiscard]] auto prepare_compact_table(const IntegerVariableID & selector, const std::vector<IntegerVariableID> & vars,
+        const ExtensionalTuples & tuples, State & initial_state) -> CompactTableData;
+
+    /**
+     * \brief Compact-Table propagation for Table.
+     *
+     * Enforces the same generalised arc consistency as
+     * gcs::innards::propagate_extensional(), and removes exactly the same values,
+     * but keeps the set of selectable tuples as a bitset rather than as the
+     * selector variable's domain. Each call first works out which values each
+     * variable has lost since the previous call, and removes their tuples from the
+     * bitset, either by clearing the union of the lost values' masks or, when more
+     * values were lost than remain, by intersecting with the union of the remaining
+     * values' masks. It then checks each remaining value for a mask that still
+     * meets the bitset, trying the residue word first.
+     *
+     * The selector is kept in step with the bitset, in both directions: a tuple
+     * that leaves the bitset has its selector value removed, and a selector value
+     * removed by anything else takes its tuple out of the bitset. As in
+     * gcs::innards::propagate_extensional(), a selector value needs no
+     * justification, and every other pruning is justified by RUP from the
+     * selector encoding written by Table::define_proof_model() and the current
+     * domains.
+     *
+     * Idempotent unless the same variable appears at two positions, when a
+     * value kept at one can lose its support through a value removed at the
+     * other.
+     *
+     * \ingroup Innards
+     * \sa gcs::table::CompactTable
+     */
+    auto propagate_compact_table(const CompactTableData &, const State &, auto & inference_tracker, innards::ProofLogger * const,
+        const hints::Table & hint) -> PropagatorState;
+}
+
+#endif
@@ -1,4 +1,5 @@
 #include <gcs/constraints/extensional_utils.hh>
+#include <gcs/constraints/table/compact_table.hh>
 #include <gcs/constraints/table/hints.hh>
 #include <gcs/constraints/table/table.hh>
 #include <gcs/exception.hh>
@@ -28,6 +29,8 @@
 using namespace gcs;
 using namespace gcs::innards;
 
+using std::holds_alternative;
+using std::make_shared;
 using std::optional;
 using std::string;
 using std::stringstream;
@@ -49,9 +52,17 @@ Table::Table(vector<IntegerVariableID> v, ExtensionalTuples t) : _vars(move(v)),
 {
 }
 
+auto Table::with_algorithm(TableAlgorithm algorithm) -> Table &
+{
+    _algorithm = algorithm;
+    return *this;
+}
+
 auto Table::clone() const -> unique_ptr<Constraint>
 {
-    return make_unique<Table>(_vars, ExtensionalTuples{_tuples});
+    auto cloned = make_unique<Table>(_vars, ExtensionalTuples{_tuples});
+    cloned->with_algorithm(_algorithm);
+    return cloned;
 }
 
 namespace
@@ -129,6 +140,11 @@ auto Table::prepare(Propagators &, State & initial_state, ProofModel * const) ->
         },
         _tuples);
 
+    // The selector is allocated either way, because the proof encoding is written
+    // in terms of it, and Compact-Table keeps it in step with its bitset.
+    if (! _has_no_tuples && holds_alternative<table::CompactTable>(_algorithm))
+        _compact_table = make_shared<CompactTableData>(prepare_compact_table(_selector, _vars, _tuples, initial_state));
+
     return true;
 }
 
@@ -174,6 +190,22 @@ auto Table::install_propagators(Propagators & propagators) -> void
         return;
     }
 
+    if (_compact_table) {
+        Triggers triggers;
+        for (auto & v : _vars)
+            triggers.on_change.push_back(v);
+        triggers.on_change.push_back(_selector);
+
+        propagators.install(
+            constraint_id(),
+            [table = std::move(*_compact_table), owner = constraint_id()](
+                const State & state, auto & inference, ProofLogger * const logger) -> PropagatorState {
+                return propagate_compact_table(table, state, inference, logger, hints::Table{owner});
+            },
+            triggers);
+        return;
+    }
+
     visit(
         [&](auto && tuples) {
             Triggers triggers;
@@ -184,8 +216,8 @@ auto Table::install_propagators(Propagators & propagators) -> void
             propagators.install(
                 constraint_id(),
                 [table = ExtensionalData{_selector, move(_vars), move(tuples)}, owner = constraint_id()](
-                    const State & state, auto & inference, ProofLogger * const logger) -> PropagatorState {
-                    return propagate_extensional(table, state, inference, logger, hints::Table{owner});
+                    const State & state, auto & inference, ProofLogger * const logger, const DomainDelta & delta) -> PropagatorState {
+                    return propagate_extensional(table, state, inference, logger, delta, hints::Table{owner});
                 },
                 triggers);
         },
@@ -3,16 +3,67 @@
 
 #include <gcs/constraint.hh>
 #include <gcs/extensional.hh>
+#include <gcs/lifetime.hh>
 #include <gcs/variable_id.hh>
 
+#include <memory>
+#include <variant>
 #include <vector>
 
 namespace gcs
 {
+    namespace innards
+    {
+        struct CompactTableData;
+    }
+
+    namespace table
+    {
+        /**
+         * \brief Propagate Table by scanning the tuples still selected by its selector
+         * variable, remembering a residual support for each value.
+         *
+         * This is the default. It needs no memory beyond the tuples themselves, and is
+         * the better choice for small tables.
+         *
+         * \ingroup Constraints
+         */
+        struct Scan final
+        {
+        };
+
+        /**
+         * \brief Propagate Table with the Compact-Table algorithm: the live tuples are a
+         * reversible sparse bitset, each (variable, value) has a precomputed bitset of
+         * the tuples it supports, and each wake works only from the values lost since
+         * the last one.
+         *
+         * This costs a support bitset per value, one bit per tuple, built when the
+         * constraint is prepared, and pays off on large tables, where a wake costs a
+         * few word operations per live word rather than a pass over every tuple.
+         *
+         * \ingroup Constraints
+         */
+        struct CompactTable final
+        {
+        };
+    }
+
+    /**
+     * \brief The propagation algorithms supported by Table: table::Scan (the default)
+     * or table::CompactTable. Both enforce generalised arc consistency and remove
+     * exactly the same values, and the choice never changes the proof encoding.
+     *
+     * \ingroup Constraints
+     */
+    using TableAlgorithm = std::variant<table::Scan, table::CompactTable>;
+
     /**
      * \brief Constrain that the specified variables are equal to one of the specified
      * tuples.
      *
+     * Select the propagation algorithm with with_algorithm().
+     *
      * \ingroup Constraints
      * \see SmartTable
      */
@@ -23,10 +74,34 @@ namespace gcs
         ExtensionalTuples _tuples;
         SimpleIntegerVariableID _selector{0};
         bool _has_no_tuples = false;
+        TableAlgorithm _algorithm = table::Scan{};
+
+        // Built by prepare() under table::CompactTable, consumed by install_propagators().
+        std::shared_ptr<innards::CompactTableData> _compact_table;
 
     public:
         explicit Table(std::vector<IntegerVariableID> vars, ExtensionalTuples tuples);
 
+        /// Select the propagation algorithm: table::Scan (the default) or table::CompactTable.
+        /// The choice never changes which values are removed or the OPB encoding.
+        auto with_algorithm(TableAlgorithm algorithm) -> Table &;
+
+        /**
+         * \brief The variables, as posted, for presolvers.
+         */
+        [[nodiscard]] auto variables() const GCS_LIFETIME_BOUND -> const std::vector<IntegerVariableID> &
+        {
+            return _vars;
+        }
+
+        /**
+         * \brief The permitted tuples, as posted, for presolvers.
+         */
+        [[nodiscard]] auto tuples() const GCS_LIFETIME_BOUND -> const ExtensionalTuples &
+        {
+            return _tuples;
+        }
+
         virtual auto define_proof_model(innards::ProofModel &, const innards::State &) -> void override;
         virtual auto install_propagators(innards::Propagators &) -> void override;
         virtual auto prepare(innards::Propagators &, innards::State &, innards::ProofModel * const) -> bool override;
@@ -41,11 +41,24 @@ using fmt::println;
 using namespace gcs;
 using namespace gcs::test_innards;
 
-auto run_table_test_2(bool proofs, const ViewWrapConfig & view_cfg, pair<int, int> r1, pair<int, int> r2, SimpleTuples allowed) -> void
+namespace
+{
+    auto algorithm_label(const TableAlgorithm & algorithm) -> const char *
+    {
+        return overloaded{
+            [](table::Scan) { return "scan"; },                  //
+            [](table::CompactTable) { return "compact table"; } //
+        }
+            .visit(algorithm);
+    }
+}
+
+auto run_table_test_2(bool proofs, const TableAlgorithm & algorithm, const ViewWrapConfig & view_cfg, pair<int, int> r1, pair<int, int> r2,
+    SimpleTuples allowed) -> void
 {
     auto wraps = wraps_for_positions(view_cfg, 2);
-    print(cerr, "table 2var [{}] [{},{}] [{},{}] {} tuples{}", view_wrap_config_label(view_cfg), r1.first, r1.second, r2.first, r2.second,
-        allowed.size(), proofs ? " with proofs:" : ":");
+    print(cerr, "table 2var {} [{}] [{},{}] [{},{}] {} tuples{}", algorithm_label(algorithm), view_wrap_config_label(view_cfg), r1.first,
+        r1.second, r2.first, r2.second, allowed.size(), proofs ? " with proofs:" : ":");
     cerr << flush;
 
     set<tuple<int, int>> expected, actual;
@@ -63,19 +76,19 @@ auto run_table_test_2(bool proofs, const ViewWrapConfig & view_cfg, pair<int, in
     Problem p;
     auto v1 = create_integer_variable_or_constant_with_view(p, r1, wraps.at(0));
     auto v2 = create_integer_variable_or_constant_with_view(p, r2, wraps.at(1));
-    p.post(Table{{v1, v2}, allowed});
+    p.post(Table{{v1, v2}, allowed}.with_algorithm(algorithm));
 
     auto proof_name = proofs ? make_optional("table_test_" + view_wrap_config_label(view_cfg)) : nullopt;
     solve_for_tests_checking_gac(p, proof_name, expected, actual, tuple{v1, v2});
     check_results(proof_name, expected, actual);
 }
 
-auto run_table_test_3(bool proofs, const ViewWrapConfig & view_cfg, pair<int, int> r1, pair<int, int> r2, pair<int, int> r3, SimpleTuples allowed)
-    -> void
+auto run_table_test_3(bool proofs, const TableAlgorithm & algorithm, const ViewWrapConfig & view_cfg, pair<int, int> r1, pair<int, int> r2,
+    pair<int, int> r3, SimpleTuples allowed) -> void
 {
     auto wraps = wraps_for_positions(view_cfg, 3);
-    print(cerr, "table 3var [{}] [{},{}] [{},{}] [{},{}] {} tuples{}", view_wrap_config_label(view_cfg), r1.first, r1.second, r2.first, r2.second,
-        r3.first, r3.second, allowed.size(), proofs ? " with proofs:" : ":");
+    print(cerr, "table 3var {} [{}] [{},{}] [{},{}] [{},{}] {} tuples{}", algorithm_label(algorithm), view_wrap_config_label(view_cfg), r1.first,
+        r1.second, r2.first, r2.second, r3.first, r3.second, allowed.size(), proofs ? " with proofs:" : ":");
     cerr << flush;
 
     set<tuple<int, int, int>> expected, actual;
@@ -94,19 +107,19 @@ auto run_table_test_3(bool proofs, const ViewWrapConfig & view_cfg, pair<int, in
     auto v1 = create_integer_variable_or_constant_with_view(p, r1, wraps.at(0));
     auto v2 = create_integer_variable_or_constant_with_view(p, r2, wraps.at(1));
     auto v3 = create_integer_variable_or_constant_with_view(p, r3, wraps.at(2));
-    p.post(Table{{v1, v2, v3}, allowed});
+    p.post(Table{{v1, v2, v3}, allowed}.with_algorithm(algorithm));
 
     auto proof_name = proofs ? make_optional("table_test_" + view_wrap_config_label(view_cfg)) : nullopt;
     solve_for_tests_checking_gac(p, proof_name, expected, actual, tuple{v1, v2, v3});
     check_results(proof_name, expected, actual);
 }
 
-auto run_wildcard_table_test(
-    bool proofs, const ViewWrapConfig & view_cfg, pair<int, int> r1, pair<int, int> r2, pair<int, int> r3, WildcardTuples allowed) -> void
+auto run_wildcard_table_test(bool proofs, const TableAlgorithm & algorithm, const ViewWrapConfig & view_cfg, pair<int, int> r1, pair<int, int> r2,
+    pair<int, int> r3, WildcardTuples allowed) -> void
 {
     auto wraps = wraps_for_positions(view_cfg, 3);
-    print(cerr, "wildcard table [{}] [{},{}] [{},{}] [{},{}] {} tuples{}", view_wrap_config_label(view_cfg), r1.first, r1.second, r2.first, r2.second,
-        r3.first, r3.second, allowed.size(), proofs ? " with proofs:" : ":");
+    print(cerr, "wildcard table {} [{}] [{},{}] [{},{}] [{},{}] {} tuples{}", algorithm_label(algorithm), view_wrap_config_label(view_cfg),
+        r1.first, r1.second, r2.first, r2.second, r3.first, r3.second, allowed.size(), proofs ? " with proofs:" : ":");
     cerr << flush;
 
     auto entry_matches = [](const IntegerOrWildcard & entry, int val) -> bool {
@@ -133,7 +146,7 @@ auto run_wildcard_table_test(
     auto v1 = create_integer_variable_or_constant_with_view(p, r1, wraps.at(0));
     auto v2 = create_integer_variable_or_constant_with_view(p, r2, wraps.at(1));
     auto v3 = create_integer_variable_or_constant_with_view(p, r3, wraps.at(2));
-    p.post(Table{{v1, v2, v3}, allowed});
+    p.post(Table{{v1, v2, v3}, allowed}.with_algorithm(algorithm));
 
     auto proof_name = proofs ? make_optional("table_test_" + view_wrap_config_label(view_cfg)) : nullopt;
     solve_for_tests_checking_gac(p, proof_name, expected, actual, tuple{v1, v2, v3});
@@ -143,9 +156,11 @@ auto run_wildcard_table_test(
 // Dup-variable test: Table with the same handle in several positions.
 // Tuples where the duplicated positions disagree are infeasible.
 // Consistency isn't checked on dup runs; see tmp/duplicate_var_audit.md.
-auto run_dup_table_test(bool proofs, const vector<pair<int, int>> & unique_domains, const vector<int> & positions, SimpleTuples allowed) -> void
+auto run_dup_table_test(bool proofs, const TableAlgorithm & algorithm, const vector<pair<int, int>> & unique_domains, const vector<int> & positions,
+    SimpleTuples allowed) -> void
 {
-    print(cerr, "table dup unique_doms={} positions={} {} tuples{}", unique_domains, positions, allowed.size(), proofs ? " with proofs:" : ":");
+    print(cerr, "table dup {} unique_doms={} positions={} {} tuples{}", algorithm_label(algorithm), unique_domains, positions, allowed.size(),
+        proofs ? " with proofs:" : ":");
     cerr << flush;
 
     set<tuple<vector<int>>> expected, actual;
@@ -174,36 +189,57 @@ auto run_dup_table_test(bool proofs, const vector<pair<int, int>> & unique_domai
     vector<IntegerVariableID> vars;
     for (auto pos : positions)
         vars.push_back(unique_vars.at(pos));
-    p.post(Table{vars, allowed});
+    p.post(Table{vars, allowed}.with_algorithm(algorithm));
 
     auto proof_name = proofs ? make_optional("table_test_dup") : nullopt;
     solve_for_tests(p, proof_name, actual, tuple{unique_vars});
     check_results(proof_name, expected, actual);
 }
 
-auto run_all_tests(bool proofs, const ViewWrapConfig & view_cfg) -> void
+auto run_all_tests(bool proofs, const TableAlgorithm & algorithm, const ViewWrapConfig & view_cfg) -> void
 {
     // Table, 2 variables
-    run_table_test_2(proofs, view_cfg, {1, 3}, {1, 3}, {{1_i, 1_i}, {1_i, 3_i}, {2_i, 2_i}, {3_i, 1_i}});
-    run_table_test_2(proofs, view_cfg, {1, 4}, {1, 4}, {{1_i, 2_i}, {2_i, 1_i}, {3_i, 4_i}, {4_i, 3_i}});
-    run_table_test_2(proofs, view_cfg, {1, 3}, {1, 3}, {}); // empty table: unsatisfiable
-    run_table_test_2(proofs, view_cfg, {-2, 2}, {-2, 2}, {{-2_i, 2_i}, {0_i, 0_i}, {2_i, -2_i}});
+    run_table_test_2(proofs, algorithm, view_cfg, {1, 3}, {1, 3}, {{1_i, 1_i}, {1_i, 3_i}, {2_i, 2_i}, {3_i, 1_i}});
+    run_table_test_2(proofs, algorithm, view_cfg, {1, 4}, {1, 4}, {{1_i, 2_i}, {2_i, 1_i}, {3_i, 4_i}, {4_i, 3_i}});
+    run_table_test_2(proofs, algorithm, view_cfg, {1, 3}, {1, 3}, {}); // empty table: unsatisfiable
+    run_table_test_2(proofs, algorithm, view_cfg, {-2, 2}, {-2, 2}, {{-2_i, 2_i}, {0_i, 0_i}, {2_i, -2_i}});
     // Degenerate (issue #254): all-fixed variables, both directions, and a
     // mixed fixed+variable case. (Empty tuple list → UNSAT is covered above.)
-    run_table_test_2(proofs, view_cfg, {1, 1}, {1, 1}, {{1_i, 1_i}});             // fixed (1,1) is an allowed tuple (tautology)
-    run_table_test_2(proofs, view_cfg, {2, 2}, {3, 3}, {{1_i, 1_i}});             // fixed (2,3) is not in the table (contradiction)
-    run_table_test_2(proofs, view_cfg, {1, 1}, {1, 3}, {{1_i, 1_i}, {1_i, 2_i}}); // mixed: v1 fixed, v2 variable
+    run_table_test_2(proofs, algorithm, view_cfg, {1, 1}, {1, 1}, {{1_i, 1_i}});             // fixed (1,1) is an allowed tuple (tautology)
+    run_table_test_2(proofs, algorithm, view_cfg, {2, 2}, {3, 3}, {{1_i, 1_i}});             // fixed (2,3) is not in the table (contradiction)
+    run_table_test_2(proofs, algorithm, view_cfg, {1, 1}, {1, 3}, {{1_i, 1_i}, {1_i, 2_i}}); // mixed: v1 fixed, v2 variable
 
     // Table, 3 variables
-    run_table_test_3(proofs, view_cfg, {1, 3}, {1, 3}, {1, 3}, {{1_i, 1_i, 1_i}, {1_i, 2_i, 3_i}, {2_i, 1_i, 3_i}, {3_i, 3_i, 3_i}});
-    run_table_test_3(proofs, view_cfg, {1, 3}, {2, 4}, {1, 2}, {{2_i, 3_i, 1_i}, {2_i, 4_i, 2_i}}); // tight domain: forces propagation
-    run_table_test_3(proofs, view_cfg, {1, 3}, {1, 3}, {1, 3}, {});                                 // empty table: unsatisfiable
-    run_table_test_3(proofs, view_cfg, {-2, 2}, {-2, 2}, {-2, 2}, {{-2_i, 0_i, 2_i}, {0_i, 0_i, 0_i}, {2_i, 0_i, -2_i}});
+    run_table_test_3(proofs, algorithm, view_cfg, {1, 3}, {1, 3}, {1, 3}, {{1_i, 1_i, 1_i}, {1_i, 2_i, 3_i}, {2_i, 1_i, 3_i}, {3_i, 3_i, 3_i}});
+    run_table_test_3(proofs, algorithm, view_cfg, {1, 3}, {2, 4}, {1, 2}, {{2_i, 3_i, 1_i}, {2_i, 4_i, 2_i}}); // tight domain: forces propagation
+    run_table_test_3(proofs, algorithm, view_cfg, {1, 3}, {1, 3}, {1, 3}, {});                                 // empty table: unsatisfiable
+    run_table_test_3(proofs, algorithm, view_cfg, {-2, 2}, {-2, 2}, {-2, 2}, {{-2_i, 0_i, 2_i}, {0_i, 0_i, 0_i}, {2_i, 0_i, -2_i}});
 
     // Wildcard Table
-    run_wildcard_table_test(proofs, view_cfg, {1, 3}, {1, 3}, {1, 3}, {{{Wildcard{}, 2_i, Wildcard{}}}}); // only middle position must be 2
-    run_wildcard_table_test(proofs, view_cfg, {1, 3}, {1, 3}, {1, 3}, {{{1_i, Wildcard{}, 3_i}, {Wildcard{}, 2_i, Wildcard{}}}});
-    run_wildcard_table_test(proofs, view_cfg, {1, 3}, {1, 3}, {1, 3}, {{{Wildcard{}, Wildcard{}, Wildcard{}}}}); // all wildcards: all tuples allowed
+    // only middle position must be 2
+    run_wildcard_table_test(proofs, algorithm, view_cfg, {1, 3}, {1, 3}, {1, 3}, {{{Wildcard{}, 2_i, Wildcard{}}}});
+    run_wildcard_table_test(proofs, algorithm, view_cfg, {1, 3}, {1, 3}, {1, 3}, {{{1_i, Wildcard{}, 3_i}, {Wildcard{}, 2_i, Wildcard{}}}});
+    // all wildcards: all tuples allowed
+    run_wildcard_table_test(proofs, algorithm, view_cfg, {1, 3}, {1, 3}, {1, 3}, {{{Wildcard{}, Wildcard{}, Wildcard{}}}});
+
+    // More than one 64-tuple word, so that the Compact-Table bitset has words to
+    // empty and swap out of its live set.
+    SimpleTuples many;
+    for (int a = 0; a <= 5; ++a)
+        for (int b = 0; b <= 5; ++b)
+            for (int c = 0; c <= 5; ++c)
+                if ((a + 2 * b + 3 * c) % 4 != 0)
+                    many.push_back({Integer{a}, Integer{b}, Integer{c}});
+    run_table_test_3(proofs, algorithm, view_cfg, {0, 5}, {1, 5}, {0, 4}, many);
+
+    WildcardTuples many_wild;
+    for (int a = 0; a <= 5; ++a)
+        for (int b = 0; b <= 5; ++b)
+            for (int c = 0; c <= 5; ++c)
+                if ((a * b + c) % 3 == 0)
+                    many_wild.push_back({Integer{a}, Integer{b}, Integer{c}});
+    many_wild.push_back({Wildcard{}, 5_i, Wildcard{}});
+    run_wildcard_table_test(proofs, algorithm, view_cfg, {0, 5}, {0, 5}, {0, 5}, many_wild);
 }
 
 auto main(int argc, char * argv[]) -> int
@@ -223,13 +259,16 @@ auto main(int argc, char * argv[]) -> int
     for (bool proofs : {false, true}) {
         if (proofs && ! can_run_veripb())
             continue;
-        run_all_tests(proofs, view_cfg);
-        if (run_dup) {
-            // {x, y, x} with mixed-match tuples: (1, 2, 1) matches (cols 0
-            // and 2 share x=1), (1, 2, 2) does not (cols 0 and 2 disagree).
-            run_dup_table_test(proofs, {{1, 3}, {1, 3}}, {0, 1, 0}, {{1_i, 2_i, 1_i}, {1_i, 2_i, 2_i}, {2_i, 3_i, 2_i}, {3_i, 3_i, 3_i}});
-            // {x, x} — only diagonal tuples can match.
-            run_dup_table_test(proofs, {{1, 3}}, {0, 0}, {{1_i, 1_i}, {2_i, 3_i}, {3_i, 3_i}});
+        for (TableAlgorithm algorithm : {TableAlgorithm{table::Scan{}}, TableAlgorithm{table::CompactTable{}}}) {
+            run_all_tests(proofs, algorithm, view_cfg);
+            if (run_dup) {
+                // {x, y, x} with mixed-match tuples: (1, 2, 1) matches (cols 0
+                // and 2 share x=1), (1, 2, 2) does not (cols 0 and 2 disagree).
+                run_dup_table_test(
+                    proofs, algorithm, {{1, 3}, {1, 3}}, {0, 1, 0}, {{1_i, 2_i, 1_i}, {1_i, 2_i, 2_i}, {2_i, 3_i, 2_i}, {3_i, 3_i, 3_i}});
+                // {x, x} — only diagonal tuples can match.
+                run_dup_table_test(proofs, algorithm, {{1, 3}}, {0, 0}, {{1_i, 1_i}, {2_i, 3_i}, {3_i, 3_i}});
+            }
         }
     }
 
@@ -4,7 +4,6 @@
 using namespace gcs;
 using namespace gcs::innards;
 
-using std::generator;
 using std::make_unique;
 using std::move;
 using std::string;
@@ -69,20 +68,27 @@ auto CurrentState::in_domain(const IntegerVariableID v, Integer n) const -> bool
     return _full_state.in_domain(v, n);
 }
 
-auto CurrentState::each_value(const IntegerVariableID v) const -> generator<Integer>
+auto CurrentState::each_value(const IntegerVariableID v) const -> DomainValues
 {
     return _full_state.each_value_mutable(v);
 }
 
-auto CurrentState::each_value_reversed(const IntegerVariableID v) const -> generator<Integer>
+auto CurrentState::each_value_reversed(const IntegerVariableID v) const -> ReversedDomainValues
 {
-    return [](IntervalSet<Integer> values) -> generator<Integer> {
-        for (auto i : values.each_reversed())
-            co_yield i;
-    }(_full_state.copy_of_values(v));
+    return ReversedDomainValues::snapshot(_full_state.copy_of_values(v), false, 0_i);
 }
 
 auto CurrentState::copy_of_values(const IntegerVariableID v) const -> IntervalSet<Integer>
 {
     return _full_state.copy_of_values(v);
 }
+
+auto CurrentState::search_arena() const -> SearchArena &
+{
+    return _full_state.search_arena();
+}
+
+auto CurrentState::saved_phases() const -> SavedPhases &
+{
+    return _full_state.saved_phases();
+}
@@ -2,6 +2,9 @@
 #define GLASGOW_CONSTRAINT_SOLVER_GUARD_GCS_CURRENT_STATE_HH
 
 #include <gcs/exception.hh>
+#include <gcs/innards/domain_values.hh>
+#include <gcs/innards/saved_phases.hh>
+#include <gcs/innards/search_arena.hh>
 #include <gcs/innards/state-fwd.hh>
 #include <gcs/integer.hh>
 #include <gcs/interval_set-fwd.hh>
@@ -10,13 +13,6 @@
 
 #include <functional>
 #include <memory>
-#include <version>
-
-#ifdef __cpp_lib_generator
-#include <generator>
-#else
-#include <__generator.hpp>
-#endif
 
 namespace gcs
 {
@@ -128,17 +124,20 @@ namespace gcs
         [[nodiscard]] auto in_domain(const IntegerVariableID, Integer) const -> bool;
 
         /**
-         * \brief Returns a generator that gives each value in the variable's domain.
+         * \brief Returns a range that gives each value in the variable's domain.
+         *
+         * The range holds its own copy of the domain, so it stays valid if
+         * search changes the variable while it is in use.
          */
-        [[nodiscard]] auto each_value(const IntegerVariableID) const -> std::generator<Integer>;
+        [[nodiscard]] auto each_value(const IntegerVariableID) const -> innards::DomainValues;
 
         /**
-         * \brief Returns a generator that gives each value in the variable's
+         * \brief Returns a range that gives each value in the variable's
          * domain in descending order.
          *
          * \sa CurrentState::each_value()
          */
-        [[nodiscard]] auto each_value_reversed(const IntegerVariableID) const -> std::generator<Integer>;
+        [[nodiscard]] auto each_value_reversed(const IntegerVariableID) const -> innards::ReversedDomainValues;
 
         /**
          * \brief Returns the values in a variable's domain, as an IntervalSet. Usually
@@ -150,6 +149,30 @@ namespace gcs
         [[nodiscard]] auto copy_of_values(const IntegerVariableID) const -> IntervalSet<Integer>;
 
         ///@}
+
+        /**
+         * \name For branching heuristics.
+         * @{
+         */
+
+        /**
+         * \brief The arena from which a branching heuristic can allocate what
+         * lives no longer than the search node, such as its coroutine frame.
+         *
+         * \sa innards::SearchArena
+         */
+        [[nodiscard]] auto search_arena() const -> innards::SearchArena &;
+
+        /**
+         * \brief The value search last gave each variable, and its value in
+         * the most recent solution, which a branching heuristic can use to
+         * pick up where search left off.
+         *
+         * \sa innards::SavedPhases
+         */
+        [[nodiscard]] auto saved_phases() const -> innards::SavedPhases &;
+
+        ///@}
     };
 }
 
@@ -10,7 +10,9 @@
 #include <gcs/extensional.hh>
 #include <gcs/integer.hh>
 #include <gcs/interval_set.hh>
+#include <gcs/large_neighbourhood_search.hh>
 #include <gcs/problem.hh>
+#include <gcs/propagation_profile.hh>
 #include <gcs/proof.hh>
 #include <gcs/reification.hh>
 #include <gcs/restarts.hh>
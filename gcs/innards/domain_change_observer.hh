@@ -0,0 +1,71 @@
+#ifndef GLASGOW_CONSTRAINT_SOLVER_GUARD_GCS_INNARDS_DOMAIN_CHANGE_OBSERVER_HH
+#define GLASGOW_CONSTRAINT_SOLVER_GUARD_GCS_INNARDS_DOMAIN_CHANGE_OBSERVER_HH
+
+#include <gcs/innards/literal.hh>
+#include <gcs/innards/state-fwd.hh>
+#include <gcs/variable_id.hh>
+
+namespace gcs::innards
+{
+    /**
+     * \brief Watches propagation for the variables whose domains change, so
+     * that something kept alongside the search, such as a branching
+     * heuristic's index of its variables, can do work proportional to what
+     * changed rather than rescanning everything at every node.
+     *
+     * Borrowed observers are attached to the Propagators for the duration of a
+     * search (Propagators::add_domain_change_observer). Propagators::propagate
+     * notifies each attached observer of every guess it is given, and then of
+     * every variable changed by each propagator run, once per variable per
+     * run. This is the same information that decides which propagators to
+     * wake, so it costs nothing extra to collect. Nothing is said about
+     * backtracking: an observer that cares has to notice that for itself,
+     * for example by keeping a Reversible beside what it has been told.
+     *
+     * Each call to propagate() is also bracketed by
+     * note_propagation_starting() and note_propagation_finished(), so that a
+     * heuristic that learns from what propagation does at each node, such as
+     * activity-based or impact-based search, can tell one node from the next.
+     * These do nothing unless overridden.
+     *
+     * \ingroup Innards
+     * \sa ConflictObserver
+     */
+    class DomainChangeObserver
+    {
+    public:
+        virtual ~DomainChangeObserver() = default;
+
+        /**
+         * \brief Called when the domain of \p var may have changed.
+         */
+        virtual auto note_domain_change(SimpleIntegerVariableID var) -> void = 0;
+
+        /**
+         * \brief Called when anything at all may have changed without being
+         * noted, as when propagate() is called with no guesses after
+         * initialisers and presolvers have been at work.
+         */
+        virtual auto note_everything_changed() -> void = 0;
+
+        /**
+         * \brief Called at the start of propagate(), with the guesses it was
+         * given, which have already been made, and before any of them is
+         * noted as a domain change.
+         */
+        virtual auto note_propagation_starting(const Literals &) -> void
+        {
+        }
+
+        /**
+         * \brief Called at the end of propagate(), with whether it reached a
+         * fixed point rather than a contradiction, and the state as
+         * propagation left it.
+         */
+        virtual auto note_propagation_finished(bool, const State &) -> void
+        {
+        }
+    };
+}
+
+#endif
@@ -0,0 +1,153 @@
+#ifndef GLASGOW_CONSTRAINT_SOLVER_GUARD_GCS_INNARDS_DOMAIN_VALUES_HH
+#define GLASGOW_CONSTRAINT_SOLVER_GUARD_GCS_INNARDS_DOMAIN_VALUES_HH
+
+#include <gcs/integer.hh>
+#include <gcs/interval_set.hh>
+
+#include <cstddef>
+#include <iterator>
+#include <utility>
+
+namespace gcs::innards
+{
+    /**
+     * \brief The values in a variable's domain, as a forward range that needs
+     * no heap allocation.
+     *
+     * Returned by State::each_value_immutable(), State::each_value_mutable()
+     * and CurrentState::each_value(). It either borrows the variable's
+     * IntervalSet, which must then not be modified whilst iterating, or holds
+     * its own copy of it. A domain of a couple of intervals is copied inline,
+     * so a snapshot costs a few words rather than an allocation. Any view of
+     * the variable is applied as each value is read, and the values come out
+     * in the order of the underlying domain, so a negated view gives them in
+     * descending order.
+     *
+     * \tparam reversed_ Walk the underlying domain from the top down instead.
+     *
+     * \ingroup Innards
+     * \sa DomainValues, ReversedDomainValues
+     */
+    template <bool reversed_>
+    class BasicDomainValues
+    {
+    private:
+        const IntervalSet<Integer> * _borrowed;
+        IntervalSet<Integer> _owned;
+        bool _negate_first;
+        Integer _then_add;
+
+        BasicDomainValues(const IntervalSet<Integer> * borrowed, IntervalSet<Integer> owned, bool negate_first, Integer then_add) :
+            _borrowed(borrowed),
+            _owned(std::move(owned)),
+            _negate_first(negate_first),
+            _then_add(then_add)
+        {
+        }
+
+    public:
+        /**
+         * \brief Iterates over a BasicDomainValues, applying the view.
+         */
+        class Iterator
+        {
+        private:
+            typename IntervalSet<Integer>::template ValueIterator<reversed_> _value{};
+            bool _negate_first = false;
+            Integer _then_add = 0_i;
+
+        public:
+            using value_type = Integer;
+            using difference_type = std::ptrdiff_t;
+            using iterator_concept = std::forward_iterator_tag;
+
+            Iterator() = default;
+
+            Iterator(typename IntervalSet<Integer>::template ValueIterator<reversed_> value, bool negate_first, Integer then_add) :
+                _value(value),
+                _negate_first(negate_first),
+                _then_add(then_add)
+            {
+            }
+
+            [[nodiscard]] auto operator*() const -> Integer
+            {
+                return (_negate_first ? -*_value : *_value) + _then_add;
+            }
+
+            auto operator++() -> Iterator &
+            {
+                ++_value;
+                return *this;
+            }
+
+            auto operator++(int) -> Iterator
+            {
+                auto result = *this;
+                ++*this;
+                return result;
+            }
+
+            [[nodiscard]] auto operator==(const Iterator & other) const -> bool
+            {
+                return _value == other._value;
+            }
+
+            [[nodiscard]] auto operator==(std::default_sentinel_t) const -> bool
+            {
+                return _value == std::default_sentinel;
+            }
+        };
+
+        /**
+         * \brief Iterate over \p set, which must outlive us and not be modified
+         * whilst iterating.
+         */
+        [[nodiscard]] static auto borrowing(const IntervalSet<Integer> & set, bool negate_first, Integer then_add) -> BasicDomainValues
+        {
+            return BasicDomainValues{&set, IntervalSet<Integer>{}, negate_first, then_add};
+        }
+
+        /**
+         * \brief Iterate over our own copy of \p set.
+         */
+        [[nodiscard]] static auto snapshot(IntervalSet<Integer> set, bool negate_first, Integer then_add) -> BasicDomainValues
+        {
+            return BasicDomainValues{nullptr, std::move(set), negate_first, then_add};
+        }
+
+        [[nodiscard]] auto begin() const -> Iterator
+        {
+            // Looked up here rather than when we are made, so that moving a
+            // snapshot before iterating over it is safe.
+            const auto & set = _borrowed ? *_borrowed : _owned;
+            if constexpr (reversed_)
+                return Iterator{set.values_reversed().begin(), _negate_first, _then_add};
+            else
+                return Iterator{set.values().begin(), _negate_first, _then_add};
+        }
+
+        [[nodiscard]] auto end() const -> std::default_sentinel_t
+        {
+            return std::default_sentinel;
+        }
+    };
+
+    /**
+     * \brief The values in a variable's domain, in the order of the underlying
+     * domain.
+     *
+     * \ingroup Innards
+     */
+    using DomainValues = BasicDomainValues<false>;
+
+    /**
+     * \brief The values in a variable's domain, in the reverse of the order
+     * DomainValues gives them.
+     *
+     * \ingroup Innards
+     */
+    using ReversedDomainValues = BasicDomainValues<true>;
+}
+
+#endif
@@ -12,16 +12,9 @@
 #include <deque>
 #include <optional>
 #include <utility>
-#include <version>
 
 #include <util/overloaded.hh>
 
-#ifdef __cpp_lib_generator
-#include <generator>
-#else
-#include <__generator.hpp>
-#endif
-
 namespace gcs::innards
 {
     class TrackedPropagationFailed
@@ -685,19 +678,6 @@ namespace gcs::innards
                 track_explicit(logger, _state.infer(lit), lit, why, snapshotted, fallback);
         }
 
-        // Yields this round's inferences in the order they were made (oldest first). The
-        // propagation queue replays them to wake the next round's propagators, so this order
-        // is the order in which a variable's changes re-trigger its propagators: oldest-first
-        // keeps that requeue properly FIFO (matching the FIFO drain), rather than the reverse
-        // (newest-first) order, which made the requeue effectively LIFO within a round.
-        auto each_inference() const -> std::generator<std::pair<SimpleIntegerVariableID, Inference>>
-        {
-            return [](const auto & inferences) -> std::generator<std::pair<SimpleIntegerVariableID, Inference>> {
-                for (const auto & [var, inf] : inferences)
-                    co_yield std::pair{var, inf};
-            }(_inferences);
-        }
-
         // How many firing inferences have been recorded since the last reset().
         // Unlike the destructive progress-flag reads below, this is a
         // non-destructive read: the propagation queue brackets each propagator
@@ -709,6 +689,15 @@ namespace gcs::innards
             return _inferences.size();
         }
 
+        // The inference at a given index, counting from the last reset(), so
+        // in the order they were made. The propagation queue reads each run's
+        // range with this as the run ends, folding it into one batch of events
+        // per variable for the round-boundary requeue and for domain deltas.
+        [[nodiscard]] auto inference_at(std::size_t i) const -> std::pair<SimpleIntegerVariableID, Inference>
+        {
+            return _inferences[i];
+        }
+
         auto reset() -> void
         {
             _inferences.clear();
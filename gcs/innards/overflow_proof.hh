@@ -0,0 +1,149 @@
+#ifndef GLASGOW_CONSTRAINT_SOLVER_GUARD_GCS_INNARDS_OVERFLOW_PROOF_HH
+#define GLASGOW_CONSTRAINT_SOLVER_GUARD_GCS_INNARDS_OVERFLOW_PROOF_HH
+
+#include <gcs/innards/integer_overflow.hh>
+#include <gcs/integer.hh>
+
+namespace gcs::innards
+{
+    /**
+     * \brief Integer arithmetic as its operators do it, checking every
+     * operation for overflow. The default policy for propagators that are
+     * templated on their arithmetic.
+     *
+     * \sa UncheckedArithmetic
+     * \ingroup Innards
+     */
+    struct CheckedArithmetic final
+    {
+        [[nodiscard]] static constexpr auto add(Integer a, Integer b) -> Integer
+        {
+            return a + b;
+        }
+
+        [[nodiscard]] static constexpr auto sub(Integer a, Integer b) -> Integer
+        {
+            return a - b;
+        }
+
+        [[nodiscard]] static constexpr auto mul(Integer a, Integer b) -> Integer
+        {
+            return a * b;
+        }
+
+        [[nodiscard]] static constexpr auto div(Integer a, Integer b) -> Integer
+        {
+            return a / b;
+        }
+
+        [[nodiscard]] static constexpr auto neg(Integer a) -> Integer
+        {
+            return -a;
+        }
+    };
+
+    /**
+     * \brief Integer arithmetic with no overflow checks, for a propagator
+     * instance that an OverflowProof has shown cannot overflow.
+     *
+     * Using this without such a proof is undefined behaviour on overflow,
+     * rather than an IntegerOverflow exception.
+     *
+     * \sa CheckedArithmetic
+     * \ingroup Innards
+     */
+    struct UncheckedArithmetic final
+    {
+        [[nodiscard]] static constexpr auto add(Integer a, Integer b) -> Integer
+        {
+            return Integer{a.raw_value + b.raw_value};
+        }
+
+        [[nodiscard]] static constexpr auto sub(Integer a, Integer b) -> Integer
+        {
+            return Integer{a.raw_value - b.raw_value};
+        }
+
+        [[nodiscard]] static constexpr auto mul(Integer a, Integer b) -> Integer
+        {
+            return Integer{a.raw_value * b.raw_value};
+        }
+
+        [[nodiscard]] static constexpr auto div(Integer a, Integer b) -> Integer
+        {
+            return Integer{a.raw_value / b.raw_value};
+        }
+
+        [[nodiscard]] static constexpr auto neg(Integer a) -> Integer
+        {
+            return Integer{-a.raw_value};
+        }
+    };
+
+    /**
+     * \brief An install-time range analysis, to show that a sum of weighted
+     * variables plus some constants can never overflow, whatever values the
+     * variables take during search.
+     *
+     * Add each term with its initial bounds, and each constant, and then ask
+     * proven(). This keeps a bound on the magnitude of the whole sum. Domains
+     * only ever shrink, so the bound holds for the rest of the search, and so
+     * does a proof made from it. proven() asks for the bound to be below
+     * 2^61, so that anything made from a few such sums is safe too. That
+     * covers a partial sum, the difference of two of them, or any of those
+     * plus one. Any overflow while building the bound leaves the proof
+     * failed, rather than throwing.
+     *
+     * \ingroup Innards
+     */
+    class OverflowProof final
+    {
+    private:
+        unsigned long long _bound = 0;
+        bool _failed = false;
+
+        [[nodiscard]] static auto magnitude(Integer v) -> unsigned long long
+        {
+            return v.raw_value < 0 ? 0ull - static_cast<unsigned long long>(v.raw_value) : static_cast<unsigned long long>(v.raw_value);
+        }
+
+        auto add_magnitude(unsigned long long m) -> void
+        {
+            _failed = _failed || add_overflows(_bound, m, &_bound);
+        }
+
+    public:
+        /**
+         * \brief Account for a term `coeff * x` with `lower <= x <= upper`.
+         */
+        auto add_term(Integer coeff, Integer lower, Integer upper) -> void
+        {
+            auto b = magnitude(lower) > magnitude(upper) ? magnitude(lower) : magnitude(upper);
+            unsigned long long m;
+            if (mul_overflows(magnitude(coeff), b, &m))
+                _failed = true;
+            else
+                add_magnitude(m);
+        }
+
+        /**
+         * \brief Account for a constant, such as the right-hand side of a
+         * linear inequality.
+         */
+        auto add_constant(Integer value) -> void
+        {
+            add_magnitude(magnitude(value));
+        }
+
+        /**
+         * \brief Is the sum, and anything made from a few partial sums of it,
+         * certain never to overflow?
+         */
+        [[nodiscard]] auto proven() const -> bool
+        {
+            return ! _failed && _bound < (1ull << 61);
+        }
+    };
+}
+
+#endif
@@ -0,0 +1,51 @@
+#include <gcs/innards/overflow_proof.hh>
+
+#include <catch2/catch_test_macros.hpp>
+
+using namespace gcs;
+using namespace gcs::innards;
+
+TEST_CASE("OverflowProof accepts comfortably small sums")
+{
+    OverflowProof proof;
+    proof.add_constant(-1000_i);
+    for (int i = 0; i < 100; ++i)
+        proof.add_term(Integer{i - 50}, -100_i, 1000000_i);
+    CHECK(proof.proven());
+}
+
+TEST_CASE("OverflowProof rejects what could overflow")
+{
+    OverflowProof big_bound;
+    big_bound.add_term(1_i, Integer::min_value(), 0_i);
+    CHECK(! big_bound.proven());
+
+    OverflowProof big_product;
+    big_product.add_term(Integer{1ll << 32}, 0_i, Integer{1ll << 32});
+    CHECK(! big_product.proven());
+
+    OverflowProof many_terms;
+    for (int i = 0; i < 4; ++i)
+        many_terms.add_term(1_i, 0_i, Integer{1ll << 59});
+    CHECK(! many_terms.proven());
+
+    OverflowProof big_constant;
+    big_constant.add_constant(Integer::max_value());
+    big_constant.add_constant(Integer::max_value());
+    big_constant.add_constant(Integer::max_value());
+    CHECK(! big_constant.proven());
+}
+
+TEST_CASE("Checked and unchecked arithmetic agree where nothing overflows")
+{
+    for (auto a : {-7_i, 0_i, 12_i, 1000000007_i})
+        for (auto b : {-3_i, 1_i, 5_i}) {
+            CHECK(UncheckedArithmetic::add(a, b) == CheckedArithmetic::add(a, b));
+            CHECK(UncheckedArithmetic::sub(a, b) == CheckedArithmetic::sub(a, b));
+            CHECK(UncheckedArithmetic::mul(a, b) == CheckedArithmetic::mul(a, b));
+            CHECK(UncheckedArithmetic::div(a, b) == CheckedArithmetic::div(a, b));
+            CHECK(UncheckedArithmetic::neg(a) == CheckedArithmetic::neg(a));
+        }
+
+    CHECK_THROWS_AS(CheckedArithmetic::add(Integer::max_value(), 1_i), IntegerOverflow);
+}
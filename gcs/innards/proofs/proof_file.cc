@@ -0,0 +1,270 @@
+#include <gcs/innards/proofs/proof_error.hh>
+#include <gcs/innards/proofs/proof_file.hh>
+
+#include <algorithm>
+#include <cstddef>
+#include <fstream>
+#include <ios>
+#include <string>
+#include <vector>
+
+#ifdef GCS_HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+#ifdef GCS_HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+using namespace gcs;
+using namespace gcs::innards;
+
+using std::ios;
+using std::ios_base;
+using std::make_unique;
+using std::ofstream;
+using std::size_t;
+using std::string;
+using std::vector;
+
+namespace
+{
+    auto ends_with(const string & s, const string & suffix) -> bool
+    {
+        return s.size() >= suffix.size() && 0 == s.compare(s.size() - suffix.size(), suffix.size(), suffix);
+    }
+}
+
+auto gcs::innards::compression_for_file_name(const string & file_name) -> ProofCompression
+{
+    if (ends_with(file_name, ".gz"))
+        return ProofCompression::Gzip;
+    else if (ends_with(file_name, ".zst"))
+        return ProofCompression::Zstd;
+    else
+        return ProofCompression::None;
+}
+
+struct ProofFileSink::Imp
+{
+    ProofCompression compression;
+    bool open = false;
+
+    // Used directly when uncompressed, and as the compressor's output for zstd.
+    ofstream file;
+
+#ifdef GCS_HAVE_ZLIB
+    gzFile gz = nullptr;
+#endif
+
+#ifdef GCS_HAVE_ZSTD
+    ZSTD_CCtx * zstd = nullptr;
+    vector<char> zstd_output;
+    // Ending a frame with nothing in it would still write an empty frame.
+    bool zstd_frame_open = false;
+
+    // Feed the compressor, writing out whatever it produces, until it has
+    // consumed all the input and, for anything but ZSTD_e_continue, has
+    // nothing left to produce.
+    auto zstd_compress(const char * data, size_t size, ZSTD_EndDirective mode) -> bool
+    {
+        if (mode == ZSTD_e_continue)
+            zstd_frame_open = true;
+        else if (! zstd_frame_open)
+            return true;
+        else
+            zstd_frame_open = false;
+
+        ZSTD_inBuffer input{data, size, 0};
+        while (true) {
+            ZSTD_outBuffer output{zstd_output.data(), zstd_output.size(), 0};
+            auto remaining = ZSTD_compressStream2(zstd, &output, &input, mode);
+            if (ZSTD_isError(remaining))
+                return false;
+            if (! file.write(zstd_output.data(), static_cast<std::streamsize>(output.pos)))
+                return false;
+            if (mode == ZSTD_e_continue ? input.pos == input.size : 0 == remaining)
+                return true;
+        }
+    }
+#endif
+};
+
+ProofFileSink::ProofFileSink(const string & file_name) : _imp(make_unique<Imp>())
+{
+    _imp->compression = compression_for_file_name(file_name);
+    switch (_imp->compression) {
+    case ProofCompression::None:
+        _imp->file.open(file_name, ios::out);
+        if (! _imp->file)
+            throw ios_base::failure{"cannot open '" + file_name + "' for writing"};
+        break;
+
+    case ProofCompression::Gzip:
+#ifdef GCS_HAVE_ZLIB
+        // Level 1: a proof is very repetitive text, so even the fastest level
+        // shrinks it several times over, and anything slower would make the
+        // compressor rather than the disk the bottleneck.
+        _imp->gz = gzopen(file_name.c_str(), "wb1");
+        if (! _imp->gz)
+            throw ios_base::failure{"cannot open '" + file_name + "' for writing"};
+        gzbuffer(_imp->gz, 1024 * 1024);
+        break;
+#else
+        throw ProofError{"Cannot write '" + file_name + "': this build has no gzip support"};
+#endif
+
+    case ProofCompression::Zstd:
+#ifdef GCS_HAVE_ZSTD
+        _imp->file.open(file_name, ios::out | ios::binary);
+        if (! _imp->file)
+            throw ios_base::failure{"cannot open '" + file_name + "' for writing"};
+        _imp->zstd = ZSTD_createCCtx();
+        _imp->zstd_output.resize(ZSTD_CStreamOutSize());
+        break;
+#else
+        throw ProofError{"Cannot write '" + file_name + "': this build has no zstd support"};
+#endif
+    }
+    _imp->open = true;
+}
+
+ProofFileSink::~ProofFileSink()
+{
+    static_cast<void>(close());
+#ifdef GCS_HAVE_ZSTD
+    if (_imp->zstd)
+        ZSTD_freeCCtx(_imp->zstd);
+#endif
+}
+
+auto ProofFileSink::write(const char * data, size_t size) -> bool
+{
+    switch (_imp->compression) {
+    case ProofCompression::None:
+        return static_cast<bool>(_imp->file.write(data, static_cast<std::streamsize>(size)));
+
+    case ProofCompression::Gzip:
+#ifdef GCS_HAVE_ZLIB
+        // gzwrite takes an unsigned, so a very large write goes in pieces.
+        while (size > 0) {
+            auto piece = static_cast<unsigned>(std::min<size_t>(size, 1u << 30));
+            if (gzwrite(_imp->gz, data, piece) != static_cast<int>(piece))
+                return false;
+            data += piece;
+            size -= piece;
+        }
+        return true;
+#else
+        return false;
+#endif
+
+    case ProofCompression::Zstd:
+#ifdef GCS_HAVE_ZSTD
+        return _imp->zstd_compress(data, size, ZSTD_e_continue);
+#else
+        return false;
+#endif
+    }
+    return false;
+}
+
+auto ProofFileSink::flush() -> bool
+{
+    switch (_imp->compression) {
+    case ProofCompression::None:
+        return static_cast<bool>(_imp->file.flush());
+
+    case ProofCompression::Gzip:
+#ifdef GCS_HAVE_ZLIB
+        return Z_OK == gzflush(_imp->gz, Z_FINISH);
+#else
+        return false;
+#endif
+
+    case ProofCompression::Zstd:
+#ifdef GCS_HAVE_ZSTD
+        return _imp->zstd_compress(nullptr, 0, ZSTD_e_end) && _imp->file.flush();
+#else
+        return false;
+#endif
+    }
+    return false;
+}
+
+auto ProofFileSink::close() -> bool
+{
+    if (! _imp->open)
+        return true;
+    _imp->open = false;
+
+    switch (_imp->compression) {
+    case ProofCompression::None:
+        _imp->file.close();
+        return ! _imp->file.fail();
+
+    case ProofCompression::Gzip:
+#ifdef GCS_HAVE_ZLIB
+        return Z_OK == gzclose(_imp->gz);
+#else
+        return false;
+#endif
+
+    case ProofCompression::Zstd:
+#ifdef GCS_HAVE_ZSTD
+    {
+        bool ok = _imp->zstd_compress(nullptr, 0, ZSTD_e_end);
+        _imp->file.close();
+        return ok && ! _imp->file.fail();
+    }
+#else
+        return false;
+#endif
+    }
+    return false;
+}
+
+ProofFileBuffer::ProofFileBuffer(const string & file_name, size_t buffer_size) : _sink(file_name)
+{
+    _buffer.resize(buffer_size);
+    setp(_buffer.data(), _buffer.data() + _buffer.size());
+}
+
+ProofFileBuffer::~ProofFileBuffer()
+{
+    static_cast<void>(close());
+}
+
+auto ProofFileBuffer::write_out_buffer() -> bool
+{
+    auto used = static_cast<size_t>(pptr() - pbase());
+    if (! _failed && 0 != used && ! _sink.write(pbase(), used))
+        _failed = true;
+    setp(_buffer.data(), _buffer.data() + _buffer.size());
+    return ! _failed;
+}
+
+auto ProofFileBuffer::overflow(int_type ch) -> int_type
+{
+    if (! write_out_buffer())
+        return traits_type::eof();
+    if (traits_type::eq_int_type(ch, traits_type::eof()))
+        return traits_type::not_eof(ch);
+    *pptr() = traits_type::to_char_type(ch);
+    pbump(1);
+    return ch;
+}
+
+auto ProofFileBuffer::sync() -> int
+{
+    if (! write_out_buffer() || ! _sink.flush())
+        _failed = true;
+    return _failed ? -1 : 0;
+}
+
+auto ProofFileBuffer::close() -> bool
+{
+    if (! write_out_buffer() || ! _sink.close())
+        _failed = true;
+    return ! _failed;
+}
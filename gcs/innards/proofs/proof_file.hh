@@ -0,0 +1,129 @@
+#ifndef GLASGOW_CONSTRAINT_SOLVER_GUARD_GCS_INNARDS_PROOFS_PROOF_FILE_HH
+#define GLASGOW_CONSTRAINT_SOLVER_GUARD_GCS_INNARDS_PROOFS_PROOF_FILE_HH
+
+#include <gcs/proof.hh>
+
+#include <cstddef>
+#include <memory>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+namespace gcs::innards
+{
+    /**
+     * \brief Which compression, if any, a proof or OPB file name asks for:
+     * gzip for a name ending in `.gz`, zstd for one ending in `.zst`, and none
+     * otherwise.
+     *
+     * \ingroup Innards
+     */
+    [[nodiscard]] auto compression_for_file_name(const std::string &) -> ProofCompression;
+
+    /**
+     * \brief Where the bytes of a proof or OPB file end up: either the file
+     * itself, or a streaming compressor writing to it.
+     *
+     * Which is decided by compression_for_file_name(). Asking for a compressor
+     * that this build was not linked against throws a ProofError, rather than
+     * writing an uncompressed file under a compressed file's name.
+     *
+     * A sink does no buffering of its own, beyond what the compressor needs,
+     * so it wants large writes: see ProofFileBuffer and AsyncProofWriter.
+     * Write failures are reported by return value rather than by throwing,
+     * because a sink may be used from a background thread.
+     *
+     * \ingroup Innards
+     */
+    class ProofFileSink final
+    {
+    private:
+        struct Imp;
+        std::unique_ptr<Imp> _imp;
+
+    public:
+        /**
+         * \brief Open (truncating) the file.
+         *
+         * Throws std::ios_base::failure if the file cannot be opened, and
+         * ProofError if it asks for a compressor this build lacks.
+         */
+        explicit ProofFileSink(const std::string & file_name);
+
+        /**
+         * \brief Calls close(), ignoring failure.
+         */
+        ~ProofFileSink();
+
+        ProofFileSink(const ProofFileSink &) = delete;
+        auto operator=(const ProofFileSink &) -> ProofFileSink & = delete;
+
+        [[nodiscard]] auto write(const char * data, std::size_t size) -> bool;
+
+        /**
+         * \brief Make everything written so far readable from the file.
+         *
+         * For a compressed file this ends the current gzip member or zstd
+         * frame, and any later write starts a new one. A file of several
+         * members or frames decompresses to their concatenation, so this
+         * costs a little compression but nothing else.
+         */
+        [[nodiscard]] auto flush() -> bool;
+
+        /**
+         * \brief Finish the compressed stream, if there is one, and close the
+         * file. Does nothing if already closed.
+         */
+        [[nodiscard]] auto close() -> bool;
+    };
+
+    /**
+     * \brief A synchronous, buffered stream buffer over a ProofFileSink.
+     *
+     * This is the stream buffer to use for a proof or OPB file that is written
+     * on the thread producing it; AsyncProofWriter is the one that writes from
+     * a background thread. A proof is many short lines, so the buffer is large:
+     * the default stream buffer makes for a write syscall every few KB.
+     *
+     * \ingroup Innards
+     */
+    class ProofFileBuffer final : public std::streambuf
+    {
+    private:
+        ProofFileSink _sink;
+        std::vector<char> _buffer;
+        bool _failed = false;
+
+        auto write_out_buffer() -> bool;
+
+    protected:
+        auto overflow(int_type ch) -> int_type override;
+        auto sync() -> int override;
+
+    public:
+        /**
+         * \brief Open (truncating) the file.
+         *
+         * Throws std::ios_base::failure if the file cannot be opened, and
+         * ProofError if it asks for a compressor this build lacks.
+         */
+        explicit ProofFileBuffer(const std::string & file_name, std::size_t buffer_size = 1024 * 1024);
+
+        /**
+         * \brief Writes out anything buffered and closes the file, ignoring
+         * failure.
+         */
+        ~ProofFileBuffer() override;
+
+        ProofFileBuffer(const ProofFileBuffer &) = delete;
+        auto operator=(const ProofFileBuffer &) -> ProofFileBuffer & = delete;
+
+        /**
+         * \brief Write out anything buffered, and close the file, finishing the
+         * compressed stream if there is one.
+         */
+        [[nodiscard]] auto close() -> bool;
+    };
+}
+
+#endif
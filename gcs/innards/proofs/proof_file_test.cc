@@ -0,0 +1,202 @@
+#include <gcs/constraints/all_different.hh>
+#include <gcs/constraints/comparison.hh>
+#include <gcs/innards/proofs/proof_error.hh>
+#include <gcs/innards/proofs/proof_file.hh>
+#include <gcs/problem.hh>
+#include <gcs/proof.hh>
+#include <gcs/solve.hh>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#ifdef GCS_HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+#ifdef GCS_HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+using namespace gcs;
+using namespace gcs::innards;
+
+using std::flush;
+using std::ifstream;
+using std::ios;
+using std::istreambuf_iterator;
+using std::ostream;
+using std::pair;
+using std::remove;
+using std::string;
+using std::stringstream;
+using std::vector;
+
+namespace
+{
+    auto contents_of(const string & file_name) -> string
+    {
+        ifstream f{file_name, ios::binary};
+        return string{istreambuf_iterator<char>{f}, istreambuf_iterator<char>{}};
+    }
+
+    // Decompress every gzip member or zstd frame in the file, as zcat or
+    // zstdcat would.
+    auto decompressed_contents_of(const string & file_name) -> string
+    {
+        switch (compression_for_file_name(file_name)) {
+        case ProofCompression::None:
+            return contents_of(file_name);
+
+        case ProofCompression::Gzip: {
+#ifdef GCS_HAVE_ZLIB
+            string result;
+            auto gz = gzopen(file_name.c_str(), "rb");
+            REQUIRE(gz);
+            vector<char> buffer(64 * 1024);
+            int n;
+            while ((n = gzread(gz, buffer.data(), static_cast<unsigned>(buffer.size()))) > 0)
+                result.append(buffer.data(), n);
+            REQUIRE(n == 0);
+            gzclose(gz);
+            return result;
+#else
+            FAIL("no zlib");
+            return "";
+#endif
+        }
+
+        case ProofCompression::Zstd: {
+#ifdef GCS_HAVE_ZSTD
+            auto compressed = contents_of(file_name);
+            string result;
+            auto * dctx = ZSTD_createDCtx();
+            vector<char> buffer(ZSTD_DStreamOutSize());
+            ZSTD_inBuffer input{compressed.data(), compressed.size(), 0};
+            while (input.pos < input.size) {
+                ZSTD_outBuffer output{buffer.data(), buffer.size(), 0};
+                auto r = ZSTD_decompressStream(dctx, &output, &input);
+                REQUIRE(! ZSTD_isError(r));
+                result.append(buffer.data(), output.pos);
+            }
+            ZSTD_freeDCtx(dctx);
+            return result;
+#else
+            FAIL("no zstd");
+            return "";
+#endif
+        }
+        }
+        return "";
+    }
+
+    auto supported(ProofCompression compression) -> bool
+    {
+        switch (compression) {
+        case ProofCompression::None: return true;
+#ifdef GCS_HAVE_ZLIB
+        case ProofCompression::Gzip: return true;
+#endif
+#ifdef GCS_HAVE_ZSTD
+        case ProofCompression::Zstd: return true;
+#endif
+        default: return false;
+        }
+    }
+
+    auto write_lines(ostream & out, stringstream & expected, int from, int to) -> void
+    {
+        for (int i = from; i < to; ++i) {
+            out << "rup 1 x" << i << " >= 1 ;\n";
+            expected << "rup 1 x" << i << " >= 1 ;\n";
+        }
+    }
+}
+
+TEST_CASE("Compression is chosen by file name")
+{
+    CHECK(compression_for_file_name("x.pbp") == ProofCompression::None);
+    CHECK(compression_for_file_name("x.pbp.gz") == ProofCompression::Gzip);
+    CHECK(compression_for_file_name("x.opb.zst") == ProofCompression::Zstd);
+    CHECK(compression_for_file_name("x.gzip") == ProofCompression::None);
+}
+
+TEST_CASE("ProofOptions::set_compression renames the OPB and proof files")
+{
+    ProofOptions options{"x"};
+    options.set_compression(ProofCompression::Gzip);
+    CHECK(options.proof_file_names.opb_file == "x.opb.gz");
+    CHECK(options.proof_file_names.proof_file == "x.pbp.gz");
+    CHECK(options.proof_file_names.variables_map_file == "x.varmap");
+
+    options.set_compression(ProofCompression::Zstd);
+    CHECK(options.proof_file_names.proof_file == "x.pbp.zst");
+
+    options.set_compression(ProofCompression::None);
+    CHECK(options.proof_file_names.proof_file == "x.pbp");
+}
+
+TEST_CASE("ProofFileBuffer round trips")
+{
+    for (auto [compression, suffix] : {pair{ProofCompression::None, ""}, pair{ProofCompression::Gzip, ".gz"},
+             pair{ProofCompression::Zstd, ".zst"}}) {
+        const string file_name = string{"proof_file_test_round_trip.pbp"} + suffix;
+        if (! supported(compression)) {
+            CHECK_THROWS_AS(ProofFileBuffer{file_name}, ProofError);
+            continue;
+        }
+
+        stringstream expected;
+        {
+            ProofFileBuffer buffer{file_name, 100};
+            ostream out{&buffer};
+            write_lines(out, expected, 0, 1000);
+
+            // A flush part way through must leave everything so far readable,
+            // and must not stop what follows being read too.
+            out << flush;
+            CHECK(decompressed_contents_of(file_name) == expected.str());
+            write_lines(out, expected, 1000, 20000);
+            CHECK(buffer.close());
+        }
+        CHECK(decompressed_contents_of(file_name) == expected.str());
+        remove(file_name.c_str());
+    }
+}
+
+TEST_CASE("Compressed and uncompressed proofs decompress the same")
+{
+    auto solve_writing = [](const string & name, ProofCompression compression, bool asynchronous) {
+        Problem p;
+        auto vs = p.create_integer_variable_vector(6, 0_i, 4_i);
+        p.post(AllDifferent{vs});
+        for (unsigned i = 0; i + 1 < vs.size(); ++i)
+            p.post(LessThan{vs[i], vs[i + 1]});
+        auto options = ProofOptions{name}.set_compression(compression).set_asynchronous_writer(asynchronous);
+        solve(p, [&](const CurrentState &) -> bool { return true; }, options);
+        auto result = pair{decompressed_contents_of(options.proof_file_names.opb_file),
+            decompressed_contents_of(options.proof_file_names.proof_file)};
+        for (const auto & file : {options.proof_file_names.opb_file, options.proof_file_names.proof_file,
+                 *options.proof_file_names.variables_map_file, *options.proof_file_names.s_expr_file})
+            remove(file.c_str());
+        return result;
+    };
+
+    auto plain = solve_writing("proof_file_test_plain", ProofCompression::None, false);
+    CHECK(plain.second.find("end pseudo-Boolean proof;") != string::npos);
+
+    for (auto compression : {ProofCompression::Gzip, ProofCompression::Zstd}) {
+        if (! supported(compression))
+            continue;
+        for (bool asynchronous : {false, true}) {
+            auto compressed = solve_writing("proof_file_test_compressed", compression, asynchronous);
+            CHECK(compressed == plain);
+        }
+    }
+}
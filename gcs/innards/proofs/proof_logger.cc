@@ -7,9 +7,11 @@
 #include <gcs/innards/proofs/names_and_ids_tracker.hh>
 #include <gcs/innards/proofs/pol_builder.hh>
 #include <gcs/innards/proofs/proof_error.hh>
+#include <gcs/innards/proofs/proof_file.hh>
 #include <gcs/innards/proofs/proof_logger-fwd.hh>
 #include <gcs/innards/proofs/proof_logger.hh>
 #include <gcs/innards/proofs/proof_model.hh>
+#include <gcs/innards/proofs/proof_writer.hh>
 #include <gcs/innards/proofs/pseudo_boolean.hh>
 #include <gcs/innards/proofs/simplify_literal.hh>
 #include <gcs/innards/state.hh>
@@ -19,7 +21,6 @@
 #include <cstddef>
 #include <cstdlib>
 #include <deque>
-#include <fstream>
 #include <optional>
 #include <sstream>
 
@@ -42,7 +43,6 @@ using fmt::format;
 using std::cmp_less_equal;
 using std::deque;
 using std::flush;
-using std::fstream;
 using std::ios;
 using std::ios_base;
 using std::make_unique;
@@ -53,6 +53,7 @@ using std::pair;
 using std::string;
 using std::stringstream;
 using std::tuple;
+using std::unique_ptr;
 using std::variant;
 using std::vector;
 using std::visit;
@@ -178,11 +179,12 @@ struct ProofLogger::Imp
     deque<IntervalSet<long long>> proof_lines_by_level;
 
     string proof_file;
-    fstream proof;
-    // A proof is many short lines; the default stream buffer makes for a
-    // write syscall every few KB, which shows up at this volume. Installed
-    // via pubsetbuf before open in start_proof.
-    vector<char> proof_stream_buffer;
+    bool asynchronous_writer;
+    // Exactly one of these is installed under proof in start_proof. Both are
+    // declared before proof, so that proof is gone before its buffer is.
+    unique_ptr<ProofFileBuffer> proof_file_buffer;
+    unique_ptr<AsyncProofWriter> proof_writer;
+    ostream proof{nullptr};
     int current_indent = 0;
     AssertionLevel assertion_level;
 
@@ -218,6 +220,7 @@ ProofLogger::ProofLogger(const ProofOptions & proof_options, NamesAndIDsTracker
     _imp->proof_file = proof_options.proof_file_names.proof_file;
     _imp->proof_lines_by_level.resize(2);
     _imp->assertion_level = proof_options.assertion_level;
+    _imp->asynchronous_writer = proof_options.asynchronous_writer;
 }
 
 ProofLogger::~ProofLogger() = default;
@@ -348,12 +351,19 @@ auto ProofLogger::emit_learned_nogood(const vector<Literal> & decisions) -> Proo
     return emit_rup_proof_line(move(clause) >= 1_i, ProofLevel::Top);
 }
 
+auto ProofLogger::objective_lower_bound(IntegerVariableID minimise_variable, Integer lower) -> void
+{
+    _imp->proof << "% objective lower bound\n";
+    emit_rup_proof_line(WPBSum{} + 1_i * minimise_variable >= lower, ProofLevel::Top);
+}
+
 auto ProofLogger::end_proof() -> void
 {
     _imp->proof << "end pseudo-Boolean proof;\n";
 
     // this is mostly for tests: we haven't necessarily destroyed the
-    // Problem before running the verifier.
+    // Problem before running the verifier. With the asynchronous writer, this
+    // also waits for the background thread to catch up.
     _imp->proof << flush;
 }
 
@@ -682,10 +692,16 @@ auto ProofLogger::forget_proof_level(int depth) -> void
 auto ProofLogger::start_proof(const ProofModel & model) -> void
 {
     try {
+        if (_imp->asynchronous_writer) {
+            _imp->proof_writer = make_unique<AsyncProofWriter>(_imp->proof_file);
+            _imp->proof.rdbuf(_imp->proof_writer.get());
+        }
+        else {
+            _imp->proof_file_buffer = make_unique<ProofFileBuffer>(_imp->proof_file);
+            _imp->proof.rdbuf(_imp->proof_file_buffer.get());
+        }
+        // rdbuf() clears the stream's state, so only now ask for exceptions.
         _imp->proof.exceptions(ios::failbit | ios::badbit);
-        _imp->proof_stream_buffer.resize(1024 * 1024);
-        _imp->proof.rdbuf()->pubsetbuf(_imp->proof_stream_buffer.data(), _imp->proof_stream_buffer.size());
-        _imp->proof.open(_imp->proof_file, ios::out);
         _imp->proof << "pseudo-Boolean proof version 3.0\n";
         // No `f` rule: VeriPB 3.0 loads the formula implicitly, and omitting the
         // explicit count means cake_pb_cp's re-derived OPB is allowed to have a
@@ -104,6 +104,13 @@ namespace gcs::innards
          */
         auto emit_learned_nogood(const std::vector<Literal> & decisions) -> ProofLine;
 
+        /**
+         * Log that the variable being minimised has been proved to be at least
+         * lower, as a persistent (ProofLevel::Top) RUP line, so that the bound
+         * stays in the proof however search goes on from here.
+         */
+        auto objective_lower_bound(IntegerVariableID minimise_variable, Integer lower) -> void;
+
         /**
          * Log that we have reached an unsatisfiable conclusion at the end of the proof.
          */
@@ -4,6 +4,7 @@
 #include <gcs/innards/proofs/emit_inequality_to.hh>
 #include <gcs/innards/proofs/names_and_ids_tracker.hh>
 #include <gcs/innards/proofs/proof_error.hh>
+#include <gcs/innards/proofs/proof_file.hh>
 #include <gcs/innards/proofs/proof_logger.hh>
 #include <gcs/innards/proofs/proof_model.hh>
 #include <gcs/innards/proofs/proof_only_variables.hh>
@@ -13,8 +14,9 @@
 #include <algorithm>
 #include <cstdlib>
 #include <exception>
-#include <fstream>
 #include <map>
+#include <memory>
+#include <ostream>
 #include <set>
 
 #include <version>
@@ -36,11 +38,12 @@ using std::ios_base;
 using std::make_unique;
 using std::map;
 using std::nullopt;
-using std::ofstream;
 using std::optional;
+using std::ostream;
 using std::pair;
 using std::set;
 using std::string;
+using std::unique_ptr;
 using std::variant;
 using std::vector;
 using std::ranges::sort;
@@ -82,7 +85,9 @@ struct ProofModel::Imp
     // everything emitted so far (the variable set-up rows); afterwards each
     // emitting method sends it straight on to the file.
     string opb;
-    ofstream opb_stream;
+    // Opened by write_preamble(); a name ending in .gz or .zst is compressed.
+    unique_ptr<ProofFileBuffer> opb_buffer;
+    ostream opb_stream{nullptr};
     bool streaming = false;
 
     bool always_use_full_encoding = false;
@@ -736,8 +741,9 @@ auto ProofModel::write_preamble() -> void
         }
 
     try {
+        _imp->opb_buffer = make_unique<ProofFileBuffer>(_imp->opb_file);
+        _imp->opb_stream.rdbuf(_imp->opb_buffer.get());
         _imp->opb_stream.exceptions(ios::failbit | ios::badbit);
-        _imp->opb_stream.open(_imp->opb_file, ios::out);
         // No `* #variable= .. #constraint= ..` counts comment: VeriPB 3 does
         // not need it, and not writing it is what lets everything stream out
         // as it is produced instead of being buffered until the counts are
@@ -820,8 +826,8 @@ auto ProofModel::finalise() -> void
     else
         write_out_pending();
     try {
-        _imp->opb_stream << std::flush;
-        _imp->opb_stream.close();
+        if (! _imp->opb_buffer->close())
+            throw ios_base::failure{"cannot close opb file"};
     }
     catch (const ios_base::failure &) {
         throw ProofError{"Error writing opb file to '" + _imp->opb_file + "'"};
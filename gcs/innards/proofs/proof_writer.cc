@@ -0,0 +1,161 @@
+#include <gcs/innards/proofs/proof_file.hh>
+#include <gcs/innards/proofs/proof_writer.hh>
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+using namespace gcs;
+using namespace gcs::innards;
+
+using std::condition_variable;
+using std::deque;
+using std::make_unique;
+using std::mutex;
+using std::size_t;
+using std::string;
+using std::thread;
+using std::unique_lock;
+using std::vector;
+
+struct AsyncProofWriter::Imp
+{
+    // Only the writer thread touches this while it runs, apart from sync(),
+    // which only does so once the writer is idle.
+    ProofFileSink sink;
+    size_t chunk_size;
+    size_t max_queued_chunks;
+
+    // The chunk the stream is rendering into. Only the search thread touches
+    // it, so it lives outside the lock.
+    vector<char> current;
+
+    mutex lock;
+    condition_variable chunk_queued, chunk_written;
+    deque<vector<char>> queued;
+    vector<vector<char>> spare;
+    bool writing = false;
+    bool stopping = false;
+    bool failed = false;
+    unsigned long long stalls = 0;
+
+    thread writer;
+
+    explicit Imp(const string & file_name) : sink(file_name)
+    {
+    }
+
+    auto write_queued_chunks() -> void
+    {
+        unique_lock guard{lock};
+        while (true) {
+            chunk_queued.wait(guard, [&] { return stopping || ! queued.empty(); });
+            if (queued.empty())
+                return;
+
+            auto chunk = std::move(queued.front());
+            queued.pop_front();
+            writing = true;
+            bool skip = failed;
+            guard.unlock();
+
+            // After a failure there is no sense in writing the rest: the
+            // producer has been told, and the file is incomplete anyway. For a
+            // compressed file, this is also where the compressing happens.
+            bool ok = skip || sink.write(chunk.data(), chunk.size());
+
+            guard.lock();
+            writing = false;
+            if (! ok)
+                failed = true;
+            chunk.clear();
+            spare.push_back(std::move(chunk));
+            chunk_written.notify_all();
+        }
+    }
+};
+
+AsyncProofWriter::AsyncProofWriter(const string & file_name, size_t chunk_size, size_t max_queued_chunks) :
+    _imp(make_unique<Imp>(file_name))
+{
+    _imp->chunk_size = chunk_size;
+    _imp->max_queued_chunks = max_queued_chunks;
+    _imp->current.resize(chunk_size);
+    setp(_imp->current.data(), _imp->current.data() + _imp->current.size());
+
+    _imp->writer = thread{[imp = _imp.get()] { imp->write_queued_chunks(); }};
+}
+
+AsyncProofWriter::~AsyncProofWriter()
+{
+    hand_off_current_chunk();
+    {
+        unique_lock guard{_imp->lock};
+        _imp->stopping = true;
+    }
+    _imp->chunk_queued.notify_all();
+    _imp->writer.join();
+    static_cast<void>(_imp->sink.close());
+}
+
+auto AsyncProofWriter::hand_off_current_chunk() -> bool
+{
+    auto used = static_cast<size_t>(pptr() - pbase());
+    unique_lock guard{_imp->lock};
+    if (0 != used) {
+        if (_imp->queued.size() >= _imp->max_queued_chunks) {
+            ++_imp->stalls;
+            _imp->chunk_written.wait(guard, [&] { return _imp->queued.size() < _imp->max_queued_chunks; });
+        }
+
+        _imp->current.resize(used);
+        _imp->queued.push_back(std::move(_imp->current));
+        _imp->chunk_queued.notify_one();
+
+        if (_imp->spare.empty())
+            _imp->current = vector<char>{};
+        else {
+            _imp->current = std::move(_imp->spare.back());
+            _imp->spare.pop_back();
+        }
+        _imp->current.resize(_imp->chunk_size);
+        setp(_imp->current.data(), _imp->current.data() + _imp->current.size());
+    }
+    return ! _imp->failed;
+}
+
+auto AsyncProofWriter::overflow(int_type ch) -> int_type
+{
+    if (! hand_off_current_chunk())
+        return traits_type::eof();
+    if (traits_type::eq_int_type(ch, traits_type::eof()))
+        return traits_type::not_eof(ch);
+    *pptr() = traits_type::to_char_type(ch);
+    pbump(1);
+    return ch;
+}
+
+auto AsyncProofWriter::sync() -> int
+{
+    if (! hand_off_current_chunk())
+        return -1;
+
+    // Once the queue is empty and the writer idle, the writer cannot touch the
+    // file again without taking the lock, so it is safe to flush it here.
+    unique_lock guard{_imp->lock};
+    _imp->chunk_written.wait(guard, [&] { return _imp->queued.empty() && ! _imp->writing; });
+    if (! _imp->failed && ! _imp->sink.flush())
+        _imp->failed = true;
+    return _imp->failed ? -1 : 0;
+}
+
+auto AsyncProofWriter::stalls() const -> unsigned long long
+{
+    unique_lock guard{_imp->lock};
+    return _imp->stalls;
+}
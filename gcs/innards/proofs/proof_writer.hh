@@ -0,0 +1,76 @@
+#ifndef GLASGOW_CONSTRAINT_SOLVER_GUARD_GCS_INNARDS_PROOFS_PROOF_WRITER_HH
+#define GLASGOW_CONSTRAINT_SOLVER_GUARD_GCS_INNARDS_PROOFS_PROOF_WRITER_HH
+
+#include <cstddef>
+#include <memory>
+#include <streambuf>
+#include <string>
+
+namespace gcs::innards
+{
+    /**
+     * \brief A stream buffer that writes a proof file from a background
+     * thread.
+     *
+     * The ProofLogger still renders every line on the search thread, into this
+     * buffer's current chunk, but it never waits on a write: a full chunk is
+     * handed to a queue, and the background thread writes it out while search
+     * carries on into the next one. Chunks are recycled, and at most a fixed
+     * number are queued at once. A search that renders proof faster than the
+     * disk takes it therefore blocks when the queue is full, rather than
+     * holding the whole proof in memory.
+     *
+     * Flushing the stream (pubsync) hands over the partial chunk and waits
+     * until everything written so far is in the file. ProofLogger::end_proof
+     * does this, so that a verifier started afterwards reads the whole proof.
+     * Destruction does the same, silently.
+     *
+     * The file is written through a ProofFileSink, so a file name ending in
+     * `.gz` or `.zst` is compressed, and the compressing is done by the
+     * background thread too.
+     *
+     * If a write fails, the writer stops writing, and the next chunk hand-off
+     * or flush reports failure to the stream, which then throws as it would
+     * for a failed write to an ordinary file.
+     *
+     * \ingroup Innards
+     */
+    class AsyncProofWriter final : public std::streambuf
+    {
+    private:
+        struct Imp;
+        std::unique_ptr<Imp> _imp;
+
+        auto hand_off_current_chunk() -> bool;
+
+    protected:
+        auto overflow(int_type ch) -> int_type override;
+        auto sync() -> int override;
+
+    public:
+        /**
+         * \brief Open (truncating) the file, and start the writer thread.
+         *
+         * Throws std::ios_base::failure if the file cannot be opened, and
+         * ProofError if it asks for a compressor this build lacks.
+         *
+         * \param chunk_size how many bytes are rendered before a hand-off.
+         * \param max_queued_chunks how many full chunks may wait for the
+         * writer before rendering blocks.
+         */
+        explicit AsyncProofWriter(const std::string & file_name, std::size_t chunk_size = 1024 * 1024, std::size_t max_queued_chunks = 8);
+
+        ~AsyncProofWriter() override;
+
+        AsyncProofWriter(const AsyncProofWriter &) = delete;
+        auto operator=(const AsyncProofWriter &) -> AsyncProofWriter & = delete;
+
+        /**
+         * \brief How many times rendering had to wait for the writer because
+         * the queue was full.
+         */
+        [[nodiscard]] auto stalls() const -> unsigned long long;
+    };
+}
+
+#endif
@@ -0,0 +1,110 @@
+#include <gcs/constraints/all_different.hh>
+#include <gcs/constraints/comparison.hh>
+#include <gcs/innards/proofs/proof_writer.hh>
+#include <gcs/problem.hh>
+#include <gcs/proof.hh>
+#include <gcs/solve.hh>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <cstdio>
+#include <fstream>
+#include <ios>
+#include <iterator>
+#include <ostream>
+#include <sstream>
+#include <string>
+
+using namespace gcs;
+using namespace gcs::innards;
+
+using std::flush;
+using std::ifstream;
+using std::ios_base;
+using std::istreambuf_iterator;
+using std::ostream;
+using std::remove;
+using std::string;
+using std::stringstream;
+
+namespace
+{
+    auto contents_of(const string & file_name) -> string
+    {
+        ifstream f{file_name};
+        return string{istreambuf_iterator<char>{f}, istreambuf_iterator<char>{}};
+    }
+
+    auto write_lines(ostream & out, stringstream & expected, int from, int to) -> void
+    {
+        for (int i = from; i < to; ++i) {
+            out << "rup 1 x" << i << " >= 1 ;\n";
+            expected << "rup 1 x" << i << " >= 1 ;\n";
+        }
+    }
+}
+
+TEST_CASE("AsyncProofWriter: flush writes everything so far")
+{
+    const string file_name = "proof_writer_test_flush.pbp";
+    stringstream expected;
+    {
+        AsyncProofWriter writer{file_name, 64, 2};
+        ostream out{&writer};
+
+        write_lines(out, expected, 0, 10);
+        out << flush;
+        CHECK(out.good());
+        CHECK(contents_of(file_name) == expected.str());
+
+        write_lines(out, expected, 10, 20);
+        out << flush;
+        CHECK(contents_of(file_name) == expected.str());
+    }
+    remove(file_name.c_str());
+}
+
+TEST_CASE("AsyncProofWriter: many chunks through a short queue")
+{
+    const string file_name = "proof_writer_test_many_chunks.pbp";
+    stringstream expected;
+    {
+        // Tiny chunks and a queue of one, so that rendering keeps having to
+        // wait for the writer and every chunk is recycled many times.
+        AsyncProofWriter writer{file_name, 16, 1};
+        ostream out{&writer};
+        write_lines(out, expected, 0, 20000);
+        out << string(100, 'x') << '\n';
+        expected << string(100, 'x') << '\n';
+    }
+
+    // Destruction drains the queue too.
+    CHECK(contents_of(file_name) == expected.str());
+    remove(file_name.c_str());
+}
+
+TEST_CASE("AsyncProofWriter: unopenable file")
+{
+    CHECK_THROWS_AS(AsyncProofWriter{"proof_writer_test_no_such_directory/x.pbp"}, ios_base::failure);
+}
+
+TEST_CASE("Asynchronous and synchronous proof writers produce the same proof")
+{
+    auto solve_writing = [](const string & name, bool asynchronous) {
+        Problem p;
+        auto vs = p.create_integer_variable_vector(6, 0_i, 4_i);
+        p.post(AllDifferent{vs});
+        for (unsigned i = 0; i + 1 < vs.size(); ++i)
+            p.post(LessThan{vs[i], vs[i + 1]});
+        solve(p, [&](const CurrentState &) -> bool { return true; }, ProofOptions{name}.set_asynchronous_writer(asynchronous));
+        auto result = contents_of(name + ".pbp");
+        for (const auto * suffix : {".opb", ".pbp", ".varmap", ".scp"})
+            remove((name + suffix).c_str());
+        return result;
+    };
+
+    auto sync = solve_writing("proof_writer_test_sync", false);
+    auto async = solve_writing("proof_writer_test_async", true);
+    CHECK(sync.find("end pseudo-Boolean proof;") != string::npos);
+    CHECK(sync == async);
+}
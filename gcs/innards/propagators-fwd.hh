@@ -60,6 +60,7 @@ namespace gcs::innards
         DisableUntilBacktrack
     };
 
+    class DomainDelta;
     class Propagators;
 }
 
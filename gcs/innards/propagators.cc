@@ -1,5 +1,6 @@
 #include <gcs/exception.hh>
 #include <gcs/innards/conflict_observer.hh>
+#include <gcs/innards/domain_change_observer.hh>
 #include <gcs/innards/inference_tracker.hh>
 #include <gcs/innards/proofs/hints.hh>
 #include <gcs/innards/proofs/names_and_ids_tracker.hh>
@@ -12,10 +13,13 @@
 
 #include <algorithm>
 #include <array>
+#include <bit>
+#include <chrono>
 #include <cstddef>
 #include <cstdint>
 #include <cstdlib>
 #include <functional>
+#include <limits>
 #include <optional>
 #include <span>
 #include <string>
@@ -26,6 +30,7 @@ using namespace gcs;
 using namespace gcs::innards;
 
 using std::atomic;
+using std::chrono::steady_clock;
 using std::make_unique;
 using std::move;
 using std::optional;
@@ -46,12 +51,19 @@ namespace
         vector<pair<int, int>> ids_and_masks;
     };
 
+    // The Inference masks for each kind of coarse trigger.
+    constexpr int on_instantiated_mask = 1 << to_underlying(Inference::Instantiated);
+    constexpr int on_bounds_mask = (1 << to_underlying(Inference::BoundsChanged)) | on_instantiated_mask;
+    constexpr int on_change_mask = (1 << to_underlying(Inference::InteriorValuesChanged)) | on_bounds_mask;
+
     // The GCS_CHECK_IDEMPOTENT_CLAIMS re-run: the claim says an immediate
     // re-run, against the domains exactly as the claiming run left them,
     // infers nothing and does not contradict. Check exactly that; a passing
     // re-run emits nothing, so proofs are unaffected. The re-run's own
     // PropagatorState is meaningless (the claim covered the first run) and is
-    // discarded. Out of line and noinline so its exception-handling region
+    // discarded. The re-run is told that everything changed, so that a
+    // propagator using a DomainDelta is checked against its whole scope. Out
+    // of line and noinline so its exception-handling region
     // stays out of the propagation loop, whose per-run cost is measurable in
     // whole-program benchmarks.
     template <typename Tracker_>
@@ -61,7 +73,7 @@ namespace
         const auto inferences_before_recheck = tracker.count_inferences();
         tracker.begin_propagator_run();
         try {
-            (void)f(state, tracker, logger, watches);
+            (void)f(state, tracker, logger, watches, DomainDelta{});
         }
         catch (const TrackedPropagationFailed &) {
         }
@@ -182,6 +194,20 @@ struct Propagators::Imp : RefinedWatchSink
     // requeue.
     vector<int> queue, lookup;
     int enqueued_begin = 0, enqueued_end = 0, idle_end = 0;
+
+    // Ordering by PropagatorCost. A woken propagator whose cost is in use is
+    // not made ready straight away: it is flagged in pending and appended to
+    // pending_by_cost for its cost, staying where it is in the idle region,
+    // and each time the ready region drains only the cheapest nonempty cost's
+    // pending list is moved into it, oldest-first. So a dearer propagator runs
+    // only once everything cheaper is at a fixpoint. Skipped entirely, and the
+    // queue is the plain FIFO above, unless order_by_cost is set and more than
+    // one bit of costs_in_use is.
+    vector<uint8_t> cost_of_propagator;
+    unsigned costs_in_use = 0;
+    bool order_by_cost = true;
+    vector<uint8_t> pending;
+    std::array<vector<int>, number_of_propagator_costs> pending_by_cost;
     // Reused scratch for the disable-until-backtrack propagators of the current round
     // (see the run loop); a member so it isn't reallocated on every propagate() call.
     vector<int> to_disable;
@@ -227,7 +253,43 @@ struct Propagators::Imp : RefinedWatchSink
     // block.
     vector<uint8_t> claim_protected;
 
+    // Each run's inferences, folded as the run ends into one entry per
+    // variable holding the Inference bits of every change the run made to it,
+    // in the order the variables were first changed. The round-boundary
+    // replay requeues from these rather than from each inference, so a run
+    // that narrows a variable ten times scans its triggers and refined watches
+    // once. A batch keeps the tracker index of its run's first inference,
+    // which is all the claim bookkeeping needs: claims are made by whole runs,
+    // so each one ends either before all of a run's inferences or after all of
+    // them. Cleared at every round boundary, and at propagate() entry.
+    struct BatchedEvents
+    {
+        SimpleIntegerVariableID var;
+        int events;
+        std::size_t first_inference_index;
+    };
+    vector<BatchedEvents> batched_events;
+
+    // Scratch for batch_run_events, indexed by variable: the events seen so
+    // far in the run being folded. All zeroes between runs.
+    vector<uint8_t> events_of_var;
+
     unsigned long long total_propagations = 0, effectful_propagations = 0, contradicting_propagations = 0;
+
+    // Per-propagator counters for a PropagationProfile, indexed by propagator
+    // id. Empty, and never touched, unless enable_profiling() was called: the
+    // run loop tests profiling once per call and does nothing else otherwise.
+    // constraint_types is filled in by note_constraint_type, keyed by
+    // ConstraintID because that is called before the constraint's propagators
+    // (and so its dense index) exist.
+    struct ProfileCounters
+    {
+        unsigned long long calls = 0, effectful_calls = 0, inferences = 0, contradictions = 0, idempotence_claims = 0;
+        steady_clock::duration time{0};
+    };
+    bool profiling = false;
+    vector<ProfileCounters> profile_by_propagator;
+    std::unordered_map<ConstraintID, string> constraint_types;
     vector<TriggerIDs> iv_triggers;
     vector<long> degrees;
 
@@ -258,6 +320,10 @@ struct Propagators::Imp : RefinedWatchSink
     // to see every conflict. Empty when there are no observers.
     vector<ConflictObserver *> conflict_observers;
 
+    // Borrowed domain change observers, told of every guess and of each
+    // batch of events below as it is made. Empty when there are none.
+    vector<DomainChangeObserver *> domain_change_observers;
+
     // Refined per-literal watches, parallel to (and leaving untouched) iv_triggers.
     // refined_watches_by_var[v] are the watches currently armed on variable v; on a
     // change to v each is tested and, if its literal is now entailed, its payload is
@@ -289,6 +355,145 @@ struct Propagators::Imp : RefinedWatchSink
     vector<vector<std::uint64_t>> watch_state_by_propagator;
     vector<WatchStateEdit> watch_state_trail;
 
+    // Domain deltas, for propagators whose function accepts a DomainDelta.
+    // delta_positions_by_var[v] says which positions of which such propagators
+    // v appears in, with the same Inference mask as the position's trigger.
+    // Changes are recorded against each position as soon as the run that made
+    // them ends (and for each guess), not at the round boundary, so that a
+    // propagator run later in the same round, or one whose idempotence claim
+    // keeps it from being woken, still hears about them. Each DomainDeltaState
+    // holds the positions changed since the propagator last ran, and the
+    // bounds each position had when it was last handed over; those snapshots
+    // are trailed on delta_snapshot_trail and restored by the same
+    // per-propagate() backtrack callback as the watch edits. A position that
+    // was already pending when the propagate() call that handed it over began
+    // is put back pending with its events when that call is backtracked off,
+    // because what it was told about happened before the branch, and so still
+    // stands. Changes still pending after a backtrack are kept. Both can only
+    // over-report.
+    struct DeltaPosition
+    {
+        int delta_index;
+        std::uint32_t position;
+    };
+    struct DomainDeltaState
+    {
+        vector<IntegerVariableID> vars;
+        vector<pair<Integer, Integer>> snapshot;
+        vector<uint8_t> pending_mask;
+        vector<unsigned long long> pending_since;
+        vector<std::uint32_t> pending;
+        vector<DomainDeltaEntry> handed_over;
+        bool everything_changed = true;
+        unsigned long long backtracks_when_last_run = 0;
+    };
+    struct DeltaSnapshotEdit
+    {
+        int delta_index;
+        std::uint32_t position;
+        pair<Integer, Integer> old_bounds;
+        uint8_t events;
+        unsigned long long pending_since;
+    };
+    vector<vector<DeltaPosition>> delta_positions_by_var;
+    vector<DomainDeltaState> domain_deltas;
+    vector<int> domain_delta_of_propagator;
+    vector<DeltaSnapshotEdit> delta_snapshot_trail;
+    static constexpr std::uint32_t everything_changed_position = std::numeric_limits<std::uint32_t>::max();
+    unsigned long long backtracks = 0;
+    unsigned long long propagations = 0;
+
+    auto add_delta_position(int delta_index, std::uint32_t position, const IntegerVariableID & var) -> void
+    {
+        domain_deltas[delta_index].vars.push_back(var);
+        if (auto var_index = underlying_var_index(var)) {
+            if (delta_positions_by_var.size() <= *var_index)
+                delta_positions_by_var.resize(*var_index + 1);
+            delta_positions_by_var[*var_index].push_back({delta_index, position});
+        }
+    }
+
+    // Every event is recorded, whatever the position's trigger would wake for:
+    // an on_bounds position that loses an interior value is not woken, but it
+    // has still changed, and must not then be reported as bounds only.
+    auto record_delta(const SimpleIntegerVariableID & v, const int events) -> void
+    {
+        if (v.index >= delta_positions_by_var.size())
+            return;
+        for (const auto & [delta_index, position] : delta_positions_by_var[v.index]) {
+            auto & delta = domain_deltas[delta_index];
+            if (0 == delta.pending_mask[position]) {
+                delta.pending.push_back(position);
+                delta.pending_since[position] = propagations;
+            }
+            delta.pending_mask[position] |= events;
+        }
+    }
+
+    // Fold the inferences [begin, end) that one run made into batched_events,
+    // and record them for domain deltas.
+    auto batch_run_events(const auto & tracker, std::size_t begin, std::size_t end) -> void
+    {
+        auto batch_begin = batched_events.size();
+        for (auto i = begin; i != end; ++i) {
+            auto [v, inf] = tracker.inference_at(i);
+            if (events_of_var.size() <= v.index)
+                events_of_var.resize(v.index + 1, 0);
+            if (0 == events_of_var[v.index])
+                batched_events.push_back({v, 0, begin});
+            events_of_var[v.index] |= 1 << to_underlying(inf);
+        }
+
+        for (auto b = batch_begin; b != batched_events.size(); ++b) {
+            auto & batch = batched_events[b];
+            batch.events = events_of_var[batch.var.index];
+            events_of_var[batch.var.index] = 0;
+            if (! domain_deltas.empty())
+                record_delta(batch.var, batch.events);
+            for (auto & observer : domain_change_observers)
+                observer->note_domain_change(batch.var);
+        }
+    }
+
+    // Hand over what changed for this propagator since it last ran, and start
+    // recording afresh. The returned DomainDelta refers to storage that stays
+    // put until the propagator next runs.
+    auto hand_over_delta(int delta_index, const State & state) -> DomainDelta
+    {
+        auto & delta = domain_deltas[delta_index];
+        auto set_snapshot = [&](std::uint32_t position) {
+            auto events = delta.pending_since[position] < propagations ? delta.pending_mask[position] : uint8_t{0};
+            delta_snapshot_trail.push_back({delta_index, position, delta.snapshot[position], events, delta.pending_since[position]});
+            delta.snapshot[position] = state.bounds(delta.vars[position]);
+        };
+
+        delta.handed_over.clear();
+        if (delta.everything_changed) {
+            // Undoing this puts everything_changed back, so the snapshots it
+            // takes need no trail entries of their own.
+            delta_snapshot_trail.push_back({delta_index, everything_changed_position, {0_i, 0_i}, 0, 0});
+            for (std::uint32_t position = 0; position < delta.vars.size(); ++position)
+                delta.snapshot[position] = state.bounds(delta.vars[position]);
+        }
+        else {
+            const int only_bounds = 1 << to_underlying(Inference::BoundsChanged);
+            for (auto position : delta.pending) {
+                auto [old_lower, old_upper] = delta.snapshot[position];
+                delta.handed_over.push_back({position, old_lower, old_upper, only_bounds == delta.pending_mask[position]});
+                set_snapshot(position);
+            }
+        }
+
+        for (auto position : delta.pending)
+            delta.pending_mask[position] = 0;
+        delta.pending.clear();
+
+        DomainDelta result{delta.handed_over, delta.everything_changed, delta.backtracks_when_last_run != backtracks};
+        delta.everything_changed = false;
+        delta.backtracks_when_last_run = backtracks;
+        return result;
+    }
+
     [[nodiscard]] auto watch_state_get(int owner, std::uint32_t key) const -> std::uint64_t override
     {
         if (owner < 0 || static_cast<std::size_t>(owner) >= watch_state_by_propagator.size())
@@ -348,19 +553,30 @@ struct Propagators::Imp : RefinedWatchSink
         // reverse replay on backtrack undoes the re-arm then restores these.
         if (owner_propagator < 0 || static_cast<std::size_t>(owner_propagator) >= propagator_scope.size())
             return;
-        for (const auto & v : propagator_scope[owner_propagator]) {
-            if (v.index >= refined_watches_by_var.size())
-                continue;
-            auto & watches = refined_watches_by_var[v.index];
-            for (std::size_t i = 0; i < watches.size();) {
-                if (watches[i].owner == owner_propagator) {
-                    refined_watch_edit_trail.push_back({WatchEditOp::Removed, v.index, watches[i]});
-                    watches[i] = watches.back();
-                    watches.pop_back();
-                }
-                else
-                    ++i;
+        for (const auto & v : propagator_scope[owner_propagator])
+            clear_refined_watches_on_var(owner_propagator, v.index);
+    }
+
+    auto clear_refined_watches_on(int owner_propagator, const vector<IntegerVariableID> & vars) -> void override
+    {
+        for (const auto & v : vars)
+            if (auto var_index = underlying_var_index(v))
+                clear_refined_watches_on_var(owner_propagator, *var_index);
+    }
+
+    auto clear_refined_watches_on_var(int owner_propagator, std::size_t var_index) -> void
+    {
+        if (var_index >= refined_watches_by_var.size())
+            return;
+        auto & watches = refined_watches_by_var[var_index];
+        for (std::size_t i = 0; i < watches.size();) {
+            if (watches[i].owner == owner_propagator) {
+                refined_watch_edit_trail.push_back({WatchEditOp::Removed, var_index, watches[i]});
+                watches[i] = watches.back();
+                watches.pop_back();
             }
+            else
+                ++i;
         }
     }
 };
@@ -401,11 +617,13 @@ auto Propagators::define_bound(const State & state, ProofModel * const optional_
     }
 }
 
-auto Propagators::install(const ConstraintID & constraint_id, PropagationFunction && f, const Triggers & triggers) -> void
+auto Propagators::install(const ConstraintID & constraint_id, PropagationFunction && f, const Triggers & triggers, PropagatorCost cost) -> void
 {
     int id = _imp->propagation_functions.size();
     _imp->propagation_functions.emplace_back(move(f));
     _imp->permanently_disabled.push_back(0);
+    _imp->cost_of_propagator.push_back(to_underlying(cost));
+    _imp->costs_in_use |= 1u << to_underlying(cost);
 
     auto [it, inserted] = _imp->constraint_index_of_id.try_emplace(constraint_id, static_cast<int>(_imp->constraint_ids.size()));
     if (inserted)
@@ -517,6 +735,26 @@ auto Propagators::install(const ConstraintID & constraint_id, PropagationFunctio
         trigger_on_instantiated(v, id);
     for (const auto & [literal, payload] : triggers.refined)
         _imp->register_refined_watch(id, literal, payload, false);
+
+    // Domain deltas, only for a propagator that accepts one. Positions are
+    // numbered over the coarse triggers, in the order DomainDeltaEntry says.
+    _imp->domain_delta_of_propagator.push_back(-1);
+    if (_imp->propagation_functions.back().wants_domain_delta()) {
+        int delta_index = _imp->domain_deltas.size();
+        _imp->domain_delta_of_propagator.back() = delta_index;
+        _imp->domain_deltas.emplace_back();
+        std::uint32_t position = 0;
+        for (const auto & v : triggers.on_change)
+            _imp->add_delta_position(delta_index, position++, v);
+        for (const auto & v : triggers.on_bounds)
+            _imp->add_delta_position(delta_index, position++, v);
+        for (const auto & v : triggers.on_instantiated)
+            _imp->add_delta_position(delta_index, position++, v);
+        auto & delta = _imp->domain_deltas.back();
+        delta.snapshot.resize(position, pair{0_i, 0_i});
+        delta.pending_mask.resize(position, 0);
+        delta.pending_since.resize(position, 0);
+    }
 }
 
 auto Propagators::disable_propagators_for_constraints(std::span<const ConstraintID> constraint_ids) -> std::size_t
@@ -590,6 +828,11 @@ auto Propagators::initialise(State & state, ProofLogger * const logger) -> bool
     return true;
 }
 
+auto Propagators::order_propagation_by_cost(bool order) -> void
+{
+    _imp->order_by_cost = order;
+}
+
 auto Propagators::propagate(const Literals & guesses, State & state, ProofLogger * const logger, atomic<bool> * optional_abort_flag) const -> bool
 {
     // Test-mode net for EnableButIdempotent (see propagators-fwd.hh): re-run
@@ -613,33 +856,63 @@ auto Propagators::propagate(const Literals & guesses, State & state, ProofLogger
 #pragma GCC diagnostic pop
 #endif
 
+    const bool by_cost = _imp->order_by_cost && std::popcount(_imp->costs_in_use) > 1;
+
+    auto make_ready = [&](const int p) {
+        auto being_swapped_item = _imp->queue[_imp->enqueued_end];
+        swap(_imp->queue[_imp->lookup[p]], _imp->queue[_imp->enqueued_end]);
+        swap(_imp->lookup[p], _imp->lookup[being_swapped_item]);
+        ++_imp->enqueued_end;
+    };
+
     auto enqueue_if_idle = [&](const int p) {
         if (_imp->lookup[p] >= _imp->enqueued_end && _imp->lookup[p] < _imp->idle_end) {
-            auto being_swapped_item = _imp->queue[_imp->enqueued_end];
-            swap(_imp->queue[_imp->lookup[p]], _imp->queue[_imp->enqueued_end]);
-            swap(_imp->lookup[p], _imp->lookup[being_swapped_item]);
-            ++_imp->enqueued_end;
+            if (by_cost) {
+                if (! _imp->pending[p]) {
+                    _imp->pending[p] = 1;
+                    _imp->pending_by_cost[_imp->cost_of_propagator[p]].push_back(p);
+                }
+            }
+            else
+                make_ready(p);
         }
     };
 
-    auto requeue = [&](const SimpleIntegerVariableID & v, const Inference inf) {
+    // Only called with the ready region empty, so every pending propagator is
+    // idle and can be swapped into it.
+    auto make_cheapest_pending_ready = [&]() {
+        for (auto & waiting : _imp->pending_by_cost)
+            if (! waiting.empty()) {
+                for (auto p : waiting) {
+                    _imp->pending[p] = 0;
+                    make_ready(p);
+                }
+                waiting.clear();
+                break;
+            }
+    };
+
+    // Wake everything on v that cares about any of the Inference bits in
+    // events, which may be several changes folded together.
+    auto requeue = [&](const SimpleIntegerVariableID & v, const int events) {
         if (v.index < _imp->iv_triggers.size())
             for (auto & [p, mask] : _imp->iv_triggers[v.index].ids_and_masks)
-                if (mask & (1 << to_underlying(inf)))
+                if (mask & events)
                     enqueue_if_idle(p);
 
         // Refined watches: fire any whose literal is now entailed, delivering the
         // payload to its owner and consuming the watch. A watch is only tested when
-        // the current inference granularity is in its trigger_mask -- e.g. an `x==v`
-        // watch is skipped on a mere bound move, since x==v can only become true when
-        // x is instantiated. This gates the expensive test_literal; the firing of a
+        // one of the changes is in its trigger_mask -- e.g. an `x==v` watch is
+        // skipped on mere bound moves, since x==v can only become true when x is
+        // instantiated. This gates the expensive test_literal; the firing of a
         // watch outside its mask would be a no-op anyway (the literal cannot have
-        // changed status), so this is semantics-preserving.
+        // changed status), so this is semantics-preserving. The test is against
+        // the current state, so one test per batch sees everything the batched
+        // changes did.
         if (v.index < _imp->refined_watches_by_var.size()) {
-            const auto inf_bit = 1u << to_underlying(inf);
             auto & watches = _imp->refined_watches_by_var[v.index];
             for (std::size_t i = 0; i < watches.size();) {
-                if ((watches[i].trigger_mask & inf_bit) && state.test_literal(watches[i].literal) == LiteralIs::DefinitelyTrue) {
+                if ((watches[i].trigger_mask & events) && state.test_literal(watches[i].literal) == LiteralIs::DefinitelyTrue) {
                     const auto fired = watches[i];
                     if (_imp->inbox_by_propagator[fired.owner].empty())
                         _imp->pending_inbox_owners.push_back(fired.owner);
@@ -663,10 +936,10 @@ auto Propagators::propagate(const Literals & guesses, State & state, ProofLogger
     // claims -- the plain requeue above keeps the claim-free hot path free of
     // the extra load. Refined watches are consumed on their first fire in the
     // requeue above, so this coarse-only replay does not re-fire them.
-    auto requeue_unless_already_seen = [&](const SimpleIntegerVariableID & v, const Inference inf) {
+    auto requeue_unless_already_seen = [&](const SimpleIntegerVariableID & v, const int events) {
         if (v.index < _imp->iv_triggers.size())
             for (auto & [p, mask] : _imp->iv_triggers[v.index].ids_and_masks)
-                if ((mask & (1 << to_underlying(inf))) && ! _imp->claim_protected[p])
+                if ((mask & events) && ! _imp->claim_protected[p])
                     enqueue_if_idle(p);
     };
 
@@ -676,10 +949,23 @@ auto Propagators::propagate(const Literals & guesses, State & state, ProofLogger
     // within the boundary-replay block itself, which always clears them
     // before running anything. Just make sure the scratch is big enough.
     _imp->idempotent_run_claims.clear();
+    _imp->batched_events.clear();
     if (_imp->claim_protected.size() < _imp->propagation_functions.size())
         _imp->claim_protected.resize(_imp->propagation_functions.size(), 0);
 
+    // Likewise, a contradiction or an abort can leave propagators pending.
+    if (by_cost) {
+        _imp->pending.resize(_imp->propagation_functions.size(), 0);
+        for (auto & waiting : _imp->pending_by_cost) {
+            for (auto p : waiting)
+                _imp->pending[p] = 0;
+            waiting.clear();
+        }
+    }
+
     _imp->inbox_by_propagator.resize(_imp->propagation_functions.size());
+    if (_imp->profiling)
+        _imp->profile_by_propagator.resize(_imp->propagation_functions.size());
 
     // Snapshot the refined-watch edit trail BEFORE any firing this call. The guess
     // first pass below can already fire and consume watches, so the snapshot must
@@ -691,7 +977,9 @@ auto Propagators::propagate(const Literals & guesses, State & state, ProofLogger
     // registered before search and so sit below every snapshot and persist.
     auto refined_trail_start = _imp->refined_watch_edit_trail.size();
     auto watch_state_trail_start = _imp->watch_state_trail.size();
-    state.on_backtrack([&, refined_trail_start, watch_state_trail_start]() {
+    auto delta_snapshot_trail_start = _imp->delta_snapshot_trail.size();
+    ++_imp->propagations;
+    state.on_backtrack([&, refined_trail_start, watch_state_trail_start, delta_snapshot_trail_start]() {
         while (_imp->refined_watch_edit_trail.size() > refined_trail_start) {
             const auto & e = _imp->refined_watch_edit_trail.back();
             auto & watches = _imp->refined_watches_by_var[e.var_index];
@@ -715,8 +1003,30 @@ auto Propagators::propagate(const Literals & guesses, State & state, ProofLogger
             _imp->watch_state_by_propagator[e.owner][e.key] = e.old_value;
             _imp->watch_state_trail.pop_back();
         }
+        // And the domain-delta snapshots, so that old bounds handed over later
+        // describe the path search is now on, along with whatever was handed
+        // over since, so that it is not lost.
+        while (_imp->delta_snapshot_trail.size() > delta_snapshot_trail_start) {
+            const auto & e = _imp->delta_snapshot_trail.back();
+            auto & delta = _imp->domain_deltas[e.delta_index];
+            if (e.position == Imp::everything_changed_position)
+                delta.everything_changed = true;
+            else {
+                delta.snapshot[e.position] = e.old_bounds;
+                if (0 != e.events && 0 == delta.pending_mask[e.position]) {
+                    delta.pending.push_back(e.position);
+                    delta.pending_since[e.position] = e.pending_since;
+                }
+                delta.pending_mask[e.position] |= e.events;
+            }
+            _imp->delta_snapshot_trail.pop_back();
+        }
+        ++_imp->backtracks;
     });
 
+    for (auto & observer : _imp->domain_change_observers)
+        observer->note_propagation_starting(guesses);
+
     if (guesses.empty()) {
         // On the first pass, walk propagators in registration order. The queue runs
         // oldest-first, so push them forwards. Permanently disabled propagators
@@ -746,6 +1056,21 @@ auto Propagators::propagate(const Literals & guesses, State & state, ProofLogger
         _imp->enqueued_begin = 0;
         _imp->enqueued_end = enabled_end;
         _imp->idle_end = enabled_end;
+
+        // Initialisers and presolvers change domains without guessing, so
+        // nothing recorded can be trusted here.
+        for (auto & delta : _imp->domain_deltas)
+            delta.everything_changed = true;
+        for (auto & observer : _imp->domain_change_observers)
+            observer->note_everything_changed();
+
+        // Ordering by cost starts with everything pending instead, so that the
+        // first pass too runs the cheap propagators first.
+        if (by_cost) {
+            _imp->enqueued_end = 0;
+            for (int at = 0; at != enabled_end; ++at)
+                enqueue_if_idle(_imp->queue[at]);
+        }
     }
     else {
         // Seed the queue from every supplied guess. A propagator already enqueued by an
@@ -762,10 +1087,18 @@ auto Propagators::propagate(const Literals & guesses, State & state, ProofLogger
                         [&](const SimpleIntegerVariableID & var) {
                             // trigger all propagators on this var, even if we might not actually
                             // have instantiated it. bit ugly but easier than tracking.
-                            requeue(var, Inference::Instantiated);
-                        },                                                                                                  //
-                        [&](const ConstantIntegerVariableID &) {},                                                          //
-                        [&](const ViewOfIntegerVariableID & var) { requeue(var.actual_variable, Inference::Instantiated); } //
+                            requeue(var, on_instantiated_mask);
+                            _imp->record_delta(var, on_instantiated_mask);
+                            for (auto & observer : _imp->domain_change_observers)
+                                observer->note_domain_change(var);
+                        },                                         //
+                        [&](const ConstantIntegerVariableID &) {}, //
+                        [&](const ViewOfIntegerVariableID & var) {
+                            requeue(var.actual_variable, on_instantiated_mask);
+                            _imp->record_delta(var.actual_variable, on_instantiated_mask);
+                            for (auto & observer : _imp->domain_change_observers)
+                                observer->note_domain_change(var.actual_variable);
+                        } //
                     }
                         .visit(cond.var);
                 } //
@@ -801,10 +1134,11 @@ auto Propagators::propagate(const Literals & guesses, State & state, ProofLogger
                 _imp->to_disable.clear();
 
                 // Fold the propagated prefix back into the idle region and wake the
-                // propagators triggered by this round's inferences. each_inference() yields
-                // oldest-first, so propagators are requeued in the order their triggers
-                // occurred -- keeping the queue properly FIFO (the drain is already FIFO).
-                // An inference must not re-wake a claiming propagator whose run ended
+                // propagators triggered by this round's inferences. The batches are in
+                // run order, and within a run in the order its variables first changed,
+                // so propagators are requeued in the order their triggers occurred --
+                // keeping the queue properly FIFO (the drain is already FIFO). An
+                // inference must not re-wake a claiming propagator whose run ended
                 // after it was recorded: that propagator had already seen it (the store
                 // applies inferences immediately, and its claim says re-running against
                 // what it saw infers nothing). Runs are serial, so the claims are
@@ -820,28 +1154,30 @@ auto Propagators::propagate(const Literals & guesses, State & state, ProofLogger
                 _imp->enqueued_begin = 0;
                 _imp->enqueued_end = 0;
                 if (_imp->idempotent_run_claims.empty()) {
-                    for (const auto & [v, inf] : tracker.each_inference())
-                        requeue(v, inf);
+                    for (const auto & batch : _imp->batched_events)
+                        requeue(batch.var, batch.events);
                 }
                 else {
                     for (const auto & c : _imp->idempotent_run_claims)
                         _imp->claim_protected[c.propagator_id] = 1;
                     auto claim = _imp->idempotent_run_claims.begin();
                     const auto claims_end = _imp->idempotent_run_claims.end();
-                    std::size_t inference_index = 0;
-                    for (const auto & [v, inf] : tracker.each_inference()) {
-                        while (claim != claims_end && claim->end_inference_index <= inference_index) {
+                    for (const auto & batch : _imp->batched_events) {
+                        while (claim != claims_end && claim->end_inference_index <= batch.first_inference_index) {
                             _imp->claim_protected[claim->propagator_id] = 0;
                             ++claim;
                         }
-                        requeue_unless_already_seen(v, inf);
-                        ++inference_index;
+                        requeue_unless_already_seen(batch.var, batch.events);
                     }
                     for (; claim != claims_end; ++claim)
                         _imp->claim_protected[claim->propagator_id] = 0;
                     _imp->idempotent_run_claims.clear();
                 }
+                _imp->batched_events.clear();
                 tracker.reset();
+
+                if (by_cost)
+                    make_cheapest_pending_ready();
             }
 
             if (_imp->enqueued_begin == _imp->enqueued_end)
@@ -857,11 +1193,25 @@ auto Propagators::propagate(const Literals & guesses, State & state, ProofLogger
             // been disabled.
             if (0 != _imp->permanently_disabled_count && _imp->permanently_disabled[propagator_id]) [[unlikely]]
                 continue;
+
+            // Only read when profiling, and recorded after the run, however it
+            // ends.
+            steady_clock::time_point profile_start;
+            std::size_t profile_inferences_before = 0;
+            bool profile_claimed_idempotence = false;
+            if (_imp->profiling) [[unlikely]] {
+                profile_inferences_before = tracker.count_inferences();
+                profile_start = steady_clock::now();
+            }
+
+            const auto inferences_before_run = tracker.count_inferences();
             try {
                 ++_imp->total_propagations;
                 tracker.begin_propagator_run();
                 RefinedWatchContext watches{*_imp, propagator_id, _imp->inbox_by_propagator[propagator_id]};
-                auto propagator_state = _imp->propagation_functions[propagator_id](state, tracker, logger, watches);
+                auto delta_index = _imp->domain_delta_of_propagator[propagator_id];
+                auto delta = -1 == delta_index ? DomainDelta{} : _imp->hand_over_delta(delta_index, state);
+                auto propagator_state = _imp->propagation_functions[propagator_id](state, tracker, logger, watches, delta);
                 // The fired set has now been delivered; clear it so that, if this
                 // propagator is woken again later in this fixpoint, it sees only the
                 // payloads that fired since.
@@ -904,6 +1254,7 @@ auto Propagators::propagate(const Literals & guesses, State & state, ProofLogger
                             }
                             if (const auto seen = tracker.count_inferences(); 0 != seen)
                                 _imp->idempotent_run_claims.emplace_back(seen, propagator_id);
+                            profile_claimed_idempotence = true;
                         }
                         break;
                     case PropagatorState::DisableUntilBacktrack: _imp->to_disable.push_back(propagator_id); break;
@@ -922,6 +1273,22 @@ auto Propagators::propagate(const Literals & guesses, State & state, ProofLogger
                         tracker.last_contradiction_reason(), state);
             }
 
+            // Fold this run's changes into one batch of events per variable,
+            // and record them against every propagator that wants a
+            // DomainDelta, however the run ended.
+            _imp->batch_run_events(tracker, inferences_before_run, tracker.count_inferences());
+
+            if (_imp->profiling) [[unlikely]] {
+                auto & counters = _imp->profile_by_propagator[propagator_id];
+                auto inferences = tracker.count_inferences() - profile_inferences_before;
+                counters.time += steady_clock::now() - profile_start;
+                ++counters.calls;
+                counters.effectful_calls += (0 != inferences);
+                counters.inferences += inferences;
+                counters.contradictions += contradiction;
+                counters.idempotence_claims += profile_claimed_idempotence;
+            }
+
             if (contradiction || (optional_abort_flag && optional_abort_flag->load()))
                 break;
         }
@@ -936,14 +1303,19 @@ auto Propagators::propagate(const Literals & guesses, State & state, ProofLogger
         return ! contradiction;
     };
 
+    bool succeeded;
     if (logger) {
         EagerProofLoggingInferenceTracker tracker{state};
-        return run(tracker);
+        succeeded = run(tracker);
     }
     else {
         SimpleInferenceTracker tracker{state};
-        return run(tracker);
+        succeeded = run(tracker);
     }
+
+    for (auto & observer : _imp->domain_change_observers)
+        observer->note_propagation_finished(succeeded, state);
+    return succeeded;
 }
 
 auto Propagators::fill_in_constraint_stats(Stats & stats) const -> void
@@ -956,6 +1328,41 @@ auto Propagators::fill_in_constraint_stats(Stats & stats) const -> void
         stats.idempotence_downgrades += ignored;
 }
 
+auto Propagators::note_constraint_type(const ConstraintID & constraint_id, const string & constraint_type) -> void
+{
+    _imp->constraint_types.insert_or_assign(constraint_id, constraint_type);
+}
+
+auto Propagators::enable_profiling() -> void
+{
+    _imp->profiling = true;
+    _imp->profile_by_propagator.resize(_imp->propagation_functions.size());
+}
+
+auto Propagators::fill_in_propagation_profile(PropagationProfile & profile) const -> void
+{
+    PropagationProfile ours;
+    ours.by_constraint.resize(_imp->constraint_ids.size());
+    for (std::size_t c = 0; c < _imp->constraint_ids.size(); ++c) {
+        auto type = _imp->constraint_types.find(_imp->constraint_ids[c]);
+        ours.by_constraint[c].constraint_type = type == _imp->constraint_types.end() ? "unknown" : type->second;
+        ours.by_constraint[c].constraint = as_string(_imp->constraint_ids[c]);
+    }
+
+    for (std::size_t p = 0; p < _imp->profile_by_propagator.size(); ++p) {
+        const auto & counters = _imp->profile_by_propagator[p];
+        auto & entry = ours.by_constraint[_imp->propagator_constraint_index[p]];
+        entry.calls += counters.calls;
+        entry.effectful_calls += counters.effectful_calls;
+        entry.inferences += counters.inferences;
+        entry.contradictions += counters.contradictions;
+        entry.idempotence_claims += counters.idempotence_claims;
+        entry.time += std::chrono::duration_cast<std::chrono::nanoseconds>(counters.time);
+    }
+
+    profile.add(ours);
+}
+
 auto Propagators::add_component_stats(std::shared_ptr<const ComponentStats> component) -> void
 {
     _imp->stats->add_component(move(component));
@@ -972,9 +1379,7 @@ auto Propagators::trigger_on_change(IntegerVariableID var, int t) -> void
         [&](const SimpleIntegerVariableID & v) {
             if (_imp->iv_triggers.size() <= v.index)
                 _imp->iv_triggers.resize(v.index + 1);
-            _imp->iv_triggers[v.index].ids_and_masks.emplace_back(t,
-                (1 << to_underlying(Inference::InteriorValuesChanged)) | (1 << to_underlying(Inference::BoundsChanged)) |
-                    (1 << to_underlying(Inference::Instantiated)));
+            _imp->iv_triggers[v.index].ids_and_masks.emplace_back(t, on_change_mask);
         },                                                                                   //
         [&](const ViewOfIntegerVariableID & v) { trigger_on_change(v.actual_variable, t); }, //
         [&](const ConstantIntegerVariableID &) {}                                            //
@@ -988,8 +1393,7 @@ auto Propagators::trigger_on_bounds(IntegerVariableID var, int t) -> void
         [&](const SimpleIntegerVariableID & v) {
             if (_imp->iv_triggers.size() <= v.index)
                 _imp->iv_triggers.resize(v.index + 1);
-            _imp->iv_triggers[v.index].ids_and_masks.emplace_back(
-                t, (1 << to_underlying(Inference::BoundsChanged)) | (1 << to_underlying(Inference::Instantiated)));
+            _imp->iv_triggers[v.index].ids_and_masks.emplace_back(t, on_bounds_mask);
         },                                                                                   //
         [&](const ViewOfIntegerVariableID & v) { trigger_on_bounds(v.actual_variable, t); }, //
         [&](const ConstantIntegerVariableID &) {}                                            //
@@ -1003,7 +1407,7 @@ auto Propagators::trigger_on_instantiated(IntegerVariableID var, int t) -> void
         [&](const SimpleIntegerVariableID & v) {
             if (_imp->iv_triggers.size() <= v.index)
                 _imp->iv_triggers.resize(v.index + 1);
-            _imp->iv_triggers[v.index].ids_and_masks.emplace_back(t, (1 << to_underlying(Inference::Instantiated)));
+            _imp->iv_triggers[v.index].ids_and_masks.emplace_back(t, on_instantiated_mask);
         },                                                                                         //
         [&](const ViewOfIntegerVariableID & v) { trigger_on_instantiated(v.actual_variable, t); }, //
         [&](const ConstantIntegerVariableID &) {}                                                  //
@@ -1083,3 +1487,13 @@ auto Propagators::conflict_observers() const -> const vector<ConflictObserver *>
 {
     return _imp->conflict_observers;
 }
+
+auto Propagators::add_domain_change_observer(DomainChangeObserver * observer) -> void
+{
+    _imp->domain_change_observers.push_back(observer);
+}
+
+auto Propagators::domain_change_observers() const -> const vector<DomainChangeObserver *> &
+{
+    return _imp->domain_change_observers;
+}
@@ -13,6 +13,7 @@
 #include <gcs/innards/state.hh>
 #include <gcs/lifetime.hh>
 #include <gcs/problem.hh>
+#include <gcs/propagation_profile.hh>
 #include <gcs/stats.hh>
 
 #include <atomic>
@@ -28,6 +29,7 @@
 namespace gcs::innards
 {
     class ConflictObserver;
+    class DomainChangeObserver;
 
     /**
      * \brief Back-channel through which a RefinedWatchContext registers refined
@@ -66,6 +68,13 @@ namespace gcs::innards
          */
         virtual auto clear_refined_watches(int owner_propagator) -> void = 0;
 
+        /**
+         * \brief As clear_refined_watches(), but searching the given variables
+         * rather than the propagator's declared scope.
+         * \sa RefinedWatchContext::clear_watches_on
+         */
+        virtual auto clear_refined_watches_on(int owner_propagator, const std::vector<IntegerVariableID> & vars) -> void = 0;
+
         /**
          * \brief Read this propagator's backtrackable scratch value for `key`, or 0
          * if never set. \sa RefinedWatchContext::watch_state
@@ -163,6 +172,20 @@ namespace gcs::innards
             _sink->clear_refined_watches(_owner);
         }
 
+        /**
+         * \brief Drop every refined watch this propagator has armed on any of
+         * `vars`.
+         *
+         * For a propagator that arms watches on variables it deliberately keeps
+         * out of its declared scope, so that clear_watches() cannot find them: the
+         * learned-nogood store, for example, may watch any variable but must not
+         * raise every variable's degree. Trailed exactly as clear_watches().
+         */
+        auto clear_watches_on(const std::vector<IntegerVariableID> & vars) const -> void
+        {
+            _sink->clear_refined_watches_on(_owner, vars);
+        }
+
         /**
          * \brief Read this propagator's backtrackable scratch value for `key` (0 if
          * never set). It is restored on backtrack in lockstep with the watches, so a
@@ -182,6 +205,110 @@ namespace gcs::innards
         }
     };
 
+    /**
+     * \brief One scope position of a propagator that may have changed since
+     * it last ran, as reported by a DomainDelta.
+     *
+     * \ingroup Innards
+     */
+    struct DomainDeltaEntry
+    {
+        /**
+         * \brief Which position changed, counting the propagator's Triggers
+         * on_change variables first, then its on_bounds variables, then its
+         * on_instantiated variables.
+         */
+        std::uint32_t position;
+
+        /**
+         * \brief Bounds that contained the position's domain as it was when
+         * the propagator last ran, so every value it has lost since then lies
+         * within them.
+         */
+        Integer old_lower, old_upper;
+
+        /**
+         * \brief If true, only bound changes were recorded, so the values lost
+         * are exactly those within the old bounds that are outside the current
+         * ones. Otherwise, any value within the old bounds that is no longer in
+         * the domain may have been lost.
+         */
+        bool bounds_only;
+    };
+
+    /**
+     * \brief The domain-delta context handed to a propagator each time it runs:
+     * which of its scope positions changed since it last ran, and how.
+     *
+     * Without this, a woken propagator learns nothing about what changed, and
+     * must rescan its whole scope. The engine records the changes as each
+     * propagator run that made them ends (and for each guess), against the
+     * positions of every propagator that has asked for them, and hands them
+     * over when the propagator runs, so a propagator can do work proportional
+     * to what changed.
+     *
+     * Every position whose domain changed after the propagator last finished
+     * running, on the current path of search, is listed. A position may also
+     * be listed when it has not changed since then, such as for a change the
+     * propagator made itself. So a position that is not listed has the domain it had
+     * when the propagator last finished, which is enough for a propagator
+     * that keeps its data in State. One that caches anything computed from
+     * domains outside of State must also check backtracked(): after a
+     * backtrack, its last run may have been on another branch.
+     *
+     * Like RefinedWatchContext, this is forwarded only to propagators whose
+     * function accepts it (see PropagationFunctionImpl), and nothing is
+     * recorded for any propagator that does not.
+     *
+     * \ingroup Innards
+     */
+    class DomainDelta
+    {
+    private:
+        std::span<const DomainDeltaEntry> _changed;
+        bool _everything_changed = true;
+        bool _backtracked = true;
+
+    public:
+        /**
+         * \brief A delta that says everything may have changed.
+         */
+        DomainDelta() = default;
+
+        DomainDelta(std::span<const DomainDeltaEntry> changed, bool everything_changed, bool backtracked) :
+            _changed(changed), _everything_changed(everything_changed), _backtracked(backtracked)
+        {
+        }
+
+        /**
+         * \brief If true, the engine cannot say what changed, and the
+         * propagator must look at its whole scope, and changed() is empty.
+         * This is so on a propagator's first run, on every run at the root
+         * of search, and when a run is repeated to check an idempotence claim.
+         */
+        [[nodiscard]] auto everything_changed() const -> bool
+        {
+            return _everything_changed;
+        }
+
+        /**
+         * \brief Has search backtracked since this propagator last ran?
+         */
+        [[nodiscard]] auto backtracked() const -> bool
+        {
+            return _backtracked;
+        }
+
+        /**
+         * \brief The positions that may have changed since this propagator
+         * last ran, each once, in no particular order.
+         */
+        [[nodiscard]] auto changed() const -> std::span<const DomainDeltaEntry>
+        {
+            return _changed;
+        }
+    };
+
     class PropagationFunctionImplBase
     {
     public:
@@ -195,9 +322,15 @@ namespace gcs::innards
         auto operator=(PropagationFunctionImplBase &&) -> PropagationFunctionImplBase & = default;
 
         [[nodiscard]] virtual auto operator()(const State & state, SimpleInferenceTracker & tracker, ProofLogger * const logger,
-            const RefinedWatchContext & watches) -> PropagatorState = 0;
+            const RefinedWatchContext & watches, const DomainDelta & delta) -> PropagatorState = 0;
         [[nodiscard]] virtual auto operator()(const State & state, EagerProofLoggingInferenceTracker & tracker, ProofLogger * const logger,
-            const RefinedWatchContext & watches) -> PropagatorState = 0;
+            const RefinedWatchContext & watches, const DomainDelta & delta) -> PropagatorState = 0;
+
+        /**
+         * \brief Does the function accept a DomainDelta, so that the engine
+         * needs to record one for it?
+         */
+        [[nodiscard]] virtual auto wants_domain_delta() const -> bool = 0;
     };
 
     template <typename Func_>
@@ -212,23 +345,33 @@ namespace gcs::innards
         }
 
         [[nodiscard]] virtual auto operator()(const State & state, SimpleInferenceTracker & tracker, ProofLogger * const logger,
-            [[maybe_unused]] const RefinedWatchContext & watches) -> PropagatorState override
+            [[maybe_unused]] const RefinedWatchContext & watches, [[maybe_unused]] const DomainDelta & delta) -> PropagatorState override
         {
             if constexpr (std::is_invocable_v<Func_ &, const State &, SimpleInferenceTracker &, ProofLogger * const, const RefinedWatchContext &>)
                 return _f(state, tracker, logger, watches);
+            else if constexpr (std::is_invocable_v<Func_ &, const State &, SimpleInferenceTracker &, ProofLogger * const, const DomainDelta &>)
+                return _f(state, tracker, logger, delta);
             else
                 return _f(state, tracker, logger);
         }
 
         [[nodiscard]] virtual auto operator()(const State & state, EagerProofLoggingInferenceTracker & tracker, ProofLogger * const logger,
-            [[maybe_unused]] const RefinedWatchContext & watches) -> PropagatorState override
+            [[maybe_unused]] const RefinedWatchContext & watches, [[maybe_unused]] const DomainDelta & delta) -> PropagatorState override
         {
             if constexpr (std::is_invocable_v<Func_ &, const State &, EagerProofLoggingInferenceTracker &, ProofLogger * const,
                               const RefinedWatchContext &>)
                 return _f(state, tracker, logger, watches);
+            else if constexpr (std::is_invocable_v<Func_ &, const State &, EagerProofLoggingInferenceTracker &, ProofLogger * const,
+                                   const DomainDelta &>)
+                return _f(state, tracker, logger, delta);
             else
                 return _f(state, tracker, logger);
         }
+
+        [[nodiscard]] virtual auto wants_domain_delta() const -> bool override
+        {
+            return std::is_invocable_v<Func_ &, const State &, SimpleInferenceTracker &, ProofLogger * const, const DomainDelta &>;
+        }
     };
 
     class PropagationFunction
@@ -242,16 +385,21 @@ namespace gcs::innards
         {
         }
 
-        [[nodiscard]] auto operator()(
-            const State & state, SimpleInferenceTracker & tracker, ProofLogger * const logger, const RefinedWatchContext & watches) -> PropagatorState
+        [[nodiscard]] auto operator()(const State & state, SimpleInferenceTracker & tracker, ProofLogger * const logger,
+            const RefinedWatchContext & watches, const DomainDelta & delta) -> PropagatorState
         {
-            return _impl->operator()(state, tracker, logger, watches);
+            return _impl->operator()(state, tracker, logger, watches, delta);
         }
 
         [[nodiscard]] auto operator()(const State & state, EagerProofLoggingInferenceTracker & tracker, ProofLogger * const logger,
-            const RefinedWatchContext & watches) -> PropagatorState
+            const RefinedWatchContext & watches, const DomainDelta & delta) -> PropagatorState
+        {
+            return _impl->operator()(state, tracker, logger, watches, delta);
+        }
+
+        [[nodiscard]] auto wants_domain_delta() const -> bool
         {
-            return _impl->operator()(state, tracker, logger, watches);
+            return _impl->wants_domain_delta();
         }
     };
 
@@ -337,6 +485,36 @@ namespace gcs::innards
 
     constexpr std::size_t number_of_initialiser_priorities = 3;
 
+    /**
+     * \brief How expensive a propagator is to run, roughly, as a function of
+     * the size of its scope.
+     *
+     * When propagators of more than one cost are woken, the queue runs the
+     * cheaper ones to a fixpoint before it runs any of the dearer ones, so
+     * that a cheap comparison does not wait behind an edge-finding or SCC
+     * pass, and the expensive pass sees the domains the cheap ones would have
+     * given it anyway. Within a cost, propagators run oldest-first. The
+     * fixpoint, and so the search tree, is the same either way; only the
+     * amount of work done to reach it, and the order of proof lines, differ.
+     *
+     * This is a hint for scheduling, not a promise, so a propagator whose cost
+     * depends upon its input should give its typical cost.
+     *
+     * \ingroup Innards
+     * \sa Propagators::install
+     * \sa Propagators::order_propagation_by_cost
+     */
+    enum class PropagatorCost
+    {
+        Unary,
+        Binary,
+        Linear,
+        Quadratic,
+        Expensive
+    };
+
+    constexpr std::size_t number_of_propagator_costs = 5;
+
     /**
      * \brief Which side of a variable's domain a definitional bound restricts.
      *
@@ -481,8 +659,13 @@ namespace gcs::innards
          * heuristic can attribute a domain wipeout back to a constraint. It is
          * passed explicitly rather than held as mutable "current constraint"
          * state so it cannot be mis-sequenced.
+         *
+         * The PropagatorCost says when, relative to other woken propagators,
+         * this one runs. Most propagators are linear in their scope, so that is
+         * the default.
          */
-        auto install(const ConstraintID & constraint_id, PropagationFunction &&, const Triggers & trigger_vars) -> void;
+        auto install(const ConstraintID & constraint_id, PropagationFunction &&, const Triggers & trigger_vars,
+            PropagatorCost cost = PropagatorCost::Linear) -> void;
 
         /**
          * Retire every propagator belonging to any of the given constraints for
@@ -613,6 +796,16 @@ namespace gcs::innards
          */
         [[nodiscard]] auto initialise(State &, ProofLogger * const) -> bool;
 
+        /**
+         * \brief Whether propagate() runs cheaper propagators to a fixpoint
+         * before dearer ones, as their PropagatorCost says, or runs every woken
+         * propagator in one first-in first-out queue.
+         *
+         * On by default. It does nothing unless propagators of at least two
+         * different costs have been installed.
+         */
+        auto order_propagation_by_cost(bool) -> void;
+
         ///@}
 
         /**
@@ -627,6 +820,33 @@ namespace gcs::innards
          */
         auto fill_in_constraint_stats(Stats &) const -> void;
 
+        /**
+         * \brief Record which type of constraint a ConstraintID belongs to, so
+         * that a PropagationProfile can group its propagators by type.
+         *
+         * Problem::create_propagators() calls this for every posted constraint.
+         * A propagator whose constraint was never noted is profiled as
+         * `unknown`.
+         */
+        auto note_constraint_type(const ConstraintID &, const std::string & constraint_type) -> void;
+
+        /**
+         * \brief Start counting and timing every propagator call, for
+         * fill_in_propagation_profile().
+         *
+         * Off until this is called, and then on for good.
+         */
+        auto enable_profiling() -> void;
+
+        /**
+         * \brief Add the calls since enable_profiling() to a profile, one
+         * entry per constraint that installed a propagator.
+         *
+         * Adds rather than replaces, as PropagationProfile::add() does, so that
+         * each thread of a parallel search can add its own.
+         */
+        auto fill_in_propagation_profile(PropagationProfile &) const -> void;
+
         /**
          * \brief Register a component's stats block with the search's Stats.
          *
@@ -734,6 +954,31 @@ namespace gcs::innards
         [[nodiscard]] auto conflict_observers() const -> const std::vector<ConflictObserver *> &;
 
         ///@}
+
+        /**
+         * \name Domain change observation
+         */
+        ///@{
+
+        /**
+         * Attach a borrowed domain change observer, notified by propagate() of
+         * every variable whose domain it may have changed. As with
+         * add_conflict_observer(), the caller owns it and must keep it alive for
+         * the duration of the search, and several may be attached.
+         *
+         * \sa DomainChangeObserver
+         */
+        auto add_domain_change_observer(DomainChangeObserver * observer) -> void;
+
+        /**
+         * The domain change observers currently attached, in the order they
+         * were added; empty if there are none.
+         *
+         * \sa Propagators::add_domain_change_observer()
+         */
+        [[nodiscard]] auto domain_change_observers() const -> const std::vector<DomainChangeObserver *> &;
+
+        ///@}
     };
 }
 
@@ -4,6 +4,10 @@
 
 #include <catch2/catch_test_macros.hpp>
 
+#include <algorithm>
+#include <string>
+#include <vector>
+
 using namespace gcs;
 using namespace gcs::innards;
 
@@ -273,3 +277,357 @@ TEST_CASE("A view of a distinct variable does not downgrade the claim")
     CHECK(state.upper_bound(x) == 5_i);
     CHECK(runs == 1);
 }
+
+namespace
+{
+    // An expensive propagator that does nothing but note that it ran, then two
+    // cheap ones that cap x, the second more tightly than the first, installed
+    // in that order so that first-in first-out would run the expensive one
+    // first.
+    auto install_cost_ordering_propagators(Propagators & propagators, SimpleIntegerVariableID x, std::string & order) -> void
+    {
+        Triggers triggers;
+        triggers.on_change = {x};
+        propagators.install(
+            ConstraintID{NumberedConstraint{1}},
+            [&order](const State &, auto &, ProofLogger * const) -> PropagatorState {
+                order += 'E';
+                return PropagatorState::Enable;
+            },
+            triggers, PropagatorCost::Expensive);
+        propagators.install(
+            ConstraintID{NumberedConstraint{2}},
+            [&order, x](const State & state, auto & inference, ProofLogger * const logger) -> PropagatorState {
+                order += 'U';
+                if (state.upper_bound(x) > 5_i)
+                    inference.infer(logger, x < 6_i, NoJustificationNeeded{}, NoReason{});
+                return PropagatorState::Enable;
+            },
+            triggers, PropagatorCost::Unary);
+        propagators.install(
+            ConstraintID{NumberedConstraint{3}},
+            [&order, x](const State & state, auto & inference, ProofLogger * const logger) -> PropagatorState {
+                order += 'B';
+                if (state.upper_bound(x) > 3_i)
+                    inference.infer(logger, x < 4_i, NoJustificationNeeded{}, NoReason{});
+                return PropagatorState::Enable;
+            },
+            triggers, PropagatorCost::Binary);
+    }
+}
+
+TEST_CASE("Cheaper propagators run to a fixpoint before dearer ones")
+{
+    State state;
+    Stats stats;
+    Propagators propagators{stats};
+    auto x = state.allocate_integer_variable_with_state(0_i, 10_i);
+
+    std::string order;
+    install_cost_ordering_propagators(propagators, x, order);
+
+    REQUIRE(propagators.propagate(Literals{}, state, nullptr));
+    CHECK(state.upper_bound(x) == 3_i);
+    CHECK(order == "UUBUBE");
+}
+
+TEST_CASE("Ordering by cost can be turned off, giving first-in first-out")
+{
+    State state;
+    Stats stats;
+    Propagators propagators{stats};
+    auto x = state.allocate_integer_variable_with_state(0_i, 10_i);
+
+    std::string order;
+    install_cost_ordering_propagators(propagators, x, order);
+    propagators.order_propagation_by_cost(false);
+
+    REQUIRE(propagators.propagate(Literals{}, state, nullptr));
+    CHECK(state.upper_bound(x) == 3_i);
+    CHECK(order == "EUBEUB");
+}
+
+namespace
+{
+    // What a propagator was told by its DomainDelta on one run.
+    struct SeenDelta
+    {
+        bool everything_changed;
+        bool backtracked;
+        std::vector<DomainDeltaEntry> changed;
+    };
+
+    // A propagator that watches x and y, and only notes what its delta says.
+    auto install_delta_observer(
+        Propagators & propagators, SimpleIntegerVariableID x, SimpleIntegerVariableID y, std::vector<SeenDelta> & seen) -> void
+    {
+        Triggers triggers;
+        triggers.on_change = {x, y};
+        propagators.install(
+            ConstraintID{NumberedConstraint{1}},
+            [&seen](const State &, auto &, ProofLogger * const, const DomainDelta & delta) -> PropagatorState {
+                seen.push_back(SeenDelta{delta.everything_changed(), delta.backtracked(), {delta.changed().begin(), delta.changed().end()}});
+                return PropagatorState::Enable;
+            },
+            triggers);
+    }
+
+    // A propagator that caps x at 7 once y is at most 5.
+    auto install_x_capper(Propagators & propagators, SimpleIntegerVariableID x, SimpleIntegerVariableID y) -> void
+    {
+        Triggers triggers;
+        triggers.on_change = {y};
+        propagators.install(
+            ConstraintID{NumberedConstraint{2}},
+            [x, y](const State & state, auto & inference, ProofLogger * const logger) -> PropagatorState {
+                if (state.upper_bound(y) <= 5_i && state.upper_bound(x) > 7_i)
+                    inference.infer(logger, x < 8_i, NoJustificationNeeded{}, NoReason{});
+                return PropagatorState::Enable;
+            },
+            triggers);
+    }
+}
+
+TEST_CASE("A DomainDelta says everything changed on the first run")
+{
+    State state;
+    Stats stats;
+    Propagators propagators{stats};
+    auto x = state.allocate_integer_variable_with_state(0_i, 10_i);
+    auto y = state.allocate_integer_variable_with_state(0_i, 10_i);
+
+    std::vector<SeenDelta> seen;
+    install_delta_observer(propagators, x, y, seen);
+
+    REQUIRE(propagators.propagate(Literals{}, state, nullptr));
+    REQUIRE(seen.size() == 1);
+    CHECK(seen[0].everything_changed);
+    CHECK(seen[0].changed.empty());
+}
+
+TEST_CASE("A DomainDelta lists guesses and other propagators' changes, with old bounds")
+{
+    State state;
+    Stats stats;
+    Propagators propagators{stats};
+    auto x = state.allocate_integer_variable_with_state(0_i, 10_i);
+    auto y = state.allocate_integer_variable_with_state(0_i, 10_i);
+
+    std::vector<SeenDelta> seen;
+    install_delta_observer(propagators, x, y, seen);
+    install_x_capper(propagators, x, y);
+    REQUIRE(propagators.propagate(Literals{}, state, nullptr));
+    REQUIRE(seen.size() == 1);
+
+    auto timestamp = state.new_epoch();
+    state.guess(y < 6_i);
+    REQUIRE(propagators.propagate(Literals{y < 6_i}, state, nullptr));
+    CHECK(state.upper_bound(x) == 7_i);
+
+    // The guess wakes the observer and the capper together. The observer
+    // runs first and hears about the guess on y, and then about the capper's
+    // change to x, which only changed a bound.
+    REQUIRE(seen.size() == 3);
+    CHECK(! seen[1].everything_changed);
+    CHECK(! seen[1].backtracked);
+    REQUIRE(seen[1].changed.size() == 1);
+    CHECK(seen[1].changed[0].position == 1);
+    CHECK(seen[1].changed[0].old_lower == 0_i);
+    CHECK(seen[1].changed[0].old_upper == 10_i);
+    CHECK(! seen[1].changed[0].bounds_only);
+    REQUIRE(seen[2].changed.size() == 1);
+    CHECK(seen[2].changed[0].position == 0);
+    CHECK(seen[2].changed[0].old_upper == 10_i);
+    CHECK(seen[2].changed[0].bounds_only);
+
+    // After a backtrack, the old bounds are those from before the undone
+    // guess, and the observer is told that it backtracked.
+    state.backtrack(timestamp);
+    static_cast<void>(state.new_epoch());
+    state.guess(y < 4_i);
+    REQUIRE(propagators.propagate(Literals{y < 4_i}, state, nullptr));
+    REQUIRE(seen.size() == 5);
+    CHECK(seen[3].backtracked);
+    REQUIRE(seen[3].changed.size() == 1);
+    CHECK(seen[3].changed[0].position == 1);
+    CHECK(seen[3].changed[0].old_upper == 10_i);
+    CHECK(! seen[4].backtracked);
+    REQUIRE(seen[4].changed.size() == 1);
+    CHECK(seen[4].changed[0].position == 0);
+    CHECK(seen[4].changed[0].old_upper == 10_i);
+}
+
+TEST_CASE("A DomainDelta tells an on_bounds watcher about interior removals it was not woken for")
+{
+    State state;
+    Stats stats;
+    Propagators propagators{stats};
+    auto x = state.allocate_integer_variable_with_state(0_i, 10_i);
+    auto y = state.allocate_integer_variable_with_state(0_i, 10_i);
+
+    std::vector<SeenDelta> seen;
+    Triggers observer_triggers;
+    observer_triggers.on_change = {y};
+    observer_triggers.on_bounds = {x};
+    propagators.install(
+        ConstraintID{NumberedConstraint{1}},
+        [&seen](const State &, auto &, ProofLogger * const, const DomainDelta & delta) -> PropagatorState {
+            seen.push_back(SeenDelta{delta.everything_changed(), delta.backtracked(), {delta.changed().begin(), delta.changed().end()}});
+            return PropagatorState::Enable;
+        },
+        observer_triggers);
+
+    // Removes 5 from x, which leaves x's bounds alone, once y is at most 5.
+    Triggers remover_triggers;
+    remover_triggers.on_change = {y};
+    propagators.install(
+        ConstraintID{NumberedConstraint{2}},
+        [x, y](const State & state, auto & inference, ProofLogger * const logger) -> PropagatorState {
+            if (state.upper_bound(y) <= 5_i && state.in_domain(x, 5_i))
+                inference.infer(logger, x != 5_i, NoJustificationNeeded{}, NoReason{});
+            return PropagatorState::Enable;
+        },
+        remover_triggers);
+
+    REQUIRE(propagators.propagate(Literals{}, state, nullptr));
+    REQUIRE(seen.size() == 1);
+
+    static_cast<void>(state.new_epoch());
+    state.guess(y < 6_i);
+    REQUIRE(propagators.propagate(Literals{y < 6_i}, state, nullptr));
+    CHECK(! state.in_domain(x, 5_i));
+    CHECK(state.upper_bound(x) == 10_i);
+
+    // Losing an interior value does not wake the observer through x...
+    REQUIRE(seen.size() == 2);
+
+    // ... but when something else does, x is listed, and not as bounds only.
+    static_cast<void>(state.new_epoch());
+    state.guess(y < 4_i);
+    REQUIRE(propagators.propagate(Literals{y < 4_i}, state, nullptr));
+    REQUIRE(seen.size() == 3);
+    REQUIRE(seen[2].changed.size() == 2);
+    auto x_entry = std::ranges::find_if(seen[2].changed, [](const DomainDeltaEntry & e) { return e.position == 1; });
+    REQUIRE(x_entry != seen[2].changed.end());
+    CHECK(x_entry->old_lower == 0_i);
+    CHECK(x_entry->old_upper == 10_i);
+    CHECK(! x_entry->bounds_only);
+}
+
+TEST_CASE("A DomainDelta still lists a change handed over in a branch that was backtracked off")
+{
+    State state;
+    Stats stats;
+    Propagators propagators{stats};
+    auto x = state.allocate_integer_variable_with_state(0_i, 10_i);
+    auto y = state.allocate_integer_variable_with_state(0_i, 10_i);
+
+    std::vector<SeenDelta> seen;
+    Triggers observer_triggers;
+    observer_triggers.on_change = {y};
+    observer_triggers.on_bounds = {x};
+    propagators.install(
+        ConstraintID{NumberedConstraint{1}},
+        [&seen](const State &, auto &, ProofLogger * const, const DomainDelta & delta) -> PropagatorState {
+            seen.push_back(SeenDelta{delta.everything_changed(), delta.backtracked(), {delta.changed().begin(), delta.changed().end()}});
+            return PropagatorState::Enable;
+        },
+        observer_triggers);
+
+    // Removes 5 from x, which leaves x's bounds alone, once y is at most 5.
+    Triggers remover_triggers;
+    remover_triggers.on_change = {y};
+    propagators.install(
+        ConstraintID{NumberedConstraint{2}},
+        [x, y](const State & state, auto & inference, ProofLogger * const logger) -> PropagatorState {
+            if (state.upper_bound(y) <= 5_i && state.in_domain(x, 5_i))
+                inference.infer(logger, x != 5_i, NoJustificationNeeded{}, NoReason{});
+            return PropagatorState::Enable;
+        },
+        remover_triggers);
+
+    REQUIRE(propagators.propagate(Literals{}, state, nullptr));
+
+    // The removal of 5 from x stays pending, because it does not wake the
+    // observer.
+    static_cast<void>(state.new_epoch());
+    state.guess(y < 6_i);
+    REQUIRE(propagators.propagate(Literals{y < 6_i}, state, nullptr));
+    CHECK(! state.in_domain(x, 5_i));
+    REQUIRE(seen.size() == 2);
+
+    // A child branch hands it over...
+    auto timestamp = state.new_epoch();
+    state.guess(y < 4_i);
+    REQUIRE(propagators.propagate(Literals{y < 4_i}, state, nullptr));
+    REQUIRE(seen.size() == 3);
+    CHECK(seen[2].changed.size() == 2);
+
+    // ... but the removal was made before the child, so once the child is
+    // backtracked off, the next run must hear about it again.
+    state.backtrack(timestamp);
+    CHECK(! state.in_domain(x, 5_i));
+    static_cast<void>(state.new_epoch());
+    state.guess(y < 5_i);
+    REQUIRE(propagators.propagate(Literals{y < 5_i}, state, nullptr));
+    REQUIRE(seen.size() == 4);
+    CHECK(seen[3].backtracked);
+    auto x_entry = std::ranges::find_if(seen[3].changed, [](const DomainDeltaEntry & e) { return e.position == 1; });
+    REQUIRE(x_entry != seen[3].changed.end());
+    CHECK(x_entry->old_lower == 0_i);
+    CHECK(x_entry->old_upper == 10_i);
+    CHECK(! x_entry->bounds_only);
+}
+
+TEST_CASE("Several changes to one variable in a run wake each watcher of any of them once")
+{
+    State state;
+    Stats stats;
+    Propagators propagators{stats};
+    auto x = state.allocate_integer_variable_with_state(0_i, 3_i);
+    auto trigger = state.allocate_integer_variable_with_state(0_i, 1_i);
+
+    // Walk x's upper bound down one step at a time, ending with x fixed.
+    Triggers stepper_triggers;
+    stepper_triggers.on_change = {trigger};
+    propagators.install(
+        ConstraintID{NumberedConstraint{1}},
+        [x, trigger](const State & state, auto & inference, ProofLogger * const logger) -> PropagatorState {
+            if (state.has_single_value(trigger))
+                for (auto upper = state.upper_bound(x); upper > 0_i; upper = state.upper_bound(x))
+                    inference.infer(logger, x < upper, NoJustificationNeeded{}, NoReason{});
+            return PropagatorState::Enable;
+        },
+        stepper_triggers);
+
+    int bounds_runs = 0, instantiated_runs = 0;
+    Triggers bounds_triggers;
+    bounds_triggers.on_bounds = {x};
+    propagators.install(
+        ConstraintID{NumberedConstraint{2}},
+        [&bounds_runs](const State &, auto &, ProofLogger * const) -> PropagatorState {
+            ++bounds_runs;
+            return PropagatorState::Enable;
+        },
+        bounds_triggers);
+    Triggers instantiated_triggers;
+    instantiated_triggers.on_instantiated = {x};
+    propagators.install(
+        ConstraintID{NumberedConstraint{3}},
+        [&instantiated_runs](const State &, auto &, ProofLogger * const) -> PropagatorState {
+            ++instantiated_runs;
+            return PropagatorState::Enable;
+        },
+        instantiated_triggers);
+
+    REQUIRE(propagators.propagate(Literals{}, state, nullptr));
+    CHECK(bounds_runs == 1);
+    CHECK(instantiated_runs == 1);
+
+    static_cast<void>(state.new_epoch());
+    state.guess(trigger == 1_i);
+    REQUIRE(propagators.propagate(Literals{trigger == 1_i}, state, nullptr));
+    CHECK(state.has_single_value(x));
+    CHECK(bounds_runs == 2);
+    CHECK(instantiated_runs == 2);
+}
@@ -0,0 +1,379 @@
+#ifndef GLASGOW_CONSTRAINT_SOLVER_GUARD_GCS_INNARDS_REVERSIBLE_HH
+#define GLASGOW_CONSTRAINT_SOLVER_GUARD_GCS_INNARDS_REVERSIBLE_HH
+
+#include <gcs/integer.hh>
+
+#include <bit>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace gcs::innards
+{
+    /**
+     * \brief The undo log behind the reversible primitives, owned by State.
+     *
+     * Everything here is a flat array of 64-bit words. Writing a word through
+     * set() records its old value the first time it is written in each epoch,
+     * and State::backtrack() puts back whatever was recorded since the epoch
+     * it returns to. So a search node costs O(words written), rather than a
+     * copy of every constraint's state as State::add_constraint_state() does.
+     *
+     * Constraints should not normally use this directly: Reversible,
+     * ReversibleVector, ReversibleBitset and ReversibleSparseSet are built on
+     * it. It is reached through State::reversible_trail(), which is const for
+     * the same reason State::get_constraint_state() is: propagators are given
+     * a const State, and restoring on backtrack is State's business.
+     *
+     * \ingroup Innards
+     */
+    class ReversibleTrail final
+    {
+    private:
+        std::vector<long long> _words;
+        std::vector<unsigned long long> _last_trailed_in;
+        std::vector<std::pair<std::size_t, long long>> _trail;
+        // (trail length, word count) to return to, one per open epoch. Serials
+        // are never reused, so a stale stamp in _last_trailed_in can never
+        // suppress a needed trail entry.
+        std::vector<std::pair<std::size_t, std::size_t>> _marks;
+        unsigned long long _epoch_serial = 0;
+
+    public:
+        /**
+         * \brief Allocate some consecutive words, and return the index of the
+         * first. Words allocated inside search go away on backtracking past
+         * where they were allocated.
+         */
+        [[nodiscard]] auto allocate(std::size_t how_many, long long initial) -> std::size_t
+        {
+            auto result = _words.size();
+            _words.resize(result + how_many, initial);
+            _last_trailed_in.resize(result + how_many, _epoch_serial);
+            return result;
+        }
+
+        [[nodiscard]] auto get(std::size_t word) const -> long long
+        {
+            return _words[word];
+        }
+
+        /**
+         * \brief Write a word, so that backtracking puts its old value back.
+         */
+        auto set(std::size_t word, long long value) -> void
+        {
+            // Changes made at the root need no trail entry, because nothing
+            // can backtrack past the root.
+            if (! _marks.empty() && _last_trailed_in[word] != _epoch_serial) {
+                _last_trailed_in[word] = _epoch_serial;
+                _trail.emplace_back(word, _words[word]);
+            }
+            _words[word] = value;
+        }
+
+        /**
+         * \brief Write a word without trailing it, for data where what a
+         * backtrack would undo does not matter, such as the order of the
+         * elements in a ReversibleSparseSet.
+         */
+        auto set_untrailed(std::size_t word, long long value) -> void
+        {
+            _words[word] = value;
+        }
+
+        /**
+         * \brief Called by State::new_epoch().
+         */
+        auto new_epoch() -> void
+        {
+            _marks.emplace_back(_trail.size(), _words.size());
+            ++_epoch_serial;
+        }
+
+        /**
+         * \brief Called by State::backtrack(), to undo everything since the
+         * new_epoch() that made this many epochs.
+         */
+        auto backtrack(std::size_t when) -> void
+        {
+            if (when >= 1 && when <= _marks.size()) {
+                auto [trail_length, word_count] = _marks[when - 1];
+                while (_trail.size() > trail_length) {
+                    auto [word, old_value] = _trail.back();
+                    _words[word] = old_value;
+                    _trail.pop_back();
+                }
+                _words.resize(word_count);
+                _last_trailed_in.resize(word_count);
+                _marks.resize(when - 1);
+            }
+            ++_epoch_serial;
+        }
+    };
+
+    namespace reversible_detail
+    {
+        template <typename T_>
+        concept WordSized = std::is_integral_v<T_> || std::is_same_v<T_, Integer>;
+
+        template <WordSized T_>
+        [[nodiscard]] constexpr auto to_word(T_ value) -> long long
+        {
+            if constexpr (std::is_same_v<T_, Integer>)
+                return value.raw_value;
+            else
+                return static_cast<long long>(value);
+        }
+
+        template <WordSized T_>
+        [[nodiscard]] constexpr auto from_word(long long word) -> T_
+        {
+            if constexpr (std::is_same_v<T_, Integer>)
+                return Integer{word};
+            else if constexpr (std::is_same_v<T_, bool>)
+                return 0 != word;
+            else
+                return static_cast<T_>(word);
+        }
+    }
+
+    /**
+     * \brief A single integer (an Integer, or any built-in integral type) that
+     * is restored on backtrack.
+     *
+     * This is a handle: copying it gives another name for the same value, and
+     * the value itself lives in the State's ReversibleTrail.
+     *
+     * \ingroup Innards
+     */
+    template <reversible_detail::WordSized T_>
+    class Reversible final
+    {
+    private:
+        std::size_t _word = 0;
+
+    public:
+        Reversible() = default;
+
+        explicit Reversible(ReversibleTrail & trail, T_ initial) : _word(trail.allocate(1, reversible_detail::to_word(initial)))
+        {
+        }
+
+        [[nodiscard]] auto get(const ReversibleTrail & trail) const -> T_
+        {
+            return reversible_detail::from_word<T_>(trail.get(_word));
+        }
+
+        auto set(ReversibleTrail & trail, T_ value) const -> void
+        {
+            trail.set(_word, reversible_detail::to_word(value));
+        }
+    };
+
+    /**
+     * \brief A fixed-length array of integers, each of which is restored on
+     * backtrack, and only trailed if it is written.
+     *
+     * A handle, like Reversible.
+     *
+     * \ingroup Innards
+     */
+    template <reversible_detail::WordSized T_>
+    class ReversibleVector final
+    {
+    private:
+        std::size_t _first_word = 0, _size = 0;
+
+    public:
+        ReversibleVector() = default;
+
+        explicit ReversibleVector(ReversibleTrail & trail, std::size_t size, T_ initial) :
+            _first_word(trail.allocate(size, reversible_detail::to_word(initial))),
+            _size(size)
+        {
+        }
+
+        [[nodiscard]] auto size() const -> std::size_t
+        {
+            return _size;
+        }
+
+        [[nodiscard]] auto get(const ReversibleTrail & trail, std::size_t i) const -> T_
+        {
+            return reversible_detail::from_word<T_>(trail.get(_first_word + i));
+        }
+
+        auto set(ReversibleTrail & trail, std::size_t i, T_ value) const -> void
+        {
+            trail.set(_first_word + i, reversible_detail::to_word(value));
+        }
+    };
+
+    /**
+     * \brief A fixed-size set of bits, all initially clear, that is restored
+     * on backtrack. Only the 64-bit words that are written are trailed.
+     *
+     * A handle, like Reversible.
+     *
+     * \ingroup Innards
+     */
+    class ReversibleBitset final
+    {
+    private:
+        std::size_t _first_word = 0, _size = 0;
+
+        [[nodiscard]] auto word_of(const ReversibleTrail & trail, std::size_t i) const -> unsigned long long
+        {
+            return std::bit_cast<unsigned long long>(trail.get(_first_word + i / 64));
+        }
+
+        auto set_word_of(ReversibleTrail & trail, std::size_t i, unsigned long long word) const -> void
+        {
+            trail.set(_first_word + i / 64, std::bit_cast<long long>(word));
+        }
+
+    public:
+        ReversibleBitset() = default;
+
+        explicit ReversibleBitset(ReversibleTrail & trail, std::size_t size) : _first_word(trail.allocate((size + 63) / 64, 0)), _size(size)
+        {
+        }
+
+        [[nodiscard]] auto size() const -> std::size_t
+        {
+            return _size;
+        }
+
+        [[nodiscard]] auto test(const ReversibleTrail & trail, std::size_t i) const -> bool
+        {
+            return word_of(trail, i) & (1ull << (i % 64));
+        }
+
+        auto set(ReversibleTrail & trail, std::size_t i) const -> void
+        {
+            auto word = word_of(trail, i);
+            if (! (word & (1ull << (i % 64))))
+                set_word_of(trail, i, word | (1ull << (i % 64)));
+        }
+
+        auto reset(ReversibleTrail & trail, std::size_t i) const -> void
+        {
+            auto word = word_of(trail, i);
+            if (word & (1ull << (i % 64)))
+                set_word_of(trail, i, word & ~(1ull << (i % 64)));
+        }
+
+        [[nodiscard]] auto count(const ReversibleTrail & trail) const -> std::size_t
+        {
+            std::size_t result = 0;
+            for (std::size_t w = 0; w < (_size + 63) / 64; ++w)
+                result += std::popcount(std::bit_cast<unsigned long long>(trail.get(_first_word + w)));
+            return result;
+        }
+    };
+
+    /**
+     * \brief A set of the values 0 to n - 1, initially full, that supports
+     * constant-time membership, removal, and iteration over what is left, and
+     * that is restored on backtrack by trailing a single word.
+     *
+     * The members are kept at the front of a permutation of the values, so
+     * removing one swaps it past the end of the live prefix and shrinks the
+     * prefix. Only the prefix length is trailed: the permutation itself is
+     * written untrailed, because restoring the length brings back exactly the
+     * values that were removed, in whatever order.
+     *
+     * Removing during iteration by position works like swap-and-pop on a
+     * vector: after erase_at(k), position k holds what was the last member, so
+     * do not advance past it.
+     *
+     * A handle, like Reversible.
+     *
+     * \ingroup Innards
+     */
+    class ReversibleSparseSet final
+    {
+    private:
+        // _size words of dense, then _size words of sparse (the position of
+        // each value in dense), then the trailed live prefix length.
+        std::size_t _first_word = 0, _size = 0;
+
+        [[nodiscard]] auto dense(const ReversibleTrail & trail, std::size_t position) const -> std::size_t
+        {
+            return static_cast<std::size_t>(trail.get(_first_word + position));
+        }
+
+        [[nodiscard]] auto sparse(const ReversibleTrail & trail, std::size_t value) const -> std::size_t
+        {
+            return static_cast<std::size_t>(trail.get(_first_word + _size + value));
+        }
+
+        auto swap_positions(ReversibleTrail & trail, std::size_t p, std::size_t q) const -> void
+        {
+            auto v = dense(trail, p), w = dense(trail, q);
+            trail.set_untrailed(_first_word + p, static_cast<long long>(w));
+            trail.set_untrailed(_first_word + q, static_cast<long long>(v));
+            trail.set_untrailed(_first_word + _size + v, static_cast<long long>(q));
+            trail.set_untrailed(_first_word + _size + w, static_cast<long long>(p));
+        }
+
+    public:
+        ReversibleSparseSet() = default;
+
+        explicit ReversibleSparseSet(ReversibleTrail & trail, std::size_t size) : _first_word(trail.allocate(2 * size + 1, 0)), _size(size)
+        {
+            for (std::size_t v = 0; v < size; ++v) {
+                trail.set_untrailed(_first_word + v, static_cast<long long>(v));
+                trail.set_untrailed(_first_word + size + v, static_cast<long long>(v));
+            }
+            trail.set_untrailed(_first_word + 2 * size, static_cast<long long>(size));
+        }
+
+        /**
+         * \brief How many values are still members.
+         */
+        [[nodiscard]] auto size(const ReversibleTrail & trail) const -> std::size_t
+        {
+            return static_cast<std::size_t>(trail.get(_first_word + 2 * _size));
+        }
+
+        /**
+         * \brief The member at the given position, which must be less than
+         * size().
+         */
+        [[nodiscard]] auto at(const ReversibleTrail & trail, std::size_t position) const -> std::size_t
+        {
+            return dense(trail, position);
+        }
+
+        [[nodiscard]] auto contains(const ReversibleTrail & trail, std::size_t value) const -> bool
+        {
+            return sparse(trail, value) < size(trail);
+        }
+
+        /**
+         * \brief Remove the member at the given position, moving the last
+         * member into its place.
+         */
+        auto erase_at(ReversibleTrail & trail, std::size_t position) const -> void
+        {
+            auto last = size(trail) - 1;
+            if (position != last)
+                swap_positions(trail, position, last);
+            trail.set(_first_word + 2 * _size, static_cast<long long>(last));
+        }
+
+        /**
+         * \brief Remove a value, if it is a member.
+         */
+        auto erase(ReversibleTrail & trail, std::size_t value) const -> void
+        {
+            if (contains(trail, value))
+                erase_at(trail, sparse(trail, value));
+        }
+    };
+}
+
+#endif
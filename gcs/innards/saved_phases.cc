@@ -0,0 +1,95 @@
+#include <gcs/innards/saved_phases.hh>
+
+#include <util/overloaded.hh>
+
+#include <utility>
+
+using namespace gcs;
+using namespace gcs::innards;
+
+using std::nullopt;
+using std::optional;
+using std::pair;
+using std::size_t;
+using std::uint8_t;
+using std::vector;
+
+namespace
+{
+    // A value for var, in terms of the variable underneath it, and where that
+    // variable is kept, or nullopt for a constant, which has nothing to save.
+    auto underlying(const IntegerVariableID & var, Integer value) -> optional<pair<size_t, Integer>>
+    {
+        return overloaded{//
+            [&](const SimpleIntegerVariableID & v) -> optional<pair<size_t, Integer>> { return pair{v.index, value}; },
+            [&](const ViewOfIntegerVariableID & v) -> optional<pair<size_t, Integer>> {
+                auto actual = value - v.then_add;
+                return pair{v.actual_variable.index, v.negate_first ? -actual : actual};
+            },
+            [&](const ConstantIntegerVariableID &) -> optional<pair<size_t, Integer>> { return nullopt; }}
+            .visit(var);
+    }
+
+    // And the other way, for reading a value back out.
+    auto read(const IntegerVariableID & var, const vector<Integer> & values, const vector<uint8_t> & has_value) -> optional<Integer>
+    {
+        return overloaded{//
+            [&](const SimpleIntegerVariableID & v) -> optional<Integer> {
+                if (v.index >= has_value.size() || ! has_value[v.index])
+                    return nullopt;
+                return values[v.index];
+            },
+            [&](const ViewOfIntegerVariableID & v) -> optional<Integer> {
+                auto i = v.actual_variable.index;
+                if (i >= has_value.size() || ! has_value[i])
+                    return nullopt;
+                return (v.negate_first ? -values[i] : values[i]) + v.then_add;
+            },
+            [&](const ConstantIntegerVariableID & c) -> optional<Integer> { return c.const_value; }}
+            .visit(var);
+    }
+
+    auto write(size_t index, Integer value, vector<Integer> & values, vector<uint8_t> & has_value) -> void
+    {
+        if (values.size() <= index) {
+            values.resize(index + 1, 0_i);
+            has_value.resize(index + 1, 0);
+        }
+        values[index] = value;
+        has_value[index] = 1;
+    }
+}
+
+auto SavedPhases::start_recording() -> void
+{
+    _recording = true;
+}
+
+auto SavedPhases::recording() const -> bool
+{
+    return _recording;
+}
+
+auto SavedPhases::save(const IntegerVariableID & var, Integer value) -> void
+{
+    if (auto u = underlying(var, value))
+        write(u->first, u->second, _last_values, _has_last_value);
+}
+
+auto SavedPhases::save_solution_value(const IntegerVariableID & var, Integer value) -> void
+{
+    if (auto u = underlying(var, value)) {
+        write(u->first, u->second, _last_values, _has_last_value);
+        write(u->first, u->second, _solution_values, _has_solution_value);
+    }
+}
+
+auto SavedPhases::last_value(const IntegerVariableID & var) const -> optional<Integer>
+{
+    return read(var, _last_values, _has_last_value);
+}
+
+auto SavedPhases::solution_value(const IntegerVariableID & var) const -> optional<Integer>
+{
+    return read(var, _solution_values, _has_solution_value);
+}
@@ -0,0 +1,74 @@
+#ifndef GLASGOW_CONSTRAINT_SOLVER_GUARD_GCS_INNARDS_SAVED_PHASES_HH
+#define GLASGOW_CONSTRAINT_SOLVER_GUARD_GCS_INNARDS_SAVED_PHASES_HH
+
+#include <gcs/integer.hh>
+#include <gcs/variable_id.hh>
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace gcs::innards
+{
+    /**
+     * \brief For each variable, the value that search last gave it, and its
+     * value in the most recent solution, owned by State.
+     *
+     * Search saves the value of every `==` decision it makes, and every value
+     * of each solution it finds, and neither backtracking nor a restart
+     * forgets them. This is what gcs::value_order::phase_saving() and
+     * gcs::value_order::solution_guided() branch on. Values are kept for the
+     * variable underneath any view, in arrays indexed by variable, so that
+     * saving one at every node costs no more than a write to a vector. Even
+     * so, search only saves anything once one of those value orders has
+     * called start_recording(), so that no other search pays for a copy of
+     * every solution.
+     *
+     * \ingroup Innards
+     * \sa gcs::value_order::phase_saving()
+     * \sa gcs::value_order::solution_guided()
+     */
+    class SavedPhases final
+    {
+    private:
+        std::vector<Integer> _last_values, _solution_values;
+        std::vector<std::uint8_t> _has_last_value, _has_solution_value;
+        bool _recording = false;
+
+    public:
+        /**
+         * \brief Ask search to save values from now on, for a heuristic that
+         * reads them.
+         */
+        auto start_recording() -> void;
+
+        /**
+         * \brief Has anything asked for values to be saved?
+         */
+        [[nodiscard]] auto recording() const -> bool;
+
+        /**
+         * \brief Remember that search has just given \p var the value \p value.
+         */
+        auto save(const IntegerVariableID & var, Integer value) -> void;
+
+        /**
+         * \brief Remember that \p var has the value \p value in the solution
+         * just found, which also counts as the value search last gave it.
+         */
+        auto save_solution_value(const IntegerVariableID & var, Integer value) -> void;
+
+        /**
+         * \brief The value that search last gave \p var, if it ever has.
+         */
+        [[nodiscard]] auto last_value(const IntegerVariableID & var) const -> std::optional<Integer>;
+
+        /**
+         * \brief The value of \p var in the most recent solution, if there has
+         * been one.
+         */
+        [[nodiscard]] auto solution_value(const IntegerVariableID & var) const -> std::optional<Integer>;
+    };
+}
+
+#endif
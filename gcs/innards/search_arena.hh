@@ -0,0 +1,200 @@
+#ifndef GLASGOW_CONSTRAINT_SOLVER_GUARD_GCS_INNARDS_SEARCH_ARENA_HH
+#define GLASGOW_CONSTRAINT_SOLVER_GUARD_GCS_INNARDS_SEARCH_ARENA_HH
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace gcs::innards
+{
+    /**
+     * \brief A stack-like arena for memory that lives no longer than a search
+     * node, owned by State.
+     *
+     * Allocating bumps a pointer through a list of blocks, and freeing does
+     * nothing: instead, State::new_epoch() records how far into which block we
+     * had got, and State::backtrack() goes back there. Blocks are kept once
+     * they are made, so after the first descent to a given depth, search
+     * allocates from memory that it has already used, and the heap is only
+     * touched again if a node needs more than any before it. This is what the
+     * built-in branching heuristics allocate their coroutine frames from.
+     *
+     * Anything allocated here must be dead by the time State::backtrack()
+     * returns past the epoch that was open when it was allocated. Memory
+     * allocated before the first new_epoch() is only given back by
+     * release_to() or by destroying the State.
+     *
+     * \ingroup Innards
+     * \sa SearchArenaAllocator
+     */
+    class SearchArena final
+    {
+    private:
+        struct Block
+        {
+            std::unique_ptr<std::byte[]> memory;
+            std::size_t size;
+        };
+
+        static constexpr std::size_t default_block_size = 64 * 1024;
+
+        std::vector<Block> _blocks;
+        std::size_t _block = 0, _used = 0;
+        // (block, bytes used in it) to return to, one per open epoch.
+        std::vector<std::pair<std::size_t, std::size_t>> _marks;
+        unsigned long long _allocations = 0, _heap_allocations = 0;
+
+    public:
+        /**
+         * \brief Where we have got to, for release_to().
+         */
+        struct Mark
+        {
+            std::size_t block, used;
+        };
+
+        SearchArena() = default;
+
+        /**
+         * A copy of a State is given a fresh arena, because nothing in the
+         * original's is in use by the copy.
+         */
+        SearchArena(const SearchArena &)
+        {
+        }
+
+        auto operator=(const SearchArena &) -> SearchArena &
+        {
+            return *this;
+        }
+
+        SearchArena(SearchArena &&) noexcept = default;
+        auto operator=(SearchArena &&) noexcept -> SearchArena & = default;
+
+        /**
+         * \brief Allocate some bytes, which stay valid until we backtrack or
+         * release past this point.
+         */
+        [[nodiscard]] auto allocate(std::size_t bytes, std::size_t alignment) -> void *
+        {
+            ++_allocations;
+            for (;; ++_block, _used = 0) {
+                if (_block == _blocks.size()) {
+                    auto size = std::max(default_block_size, bytes + alignment);
+                    _blocks.push_back(Block{std::make_unique_for_overwrite<std::byte[]>(size), size});
+                    ++_heap_allocations;
+                }
+
+                auto & block = _blocks[_block];
+                auto base = reinterpret_cast<std::uintptr_t>(block.memory.get());
+                auto start = ((base + _used + alignment - 1) & ~(alignment - 1)) - base;
+                if (start + bytes <= block.size) {
+                    _used = start + bytes;
+                    return block.memory.get() + start;
+                }
+            }
+        }
+
+        [[nodiscard]] auto mark() const -> Mark
+        {
+            return Mark{_block, _used};
+        }
+
+        /**
+         * \brief Give back everything allocated since mark() returned \p m.
+         */
+        auto release_to(const Mark & m) -> void
+        {
+            _block = m.block;
+            _used = m.used;
+        }
+
+        /**
+         * \brief Called by State::new_epoch().
+         */
+        auto new_epoch() -> void
+        {
+            _marks.emplace_back(_block, _used);
+        }
+
+        /**
+         * \brief Called by State::backtrack(), to give back everything allocated
+         * since the new_epoch() that made this many epochs.
+         */
+        auto backtrack(std::size_t when) -> void
+        {
+            if (when >= 1 && when <= _marks.size()) {
+                std::tie(_block, _used) = _marks[when - 1];
+                _marks.resize(when - 1);
+            }
+        }
+
+        /**
+         * \brief How many allocations we have served.
+         */
+        [[nodiscard]] auto allocations() const -> unsigned long long
+        {
+            return _allocations;
+        }
+
+        /**
+         * \brief How many of those needed a new block from the heap.
+         */
+        [[nodiscard]] auto heap_allocations() const -> unsigned long long
+        {
+            return _heap_allocations;
+        }
+    };
+
+    /**
+     * \brief A standard allocator over a SearchArena, whose deallocate() does
+     * nothing.
+     *
+     * Passed as std::allocator_arg, allocator to a std::generator coroutine,
+     * this puts the coroutine's frame in the arena.
+     *
+     * \ingroup Innards
+     */
+    template <typename T_>
+    class SearchArenaAllocator
+    {
+    private:
+        template <typename>
+        friend class SearchArenaAllocator;
+
+        SearchArena * _arena;
+
+    public:
+        using value_type = T_;
+
+        explicit SearchArenaAllocator(SearchArena & arena) : _arena(&arena)
+        {
+        }
+
+        template <typename U_>
+        SearchArenaAllocator(const SearchArenaAllocator<U_> & other) : _arena(other._arena)
+        {
+        }
+
+        [[nodiscard]] auto allocate(std::size_t n) -> T_ *
+        {
+            return static_cast<T_ *>(_arena->allocate(n * sizeof(T_), alignof(T_)));
+        }
+
+        auto deallocate(T_ *, std::size_t) -> void
+        {
+        }
+
+        template <typename U_>
+        [[nodiscard]] auto operator==(const SearchArenaAllocator<U_> & other) const -> bool
+        {
+            return _arena == other._arena;
+        }
+    };
+}
+
+#endif
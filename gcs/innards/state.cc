@@ -6,7 +6,9 @@
 #include <util/overloaded.hh>
 
 #include <algorithm>
-#include <list>
+#include <array>
+#include <cstddef>
+#include <span>
 #include <string>
 #include <tuple>
 #include <utility>
@@ -16,16 +18,17 @@
 using namespace gcs;
 using namespace gcs::innards;
 
+using std::array;
 using std::function;
-using std::generator;
 using std::get_if;
-using std::list;
 using std::make_optional;
 using std::make_unique;
 using std::move;
 using std::nullopt;
 using std::optional;
 using std::pair;
+using std::size_t;
+using std::span;
 using std::string;
 using std::tuple;
 using std::vector;
@@ -85,15 +88,105 @@ namespace
         }
             .visit(v);
     }
+
+    // A stack of per-epoch entries whose popped entries are kept for the next
+    // push to reuse, so that once search has been to a given depth,
+    // new_epoch() copies into storage an earlier node already grew rather
+    // than allocating afresh. Only the open entries are copied with it.
+    template <typename T_>
+    class EpochStack
+    {
+    private:
+        vector<T_> _entries;
+        size_t _open = 0;
+
+    public:
+        EpochStack() = default;
+
+        EpochStack(const EpochStack & other) : _entries(other._entries.begin(), other._entries.begin() + other._open), _open(other._open)
+        {
+        }
+
+        auto operator=(const EpochStack & other) -> EpochStack &
+        {
+            _entries.assign(other._entries.begin(), other._entries.begin() + other._open);
+            _open = other._open;
+            return *this;
+        }
+
+        [[nodiscard]] auto size() const -> size_t
+        {
+            return _open;
+        }
+
+        [[nodiscard]] auto back() -> T_ &
+        {
+            return _entries[_open - 1];
+        }
+
+        auto emplace_back() -> void
+        {
+            if (_open == _entries.size())
+                _entries.emplace_back();
+            else
+                _entries[_open].clear();
+            ++_open;
+        }
+
+        auto push_copy_of_back() -> void
+        {
+            if (_open == _entries.size())
+                _entries.push_back(_entries[_open - 1]);
+            else
+                _entries[_open] = _entries[_open - 1];
+            ++_open;
+        }
+
+        auto pop_back() -> void
+        {
+            --_open;
+        }
+
+        auto pop_back_to(size_t how_many) -> void
+        {
+            _open = std::min(_open, how_many);
+        }
+    };
 }
 
 struct State::Imp
 {
     ProofLogger * maybe_proof_logger;
 
-    list<vector<IntervalSet<Integer>>> integer_variable_states{};
-    list<vector<ConstraintState>> constraint_states{};
-    list<vector<function<auto()->void>>> on_backtracks{};
+    EpochStack<vector<IntervalSet<Integer>>> integer_variable_states{};
+    EpochStack<vector<ConstraintState>> constraint_states{};
+
+    // BacktrackingMode::Trail keeps a single entry in integer_variable_states,
+    // and instead records (variable index, old domain) here on the first change
+    // to a variable in each epoch. Each new_epoch() pushes the trail length and
+    // variable count to return to; last_trailed_in says in which epoch serial a
+    // variable was last trailed. Serials are never reused (backtrack() takes a
+    // fresh one too), so a stale stamp can never suppress a needed entry.
+    //
+    // BacktrackingMode::CopyEveryEpoch throws its copies of the domains away on
+    // backtrack, but the bounds arrays are undone from bounds_trail in just the
+    // same way, so that a backtrack costs only the variables that changed. In
+    // that mode, the trail lengths in domain_trail_marks are of bounds_trail.
+    struct OldBounds
+    {
+        unsigned long index;
+        Integer lower, upper;
+        std::uint8_t is_interval;
+    };
+
+    bool trailing = false;
+    vector<pair<unsigned long, IntervalSet<Integer>>> domain_trail{};
+    vector<OldBounds> bounds_trail{};
+    vector<pair<unsigned long long, unsigned long long>> domain_trail_marks{};
+    vector<unsigned long long> last_trailed_in{};
+    unsigned long long current_epoch_serial = 0;
+
+    EpochStack<vector<function<auto()->void>>> on_backtracks{};
     vector<Literal> guesses{};
     vector<Literal> extra_proof_conditions{};
 
@@ -108,7 +201,14 @@ State::State() : _imp(make_unique<Imp>())
     _imp->on_backtracks.emplace_back();
 }
 
-State::State(State && other) noexcept : _imp(move(other._imp))
+State::State(State && other) noexcept :
+    _imp(move(other._imp)),
+    _reversible_trail(move(other._reversible_trail)),
+    _search_arena(move(other._search_arena)),
+    _saved_phases(move(other._saved_phases)),
+    _lower_bounds(move(other._lower_bounds)),
+    _upper_bounds(move(other._upper_bounds)),
+    _domain_is_interval(move(other._domain_is_interval))
 {
 }
 
@@ -120,9 +220,19 @@ auto State::clone() const -> State
     result._imp->integer_variable_states = _imp->integer_variable_states;
     result._imp->constraint_states = _imp->constraint_states;
     result._imp->on_backtracks = _imp->on_backtracks;
+    result._imp->trailing = _imp->trailing;
+    result._imp->domain_trail = _imp->domain_trail;
+    result._imp->bounds_trail = _imp->bounds_trail;
+    result._imp->domain_trail_marks = _imp->domain_trail_marks;
+    result._imp->last_trailed_in = _imp->last_trailed_in;
+    result._imp->current_epoch_serial = _imp->current_epoch_serial;
     result._imp->optional_minimise_variable = _imp->optional_minimise_variable;
     result._imp->optional_objective_incumbent = _imp->optional_objective_incumbent;
     result._imp->maybe_proof_logger = _imp->maybe_proof_logger;
+    result._reversible_trail = _reversible_trail;
+    result._lower_bounds = _lower_bounds;
+    result._upper_bounds = _upper_bounds;
+    result._domain_is_interval = _domain_is_interval;
     return result;
 }
 
@@ -131,6 +241,10 @@ auto State::allocate_integer_variable_with_state(Integer lower, Integer upper) -
     if (lower > upper)
         throw InvalidProblemDefinitionException{"variable created with lower bound greater than upper bound"};
     _imp->integer_variable_states.back().emplace_back(lower, upper);
+    _lower_bounds.push_back(lower);
+    _upper_bounds.push_back(upper);
+    _domain_is_interval.push_back(1);
+    _imp->last_trailed_in.push_back(0);
     return SimpleIntegerVariableID{_imp->integer_variable_states.back().size() - 1};
 }
 
@@ -139,6 +253,35 @@ auto State::what_variable_id_will_be_created_next() const -> SimpleIntegerVariab
     return SimpleIntegerVariableID{_imp->integer_variable_states.back().size()};
 }
 
+auto State::set_backtracking_mode(BacktrackingMode mode) -> void
+{
+    if (_imp->constraint_states.size() != 1)
+        throw UnexpectedException{"can only change backtracking mode outside of search"};
+
+    _imp->trailing = (mode == BacktrackingMode::Trail);
+    _imp->last_trailed_in.assign(_imp->integer_variable_states.back().size(), 0);
+}
+
+auto State::remember_before_change(const SimpleIntegerVariableID & v) -> void
+{
+    // Changes made at the root need no trail entry, because nothing can
+    // backtrack past the root.
+    if (! _imp->domain_trail_marks.empty() && _imp->last_trailed_in[v.index] != _imp->current_epoch_serial) {
+        _imp->last_trailed_in[v.index] = _imp->current_epoch_serial;
+        if (_imp->trailing)
+            _imp->domain_trail.emplace_back(v.index, state_of(v));
+        else
+            _imp->bounds_trail.push_back({v.index, _lower_bounds[v.index], _upper_bounds[v.index], _domain_is_interval[v.index]});
+    }
+}
+
+auto State::note_domain_changed(const SimpleIntegerVariableID & v, const IntervalSet<Integer> & set) -> void
+{
+    _lower_bounds[v.index] = set.lower();
+    _upper_bounds[v.index] = set.upper();
+    _domain_is_interval[v.index] = ! set.has_holes();
+}
+
 auto State::state_of(const SimpleIntegerVariableID & v) -> IntervalSet<Integer> &
 {
     return _imp->integer_variable_states.back()[v.index];
@@ -161,8 +304,10 @@ auto State::change_state_for_equal(const SimpleIntegerVariableID & var, Integer
         return Inference::Contradiction;
     if (set.lower() == set.upper())
         return Inference::NoChange;
+    remember_before_change(var);
     set.clear();
     set.insert_at_end(value);
+    note_domain_changed(var, set);
     return Inference::Instantiated;
 }
 
@@ -174,7 +319,9 @@ auto State::change_state_for_not_equal(const SimpleIntegerVariableID & var, Inte
     if (set.lower() == set.upper())
         return Inference::Contradiction;
     bool is_bound = (value == set.lower() || value == set.upper());
+    remember_before_change(var);
     set.erase(value);
+    note_domain_changed(var, set);
     if (set.lower() == set.upper())
         return Inference::Instantiated;
     return is_bound ? Inference::BoundsChanged : Inference::InteriorValuesChanged;
@@ -185,9 +332,11 @@ auto State::change_state_for_less_than(const SimpleIntegerVariableID & var, Inte
     auto & set = state_of(var);
     if (set.upper() < value)
         return Inference::NoChange;
+    remember_before_change(var);
     set.erase_greater_than(value - 1_i);
     if (set.empty())
         return Inference::Contradiction;
+    note_domain_changed(var, set);
     if (set.lower() == set.upper())
         return Inference::Instantiated;
     return Inference::BoundsChanged;
@@ -198,9 +347,11 @@ auto State::change_state_for_greater_than_or_equal(const SimpleIntegerVariableID
     auto & set = state_of(var);
     if (set.lower() >= value)
         return Inference::NoChange;
+    remember_before_change(var);
     set.erase_less_than(value);
     if (set.empty())
         return Inference::Contradiction;
+    note_domain_changed(var, set);
     if (set.lower() == set.upper())
         return Inference::Instantiated;
     return Inference::BoundsChanged;
@@ -219,9 +370,11 @@ auto State::change_state_for_not_in_range(const SimpleIntegerVariableID & var, I
         return Inference::NoChange;
     if (! set.contains_any_of(IntervalSet<Integer>{lo, hi}))
         return Inference::NoChange;
+    remember_before_change(var);
     set.erase_range(lo, hi);
     if (set.empty())
         return Inference::Contradiction;
+    note_domain_changed(var, set);
     if (set.lower() == set.upper())
         return Inference::Instantiated;
     return (set.lower() != old_lower || set.upper() != old_upper) ? Inference::BoundsChanged : Inference::InteriorValuesChanged;
@@ -235,11 +388,13 @@ auto State::change_state_for_in_range(const SimpleIntegerVariableID & var, Integ
     auto old_lower = set.lower(), old_upper = set.upper();
     if (old_lower >= lo && old_upper <= hi)
         return Inference::NoChange;
+    remember_before_change(var);
     set.erase_less_than(lo);
     if (! set.empty())
         set.erase_greater_than(hi);
     if (set.empty())
         return Inference::Contradiction;
+    note_domain_changed(var, set);
     if (set.lower() == set.upper())
         return Inference::Instantiated;
     return Inference::BoundsChanged;
@@ -409,11 +564,11 @@ auto State::lower_bound(const IntegerVariableID var) const -> Integer
     // bound directly. This skips two std::variant visits (deview then the
     // overloaded visit), which profiling showed to dominate per-node time.
     if (const auto * simple = get_if<SimpleIntegerVariableID>(&var))
-        return state_of(*simple).lower();
+        return _lower_bounds[simple->index];
     auto [actual_var, negate_first, then_add] = deview(var);
     auto raw = overloaded{
-        [&](const SimpleIntegerVariableID & v) { return negate_first ? state_of(v).upper() : state_of(v).lower(); }, //
-        [&](const ConstantIntegerVariableID & v) { return v.const_value; }                                           //
+        [&](const SimpleIntegerVariableID & v) { return negate_first ? _upper_bounds[v.index] : _lower_bounds[v.index]; }, //
+        [&](const ConstantIntegerVariableID & v) { return v.const_value; }                                                  //
     }
                    .visit(actual_var);
     return (negate_first ? -raw : raw) + then_add;
@@ -422,11 +577,11 @@ auto State::lower_bound(const IntegerVariableID var) const -> Integer
 auto State::upper_bound(const IntegerVariableID var) const -> Integer
 {
     if (const auto * simple = get_if<SimpleIntegerVariableID>(&var))
-        return state_of(*simple).upper();
+        return _upper_bounds[simple->index];
     auto [actual_var, negate_first, then_add] = deview(var);
     auto raw = overloaded{
-        [&](const SimpleIntegerVariableID & v) { return negate_first ? state_of(v).lower() : state_of(v).upper(); }, //
-        [&](const ConstantIntegerVariableID & v) { return v.const_value; }                                           //
+        [&](const SimpleIntegerVariableID & v) { return negate_first ? _lower_bounds[v.index] : _upper_bounds[v.index]; }, //
+        [&](const ConstantIntegerVariableID & v) { return v.const_value; }                                                  //
     }
                    .visit(actual_var);
     return (negate_first ? -raw : raw) + then_add;
@@ -440,14 +595,12 @@ auto State::bounds(const VarType_ & var) const -> pair<Integer, Integer>
     // IntegerVariableID caller can hold a view or constant; the concrete
     // instantiations already avoid the variant machinery.
     if constexpr (std::is_same_v<VarType_, IntegerVariableID>) {
-        if (const auto * simple = get_if<SimpleIntegerVariableID>(&var)) {
-            const auto & set = state_of(*simple);
-            return pair{set.lower(), set.upper()};
-        }
+        if (const auto * simple = get_if<SimpleIntegerVariableID>(&var))
+            return pair{_lower_bounds[simple->index], _upper_bounds[simple->index]};
     }
     auto [actual_var, negate_first, then_add] = deview(var);
     auto raw = visit_actual(
-        actual_var, [&](const SimpleIntegerVariableID & v) { return pair{state_of(v).lower(), state_of(v).upper()}; },
+        actual_var, [&](const SimpleIntegerVariableID & v) { return pair{_lower_bounds[v.index], _upper_bounds[v.index]}; },
         [&](const ConstantIntegerVariableID & v) { return pair{v.const_value, v.const_value}; });
     if (negate_first)
         return pair{-raw.second + then_add, -raw.first + then_add};
@@ -458,14 +611,19 @@ auto State::bounds(const VarType_ & var) const -> pair<Integer, Integer>
 template <IntegerVariableIDLike VarType_>
 auto State::in_domain(const VarType_ & var, const Integer val) const -> bool
 {
+    // Within the bounds of a domain with no holes is in the domain, so only a
+    // domain with holes needs a search of its intervals.
+    auto contains = [&](const SimpleIntegerVariableID & v, Integer value) {
+        return value >= _lower_bounds[v.index] && value <= _upper_bounds[v.index] && (_domain_is_interval[v.index] || state_of(v).contains(value));
+    };
     if constexpr (std::is_same_v<VarType_, IntegerVariableID>) {
         if (const auto * simple = get_if<SimpleIntegerVariableID>(&var))
-            return state_of(*simple).contains(val);
+            return contains(*simple, val);
     }
     auto [actual_var, negate_first, then_add] = deview(var);
     auto adjusted = (negate_first ? -val + then_add : val - then_add);
     return visit_actual(
-        actual_var, [&](const SimpleIntegerVariableID & v) { return state_of(v).contains(adjusted); },
+        actual_var, [&](const SimpleIntegerVariableID & v) { return contains(v, adjusted); },
         [&](const ConstantIntegerVariableID & v) { return v.const_value == adjusted; });
 }
 
@@ -473,8 +631,8 @@ auto State::domain_has_holes(const IntegerVariableID var) const -> bool
 {
     auto [actual_var, _1, _2] = deview(var);
     return overloaded{
-        [&](const SimpleIntegerVariableID & v) { return state_of(v).has_holes(); }, //
-        [](const ConstantIntegerVariableID &) { return false; }                     //
+        [&](const SimpleIntegerVariableID & v) { return ! _domain_is_interval[v.index]; }, //
+        [](const ConstantIntegerVariableID &) { return false; }                            //
     }
         .visit(actual_var);
 }
@@ -484,9 +642,8 @@ auto State::optional_single_value(const VarType_ & var) const -> optional<Intege
 {
     if constexpr (std::is_same_v<VarType_, IntegerVariableID>) {
         if (const auto * simple = get_if<SimpleIntegerVariableID>(&var)) {
-            const auto & set = state_of(*simple);
-            if (set.lower() == set.upper())
-                return make_optional(set.lower());
+            if (_lower_bounds[simple->index] == _upper_bounds[simple->index])
+                return make_optional(_lower_bounds[simple->index]);
             return nullopt;
         }
     }
@@ -494,9 +651,8 @@ auto State::optional_single_value(const VarType_ & var) const -> optional<Intege
     auto raw = visit_actual(
         actual_var,
         [&](const SimpleIntegerVariableID & v) -> optional<Integer> {
-            const auto & set = state_of(v);
-            if (set.lower() == set.upper())
-                return make_optional(set.lower());
+            if (_lower_bounds[v.index] == _upper_bounds[v.index])
+                return make_optional(_lower_bounds[v.index]);
             return nullopt;
         },
         [&](const ConstantIntegerVariableID & v) -> optional<Integer> { return make_optional(v.const_value); });
@@ -506,14 +662,12 @@ auto State::optional_single_value(const VarType_ & var) const -> optional<Intege
 
 auto State::has_single_value(const IntegerVariableID var) const -> bool
 {
-    if (const auto * simple = get_if<SimpleIntegerVariableID>(&var)) {
-        const auto & set = state_of(*simple);
-        return set.lower() == set.upper();
-    }
+    if (const auto * simple = get_if<SimpleIntegerVariableID>(&var))
+        return _lower_bounds[simple->index] == _upper_bounds[simple->index];
     auto [actual_var, _1, _2] = deview(var);
     return overloaded{
-        [&](const SimpleIntegerVariableID & v) { return state_of(v).lower() == state_of(v).upper(); }, //
-        [](const ConstantIntegerVariableID &) { return true; }                                         //
+        [&](const SimpleIntegerVariableID & v) { return _lower_bounds[v.index] == _upper_bounds[v.index]; }, //
+        [](const ConstantIntegerVariableID &) { return true; }                                               //
     }
         .visit(actual_var);
 }
@@ -545,16 +699,10 @@ auto State::copy_of_values(const VarType_ & var) const -> IntervalSet<Integer>
         // Each stored interval [l, u] becomes [-u + then_add, -l + then_add],
         // and negation reverses the order, so iterate in reverse to keep
         // result intervals sorted for insert_at_end.
-        std::vector<std::pair<Integer, Integer>> intervals;
-        for (auto p : raw.each_interval())
-            intervals.push_back(p);
-        for (auto it = intervals.rbegin(); it != intervals.rend(); ++it)
-            result.insert_at_end(-it->second + then_add, -it->first + then_add);
-    }
-    else {
-        for (const auto & [l, u] : raw.each_interval())
-            result.insert_at_end(l + then_add, u + then_add);
+        raw.for_each_interval_reversed([&](Integer l, Integer u) { result.insert_at_end(-u + then_add, -l + then_add); });
     }
+    else
+        raw.for_each_interval([&](Integer l, Integer u) { result.insert_at_end(l + then_add, u + then_add); });
     return result;
 }
 
@@ -627,44 +775,6 @@ auto State::domains_intersect(const IntegerVariableID & var1, const IntegerVaria
         [&](const ConstantIntegerVariableID & v1) -> bool { return in_domain(var2, v1.const_value + add1); });
 }
 
-namespace
-{
-    auto each_value_generator(IntervalSet<Integer> set, std::function<auto(Integer)->Integer> apply) -> generator<Integer>
-    {
-        for (auto i : set.each())
-            co_yield apply(i);
-    }
-
-    auto each_value_constant_generator(Integer val, std::function<auto(Integer)->Integer> apply) -> generator<Integer>
-    {
-        co_yield apply(val);
-    }
-}
-
-template <IntegerVariableIDLike VarType_>
-auto State::each_value_immutable(const VarType_ & var) const -> generator<Integer>
-{
-    auto [actual_var, negate_first, then_add] = deview(var);
-
-    auto apply = [negate_first = negate_first, then_add = then_add](Integer v) -> Integer { return apply_view(v, negate_first, then_add); };
-
-    return visit_actual(
-        actual_var, [&](const SimpleIntegerVariableID & v) { return each_value_generator(state_of(v), apply); },
-        [&](const ConstantIntegerVariableID & v) { return each_value_constant_generator(v.const_value, apply); });
-}
-
-template <IntegerVariableIDLike VarType_>
-auto State::each_value_mutable(const VarType_ & var) const -> generator<Integer>
-{
-    auto [actual_var, negate_first, then_add] = deview(var);
-
-    auto apply = [negate_first = negate_first, then_add = then_add](Integer v) -> Integer { return apply_view(v, negate_first, then_add); };
-
-    return visit_actual(
-        actual_var, [&](const SimpleIntegerVariableID & v) { return each_value_generator(state_of(v), apply); },
-        [&](const ConstantIntegerVariableID & v) { return each_value_constant_generator(v.const_value, apply); });
-}
-
 auto State::operator()(const IntegerVariableID & i) const -> Integer
 {
     if (auto result = optional_single_value(i))
@@ -674,18 +784,56 @@ auto State::operator()(const IntegerVariableID & i) const -> Integer
 
 auto State::new_epoch(bool subsearch) -> Timestamp
 {
-    _imp->integer_variable_states.push_back(_imp->integer_variable_states.back());
-    _imp->constraint_states.push_back(_imp->constraint_states.back());
+    _imp->domain_trail_marks.emplace_back(
+        _imp->trailing ? _imp->domain_trail.size() : _imp->bounds_trail.size(), _imp->integer_variable_states.back().size());
+    ++_imp->current_epoch_serial;
+    if (! _imp->trailing)
+        _imp->integer_variable_states.push_copy_of_back();
+    _imp->constraint_states.push_copy_of_back();
+    _reversible_trail.new_epoch();
+    _search_arena.new_epoch();
     _imp->on_backtracks.emplace_back();
 
-    return Timestamp{_imp->integer_variable_states.size() - 1, _imp->guesses.size(),
+    return Timestamp{_imp->constraint_states.size() - 1, _imp->guesses.size(),
         subsearch ? make_optional<unsigned long long>(_imp->extra_proof_conditions.size()) : nullopt};
 }
 
 auto State::backtrack(Timestamp t) -> void
 {
-    _imp->integer_variable_states.resize(t.when);
-    _imp->constraint_states.resize(t.when);
+    if (! _imp->trailing)
+        _imp->integer_variable_states.pop_back_to(t.when);
+
+    // Epoch t.when was opened by the new_epoch() that pushed mark t.when - 1.
+    if (t.when >= 1 && t.when <= _imp->domain_trail_marks.size()) {
+        auto [trail_length, variable_count] = _imp->domain_trail_marks[t.when - 1];
+        if (_imp->trailing) {
+            auto & domains = _imp->integer_variable_states.back();
+            while (_imp->domain_trail.size() > trail_length) {
+                auto & [index, old_domain] = _imp->domain_trail.back();
+                domains[index] = move(old_domain);
+                note_domain_changed(SimpleIntegerVariableID{index}, domains[index]);
+                _imp->domain_trail.pop_back();
+            }
+            domains.erase(domains.begin() + variable_count, domains.end());
+        }
+        else
+            while (_imp->bounds_trail.size() > trail_length) {
+                const auto & old = _imp->bounds_trail.back();
+                _lower_bounds[old.index] = old.lower;
+                _upper_bounds[old.index] = old.upper;
+                _domain_is_interval[old.index] = old.is_interval;
+                _imp->bounds_trail.pop_back();
+            }
+        _lower_bounds.resize(variable_count, 0_i);
+        _upper_bounds.resize(variable_count, 0_i);
+        _domain_is_interval.resize(variable_count);
+        _imp->last_trailed_in.erase(_imp->last_trailed_in.begin() + variable_count, _imp->last_trailed_in.end());
+        _imp->domain_trail_marks.erase(_imp->domain_trail_marks.begin() + (t.when - 1), _imp->domain_trail_marks.end());
+    }
+    ++_imp->current_epoch_serial;
+    _imp->constraint_states.pop_back_to(t.when);
+    _reversible_trail.backtrack(t.when);
+    _search_arena.backtrack(t.when);
     _imp->guesses.erase(_imp->guesses.begin() + t.how_many_guesses, _imp->guesses.end());
     if (t.how_many_extra_proof_conditions)
         _imp->extra_proof_conditions.erase(
@@ -694,18 +842,14 @@ auto State::backtrack(Timestamp t) -> void
     while (_imp->on_backtracks.size() > t.when) {
         for (auto & f : _imp->on_backtracks.back())
             f();
+        _imp->on_backtracks.back().clear();
         _imp->on_backtracks.pop_back();
     }
 }
 
-auto State::guesses() const -> generator<Literal>
+auto State::guesses() const -> Guesses
 {
-    return [](const auto & extra_proof_conditions, const auto & guesses) -> generator<Literal> {
-        for (auto & g : extra_proof_conditions)
-            co_yield g;
-        for (auto & g : guesses)
-            co_yield g;
-    }(_imp->extra_proof_conditions, _imp->guesses);
+    return Guesses{array{span<const Literal>{_imp->extra_proof_conditions}, span<const Literal>{_imp->guesses}}};
 }
 
 auto State::test_literal(const Literal & lit) const -> LiteralIs
@@ -819,16 +963,6 @@ namespace gcs
     template auto State::domain_size(const IntegerVariableID &) const -> Integer;
     template auto State::domain_size(const SimpleIntegerVariableID &) const -> Integer;
 
-    template auto State::each_value_immutable(const IntegerVariableID &) const -> generator<Integer>;
-    template auto State::each_value_immutable(const SimpleIntegerVariableID &) const -> generator<Integer>;
-    template auto State::each_value_immutable(const ViewOfIntegerVariableID &) const -> generator<Integer>;
-    template auto State::each_value_immutable(const ConstantIntegerVariableID &) const -> generator<Integer>;
-
-    template auto State::each_value_mutable(const IntegerVariableID &) const -> generator<Integer>;
-    template auto State::each_value_mutable(const SimpleIntegerVariableID &) const -> generator<Integer>;
-    template auto State::each_value_mutable(const ViewOfIntegerVariableID &) const -> generator<Integer>;
-    template auto State::each_value_mutable(const ConstantIntegerVariableID &) const -> generator<Integer>;
-
     template auto State::copy_of_values(const IntegerVariableID &) const -> IntervalSet<Integer>;
     template auto State::copy_of_values(const SimpleIntegerVariableID &) const -> IntervalSet<Integer>;
     template auto State::copy_of_values(const ViewOfIntegerVariableID &) const -> IntervalSet<Integer>;
@@ -2,7 +2,11 @@
 #define GLASGOW_CONSTRAINT_SOLVER_GUARD_GCS_STATE_HH
 
 #include <gcs/current_state.hh>
+#include <gcs/innards/domain_values.hh>
 #include <gcs/innards/literal.hh>
+#include <gcs/innards/reversible.hh>
+#include <gcs/innards/saved_phases.hh>
+#include <gcs/innards/search_arena.hh>
 #include <gcs/innards/state-fwd.hh>
 #include <gcs/innards/variable_id_utils.hh>
 #include <gcs/integer.hh>
@@ -10,17 +14,16 @@
 #include <util/overloaded.hh>
 
 #include <any>
+#include <array>
+#include <cstdint>
 #include <functional>
 #include <memory>
 #include <optional>
+#include <ranges>
+#include <span>
 #include <tuple>
-#include <version>
-
-#ifdef __cpp_lib_generator
-#include <generator>
-#else
-#include <__generator.hpp>
-#endif
+#include <utility>
+#include <vector>
 
 namespace gcs::innards
 {
@@ -47,6 +50,16 @@ namespace gcs::innards
         }
     };
 
+    /**
+     * \brief The current guesses, as returned by State::guesses(): the extra
+     * proof conditions followed by the guesses proper, as one range over the
+     * State's own storage, so no allocation is needed.
+     *
+     * \sa State::guesses()
+     * \ingroup Innards
+     */
+    using Guesses = std::ranges::join_view<std::ranges::owning_view<std::array<std::span<const Literal>, 2>>>;
+
     /**
      * \brief Is a Literal's state known?
      *
@@ -60,6 +73,24 @@ namespace gcs::innards
         Undecided
     };
 
+    /**
+     * \brief How does State restore variable domains on backtrack?
+     *
+     * \sa State::set_backtracking_mode()
+     * \ingroup Innards
+     */
+    enum class BacktrackingMode
+    {
+        /// Every new_epoch() copies every domain, and backtrack() throws the
+        /// copies away. The default.
+        CopyEveryEpoch,
+
+        /// A domain's old value is recorded on the trail the first time it
+        /// changes in an epoch, and backtrack() undoes the trail. A node then
+        /// costs O(domains changed) rather than O(variables).
+        Trail
+    };
+
     using ConstraintState = std::any;
 
     struct ConstraintStateHandle
@@ -139,6 +170,27 @@ namespace gcs::innards
         struct Imp;
         std::unique_ptr<Imp> _imp;
 
+        // Outside _imp, unlike everything else, so that reversible_trail() can
+        // be inline: propagators reach it once per call, and the primitives
+        // over it are meant to cost no more than a vector access.
+        mutable ReversibleTrail _reversible_trail;
+
+        // Outside _imp for the same reason: the branching heuristics reach it
+        // at every search node.
+        mutable SearchArena _search_arena;
+
+        // And this one search reaches at every decision.
+        mutable SavedPhases _saved_phases;
+
+        // Every variable's bounds, and whether its domain is a single interval,
+        // as flat arrays indexed by variable. Every change_state_for_*() and
+        // backtrack() keeps them in step with the IntervalSet domains, so that
+        // bounds-only readers, which is most propagators, touch two contiguous
+        // arrays rather than chasing into each domain. Outside _imp too, so
+        // that the bulk bounds() can be inline.
+        std::vector<Integer> _lower_bounds, _upper_bounds;
+        std::vector<std::uint8_t> _domain_is_interval;
+
         [[nodiscard]] auto change_state_for_equal(const SimpleIntegerVariableID & var, Integer value) -> Inference;
 
         [[nodiscard]] auto change_state_for_not_equal(const SimpleIntegerVariableID & var, Integer value) -> Inference;
@@ -151,6 +203,15 @@ namespace gcs::innards
 
         [[nodiscard]] auto change_state_for_in_range(const SimpleIntegerVariableID & var, Integer lo, Integer hi) -> Inference;
 
+        // Every change_state_for_*() calls this immediately before it mutates
+        // a domain, so the old value is trailed on the first write to that
+        // variable in the current epoch: the domain under BacktrackingMode::Trail,
+        // and just its entries in the bounds arrays otherwise.
+        inline auto remember_before_change(const SimpleIntegerVariableID &) -> void;
+
+        // And this immediately after, unless the domain is now empty.
+        inline auto note_domain_changed(const SimpleIntegerVariableID &, const IntervalSet<Integer> &) -> void;
+
         [[nodiscard]] inline auto state_of(const SimpleIntegerVariableID &) -> IntervalSet<Integer> &;
         [[nodiscard]] inline auto state_of(const SimpleIntegerVariableID &) const -> const IntervalSet<Integer> &;
 
@@ -183,6 +244,16 @@ namespace gcs::innards
          */
         [[nodiscard]] auto clone() const -> State;
 
+        /**
+         * Select how variable domains are restored on backtrack. Must be
+         * called before the first new_epoch(). Constraint states are copied
+         * every epoch in either mode, and the reversible_trail() is trailed in
+         * either mode.
+         *
+         * \sa BacktrackingMode
+         */
+        auto set_backtracking_mode(BacktrackingMode) -> void;
+
         ///@}
 
         /**
@@ -304,7 +375,7 @@ namespace gcs::innards
          *
          * \sa State::guess()
          */
-        auto guesses() const -> std::generator<Literal>;
+        auto guesses() const -> Guesses;
 
         /**
          * Create a new epoch, that can be backtracked to. Only legal if we are in a fully
@@ -369,6 +440,35 @@ namespace gcs::innards
         template <IntegerVariableIDLike VarType_>
         [[nodiscard]] auto bounds(const VarType_ &) const -> std::pair<Integer, Integer>;
 
+        /**
+         * Fill in the smallest and largest values of each of these variables'
+         * domains, in order, for a propagator that wants the bounds of its
+         * whole scope at once. The bounds are kept in contiguous arrays, so
+         * this is a gather rather than a walk over the domains. The result must
+         * be at least as long as the variables.
+         *
+         * \sa State::bounds()
+         */
+        auto bounds(std::span<const SimpleIntegerVariableID> vars, std::span<std::pair<Integer, Integer>> result) const -> void
+        {
+            bounds(vars, std::identity{}, result);
+        }
+
+        /**
+         * Fill in bounds as above, for a range of terms from each of which
+         * the projection picks out a SimpleIntegerVariableID, such as the
+         * weighted terms of a linear constraint.
+         */
+        template <std::ranges::input_range Terms_, typename VariableOf_>
+        auto bounds(const Terms_ & terms, const VariableOf_ & variable_of, std::span<std::pair<Integer, Integer>> result) const -> void
+        {
+            auto out = result.begin();
+            for (const auto & term : terms) {
+                auto index = std::invoke(variable_of, term).index;
+                *out++ = std::pair{_lower_bounds[index], _upper_bounds[index]};
+            }
+        }
+
         /**
          * Does this variable have a single value left in its domain, and if
          * so, what is it? Call using either IntegerVariableID or one of its
@@ -395,25 +495,51 @@ namespace gcs::innards
         [[nodiscard]] auto has_single_value(const IntegerVariableID) const -> bool;
 
         /**
-         * Provide a generator that iterates over each value in a variable's domain. The
-         * variable's domain must not be modified whilst the generator is alive. Call using
-         * either IntegerVariableID or one of its more specific types.
+         * Provide a range over each value in a variable's domain. The variable's domain
+         * must not be modified whilst the range is in use: the range borrows the
+         * domain, so this allocates nothing, but inferring anything about the variable
+         * from inside the loop is undefined behaviour. Use each_value_mutable() if the
+         * loop might change the domain. Call using either IntegerVariableID or one of
+         * its more specific types.
          *
          * \sa State::each_value_mutable(), State::for_each_value_immutable()
          */
         template <IntegerVariableIDLike VarType_>
-        auto each_value_immutable(const VarType_ &) const -> std::generator<Integer>;
+        auto each_value_immutable(const VarType_ & var) const -> DomainValues
+        {
+            auto [actual_var, negate_first, then_add] = state_detail::deview(var);
+            return state_detail::visit_actual(
+                actual_var,
+                [&, negate_first = negate_first, then_add = then_add](const SimpleIntegerVariableID & v) {
+                    return DomainValues::borrowing(state_of_for_iteration(v), negate_first, then_add);
+                },
+                [&, negate_first = negate_first, then_add = then_add](const ConstantIntegerVariableID & v) {
+                    return DomainValues::snapshot(IntervalSet<Integer>{v.const_value, v.const_value}, negate_first, then_add);
+                });
+        }
 
         /**
-         * Provide a generator that iterates over each value in a variable's domain. The
-         * variable's domain may be modified whilst the generator is alive, but the generator
-         * will run over the values pre-modification. Call using either IntegerVariableID or
-         * one of its more specific types.
+         * Provide a range over each value in a variable's domain. The variable's domain
+         * may be modified whilst the range is in use, but the range will run over the
+         * values pre-modification. Call using either IntegerVariableID or one of its more
+         * specific types. The range holds its own copy of the domain, which only
+         * allocates if the domain has more holes than IntervalSet stores inline.
          *
          * \sa State::each_value_immutable(), State::for_each_value_mutable()
          */
         template <IntegerVariableIDLike VarType_>
-        auto each_value_mutable(const VarType_ &) const -> std::generator<Integer>;
+        auto each_value_mutable(const VarType_ & var) const -> DomainValues
+        {
+            auto [actual_var, negate_first, then_add] = state_detail::deview(var);
+            return state_detail::visit_actual(
+                actual_var,
+                [&, negate_first = negate_first, then_add = then_add](const SimpleIntegerVariableID & v) {
+                    return DomainValues::snapshot(state_of_for_iteration(v), negate_first, then_add);
+                },
+                [&, negate_first = negate_first, then_add = then_add](const ConstantIntegerVariableID & v) {
+                    return DomainValues::snapshot(IntervalSet<Integer>{v.const_value, v.const_value}, negate_first, then_add);
+                });
+        }
 
         /**
          * Non-coroutine alternative to each_value_immutable(). Calls \p cb(value)
@@ -461,6 +587,54 @@ namespace gcs::innards
                     const ConstantIntegerVariableID & v) { cb(state_detail::apply_view(v.const_value, negate_first, then_add)); });
         }
 
+        /**
+         * As for_each_value_immutable(), but visiting the values in the reverse
+         * order. If \p cb returns \c bool, returning \c false stops iteration
+         * early.
+         *
+         * \sa State::for_each_value_immutable()
+         */
+        template <IntegerVariableIDLike VarType_, typename Callback_>
+        auto for_each_value_reversed_immutable(const VarType_ & var, Callback_ && cb) const -> void
+        {
+            auto [actual_var, negate_first, then_add] = state_detail::deview(var);
+            state_detail::visit_actual(
+                actual_var,
+                [&, negate_first = negate_first, then_add = then_add](const SimpleIntegerVariableID & v) {
+                    state_of_for_iteration(v).for_each_reversed([&](Integer i) { return cb(state_detail::apply_view(i, negate_first, then_add)); });
+                },
+                [&, negate_first = negate_first, then_add = then_add](
+                    const ConstantIntegerVariableID & v) { cb(state_detail::apply_view(v.const_value, negate_first, then_add)); });
+        }
+
+        /**
+         * Calls \p cb(lower, upper) for each maximal run of consecutive values in the
+         * variable's domain, with the view applied, so that \p lower <= \p upper
+         * always. The runs come in the order for_each_value_immutable() would visit
+         * their values. The variable's domain must not be modified during the
+         * callback. If \p cb returns \c bool, returning \c false stops iteration
+         * early.
+         *
+         * \sa State::for_each_value_immutable()
+         */
+        template <IntegerVariableIDLike VarType_, typename Callback_>
+        auto for_each_interval_immutable(const VarType_ & var, Callback_ && cb) const -> void
+        {
+            auto [actual_var, negate_first, then_add] = state_detail::deview(var);
+            state_detail::visit_actual(
+                actual_var,
+                [&, negate_first = negate_first, then_add = then_add](const SimpleIntegerVariableID & v) {
+                    state_of_for_iteration(v).for_each_interval([&](Integer l, Integer u) {
+                        auto vl = state_detail::apply_view(l, negate_first, then_add), vu = state_detail::apply_view(u, negate_first, then_add);
+                        return negate_first ? cb(vu, vl) : cb(vl, vu);
+                    });
+                },
+                [&, negate_first = negate_first, then_add = then_add](const ConstantIntegerVariableID & v) {
+                    auto val = state_detail::apply_view(v.const_value, negate_first, then_add);
+                    cb(val, val);
+                });
+        }
+
         /**
          * Return the contents of the domain.
          */
@@ -560,7 +734,9 @@ namespace gcs::innards
          * add state that genuinely has to backtrack. Data that must survive
          * backtracking (a cache of proof lines already emitted, say) or that never
          * changes after install is not constraint state at all: capture it in the
-         * propagator, by shared_ptr if it is mutable.
+         * propagator, by shared_ptr if it is mutable. State that is made of
+         * integers, flags or a shrinking set is better kept in the
+         * reversible_trail(), where a node costs only what it writes.
          */
         [[nodiscard]] auto add_constraint_state(const ConstraintState c) -> ConstraintStateHandle;
 
@@ -569,6 +745,37 @@ namespace gcs::innards
          */
         [[nodiscard]] auto get_constraint_state(const ConstraintStateHandle h) const -> ConstraintState &;
 
+        /**
+         * The store for Reversible, ReversibleVector, ReversibleBitset and
+         * ReversibleSparseSet values, which are restored on backtrack by undoing
+         * whatever was written since, rather than by copying.
+         */
+        [[nodiscard]] auto reversible_trail() const -> ReversibleTrail &
+        {
+            return _reversible_trail;
+        }
+
+        /**
+         * The arena for memory that lives no longer than a search node, such
+         * as the coroutine frames of the built-in branching heuristics. It is
+         * given back on backtrack, and a clone() starts with an empty one.
+         */
+        [[nodiscard]] auto search_arena() const -> SearchArena &
+        {
+            return _search_arena;
+        }
+
+        /**
+         * The value search last gave each variable, and its value in the most
+         * recent solution, for phase-saving value orderings. Unlike everything
+         * else here, these are not undone by backtracking, and a clone()
+         * starts with none.
+         */
+        [[nodiscard]] auto saved_phases() const -> SavedPhases &
+        {
+            return _saved_phases;
+        }
+
         ///@}
     };
 }
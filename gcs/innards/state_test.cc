@@ -3,6 +3,9 @@
 #include <catch2/catch_test_macros.hpp>
 
 #include <algorithm>
+#include <any>
+#include <cstddef>
+#include <cstdint>
 #include <optional>
 #include <utility>
 #include <vector>
@@ -259,3 +262,275 @@ TEST_CASE("copy_of_values / domains_intersect on multi-interval negated views")
         CHECK(state.domains_intersect(d, -a)); // symmetry
     }
 }
+
+namespace
+{
+    auto values_of(State & state, IntegerVariableID var) -> vector<Integer>
+    {
+        vector<Integer> values;
+        for (const auto & v : state.each_value_immutable(var))
+            values.push_back(v);
+        return values;
+    }
+}
+
+TEST_CASE("Trailed backtracking restores domains like copying does")
+{
+    for (auto mode : {BacktrackingMode::CopyEveryEpoch, BacktrackingMode::Trail}) {
+        State state;
+        state.set_backtracking_mode(mode);
+        auto a = state.allocate_integer_variable_with_state(1_i, 10_i);
+        auto b = state.allocate_integer_variable_with_state(1_i, 10_i);
+
+        // A root change persists: nothing backtracks past the root.
+        CHECK(state.infer_less_than(a, 9_i) == Inference::BoundsChanged);
+
+        auto outer = state.new_epoch();
+        CHECK(state.infer_not_equal(a, 4_i) == Inference::InteriorValuesChanged);
+        CHECK(state.infer_greater_than_or_equal(a, 2_i) == Inference::BoundsChanged);
+
+        auto inner = state.new_epoch();
+        CHECK(state.infer_equal(a, 5_i) == Inference::Instantiated);
+        CHECK(state.infer_in_range(b, 3_i, 6_i) == Inference::BoundsChanged);
+        auto c = state.allocate_integer_variable_with_state(0_i, 1_i);
+        CHECK(state.infer_equal(c, 1_i) == Inference::Instantiated);
+        state.backtrack(inner);
+
+        CHECK(values_of(state, a) == vector{2_i, 3_i, 5_i, 6_i, 7_i, 8_i});
+        check_range(state, b, 1_i, 10_i);
+        CHECK(state.what_variable_id_will_be_created_next().index == c.index);
+
+        // A second child of the same parent must trail afresh.
+        auto again = state.new_epoch();
+        CHECK(state.infer_not_in_range(a, 5_i, 6_i) == Inference::InteriorValuesChanged);
+        CHECK(state.infer_equal(b, 7_i) == Inference::Instantiated);
+        state.backtrack(again);
+        CHECK(values_of(state, a) == vector{2_i, 3_i, 5_i, 6_i, 7_i, 8_i});
+        check_range(state, b, 1_i, 10_i);
+
+        // Changes made to the parent after a child was undone are undone too.
+        CHECK(state.infer_less_than(b, 4_i) == Inference::BoundsChanged);
+        state.backtrack(outer);
+        check_range(state, a, 1_i, 8_i);
+        check_range(state, b, 1_i, 10_i);
+    }
+}
+
+TEST_CASE("Bounds read in bulk follow changes and backtracking")
+{
+    for (auto mode : {BacktrackingMode::CopyEveryEpoch, BacktrackingMode::Trail}) {
+        State state;
+        state.set_backtracking_mode(mode);
+        auto a = state.allocate_integer_variable_with_state(1_i, 10_i);
+        auto b = state.allocate_integer_variable_with_state(-5_i, 5_i);
+        const vector vars{a, b, a};
+        vector<pair<Integer, Integer>> bounds(vars.size(), pair{0_i, 0_i});
+
+        auto timestamp = state.new_epoch();
+        CHECK(state.infer_not_equal(a, 10_i) == Inference::BoundsChanged);
+        CHECK(state.infer_not_equal(b, 0_i) == Inference::InteriorValuesChanged);
+        state.bounds(vars, bounds);
+        CHECK(bounds == vector{pair{1_i, 9_i}, pair{-5_i, 5_i}, pair{1_i, 9_i}});
+        CHECK(state.domain_has_holes(b));
+        CHECK(! state.in_domain(b, 0_i));
+        CHECK(state.in_domain(b, 1_i));
+
+        CHECK(state.infer_greater_than_or_equal(b, 1_i) == Inference::BoundsChanged);
+        CHECK(! state.domain_has_holes(b));
+        CHECK(state.infer_equal(a, 3_i) == Inference::Instantiated);
+        CHECK(state.has_single_value(a));
+        state.bounds(vars, [](const SimpleIntegerVariableID & v) { return v; }, bounds);
+        CHECK(bounds == vector{pair{3_i, 3_i}, pair{1_i, 5_i}, pair{3_i, 3_i}});
+
+        state.backtrack(timestamp);
+        state.bounds(vars, bounds);
+        CHECK(bounds == vector{pair{1_i, 10_i}, pair{-5_i, 5_i}, pair{1_i, 10_i}});
+        CHECK(! state.domain_has_holes(b));
+        CHECK(state.in_domain(b, 0_i));
+        CHECK(! state.has_single_value(a));
+    }
+}
+
+TEST_CASE("Reversible primitives are restored on backtrack")
+{
+    State state;
+    auto & trail = state.reversible_trail();
+    Reversible<Integer> sum{trail, 5_i};
+    Reversible<bool> flag{trail, false};
+    ReversibleVector<long> counts{trail, 3, 0};
+    ReversibleBitset bits{trail, 130};
+    ReversibleSparseSet set{trail, 6};
+
+    // Changes at the root are permanent.
+    bits.set(trail, 0);
+    set.erase(trail, 5);
+
+    auto members = [&]() {
+        vector<std::size_t> result;
+        for (std::size_t k = 0; k < set.size(trail); ++k)
+            result.push_back(set.at(trail, k));
+        std::ranges::sort(result);
+        return result;
+    };
+
+    auto outer = state.new_epoch();
+    sum.set(trail, 7_i);
+    flag.set(trail, true);
+    counts.set(trail, 1, 4);
+    bits.set(trail, 129);
+    set.erase(trail, 2);
+    set.erase_at(trail, 0);
+
+    auto inner = state.new_epoch();
+    sum.set(trail, 9_i);
+    sum.set(trail, 11_i);
+    counts.set(trail, 1, 8);
+    counts.set(trail, 2, 1);
+    bits.set(trail, 64);
+    bits.reset(trail, 129);
+    set.erase(trail, 3);
+    CHECK(sum.get(trail) == 11_i);
+    CHECK(bits.count(trail) == 2);
+    CHECK(! set.contains(trail, 3));
+
+    state.backtrack(inner);
+    CHECK(sum.get(trail) == 7_i);
+    CHECK(flag.get(trail));
+    CHECK(counts.get(trail, 1) == 4);
+    CHECK(counts.get(trail, 2) == 0);
+    CHECK(bits.test(trail, 129));
+    CHECK(! bits.test(trail, 64));
+    CHECK(members().size() == 3);
+    CHECK(set.contains(trail, 3));
+    CHECK(! set.contains(trail, 2));
+
+    state.backtrack(outer);
+    CHECK(sum.get(trail) == 5_i);
+    CHECK(! flag.get(trail));
+    CHECK(counts.get(trail, 1) == 0);
+    CHECK(bits.count(trail) == 1);
+    CHECK(bits.test(trail, 0));
+    CHECK(members() == vector<std::size_t>{0, 1, 2, 3, 4});
+}
+
+TEST_CASE("Every way of iterating over values agrees, with and without views")
+{
+    State state;
+    auto x = state.allocate_integer_variable_with_state(1_i, 12_i);
+    for (auto v : {3_i, 4_i, 7_i, 10_i})
+        (void)state.infer_not_equal(x, v);
+    // x in {1..2, 5..6, 8..9, 11..12}, more intervals than a snapshot keeps inline
+
+    for (auto var : {IntegerVariableID{x}, -IntegerVariableID{x} + 2_i, x + 3_i, IntegerVariableID{5_c}}) {
+        auto expected = values_of(state, var);
+
+        vector<Integer> mutable_values, callback_values, reversed_values, interval_values;
+        for (auto v : state.each_value_mutable(var))
+            mutable_values.push_back(v);
+        state.for_each_value_immutable(var, [&](Integer v) { callback_values.push_back(v); });
+        state.for_each_value_reversed_immutable(var, [&](Integer v) { reversed_values.push_back(v); });
+        state.for_each_interval_immutable(var, [&](Integer l, Integer u) {
+            CHECK(l <= u);
+            for (auto v = l; v <= u; ++v)
+                interval_values.push_back(v);
+        });
+
+        CHECK(mutable_values == expected);
+        CHECK(callback_values == expected);
+        std::ranges::reverse(reversed_values);
+        CHECK(reversed_values == expected);
+        std::ranges::sort(interval_values);
+        auto sorted_expected = expected;
+        std::ranges::sort(sorted_expected);
+        CHECK(interval_values == sorted_expected);
+    }
+}
+
+TEST_CASE("A mutable value range iterates over the domain as it was")
+{
+    State state;
+    auto x = state.allocate_integer_variable_with_state(1_i, 6_i);
+    vector<Integer> seen;
+    for (auto v : state.each_value_mutable(x)) {
+        seen.push_back(v);
+        (void)state.infer_not_equal(x, v + 1_i);
+    }
+    CHECK(seen == vector<Integer>{1_i, 2_i, 3_i, 4_i, 5_i, 6_i});
+}
+
+TEST_CASE("Guesses give extra proof conditions then guesses")
+{
+    State state;
+    auto x = state.allocate_integer_variable_with_state(1_i, 6_i);
+    CHECK(std::ranges::empty(state.guesses()));
+
+    state.add_extra_proof_condition(x != 1_i);
+    auto t = state.new_epoch();
+    state.guess(x != 2_i);
+    state.guess(x != 3_i);
+    vector<Literal> guesses;
+    for (const auto & g : state.guesses())
+        guesses.push_back(g);
+    CHECK(guesses == vector<Literal>{x != 1_i, x != 2_i, x != 3_i});
+
+    state.backtrack(t);
+    guesses.clear();
+    for (const auto & g : state.guesses())
+        guesses.push_back(g);
+    CHECK(guesses == vector<Literal>{x != 1_i});
+}
+
+TEST_CASE("The search arena gives memory back on backtrack")
+{
+    State state;
+    auto & arena = state.search_arena();
+
+    auto * at_root = arena.allocate(100, 8);
+    auto outer = state.new_epoch();
+    auto * in_outer = arena.allocate(100, 8);
+    CHECK(in_outer != at_root);
+
+    auto inner = state.new_epoch();
+    auto * aligned = arena.allocate(8, 64);
+    CHECK(reinterpret_cast<std::uintptr_t>(aligned) % 64 == 0);
+    // Bigger than a block, so it needs a block of its own.
+    auto * big = static_cast<std::byte *>(arena.allocate(1 << 20, 16));
+    big[(1 << 20) - 1] = std::byte{1};
+    auto heap_allocations = arena.heap_allocations();
+    CHECK(heap_allocations == 2);
+
+    state.backtrack(inner);
+    CHECK(arena.allocate(8, 64) == aligned);
+    state.backtrack(outer);
+    CHECK(arena.allocate(100, 8) == in_outer);
+
+    // Going back down reuses the blocks we already have.
+    auto again = state.new_epoch();
+    (void)arena.allocate(1 << 20, 16);
+    state.backtrack(again);
+    CHECK(arena.heap_allocations() == heap_allocations);
+    CHECK(arena.allocations() == 7);
+
+    CHECK(state.clone().search_arena().allocations() == 0);
+}
+
+TEST_CASE("Constraint states and backtrack callbacks are right when epochs are reused")
+{
+    State state;
+    auto h = state.add_constraint_state(0);
+    int calls = 0;
+
+    for (int round = 1; round <= 3; ++round) {
+        auto outer = state.new_epoch();
+        std::any_cast<int &>(state.get_constraint_state(h)) = round;
+        state.on_backtrack([&]() { ++calls; });
+        auto inner = state.new_epoch();
+        CHECK(std::any_cast<int>(state.get_constraint_state(h)) == round);
+        std::any_cast<int &>(state.get_constraint_state(h)) = 10 * round;
+        state.backtrack(inner);
+        CHECK(std::any_cast<int>(state.get_constraint_state(h)) == round);
+        state.backtrack(outer);
+        CHECK(std::any_cast<int>(state.get_constraint_state(h)) == 0);
+        CHECK(calls == round);
+    }
+}
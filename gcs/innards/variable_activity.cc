@@ -0,0 +1,99 @@
+#include <gcs/current_state.hh>
+#include <gcs/innards/variable_activity.hh>
+
+#include <util/overloaded.hh>
+
+using namespace gcs;
+using namespace gcs::innards;
+
+using std::move;
+using std::nullopt;
+using std::optional;
+using std::size_t;
+using std::vector;
+
+namespace
+{
+    // Once a bump gets this big, scale every activity and the bump down by
+    // the same amount, which leaves their order as it was.
+    constexpr double rescale_above = 1e100;
+
+    auto simple_index_of(const IntegerVariableID & var) -> optional<size_t>
+    {
+        return overloaded{//
+            [](const SimpleIntegerVariableID & v) -> optional<size_t> { return v.index; },
+            [](const ViewOfIntegerVariableID & v) -> optional<size_t> { return v.actual_variable.index; },
+            [](const ConstantIntegerVariableID &) -> optional<size_t> {
+                return nullopt;
+            }}.visit(var);
+    }
+}
+
+VariableActivity::VariableActivity(vector<IntegerVariableID> vars, double decay) :
+    _vars(move(vars)),
+    _decay(decay)
+{
+}
+
+auto VariableActivity::select(const CurrentState & state) const -> optional<IntegerVariableID>
+{
+    optional<IntegerVariableID> result;
+    double result_score = 0.0;
+    long long result_size = 0;
+    for (const auto & v : _vars) {
+        auto size = state.domain_size(v).raw_value;
+        if (size < 2)
+            continue;
+        auto score = activity_of(v) / static_cast<double>(size);
+        if ((! result) || score > result_score || (score == result_score && size < result_size)) {
+            result = v;
+            result_score = score;
+            result_size = size;
+        }
+    }
+    return result;
+}
+
+auto VariableActivity::activity_of(const IntegerVariableID & var) const -> double
+{
+    auto index = simple_index_of(var);
+    if (! index || *index >= _activity.size())
+        return 0.0;
+    return _activity[*index];
+}
+
+auto VariableActivity::note_domain_change(SimpleIntegerVariableID var) -> void
+{
+    if (_activity.size() <= var.index) {
+        _activity.resize(var.index + 1, 0.0);
+        _bumped_at.resize(var.index + 1, 0);
+    }
+
+    if (_bumped_at[var.index] != _node) {
+        _bumped_at[var.index] = _node;
+        _activity[var.index] += _increment;
+    }
+}
+
+auto VariableActivity::note_everything_changed() -> void
+{
+    // This is the first propagation at the root, which says nothing about
+    // how search is going.
+}
+
+auto VariableActivity::note_propagation_starting(const Literals &) -> void
+{
+    ++_node;
+}
+
+auto VariableActivity::note_propagation_finished(bool, const State &) -> void
+{
+    // Growing the bump is the same as decaying every activity, relative to
+    // each other, but costs nothing.
+    _increment /= _decay;
+    if (_increment > rescale_above) {
+        for (auto & a : _activity)
+            a /= rescale_above;
+        _increment /= rescale_above;
+    }
+}
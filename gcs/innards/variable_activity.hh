@@ -0,0 +1,85 @@
+#ifndef GLASGOW_CONSTRAINT_SOLVER_GUARD_GCS_INNARDS_VARIABLE_ACTIVITY_HH
+#define GLASGOW_CONSTRAINT_SOLVER_GUARD_GCS_INNARDS_VARIABLE_ACTIVITY_HH
+
+#include <gcs/innards/domain_change_observer.hh>
+#include <gcs/variable_id.hh>
+
+#include <optional>
+#include <vector>
+
+namespace gcs
+{
+    class CurrentState;
+}
+
+namespace gcs::innards
+{
+    /**
+     * \brief The activity of each variable, for activity-based search
+     * (Michel and Van Hentenryck, CPAIOR 2012), and the variable that
+     * gcs::variable_order::activity() would pick.
+     *
+     * Attached to the Propagators as a DomainChangeObserver, each call to
+     * propagate() is a node, and every variable whose domain changes at that
+     * node has its activity bumped, once however many times it changes. The
+     * activity of every variable also decays by a constant factor at each
+     * node, which is done the way SAT solvers decay VSIDS scores, by making
+     * each bump bigger than the last, and scaling everything down every so
+     * often so that nothing overflows. Activities are not reset by
+     * backtracking or by restarts, which is the point: they say what search
+     * has seen so far.
+     *
+     * \ingroup Innards
+     */
+    class VariableActivity final : public DomainChangeObserver
+    {
+    private:
+        std::vector<IntegerVariableID> _vars;
+        double _decay;
+
+        // By the index of each simple variable, its activity, and the node at
+        // which it was last bumped.
+        std::vector<double> _activity;
+        std::vector<unsigned long long> _bumped_at;
+
+        unsigned long long _node = 0;
+        double _increment = 1.0;
+
+    public:
+        /**
+         * \brief Keep activities for the variables underlying \p vars, each
+         * multiplied by \p decay at every node.
+         *
+         * The caller must attach this to the Propagators as a domain change
+         * observer.
+         */
+        VariableActivity(std::vector<IntegerVariableID> vars, double decay);
+
+        VariableActivity(const VariableActivity &) = delete;
+        auto operator=(const VariableActivity &) -> VariableActivity & = delete;
+
+        /**
+         * \brief The unassigned variable with the highest activity divided by
+         * domain size, with ties going to the smaller domain and then to
+         * whichever comes first, or nullopt if every variable is assigned.
+         */
+        [[nodiscard]] auto select(const CurrentState & state) const -> std::optional<IntegerVariableID>;
+
+        /**
+         * \brief The activity of a variable, relative to that of the others,
+         * with views and constants having those of what they are views of and
+         * nothing.
+         */
+        [[nodiscard]] auto activity_of(const IntegerVariableID & var) const -> double;
+
+        auto note_domain_change(SimpleIntegerVariableID var) -> void override;
+
+        auto note_everything_changed() -> void override;
+
+        auto note_propagation_starting(const Literals & guesses) -> void override;
+
+        auto note_propagation_finished(bool succeeded, const State & state) -> void override;
+    };
+}
+
+#endif
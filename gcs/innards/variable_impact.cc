@@ -0,0 +1,212 @@
+#include <gcs/current_state.hh>
+#include <gcs/innards/propagators.hh>
+#include <gcs/innards/state.hh>
+#include <gcs/innards/variable_impact.hh>
+
+#include <algorithm>
+#include <cmath>
+#include <variant>
+
+using namespace gcs;
+using namespace gcs::innards;
+
+using std::clamp;
+using std::exp;
+using std::get_if;
+using std::log;
+using std::move;
+using std::nullopt;
+using std::optional;
+using std::size_t;
+using std::vector;
+
+namespace
+{
+    // Values are remembered one by one for a variable whose initial domain
+    // spans at most this many of them.
+    constexpr long long most_values_remembered = 4096;
+
+    // And the first select() probes every value of each variable that has at
+    // most this many left by then.
+    constexpr long long most_values_probed = 64;
+}
+
+VariableImpact::VariableImpact(vector<IntegerVariableID> vars, State & state, const Propagators & propagators) :
+    _vars(move(vars)),
+    _state(state),
+    _propagators(propagators),
+    _trail(state.reversible_trail()),
+    _variable_impact(_vars.size()),
+    _decisions_on_path(_trail, 0)
+{
+    size_t values = 0;
+    for (const auto & v : _vars) {
+        auto [lower, upper] = state.bounds(v);
+        _first_value_of.push_back(values);
+        _lowest_value.push_back(lower);
+        if ((upper - lower).raw_value < most_values_remembered)
+            values += (upper - lower).raw_value + 1;
+    }
+    _first_value_of.push_back(values);
+    _value_impact.resize(values);
+}
+
+auto VariableImpact::log_search_space_size(const State & state) const -> double
+{
+    double result = 0.0;
+    for (const auto & v : _vars)
+        result += log(static_cast<double>(state.domain_size(v).raw_value));
+    return result;
+}
+
+auto VariableImpact::value_average(size_t position, Integer value) -> Average *
+{
+    auto offset = (value - _lowest_value[position]).raw_value;
+    if (offset < 0 || _first_value_of[position] + offset >= _first_value_of[position + 1])
+        return nullptr;
+    return &_value_impact[_first_value_of[position] + offset];
+}
+
+auto VariableImpact::estimate(size_t position, Integer value) const -> double
+{
+    auto offset = (value - _lowest_value[position]).raw_value;
+    if (offset >= 0 && _first_value_of[position] + offset < _first_value_of[position + 1]) {
+        const auto & average = _value_impact[_first_value_of[position] + offset];
+        if (average.count > 0)
+            return average.impact;
+    }
+    return _variable_impact[position].impact;
+}
+
+auto VariableImpact::record(size_t position, optional<Integer> value, double impact) -> void
+{
+    auto update = [&](Average & average) {
+        ++average.count;
+        average.impact += (impact - average.impact) / static_cast<double>(average.count);
+    };
+
+    update(_variable_impact[position]);
+    if (value)
+        if (auto average = value_average(position, *value))
+            update(*average);
+}
+
+auto VariableImpact::probe() -> void
+{
+    _probing = true;
+    auto before = log_search_space_size(_state);
+    auto current = _state.current();
+    vector<Integer> values;
+    for (size_t p = 0; p < _vars.size(); ++p) {
+        auto size = _state.domain_size(_vars[p]).raw_value;
+        if (size < 2 || size > most_values_probed || _first_value_of[p] == _first_value_of[p + 1])
+            continue;
+
+        values.clear();
+        for (auto v : current.each_value(_vars[p]))
+            values.push_back(v);
+
+        for (auto v : values) {
+            // As with any other guess, this needs an epoch of its own, so
+            // that backtracking undoes what propagation did.
+            auto timestamp = _state.new_epoch();
+            _state.guess(_vars[p] == v);
+            if (_propagators.propagate(Literals{_vars[p] == v}, _state, nullptr))
+                record(p, v, clamp(1.0 - exp(log_search_space_size(_state) - before), 0.0, 1.0));
+            else
+                record(p, v, 1.0);
+            _state.backtrack(timestamp);
+        }
+    }
+    _probing = false;
+}
+
+auto VariableImpact::select(const CurrentState & state) -> optional<IntegerVariableID>
+{
+    if (! _probed) {
+        _probed = true;
+        probe();
+    }
+
+    optional<size_t> result;
+    double result_score = 0.0;
+    for (size_t p = 0; p < _vars.size(); ++p) {
+        auto size = state.domain_size(_vars[p]).raw_value;
+        if (size < 2)
+            continue;
+
+        // How much search space each value would leave, relative to what
+        // there is now, summed over every value.
+        double score = 0.0;
+        if (_first_value_of[p] == _first_value_of[p + 1])
+            score = static_cast<double>(size) * (1.0 - _variable_impact[p].impact);
+        else
+            for (auto v : state.each_value(_vars[p]))
+                score += 1.0 - estimate(p, v);
+
+        if ((! result) || score < result_score) {
+            result = p;
+            result_score = score;
+        }
+    }
+
+    if (! result)
+        return nullopt;
+
+    // Children of this node see this on the path, and measure against it.
+    _decisions.resize(static_cast<size_t>(_decisions_on_path.get(_trail)));
+    _decisions.push_back(Decision{*result, log_search_space_size(_state)});
+    _decisions_on_path.set(_trail, static_cast<long long>(_decisions.size()));
+    return _vars[*result];
+}
+
+auto VariableImpact::impact_of(const IntegerVariableID & var) const -> double
+{
+    auto p = std::ranges::find(_vars, var);
+    return p == _vars.end() ? 0.0 : _variable_impact[p - _vars.begin()].impact;
+}
+
+auto VariableImpact::impact_of(const IntegerVariableID & var, Integer value) const -> double
+{
+    auto p = std::ranges::find(_vars, var);
+    return p == _vars.end() ? 0.0 : estimate(p - _vars.begin(), value);
+}
+
+auto VariableImpact::note_domain_change(SimpleIntegerVariableID) -> void
+{
+}
+
+auto VariableImpact::note_everything_changed() -> void
+{
+}
+
+auto VariableImpact::note_propagation_starting(const Literals & guesses) -> void
+{
+    _measuring = nullopt;
+    if (_probing || guesses.empty())
+        return;
+
+    // A guess is one of our decisions if it is on the variable that select()
+    // last chose on this path. Anything else, such as a restart or large
+    // neighbourhood search fixing things, is not measured.
+    auto on_path = static_cast<size_t>(_decisions_on_path.get(_trail));
+    if (on_path == 0 || on_path > _decisions.size())
+        return;
+    auto cond = get_if<IntegerVariableCondition>(&guesses.front());
+    const auto & decision = _decisions[on_path - 1];
+    if (! cond || cond->var != _vars[decision.position])
+        return;
+
+    _measuring = decision;
+    _measuring_value = cond->op == VariableConditionOperator::Equal ? optional{cond->value} : nullopt;
+}
+
+auto VariableImpact::note_propagation_finished(bool succeeded, const State & state) -> void
+{
+    if (! _measuring)
+        return;
+
+    auto impact = succeeded ? clamp(1.0 - exp(log_search_space_size(state) - _measuring->log_size_before), 0.0, 1.0) : 1.0;
+    record(_measuring->position, _measuring_value, impact);
+    _measuring = nullopt;
+}
@@ -0,0 +1,139 @@
+#ifndef GLASGOW_CONSTRAINT_SOLVER_GUARD_GCS_INNARDS_VARIABLE_IMPACT_HH
+#define GLASGOW_CONSTRAINT_SOLVER_GUARD_GCS_INNARDS_VARIABLE_IMPACT_HH
+
+#include <gcs/innards/domain_change_observer.hh>
+#include <gcs/innards/propagators-fwd.hh>
+#include <gcs/innards/reversible.hh>
+#include <gcs/innards/state-fwd.hh>
+#include <gcs/integer.hh>
+#include <gcs/variable_id.hh>
+
+#include <cstddef>
+#include <optional>
+#include <vector>
+
+namespace gcs
+{
+    class CurrentState;
+}
+
+namespace gcs::innards
+{
+    /**
+     * \brief The impact of assigning each variable each value, for
+     * impact-based search (Refalo, CP 2004), and the variable that
+     * gcs::variable_order::impact() would pick.
+     *
+     * The impact of a decision is how much of the search space propagating
+     * it removed, that is, one minus the product of the domain sizes of the
+     * variables afterwards divided by the product before, and is one if the
+     * decision fails. Each time search branches on one of our variables, the
+     * product before is worked out by select(), and, attached to the
+     * Propagators as a DomainChangeObserver, we hear when propagating the
+     * decision starts and finishes, and so can work out the product after.
+     * The impact of assigning a variable a value is the average over every
+     * time that decision was made, and that of a variable is the average
+     * over every decision on it, whatever its value, which also stands in
+     * for any value that has not been tried yet. Only decisions whose
+     * variable is the one select() last gave, on the path search is on, are
+     * measured, which a Reversible keeps track of.
+     *
+     * The first call to select() probes every value of every variable with
+     * a small enough domain, by guessing it and propagating it and then
+     * backtracking, so that search starts with something to go on. This is
+     * why the index needs the live State and Propagators, and why it must
+     * only be used from a branching heuristic, at a node that has just been
+     * propagated.
+     *
+     * Values are only remembered individually for variables whose initial
+     * domains span no more than a few thousand values, and the rest make do
+     * with the impact of the variable.
+     *
+     * \ingroup Innards
+     */
+    class VariableImpact final : public DomainChangeObserver
+    {
+    private:
+        struct Average
+        {
+            double impact = 0.0;
+            unsigned long long count = 0;
+        };
+
+        struct Decision
+        {
+            std::size_t position;
+            double log_size_before;
+        };
+
+        std::vector<IntegerVariableID> _vars;
+        State & _state;
+        const Propagators & _propagators;
+        ReversibleTrail & _trail;
+
+        // The values of position p are remembered in _value_impact from
+        // _first_value_of[p], starting with the value _lowest_value[p], and
+        // there are none for a position whose domain is too big.
+        std::vector<Average> _variable_impact, _value_impact;
+        std::vector<std::size_t> _first_value_of;
+        std::vector<Integer> _lowest_value;
+
+        // What select() chose, and how big the search space was, at each node
+        // down the path search is on, of which there are _decisions_on_path.
+        std::vector<Decision> _decisions;
+        Reversible<long long> _decisions_on_path;
+
+        std::optional<Decision> _measuring;
+        std::optional<Integer> _measuring_value;
+        bool _probed = false, _probing = false;
+
+        [[nodiscard]] auto log_search_space_size(const State & state) const -> double;
+        [[nodiscard]] auto value_average(std::size_t position, Integer value) -> Average *;
+        [[nodiscard]] auto estimate(std::size_t position, Integer value) const -> double;
+        auto record(std::size_t position, std::optional<Integer> value, double impact) -> void;
+        auto probe() -> void;
+
+    public:
+        /**
+         * \brief Keep impacts for \p vars.
+         *
+         * The caller must attach this to \p propagators as a domain change
+         * observer.
+         */
+        VariableImpact(std::vector<IntegerVariableID> vars, State & state, const Propagators & propagators);
+
+        VariableImpact(const VariableImpact &) = delete;
+        auto operator=(const VariableImpact &) -> VariableImpact & = delete;
+
+        /**
+         * \brief The unassigned variable whose values leave the least search
+         * space, summing one minus the impact of each value in its domain,
+         * with ties going to whichever comes first, or nullopt if every
+         * variable is assigned.
+         */
+        [[nodiscard]] auto select(const CurrentState & state) -> std::optional<IntegerVariableID>;
+
+        /**
+         * \brief The average impact of every decision made on \p var so
+         * far, which is zero if there have been none.
+         */
+        [[nodiscard]] auto impact_of(const IntegerVariableID & var) const -> double;
+
+        /**
+         * \brief The average impact of assigning \p var the value \p value,
+         * which falls back to impact_of(var) if it has never been made, or is
+         * not remembered.
+         */
+        [[nodiscard]] auto impact_of(const IntegerVariableID & var, Integer value) const -> double;
+
+        auto note_domain_change(SimpleIntegerVariableID var) -> void override;
+
+        auto note_everything_changed() -> void override;
+
+        auto note_propagation_starting(const Literals & guesses) -> void override;
+
+        auto note_propagation_finished(bool succeeded, const State & state) -> void override;
+    };
+}
+
+#endif
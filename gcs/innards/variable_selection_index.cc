@@ -0,0 +1,318 @@
+#include <gcs/current_state.hh>
+#include <gcs/innards/propagators.hh>
+#include <gcs/innards/state.hh>
+#include <gcs/innards/variable_selection_index.hh>
+#include <gcs/variable_weighting.hh>
+
+#include <util/overloaded.hh>
+
+#include <algorithm>
+
+using namespace gcs;
+using namespace gcs::innards;
+
+using std::max;
+using std::min;
+using std::move;
+using std::nullopt;
+using std::optional;
+using std::pair;
+using std::shared_ptr;
+using std::size_t;
+using std::vector;
+
+namespace
+{
+    auto simple_index_of(const IntegerVariableID & var) -> optional<size_t>
+    {
+        return overloaded{//
+            [](const SimpleIntegerVariableID & v) -> optional<size_t> { return v.index; },
+            [](const ViewOfIntegerVariableID & v) -> optional<size_t> { return v.actual_variable.index; },
+            [](const ConstantIntegerVariableID &) -> optional<size_t> {
+                return nullopt;
+            }}.visit(var);
+    }
+
+    // The |fut|>1 filter of weighted_degree_of(), for one constraint.
+    auto has_two_unassigned(const CurrentState & state, const Propagators & propagators, int constraint_index) -> bool
+    {
+        int futures = 0;
+        for (const auto & v : propagators.scope_of_constraint(constraint_index))
+            if (! state.has_single_value(v))
+                if (++futures >= 2)
+                    return true;
+        return false;
+    }
+}
+
+VariableSelectionIndex::VariableSelectionIndex(
+    vector<IntegerVariableID> vars, Order order, State & state, const Propagators & propagators, shared_ptr<VariableWeighting> weighting) :
+    _vars(move(vars)),
+    _order(order),
+    _trail(state.reversible_trail()),
+    _propagators(propagators),
+    _weighting(move(weighting)),
+    _size(_vars.size()),
+    _degree(_vars.size()),
+    _weight(_vars.size()),
+    _place_in_heap(_vars.size(), not_in_heap),
+    _changes_on_path(_trail, 0),
+    _built(_trail, 0)
+{
+    // Count the positions of each simple variable, then lay them out.
+    size_t end = 0;
+    for (const auto & v : _vars)
+        if (auto index = simple_index_of(v))
+            end = max(end, *index + 1);
+    _first_position_of.assign(end + 1, 0);
+    for (const auto & v : _vars)
+        if (auto index = simple_index_of(v))
+            ++_first_position_of[*index + 1];
+    for (size_t i = 1; i < _first_position_of.size(); ++i)
+        _first_position_of[i] += _first_position_of[i - 1];
+    _positions.resize(_first_position_of.back());
+    auto next = _first_position_of;
+    for (size_t p = 0; p < _vars.size(); ++p)
+        if (auto index = simple_index_of(_vars[p]))
+            _positions[next[*index]++] = p;
+}
+
+auto VariableSelectionIndex::positions_of(size_t var_index) const -> pair<size_t, size_t>
+{
+    if (var_index + 1 >= _first_position_of.size())
+        return pair{0, 0};
+    return pair{_first_position_of[var_index], _first_position_of[var_index + 1]};
+}
+
+auto VariableSelectionIndex::precedes(size_t a, size_t b) const -> bool
+{
+    // The same comparisons the scanning selectors made, in the same order,
+    // with the earlier position winning where they made no choice.
+    switch (_order) {
+    case Order::Dom:
+        if (_size[a] != _size[b])
+            return _size[a] < _size[b];
+        break;
+    case Order::DomThenDeg:
+        if (_size[a] != _size[b])
+            return _size[a] < _size[b];
+        if (_degree[a] != _degree[b])
+            return _degree[a] > _degree[b];
+        break;
+    case Order::DomWDeg: {
+        // Cross-multiplied dom(x)/W(x), so a variable with W(x)=0 sorts last.
+        auto lhs = static_cast<double>(_size[a]) * _weight[b];
+        auto rhs = static_cast<double>(_size[b]) * _weight[a];
+        if (lhs != rhs)
+            return lhs < rhs;
+        if (_degree[a] != _degree[b])
+            return _degree[a] > _degree[b];
+        break;
+    }
+    }
+    return a < b;
+}
+
+auto VariableSelectionIndex::sift_up(size_t i) -> void
+{
+    auto position = _heap[i];
+    while (i > 0) {
+        auto parent = (i - 1) / 2;
+        if (! precedes(position, _heap[parent]))
+            break;
+        _heap[i] = _heap[parent];
+        _place_in_heap[_heap[i]] = i;
+        i = parent;
+    }
+    _heap[i] = position;
+    _place_in_heap[position] = i;
+}
+
+auto VariableSelectionIndex::sift_down(size_t i) -> void
+{
+    auto position = _heap[i];
+    while (true) {
+        auto child = 2 * i + 1;
+        if (child >= _heap.size())
+            break;
+        if (child + 1 < _heap.size() && precedes(_heap[child + 1], _heap[child]))
+            ++child;
+        if (! precedes(_heap[child], position))
+            break;
+        _heap[i] = _heap[child];
+        _place_in_heap[_heap[i]] = i;
+        i = child;
+    }
+    _heap[i] = position;
+    _place_in_heap[position] = i;
+}
+
+auto VariableSelectionIndex::update(const CurrentState & state, size_t position) -> void
+{
+    auto size = state.domain_size(_vars[position]).raw_value;
+    _size[position] = size;
+    if (size >= 2) {
+        _degree[position] = _propagators.degree_of(_vars[position]);
+        if (_order == Order::DomWDeg)
+            _weight[position] = _weighting->weighted_degree_of(state, _propagators, _vars[position]);
+        if (_place_in_heap[position] == not_in_heap) {
+            _heap.push_back(position);
+            sift_up(_heap.size() - 1);
+        }
+        else {
+            sift_up(_place_in_heap[position]);
+            sift_down(_place_in_heap[position]);
+        }
+    }
+    else if (_place_in_heap[position] != not_in_heap) {
+        auto i = _place_in_heap[position];
+        auto last = _heap.back();
+        _heap.pop_back();
+        _place_in_heap[position] = not_in_heap;
+        if (last != position) {
+            _heap[i] = last;
+            _place_in_heap[last] = i;
+            sift_up(i);
+            sift_down(_place_in_heap[last]);
+        }
+    }
+}
+
+auto VariableSelectionIndex::mark_dirty(size_t var_index) -> void
+{
+    if (_is_dirty.size() <= var_index)
+        _is_dirty.resize(var_index + 1, 0);
+    if (! _is_dirty[var_index]) {
+        _is_dirty[var_index] = 1;
+        _dirty.push_back(var_index);
+    }
+}
+
+auto VariableSelectionIndex::forget_abandoned_changes() -> void
+{
+    // Anything logged past the point the current path had reached was
+    // changed on a path we have since backtracked out of, so its domain has
+    // changed back, and whatever key we gave it since then is wrong.
+    auto on_path = static_cast<size_t>(_changes_on_path.get(_trail));
+    if (on_path < _changes.size()) {
+        for (auto i = on_path; i < _changes.size(); ++i)
+            mark_dirty(_changes[i]);
+        _changes.resize(on_path);
+        _changes_looked_at = min(_changes_looked_at, on_path);
+    }
+}
+
+auto VariableSelectionIndex::refresh(const CurrentState & state, size_t var_index) -> void
+{
+    auto [begin, end] = positions_of(var_index);
+    for (auto p = begin; p != end; ++p)
+        update(state, _positions[p]);
+
+    if (_order == Order::DomWDeg && var_index < _was_assigned.size()) {
+        SimpleIntegerVariableID var{var_index};
+        bool assigned = state.has_single_value(var);
+        if (assigned != static_cast<bool>(_was_assigned[var_index])) {
+            _was_assigned[var_index] = assigned;
+            // Only a constraint that crosses the |fut|>1 threshold changes
+            // anyone's weighted degree, and then it changes the weighted
+            // degree of everything in it.
+            for (auto c : _propagators.constraint_indices_of_variable(var)) {
+                bool counts = has_two_unassigned(state, _propagators, c);
+                if (counts != static_cast<bool>(_constraint_counts[c])) {
+                    _constraint_counts[c] = counts;
+                    for (const auto & v : _propagators.scope_of_constraint(c)) {
+                        auto [v_begin, v_end] = positions_of(v.index);
+                        for (auto p = v_begin; p != v_end; ++p)
+                            update(state, _positions[p]);
+                    }
+                }
+            }
+        }
+    }
+}
+
+auto VariableSelectionIndex::rebuild(const CurrentState & state) -> void
+{
+    forget_abandoned_changes();
+    _changes_looked_at = _changes.size();
+    for (auto v : _dirty)
+        _is_dirty[v] = 0;
+    _dirty.clear();
+
+    if (_order == Order::DomWDeg) {
+        _constraint_counts.assign(_propagators.number_of_constraints(), 0);
+        for (size_t c = 0; c < _constraint_counts.size(); ++c) {
+            _constraint_counts[c] = has_two_unassigned(state, _propagators, static_cast<int>(c));
+            for (const auto & v : _propagators.scope_of_constraint(static_cast<int>(c))) {
+                if (_was_assigned.size() <= v.index)
+                    _was_assigned.resize(v.index + 1, 0);
+                _was_assigned[v.index] = state.has_single_value(v);
+            }
+        }
+    }
+
+    _heap.clear();
+    std::ranges::fill(_place_in_heap, not_in_heap);
+    for (size_t p = 0; p < _vars.size(); ++p)
+        update(state, p);
+
+    _must_rebuild = false;
+    _built.set(_trail, ++_builds);
+}
+
+auto VariableSelectionIndex::select(const CurrentState & state) -> optional<IntegerVariableID>
+{
+    if (_built.get(_trail) != _builds)
+        _must_rebuild = true;
+
+    if (_must_rebuild)
+        rebuild(state);
+    else {
+        forget_abandoned_changes();
+        for (; _changes_looked_at < _changes.size(); ++_changes_looked_at)
+            mark_dirty(_changes[_changes_looked_at]);
+        for (auto v : _dirty) {
+            _is_dirty[v] = 0;
+            refresh(state, v);
+        }
+        _dirty.clear();
+    }
+
+    if (_heap.empty())
+        return nullopt;
+    return _vars[_heap.front()];
+}
+
+auto VariableSelectionIndex::note_domain_change(SimpleIntegerVariableID var) -> void
+{
+    // For dom/wdeg, a variable we are not branching on can still change the
+    // weighted degree of one that we are.
+    if (_order != Order::DomWDeg) {
+        auto [begin, end] = positions_of(var.index);
+        if (begin == end)
+            return;
+    }
+
+    forget_abandoned_changes();
+    _changes.push_back(var.index);
+    _changes_on_path.set(_trail, static_cast<long long>(_changes.size()));
+}
+
+auto VariableSelectionIndex::note_everything_changed() -> void
+{
+    _must_rebuild = true;
+}
+
+auto VariableSelectionIndex::note_conflict(int constraint_index, const vector<SimpleIntegerVariableID> &, const optional<Reason> &, const State &)
+    -> void
+{
+    // The weighting has just changed this constraint's weight, which is part
+    // of the weighted degree of everything in it.
+    for (const auto & v : _propagators.scope_of_constraint(constraint_index))
+        mark_dirty(v.index);
+}
+
+auto VariableSelectionIndex::on_restart() -> void
+{
+    _must_rebuild = true;
+}
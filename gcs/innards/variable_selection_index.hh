@@ -0,0 +1,159 @@
+#ifndef GLASGOW_CONSTRAINT_SOLVER_GUARD_GCS_INNARDS_VARIABLE_SELECTION_INDEX_HH
+#define GLASGOW_CONSTRAINT_SOLVER_GUARD_GCS_INNARDS_VARIABLE_SELECTION_INDEX_HH
+
+#include <gcs/innards/conflict_observer.hh>
+#include <gcs/innards/domain_change_observer.hh>
+#include <gcs/innards/propagators-fwd.hh>
+#include <gcs/innards/reversible.hh>
+#include <gcs/innards/state-fwd.hh>
+#include <gcs/variable_id.hh>
+
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace gcs
+{
+    class CurrentState;
+    class VariableWeighting;
+}
+
+namespace gcs::innards
+{
+    /**
+     * \brief The variable that gcs::variable_order::dom(), dom_then_deg() or
+     * dom_wdeg() would pick, kept up to date as search goes rather than found
+     * by looking at every variable at every node.
+     *
+     * The unassigned variables are kept in a binary heap, ordered the way the
+     * heuristic orders them, with ties going to whichever comes first in the
+     * list of variables, so the top of the heap is exactly what a scan of the
+     * list would choose. Assigned variables are not in the heap at all. The
+     * index is attached to the Propagators as a DomainChangeObserver, and
+     * writes down each variable it is told about in a log. A Reversible holds
+     * how much of the log belongs to the path search is on, so after a
+     * backtrack, whatever is past that point in the log is what search has
+     * just undone. Selecting a variable first gives new keys to those, and to
+     * the variables logged since the last selection, and so costs a
+     * logarithmic amount for each variable changed since then rather than a
+     * linear amount for all of them.
+     *
+     * For dom/wdeg, the weighted degree of a variable also changes when a
+     * constraint it is in gets a conflict, which the index hears about by
+     * also being a ConflictObserver (attached after the weighting, so the
+     * weights have already moved), and when one of its constraints is left
+     * with fewer than two unassigned variables, or gets them back. For the
+     * latter, the index keeps track of which constraints have at least two
+     * unassigned variables, and looks again at those of a variable whose
+     * assignedness has changed. A restart may rescale every weight, so the
+     * whole index is rebuilt after one. Weighted degrees are always
+     * recomputed with VariableWeighting::weighted_degree_of(), so they are
+     * the same numbers the scan would have compared.
+     *
+     * The index relies upon every change to the domains of its variables
+     * after it is first used coming through Propagators::propagate(), either
+     * as a guess or from a propagator.
+     *
+     * \ingroup Innards
+     */
+    class VariableSelectionIndex final : public DomainChangeObserver, public ConflictObserver
+    {
+    public:
+        /**
+         * \brief Which heuristic's order to keep.
+         */
+        enum class Order
+        {
+            Dom,
+            DomThenDeg,
+            DomWDeg
+        };
+
+    private:
+        static constexpr std::size_t not_in_heap = static_cast<std::size_t>(-1);
+
+        std::vector<IntegerVariableID> _vars;
+        Order _order;
+        ReversibleTrail & _trail;
+        const Propagators & _propagators;
+        std::shared_ptr<VariableWeighting> _weighting;
+
+        // Positions in _vars of each simple variable, by its index, as
+        // _positions[_first_position_of[i]] up to _first_position_of[i + 1].
+        std::vector<std::size_t> _first_position_of, _positions;
+
+        // The key of each position, as of when it was last looked at.
+        std::vector<long long> _size;
+        std::vector<long> _degree;
+        std::vector<double> _weight;
+
+        std::vector<std::size_t> _heap, _place_in_heap;
+
+        // Every simple variable we have been told about, in order. Only the
+        // first _changes_on_path of them were changed on the current path,
+        // and only the first _changes_looked_at of those have been put back
+        // into the heap since.
+        std::vector<std::size_t> _changes;
+        Reversible<long long> _changes_on_path;
+        std::size_t _changes_looked_at = 0;
+
+        std::vector<std::size_t> _dirty;
+        std::vector<char> _is_dirty;
+
+        // For dom/wdeg: whether each simple variable was assigned, and whether
+        // each constraint had at least two unassigned variables, as of when we
+        // last looked.
+        std::vector<char> _was_assigned, _constraint_counts;
+
+        // Bumped each time we rebuild, and also written to a Reversible, so
+        // that if they differ then search has backtracked past a rebuild, and
+        // we need another one.
+        long long _builds = 0;
+        Reversible<long long> _built;
+        bool _must_rebuild = true;
+
+        [[nodiscard]] auto positions_of(std::size_t var_index) const -> std::pair<std::size_t, std::size_t>;
+        [[nodiscard]] auto precedes(std::size_t a, std::size_t b) const -> bool;
+        auto sift_up(std::size_t i) -> void;
+        auto sift_down(std::size_t i) -> void;
+        auto update(const CurrentState & state, std::size_t position) -> void;
+        auto mark_dirty(std::size_t var_index) -> void;
+        auto forget_abandoned_changes() -> void;
+        auto refresh(const CurrentState & state, std::size_t var_index) -> void;
+        auto rebuild(const CurrentState & state) -> void;
+
+    public:
+        /**
+         * \brief Index \p vars in the given order, which for Order::DomWDeg
+         * needs a \p weighting.
+         *
+         * The caller must attach the index to \p propagators, as a domain
+         * change observer, and for Order::DomWDeg also as a conflict observer
+         * after \p weighting.
+         */
+        VariableSelectionIndex(std::vector<IntegerVariableID> vars, Order order, State & state, const Propagators & propagators,
+            std::shared_ptr<VariableWeighting> weighting = nullptr);
+
+        VariableSelectionIndex(const VariableSelectionIndex &) = delete;
+        auto operator=(const VariableSelectionIndex &) -> VariableSelectionIndex & = delete;
+
+        /**
+         * \brief The variable to branch on, or nullopt if every variable is
+         * assigned.
+         */
+        [[nodiscard]] auto select(const CurrentState & state) -> std::optional<IntegerVariableID>;
+
+        auto note_domain_change(SimpleIntegerVariableID var) -> void override;
+
+        auto note_everything_changed() -> void override;
+
+        auto note_conflict(int constraint_index, const std::vector<SimpleIntegerVariableID> & scope, const std::optional<Reason> & reason,
+            const State & state) -> void override;
+
+        auto on_restart() -> void override;
+    };
+}
+
+#endif
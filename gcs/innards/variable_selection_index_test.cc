@@ -0,0 +1,162 @@
+#include <gcs/constraints/comparison.hh>
+#include <gcs/constraints/equals.hh>
+#include <gcs/constraints/linear.hh>
+#include <gcs/current_state.hh>
+#include <gcs/innards/propagators.hh>
+#include <gcs/innards/state.hh>
+#include <gcs/innards/variable_selection_index.hh>
+#include <gcs/problem.hh>
+#include <gcs/search_heuristics.hh>
+#include <gcs/solve.hh>
+#include <gcs/variable_weighting.hh>
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+
+#include <memory>
+#include <optional>
+#include <random>
+#include <vector>
+
+using namespace gcs;
+using namespace gcs::innards;
+
+using std::make_shared;
+using std::mt19937;
+using std::nullopt;
+using std::optional;
+using std::shared_ptr;
+using std::vector;
+
+namespace
+{
+    // The linear scan that the index replaces, written out the long way.
+    auto scan(const CurrentState & state, const Propagators & propagators, const vector<IntegerVariableID> & vars,
+        VariableSelectionIndex::Order order, const VariableWeighting * weighting) -> optional<IntegerVariableID>
+    {
+        optional<IntegerVariableID> result;
+        double dom_result = 0.0, w_result = 0.0;
+        for (const auto & v : vars) {
+            if (state.domain_size(v) < 2_i)
+                continue;
+            auto dom_v = static_cast<double>(state.domain_size(v).raw_value);
+            auto w_v = weighting ? weighting->weighted_degree_of(state, propagators, v) : 0.0;
+            bool better = false;
+            if (! result)
+                better = true;
+            else {
+                switch (order) {
+                case VariableSelectionIndex::Order::Dom: better = state.domain_size(v) < state.domain_size(*result); break;
+                case VariableSelectionIndex::Order::DomThenDeg:
+                    better = state.domain_size(v) < state.domain_size(*result) ||
+                        (state.domain_size(v) == state.domain_size(*result) && propagators.degree_of(v) > propagators.degree_of(*result));
+                    break;
+                case VariableSelectionIndex::Order::DomWDeg: {
+                    auto lhs = dom_v * w_result, rhs = dom_result * w_v;
+                    better = (lhs != rhs) ? (lhs < rhs) : (propagators.degree_of(v) > propagators.degree_of(*result));
+                    break;
+                }
+                }
+            }
+            if (better) {
+                result = v;
+                dom_result = dom_v;
+                w_result = w_v;
+            }
+        }
+        return result;
+    }
+}
+
+TEST_CASE("Variable selection index chooses what a scan would, all through search")
+{
+    using enum VariableSelectionIndex::Order;
+    auto order = GENERATE(Dom, DomThenDeg, DomWDeg);
+    auto restarts = GENERATE(false, true);
+    auto seed = GENERATE(1u, 2u, 3u, 4u, 5u);
+
+    // A random problem, with enough going on that search fails and backtracks
+    // a lot. The list of variables includes views and a repeat, which
+    // the index must treat the way the scan does.
+    mt19937 rand(seed);
+    Problem problem;
+    int n = 16;
+    auto xs = problem.create_integer_variable_vector(n, 0_i, 3_i);
+    for (int c = 0; c < 8 * n; ++c) {
+        auto a = rand() % n, b = rand() % n, d = rand() % n;
+        if (a == b)
+            continue;
+        switch (rand() % 4) {
+        case 0: problem.post(NotEquals{xs[a], xs[b]}); break;
+        case 1: problem.post(NotEquals{xs[a] + 1_i, xs[b]}); break;
+        case 2: problem.post(LessThanEqual{xs[a], xs[b] + 2_i}); break;
+        case 3: problem.post(WeightedSum{} + 1_i * xs[a] + 1_i * xs[b] + 1_i * xs[d] <= 6_i); break;
+        }
+    }
+    vector<IntegerVariableID> vars;
+    for (int i = 0; i < n; ++i)
+        vars.push_back(i % 3 == 0 ? IntegerVariableID{-xs[i]} : IntegerVariableID{xs[i]});
+    vars.push_back(xs[0]);
+
+    int nodes = 0, mismatches = 0, solutions = 0;
+    auto checked = [&](const Problem &, State & state, Propagators & propagators) -> BranchVariableSelector {
+        shared_ptr<VariableWeighting> weighting;
+        if (order == DomWDeg) {
+            weighting = make_shared<ClassicDomWDeg>(propagators);
+            propagators.add_conflict_observer(weighting.get());
+        }
+        auto index = make_shared<VariableSelectionIndex>(vars, order, state, propagators, weighting);
+        propagators.add_domain_change_observer(index.get());
+        if (order == DomWDeg)
+            propagators.add_conflict_observer(index.get());
+        return [&, index, weighting](const CurrentState & s, const Propagators & p) -> optional<IntegerVariableID> {
+            auto chosen = index->select(s);
+            ++nodes;
+            if (chosen != scan(s, p, vars, order, weighting.get()))
+                ++mismatches;
+            return chosen;
+        };
+    };
+
+    SolveCallbacks callbacks{.solution = [&](const CurrentState &) -> bool { return ++solutions < 100; },
+        .branch = branch_with(checked, value_order::smallest_first())};
+    if (restarts)
+        callbacks.restarts = RestartSchedule::luby(2);
+    auto stats = solve_with(problem, callbacks);
+
+    CHECK(nodes > 0);
+    CHECK(mismatches == 0);
+    if (restarts)
+        CHECK(stats.restarts > 0);
+}
+
+TEST_CASE("Variable selection index follows guesses and backtracking")
+{
+    State state;
+    auto a = state.allocate_integer_variable_with_state(0_i, 9_i);
+    auto b = state.allocate_integer_variable_with_state(0_i, 9_i);
+    Stats stats;
+    Propagators propagators{stats};
+
+    VariableSelectionIndex index{{a, b}, VariableSelectionIndex::Order::Dom, state, propagators};
+    propagators.add_domain_change_observer(&index);
+
+    // Ties go to the first variable.
+    CHECK(index.select(state.current()) == optional<IntegerVariableID>{a});
+
+    // Shrinking b under a guess makes it the smallest, and backtracking puts
+    // things back as they were.
+    auto timestamp = state.new_epoch();
+    state.guess(b < 3_i);
+    REQUIRE(propagators.propagate(Literals{b < 3_i}, state, nullptr));
+    CHECK(index.select(state.current()) == optional<IntegerVariableID>{b});
+
+    state.guess(b == 1_i);
+    REQUIRE(propagators.propagate(Literals{b == 1_i}, state, nullptr));
+    state.guess(a == 1_i);
+    REQUIRE(propagators.propagate(Literals{a == 1_i}, state, nullptr));
+    CHECK(index.select(state.current()) == nullopt);
+
+    state.backtrack(timestamp);
+    CHECK(index.select(state.current()) == optional<IntegerVariableID>{a});
+}
@@ -5,7 +5,10 @@
 
 #include <gch/small_vector.hpp>
 
+#include <cstddef>
 #include <cstdlib>
+#include <iterator>
+#include <ranges>
 #include <type_traits>
 #include <utility>
 #include <version>
@@ -33,7 +36,8 @@ namespace gcs
      * set too) must outlive the generator, and must not be modified while the
      * generator is live. To modify a set based upon what an iteration finds,
      * either iterate over a copy, or build a new set and move-assign it
-     * afterwards.
+     * afterwards. The same goes for the ranges from values() and
+     * values_reversed(), which borrow the set without allocating a generator.
      *
      * \tparam Int_ The integer type used for values and bounds. Must support arithmetic
      * and comparison operators, and construction from a literal zero or one.
@@ -464,6 +468,65 @@ namespace gcs
             }
         }
 
+        /**
+         * \brief Calls \p f(value) for each value in the set in descending order.
+         *
+         * The for_each() counterpart of each_reversed(). If \p f returns \c bool,
+         * returning \c false stops iteration early.
+         *
+         * \sa each_reversed(), for_each()
+         */
+        template <typename F_>
+        auto for_each_reversed(F_ && f) const -> void
+        {
+            for (auto lu = intervals.rbegin(); lu != intervals.rend(); ++lu)
+                for (Int_ i = lu->second; i >= lu->first; --i) {
+                    if constexpr (std::is_void_v<std::invoke_result_t<F_ &, Int_>>)
+                        f(i);
+                    else if (! f(i))
+                        return;
+                }
+        }
+
+        /**
+         * \brief Calls \p f(lower, upper) for each stored interval, in ascending
+         * order.
+         *
+         * The for_each() counterpart of each_interval(), for callers that can
+         * deal with a whole run of values at once. If \p f returns \c bool,
+         * returning \c false stops iteration early.
+         *
+         * \sa each_interval(), for_each(), for_each_interval_reversed()
+         */
+        template <typename F_>
+        auto for_each_interval(F_ && f) const -> void
+        {
+            for (const auto & [l, u] : intervals) {
+                if constexpr (std::is_void_v<std::invoke_result_t<F_ &, Int_, Int_>>)
+                    f(l, u);
+                else if (! f(l, u))
+                    return;
+            }
+        }
+
+        /**
+         * \brief Calls \p f(lower, upper) for each stored interval, in descending
+         * order. If \p f returns \c bool, returning \c false stops iteration
+         * early.
+         *
+         * \sa for_each_interval()
+         */
+        template <typename F_>
+        auto for_each_interval_reversed(F_ && f) const -> void
+        {
+            for (auto lu = intervals.rbegin(); lu != intervals.rend(); ++lu) {
+                if constexpr (std::is_void_v<std::invoke_result_t<F_ &, Int_, Int_>>)
+                    f(lu->first, lu->second);
+                else if (! f(lu->first, lu->second))
+                    return;
+            }
+        }
+
         /**
          * \brief Returns a generator that yields each stored interval as a
          * (lower, upper) pair, in ascending order.
@@ -596,6 +659,111 @@ namespace gcs
             }(intervals);
         }
 
+        /**
+         * \brief A forward iterator over each value in the set, in ascending
+         * order, or in descending order if \p reversed_ is true.
+         *
+         * Compares equal to std::default_sentinel once every value has been
+         * visited. Borrows the set in the same way the generators do.
+         *
+         * \sa values(), values_reversed()
+         */
+        template <bool reversed_>
+        class ValueIterator
+        {
+        private:
+            using IntervalIterator = std::conditional_t<reversed_, typename Intervals::const_reverse_iterator, typename Intervals::const_iterator>;
+
+            IntervalIterator _interval{}, _end{};
+            Int_ _value = Int_(0);
+
+            [[nodiscard]] auto first_of_interval() const -> Int_
+            {
+                return reversed_ ? _interval->second : _interval->first;
+            }
+
+            [[nodiscard]] auto last_of_interval() const -> Int_
+            {
+                return reversed_ ? _interval->first : _interval->second;
+            }
+
+        public:
+            using value_type = Int_;
+            using difference_type = std::ptrdiff_t;
+            using iterator_concept = std::forward_iterator_tag;
+
+            ValueIterator() = default;
+
+            ValueIterator(IntervalIterator interval, IntervalIterator end) : _interval(interval), _end(end)
+            {
+                if (_interval != _end)
+                    _value = first_of_interval();
+            }
+
+            [[nodiscard]] auto operator*() const -> Int_
+            {
+                return _value;
+            }
+
+            auto operator++() -> ValueIterator &
+            {
+                if (_value != last_of_interval()) {
+                    if constexpr (reversed_)
+                        --_value;
+                    else
+                        ++_value;
+                }
+                else if (++_interval != _end)
+                    _value = first_of_interval();
+                return *this;
+            }
+
+            auto operator++(int) -> ValueIterator
+            {
+                auto result = *this;
+                ++*this;
+                return result;
+            }
+
+            [[nodiscard]] auto operator==(const ValueIterator & other) const -> bool
+            {
+                return _interval == other._interval && (_interval == _end || _value == other._value);
+            }
+
+            [[nodiscard]] auto operator==(std::default_sentinel_t) const -> bool
+            {
+                return _interval == _end;
+            }
+        };
+
+        /**
+         * \brief Returns a range over each value in the set in ascending order.
+         *
+         * Unlike each(), this needs no heap-allocated coroutine frame, and the
+         * result can be used with the standard range adaptors and algorithms.
+         * It borrows this set, which must outlive it and must not be modified
+         * while iterating.
+         *
+         * \sa each(), values_reversed()
+         */
+        [[nodiscard]] auto values() const -> std::ranges::subrange<ValueIterator<false>, std::default_sentinel_t>
+        {
+            return {ValueIterator<false>{intervals.begin(), intervals.end()}, std::default_sentinel};
+        }
+
+        /**
+         * \brief Returns a range over each value in the set in descending order.
+         *
+         * The non-allocating counterpart of each_reversed(), borrowing the set
+         * just as values() does.
+         *
+         * \sa each_reversed(), values()
+         */
+        [[nodiscard]] auto values_reversed() const -> std::ranges::subrange<ValueIterator<true>, std::default_sentinel_t>
+        {
+            return {ValueIterator<true>{intervals.rbegin(), intervals.rend()}, std::default_sentinel};
+        }
+
         ///@}
     };
 }
@@ -959,3 +959,62 @@ TEST_CASE("intersect_with brute-force cross-check with multi-interval sets")
         for (const auto & b : {s0, s1, s2, s3, s4, s5})
             CHECK(expand(intersected_with(a, b)) == brute_force(a, b));
 }
+
+TEST_CASE("Value ranges match the generators")
+{
+    IntervalSet<int> set(1, 10);
+    set.erase(4);
+    set.erase(5);
+    set.erase(8);
+    // {[1,3],[6,7],[9,10]}
+
+    vector<int> each, values, each_reversed, values_reversed;
+    for (auto v : set.each())
+        each.push_back(v);
+    for (auto v : set.values())
+        values.push_back(v);
+    for (auto v : set.each_reversed())
+        each_reversed.push_back(v);
+    for (auto v : set.values_reversed())
+        values_reversed.push_back(v);
+    CHECK(values == each);
+    CHECK(values_reversed == each_reversed);
+
+    IntervalSet<int> empty;
+    CHECK(empty.values().empty());
+    CHECK(empty.values_reversed().empty());
+}
+
+TEST_CASE("For each reversed and for each interval, with early exit")
+{
+    IntervalSet<int> set(1, 10);
+    set.erase(4);
+    set.erase(5);
+    // {[1,3],[6,10]}
+
+    vector<int> rev;
+    set.for_each_reversed([&](int v) { rev.push_back(v); });
+    CHECK(rev == vector<int>{10, 9, 8, 7, 6, 3, 2, 1});
+
+    rev.clear();
+    set.for_each_reversed([&](int v) -> bool {
+        rev.push_back(v);
+        return v != 7;
+    });
+    CHECK(rev == vector<int>{10, 9, 8, 7});
+
+    vector<pair<int, int>> intervals;
+    set.for_each_interval([&](int l, int u) { intervals.emplace_back(l, u); });
+    CHECK(intervals == vector<pair<int, int>>{{1, 3}, {6, 10}});
+
+    intervals.clear();
+    set.for_each_interval_reversed([&](int l, int u) { intervals.emplace_back(l, u); });
+    CHECK(intervals == vector<pair<int, int>>{{6, 10}, {1, 3}});
+
+    intervals.clear();
+    set.for_each_interval([&](int l, int u) -> bool {
+        intervals.emplace_back(l, u);
+        return false;
+    });
+    CHECK(intervals == vector<pair<int, int>>{{1, 3}});
+}
@@ -0,0 +1,216 @@
+#include <gcs/innards/propagators.hh>
+#include <gcs/large_neighbourhood_search.hh>
+
+#include <util/overloaded.hh>
+
+#include <algorithm>
+#include <deque>
+#include <memory>
+#include <numeric>
+#include <random>
+
+using namespace gcs;
+using namespace gcs::innards;
+
+using std::deque;
+using std::iota;
+using std::make_shared;
+using std::move;
+using std::mt19937;
+using std::nullopt;
+using std::optional;
+using std::random_device;
+using std::shared_ptr;
+using std::size_t;
+using std::uint_fast32_t;
+using std::uniform_int_distribution;
+using std::vector;
+using std::ranges::shuffle;
+
+namespace
+{
+    // As in search_heuristics.cc, the random number generator is shared
+    // between copies of the closure, and so between iterations.
+    auto make_shared_rng() -> shared_ptr<mt19937>
+    {
+        random_device rd;
+        return make_shared<mt19937>(rd());
+    }
+
+    auto simple_index_of(const IntegerVariableID & var) -> optional<size_t>
+    {
+        return overloaded{//
+            [](const SimpleIntegerVariableID & v) -> optional<size_t> { return v.index; },
+            [](const ViewOfIntegerVariableID & v) -> optional<size_t> { return v.actual_variable.index; },
+            [](const ConstantIntegerVariableID &) -> optional<size_t> {
+                return nullopt;
+            }}.visit(var);
+    }
+
+    auto random_positions(size_t how_many, mt19937 & rand) -> vector<size_t>
+    {
+        vector<size_t> result(how_many);
+        iota(result.begin(), result.end(), 0);
+        shuffle(result, rand);
+        return result;
+    }
+
+    auto fix_in_random_order(shared_ptr<mt19937> rand, const vector<IntegerVariableID> & vars) -> std::generator<IntegerVariableID>
+    {
+        for (auto p : random_positions(vars.size(), *rand))
+            co_yield vars[p];
+    }
+
+    auto fix_guided_by_propagation(shared_ptr<mt19937> rand, const vector<IntegerVariableID> & vars, const CurrentState & state)
+        -> std::generator<IntegerVariableID>
+    {
+        auto order = random_positions(vars.size(), *rand);
+        size_t next_in_order = 0;
+
+        vector<long long> sizes(vars.size());
+        for (size_t p = 0; p < vars.size(); ++p)
+            sizes[p] = state.domain_size(vars[p]).raw_value;
+        vector<char> given(vars.size(), 0);
+
+        while (true) {
+            // Look at what the last fixing did, and remember the new sizes for
+            // next time. A fixing that failed was undone, so its variables are
+            // no smaller than they were, and do not count.
+            optional<size_t> chosen;
+            double most_reduced = 0.0;
+            for (size_t p = 0; p < vars.size(); ++p) {
+                auto size = state.domain_size(vars[p]).raw_value;
+                if (! given[p] && size > 1 && size < sizes[p]) {
+                    auto reduction = static_cast<double>(sizes[p] - size) / static_cast<double>(sizes[p]);
+                    if (reduction > most_reduced) {
+                        most_reduced = reduction;
+                        chosen = p;
+                    }
+                }
+                sizes[p] = size;
+            }
+
+            if (! chosen) {
+                while (next_in_order < order.size() && (given[order[next_in_order]] || state.has_single_value(vars[order[next_in_order]])))
+                    ++next_in_order;
+                if (next_in_order == order.size())
+                    co_return;
+                chosen = order[next_in_order];
+            }
+
+            given[*chosen] = 1;
+            co_yield vars[*chosen];
+        }
+    }
+
+    auto fix_by_constraint_structure(shared_ptr<mt19937> rand, const vector<IntegerVariableID> & vars, const Propagators & propagators)
+        -> std::generator<IntegerVariableID>
+    {
+        if (vars.empty())
+            co_return;
+
+        // The positions in vars of each simple variable, by its index.
+        vector<vector<size_t>> positions;
+        for (size_t p = 0; p < vars.size(); ++p)
+            if (auto index = simple_index_of(vars[p])) {
+                if (positions.size() <= *index)
+                    positions.resize(*index + 1);
+                positions[*index].push_back(p);
+            }
+
+        // Breadth first out from a random variable, through every variable and
+        // not only those in vars, since an auxiliary variable can be what
+        // connects two that are.
+        vector<size_t> nearest_first;
+        vector<char> reached(vars.size(), 0);
+        vector<char> seen_variable;
+        vector<char> seen_constraint(propagators.number_of_constraints(), 0);
+        deque<size_t> queue;
+
+        auto see = [&](size_t var_index) {
+            if (seen_variable.size() <= var_index)
+                seen_variable.resize(var_index + 1, 0);
+            if (seen_variable[var_index])
+                return;
+            seen_variable[var_index] = 1;
+            queue.push_back(var_index);
+        };
+
+        if (auto start = simple_index_of(vars[uniform_int_distribution<size_t>{0, vars.size() - 1}(*rand)]))
+            see(*start);
+        while (! queue.empty()) {
+            auto var_index = queue.front();
+            queue.pop_front();
+            if (var_index < positions.size())
+                for (auto p : positions[var_index])
+                    if (! reached[p]) {
+                        reached[p] = 1;
+                        nearest_first.push_back(p);
+                    }
+            for (auto c : propagators.constraint_indices_of_variable(SimpleIntegerVariableID{var_index}))
+                if (! seen_constraint[c]) {
+                    seen_constraint[c] = 1;
+                    for (const auto & v : propagators.scope_of_constraint(c))
+                        see(v.index);
+                }
+        }
+
+        for (auto p : random_positions(vars.size(), *rand))
+            if (! reached[p])
+                co_yield vars[p];
+        for (auto p = nearest_first.rbegin(); p != nearest_first.rend(); ++p)
+            co_yield vars[*p];
+    }
+
+    auto random_neighbourhood(shared_ptr<mt19937> rand) -> NeighbourhoodGenerator
+    {
+        return [rand = move(rand)](const vector<IntegerVariableID> & vars, const CurrentState &, const CurrentState &, const Propagators &) {
+            return fix_in_random_order(rand, vars);
+        };
+    }
+
+    auto propagation_guided_neighbourhood(shared_ptr<mt19937> rand) -> NeighbourhoodGenerator
+    {
+        return [rand = move(rand)](const vector<IntegerVariableID> & vars, const CurrentState & state, const CurrentState &, const Propagators &) {
+            return fix_guided_by_propagation(rand, vars, state);
+        };
+    }
+
+    auto constraint_structured_neighbourhood(shared_ptr<mt19937> rand) -> NeighbourhoodGenerator
+    {
+        return [rand = move(rand)](
+                   const vector<IntegerVariableID> & vars, const CurrentState &, const CurrentState &, const Propagators & propagators) {
+            return fix_by_constraint_structure(rand, vars, propagators);
+        };
+    }
+}
+
+auto gcs::neighbourhood::random() -> NeighbourhoodGenerator
+{
+    return random_neighbourhood(make_shared_rng());
+}
+
+auto gcs::neighbourhood::random(uint_fast32_t seed) -> NeighbourhoodGenerator
+{
+    return random_neighbourhood(make_shared<mt19937>(seed));
+}
+
+auto gcs::neighbourhood::propagation_guided() -> NeighbourhoodGenerator
+{
+    return propagation_guided_neighbourhood(make_shared_rng());
+}
+
+auto gcs::neighbourhood::propagation_guided(uint_fast32_t seed) -> NeighbourhoodGenerator
+{
+    return propagation_guided_neighbourhood(make_shared<mt19937>(seed));
+}
+
+auto gcs::neighbourhood::constraint_structured() -> NeighbourhoodGenerator
+{
+    return constraint_structured_neighbourhood(make_shared_rng());
+}
+
+auto gcs::neighbourhood::constraint_structured(uint_fast32_t seed) -> NeighbourhoodGenerator
+{
+    return constraint_structured_neighbourhood(make_shared<mt19937>(seed));
+}
@@ -0,0 +1,207 @@
+#ifndef GLASGOW_CONSTRAINT_SOLVER_GUARD_GCS_LARGE_NEIGHBOURHOOD_SEARCH_HH
+#define GLASGOW_CONSTRAINT_SOLVER_GUARD_GCS_LARGE_NEIGHBOURHOOD_SEARCH_HH
+
+#include <gcs/current_state.hh>
+#include <gcs/innards/propagators-fwd.hh>
+#include <gcs/variable_id.hh>
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <vector>
+#include <version>
+
+#ifdef __cpp_lib_generator
+#include <generator>
+#else
+#include <__generator.hpp>
+#endif
+
+namespace gcs
+{
+    /**
+     * \brief Chooses which variables one iteration of large neighbourhood
+     * search fixes to their values in the best solution so far.
+     *
+     * Called with the variables the search was asked to work on, the live
+     * state, the best solution so far, and the propagators, and returns a
+     * generator of variables, in the order they should be fixed. The
+     * generator is resumed only after the variable it last gave has been
+     * fixed and propagated, so it can look at the live state to see what that
+     * fixing did, which is how gcs::neighbourhood::propagation_guided() works.
+     * A variable that is already assigned, or whose value in the best solution
+     * is no longer in its domain, is skipped, as is one whose fixing fails.
+     * The generator is not resumed again once enough variables have been
+     * fixed (see LargeNeighbourhoodSearch::fix_fraction), and so may go on
+     * forever.
+     *
+     * \warning The references are into live solver internals, and are valid
+     * only until the generator is destroyed, which happens before the
+     * remaining variables are searched.
+     *
+     * \ingroup SolveCallbacks
+     * \sa gcs::neighbourhood
+     */
+    using NeighbourhoodGenerator = std::function<std::generator<IntegerVariableID>(
+        const std::vector<IntegerVariableID> &, const CurrentState &, const CurrentState &, const innards::Propagators &)>;
+
+    /**
+     * \brief Asks gcs::solve_with() to minimise by large neighbourhood search,
+     * rather than by branch and bound alone.
+     *
+     * Search first looks for a solution in the usual way, using
+     * SolveCallbacks::restarts if it is set. From then on, each iteration
+     * opens a new epoch, fixes some of the variables to their values in the
+     * best solution so far, choosing them with one of the \ref neighbourhoods,
+     * and then searches whatever is left, with the objective bounded by the
+     * best solution so far, until that search has seen \ref conflict_limit
+     * conflicts, just as a restart would cut it off. Any solution found is
+     * better than the last, and is kept as the new best. The state is then
+     * backtracked to the root, and the next iteration begins.
+     *
+     * Search stops, without a proof of optimality, once either limit is
+     * reached, if the abort flag is set, or if the solution callback returns
+     * false. It stops having proved optimality, and calls
+     * SolveCallbacks::completed, if the first search completes, or if an
+     * iteration that fixed nothing searches everything without being cut off.
+     *
+     * Only minimisation problems are supported, and neither proof logging nor
+     * SolveCallbacks::parallel may be used with it. Nogoods are learned only
+     * by the first search, because they would not hold without the fixings
+     * that an iteration made.
+     *
+     * \ingroup SolveCallbacks
+     */
+    struct LargeNeighbourhoodSearch final
+    {
+        /**
+         * \brief The variables that may be fixed, with empty meaning every
+         * variable in the problem except for the objective.
+         */
+        std::vector<IntegerVariableID> variables = {};
+
+        /**
+         * \brief How to choose the variables to fix, used in turn, one per
+         * iteration.
+         *
+         * Empty means gcs::neighbourhood::random(),
+         * gcs::neighbourhood::propagation_guided(), and
+         * gcs::neighbourhood::constraint_structured(), seeded from \ref seed.
+         */
+        std::vector<NeighbourhoodGenerator> neighbourhoods = {};
+
+        /**
+         * \brief What fraction of \ref variables an iteration fixes, counting
+         * only those it fixes itself and not those that propagation then
+         * assigns.
+         */
+        double fix_fraction = 0.7;
+
+        /**
+         * \brief Whether to change \ref fix_fraction as search goes.
+         *
+         * If set, an iteration that searches everything that was left without
+         * being cut off fixes too much, so the fraction goes down by 0.05, and
+         * one that is cut off without finding a better solution fixes too
+         * little, so the fraction goes up by 0.05.
+         */
+        bool adapt_fix_fraction = true;
+
+        /**
+         * \brief How many conflicts the search in each iteration may see.
+         */
+        unsigned long long conflict_limit = 100;
+
+        /**
+         * \brief Stop after this many iterations, with unset meaning no limit.
+         */
+        std::optional<unsigned long long> iteration_limit = std::nullopt;
+
+        /**
+         * \brief Stop once this long has passed since the first search
+         * started, with unset meaning no limit.
+         *
+         * Only checked between iterations, so search may go on for as long as
+         * one iteration takes afterwards, and the first search does not look
+         * at it at all.
+         */
+        std::optional<std::chrono::milliseconds> time_limit = std::nullopt;
+
+        /**
+         * \brief The seed for the default \ref neighbourhoods.
+         */
+        std::uint_fast32_t seed = 0;
+    };
+
+    /**
+     * Neighbourhoods for gcs::LargeNeighbourhoodSearch.
+     */
+    namespace neighbourhood
+    {
+        /**
+         * Fix variables in a random order, seeded non-deterministically.
+         *
+         * \ingroup SolveCallbacks
+         */
+        [[nodiscard]] auto random() -> NeighbourhoodGenerator;
+
+        /**
+         * Fix variables in a random order, with an explicit seed for
+         * reproducible debugging.
+         *
+         * \ingroup SolveCallbacks
+         */
+        [[nodiscard]] auto random(std::uint_fast32_t seed) -> NeighbourhoodGenerator;
+
+        /**
+         * Propagation-guided neighbourhoods, as described by Perron, Shaw and
+         * Furnon (CP 2004), seeded non-deterministically.
+         *
+         * The first variable is chosen at random. After that, the variable
+         * whose domain the last fixing reduced the most, relative to its size
+         * before, is fixed next, so that the variables left to search are
+         * those that are least bound up with the ones that were fixed. If the
+         * last fixing reduced no unassigned domain, the next variable is
+         * chosen at random.
+         *
+         * \ingroup SolveCallbacks
+         */
+        [[nodiscard]] auto propagation_guided() -> NeighbourhoodGenerator;
+
+        /**
+         * Propagation-guided neighbourhoods, with an explicit seed for
+         * reproducible debugging.
+         *
+         * \ingroup SolveCallbacks
+         * \sa propagation_guided()
+         */
+        [[nodiscard]] auto propagation_guided(std::uint_fast32_t seed) -> NeighbourhoodGenerator;
+
+        /**
+         * Neighbourhoods that follow the structure of the constraints, seeded
+         * non-deterministically.
+         *
+         * A variable is chosen at random, and the variables are ordered by a
+         * breadth first search out from it, going from a variable to the
+         * others that share a constraint with it. Those that cannot be
+         * reached at all, and then those furthest away, are fixed first, so
+         * the variables left to search are those that are close together in
+         * the constraint graph.
+         *
+         * \ingroup SolveCallbacks
+         */
+        [[nodiscard]] auto constraint_structured() -> NeighbourhoodGenerator;
+
+        /**
+         * Neighbourhoods that follow the structure of the constraints, with an
+         * explicit seed for reproducible debugging.
+         *
+         * \ingroup SolveCallbacks
+         * \sa constraint_structured()
+         */
+        [[nodiscard]] auto constraint_structured(std::uint_fast32_t seed) -> NeighbourhoodGenerator;
+    }
+}
+
+#endif
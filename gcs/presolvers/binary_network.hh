@@ -0,0 +1,6 @@
+#ifndef GLASGOW_CONSTRAINT_SOLVER_GUARD_GCS_PRESOLVERS_BINARY_NETWORK_HH
+#define GLASGOW_CONSTRAINT_SOLVER_GUARD_GCS_PRESOLVERS_BINARY_NETWORK_HH
+
+#include <gcs/presolvers/binary_network/binary_network.hh>
+
+#endif
@@ -0,0 +1,487 @@
+#include <gcs/constraints/comparison/comparison.hh>
+#include <gcs/constraints/equals/equals.hh>
+#include <gcs/constraints/table/table.hh>
+#include <gcs/innards/inference_tracker.hh>
+#include <gcs/innards/justification.hh>
+#include <gcs/innards/propagators.hh>
+#include <gcs/innards/reason.hh>
+#include <gcs/innards/reversible.hh>
+#include <gcs/innards/state.hh>
+#include <gcs/presolvers/binary_network/binary_network.hh>
+#include <gcs/problem.hh>
+#include <gcs/reification.hh>
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <variant>
+#include <vector>
+
+using namespace gcs;
+using namespace gcs::innards;
+
+using std::countr_zero;
+using std::function;
+using std::holds_alternative;
+using std::lower_bound;
+using std::make_shared;
+using std::make_unique;
+using std::map;
+using std::move;
+using std::nullopt;
+using std::optional;
+using std::shared_ptr;
+using std::size_t;
+using std::string;
+using std::to_string;
+using std::uint32_t;
+using std::uint64_t;
+using std::unique_ptr;
+using std::vector;
+using std::visit;
+using std::ranges::sort;
+
+namespace
+{
+    constexpr size_t bits_per_word = 64;
+
+    auto words_for(size_t bits) -> size_t
+    {
+        return (bits + bits_per_word - 1) / bits_per_word;
+    }
+
+    // One constraint seen from one of its variables: revising it removes each
+    // value of `var` that has no support left among the values of `support`.
+    // The support bitset for slot `s` of var is the n_words[support] words
+    // starting at `masks + s * n_words[support]`, and its residue is
+    // `residues + s`. Reversing an arc gives the same constraint seen from the
+    // other end.
+    struct NetworkArc
+    {
+        uint32_t var;
+        uint32_t support;
+        uint32_t reverse;
+        size_t masks;
+        size_t residues;
+        Reason reason;
+    };
+
+    // The fixed part of the network, shared by every call. The residues are
+    // not backtrackable: a stale one is simply re-sought, as for
+    // CompactTableSupports. The queue is scratch, reused by every call.
+    struct NetworkSupports
+    {
+        vector<IntegerVariableID> nodes;
+        vector<vector<Integer>> values;
+        vector<size_t> n_words;
+        vector<NetworkArc> arcs;
+        vector<vector<uint32_t>> arcs_supported_by;
+        vector<uint64_t> masks;
+        vector<uint32_t> residues;
+
+        vector<uint32_t> queue;
+        vector<char> queued;
+    };
+
+    // The backtrackable part, held in the ReversibleTrail: per node, the
+    // slots of the values that were in its domain at the end of the last
+    // call, and how many. A node the DomainDelta lists is compared against its
+    // current domain to find the values it lost since.
+    struct NetworkState
+    {
+        vector<ReversibleVector<uint64_t>> live;
+        ReversibleVector<size_t> live_count;
+    };
+
+    // The slots of the values a table entry matches: none, for a value not in
+    // the domain, or all of them, for a wildcard.
+    auto add_slots(vector<size_t> & slots, const vector<Integer> & values, const Integer & val) -> void
+    {
+        auto it = lower_bound(values.begin(), values.end(), val);
+        if (it != values.end() && *it == val)
+            slots.push_back(it - values.begin());
+    }
+
+    auto add_slots(vector<size_t> & slots, const vector<Integer> & values, const Wildcard &) -> void
+    {
+        for (size_t s = 0; s < values.size(); ++s)
+            slots.push_back(s);
+    }
+
+    auto add_slots(vector<size_t> & slots, const vector<Integer> & values, const IntegerOrWildcard & val) -> void
+    {
+        visit([&](const auto & val) { add_slots(slots, values, val); }, val);
+    }
+
+    auto revise(NetworkSupports & network, const NetworkState & ns, ReversibleTrail & trail, uint32_t arc_index, auto & inference,
+        ProofLogger * const logger) -> bool
+    {
+        const auto & arc = network.arcs[arc_index];
+        const auto & live = ns.live[arc.var];
+        const auto & support_live = ns.live[arc.support];
+        auto support_words = network.n_words[arc.support];
+        bool changed = false;
+
+        for (size_t w = 0; w < live.size(); ++w) {
+            auto old_word = live.get(trail, w), new_word = old_word;
+            for (auto word = old_word; word != 0; word &= word - 1) {
+                auto slot = w * bits_per_word + static_cast<size_t>(countr_zero(word));
+                const auto * mask = network.masks.data() + arc.masks + slot * support_words;
+                auto & residue = network.residues[arc.residues + slot];
+                if (0 != (support_live.get(trail, residue) & mask[residue]))
+                    continue;
+
+                bool supported = false;
+                for (size_t s = 0; s < support_words; ++s)
+                    if (0 != (support_live.get(trail, s) & mask[s])) {
+                        residue = static_cast<uint32_t>(s);
+                        supported = true;
+                        break;
+                    }
+                if (supported)
+                    continue;
+
+                inference.infer(logger, network.nodes[arc.var] != network.values[arc.var][slot], JustifyUsingRUP{}, arc.reason);
+                new_word &= ~(uint64_t{1} << (slot % bits_per_word));
+                ns.live_count.set(trail, arc.var, ns.live_count.get(trail, arc.var) - 1);
+                changed = true;
+            }
+            if (new_word != old_word)
+                live.set(trail, w, new_word);
+        }
+
+        return changed;
+    }
+
+    auto enqueue(NetworkSupports & network, uint32_t arc_index) -> void
+    {
+        if (! network.queued[arc_index]) {
+            network.queued[arc_index] = true;
+            network.queue.push_back(arc_index);
+        }
+    }
+
+    // Bring a node's live bits up to date, and revise every arc it supports,
+    // if it has lost values since the last call. A domain only shrinks, so an
+    // unchanged size means an unchanged domain.
+    auto refresh_node(NetworkSupports & network, const NetworkState & ns, ReversibleTrail & trail, const State & state, uint32_t n) -> void
+    {
+        auto live_count = ns.live_count.get(trail, n);
+        if (static_cast<size_t>(state.domain_size(network.nodes[n]).raw_value) == live_count)
+            return;
+        const auto & live = ns.live[n];
+        for (size_t w = 0; w < live.size(); ++w) {
+            auto old_word = live.get(trail, w), new_word = old_word;
+            for (auto word = old_word; word != 0; word &= word - 1) {
+                auto slot = w * bits_per_word + static_cast<size_t>(countr_zero(word));
+                if (! state.in_domain(network.nodes[n], network.values[n][slot])) {
+                    new_word &= ~(uint64_t{1} << (slot % bits_per_word));
+                    --live_count;
+                }
+            }
+            if (new_word != old_word)
+                live.set(trail, w, new_word);
+        }
+        ns.live_count.set(trail, n, live_count);
+        for (auto a : network.arcs_supported_by[n])
+            enqueue(network, a);
+    }
+
+    auto propagate_network(NetworkSupports & network, const NetworkState & ns, const State & state, auto & inference, ProofLogger * const logger,
+        const DomainDelta & delta) -> PropagatorState
+    {
+        auto & trail = state.reversible_trail();
+
+        // A contradiction unwinds out of the middle of the loop below, so the
+        // queue may be left holding arcs from the previous call.
+        for (auto a : network.queue)
+            network.queued[a] = false;
+        network.queue.clear();
+
+        // Only the nodes the delta lists can have lost values since the last
+        // call. Each trigger position is its node's index. When the engine
+        // cannot say what changed, which includes the first call, when
+        // nothing has been revised yet, look at everything.
+        if (delta.everything_changed()) {
+            for (uint32_t n = 0; n < network.nodes.size(); ++n)
+                refresh_node(network, ns, trail, state, n);
+            for (uint32_t a = 0; a < network.arcs.size(); ++a)
+                enqueue(network, a);
+        }
+        else
+            for (const auto & entry : delta.changed())
+                refresh_node(network, ns, trail, state, entry.position);
+
+        // Values lost by revising an arc cannot leave any value of the other
+        // end unsupported through that same constraint, since they had no
+        // support there, so its reverse need not be queued again.
+        while (! network.queue.empty()) {
+            auto a = network.queue.back();
+            network.queue.pop_back();
+            network.queued[a] = false;
+            if (revise(network, ns, trail, a, inference, logger))
+                for (auto b : network.arcs_supported_by[network.arcs[a].var])
+                    if (b != network.arcs[a].reverse)
+                        enqueue(network, b);
+        }
+
+        // Every remaining value is supported on every arc, and this call made
+        // every change itself, so a further call would find nothing to do.
+        return PropagatorState::EnableButIdempotent;
+    }
+}
+
+BinaryNetwork::BinaryNetwork(shared_ptr<BinaryNetworkStats> stats) :
+    _stats(stats ? move(stats) : make_shared<BinaryNetworkStats>()), _disable_lifted_donors(false), _max_domain_size(64)
+{
+}
+
+auto BinaryNetwork::disabling_lifted_donors(bool disable) -> BinaryNetwork &
+{
+    _disable_lifted_donors = disable;
+    return *this;
+}
+
+auto BinaryNetwork::with_max_domain_size(size_t max_domain_size) -> BinaryNetwork &
+{
+    _max_domain_size = max_domain_size;
+    return *this;
+}
+
+auto BinaryNetwork::clone() const -> unique_ptr<Presolver>
+{
+    auto result = make_unique<BinaryNetwork>(_stats);
+    result->disabling_lifted_donors(_disable_lifted_donors);
+    result->with_max_domain_size(_max_domain_size);
+    return result;
+}
+
+auto BinaryNetwork::run(Problem & problem, Propagators & propagators, State & initial_state, ProofLogger * const) -> bool
+{
+    propagators.add_component_stats(_stats);
+
+    BinaryNetworkStats stats;
+    auto network = make_shared<NetworkSupports>();
+    map<SimpleIntegerVariableID, uint32_t> node_of;
+    vector<ConstraintID> retirable_donors;
+
+    // The node for an operand, if it can be one: a plain variable, with a
+    // small enough domain.
+    auto node_index = [&](const IntegerVariableID & var) -> optional<uint32_t> {
+        auto simple = std::get_if<SimpleIntegerVariableID>(&var);
+        if (! simple)
+            return nullopt;
+        if (auto it = node_of.find(*simple); it != node_of.end())
+            return it->second;
+
+        auto index = static_cast<uint32_t>(network->nodes.size());
+        node_of.emplace(*simple, index);
+        network->nodes.push_back(*simple);
+        auto & values = network->values.emplace_back();
+        initial_state.for_each_value_immutable(*simple, [&](Integer val) { values.push_back(val); });
+        sort(values);
+        network->n_words.push_back(words_for(values.size()));
+        network->arcs_supported_by.emplace_back();
+        return index;
+    };
+
+    auto small_enough = [&](const IntegerVariableID & var) -> bool {
+        return static_cast<size_t>(initial_state.domain_size(var).raw_value) <= _max_domain_size;
+    };
+
+    // Check an operand pair before node_index is called, so that a skipped
+    // donor never leaves an isolated node behind to be triggered on.
+    auto check_operands = [&](const IntegerVariableID & x, const IntegerVariableID & y) -> bool {
+        if (! holds_alternative<SimpleIntegerVariableID>(x) || ! holds_alternative<SimpleIntegerVariableID>(y) || x == y) {
+            ++stats.skipped_not_plain_variables;
+            return false;
+        }
+        if (! small_enough(x) || ! small_enough(y)) {
+            ++stats.skipped_large_domain;
+            return false;
+        }
+        return true;
+    };
+
+    // Add the pair of arcs for one donor, given which pairs of its operands'
+    // values, by slot, it allows.
+    auto add_arcs = [&](uint32_t x, uint32_t y, const ConstraintID & id, bool retirable, const function<auto(size_t, size_t)->bool> & allowed) {
+        auto add_arc = [&](uint32_t var, uint32_t support, bool forwards) {
+            NetworkArc arc{var, support, 0, network->masks.size(), network->residues.size(), generic_reason({network->nodes[support]})};
+            auto var_values = network->values[var].size(), support_values = network->values[support].size();
+            auto support_words = network->n_words[support];
+            network->masks.resize(network->masks.size() + var_values * support_words, 0);
+            network->residues.resize(network->residues.size() + var_values, 0);
+            for (size_t a = 0; a < var_values; ++a)
+                for (size_t b = 0; b < support_values; ++b)
+                    if (forwards ? allowed(a, b) : allowed(b, a))
+                        network->masks[arc.masks + a * support_words + b / bits_per_word] |= uint64_t{1} << (b % bits_per_word);
+            network->arcs_supported_by[support].push_back(static_cast<uint32_t>(network->arcs.size()));
+            network->arcs.push_back(move(arc));
+        };
+
+        auto first = static_cast<uint32_t>(network->arcs.size());
+        add_arc(x, y, true);
+        add_arc(y, x, false);
+        network->arcs[first].reverse = first + 1;
+        network->arcs[first + 1].reverse = first;
+        if (retirable)
+            retirable_donors.push_back(id);
+        ++stats.constraints_lifted;
+    };
+
+    // A plain NotEquals is stored as a ReifiedEquals under reif::MustNotHold.
+    for (const auto & c : problem.each_constraint_of_type<ReifiedEquals>()) {
+        if (holds_alternative<reif::MustHold>(c.reification_condition())) {
+            ++stats.skipped_equals;
+            continue;
+        }
+        if (! holds_alternative<reif::MustNotHold>(c.reification_condition())) {
+            ++stats.skipped_reified;
+            continue;
+        }
+        if (! check_operands(c.first_variable(), c.second_variable()))
+            continue;
+        auto x = *node_index(c.first_variable()), y = *node_index(c.second_variable());
+        const auto & x_values = network->values[x];
+        const auto & y_values = network->values[y];
+        add_arcs(x, y, c.constraint_id(), true, [&](size_t a, size_t b) { return x_values[a] != y_values[b]; });
+        ++stats.not_equals_lifted;
+    }
+
+    // The whole comparison family is stored as `left <` or `left <=` `right`.
+    for (const auto & c : problem.each_constraint_of_type<ReifiedCompareLessThanOrMaybeEqual>()) {
+        if (! holds_alternative<reif::MustHold>(c.reification_condition())) {
+            ++stats.skipped_reified;
+            continue;
+        }
+        if (! check_operands(c.left_variable(), c.right_variable()))
+            continue;
+        auto x = *node_index(c.left_variable()), y = *node_index(c.right_variable());
+        const auto & x_values = network->values[x];
+        const auto & y_values = network->values[y];
+        auto or_equal = c.or_equal();
+        add_arcs(x, y, c.constraint_id(), true, [&](size_t a, size_t b) { return or_equal ? x_values[a] <= y_values[b] : x_values[a] < y_values[b]; });
+        ++stats.comparisons_lifted;
+    }
+
+    for (const auto & c : problem.each_constraint_of_type<Table>()) {
+        if (2 != c.variables().size()) {
+            ++stats.skipped_not_binary;
+            continue;
+        }
+        if (! check_operands(c.variables()[0], c.variables()[1]))
+            continue;
+
+        // Gather the allowed pairs of slots once, rather than asking of every
+        // tuple for every pair of values.
+        auto x = *node_index(c.variables()[0]), y = *node_index(c.variables()[1]);
+        auto y_words = network->n_words[y];
+        vector<uint64_t> pairs(network->values[x].size() * y_words, 0);
+        vector<size_t> x_slots, y_slots;
+        visit(
+            [&](const auto & tuples) {
+                for (const auto & tuple : *tuples) {
+                    x_slots.clear();
+                    y_slots.clear();
+                    add_slots(x_slots, network->values[x], tuple[0]);
+                    add_slots(y_slots, network->values[y], tuple[1]);
+                    for (auto a : x_slots)
+                        for (auto b : y_slots)
+                            pairs[a * y_words + b / bits_per_word] |= uint64_t{1} << (b % bits_per_word);
+                }
+            },
+            c.tuples());
+
+        // The fused propagator does everything a binary Table's propagator
+        // does to its two variables, but nothing to its selector.
+        add_arcs(x, y, c.constraint_id(), false,
+            [&](size_t a, size_t b) { return 0 != (pairs[a * y_words + b / bits_per_word] & (uint64_t{1} << (b % bits_per_word))); });
+        ++stats.tables_lifted;
+    }
+
+    stats.nodes = network->nodes.size();
+
+    // Over a single constraint the fused propagator does what that
+    // constraint's own propagator does, so it buys nothing.
+    if (stats.constraints_lifted >= 2) {
+        auto & trail = initial_state.reversible_trail();
+        NetworkState ns{{}, ReversibleVector<size_t>{trail, network->nodes.size(), 0}};
+        Triggers triggers;
+        for (uint32_t n = 0; n < network->nodes.size(); ++n) {
+            const auto & live = ns.live.emplace_back(trail, network->n_words[n], 0);
+            auto values = network->values[n].size();
+            for (size_t w = 0; w < live.size(); ++w)
+                live.set(trail, w, values - w * bits_per_word >= bits_per_word ? ~uint64_t{0} : (uint64_t{1} << (values - w * bits_per_word)) - 1);
+            ns.live_count.set(trail, n, values);
+            triggers.on_change.push_back(network->nodes[n]);
+        }
+        network->queued.assign(network->arcs.size(), false);
+
+        // A presolver-derived propagator has no posted-constraint identity of
+        // its own, exactly as for DifferenceLogic.
+        propagators.install(
+            CurrentlyUnnamedConstraint{},
+            [network = move(network), ns = move(ns)](
+                const State & state, auto & inference, ProofLogger * const logger, const DomainDelta & delta) -> PropagatorState {
+                return propagate_network(*network, ns, state, inference, logger, delta);
+            },
+            triggers);
+        stats.propagator_installed = true;
+
+        if (_disable_lifted_donors) {
+            stats.donor_propagators_disabled = propagators.disable_propagators_for_constraints(retirable_donors);
+            stats.tables_kept = stats.tables_lifted;
+        }
+    }
+
+    *_stats = stats;
+    return true;
+}
+
+auto BinaryNetworkStats::component_name() const -> string
+{
+    return "binary_network";
+}
+
+auto BinaryNetworkStats::summary() const -> string
+{
+    if (0 == constraints_lifted)
+        return "lifted nothing";
+
+    auto result = to_string(constraints_lifted) + " constraints lifted over " + to_string(nodes) + " nodes, " + to_string(not_equals_lifted) +
+        " not-equals, " + to_string(comparisons_lifted) + " comparisons and " + to_string(tables_lifted) + " tables";
+
+    if (! propagator_installed)
+        return result + ", but no propagator was installed";
+
+    if (0 != donor_propagators_disabled)
+        result += ", retiring " + to_string(donor_propagators_disabled) + " donor propagators";
+
+    if (0 != tables_kept)
+        result += ", keeping " + to_string(tables_kept) + " table propagators for their selectors";
+
+    return result;
+}
+
+auto BinaryNetworkStats::entries() const -> vector<StatsEntry>
+{
+    return {StatsEntry{"constraints_lifted", static_cast<long long>(constraints_lifted)},
+        StatsEntry{"not_equals_lifted", static_cast<long long>(not_equals_lifted)},
+        StatsEntry{"comparisons_lifted", static_cast<long long>(comparisons_lifted)},
+        StatsEntry{"tables_lifted", static_cast<long long>(tables_lifted)}, StatsEntry{"nodes", static_cast<long long>(nodes)},
+        StatsEntry{"propagator_installed", propagator_installed ? 1 : 0},
+        StatsEntry{"donor_propagators_disabled", static_cast<long long>(donor_propagators_disabled)},
+        StatsEntry{"tables_kept", static_cast<long long>(tables_kept)},
+        StatsEntry{"skipped_reified", static_cast<long long>(skipped_reified)},
+        StatsEntry{"skipped_not_plain_variables", static_cast<long long>(skipped_not_plain_variables)},
+        StatsEntry{"skipped_large_domain", static_cast<long long>(skipped_large_domain)},
+        StatsEntry{"skipped_not_binary", static_cast<long long>(skipped_not_binary)},
+        StatsEntry{"skipped_equals", static_cast<long long>(skipped_equals)}};
+}
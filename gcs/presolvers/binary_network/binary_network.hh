@@ -0,0 +1,168 @@
+#ifndef GLASGOW_CONSTRAINT_SOLVER_GUARD_GCS_PRESOLVERS_BINARY_NETWORK_BINARY_NETWORK_HH
+#define GLASGOW_CONSTRAINT_SOLVER_GUARD_GCS_PRESOLVERS_BINARY_NETWORK_BINARY_NETWORK_HH
+
+#include <gcs/presolver.hh>
+#include <gcs/stats.hh>
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace gcs
+{
+    /**
+     * \brief What the binary-network presolver did, filled in when it runs.
+     *
+     * As with DifferenceLogicStats, these counts are how a test tells a
+     * presolver that fused the network from one that silently fused nothing:
+     * either way every solution, and every proof, comes out the same.
+     *
+     * \ingroup Presolvers
+     */
+    struct BinaryNetworkStats final : ComponentStats
+    {
+        /// Donors turned into a pair of arcs: the number that matters.
+        std::size_t constraints_lifted = 0;
+
+        /// How many of constraints_lifted were a NotEquals.
+        std::size_t not_equals_lifted = 0;
+
+        /// How many of constraints_lifted were a comparison (`LessThan`,
+        /// `LessThanEqual`, `GreaterThan` or `GreaterThanEqual`).
+        std::size_t comparisons_lifted = 0;
+
+        /// How many of constraints_lifted were a two-variable Table.
+        std::size_t tables_lifted = 0;
+
+        /// Distinct variables those constraints span.
+        std::size_t nodes = 0;
+
+        /// True if the fused propagator was actually installed.
+        bool propagator_installed = false;
+
+        /// Propagators retired because the fused propagator subsumes them.
+        std::size_t donor_propagators_disabled = 0;
+
+        /// Table donors left running when the others were retired, because
+        /// only a Table's own propagator prunes its selector variable.
+        std::size_t tables_kept = 0;
+
+        /**
+         * \name Why a candidate was not lifted.
+         * @{
+         */
+
+        /// A donor that is reified, or half-reified: the network holds only
+        /// constraints that must hold.
+        std::size_t skipped_reified = 0;
+
+        /// An operand that is a constant or a view rather than a plain
+        /// variable, or both operands the same variable. The donor's own
+        /// propagator does everything there is to do with these.
+        std::size_t skipped_not_plain_variables = 0;
+
+        /// An operand whose domain has more values than the network's limit
+        /// (see BinaryNetwork::with_max_domain_size()).
+        std::size_t skipped_large_domain = 0;
+
+        /// A Table whose arity is not two.
+        std::size_t skipped_not_binary = 0;
+
+        /// An Equals, which is never lifted: see BinaryNetwork.
+        std::size_t skipped_equals = 0;
+
+        ///@}
+
+        [[nodiscard]] auto component_name() const -> std::string override;
+        [[nodiscard]] auto summary() const -> std::string override;
+        [[nodiscard]] auto entries() const -> std::vector<StatsEntry> override;
+    };
+
+    /**
+     * \brief Scan a posted Problem for binary constraints over small domains,
+     * and propagate all of them together with one fused arc-consistency
+     * propagator.
+     *
+     * A model with thousands of binary constraints, one NotEquals per pair for
+     * example, otherwise has thousands of propagators, each with its own trigger
+     * entries and queue slot, and on such a model the cost of waking and calling
+     * each of them can dominate the filtering itself. The fused propagator holds
+     * the whole network: for each arc (a constraint, seen from one of its two
+     * variables) and each value of that variable, a bitset over the other
+     * variable's values that support it. It wakes once for any change to any
+     * node, works out which nodes lost values since it last ran, and runs
+     * AC3-bit style revision from the arcs those nodes support, with a residue
+     * per (arc, value) so that a support that survives is found in one word
+     * operation. It is one queue entry however large the network is.
+     *
+     * Lifted donors' propagators keep running by default, as for
+     * DifferenceLogic, and can be retired with disabling_lifted_donors(), since
+     * the fused propagator enforces arc consistency on every lifted constraint.
+     * Every removal is justified by RUP from the donor's own OPB encoding and
+     * the supporting variable's domain, so, as for DifferenceLogic, nothing is
+     * added to the proof model.
+     *
+     * Off by default: opt in with Problem::add_presolver.
+     *
+     * \par What is lifted
+     *
+     *  - NotEquals;
+     *  - LessThan, LessThanEqual, GreaterThan and GreaterThanEqual;
+     *  - Table with exactly two variables, wildcards included;
+     *
+     * each unreified, over two distinct plain variables (not constants or
+     * views), with no more than the limit of values in either domain when the
+     * presolver runs. Equals is deliberately not lifted: its own propagator
+     * justifies some prunings with an explicit bridge rather than by RUP, and
+     * equality is better handled by merging the variables anyway. There is no
+     * intension constraint to lift: the XCSP front end decomposes an
+     * intension into the constraints above where it is a binary comparison,
+     * and otherwise into arithmetic over auxiliary variables, which is not
+     * binary. Everything else is skipped and counted --- see
+     * BinaryNetworkStats.
+     *
+     * \ingroup Presolvers
+     */
+    class BinaryNetwork : public Presolver
+    {
+    private:
+        std::shared_ptr<BinaryNetworkStats> _stats;
+        bool _disable_lifted_donors;
+        std::size_t _max_domain_size;
+
+    public:
+        /**
+         * \brief Construct the presolver, optionally sharing a stats block that
+         * will be filled in when it runs.
+         */
+        explicit BinaryNetwork(std::shared_ptr<BinaryNetworkStats> stats = nullptr);
+
+        /**
+         * \brief Also retire the propagators of lifted donors, so that the
+         * fused propagator is one queue entry in place of many, rather than
+         * leaving them running alongside it (the default).
+         *
+         * The search tree must be the same either way, which is what checks
+         * the subsumption claim. Table donors are never retired, because the
+         * fused propagator knows nothing of the selector variable that a
+         * Table's encoding is written over, and only the Table's own
+         * propagator keeps it in step.
+         */
+        auto disabling_lifted_donors(bool = true) -> BinaryNetwork &;
+
+        /**
+         * \brief Only lift constraints whose variables each have at most this
+         * many values, 64 by default.
+         *
+         * Each arc costs a bitset over the other variable's values for each of
+         * its own values, so memory grows with the product of the domain sizes.
+         */
+        auto with_max_domain_size(std::size_t) -> BinaryNetwork &;
+
+        [[nodiscard]] virtual auto run(Problem &, innards::Propagators &, innards::State &, innards::ProofLogger * const) -> bool override;
+        [[nodiscard]] virtual auto clone() const -> std::unique_ptr<Presolver> override;
+    };
+}
+
+#endif
@@ -0,0 +1,313 @@
+// Tests for the binary-network presolver.
+//
+// As with the difference-logic presolver, a presolver that silently fused
+// nothing would pass every solution-set check and every proof, so the counts
+// asserted on BinaryNetworkStats below are what tell "working" from "no-op".
+// If one of them fails, fix gcs/presolvers/binary_network/binary_network.cc
+// rather than the expected number.
+
+#include <gcs/constraints/comparison.hh>
+#include <gcs/constraints/equals.hh>
+#include <gcs/constraints/innards/constraints_test_utils.hh>
+#include <gcs/constraints/table.hh>
+#include <gcs/exception.hh>
+#include <gcs/presolvers/binary_network.hh>
+#include <gcs/problem.hh>
+#include <gcs/solve.hh>
+
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <random>
+#include <set>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+#include <version>
+
+#if defined(__cpp_lib_print) && defined(__cpp_lib_format)
+#include <print>
+#else
+#include <fmt/core.h>
+#include <fmt/ostream.h>
+#include <fmt/ranges.h>
+#endif
+
+using std::cerr;
+using std::flush;
+using std::make_optional;
+using std::make_shared;
+using std::mt19937;
+using std::nullopt;
+using std::optional;
+using std::pair;
+using std::set;
+using std::shared_ptr;
+using std::size_t;
+using std::string;
+using std::to_string;
+using std::tuple;
+using std::uniform_int_distribution;
+using std::vector;
+
+#if defined(__cpp_lib_print) && defined(__cpp_lib_format)
+using std::print;
+using std::println;
+#else
+using fmt::print;
+using fmt::println;
+#endif
+
+using namespace gcs;
+using namespace gcs::test_innards;
+
+namespace
+{
+    auto check_count(const string & what, size_t expected, size_t actual, const string & fixture) -> void
+    {
+        if (expected != actual)
+            throw UnexpectedException{"the binary-network presolver reported " + to_string(actual) + " for " + what + " on fixture '" + fixture +
+                "', expected " + to_string(expected) + ". This means detection is broken, not that the expectation is stale."};
+    }
+
+    enum class Kind
+    {
+        NotEqual,
+        Less,
+        LessEqual,
+        Table
+    };
+
+    // One binary constraint of a test network, by variable index, so that the
+    // same description drives both the posted constraint and the oracle.
+    struct Arc
+    {
+        Kind kind;
+        size_t x, y;
+        vector<pair<int, int>> tuples = {};
+    };
+
+    auto satisfied(const vector<int> & vals, const vector<Arc> & arcs) -> bool
+    {
+        for (const auto & arc : arcs) {
+            auto a = vals.at(arc.x), b = vals.at(arc.y);
+            switch (arc.kind) {
+            case Kind::NotEqual:
+                if (a == b)
+                    return false;
+                break;
+            case Kind::Less:
+                if (a >= b)
+                    return false;
+                break;
+            case Kind::LessEqual:
+                if (a > b)
+                    return false;
+                break;
+            case Kind::Table: {
+                bool found = false;
+                for (const auto & [ta, tb] : arc.tuples)
+                    if (ta == a && tb == b)
+                        found = true;
+                if (! found)
+                    return false;
+            } break;
+            }
+        }
+        return true;
+    }
+
+    enum class Config
+    {
+        NoPresolver,
+        Hybrid,
+        Fused
+    };
+
+    auto config_name(Config config) -> string
+    {
+        switch (config) {
+            using enum Config;
+        case NoPresolver: return "no-presolver";
+        case Hybrid: return "hybrid";
+        case Fused: return "fused";
+        }
+        throw UnimplementedException{};
+    }
+
+    auto build(Problem & p, const vector<pair<int, int>> & domains, const vector<Arc> & arcs, Config config,
+        const shared_ptr<BinaryNetworkStats> & stats) -> vector<IntegerVariableID>
+    {
+        vector<IntegerVariableID> vars;
+        for (const auto & [lo, hi] : domains)
+            vars.push_back(p.create_integer_variable(Integer(lo), Integer(hi)));
+
+        // Less is posted the other way round, as a GreaterThan, so that the
+        // normalised operand order is exercised too.
+        for (const auto & arc : arcs)
+            switch (arc.kind) {
+            case Kind::NotEqual: p.post(NotEquals{vars.at(arc.x), vars.at(arc.y)}); break;
+            case Kind::Less: p.post(GreaterThan{vars.at(arc.y), vars.at(arc.x)}); break;
+            case Kind::LessEqual: p.post(LessThanEqual{vars.at(arc.x), vars.at(arc.y)}); break;
+            case Kind::Table: {
+                SimpleTuples tuples;
+                for (const auto & [a, b] : arc.tuples)
+                    tuples.push_back(vector{Integer(a), Integer(b)});
+                p.post(Table{{vars.at(arc.x), vars.at(arc.y)}, std::move(tuples)});
+            } break;
+            }
+
+        switch (config) {
+            using enum Config;
+        case NoPresolver: break;
+        case Hybrid: p.add_presolver(BinaryNetwork{stats}); break;
+        case Fused: p.add_presolver(BinaryNetwork{stats}.disabling_lifted_donors()); break;
+        }
+
+        return vars;
+    }
+
+    // Solution-set equivalence across all three configurations, against an
+    // independent oracle, and, with the donors retired, the same search tree as
+    // with them running: the fused propagator enforces arc consistency on every
+    // lifted constraint, so it must subsume each donor's own propagation.
+    auto run_equivalence_test(bool proofs, const string & name, const vector<pair<int, int>> & domains, const vector<Arc> & arcs) -> void
+    {
+        print(cerr, "binary network equivalence {} domains={} constraints={}{}", name, domains, arcs.size(), proofs ? " with proofs:" : ":");
+        cerr << flush;
+
+        set<tuple<vector<int>>> expected;
+        build_expected(expected, [&](const vector<int> & vals) { return satisfied(vals, arcs); }, domains);
+        println(cerr, " expecting {} solutions", expected.size());
+
+        for (auto config : {Config::NoPresolver, Config::Hybrid, Config::Fused}) {
+            auto stats = make_shared<BinaryNetworkStats>();
+            Problem p;
+            auto vars = build(p, domains, arcs, config, stats);
+
+            set<tuple<vector<int>>> actual;
+            auto proof_name = proofs ? make_optional("binary_network_" + name + "_" + config_name(config)) : nullopt;
+            solve_for_tests(p, proof_name, actual, tuple{vars});
+            check_results(proof_name, expected, actual);
+
+            if (config != Config::NoPresolver) {
+                check_count("constraints lifted", arcs.size(), stats->constraints_lifted, name);
+                if (arcs.size() >= 2 && ! stats->propagator_installed)
+                    throw UnexpectedException{"the binary-network presolver installed no propagator on fixture '" + name + "'"};
+            }
+        }
+
+        if (! proofs) {
+            auto recursions = [&](Config config) {
+                Problem p;
+                build(p, domains, arcs, config, make_shared<BinaryNetworkStats>());
+                return solve(p, [](const CurrentState &) -> bool { return true; }).recursions;
+            };
+            if (recursions(Config::Hybrid) != recursions(Config::Fused))
+                throw UnexpectedException{"retiring the donors changed the search tree on fixture '" + name +
+                    "', so the fused propagator does not subsume them"};
+        }
+    }
+
+    auto random_instance(mt19937 & rng) -> pair<vector<pair<int, int>>, vector<Arc>>
+    {
+        int n_vars = uniform_int_distribution{3, 5}(rng);
+        vector<pair<int, int>> domains;
+        for (int v = 0; v < n_vars; ++v) {
+            int lo = uniform_int_distribution{-2, 2}(rng);
+            domains.emplace_back(lo, lo + uniform_int_distribution{1, 4}(rng));
+        }
+
+        vector<Arc> arcs;
+        int n_arcs = uniform_int_distribution{2, 7}(rng);
+        for (int a = 0; a < n_arcs; ++a) {
+            auto x = static_cast<size_t>(uniform_int_distribution{0, n_vars - 1}(rng));
+            auto y = static_cast<size_t>(uniform_int_distribution{0, n_vars - 2}(rng));
+            if (y >= x)
+                ++y;
+            Arc arc{static_cast<Kind>(uniform_int_distribution{0, 3}(rng)), x, y};
+            if (arc.kind == Kind::Table)
+                for (int a_val = domains[x].first - 1; a_val <= domains[x].second; ++a_val)
+                    for (int b_val = domains[y].first; b_val <= domains[y].second + 1; ++b_val)
+                        if (uniform_int_distribution{0, 2}(rng) == 0)
+                            arc.tuples.emplace_back(a_val, b_val);
+            arcs.push_back(std::move(arc));
+        }
+        return pair{domains, arcs};
+    }
+
+    auto run_equivalence_tests(bool proofs) -> void
+    {
+        run_equivalence_test(proofs, "triangle", {{1, 3}, {1, 3}, {1, 3}},
+            {Arc{Kind::NotEqual, 0, 1}, Arc{Kind::NotEqual, 1, 2}, Arc{Kind::NotEqual, 0, 2}});
+        run_equivalence_test(proofs, "pigeonhole", {{1, 3}, {1, 3}, {1, 3}, {1, 3}},
+            {Arc{Kind::NotEqual, 0, 1}, Arc{Kind::NotEqual, 0, 2}, Arc{Kind::NotEqual, 0, 3}, Arc{Kind::NotEqual, 1, 2},
+                Arc{Kind::NotEqual, 1, 3}, Arc{Kind::NotEqual, 2, 3}});
+        run_equivalence_test(proofs, "chain", {{0, 4}, {0, 4}, {0, 4}},
+            {Arc{Kind::Less, 0, 1}, Arc{Kind::LessEqual, 1, 2}, Arc{Kind::Table, 2, 0, {{0, 1}, {2, 0}, {3, 2}, {4, 4}}}});
+
+        mt19937 rng(*get_seed());
+        for (int i = 0; i < (proofs ? 10 : 40); ++i) {
+            auto [domains, arcs] = random_instance(rng);
+            run_equivalence_test(proofs, "random" + to_string(i), domains, arcs);
+        }
+    }
+
+    // Every donor shape, with the count it must land in.
+    auto run_detection_tests() -> void
+    {
+        auto stats = make_shared<BinaryNetworkStats>();
+        Problem p;
+        auto x = p.create_integer_variable_vector(4, 0_i, 5_i, "x");
+        auto big = p.create_integer_variable(0_i, 1000_i, "big");
+        auto flag = p.create_integer_variable(0_i, 1_i, "flag");
+
+        p.post(NotEquals{x[0], x[1]});
+        p.post(NotEquals{x[1], x[2]});
+        p.post(LessThan{x[0], x[2]});
+        p.post(GreaterThanEqual{x[3], x[2]});
+        p.post(Table{{x[0], x[3]}, SimpleTuples{{0_i, 1_i}, {2_i, 3_i}, {4_i, 5_i}}});
+        p.post(Table{{x[1], x[3]}, WildcardTuples{{1_i, Wildcard{}}, {Wildcard{}, 0_i}}});
+
+        p.post(NotEqualsIf{x[0], x[3], flag == 1_i});
+        p.post(LessThanIf{x[1], x[3], flag == 1_i});
+        p.post(NotEquals{x[0], 3_c});
+        p.post(LessThan{x[0] + 1_i, x[1]});
+        p.post(NotEquals{x[0], big});
+        p.post(Table{{x[0], x[1], x[2]}, SimpleTuples{{0_i, 1_i, 2_i}}});
+        p.post(Equals{x[2], flag});
+
+        p.add_presolver(BinaryNetwork{stats}.disabling_lifted_donors());
+        static_cast<void>(solve(p, [](const CurrentState &) -> bool { return false; }));
+
+        const string fixture = "every shape";
+        println(cerr, "binary network detection: {}", stats->summary());
+        check_count("constraints lifted", 6, stats->constraints_lifted, fixture);
+        check_count("not-equals lifted", 2, stats->not_equals_lifted, fixture);
+        check_count("comparisons lifted", 2, stats->comparisons_lifted, fixture);
+        check_count("tables lifted", 2, stats->tables_lifted, fixture);
+        check_count("nodes", 4, stats->nodes, fixture);
+        check_count("skipped: reified", 2, stats->skipped_reified, fixture);
+        check_count("skipped: not plain variables", 2, stats->skipped_not_plain_variables, fixture);
+        check_count("skipped: large domain", 1, stats->skipped_large_domain, fixture);
+        check_count("skipped: not binary", 1, stats->skipped_not_binary, fixture);
+        check_count("skipped: equals", 1, stats->skipped_equals, fixture);
+        check_count("tables kept", 2, stats->tables_kept, fixture);
+        if (! stats->propagator_installed || 0 == stats->donor_propagators_disabled)
+            throw UnexpectedException{"the binary-network presolver did not install its propagator and retire its donors"};
+    }
+}
+
+auto main(int argc, char * argv[]) -> int
+{
+    establish_and_announce_seed(argc, argv);
+
+    run_detection_tests();
+    run_equivalence_tests(false);
+    if (can_run_veripb())
+        run_equivalence_tests(true);
+
+    return EXIT_SUCCESS;
+}
@@ -213,6 +213,7 @@ auto Problem::create_propagators(State & state, Stats & stats, ProofModel * cons
         // constraint's OPB rows (near enough) contiguously after it.
         if (optional_proof_model)
             optional_proof_model->begin_constraint_block_comment(cc->constraint_type(), cc->constraint_id());
+        result.note_constraint_type(cc->constraint_id(), cc->constraint_type());
         move(*cc).install(result, state, optional_proof_model);
     }
 
@@ -53,6 +53,64 @@ namespace
         return nullopt;
     }
 
+    /**
+     * Read whether to write the proof from a background thread from the
+     * GCS_PROOF_WRITER environment variable, if set: "async" or "sync". An
+     * unrecognised value is ignored with a warning.
+     */
+    [[nodiscard]] auto asynchronous_writer_from_env() -> optional<bool>
+    {
+        const auto * const env = std::getenv("GCS_PROOF_WRITER");
+        if (! env || ! *env)
+            return nullopt;
+
+        string value{env};
+        if (value == "async")
+            return true;
+        else if (value == "sync")
+            return false;
+
+        print(stderr, "Ignoring unrecognised GCS_PROOF_WRITER value '{}'\n", value);
+        return nullopt;
+    }
+
+    /**
+     * Read a ProofCompression from the GCS_PROOF_COMPRESSION environment
+     * variable, if set: "none", "gzip" or "zstd". An unrecognised value is
+     * ignored with a warning.
+     */
+    [[nodiscard]] auto compression_from_env() -> optional<ProofCompression>
+    {
+        const auto * const env = std::getenv("GCS_PROOF_COMPRESSION");
+        if (! env || ! *env)
+            return nullopt;
+
+        string value{env};
+        if (value == "none")
+            return ProofCompression::None;
+        else if (value == "gzip" || value == "gz")
+            return ProofCompression::Gzip;
+        else if (value == "zstd" || value == "zst")
+            return ProofCompression::Zstd;
+
+        print(stderr, "Ignoring unrecognised GCS_PROOF_COMPRESSION value '{}'\n", value);
+        return nullopt;
+    }
+
+    auto with_compression_suffix(string file_name, ProofCompression compression) -> string
+    {
+        for (const string suffix : {".gz", ".zst"})
+            if (file_name.size() > suffix.size() && file_name.ends_with(suffix))
+                file_name.resize(file_name.size() - suffix.size());
+
+        switch (compression) {
+        case ProofCompression::None: break;
+        case ProofCompression::Gzip: file_name += ".gz"; break;
+        case ProofCompression::Zstd: file_name += ".zst"; break;
+        }
+        return file_name;
+    }
+
     /**
      * Apply any environment-variable overrides to a copy of the given ProofOptions.
      * Environment variables act as defaults only: an option set explicitly in code
@@ -63,6 +121,12 @@ namespace
         if (! options.assertion_level_set_explicitly)
             if (auto level = assertion_level_from_env())
                 options.assertion_level = *level;
+        if (! options.asynchronous_writer_set_explicitly)
+            if (auto asynchronous = asynchronous_writer_from_env())
+                options.asynchronous_writer = *asynchronous;
+        if (! options.compression_set_explicitly)
+            if (auto compression = compression_from_env())
+                options.set_compression(*compression);
         return options;
     }
 }
@@ -80,6 +144,15 @@ ProofOptions::ProofOptions(const ProofFileNames & f) : proof_file_names(f)
 {
 }
 
+auto ProofOptions::set_compression(ProofCompression c) -> ProofOptions &
+{
+    compression = c;
+    compression_set_explicitly = true;
+    proof_file_names.opb_file = with_compression_suffix(proof_file_names.opb_file, c);
+    proof_file_names.proof_file = with_compression_suffix(proof_file_names.proof_file, c);
+    return *this;
+}
+
 struct Proof::Imp
 {
     NamesAndIDsTracker tracker;
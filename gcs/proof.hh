@@ -30,6 +30,29 @@ namespace gcs
         std::optional<std::string> s_expr_file;        ///< Filename for the s-expression verified definition
     };
 
+    /**
+     * \brief How the OPB model and the proof are compressed, if at all.
+     *
+     * What is written is decided by the file name: a name ending in `.gz` is
+     * written through gzip, one ending in `.zst` through zstd, and anything else
+     * is plain text. ProofOptions::set_compression() picks the names to match.
+     * Compression needs zlib or libzstd at build time; without it, asking for a
+     * compressed file throws a ProofError when the file is opened.
+     *
+     * Compressed files are written as a sequence of gzip members or zstd
+     * frames, which the standard tools decompress as a whole. VeriPB is given
+     * them decompressed, for example through a named pipe.
+     *
+     * \sa ProofOptions
+     * \ingroup Core
+     */
+    enum class ProofCompression
+    {
+        None, ///< Plain text
+        Gzip, ///< gzip, written to a file ending in `.gz`
+        Zstd  ///< zstd, written to a file ending in `.zst`
+    };
+
     /**
      * \brief Mode setting for annotated assertions. Each option involves successively less
      * justification.
@@ -60,7 +83,11 @@ namespace gcs
         bool always_use_full_encoding = false;     ///< Always write the full variable encoding to the OPB file
         bool use_compact_boolean_encoding = false; ///< Drop the trivial constant boundary literals (ge_lower, ge_ub+1) from eq-atom definitions
         AssertionLevel assertion_level = AssertionLevel::Off;
-        bool assertion_level_set_explicitly = false; ///< Was assertion_level set in code (so it overrides the env var)?
+        bool assertion_level_set_explicitly = false;           ///< Was assertion_level set in code (so it overrides the env var)?
+        bool asynchronous_writer = true;                       ///< Write the proof file from a background thread?
+        bool asynchronous_writer_set_explicitly = false;       ///< Was asynchronous_writer set in code (so it overrides the env var)?
+        ProofCompression compression = ProofCompression::None; ///< How the OPB and proof files are compressed
+        bool compression_set_explicitly = false;               ///< Was compression set in code (so it overrides the env var)?
 
         /// Write annotated assertions instead of full justifications.
         ProofOptions & set_assertion_level(AssertionLevel a = AssertionLevel::Inferences)
@@ -87,6 +114,19 @@ namespace gcs
             use_compact_boolean_encoding = c;
             return *this;
         }
+        /// Write the proof file from a background thread, so that search does
+        /// not wait on disk writes (the default), or from the search thread.
+        /// The file is the same either way.
+        ProofOptions & set_asynchronous_writer(bool a = true)
+        {
+            asynchronous_writer = a;
+            asynchronous_writer_set_explicitly = true;
+            return *this;
+        }
+        /// Compress the OPB and proof files, by adding `.gz` or `.zst` to the end
+        /// of their names (or, for ProofCompression::None, removing it). The
+        /// variables map and s-expression files are small, and are left alone.
+        ProofOptions & set_compression(ProofCompression c);
         /// Set whether to use verbose names in proofs.
         ProofOptions & set_verbose_names(bool v)
         {
@@ -0,0 +1,157 @@
+#include <gcs/propagation_profile.hh>
+
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+using namespace gcs;
+
+using std::map;
+using std::ostream;
+using std::pair;
+using std::string;
+using std::to_string;
+using std::vector;
+using std::chrono::duration_cast;
+using std::chrono::microseconds;
+using std::ranges::stable_sort;
+
+namespace
+{
+    auto add_counts(PropagationProfileEntry & to, const PropagationProfileEntry & from) -> void
+    {
+        to.calls += from.calls;
+        to.effectful_calls += from.effectful_calls;
+        to.inferences += from.inferences;
+        to.contradictions += from.contradictions;
+        to.idempotence_claims += from.idempotence_claims;
+        to.time += from.time;
+    }
+
+    auto as_json(const PropagationProfileEntry & entry) -> nlohmann::json
+    {
+        nlohmann::json result{{"constraint_type", entry.constraint_type}};
+        if (! entry.constraint.empty())
+            result["constraint"] = entry.constraint;
+        result["calls"] = entry.calls;
+        result["effectful_calls"] = entry.effectful_calls;
+        result["inferences"] = entry.inferences;
+        result["contradictions"] = entry.contradictions;
+        result["idempotence_claims"] = entry.idempotence_claims;
+        result["time_ns"] = entry.time.count();
+        return result;
+    }
+
+    // Quote a CSV field if it needs it. A constraint's name is whatever the
+    // caller gave it, so it might.
+    auto csv_field(const string & s) -> string
+    {
+        if (s.find_first_of(",\"\n") == string::npos)
+            return s;
+        string result = "\"";
+        for (auto c : s) {
+            if (c == '"')
+                result += '"';
+            result += c;
+        }
+        return result + "\"";
+    }
+}
+
+auto PropagationProfile::by_constraint_type() const -> vector<PropagationProfileEntry>
+{
+    map<string, PropagationProfileEntry> by_type;
+    for (const auto & entry : by_constraint) {
+        auto & total = by_type[entry.constraint_type];
+        total.constraint_type = entry.constraint_type;
+        add_counts(total, entry);
+    }
+
+    vector<PropagationProfileEntry> result;
+    for (auto & [_, entry] : by_type)
+        result.push_back(std::move(entry));
+    stable_sort(result, [](const auto & a, const auto & b) { return a.time > b.time; });
+    return result;
+}
+
+auto PropagationProfile::add(const PropagationProfile & other) -> void
+{
+    map<pair<string, string>, std::size_t> index;
+    for (std::size_t i = 0; i < by_constraint.size(); ++i)
+        index.emplace(pair{by_constraint[i].constraint_type, by_constraint[i].constraint}, i);
+
+    for (const auto & entry : other.by_constraint) {
+        auto [it, inserted] = index.emplace(pair{entry.constraint_type, entry.constraint}, by_constraint.size());
+        if (inserted)
+            by_constraint.push_back(entry);
+        else
+            add_counts(by_constraint[it->second], entry);
+    }
+}
+
+auto PropagationProfile::write_json(ostream & s) const -> void
+{
+    nlohmann::json result;
+    result["by_constraint_type"] = nlohmann::json::array();
+    for (const auto & entry : by_constraint_type())
+        result["by_constraint_type"].push_back(as_json(entry));
+    result["by_constraint"] = nlohmann::json::array();
+    for (const auto & entry : by_constraint)
+        result["by_constraint"].push_back(as_json(entry));
+    s << result.dump(2) << '\n';
+}
+
+auto PropagationProfile::write_csv(ostream & s) const -> void
+{
+    s << "constraint_type,constraint,calls,effectful_calls,inferences,contradictions,idempotence_claims,time_ns\n";
+    for (const auto & e : by_constraint)
+        s << csv_field(e.constraint_type) << ',' << csv_field(e.constraint) << ',' << e.calls << ',' << e.effectful_calls << ',' << e.inferences
+          << ',' << e.contradictions << ',' << e.idempotence_claims << ',' << e.time.count() << '\n';
+}
+
+auto PropagationProfile::component_name() const -> string
+{
+    return "propagation_profile";
+}
+
+auto PropagationProfile::summary() const -> string
+{
+    auto types = by_constraint_type();
+    PropagationProfileEntry total;
+    for (const auto & entry : types)
+        add_counts(total, entry);
+    if (0 == total.calls)
+        return "no propagator calls";
+
+    auto result = to_string(total.calls) + " propagator calls over " + to_string(types.size()) + " constraint types, taking " +
+        to_string(duration_cast<microseconds>(total.time).count()) + "us";
+
+    // The few types that took the most time are what anyone reading this is
+    // looking for; the rest are in entries() and the dumps.
+    for (std::size_t i = 0; i < types.size() && i < 3; ++i) {
+        auto percent = 0 == total.time.count() ? 0 : (100 * types[i].time.count()) / total.time.count();
+        result += (0 == i ? "; most in " : ", ") + types[i].constraint_type + " (" + to_string(percent) + "%)";
+    }
+    return result;
+}
+
+auto PropagationProfile::entries() const -> vector<StatsEntry>
+{
+    vector<StatsEntry> result;
+    for (const auto & entry : by_constraint_type()) {
+        const auto & t = entry.constraint_type;
+        result.push_back(StatsEntry{t + ".calls", static_cast<long long>(entry.calls)});
+        result.push_back(StatsEntry{t + ".effectful_calls", static_cast<long long>(entry.effectful_calls)});
+        result.push_back(StatsEntry{t + ".inferences", static_cast<long long>(entry.inferences)});
+        result.push_back(StatsEntry{t + ".contradictions", static_cast<long long>(entry.contradictions)});
+        result.push_back(StatsEntry{t + ".idempotence_claims", static_cast<long long>(entry.idempotence_claims)});
+        result.push_back(StatsEntry{t + ".time_ns", static_cast<long long>(entry.time.count())});
+    }
+    return result;
+}
@@ -1,6 +1,8 @@
 #ifndef GLASGOW_CONSTRAINT_SOLVER_GUARD_GCS_RESTARTS_HH
 #define GLASGOW_CONSTRAINT_SOLVER_GUARD_GCS_RESTARTS_HH
 
+#include <cstddef>
+
 namespace gcs
 {
     /**
@@ -53,6 +55,58 @@ namespace gcs
          */
         auto advance() -> void;
     };
+
+    /**
+     * \brief How gcs::solve_with() keeps the nogoods learned at restarts in
+     * check, on a long run with many restarts.
+     *
+     * Every restart adds the reduced nld-nogoods of the pass just ended, and
+     * without reduction they are never forgotten, so memory and the cost of
+     * propagating them grow without bound. Instead, at a restart boundary once
+     * more than \ref limit nogoods are held, the database is reduced:
+     *
+     *  - if \ref minimise is set, a nogood that includes another is deleted
+     *    (subsumption), and a nogood that differs from another only in holding
+     *    the negation of one of its literals loses that literal (self-subsuming
+     *    resolution);
+     *  - then the least active of what remains, those that have propagated or
+     *    failed least often, with ties broken against the longest, are deleted
+     *    until only a \ref keep_fraction of them are left.
+     *
+     * Nogoods of no more than \ref keep_length literals are never deleted for
+     * inactivity, and neither are those learned in the pass just ended, which
+     * have not yet had a chance to be used. Each nogood's activity is halved at
+     * every reduction, so that recent use counts for more. The limit then grows
+     * by \ref limit_growth, so reductions become rarer as the run goes on.
+     *
+     * Deleting for inactivity happens only when optimising. Without an
+     * objective, search may be enumerating, and then a nogood is what stops a
+     * later pass from finding the same solutions again, so only minimisation
+     * is done.
+     *
+     * With proof logging, a deleted nogood's line is deleted from the proof,
+     * and a strengthened one is derived by RUP before its old line is deleted.
+     *
+     * \ingroup Core
+     * \sa gcs::SolveCallbacks, gcs::NogoodStore::reduce
+     */
+    struct NogoodReduction final
+    {
+        /// Reduce once more than this many nogoods are held.
+        std::size_t limit = 2000;
+
+        /// After each reduction, multiply the limit by this.
+        double limit_growth = 1.1;
+
+        /// The fraction of the deletion candidates that survive inactivity.
+        double keep_fraction = 0.5;
+
+        /// Nogoods no longer than this are never deleted for inactivity.
+        std::size_t keep_length = 2;
+
+        /// Whether to use subsumption and self-subsuming resolution.
+        bool minimise = true;
+    };
 }
 
 #endif
@@ -1,11 +1,18 @@
 #include <gcs/innards/propagators.hh>
+#include <gcs/innards/search_arena.hh>
+#include <gcs/innards/variable_activity.hh>
+#include <gcs/innards/variable_impact.hh>
+#include <gcs/innards/variable_selection_index.hh>
 #include <gcs/search_heuristics.hh>
 
 #include <algorithm>
+#include <cstddef>
 #include <memory>
 #include <random>
 #include <ranges>
 
+using std::allocator_arg;
+using std::allocator_arg_t;
 using std::generator;
 using std::make_shared;
 using std::mt19937;
@@ -13,7 +20,6 @@ using std::nullopt;
 using std::optional;
 using std::random_device;
 using std::shared_ptr;
-using std::tuple;
 using std::uint_fast32_t;
 using std::uniform_int_distribution;
 using std::vector;
@@ -41,6 +47,20 @@ namespace
 
 using namespace gcs;
 
+namespace
+{
+    // Every coroutine here takes these as its leading parameters, so that
+    // std::generator allocates its frame from the search arena rather than
+    // from the heap. The frame is dead before search backtracks past the node
+    // that made it, which is all the arena asks.
+    using FrameAllocator = innards::SearchArenaAllocator<std::byte>;
+
+    auto frame_allocator(const CurrentState & s) -> FrameAllocator
+    {
+        return FrameAllocator{s.search_arena()};
+    }
+}
+
 auto gcs::branch_with(BranchVariableHeuristic var, BranchValueGenerator val) -> BranchHeuristic
 {
     return [var = move(var), val = move(val)](const Problem & problem, innards::State & state, innards::Propagators & propagators) -> BranchCallback {
@@ -49,14 +69,12 @@ auto gcs::branch_with(BranchVariableHeuristic var, BranchValueGenerator val) ->
         auto select_var = var(problem, state, propagators);
         return [select_var = move(select_var), val = val](
                    const CurrentState & s, const innards::Propagators & p) -> generator<IntegerVariableCondition> {
-            return [](const CurrentState & s, const innards::Propagators & p, BranchVariableSelector select_var,
-                       BranchValueGenerator make_val_gen) -> generator<IntegerVariableCondition> {
-                auto branch_var = select_var(s, p);
-                if (branch_var)
-                    return make_val_gen(s, p, *branch_var);
-                else
-                    return []() -> generator<IntegerVariableCondition> { co_return; }();
-            }(s, p, select_var, val);
+            // Not itself a coroutine, so select_var and val need not be copied.
+            auto branch_var = select_var(s, p);
+            if (branch_var)
+                return val(s, p, *branch_var);
+            else
+                return [](allocator_arg_t, FrameAllocator) -> generator<IntegerVariableCondition> { co_return; }(allocator_arg, frame_allocator(s));
         };
     };
 }
@@ -68,8 +86,11 @@ auto gcs::branch_sequence(BranchHeuristic a, BranchHeuristic b) -> BranchHeurist
         auto callback_b = b(problem, state, propagators);
         return [callback_a = move(callback_a), callback_b = move(callback_b)](
                    const CurrentState & s, const innards::Propagators & p) -> generator<IntegerVariableCondition> {
-            return [](const CurrentState & s, const innards::Propagators & p, BranchCallback a,
-                       BranchCallback b) -> generator<IntegerVariableCondition> {
+            // The callbacks are taken by reference, rather than copied for every
+            // node, because the search holds on to this closure for as long as
+            // any generator it returns.
+            return [](allocator_arg_t, FrameAllocator, const CurrentState & s, const innards::Propagators & p, const BranchCallback & a,
+                       const BranchCallback & b) -> generator<IntegerVariableCondition> {
                 auto gen_a = a(s, p);
                 auto iter_a = gen_a.begin();
                 if (iter_a != gen_a.end()) {
@@ -82,7 +103,7 @@ auto gcs::branch_sequence(BranchHeuristic a, BranchHeuristic b) -> BranchHeurist
                     for (; iter_b != gen_b.end(); ++iter_b)
                         co_yield *iter_b;
                 }
-            }(s, p, callback_a, callback_b);
+            }(allocator_arg, frame_allocator(s), s, p, callback_a, callback_b);
         };
     };
 }
@@ -121,6 +142,17 @@ namespace
         };
     }
 
+    // A heuristic whose selector is a VariableSelectionIndex, which is set up
+    // afresh for each search and told about what changes by propagation.
+    auto indexed_heuristic(vector<IntegerVariableID> vars, innards::VariableSelectionIndex::Order order) -> BranchVariableHeuristic
+    {
+        return [vars = move(vars), order](const Problem &, innards::State & state, innards::Propagators & propagators) -> BranchVariableSelector {
+            auto index = make_shared<innards::VariableSelectionIndex>(vars, order, state, propagators);
+            propagators.add_domain_change_observer(index.get());
+            return [index](const CurrentState & s, const innards::Propagators &) -> optional<IntegerVariableID> { return index->select(s); };
+        };
+    }
+
     // Wrap a stateless selector (one needing no per-search setup) as a
     // BranchVariableHeuristic: the setup ignores its arguments and just returns
     // the selector.
@@ -180,10 +212,7 @@ auto gcs::variable_order::dom(const Problem & problem) -> BranchVariableHeuristi
 
 auto gcs::variable_order::dom(vector<IntegerVariableID> vars) -> BranchVariableHeuristic
 {
-    return variable_order::in_order_of(
-        vars, [](const CurrentState & state, const innards::Propagators &, const IntegerVariableID & a, const IntegerVariableID & b) {
-            return state.domain_size(a) < state.domain_size(b);
-        });
+    return indexed_heuristic(move(vars), innards::VariableSelectionIndex::Order::Dom);
 }
 
 auto gcs::variable_order::dom_then_deg(const Problem & problem) -> BranchVariableHeuristic
@@ -193,10 +222,7 @@ auto gcs::variable_order::dom_then_deg(const Problem & problem) -> BranchVariabl
 
 auto gcs::variable_order::dom_then_deg(vector<IntegerVariableID> vars) -> BranchVariableHeuristic
 {
-    return variable_order::in_order_of(
-        vars, [](const CurrentState & state, const innards::Propagators & p, const IntegerVariableID & a, const IntegerVariableID & b) {
-            return tuple{state.domain_size(a), -p.degree_of(a)} < tuple{state.domain_size(b), -p.degree_of(b)};
-        });
+    return indexed_heuristic(move(vars), innards::VariableSelectionIndex::Order::DomThenDeg);
 }
 
 auto gcs::variable_order::dom_wdeg(const Problem & problem, WeightingScheme scheme, optional<WeightingState> initial) -> BranchVariableHeuristic
@@ -230,44 +256,47 @@ auto gcs::variable_order::dom_wdeg(vector<IntegerVariableID> vars, WeightingSche
             weighting->load(*initial, propagators);
         propagators.add_conflict_observer(weighting.get());
 
-        // Select the argmin of dom(x)/W(x). This is the same selection an
-        // in_order_of_selector min-scan would make, but we compute each
-        // candidate's weighted degree exactly once per node and carry the
-        // incumbent's cached score, rather than recomputing weighted_degree_of
-        // for *both* arguments of every comparison. weighted_degree_of walks
-        // every constraint in a variable's scope, so on wide constraints (e.g.
-        // count / cardinality) the redundant per-comparison recompute of the
-        // incumbent's score dominates the entire solve.
-        return [vars, weighting](const CurrentState & state, const innards::Propagators & p) -> optional<IntegerVariableID> {
-            optional<IntegerVariableID> result;
-            double dom_result = 0.0, w_result = 0.0;
-            for (const auto & v : vars) {
-                auto size = state.domain_size(v);
-                if (size < 2_i)
-                    continue;
-                auto dom_v = static_cast<double>(size.raw_value);
-                auto w_v = weighting->weighted_degree_of(state, p, v);
-                if (! result) {
-                    result = v;
-                    dom_result = dom_v;
-                    w_result = w_v;
-                    continue;
-                }
-                // Cross-multiplied dom(x)/W(x) to avoid division: a variable
-                // with W(x)=0 (in no constraint with two or more unassigned
-                // variables) sorts last for free. Tie-break on highest degree,
-                // matching dom_then_deg.
-                auto lhs = dom_v * w_result;
-                auto rhs = dom_result * w_v;
-                bool v_better = (lhs != rhs) ? (lhs < rhs) : (p.degree_of(v) > p.degree_of(*result));
-                if (v_better) {
-                    result = v;
-                    dom_result = dom_v;
-                    w_result = w_v;
-                }
-            }
-            return result;
-        };
+        // Select the argmin of dom(x)/W(x), breaking ties on highest degree
+        // as dom_then_deg does. Rather than summing the weighted degree of
+        // every variable at every node, the index only recomputes it for the
+        // variables whose domains, constraints or weights have changed. It is
+        // attached as a conflict observer after the weighting, so it hears
+        // about a conflict once the weights have moved.
+        auto index =
+            make_shared<innards::VariableSelectionIndex>(vars, innards::VariableSelectionIndex::Order::DomWDeg, state, propagators, weighting);
+        propagators.add_domain_change_observer(index.get());
+        propagators.add_conflict_observer(index.get());
+        return [index](const CurrentState & s, const innards::Propagators &) -> optional<IntegerVariableID> { return index->select(s); };
+    };
+}
+
+auto gcs::variable_order::activity(const Problem & problem, double decay) -> BranchVariableHeuristic
+{
+    return activity(problem.all_normal_variables(), decay);
+}
+
+auto gcs::variable_order::activity(vector<IntegerVariableID> vars, double decay) -> BranchVariableHeuristic
+{
+    return [vars = move(vars), decay](const Problem &, innards::State &, innards::Propagators & propagators) -> BranchVariableSelector {
+        auto activity = make_shared<innards::VariableActivity>(vars, decay);
+        propagators.add_domain_change_observer(activity.get());
+        return [activity](const CurrentState & s, const innards::Propagators &) -> optional<IntegerVariableID> { return activity->select(s); };
+    };
+}
+
+auto gcs::variable_order::impact(const Problem & problem) -> BranchVariableHeuristic
+{
+    return impact(problem.all_normal_variables());
+}
+
+auto gcs::variable_order::impact(vector<IntegerVariableID> vars) -> BranchVariableHeuristic
+{
+    return [vars = move(vars)](const Problem &, innards::State & state, innards::Propagators & propagators) -> BranchVariableSelector {
+        // Unlike the other heuristics, this keeps hold of the live state and
+        // propagators, because its first selection probes the root.
+        auto impact = make_shared<innards::VariableImpact>(vars, state, propagators);
+        propagators.add_domain_change_observer(impact.get());
+        return [impact](const CurrentState & s, const innards::Propagators &) -> optional<IntegerVariableID> { return impact->select(s); };
     };
 }
 
@@ -286,18 +315,27 @@ auto gcs::variable_order::with_smallest_value(vector<IntegerVariableID> vars) ->
 
 namespace
 {
+    // The value that each_value() would give at position idx, counting from
+    // zero. Picking a value by position like this, rather than by collecting
+    // every value into a vector first, allocates nothing.
+    auto value_at(const CurrentState & s, const IntegerVariableID & var, std::size_t idx) -> Integer
+    {
+        return *(s.each_value(var) | std::views::drop(idx)).begin();
+    }
+
     auto random_value_generator(shared_ptr<mt19937> rand) -> BranchValueGenerator
     {
         return [rand = move(rand)](
                    const CurrentState & s, const innards::Propagators &, const IntegerVariableID & var) -> generator<IntegerVariableCondition> {
-            return [](shared_ptr<mt19937> rand, const CurrentState & s, IntegerVariableID var) -> generator<IntegerVariableCondition> {
+            return [](allocator_arg_t, FrameAllocator, shared_ptr<mt19937> rand, const CurrentState & s, IntegerVariableID var)
+                       -> generator<IntegerVariableCondition> {
                 vector<Integer> values;
                 for (auto v : s.each_value(var))
                     values.push_back(v);
                 shuffle(values, *rand);
                 for (auto v : values)
                     co_yield var == v;
-            }(rand, s, var);
+            }(allocator_arg, frame_allocator(s), rand, s, var);
         };
     }
 
@@ -305,15 +343,13 @@ namespace
     {
         return [rand = move(rand)](
                    const CurrentState & s, const innards::Propagators &, const IntegerVariableID & var) -> generator<IntegerVariableCondition> {
-            return [](shared_ptr<mt19937> rand, const CurrentState & s, IntegerVariableID var) -> generator<IntegerVariableCondition> {
-                vector<Integer> values;
-                for (auto v : s.each_value(var))
-                    values.push_back(v);
-                uniform_int_distribution<size_t> dist(0, values.size() - 1);
-                auto val = values.at(dist(*rand));
+            return [](allocator_arg_t, FrameAllocator, shared_ptr<mt19937> rand, const CurrentState & s, IntegerVariableID var)
+                       -> generator<IntegerVariableCondition> {
+                uniform_int_distribution<size_t> dist(0, s.domain_size(var).as_index() - 1);
+                auto val = value_at(s, var, dist(*rand));
                 co_yield var != val;
                 co_yield var == val;
-            }(rand, s, var);
+            }(allocator_arg, frame_allocator(s), rand, s, var);
         };
     }
 
@@ -321,32 +357,31 @@ namespace
     {
         return [rand = move(rand)](
                    const CurrentState & s, const innards::Propagators &, const IntegerVariableID & var) -> generator<IntegerVariableCondition> {
-            return [](shared_ptr<mt19937> rand, const CurrentState & s, IntegerVariableID var) -> generator<IntegerVariableCondition> {
-                vector<Integer> values;
-                for (auto v : s.each_value(var))
-                    values.push_back(v);
+            return [](allocator_arg_t, FrameAllocator, shared_ptr<mt19937> rand, const CurrentState & s, IntegerVariableID var)
+                       -> generator<IntegerVariableCondition> {
+                auto size = s.domain_size(var).as_index();
                 // An interior interval needs a plain variable and at least three
                 // values (so lo/hi can both be strictly inside the bounds, making the
                 // reject branch a genuine hole). Otherwise fall back to a value reject.
                 const auto * svar = std::get_if<SimpleIntegerVariableID>(&var);
-                if (svar && values.size() >= 3) {
-                    uniform_int_distribution<size_t> dist(1, values.size() - 2);
+                if (svar && size >= 3) {
+                    uniform_int_distribution<size_t> dist(1, size - 2);
                     auto i = dist(*rand);
                     auto j = dist(*rand);
                     if (i > j)
                         std::swap(i, j);
-                    auto lo = values.at(i);
-                    auto hi = values.at(j);
+                    auto lo = value_at(s, var, i);
+                    auto hi = value_at(s, var, j);
                     co_yield not_in_range(var, lo, hi);
                     co_yield in_range(var, lo, hi);
                 }
                 else {
-                    uniform_int_distribution<size_t> dist(0, values.size() - 1);
-                    auto val = values.at(dist(*rand));
+                    uniform_int_distribution<size_t> dist(0, size - 1);
+                    auto val = value_at(s, var, dist(*rand));
                     co_yield var != val;
                     co_yield var == val;
                 }
-            }(rand, s, var);
+            }(allocator_arg, frame_allocator(s), rand, s, var);
         };
     }
 }
@@ -384,56 +419,56 @@ auto gcs::value_order::reject_random_interval(uint_fast32_t seed) -> BranchValue
 auto gcs::value_order::smallest_in() -> BranchValueGenerator
 {
     return [](const CurrentState & s, const innards::Propagators &, const IntegerVariableID & var) -> generator<IntegerVariableCondition> {
-        return [](const CurrentState & s, IntegerVariableID var) -> generator<IntegerVariableCondition> {
+        return [](allocator_arg_t, FrameAllocator, const CurrentState & s, IntegerVariableID var) -> generator<IntegerVariableCondition> {
             auto value = s.lower_bound(var);
             co_yield var == value;
             co_yield var != value;
-        }(s, var);
+        }(allocator_arg, frame_allocator(s), s, var);
     };
 }
 
 auto gcs::value_order::smallest_out() -> BranchValueGenerator
 {
     return [](const CurrentState & s, const innards::Propagators &, const IntegerVariableID & var) -> generator<IntegerVariableCondition> {
-        return [](const CurrentState & s, IntegerVariableID var) -> generator<IntegerVariableCondition> {
+        return [](allocator_arg_t, FrameAllocator, const CurrentState & s, IntegerVariableID var) -> generator<IntegerVariableCondition> {
             auto value = s.lower_bound(var);
             co_yield var != value;
             co_yield var == value;
-        }(s, var);
+        }(allocator_arg, frame_allocator(s), s, var);
     };
 }
 
 auto gcs::value_order::smallest_first() -> BranchValueGenerator
 {
     return [](const CurrentState & s, const innards::Propagators &, const IntegerVariableID & var) -> generator<IntegerVariableCondition> {
-        return [](const CurrentState & s, IntegerVariableID var) -> generator<IntegerVariableCondition> {
+        return [](allocator_arg_t, FrameAllocator, const CurrentState & s, IntegerVariableID var) -> generator<IntegerVariableCondition> {
             for (auto v : s.each_value(var))
                 co_yield var == v;
-        }(s, var);
+        }(allocator_arg, frame_allocator(s), s, var);
     };
 }
 
 auto gcs::value_order::split_smallest_first() -> BranchValueGenerator
 {
     return [](const CurrentState & s, const innards::Propagators &, const IntegerVariableID & var) -> generator<IntegerVariableCondition> {
-        return [](const CurrentState & s, IntegerVariableID var) -> generator<IntegerVariableCondition> {
+        return [](allocator_arg_t, FrameAllocator, const CurrentState & s, IntegerVariableID var) -> generator<IntegerVariableCondition> {
             auto mid = s.domain_size(var) / 2_i;
-            auto v = *(s.each_value(var) | std::ranges::views::drop((mid - 1_i).as_index())).begin();
+            auto v = value_at(s, var, (mid - 1_i).as_index());
             co_yield var <= v;
             co_yield var > v;
-        }(s, var);
+        }(allocator_arg, frame_allocator(s), s, var);
     };
 }
 
 auto gcs::value_order::split_largest_first() -> BranchValueGenerator
 {
     return [](const CurrentState & s, const innards::Propagators &, const IntegerVariableID & var) -> generator<IntegerVariableCondition> {
-        return [](const CurrentState & s, IntegerVariableID var) -> generator<IntegerVariableCondition> {
+        return [](allocator_arg_t, FrameAllocator, const CurrentState & s, IntegerVariableID var) -> generator<IntegerVariableCondition> {
             auto mid = s.domain_size(var) / 2_i;
-            auto v = *(s.each_value(var) | std::ranges::views::drop((mid - 1_i).as_index())).begin();
+            auto v = value_at(s, var, (mid - 1_i).as_index());
             co_yield var > v;
             co_yield var <= v;
-        }(s, var);
+        }(allocator_arg, frame_allocator(s), s, var);
     };
 }
 
@@ -443,9 +478,10 @@ namespace
     {
         return [rand = move(rand)](
                    const CurrentState & s, const innards::Propagators &, const IntegerVariableID & var) -> generator<IntegerVariableCondition> {
-            return [](shared_ptr<mt19937> rand, const CurrentState & s, IntegerVariableID var) -> generator<IntegerVariableCondition> {
+            return [](allocator_arg_t, FrameAllocator, shared_ptr<mt19937> rand, const CurrentState & s, IntegerVariableID var)
+                       -> generator<IntegerVariableCondition> {
                 auto mid = s.domain_size(var) / 2_i;
-                auto v = *(s.each_value(var) | std::ranges::views::drop((mid - 1_i).as_index())).begin();
+                auto v = value_at(s, var, (mid - 1_i).as_index());
                 if (uniform_int_distribution(0, 1)(*rand) == 0) {
                     co_yield var <= v;
                     co_yield var > v;
@@ -454,7 +490,7 @@ namespace
                     co_yield var > v;
                     co_yield var <= v;
                 }
-            }(rand, s, var);
+            }(allocator_arg, frame_allocator(s), rand, s, var);
         };
     }
 }
@@ -472,45 +508,77 @@ auto gcs::value_order::split_random(uint_fast32_t seed) -> BranchValueGenerator
 auto gcs::value_order::largest_in() -> BranchValueGenerator
 {
     return [](const CurrentState & s, const innards::Propagators &, const IntegerVariableID & var) -> generator<IntegerVariableCondition> {
-        return [](const CurrentState & s, IntegerVariableID var) -> generator<IntegerVariableCondition> {
+        return [](allocator_arg_t, FrameAllocator, const CurrentState & s, IntegerVariableID var) -> generator<IntegerVariableCondition> {
             auto value = s.upper_bound(var);
             co_yield var == value;
             co_yield var != value;
-        }(s, var);
+        }(allocator_arg, frame_allocator(s), s, var);
     };
 }
 
 auto gcs::value_order::largest_out() -> BranchValueGenerator
 {
     return [](const CurrentState & s, const innards::Propagators &, const IntegerVariableID & var) -> generator<IntegerVariableCondition> {
-        return [](const CurrentState & s, IntegerVariableID var) -> generator<IntegerVariableCondition> {
+        return [](allocator_arg_t, FrameAllocator, const CurrentState & s, IntegerVariableID var) -> generator<IntegerVariableCondition> {
             auto value = s.upper_bound(var);
             co_yield var != value;
             co_yield var == value;
-        }(s, var);
+        }(allocator_arg, frame_allocator(s), s, var);
     };
 }
 
 auto gcs::value_order::largest_first() -> BranchValueGenerator
 {
     return [](const CurrentState & s, const innards::Propagators &, const IntegerVariableID & var) -> generator<IntegerVariableCondition> {
-        return [](const CurrentState & s, IntegerVariableID var) -> generator<IntegerVariableCondition> {
+        return [](allocator_arg_t, FrameAllocator, const CurrentState & s, IntegerVariableID var) -> generator<IntegerVariableCondition> {
             for (auto v : s.each_value_reversed(var))
                 co_yield var == v;
-        }(s, var);
+        }(allocator_arg, frame_allocator(s), s, var);
     };
 }
 
 auto gcs::value_order::median() -> BranchValueGenerator
 {
     return [](const CurrentState & s, const innards::Propagators &, const IntegerVariableID & var) -> generator<IntegerVariableCondition> {
-        return [](const CurrentState & s, IntegerVariableID var) -> generator<IntegerVariableCondition> {
-            vector<Integer> values;
-            for (auto v : s.each_value(var))
-                values.push_back(v);
-            auto v = values.at(values.size() / 2);
+        return [](allocator_arg_t, FrameAllocator, const CurrentState & s, IntegerVariableID var) -> generator<IntegerVariableCondition> {
+            auto v = value_at(s, var, (s.domain_size(var) / 2_i).as_index());
             co_yield var == v;
             co_yield var != v;
-        }(s, var);
+        }(allocator_arg, frame_allocator(s), s, var);
     };
 }
+
+namespace
+{
+    // Not itself a coroutine, like branch_with(), so that a variable with no
+    // saved value can be handed to otherwise as it is.
+    auto saved_value_generator(bool solution_first, BranchValueGenerator otherwise) -> BranchValueGenerator
+    {
+        return [solution_first, otherwise = move(otherwise)](
+                   const CurrentState & s, const innards::Propagators & p, const IntegerVariableID & var) -> generator<IntegerVariableCondition> {
+            s.saved_phases().start_recording();
+            optional<Integer> value;
+            if (solution_first)
+                value = s.saved_phases().solution_value(var);
+            if (! value || ! s.in_domain(var, *value))
+                value = s.saved_phases().last_value(var);
+            if (! value || ! s.in_domain(var, *value))
+                return otherwise(s, p, var);
+
+            return [](allocator_arg_t, FrameAllocator, IntegerVariableID var, Integer value) -> generator<IntegerVariableCondition> {
+                co_yield var == value;
+                co_yield var != value;
+            }(allocator_arg, frame_allocator(s), var, *value);
+        };
+    }
+}
+
+auto gcs::value_order::phase_saving(BranchValueGenerator otherwise) -> BranchValueGenerator
+{
+    return saved_value_generator(false, move(otherwise));
+}
+
+auto gcs::value_order::solution_guided(BranchValueGenerator otherwise) -> BranchValueGenerator
+{
+    return saved_value_generator(true, move(otherwise));
+}
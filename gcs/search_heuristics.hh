@@ -112,7 +112,12 @@ namespace gcs
         [[nodiscard]] auto in_order_of(std::vector<IntegerVariableID>, VariableComparator) -> BranchVariableHeuristic;
 
         /**
-         * Branch on the non-assigned variable with smallest domain.
+         * Branch on the non-assigned variable with smallest domain, with ties
+         * going to whichever comes first.
+         *
+         * Rather than looking at every variable at every node, this keeps them
+         * in an innards::VariableSelectionIndex, which hears from propagation
+         * about what has changed. So too do dom_then_deg() and dom_wdeg().
          *
          * \ingroup SearchHeuristics
          * \sa gcs::branch_with()
@@ -178,6 +183,62 @@ namespace gcs
         [[nodiscard]] auto dom_wdeg(std::vector<IntegerVariableID>, WeightingScheme scheme = WeightingScheme::ConflictHistorySearch,
             std::optional<WeightingState> initial = std::nullopt) -> BranchVariableHeuristic;
 
+        /**
+         * \brief Activity-based search (Michel and Van Hentenryck, CPAIOR
+         * 2012): branch on the non-assigned variable with the highest
+         * activity divided by its domain size.
+         *
+         * A variable's activity goes up by one at each node where propagation
+         * changes its domain, and every activity is multiplied by \p decay
+         * at every node, so it says how often the variable has been caught up
+         * in propagation lately. Ties go to the smaller domain, so until
+         * search has seen anything, this behaves like dom(). Activities carry
+         * on across restarts. This suits a model that has no good annotations
+         * of its own, because it finds the variables that everything else
+         * hangs off by watching search.
+         *
+         * \ingroup SearchHeuristics
+         * \sa innards::VariableActivity
+         */
+        [[nodiscard]] auto activity(const Problem &, double decay = 0.999) -> BranchVariableHeuristic;
+
+        /**
+         * \brief Activity-based search over an explicit list of variables.
+         *
+         * \ingroup SearchHeuristics
+         * \sa gcs::variable_order::activity(const Problem &, double)
+         */
+        [[nodiscard]] auto activity(std::vector<IntegerVariableID>, double decay = 0.999) -> BranchVariableHeuristic;
+
+        /**
+         * \brief Impact-based search (Refalo, CP 2004): branch on the
+         * non-assigned variable whose values leave the least search space.
+         *
+         * The impact of assigning a variable a value is how much of the search
+         * space, measured as the product of the domain sizes of the
+         * variables, propagating that decision has been seen to remove, on
+         * average. A variable is chosen by summing, over the values in its
+         * domain, the proportion of search space each would leave, and
+         * taking the smallest sum. The first time a variable is chosen, every
+         * value of every variable with a small domain is tried once, at what
+         * is usually the root, so that search does not start blind. This is
+         * best combined with a value ordering that assigns values, such as
+         * gcs::value_order::smallest_first(), since only then is the impact
+         * of each value learned.
+         *
+         * \ingroup SearchHeuristics
+         * \sa innards::VariableImpact
+         */
+        [[nodiscard]] auto impact(const Problem &) -> BranchVariableHeuristic;
+
+        /**
+         * \brief Impact-based search over an explicit list of variables.
+         *
+         * \ingroup SearchHeuristics
+         * \sa gcs::variable_order::impact(const Problem &)
+         */
+        [[nodiscard]] auto impact(std::vector<IntegerVariableID>) -> BranchVariableHeuristic;
+
         /**
          * Branch on non-assigned variables in this order.
          *
@@ -387,6 +448,37 @@ namespace gcs
          * \ingroup SearchHeuristics
          */
         [[nodiscard]] auto median() -> BranchValueGenerator;
+
+        /**
+         * \brief Accept then reject the value that search last gave the
+         * variable, if it is still in the domain, and otherwise do as \p
+         * otherwise does.
+         *
+         * Once this has been asked for a value, search remembers the value of
+         * every `==` decision it makes, and of every solution it finds, and
+         * does not forget them on backtracking or restarting. So with SolveCallbacks::restarts set, each pass
+         * heads back to where the last one had got to, rather than starting
+         * again from scratch, which is what phase saving does in a SAT
+         * solver.
+         *
+         * \ingroup SearchHeuristics
+         * \sa innards::SavedPhases
+         */
+        [[nodiscard]] auto phase_saving(BranchValueGenerator otherwise = smallest_in()) -> BranchValueGenerator;
+
+        /**
+         * \brief Accept then reject the variable's value in the most recent
+         * solution, if it is still in the domain, and otherwise do as
+         * phase_saving() would.
+         *
+         * When optimising, the most recent solution is the best so far, so
+         * this searches close to it first, for a better one nearby. Until
+         * the first solution, this is the same as phase_saving().
+         *
+         * \ingroup SearchHeuristics
+         * \sa innards::SavedPhases
+         */
+        [[nodiscard]] auto solution_guided(BranchValueGenerator otherwise = smallest_in()) -> BranchValueGenerator;
     }
 }
 
@@ -4,21 +4,31 @@
 #include <gcs/current_state.hh>
 #include <gcs/innards/propagators.hh>
 #include <gcs/innards/state.hh>
+#include <gcs/innards/variable_activity.hh>
+#include <gcs/innards/variable_impact.hh>
 #include <gcs/problem.hh>
 #include <gcs/search_heuristics.hh>
 #include <gcs/solve.hh>
 #include <gcs/variable_id.hh>
 #include <gcs/variable_weighting.hh>
 
+#include <catch2/catch_approx.hpp>
 #include <catch2/catch_test_macros.hpp>
 #include <catch2/generators/catch_generators.hpp>
 
+#include <memory>
 #include <optional>
 #include <vector>
 
 using namespace gcs;
 using namespace gcs::innards;
 
+using Catch::Approx;
+
+using std::make_shared;
+using std::nullopt;
+using std::optional;
+using std::shared_ptr;
 using std::vector;
 
 namespace
@@ -228,3 +238,218 @@ TEST_CASE("dom_wdeg wired into solve_with finds every solution")
 
     CHECK(solutions == 6);
 }
+
+TEST_CASE("activity remembers what propagation touched, across backtracking")
+{
+    State state;
+    auto a = state.allocate_integer_variable_with_state(0_i, 9_i);
+    auto b = state.allocate_integer_variable_with_state(0_i, 9_i);
+    Stats stats;
+    Propagators propagators{stats};
+
+    VariableActivity activity{{a, b}, 0.5};
+    propagators.add_domain_change_observer(&activity);
+
+    // Nothing has happened yet, so ties go to the first variable.
+    CHECK(activity.select(state.current()) == optional<IntegerVariableID>{a});
+
+    // Touching b twice at one node bumps it once, and the next node's bump is
+    // bigger, because the first has decayed.
+    auto timestamp = state.new_epoch();
+    state.guess(b < 5_i);
+    state.guess(b != 7_i);
+    REQUIRE(propagators.propagate(Literals{b < 5_i, b != 7_i}, state, nullptr));
+    CHECK(activity.activity_of(b) == Approx(1.0));
+    state.guess(a < 5_i);
+    REQUIRE(propagators.propagate(Literals{a < 5_i}, state, nullptr));
+    CHECK(activity.activity_of(a) == Approx(2.0));
+    CHECK(activity.select(state.current()) == optional<IntegerVariableID>{a});
+
+    // Domains go back on backtracking, but activities do not.
+    state.backtrack(timestamp);
+    CHECK(activity.activity_of(a) == Approx(2.0));
+    CHECK(activity.select(state.current()) == optional<IntegerVariableID>{a});
+
+    state.guess(a == 1_i);
+    REQUIRE(propagators.propagate(Literals{a == 1_i}, state, nullptr));
+    CHECK(activity.select(state.current()) == optional<IntegerVariableID>{b});
+}
+
+TEST_CASE("impact probes the root and measures each decision")
+{
+    // Fixing x fixes y too, leaving a ninth of the search space, and fixing z
+    // leaves a sixth, wherever search is, so those are the impacts whether
+    // they were seen when probing or when searching.
+    Problem problem;
+    auto x = problem.create_integer_variable(1_i, 3_i);
+    auto y = problem.create_integer_variable(1_i, 3_i);
+    auto z = problem.create_integer_variable(1_i, 6_i);
+    problem.post(Equals{x, y});
+
+    shared_ptr<VariableImpact> impact;
+    optional<IntegerVariableID> first_choice;
+    auto keeping_hold = [&](const Problem &, State & state, Propagators & propagators) -> BranchVariableSelector {
+        impact = make_shared<VariableImpact>(vector<IntegerVariableID>{z, x, y}, state, propagators);
+        propagators.add_domain_change_observer(impact.get());
+        return [&](const CurrentState & s, const Propagators &) -> optional<IntegerVariableID> {
+            auto result = impact->select(s);
+            if (! first_choice)
+                first_choice = result;
+            return result;
+        };
+    };
+
+    int solutions = 0;
+    solve_with(problem,
+        SolveCallbacks{.solution = [&](const CurrentState &) -> bool {
+                           ++solutions;
+                           return true;
+                       },
+            .branch = branch_with(keeping_hold, value_order::smallest_first())});
+
+    CHECK(solutions == 18);
+    CHECK(first_choice == optional<IntegerVariableID>{x});
+    CHECK(impact->impact_of(x) == Approx(8.0 / 9.0));
+    CHECK(impact->impact_of(x, 2_i) == Approx(8.0 / 9.0));
+    CHECK(impact->impact_of(z) == Approx(5.0 / 6.0));
+    CHECK(impact->impact_of(z, 4_i) == Approx(5.0 / 6.0));
+}
+
+TEST_CASE("activity and impact wired into solve_with find every solution")
+{
+    // As for dom_wdeg, these only change the order of search, so must still
+    // find the 12 permutations of 1..4 with x[0] < x[3], with or without
+    // restarts, and whichever way values are tried.
+    auto which = GENERATE(0, 1);
+    auto restarts = GENERATE(false, true);
+    auto split = GENERATE(false, true);
+
+    Problem problem;
+    vector<IntegerVariableID> xs;
+    for (int i = 0; i < 4; ++i)
+        xs.push_back(problem.create_integer_variable(1_i, 4_i));
+    for (unsigned i = 0; i < xs.size(); ++i)
+        for (unsigned j = i + 1; j < xs.size(); ++j)
+            problem.post(NotEquals{xs[i], xs[j]});
+    problem.post(LessThan{xs[0], xs[3]});
+
+    int solutions = 0;
+    SolveCallbacks callbacks{.solution = [&](const CurrentState &) -> bool {
+                                 ++solutions;
+                                 return true;
+                             },
+        .branch = branch_with(0 == which ? variable_order::activity(problem) : variable_order::impact(problem),
+            split ? value_order::split_smallest_first() : value_order::smallest_first())};
+    if (restarts)
+        callbacks.restarts = RestartSchedule::luby(1);
+    solve_with(problem, callbacks);
+
+    CHECK(solutions == 12);
+}
+
+TEST_CASE("phase_saving and solution_guided branch on the values search saved")
+{
+    State state;
+    auto x = state.allocate_integer_variable_with_state(0_i, 9_i);
+    Stats stats;
+    Propagators propagators{stats};
+
+    // The fallback's coroutine refers to the CurrentState, so it must outlive
+    // every generator.
+    auto current = state.current();
+    auto branches = [&](const BranchValueGenerator & gen, const IntegerVariableID & var) {
+        vector<IntegerVariableCondition> result;
+        for (auto c : gen(current, propagators, var))
+            result.push_back(c);
+        return result;
+    };
+
+    auto phase_saving = value_order::phase_saving();
+    auto solution_guided = value_order::solution_guided();
+    using Branches = vector<IntegerVariableCondition>;
+
+    // With nothing saved, both do as smallest_in() would.
+    CHECK(branches(phase_saving, x) == Branches{x == 0_i, x != 0_i});
+    CHECK(branches(solution_guided, x) == Branches{x == 0_i, x != 0_i});
+
+    // A solution's value is also the last value search gave.
+    state.saved_phases().save_solution_value(x, 6_i);
+    CHECK(branches(phase_saving, x) == Branches{x == 6_i, x != 6_i});
+    CHECK(branches(solution_guided, x) == Branches{x == 6_i, x != 6_i});
+
+    state.saved_phases().save(x, 2_i);
+    CHECK(branches(phase_saving, x) == Branches{x == 2_i, x != 2_i});
+    CHECK(branches(solution_guided, x) == Branches{x == 6_i, x != 6_i});
+
+    // Values are saved for what is underneath a view, and read back through
+    // whichever view asks.
+    state.saved_phases().save(x + 3_i, 8_i);
+    CHECK(state.saved_phases().last_value(x) == optional{5_i});
+    CHECK(state.saved_phases().last_value(-x) == optional{-5_i});
+    CHECK(branches(phase_saving, -x) == Branches{-x == -5_i, -x != -5_i});
+
+    // A saved value that is no longer in the domain is passed over.
+    auto timestamp = state.new_epoch();
+    state.guess(x != 6_i);
+    CHECK(branches(solution_guided, x) == Branches{x == 5_i, x != 5_i});
+    state.guess(x > 5_i);
+    CHECK(branches(solution_guided, x) == Branches{x == 7_i, x != 7_i});
+    state.backtrack(timestamp);
+
+    // And none of this is undone by backtracking.
+    CHECK(state.saved_phases().solution_value(x) == optional{6_i});
+}
+
+TEST_CASE("phase_saving and solution_guided wired into solve_with find the optimum")
+{
+    // Each pass of a restarting search picks up where the last left off, so
+    // must still find solutions that only ever improve, and end at the
+    // optimum, with a solution's values saved before the callback sees it.
+    auto solution_first = GENERATE(false, true);
+    auto restarts = GENERATE(false, true);
+
+    Problem problem;
+    vector<IntegerVariableID> xs;
+    for (int i = 0; i < 4; ++i)
+        xs.push_back(problem.create_integer_variable(1_i, 4_i));
+    for (unsigned i = 0; i < xs.size(); ++i)
+        for (unsigned j = i + 1; j < xs.size(); ++j)
+            problem.post(NotEquals{xs[i], xs[j]});
+    problem.post(LessThan{xs[1], xs[2]});
+    problem.maximise(xs[0]);
+
+    optional<Integer> best;
+    bool completed = false;
+    SolveCallbacks callbacks{.solution = [&](const CurrentState & s) -> bool {
+                                 CHECK((! best || s(xs[0]) > *best));
+                                 best = s(xs[0]);
+                                 for (const auto & x : xs)
+                                     CHECK(s.saved_phases().solution_value(x) == optional{s(x)});
+                                 return true;
+                             },
+        .branch = branch_with(variable_order::dom(problem), solution_first ? value_order::solution_guided() : value_order::phase_saving()),
+        .completed = [&]() { completed = true; }};
+    if (restarts)
+        callbacks.restarts = RestartSchedule::luby(1);
+    solve_with(problem, callbacks);
+
+    CHECK(completed);
+    CHECK(best == optional{4_i});
+}
+
+TEST_CASE("Search saves no values unless a value order reads them")
+{
+    Problem problem;
+    auto xs = problem.create_integer_variable_vector(3, 1_i, 3_i);
+    problem.post(LessThan{xs[0], xs[1]});
+
+    auto phase_saving = GENERATE(false, true);
+    bool saved = false;
+    solve_with(problem,
+        SolveCallbacks{.solution = [&](const CurrentState & s) -> bool {
+                           saved = s.saved_phases().recording() && s.saved_phases().solution_value(xs[0]).has_value();
+                           return false;
+                       },
+            .branch = branch_with(variable_order::in_order(xs), phase_saving ? value_order::phase_saving() : value_order::smallest_first())});
+    CHECK(saved == phase_saving);
+}
@@ -14,25 +14,48 @@
 
 #include <util/enumerate.hh>
 
+#include <algorithm>
+#include <condition_variable>
 #include <cstdlib>
+#include <exception>
+#include <fstream>
+#include <functional>
 #include <limits>
+#include <memory>
+#include <mutex>
+#include <ranges>
 #include <string>
+#include <thread>
 #include <variant>
 
 using namespace gcs;
 using namespace gcs::innards;
 
 using std::atomic;
+using std::condition_variable;
+using std::current_exception;
+using std::exception_ptr;
+using std::function;
 using std::make_shared;
+using std::make_unique;
 using std::max;
+using std::min;
+using std::mutex;
 using std::nullopt;
 using std::numeric_limits;
+using std::ofstream;
 using std::optional;
 using std::pair;
+using std::rethrow_exception;
 using std::shared_ptr;
+using std::string;
+using std::thread;
+using std::unique_lock;
+using std::unique_ptr;
 using std::vector;
 using std::chrono::duration_cast;
 using std::chrono::microseconds;
+using std::chrono::milliseconds;
 using std::chrono::steady_clock;
 
 namespace
@@ -54,7 +77,7 @@ namespace
     };
 
     /**
-     * The restart budget threaded through the recursion: how many conflicts
+     * The restart budget threaded through the search: how many conflicts
      * (dead-end nodes) the current run has seen, and the cutoff at which it
      * should abandon the tree and restart. When restarts are disabled the cutoff
      * is "infinite", so the check never fires and search is a single pass.
@@ -66,44 +89,156 @@ namespace
         bool enabled;
     };
 
+    /**
+     * What the threads of a parallel search share: the best objective value
+     * found so far, which every thread prunes against, the lock under which
+     * solution and trace callbacks run, and the flag that stops every thread.
+     * The incumbent only ever improves, and only under the lock, so a thread
+     * may read it without the lock and at worst prune with a stale bound.
+     */
+    struct SharedSearch
+    {
+        mutex callback_mutex;
+        atomic<bool> has_incumbent{false};
+        atomic<long long> incumbent{0};
+        atomic<bool> stop{false};
+
+        auto tighten(optional<Integer> & objective_value) const -> void
+        {
+            if (has_incumbent.load()) {
+                auto value = Integer{incumbent.load()};
+                if ((! objective_value) || value < *objective_value)
+                    objective_value = value;
+            }
+        }
+
+        // Must be called with callback_mutex held. Returns false if another
+        // thread has already found a solution at least as good.
+        auto offer_incumbent(Integer value) -> bool
+        {
+            if (has_incumbent.load() && Integer{incumbent.load()} <= value)
+                return false;
+            incumbent.store(value.raw_value);
+            has_incumbent.store(true);
+            return true;
+        }
+    };
+
+    using BranchGenerator = std::generator<IntegerVariableCondition>;
+
+    /**
+     * One open node of solve_with_state()'s explicit stack: what a recursive
+     * search would keep in a stack frame. The root has no timestamp, because
+     * its caller opened no epoch for it; every other node's was opened by its
+     * parent just before the node was pushed.
+     */
+    struct SearchNode
+    {
+        unsigned long long depth = 0;
+        optional<Literal> branch_guess{};
+        optional<Timestamp> timestamp{};
+        vector<IntegerVariableCondition> reduced_prefix{};
+        bool contains_solution = false;
+        SearchResult result = SearchResult::Complete;
+
+        // The brancher's generator, and where we are in it. The generator's
+        // frame may come from the search arena, so the node must be popped,
+        // destroying it, before its epoch is backtracked.
+        optional<BranchGenerator> branches{};
+        optional<std::ranges::iterator_t<BranchGenerator>> branch_iter{};
+
+        // The branch whose subtree is being searched below this node.
+        optional<Literal> exploring{};
+
+        // Reduced nld-nogoods thread down only the *positive* branch decisions:
+        // see where child prefixes are built in solve_with_state().
+        optional<IntegerVariableCondition> first_sibling{};
+        unsigned long long sibling_index = 0;
+
+        // Branch decisions this node tried and whose subtree was then fully
+        // refuted, before any restart cutoff hit. On a restart unwind each is a
+        // learned nogood (the path to here plus that decision).
+        vector<Literal> refuted_siblings{};
+    };
+
+    /**
+     * Search the tree below the current state, depth first, starting at the
+     * given depth. This does what recursing once per decision would, but the
+     * open nodes are kept on an explicit stack of SearchNode rather than on the
+     * thread's stack, so depth is limited only by memory, and the nodes of a
+     * search in progress are data that could be inspected or handed on.
+     *
+     * Each node goes through the same steps a recursive call would: Enter
+     * propagates and either finds a solution, a dead end, or builds the
+     * generator of branches; Branch opens an epoch and pushes a child for the
+     * next branch; Finish does the restart-nogood learning and proof-level
+     * bookkeeping that a recursive call does on the way out; and Return pops
+     * the node and tells its parent how it went. A Stop returns at once without
+     * the Finish step, because the proof is abandoned.
+     */
     auto solve_with_state(unsigned long long depth, Stats & stats, Problem & problem, Propagators & propagators, State & state,
         const optional<Literal> & this_branch_guess, SolveCallbacks & callbacks, const BranchCallback & branch_callback, ProofLogger * const logger,
         bool & this_subtree_contains_solution, Integer & number_of_solutions, optional<Integer> & objective_value, RestartState & restart,
-        NogoodStore * const learned_nogoods, const vector<IntegerVariableCondition> & reduced_prefix, atomic<bool> * optional_abort_flag)
-        -> SearchResult
+        NogoodStore * const learned_nogoods, const vector<IntegerVariableCondition> & reduced_prefix, SharedSearch * const shared,
+        atomic<bool> * optional_abort_flag) -> SearchResult
     {
-        stats.max_depth = max(stats.max_depth, depth);
-        ++stats.recursions;
+        // The branchers in search_heuristics.cc are coroutines, so calling
+        // branch_callback only builds the frame: the CurrentState reference is
+        // stored, and nothing reads it until begin() resumes the coroutine.
+        // State::current() returns by value, so it must be bound to something
+        // that outlives every generator. It only refers to state, so one serves
+        // every node.
+        auto current_state = state.current();
 
-        if (logger)
-            logger->enter_proof_level(depth + 1);
+        enum class Step
+        {
+            Enter,
+            Branch,
+            Finish,
+            Return
+        };
 
-        auto result = SearchResult::Complete;
+        vector<SearchNode> stack;
+        stack.push_back(SearchNode{.depth = depth,
+            .branch_guess = this_branch_guess,
+            .reduced_prefix = reduced_prefix,
+            .contains_solution = this_subtree_contains_solution});
+        auto returning = SearchResult::Complete;
+
+        auto return_from = [&](SearchResult result) -> Step {
+            returning = result;
+            return Step::Return;
+        };
+
+        auto enter = [&](SearchNode & node) -> Step {
+            stats.max_depth = max(stats.max_depth, node.depth);
+            ++stats.recursions;
+
+            if (logger)
+                logger->enter_proof_level(node.depth + 1);
+
+            if (restart.conflicts_since_restart >= restart.cutoff) {
+                // This run has spent its conflict budget: abandon the tree and unwind
+                // to the root for a restart. Unlike Stop we go through Finish at this
+                // and every ancestor node, so the proof stays balanced and the
+                // restart can continue it.
+                node.result = SearchResult::RestartCutoffHit;
+                return Step::Finish;
+            }
 
-        // Branch decisions this frame tried and whose subtree was then fully
-        // refuted, before any restart cutoff hit. On a restart unwind each is a
-        // learned nogood (the path to here plus that decision).
-        vector<Literal> refuted_siblings;
-
-        if (restart.conflicts_since_restart >= restart.cutoff) {
-            // This run has spent its conflict budget: abandon the tree and unwind
-            // to the root for a restart. Unlike Stop we fall through to the tail
-            // backtrack/forget logging below, at this and every ancestor frame, so
-            // the proof stays balanced and the restart can continue it.
-            result = SearchResult::RestartCutoffHit;
-        }
-        else {
             bool objective_failure = false;
             Literals guesses;
-            if (this_branch_guess)
-                guesses.push_back(*this_branch_guess);
+            if (node.branch_guess)
+                guesses.push_back(*node.branch_guess);
+            if (shared && problem.optional_minimise_variable())
+                shared->tighten(objective_value);
             if (problem.optional_minimise_variable() && objective_value) {
                 auto objective_bound = *problem.optional_minimise_variable() < *objective_value;
                 switch (state.infer(objective_bound)) {
                 case Inference::Contradiction: objective_failure = true; break;
                 case Inference::NoChange: break;
                 // The branch-and-bound bound tightened the objective variable, so seed the queue with
-                // its propagators too. Without this only this_branch_guess seeds the queue, and a
+                // its propagators too. Without this only the branch guess seeds the queue, and a
                 // propagator that would react to the new objective bound is not re-run here (issue #418).
                 case Inference::BoundsChanged:
                 case Inference::InteriorValuesChanged:
@@ -111,176 +246,1087 @@ namespace
                 }
             }
 
-            if ((! objective_failure) && propagators.propagate(guesses, state, logger, optional_abort_flag)) {
-                if (optional_abort_flag && optional_abort_flag->load())
-                    return SearchResult::Stop;
-
-                // The branchers in search_heuristics.cc are coroutines, so calling
-                // branch_callback only builds the frame: the CurrentState reference is
-                // stored, and nothing reads it until begin() resumes the coroutine on
-                // the next line. State::current() returns by value, so a temporary here
-                // would be dead by then -- it works only for as long as nothing reuses
-                // that stack slot. Bind it to a local that outlives the generator.
-                auto current_state = state.current();
-                auto branch_generator = branch_callback(current_state, propagators);
-                auto branch_iter = branch_generator.begin();
-
-                if (branch_iter == branch_generator.end()) {
-                    if (logger) {
-                        vector<pair<IntegerVariableID, Integer>> vars_and_values;
-                        for (const auto & v : problem.all_normal_variables())
-                            vars_and_values.emplace_back(v, state(v));
-                        logger->solution(vars_and_values,
-                            problem.optional_minimise_variable().transform([&](const IntegerVariableID & var) { return pair{var, state(var)}; }));
+            if (objective_failure || ! propagators.propagate(guesses, state, logger, optional_abort_flag)) {
+                // A dead end: either the objective bound or a propagator wiped out
+                // a domain. That is one conflict spent against the restart budget.
+                ++restart.conflicts_since_restart;
+                return Step::Finish;
+            }
+
+            if (optional_abort_flag && optional_abort_flag->load())
+                return return_from(SearchResult::Stop);
+
+            node.branches.emplace(branch_callback(current_state, propagators));
+            node.branch_iter.emplace(node.branches->begin());
+
+            if (*node.branch_iter == node.branches->end()) {
+                // Under parallel search, solutions are reported one at a time,
+                // and one that another thread has already beaten is dropped.
+                unique_lock<mutex> solution_lock;
+                if (shared) {
+                    solution_lock = unique_lock{shared->callback_mutex};
+                    if (shared->stop.load())
+                        return return_from(SearchResult::Stop);
+                    if (problem.optional_minimise_variable() && ! shared->offer_incumbent(state(*problem.optional_minimise_variable()))) {
+                        shared->tighten(objective_value);
+                        return return_from(SearchResult::Complete);
                     }
+                }
+
+                if (logger) {
+                    vector<pair<IntegerVariableID, Integer>> vars_and_values;
+                    for (const auto & v : problem.all_normal_variables())
+                        vars_and_values.emplace_back(v, state(v));
+                    logger->solution(vars_and_values,
+                        problem.optional_minimise_variable().transform([&](const IntegerVariableID & var) { return pair{var, state(var)}; }));
+                }
 
-                    if (problem.optional_minimise_variable())
-                        objective_value = state(*problem.optional_minimise_variable());
+                if (problem.optional_minimise_variable())
+                    objective_value = state(*problem.optional_minimise_variable());
 
-                    ++stats.solutions;
-                    ++number_of_solutions;
-                    this_subtree_contains_solution = true;
-                    if (callbacks.solution && ! callbacks.solution(state.current()))
-                        return SearchResult::Stop;
+                // Keep the solution, so that solution-guided value orderings
+                // can head back towards it, even after a restart.
+                if (state.saved_phases().recording())
+                    for (const auto & v : problem.all_normal_variables())
+                        state.saved_phases().save_solution_value(v, state(v));
 
-                    // Continuing past a solution while restarting is sound: the
-                    // proof's solx excludes each solution, so a fully-explored
-                    // subtree (solutions and all) is refuted and the nld nogood
-                    // learned for it stops a later pass re-entering and re-counting
-                    // it. So enumeration accumulates each solution exactly once.
+                ++stats.solutions;
+                ++number_of_solutions;
+                node.contains_solution = true;
+                if (callbacks.solution && ! callbacks.solution(state.current())) {
+                    if (shared)
+                        shared->stop.store(true);
+                    return return_from(SearchResult::Stop);
                 }
-                else {
-                    if (callbacks.trace && ! callbacks.trace(state.current()))
-                        return SearchResult::Stop;
-
-                    if (optional_abort_flag && optional_abort_flag->load())
-                        return SearchResult::Stop;
-
-                    auto recurse = [&](const Literal & guess, const vector<IntegerVariableCondition> & child_prefix) -> SearchResult {
-                        if (optional_abort_flag && optional_abort_flag->load())
-                            return SearchResult::Stop;
-
-                        auto timestamp = state.new_epoch();
-                        state.guess(guess);
-                        bool child_contains_solution = false;
-                        auto child_result = solve_with_state(depth + 1, stats, problem, propagators, state, guess, callbacks, branch_callback, logger,
-                            child_contains_solution, number_of_solutions, objective_value, restart, learned_nogoods, child_prefix,
-                            optional_abort_flag);
-
-                        if (child_contains_solution)
-                            this_subtree_contains_solution = true;
-                        else
-                            ++stats.failures;
-
-                        state.backtrack(timestamp);
-                        return child_result;
-                    };
 
-                    // Reduced nld-nogoods thread down only the *positive* branch
-                    // decisions. A binary branch's second sibling is the negation of
-                    // its first (x=v then x!=v, or x<=v then x>v): descending into it
-                    // is a refutation flip --- a negative decision --- so it is
-                    // dropped, because the first sibling's own recorded nogood
-                    // re-derives it on the next pass. Every other descended sibling
-                    // (a first sibling, or any d-way value) is a free positive
-                    // decision and extends the prefix.
-                    optional<IntegerVariableCondition> first_sibling;
-                    unsigned long long sibling_index = 0;
-                    for (; branch_iter != branch_generator.end(); ++branch_iter) {
-                        auto guess = *branch_iter;
-                        // Only maintain the reduced prefix when we are actually
-                        // learning nogoods: otherwise reduced_prefix stays empty and
-                        // the copy is free, so ordinary search pays nothing.
-                        auto child_prefix = reduced_prefix;
-                        if (learned_nogoods) {
-                            bool negative_flip = sibling_index == 1 && first_sibling && guess == ! *first_sibling;
-                            if (! negative_flip)
-                                child_prefix.push_back(guess);
-                            if (sibling_index == 0)
-                                first_sibling = guess;
-                            ++sibling_index;
-                        }
-
-                        auto child_result = recurse(guess, child_prefix);
-                        if (child_result == SearchResult::Stop)
-                            return SearchResult::Stop;
-                        if (child_result == SearchResult::RestartCutoffHit) {
-                            result = SearchResult::RestartCutoffHit;
-                            break;
-                        }
-                        // Complete: this sibling's subtree was refuted under the
-                        // current path, so record it for restart-nogood learning.
-                        refuted_siblings.push_back(guess);
+                // Continuing past a solution while restarting is sound: the
+                // proof's solx excludes each solution, so a fully-explored
+                // subtree (solutions and all) is refuted and the nld nogood
+                // learned for it stops a later pass re-entering and re-counting
+                // it. So enumeration accumulates each solution exactly once.
+                return Step::Finish;
+            }
+
+            if (callbacks.trace) {
+                auto trace_lock = shared ? unique_lock{shared->callback_mutex} : unique_lock<mutex>{};
+                if (! callbacks.trace(state.current())) {
+                    if (shared)
+                        shared->stop.store(true);
+                    return return_from(SearchResult::Stop);
+                }
+            }
+
+            if (optional_abort_flag && optional_abort_flag->load())
+                return return_from(SearchResult::Stop);
+
+            return Step::Branch;
+        };
+
+        // Pushes a child, so node is not valid afterwards.
+        auto branch = [&](SearchNode & node) -> Step {
+            if (*node.branch_iter == node.branches->end())
+                return Step::Finish;
+
+            auto guess = **node.branch_iter;
+
+            // Reduced nld-nogoods thread down only the *positive* branch
+            // decisions. A binary branch's second sibling is the negation of
+            // its first (x=v then x!=v, or x<=v then x>v): descending into it
+            // is a refutation flip --- a negative decision --- so it is
+            // dropped, because the first sibling's own recorded nogood
+            // re-derives it on the next pass. Every other descended sibling
+            // (a first sibling, or any d-way value) is a free positive
+            // decision and extends the prefix. Only maintain the reduced
+            // prefix when we are actually learning nogoods: otherwise it
+            // stays empty and the copy is free, so ordinary search pays
+            // nothing.
+            auto child_prefix = node.reduced_prefix;
+            if (learned_nogoods) {
+                bool negative_flip = node.sibling_index == 1 && node.first_sibling && guess == ! *node.first_sibling;
+                if (! negative_flip)
+                    child_prefix.push_back(guess);
+                if (node.sibling_index == 0)
+                    node.first_sibling = guess;
+                ++node.sibling_index;
+            }
+
+            if (optional_abort_flag && optional_abort_flag->load())
+                return return_from(SearchResult::Stop);
+
+            auto timestamp = state.new_epoch();
+            state.guess(guess);
+            if (guess.op == VariableConditionOperator::Equal && state.saved_phases().recording())
+                state.saved_phases().save(guess.var, guess.value);
+            node.exploring = guess;
+            stack.push_back(SearchNode{.depth = node.depth + 1, .branch_guess = guess, .timestamp = timestamp, .reduced_prefix = move(child_prefix)});
+            return Step::Enter;
+        };
+
+        auto finish = [&](SearchNode & node) -> Step {
+            // Restart-nogood learning: each sibling refuted at this node before the
+            // cutoff yields a reduced nld-nogood --- the positive decisions on the path
+            // to here (reduced_prefix) plus that refuted decision. The clause drops the
+            // negative (refutation-flip) path decisions but is still RUP: this is logged
+            // during the deep-first unwind, when the ancestor nodes' backtrack lemmas
+            // (which force exactly those dropped negatives) are still live below Top, so
+            // RUP re-derives them. We derive it at Top so it survives the forget below
+            // and the whole restart, and feed it to the store for the next pass.
+            if (learned_nogoods && node.result == SearchResult::RestartCutoffHit) {
+                for (const auto & sibling : node.refuted_siblings) {
+                    // The refuted sibling heads the nogood; if it is not a plain
+                    // condition (a proof-scaffolding literal) skip it.
+                    auto sibling_cond = std::get_if<IntegerVariableCondition>(&sibling);
+                    if (! sibling_cond)
+                        continue;
+                    Nogood nogood = node.reduced_prefix;
+                    nogood.push_back(*sibling_cond);
+                    optional<ProofLine> proof_line;
+                    if (logger) {
+                        vector<Literal> decisions;
+                        decisions.reserve(node.reduced_prefix.size() + 1);
+                        for (const auto & cond : node.reduced_prefix)
+                            decisions.push_back(cond);
+                        decisions.push_back(*sibling_cond);
+                        proof_line = logger->emit_learned_nogood(decisions);
                     }
+                    learned_nogoods->add(move(nogood), proof_line);
+                    ++stats.learned_nogoods;
                 }
             }
-            else {
-                // A dead end: either the objective bound or a propagator wiped out
-                // a domain. That is one conflict spent against the restart budget.
-                ++restart.conflicts_since_restart;
+
+            if (logger) {
+                logger->enter_proof_level(node.depth);
+                if (node.result == SearchResult::RestartCutoffHit) {
+                    // We must NOT delete the root node's own guess-independent
+                    // propagation (proof level 1): the next pass starts from the same
+                    // root fixpoint, so propagate() re-emits nothing there, and that
+                    // reasoning has to survive for the next pass's backtracks to remain
+                    // RUP. So at the root (depth 0) we keep level 1; deeper
+                    // guess-dependent levels are re-derived next pass.
+                    if (node.depth > 0)
+                        logger->forget_proof_level(node.depth + 1);
+                }
+                else {
+                    // A normal backtrack: the subtree under these guesses was refuted,
+                    // so we may assert the negation of the guess set (RUP from the
+                    // refutation that the forget below then discards).
+                    vector<Literal> guesses;
+                    for (const auto & g : state.guesses())
+                        guesses.push_back(g);
+                    logger->backtrack(guesses);
+                    logger->forget_proof_level(node.depth + 1);
+                }
+            }
+
+            return return_from(node.result);
+        };
+
+        // Pops the node on top, which has returned, and carries on with its
+        // parent, as a recursive call's caller would.
+        auto pop = [&]() -> Step {
+            auto child_contains_solution = stack.back().contains_solution;
+            auto timestamp = *stack.back().timestamp;
+            stack.pop_back();
+
+            auto & parent = stack.back();
+            if (child_contains_solution)
+                parent.contains_solution = true;
+            else
+                ++stats.failures;
+            state.backtrack(timestamp);
+
+            switch (returning) {
+            case SearchResult::Stop: return Step::Return;
+            case SearchResult::RestartCutoffHit: parent.result = SearchResult::RestartCutoffHit; return Step::Finish;
+            case SearchResult::Complete:
+                // This branch's subtree was refuted under the current path, so
+                // record it for restart-nogood learning.
+                if (learned_nogoods)
+                    parent.refuted_siblings.push_back(*parent.exploring);
+                ++*parent.branch_iter;
+                return Step::Branch;
+            }
+            throw NonExhaustiveSwitch{};
+        };
+
+        auto step = Step::Enter;
+        while (true) {
+            switch (step) {
+            case Step::Enter: step = enter(stack.back()); break;
+            case Step::Branch: step = branch(stack.back()); break;
+            case Step::Finish: step = finish(stack.back()); break;
+            case Step::Return:
+                if (stack.size() == 1) {
+                    this_subtree_contains_solution = stack.back().contains_solution;
+                    return returning;
+                }
+                step = pop();
+                break;
             }
         }
+    }
+}
 
-        // Restart-nogood learning: each sibling refuted at this frame before the
-        // cutoff yields a reduced nld-nogood --- the positive decisions on the path
-        // to here (reduced_prefix) plus that refuted decision. The clause drops the
-        // negative (refutation-flip) path decisions but is still RUP: this is logged
-        // during the deep-first unwind, when the ancestor frames' backtrack lemmas
-        // (which force exactly those dropped negatives) are still live below Top, so
-        // RUP re-derives them. We derive it at Top so it survives the forget below
-        // and the whole restart, and feed it to the store for the next pass.
-        if (learned_nogoods && result == SearchResult::RestartCutoffHit && ! refuted_siblings.empty()) {
-            for (const auto & sibling : refuted_siblings) {
-                // The refuted sibling heads the nogood; if it is not a plain
-                // condition (a proof-scaffolding literal) skip it.
-                auto sibling_cond = std::get_if<IntegerVariableCondition>(&sibling);
-                if (! sibling_cond)
-                    continue;
-                Nogood nogood = reduced_prefix;
-                nogood.push_back(*sibling_cond);
-                if (logger) {
-                    vector<Literal> decisions;
-                    decisions.reserve(reduced_prefix.size() + 1);
-                    for (const auto & cond : reduced_prefix)
-                        decisions.push_back(cond);
-                    decisions.push_back(*sibling_cond);
-                    logger->emit_learned_nogood(decisions);
+namespace
+{
+    /**
+     * Does this search trail domains rather than copying them? The caller
+     * says, or failing that the GCS_TRAILED_STATE environment variable does.
+     */
+    auto trail_domains(const SolveCallbacks & callbacks) -> bool
+    {
+        static const bool trail_by_default = nullptr != std::getenv("GCS_TRAILED_STATE");
+        return callbacks.trail_domains.value_or(trail_by_default);
+    }
+
+    /**
+     * Install an (initially empty) Nogoods over a new store that the restart
+     * loop grows, subscribed to every variable since a later-learned nogood may
+     * mention any.
+     */
+    auto install_learned_nogoods(Problem & problem, Propagators & propagators, State & state, ProofModel * const model) -> shared_ptr<NogoodStore>
+    {
+        auto nogood_store = make_shared<NogoodStore>();
+        // Use refined per-literal watches for the learned-nogood store (issue #335,
+        // stage C-2): the propagator wakes only when a learned clause loses a
+        // non-entailed literal and visits only the clauses that fired, rather than
+        // the coarse wake-on-every-variable-and-scan-the-whole-store path that was
+        // the ~13.1M-wasted-propagation cost. Setting GCS_LEARNED_NOGOODS_SCAN picks
+        // the legacy scan path, for the scan-vs-refined differential and perf check.
+        bool refined_nogoods = (std::getenv("GCS_LEARNED_NOGOODS_SCAN") == nullptr);
+        auto nogoods_constraint = Nogoods{nogood_store, problem.all_normal_variables(), refined_nogoods};
+        nogoods_constraint.set_constraint_id(NamedConstraint{"learned_nogoods"});
+        std::move(nogoods_constraint).install(propagators, state, model);
+        return nogood_store;
+    }
+
+    /**
+     * Search from the root, as a loop of restarts if there is a schedule: each
+     * pass explores until it has spent its conflict cutoff, then unwinds to the
+     * root (proof balanced) and the schedule grows the cutoff for the next
+     * pass. Weights and the incumbent objective bound persist across passes, so
+     * a later pass searches differently; the growing Luby cutoff eventually
+     * exceeds the whole tree, so a final pass completes. Without a schedule the
+     * cutoff is infinite and this is a single, exhaustive pass. If set,
+     * at_restart is called at each restart boundary, after the conflict
+     * observers have been told and after any reduction of the learned
+     * nogoods, which never touches those learned in the pass just ended.
+     */
+    auto search_from_root(Stats & stats, Problem & problem, Propagators & propagators, State & state, SolveCallbacks & callbacks,
+        const BranchCallback & branch_callback, ProofLogger * const logger, bool & contains_solution, Integer & number_of_solutions,
+        optional<Integer> & objective_value, optional<RestartSchedule> restart_schedule, NogoodStore * const learned_nogoods,
+        SharedSearch * const shared, const function<auto()->void> & at_restart, atomic<bool> * optional_abort_flag) -> SearchResult
+    {
+        RestartState restart{.conflicts_since_restart = 0,
+            .cutoff = restart_schedule ? restart_schedule->current_cutoff() : numeric_limits<unsigned long long>::max(),
+            .enabled = restart_schedule.has_value()};
+
+        // Without an objective, the nogoods may be all that stops a later pass
+        // re-finding, and re-counting, the solutions of a region, so reduction
+        // may only minimise them and never delete for inactivity.
+        auto nogood_reduction = callbacks.nogood_reduction;
+        if (nogood_reduction && ! problem.optional_minimise_variable())
+            nogood_reduction->keep_fraction = 1.0;
+        auto reduction_limit = nogood_reduction ? static_cast<double>(nogood_reduction->limit) : 0.0;
+
+        SearchResult search_result;
+        do {
+            restart.conflicts_since_restart = 0;
+            auto pass_start = learned_nogoods ? learned_nogoods->size() : 0;
+            // The root node has no epoch of its own, so give back what it took
+            // from the search arena by hand, or each pass would add to it.
+            auto arena_mark = state.search_arena().mark();
+            search_result = solve_with_state(0, stats, problem, propagators, state, nullopt, callbacks, branch_callback, logger, contains_solution,
+                number_of_solutions, objective_value, restart, learned_nogoods, vector<IntegerVariableCondition>{}, shared, optional_abort_flag);
+            state.search_arena().release_to(arena_mark);
+
+            if (search_result == SearchResult::RestartCutoffHit) {
+                ++stats.restarts;
+                for (auto & observer : propagators.conflict_observers())
+                    observer->on_restart();
+                if (learned_nogoods && nogood_reduction && static_cast<double>(learned_nogoods->size()) > reduction_limit) {
+                    auto reduced = learned_nogoods->reduce(*nogood_reduction, pass_start, logger);
+                    ++stats.nogood_reductions;
+                    stats.deleted_nogoods += reduced.deleted;
+                    stats.strengthened_nogoods += reduced.strengthened;
+                    reduction_limit *= nogood_reduction->limit_growth;
+                }
+                if (at_restart)
+                    at_restart();
+                restart_schedule->advance();
+                restart.cutoff = restart_schedule->current_cutoff();
+            }
+        } while (search_result == SearchResult::RestartCutoffHit);
+
+        if (learned_nogoods) {
+            stats.held_nogoods = learned_nogoods->size();
+            stats.held_nogood_literals = learned_nogoods->literals();
+        }
+        stats.search_arena_allocations = state.search_arena().allocations();
+        stats.search_arena_heap_allocations = state.search_arena().heap_allocations();
+
+        return search_result;
+    }
+
+    /**
+     * Minimise by large neighbourhood search (see LargeNeighbourhoodSearch):
+     * find a first solution by searching from the root, and then repeatedly
+     * fix some of the variables to their values in the best solution so far,
+     * and search what is left with the restart cutoff as a conflict limit. An
+     * iteration opens an epoch, then one more for each fixing and one for its
+     * search, so backtracking to the first leaves the state as it was at the
+     * root for the next iteration. Only the first search learns nogoods, since
+     * those learned under the fixings would not hold without them.
+     */
+    auto search_with_lns(Stats & stats, Problem & problem, Propagators & propagators, State & state, SolveCallbacks & callbacks,
+        const BranchCallback & branch_callback, bool & contains_solution, Integer & number_of_solutions, optional<Integer> & objective_value,
+        NogoodStore * const learned_nogoods, atomic<bool> * optional_abort_flag) -> SearchResult
+    {
+        const auto & options = *callbacks.lns;
+        auto start_time = steady_clock::now();
+
+        // Keep a copy of each solution as it is found, since it is the best so
+        // far. The first search stops at its first solution, unless it finishes
+        // the whole tree before then.
+        optional<CurrentState> incumbent;
+        bool looking_for_first_solution = true, caller_stopped = false;
+        auto lns_callbacks = callbacks;
+        lns_callbacks.solution = [&](const CurrentState & s) -> bool {
+            incumbent.emplace(s.clone());
+            if (callbacks.solution && ! callbacks.solution(s)) {
+                caller_stopped = true;
+                return false;
+            }
+            return ! looking_for_first_solution;
+        };
+
+        auto search_result = search_from_root(stats, problem, propagators, state, lns_callbacks, branch_callback, nullptr, contains_solution,
+            number_of_solutions, objective_value, callbacks.restarts, learned_nogoods, nullptr, {}, optional_abort_flag);
+        if (search_result != SearchResult::Stop || ! incumbent || caller_stopped || (optional_abort_flag && optional_abort_flag->load()))
+            return search_result;
+        looking_for_first_solution = false;
+
+        auto neighbourhoods = options.neighbourhoods;
+        if (neighbourhoods.empty())
+            neighbourhoods = {neighbourhood::random(options.seed), neighbourhood::propagation_guided(options.seed + 1),
+                neighbourhood::constraint_structured(options.seed + 2)};
+        // Fixing the objective to its value in the best solution so far would
+        // leave nothing better to find.
+        auto variables = options.variables;
+        if (variables.empty())
+            for (const auto & v : problem.all_normal_variables())
+                if (v != *problem.optional_minimise_variable())
+                    variables.push_back(v);
+        auto fix_fraction = options.fix_fraction;
+        auto current_state = state.current();
+
+        for (unsigned long long iteration = 0;; ++iteration) {
+            if (options.iteration_limit && iteration >= *options.iteration_limit)
+                return SearchResult::Stop;
+            if (options.time_limit && steady_clock::now() - start_time >= *options.time_limit)
+                return SearchResult::Stop;
+            if (optional_abort_flag && optional_abort_flag->load())
+                return SearchResult::Stop;
+            ++stats.lns_iterations;
+
+            auto timestamp = state.new_epoch();
+
+            // Fix variables one at a time, each with an epoch of its own so
+            // that one whose fixing fails can be undone on its own. The
+            // generator is destroyed before search starts, because it may
+            // refer to the incumbent, which search may replace.
+            auto to_fix = static_cast<std::size_t>(fix_fraction * static_cast<double>(variables.size()));
+            std::size_t fixed = 0;
+            {
+                auto chosen = neighbourhoods[iteration % neighbourhoods.size()](variables, current_state, *incumbent, propagators);
+                for (auto var = chosen.begin(); fixed < to_fix && var != chosen.end(); ++var) {
+                    if (current_state.has_single_value(*var))
+                        continue;
+                    auto value = (*incumbent)(*var);
+                    if (! current_state.in_domain(*var, value))
+                        continue;
+                    auto fixing_timestamp = state.new_epoch();
+                    auto fixing = *var == value;
+                    state.guess(fixing);
+                    if (propagators.propagate(Literals{fixing}, state, nullptr, optional_abort_flag))
+                        ++fixed;
+                    else
+                        state.backtrack(fixing_timestamp);
+                }
+            }
+
+            // The search is given an epoch of its own, as every node below the
+            // root has, because propagate() leaves things for backtrack() to
+            // undo on the assumption that it runs once per epoch. For the same
+            // reason, it is given the objective bound as if that were the guess
+            // that led to it: propagating with no guesses at all would start
+            // the propagators again from scratch, as is only right at the root.
+            static_cast<void>(state.new_epoch());
+            auto objective_before = objective_value;
+            bool neighbourhood_contains_solution = false;
+            RestartState restart{.conflicts_since_restart = 0, .cutoff = options.conflict_limit, .enabled = true};
+            search_result = solve_with_state(0, stats, problem, propagators, state, *problem.optional_minimise_variable() < *objective_value,
+                lns_callbacks, branch_callback, nullptr, neighbourhood_contains_solution, number_of_solutions, objective_value, restart, nullptr,
+                vector<IntegerVariableCondition>{}, nullptr, optional_abort_flag);
+            state.backtrack(timestamp);
+
+            if (neighbourhood_contains_solution)
+                contains_solution = true;
+            bool improved = objective_value != objective_before;
+            if (improved)
+                ++stats.lns_improvements;
+
+            switch (search_result) {
+            case SearchResult::Stop: return SearchResult::Stop;
+            case SearchResult::Complete:
+                // With nothing fixed, that was a search of the whole tree,
+                // bounded by the best solution so far, so there is no better one.
+                if (fixed == 0)
+                    return SearchResult::Complete;
+                ++stats.lns_exhausted_neighbourhoods;
+                if (options.adapt_fix_fraction)
+                    fix_fraction = max(0.0, fix_fraction - 0.05);
+                break;
+            case SearchResult::RestartCutoffHit:
+                if (options.adapt_fix_fraction && ! improved)
+                    fix_fraction = min(1.0, fix_fraction + 0.05);
+                break;
+            }
+        }
+    }
+
+    /**
+     * Minimise by probing bounds on the objective (see ObjectiveSearch). The
+     * first search runs from the root, restarting if there is a schedule, and
+     * is cut off at its first solution, just as if it had spent its conflicts,
+     * so that the proof stays balanced and the root's own reasoning, at proof
+     * level 1, is kept. Each probe then opens an epoch and guesses the
+     * objective is at most some value, and is searched as a child of the
+     * root, at depth 1, with the conflict limit as its restart cutoff. Like
+     * any other child, a probe that is refuted logs the negation of its guess
+     * at level 1, where it stays, and so the lower bound it proves can be
+     * concluded. The lower bound proved so far comes in as objective_lower_bound
+     * and goes out raised.
+     */
+    auto search_with_objective_probes(Stats & stats, Problem & problem, Propagators & propagators, State & state, SolveCallbacks & callbacks,
+        const BranchCallback & branch_callback, ProofLogger * const logger, bool & contains_solution, Integer & number_of_solutions,
+        optional<Integer> & objective_value, Integer & objective_lower_bound, NogoodStore * const learned_nogoods,
+        atomic<bool> * optional_abort_flag) -> SearchResult
+    {
+        const auto & options = *callbacks.objective_search;
+        auto objective = *problem.optional_minimise_variable();
+
+        // However search ends, it says how much the search arena was used.
+        auto finish = [&](SearchResult result) -> SearchResult {
+            stats.search_arena_allocations = state.search_arena().allocations();
+            stats.search_arena_heap_allocations = state.search_arena().heap_allocations();
+            return result;
+        };
+
+        // A solution cuts off whatever found it at the next node, as if it had
+        // run out of conflicts, so that the next probe can be chosen.
+        RestartState restart{.conflicts_since_restart = 0, .cutoff = numeric_limits<unsigned long long>::max(), .enabled = true};
+        auto probe_callbacks = callbacks;
+        probe_callbacks.solution = [&](const CurrentState & s) -> bool {
+            if (callbacks.solution && ! callbacks.solution(s))
+                return false;
+            restart.cutoff = 0;
+            return true;
+        };
+
+        auto restart_schedule = callbacks.restarts;
+        SearchResult search_result;
+        do {
+            restart.conflicts_since_restart = 0;
+            restart.cutoff = restart_schedule ? restart_schedule->current_cutoff() : numeric_limits<unsigned long long>::max();
+            auto arena_mark = state.search_arena().mark();
+            search_result = solve_with_state(0, stats, problem, propagators, state, nullopt, probe_callbacks, branch_callback, logger,
+                contains_solution, number_of_solutions, objective_value, restart, learned_nogoods, vector<IntegerVariableCondition>{}, nullptr,
+                optional_abort_flag);
+            state.search_arena().release_to(arena_mark);
+
+            if (search_result == SearchResult::RestartCutoffHit && ! objective_value) {
+                ++stats.restarts;
+                for (auto & observer : propagators.conflict_observers())
+                    observer->on_restart();
+                restart_schedule->advance();
+            }
+        } while (search_result == SearchResult::RestartCutoffHit && ! objective_value);
+
+        if (learned_nogoods) {
+            stats.held_nogoods = learned_nogoods->size();
+            stats.held_nogood_literals = learned_nogoods->literals();
+        }
+
+        // Finished, either having proved optimality or unsatisfiability, or
+        // because we were asked to stop.
+        if (search_result != SearchResult::RestartCutoffHit)
+            return finish(search_result);
+
+        // Probes are chosen from between probe_lower_bound and the best
+        // solution so far. That starts at the lower bound after root
+        // propagation, which the proof might not know about, and a dichotomic
+        // search moves it up past each probe that is cut off, so it only says
+        // where to look next, and not what has been proved.
+        auto probe_lower_bound = max(objective_lower_bound, state.lower_bound(objective));
+        auto conflict_limit = static_cast<double>(options.conflict_limit);
+        bool probe_for_solution = false;
+
+        auto raise_lower_bound = [&](Integer bound) {
+            objective_lower_bound = bound;
+            if (logger)
+                logger->objective_lower_bound(objective, bound);
+            if (callbacks.objective_bound)
+                callbacks.objective_bound(bound);
+            stats.report(StatsNote{.level = StatsLevel::Detailed,
+                .component = "objective_search",
+                .constraint = nullopt,
+                .text = "objective is at least " + bound.to_string()});
+        };
+
+        while (objective_lower_bound < *objective_value) {
+            if (optional_abort_flag && optional_abort_flag->load())
+                return finish(SearchResult::Stop);
+
+            auto best = *objective_value;
+            probe_lower_bound = min(max(probe_lower_bound, objective_lower_bound), best - 1_i);
+            Integer mid = 0_i;
+            switch (options.strategy) {
+            case ObjectiveStrategy::Dichotomic: mid = probe_lower_bound + (best - 1_i - probe_lower_bound) / 2_i; break;
+            case ObjectiveStrategy::LowerBounding: mid = probe_for_solution ? best - 1_i : probe_lower_bound; break;
+            }
+
+            // Below the best solution so far, this is branch and bound, and
+            // if it were cut off, search might never end.
+            bool unlimited = mid == best - 1_i && ! probe_for_solution;
+            restart.conflicts_since_restart = 0;
+            restart.cutoff = unlimited ? numeric_limits<unsigned long long>::max() : static_cast<unsigned long long>(max(1.0, conflict_limit));
+
+            // Root propagation can already rule the probe out, if the best
+            // solution so far is at its bound, and then there is nothing to
+            // guess, and the new bound follows from what the root proved.
+            auto probe = objective <= mid;
+            if (state.test_literal(probe) == LiteralIs::DefinitelyFalse) {
+                raise_lower_bound(mid + 1_i);
+                continue;
+            }
+
+            auto timestamp = state.new_epoch();
+            state.guess(probe);
+            bool probe_contains_solution = false;
+            search_result = solve_with_state(1, stats, problem, propagators, state, probe, probe_callbacks, branch_callback, logger,
+                probe_contains_solution, number_of_solutions, objective_value, restart, nullptr, vector<IntegerVariableCondition>{}, nullptr,
+                optional_abort_flag);
+            state.backtrack(timestamp);
+            ++stats.objective_probes;
+
+            if (probe_contains_solution)
+                contains_solution = true;
+
+            switch (search_result) {
+            case SearchResult::Stop: return finish(SearchResult::Stop);
+            case SearchResult::Complete:
+                // Nothing at most mid beats the best solution so far, which
+                // may be one that this probe found.
+                ++stats.refuted_objective_probes;
+                raise_lower_bound(min(mid + 1_i, *objective_value));
+                break;
+            case SearchResult::RestartCutoffHit:
+                // A better solution means bisecting afresh. Otherwise, a
+                // dichotomic search looks higher up, where probes are easier,
+                // and lower bounding stays where it is, but first gives as
+                // many conflicts to looking for a better solution.
+                if (objective_value != best)
+                    probe_lower_bound = objective_lower_bound;
+                else if (options.strategy == ObjectiveStrategy::Dichotomic) {
+                    probe_lower_bound = mid + 1_i;
+                    conflict_limit *= options.conflict_limit_growth;
+                }
+                else if (probe_for_solution)
+                    conflict_limit *= options.conflict_limit_growth;
+                break;
+            }
+
+            if (options.strategy == ObjectiveStrategy::LowerBounding)
+                probe_for_solution = ! probe_for_solution && search_result == SearchResult::RestartCutoffHit && objective_value == best;
+        }
+
+        return finish(SearchResult::Complete);
+    }
+
+    /**
+     * One thread's share of a parallel search. Propagators keep a pointer to
+     * the Stats they were built with, so a worker must not move once built.
+     */
+    struct SearchWorker
+    {
+        Stats stats;
+        State state;
+        Propagators propagators;
+        BranchCallback branch_callback;
+        shared_ptr<NogoodStore> nogood_store;
+
+        explicit SearchWorker(Problem & problem) :
+            state(problem.create_state_for_new_search(nullptr)),
+            propagators(problem.create_propagators(state, stats, nullptr))
+        {
+        }
+    };
+
+    /**
+     * Repeat solve_with()'s setup, without proof logging, for a thread other
+     * than the one that did it first. Presolvers and the branch heuristic are
+     * shared with the calling thread, so this must not run concurrently with
+     * anything else. Returns nullptr if setup alone shows there is no solution.
+     */
+    auto set_up_worker(Problem & problem, const BranchHeuristic & branch_heuristic, bool learn_nogoods, const SolveCallbacks & callbacks)
+        -> unique_ptr<SearchWorker>
+    {
+        auto worker = make_unique<SearchWorker>(problem);
+        if (trail_domains(callbacks))
+            worker->state.set_backtracking_mode(BacktrackingMode::Trail);
+        if (callbacks.propagation_profile)
+            worker->propagators.enable_profiling();
+        worker->propagators.order_propagation_by_cost(callbacks.order_propagation_by_cost);
+        if (learn_nogoods)
+            worker->nogood_store = install_learned_nogoods(problem, worker->propagators, worker->state, nullptr);
+        if (! worker->propagators.initialise(worker->state, nullptr))
+            return nullptr;
+        for (auto & presolver : problem.each_presolver())
+            if (! presolver.run(problem, worker->propagators, worker->state, nullptr) || ! worker->propagators.initialise(worker->state, nullptr))
+                return nullptr;
+        worker->branch_callback = branch_heuristic(problem, worker->state, worker->propagators);
+        return worker;
+    }
+
+    /**
+     * Add what a worker counted to the calling thread's stats.
+     */
+    auto add_worker_stats(Stats & stats, SearchWorker & worker, PropagationProfile * const optional_profile) -> void
+    {
+        worker.propagators.fill_in_constraint_stats(worker.stats);
+        if (optional_profile)
+            worker.propagators.fill_in_propagation_profile(*optional_profile);
+        stats += worker.stats;
+    }
+
+    /**
+     * Run body(0) to body(how_many - 1) on a thread each, while the calling
+     * thread waits and passes on the caller's abort flag. Threads poll only
+     * shared.stop. The first exception thrown by any body stops every thread,
+     * and is rethrown here once they have all finished.
+     */
+    auto run_on_threads(std::size_t how_many, const function<auto(std::size_t)->void> & body, SharedSearch & shared,
+        atomic<bool> * optional_abort_flag) -> void
+    {
+        auto still_running = how_many;
+        mutex still_running_mutex;
+        condition_variable still_running_cv;
+        exception_ptr failure;
+        mutex failure_mutex;
+
+        vector<thread> threads;
+        for (std::size_t i = 0; i < how_many; ++i)
+            threads.emplace_back([&, i]() {
+                try {
+                    body(i);
                 }
-                learned_nogoods->add(move(nogood));
+                catch (...) {
+                    auto lock = unique_lock{failure_mutex};
+                    if (! failure)
+                        failure = current_exception();
+                    shared.stop.store(true);
+                }
+                auto lock = unique_lock{still_running_mutex};
+                --still_running;
+                still_running_cv.notify_all();
+            });
+
+        {
+            auto lock = unique_lock{still_running_mutex};
+            while (still_running != 0) {
+                if (optional_abort_flag && optional_abort_flag->load())
+                    shared.stop.store(true);
+                still_running_cv.wait_for(lock, milliseconds(10));
             }
         }
+        for (auto & t : threads)
+            t.join();
+
+        if (failure)
+            rethrow_exception(failure);
+    }
+
+    /**
+     * Split the tree into subproblems for parallel search: depth-first to
+     * depth_limit, recording the branching decisions that lead to each node
+     * still open there. A node whose domains are already fixed is recorded
+     * too, so that a solution above the limit is found by whichever thread
+     * takes it, just like any other. Subproblems come out in the order a
+     * sequential search would reach them.
+     */
+    auto split_into_subproblems(unsigned long long depth, unsigned long long depth_limit, Propagators & propagators, State & state,
+        const BranchCallback & branch_callback, const optional<Literal> & this_branch_guess, vector<IntegerVariableCondition> & decisions,
+        vector<vector<IntegerVariableCondition>> & subproblems, bool & hit_depth_limit, atomic<bool> * optional_abort_flag) -> void
+    {
+        Literals guesses;
+        if (this_branch_guess)
+            guesses.push_back(*this_branch_guess);
+        if (! propagators.propagate(guesses, state, nullptr, optional_abort_flag))
+            return;
+
+        if (depth == depth_limit) {
+            hit_depth_limit = true;
+            subproblems.push_back(decisions);
+            return;
+        }
 
-        if (logger) {
-            logger->enter_proof_level(depth);
-            if (result == SearchResult::RestartCutoffHit) {
-                // We must NOT delete the root node's own guess-independent
-                // propagation (proof level 1): the next pass starts from the same
-                // root fixpoint, so propagate() re-emits nothing there, and that
-                // reasoning has to survive for the next pass's backtracks to remain
-                // RUP. So at the root (depth 0) we keep level 1; deeper
-                // guess-dependent levels are re-derived next pass.
-                if (depth > 0)
-                    logger->forget_proof_level(depth + 1);
+        auto current_state = state.current();
+        auto branch_generator = branch_callback(current_state, propagators);
+        auto branch_iter = branch_generator.begin();
+        if (branch_iter == branch_generator.end()) {
+            subproblems.push_back(decisions);
+            return;
+        }
+
+        for (; branch_iter != branch_generator.end(); ++branch_iter) {
+            auto guess = *branch_iter;
+            auto timestamp = state.new_epoch();
+            state.guess(guess);
+            decisions.push_back(guess);
+            split_into_subproblems(depth + 1, depth_limit, propagators, state, branch_callback, guess, decisions, subproblems, hit_depth_limit,
+                optional_abort_flag);
+            decisions.pop_back();
+            state.backtrack(timestamp);
+        }
+    }
+
+    /**
+     * Search one subproblem on a worker whose root is already propagated:
+     * replay its decisions, propagating after each as search would have, then
+     * search what is left from there.
+     */
+    auto solve_subproblem(SearchWorker & worker, Problem & problem, SolveCallbacks & callbacks, const vector<IntegerVariableCondition> & decisions,
+        SharedSearch & shared, optional<Integer> & objective_value) -> SearchResult
+    {
+        // Each decision gets an epoch of its own, just as it would have had
+        // in search, because propagate() leaves things for backtrack() to
+        // undo on the assumption that it runs once per epoch. The last
+        // decision is left for the search below to propagate, as the guess
+        // that led to its root.
+        auto timestamp = worker.state.new_epoch();
+        bool consistent = true;
+        optional<Literal> last_decision;
+        for (std::size_t d = 0; d < decisions.size(); ++d) {
+            if (worker.state.test_literal(decisions[d]) == LiteralIs::DefinitelyFalse) {
+                consistent = false;
+                break;
             }
-            else {
-                // A normal backtrack: the subtree under these guesses was refuted,
-                // so we may assert the negation of the guess set (RUP from the
-                // refutation that the forget below then discards).
-                vector<Literal> guesses;
-                for (const auto & g : state.guesses())
-                    guesses.push_back(g);
-                logger->backtrack(guesses);
-                logger->forget_proof_level(depth + 1);
+            if (d != 0)
+                static_cast<void>(worker.state.new_epoch());
+            worker.state.guess(decisions[d]);
+            if (d + 1 == decisions.size())
+                last_decision = decisions[d];
+            else if (! worker.propagators.propagate(Literals{decisions[d]}, worker.state, nullptr, &shared.stop)) {
+                consistent = false;
+                break;
             }
         }
 
+        auto result = SearchResult::Complete;
+        if (consistent) {
+            bool contains_solution = false;
+            Integer number_of_solutions = 0_i;
+            RestartState no_restarts{.conflicts_since_restart = 0, .cutoff = numeric_limits<unsigned long long>::max(), .enabled = false};
+            result = solve_with_state(decisions.size(), worker.stats, problem, worker.propagators, worker.state, last_decision, callbacks,
+                worker.branch_callback, nullptr, contains_solution, number_of_solutions, objective_value, no_restarts, nullptr,
+                vector<IntegerVariableCondition>{}, &shared, &shared.stop);
+        }
+        worker.state.backtrack(timestamp);
+        worker.stats.search_arena_allocations = worker.state.search_arena().allocations();
+        worker.stats.search_arena_heap_allocations = worker.state.search_arena().heap_allocations();
         return result;
     }
+
+    /**
+     * The parallel counterpart of solve_with()'s restart loop. The calling
+     * thread's State and Propagators, already set up, split the tree into
+     * subproblems; then one worker per thread takes subproblems from the
+     * shared list in order, while the calling thread waits and passes on the
+     * caller's abort flag. Every worker's counters are summed into stats.
+     */
+    auto solve_in_parallel(Problem & problem, SolveCallbacks & callbacks, const ParallelSearch & options, const BranchHeuristic & branch_heuristic,
+        Stats & stats, State & state, Propagators & propagators, const BranchCallback & branch_callback, bool & contains_solution,
+        optional<Integer> & objective_value, atomic<bool> * optional_abort_flag) -> SearchResult
+    {
+        auto how_many_threads = options.threads != 0 ? options.threads : max(1u, thread::hardware_concurrency());
+        auto target = static_cast<std::size_t>(how_many_threads) * max(1u, options.subproblems_per_thread);
+
+        // Deepen the split until there are enough subproblems to go round, or
+        // until the whole tree is shallower than the limit. Root propagation
+        // happens on the first pass, and stays put.
+        vector<vector<IntegerVariableCondition>> subproblems;
+        for (unsigned long long depth_limit = 1;; ++depth_limit) {
+            subproblems.clear();
+            bool hit_depth_limit = false;
+            vector<IntegerVariableCondition> decisions;
+            split_into_subproblems(
+                0, depth_limit, propagators, state, branch_callback, nullopt, decisions, subproblems, hit_depth_limit, optional_abort_flag);
+            if (optional_abort_flag && optional_abort_flag->load())
+                return SearchResult::Stop;
+            if (subproblems.size() >= target || ! hit_depth_limit)
+                break;
+        }
+
+        if (subproblems.empty())
+            return SearchResult::Complete;
+
+        // Setup is repeated in full for every thread, so a thread that would
+        // only sit idle is not worth building.
+        how_many_threads = static_cast<unsigned>(std::min<std::size_t>(how_many_threads, subproblems.size()));
+        vector<unique_ptr<SearchWorker>> workers;
+        for (unsigned i = 0; i < how_many_threads; ++i)
+            if (auto worker = set_up_worker(problem, branch_heuristic, false, callbacks))
+                workers.push_back(move(worker));
+            else
+                return SearchResult::Complete;
+
+        SharedSearch shared;
+        atomic<std::size_t> next_subproblem{0};
+        vector<char> found_solution(workers.size(), false);
+
+        run_on_threads(
+            workers.size(),
+            [&](std::size_t w) {
+                auto & worker = *workers[w];
+                optional<Integer> worker_objective_value;
+                if (worker.propagators.propagate(Literals{}, worker.state, nullptr, &shared.stop)) {
+                    while (! shared.stop.load()) {
+                        auto i = next_subproblem.fetch_add(1);
+                        if (i >= subproblems.size())
+                            break;
+                        auto solutions_before = worker.stats.solutions;
+                        if (SearchResult::Stop == solve_subproblem(worker, problem, callbacks, subproblems[i], shared, worker_objective_value))
+                            shared.stop.store(true);
+                        if (worker.stats.solutions != solutions_before)
+                            found_solution[w] = true;
+                    }
+                }
+            },
+            shared, optional_abort_flag);
+
+        for (std::size_t w = 0; w < workers.size(); ++w) {
+            add_worker_stats(stats, *workers[w], callbacks.propagation_profile.get());
+            if (found_solution[w])
+                contains_solution = true;
+        }
+
+        shared.tighten(objective_value);
+        return shared.stop.load() ? SearchResult::Stop : SearchResult::Complete;
+    }
+
+    /**
+     * The heuristic a portfolio thread gets when ParallelSearch::portfolio_branch
+     * is unset: dom/wdeg, with the weighting scheme and the value order's seed
+     * differing from thread to thread.
+     */
+    auto default_portfolio_branch(const Problem & problem, unsigned thread, std::uint_fast32_t seed) -> BranchHeuristic
+    {
+        constexpr WeightingScheme schemes[] = {
+            WeightingScheme::ConflictHistorySearch, WeightingScheme::Classic, WeightingScheme::CurrentArityCurrentDomain};
+        return branch_with(variable_order::dom_wdeg(problem, schemes[thread % std::size(schemes)]), value_order::random(seed + thread));
+    }
+
+    /**
+     * The weightings a thread's heuristics have attached as conflict observers,
+     * in the order they were attached.
+     */
+    auto weightings_of(const Propagators & propagators) -> vector<VariableWeighting *>
+    {
+        vector<VariableWeighting *> result;
+        for (auto & observer : propagators.conflict_observers())
+            if (auto weighting = dynamic_cast<VariableWeighting *>(observer))
+                result.push_back(weighting);
+        return result;
+    }
+
+    /**
+     * The restart-based counterpart of solve_in_parallel(): every thread
+     * searches the whole problem from the root with its own restart loop, and
+     * the first to finish stops the rest. The calling thread's own State and
+     * Propagators, already set up, are thread 0's; the rest get a
+     * SearchWorker each. At each restart boundary a thread swaps its weights
+     * with the others', under a lock, by way of WeightingState snapshots, so
+     * weightings are matched up between threads by the order in which they
+     * were attached. It also publishes the nogoods it learned in the pass just
+     * ended, and imports those the others have published, which needs no lock.
+     *
+     * An imported nogood is sound for the importing thread because every
+     * thread searches the same problem: a nogood refutes a region with no
+     * solution, or with none better than the shared incumbent at the time,
+     * and the bound every thread prunes against only ever tightens to match.
+     */
+    auto solve_in_portfolio(Problem & problem, SolveCallbacks & callbacks, const ParallelSearch & options, Stats & stats, State & state,
+        Propagators & propagators, const BranchCallback & branch_callback, NogoodStore * const nogood_store, bool & contains_solution,
+        optional<Integer> & objective_value, atomic<bool> * optional_abort_flag) -> SearchResult
+    {
+        auto how_many_threads = options.threads != 0 ? options.threads : max(1u, thread::hardware_concurrency());
+
+        vector<unique_ptr<SearchWorker>> workers;
+        for (unsigned i = 1; i < how_many_threads; ++i) {
+            auto heuristic = options.portfolio_branch ? options.portfolio_branch(i) : default_portfolio_branch(problem, i, options.portfolio_seed);
+            if (auto worker = set_up_worker(problem, heuristic, true, callbacks))
+                workers.push_back(move(worker));
+            else
+                return SearchResult::Complete;
+        }
+
+        // Every thread searches everything, so a satisfaction problem's
+        // solutions would be reported again by each thread that found them.
+        // Instead, the first thread to find a solution becomes the only one
+        // that reports any. It still finds every solution itself: its own
+        // nogoods only rule out subtrees it has finished with, and a thread
+        // publishes nogoods only while it has found no solution, so none that
+        // it imports rules a solution out. So enumeration is complete once the
+        // reporting thread finishes, or once any thread finishes if none has
+        // found a solution. Both of these are guarded by the callback lock.
+        bool satisfaction = ! problem.optional_minimise_variable();
+        optional<std::size_t> reporting_thread;
+        unsigned long long reported_solutions = 0;
+
+        SharedSearch shared;
+        atomic<bool> any_completed{false};
+        vector<char> found_solution(workers.size() + 1, false);
+
+        mutex exchange_mutex;
+        vector<vector<WeightingState>> latest_weights(workers.size() + 1);
+        auto exchange_weights = [&](std::size_t t, Propagators & thread_propagators) {
+            auto weightings = weightings_of(thread_propagators);
+            auto lock = unique_lock{exchange_mutex};
+            latest_weights[t].clear();
+            for (auto & weighting : weightings)
+                latest_weights[t].push_back(weighting->snapshot(thread_propagators));
+            for (std::size_t k = 0; k < weightings.size(); ++k) {
+                auto merged = latest_weights[t][k];
+                for (std::size_t other = 0; other < latest_weights.size(); ++other)
+                    if (other != t && k < latest_weights[other].size())
+                        merged.merge(latest_weights[other][k], options.portfolio_merge);
+                weightings[k]->load(merged, thread_propagators);
+            }
+        };
+
+        NogoodExchange nogood_exchange{options.shared_nogood_capacity, options.max_shared_nogood_length};
+
+        run_on_threads(
+            workers.size() + 1,
+            [&](std::size_t t) {
+                auto & thread_stats = t == 0 ? stats : workers[t - 1]->stats;
+                auto & thread_state = t == 0 ? state : workers[t - 1]->state;
+                auto & thread_propagators = t == 0 ? propagators : workers[t - 1]->propagators;
+                auto & thread_branch_callback = t == 0 ? branch_callback : workers[t - 1]->branch_callback;
+                auto thread_nogood_store = t == 0 ? nogood_store : workers[t - 1]->nogood_store.get();
+
+                // The store holds this thread's own nogoods and imported ones,
+                // interleaved, and a reduction may have moved them, but those it
+                // learned in the pass just ended are always the last ones in it,
+                // untouched by the reduction.
+                std::size_t import_cursor = 0;
+                auto published_up_to = thread_stats.learned_nogoods;
+                bool thread_contains_solution = false;
+                Integer number_of_solutions = 0_i;
+                auto exchange_nogoods = [&]() {
+                    auto fresh = thread_stats.learned_nogoods - published_up_to;
+                    if ((! satisfaction) || 0_i == number_of_solutions)
+                        for (auto n = thread_nogood_store->size() - fresh; n < thread_nogood_store->size(); ++n)
+                            nogood_exchange.publish(t, thread_nogood_store->nogood(n));
+                    thread_stats.imported_nogoods += nogood_exchange.import_into(t, import_cursor, *thread_nogood_store);
+                    published_up_to = thread_stats.learned_nogoods;
+                };
+
+                auto thread_callbacks = callbacks;
+                if (satisfaction)
+                    thread_callbacks.solution = [&](const CurrentState & s) -> bool {
+                        if (! reporting_thread)
+                            reporting_thread = t;
+                        if (*reporting_thread != t)
+                            return true;
+                        ++reported_solutions;
+                        return ! callbacks.solution || callbacks.solution(s);
+                    };
+
+                // The first propagation must be given no guesses, but by the
+                // time this thread's root is reached, another thread's
+                // incumbent may already have given it one, so the root is
+                // propagated here first, as a parallel worker's is.
+                optional<Integer> thread_objective_value;
+                auto result = SearchResult::Stop;
+                if (thread_propagators.propagate(Literals{}, thread_state, nullptr, &shared.stop))
+                    result = search_from_root(thread_stats, problem, thread_propagators, thread_state, thread_callbacks, thread_branch_callback,
+                        nullptr, thread_contains_solution, number_of_solutions, thread_objective_value, callbacks.restarts, thread_nogood_store,
+                        &shared,
+                        [&]() {
+                            exchange_weights(t, thread_propagators);
+                            exchange_nogoods();
+                        },
+                        &shared.stop);
+                else if (! shared.stop.load())
+                    result = SearchResult::Complete;
+
+                found_solution[t] = thread_contains_solution;
+                if (result == SearchResult::Complete) {
+                    // Another thread may still have solutions left to report.
+                    auto lock = unique_lock{shared.callback_mutex};
+                    if (satisfaction && reporting_thread && *reporting_thread != t)
+                        return;
+                    any_completed.store(true);
+                }
+                shared.stop.store(true);
+            },
+            shared, optional_abort_flag);
+
+        for (auto & worker : workers)
+            add_worker_stats(stats, *worker, callbacks.propagation_profile.get());
+        for (auto f : found_solution)
+            if (f)
+                contains_solution = true;
+
+        // Otherwise a solution found by several threads would count several times.
+        if (satisfaction)
+            stats.solutions = reported_solutions;
+
+        shared.tighten(objective_value);
+        return any_completed.load() ? SearchResult::Complete : SearchResult::Stop;
+    }
 }
 
 auto gcs::solve_with(
     Problem & problem, SolveCallbacks callbacks, const optional<ProofOptions> & optional_proof_options, atomic<bool> * optional_abort_flag) -> Stats
 {
+    if (callbacks.parallel) {
+        if (optional_proof_options)
+            throw UnimplementedException{"parallel search does not support proof logging"};
+    }
+
+    if (callbacks.objective_search) {
+        if (callbacks.parallel)
+            throw UnimplementedException{"objective search cannot be combined with parallel search"};
+        if (callbacks.lns)
+            throw UnimplementedException{"objective search cannot be combined with large neighbourhood search"};
+        if (! problem.optional_minimise_variable())
+            throw UnimplementedException{"objective search is only implemented for minimisation problems"};
+        if (! (callbacks.objective_search->conflict_limit_growth > 1.0))
+            throw UnexpectedException{"objective search needs a conflict limit growth of more than one"};
+    }
+
+    if (callbacks.lns) {
+        if (optional_proof_options)
+            throw UnimplementedException{"large neighbourhood search does not support proof logging"};
+        if (callbacks.parallel)
+            throw UnimplementedException{"large neighbourhood search cannot be combined with parallel search"};
+        if (! problem.optional_minimise_variable())
+            throw UnimplementedException{"large neighbourhood search is only implemented for minimisation problems"};
+    }
+
     Stats stats;
 
     // Before anything can report: a presolver's decision is said as it is made,
@@ -297,6 +1343,9 @@ auto gcs::solve_with(
 
     auto state = problem.create_state_for_new_search(optional_proof ? optional_proof->model() : nullptr);
 
+    if (trail_domains(callbacks))
+        state.set_backtracking_mode(BacktrackingMode::Trail);
+
     if (optional_proof) {
         if (problem.optional_minimise_variable())
             optional_proof->model()->minimise(*problem.optional_minimise_variable());
@@ -311,27 +1360,32 @@ auto gcs::solve_with(
 
     auto propagators = problem.create_propagators(state, stats, optional_proof ? optional_proof->model() : nullptr);
 
+    // Setting GCS_PROPAGATION_PROFILE to a file name profiles propagation even
+    // for a caller that did not ask for it, and writes the profile there. Like
+    // every other environment variable, it is read once, on first use.
+    static const auto profile_file_name = []() -> optional<string> {
+        if (const char * e = std::getenv("GCS_PROPAGATION_PROFILE"))
+            return string{e};
+        return nullopt;
+    }();
+    if (profile_file_name && ! callbacks.propagation_profile)
+        callbacks.propagation_profile = make_shared<PropagationProfile>();
+    if (callbacks.propagation_profile) {
+        callbacks.propagation_profile->by_constraint.clear();
+        propagators.enable_profiling();
+    }
+
+    propagators.order_propagation_by_cost(callbacks.order_propagation_by_cost);
+
     // With restarts on, search learns nogoods from refuted regions. Install an
-    // (initially empty) Nogoods over a store the restart loop grows, subscribed
-    // to every variable since a later-learned nogood may mention any. This is
+    // (initially empty) Nogoods over a store the restart loop grows. This is
     // engine-owned, not user-posted --- restart nogoods are internal (and, under
     // parallel search, per-thread). Must follow create_propagators (it installs
     // into them) and precede the model finalise below; any model definitions it
     // adds land after the preamble, like every other constraint's.
     shared_ptr<NogoodStore> nogood_store;
-    if (callbacks.restarts) {
-        nogood_store = make_shared<NogoodStore>();
-        // Use refined per-literal watches for the learned-nogood store (issue #335,
-        // stage C-2): the propagator wakes only when a learned clause loses a
-        // non-entailed literal and visits only the clauses that fired, rather than
-        // the coarse wake-on-every-variable-and-scan-the-whole-store path that was
-        // the ~13.1M-wasted-propagation cost. Setting GCS_LEARNED_NOGOODS_SCAN picks
-        // the legacy scan path, for the scan-vs-refined differential and perf check.
-        bool refined_nogoods = (std::getenv("GCS_LEARNED_NOGOODS_SCAN") == nullptr);
-        auto nogoods_constraint = Nogoods{nogood_store, problem.all_normal_variables(), refined_nogoods};
-        nogoods_constraint.set_constraint_id(NamedConstraint{"learned_nogoods"});
-        std::move(nogoods_constraint).install(propagators, state, optional_proof ? optional_proof->model() : nullptr);
-    }
+    if (callbacks.restarts)
+        nogood_store = install_learned_nogoods(problem, propagators, state, optional_proof ? optional_proof->model() : nullptr);
 
     if (optional_proof) {
         optional_proof->model()->finalise();
@@ -371,8 +1425,9 @@ auto gcs::solve_with(
         }
     }
 
+    // Objective search raises this as it proves better bounds.
     Integer objective_lower_bound_for_proof = 0_i;
-    if (optional_proof && problem.optional_minimise_variable())
+    if (problem.optional_minimise_variable())
         objective_lower_bound_for_proof = state.lower_bound(*problem.optional_minimise_variable());
 
     if (initialisation_success && presolve_success) {
@@ -388,33 +1443,24 @@ auto gcs::solve_with(
             callbacks.branch ? callbacks.branch : branch_with(variable_order::dom_then_deg(problem), value_order::smallest_first());
         auto branch_callback = branch_heuristic(problem, state, propagators);
 
-        // A restart loop around the depth-first search: each pass explores until
-        // it has spent its conflict cutoff, then unwinds to the root (proof
-        // balanced) and the schedule grows the cutoff for the next pass. Weights
-        // and the incumbent objective bound persist across passes, so a later pass
-        // searches differently; the growing Luby cutoff eventually exceeds the
-        // whole tree, so a final pass completes. Without a schedule the cutoff is
-        // infinite and this is a single, exhaustive pass.
-        auto restart_schedule = callbacks.restarts;
-        RestartState restart{.conflicts_since_restart = 0,
-            .cutoff = restart_schedule ? restart_schedule->current_cutoff() : numeric_limits<unsigned long long>::max(),
-            .enabled = restart_schedule.has_value()};
-
         SearchResult search_result;
-        do {
-            restart.conflicts_since_restart = 0;
-            search_result = solve_with_state(0, stats, problem, propagators, state, nullopt, callbacks, branch_callback,
-                optional_proof ? optional_proof->logger() : nullptr, child_contains_solution, number_of_solutions, objective_value, restart,
-                nogood_store.get(), vector<IntegerVariableCondition>{}, optional_abort_flag);
-
-            if (search_result == SearchResult::RestartCutoffHit) {
-                ++stats.restarts;
-                for (auto & observer : propagators.conflict_observers())
-                    observer->on_restart();
-                restart_schedule->advance();
-                restart.cutoff = restart_schedule->current_cutoff();
-            }
-        } while (search_result == SearchResult::RestartCutoffHit);
+        if (callbacks.objective_search)
+            search_result = search_with_objective_probes(stats, problem, propagators, state, callbacks, branch_callback,
+                optional_proof ? optional_proof->logger() : nullptr, child_contains_solution, number_of_solutions, objective_value,
+                objective_lower_bound_for_proof, nogood_store.get(), optional_abort_flag);
+        else if (callbacks.lns)
+            search_result = search_with_lns(stats, problem, propagators, state, callbacks, branch_callback, child_contains_solution,
+                number_of_solutions, objective_value, nogood_store.get(), optional_abort_flag);
+        else if (callbacks.parallel && callbacks.restarts)
+            search_result = solve_in_portfolio(problem, callbacks, *callbacks.parallel, stats, state, propagators, branch_callback, nogood_store.get(),
+                child_contains_solution, objective_value, optional_abort_flag);
+        else if (callbacks.parallel)
+            search_result = solve_in_parallel(problem, callbacks, *callbacks.parallel, branch_heuristic, stats, state, propagators, branch_callback,
+                child_contains_solution, objective_value, optional_abort_flag);
+        else
+            search_result = search_from_root(stats, problem, propagators, state, callbacks, branch_callback,
+                optional_proof ? optional_proof->logger() : nullptr, child_contains_solution, number_of_solutions, objective_value, callbacks.restarts,
+                nogood_store.get(), nullptr, {}, optional_abort_flag);
 
         if (search_result == SearchResult::Complete) {
             if (optional_proof) {
@@ -463,8 +1509,20 @@ auto gcs::solve_with(
 
     stats.solve_time = duration_cast<microseconds>(steady_clock::now() - start_time);
     propagators.fill_in_constraint_stats(stats);
-    if (nogood_store)
-        stats.learned_nogoods = nogood_store->size();
+
+    if (callbacks.propagation_profile) {
+        propagators.fill_in_propagation_profile(*callbacks.propagation_profile);
+        stats.add_component(callbacks.propagation_profile);
+        if (profile_file_name) {
+            ofstream profile_file{*profile_file_name};
+            if (profile_file_name->ends_with(".csv"))
+                callbacks.propagation_profile->write_csv(profile_file);
+            else
+                callbacks.propagation_profile->write_json(profile_file);
+            if (! profile_file)
+                stats.report(StatsNote{StatsLevel::Important, "propagation_profile", nullopt, "could not write " + *profile_file_name});
+        }
+    }
 
     // The search is over, so a caller holding the result should not be holding
     // a live callback into it: the notes are all accumulated, and reporting a
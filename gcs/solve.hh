@@ -3,16 +3,22 @@
 
 #include <gcs/current_state.hh>
 #include <gcs/innards/state-fwd.hh>
+#include <gcs/large_neighbourhood_search.hh>
 #include <gcs/problem.hh>
+#include <gcs/propagation_profile.hh>
 #include <gcs/proof.hh>
 #include <gcs/restarts.hh>
 #include <gcs/stats.hh>
 #include <gcs/variable_condition.hh>
+#include <gcs/variable_weighting.hh>
 
 #include <optional>
 
 #include <atomic>
+#include <cstddef>
+#include <cstdint>
 #include <functional>
+#include <memory>
 #include <version>
 
 #ifdef __cpp_lib_generator
@@ -97,6 +103,185 @@ namespace gcs
      */
     using CompletedCallback = std::function<auto()->void>;
 
+    /**
+     * \brief Called by gcs::solve_with() with each new lower bound on the
+     * objective, as soon as it is proved, when using gcs::ObjectiveSearch.
+     *
+     * \ingroup SolveCallbacks
+     */
+    using ObjectiveBoundCallback = std::function<auto(Integer)->void>;
+
+    /**
+     * \brief Asks gcs::solve_with() to search on several threads.
+     *
+     * Each thread has its own State and Propagators, built by repeating the
+     * normal setup (cloning the initial state, installing every constraint, and
+     * running the presolvers). When minimising, the best objective value found
+     * so far is shared, so every thread prunes against it. How the threads
+     * divide the work depends upon whether SolveCallbacks::restarts is set.
+     *
+     * Without restarts, the search tree is split into many subproblems, each a
+     * short sequence of branching decisions from the root, found by a shallow
+     * depth-first pass. Threads take subproblems from a shared queue, in the
+     * order a sequential search would reach them, and search each to
+     * completion.
+     *
+     * With restarts, the threads instead run a portfolio: every thread searches
+     * the whole problem, with its own restart schedule, its own learned
+     * nogoods, and its own branching heuristic, and the first to finish has
+     * proved optimality (or unsatisfiability) for all of them, so the rest are
+     * stopped. The first thread uses SolveCallbacks::branch, and thread \c i
+     * after it uses \ref portfolio_branch. At every restart boundary a thread
+     * publishes a snapshot of each of its dom/wdeg-style weightings (each
+     * VariableWeighting attached as a conflict observer), and loads the merge
+     * of its own with the latest from every other thread. It also shares the
+     * short nogoods it learned in the pass just ended (see
+     * \ref max_shared_nogood_length), and takes in those the other threads
+     * have shared, as if it had learned them itself.
+     *
+     * \warning The solution and trace callbacks are called under a lock, from
+     * whichever thread found the solution, so they need not be thread safe
+     * themselves. The BranchCallback that SolveCallbacks::branch returns is
+     * built once per thread, but anything that heuristic shares between the
+     * callbacks it builds is used concurrently. The randomised heuristics in
+     * gcs::variable_order and gcs::value_order share their random number
+     * generator, so they are not safe here. (In a portfolio only the first
+     * thread uses SolveCallbacks::branch, so there they are.) Proof logging is
+     * not supported, and solutions to a satisfaction problem arrive in no
+     * particular order. Since every thread of a portfolio searches everything,
+     * a portfolio reports a satisfaction problem's solutions only from the
+     * first thread to find one, so that none is reported twice.
+     *
+     * \ingroup SolveCallbacks
+     */
+    struct ParallelSearch final
+    {
+        /**
+         * \brief How many search threads to use, with 0 meaning one per
+         * hardware thread.
+         */
+        unsigned threads = 0;
+
+        /**
+         * \brief Aim for roughly this many subproblems per thread, so that a
+         * thread that gets an easy subproblem can take another.
+         */
+        unsigned subproblems_per_thread = 30;
+
+        /**
+         * \brief In a portfolio, the heuristic for thread \c i, for \c i from 1.
+         *
+         * Unset gives each thread dom/wdeg, cycling through the weighting
+         * schemes, with values in a random order seeded by \ref portfolio_seed
+         * plus the thread number.
+         */
+        std::function<auto(unsigned)->BranchHeuristic> portfolio_branch = {};
+
+        /**
+         * \brief In a portfolio, how a thread combines its weights with the
+         * other threads'.
+         *
+         * \warning Max and Average settle down as threads exchange repeatedly,
+         * but Sum adds every other thread's weights in again at each exchange.
+         */
+        WeightingState::MergePolicy portfolio_merge = WeightingState::MergePolicy::Max;
+
+        /**
+         * \brief In a portfolio, the seed for the default \ref portfolio_branch.
+         */
+        std::uint_fast32_t portfolio_seed = 0;
+
+        /**
+         * \brief In a portfolio, the longest learned nogood that a thread
+         * shares with the others, with 0 meaning share none.
+         *
+         * A short nogood prunes a large region, and is cheap to watch; sharing
+         * long ones mostly gives every thread more clauses to wake.
+         */
+        std::size_t max_shared_nogood_length = 8;
+
+        /**
+         * \brief In a portfolio, how many nogoods may be shared in total, after
+         * which the threads stop sharing them.
+         */
+        std::size_t shared_nogood_capacity = 1 << 16;
+    };
+
+    /**
+     * \brief How gcs::ObjectiveSearch chooses the bounds it probes.
+     *
+     * \ingroup SolveCallbacks
+     */
+    enum class ObjectiveStrategy
+    {
+        /// Probe halfway between the best bound proved so far and the best
+        /// solution so far, so that either outcome halves the gap.
+        Dichotomic,
+
+        /// Probe the best bound proved so far, to raise it one step at a time,
+        /// and, whenever a probe is cut off, spend as long again looking for
+        /// a better solution.
+        LowerBounding
+    };
+
+    /**
+     * \brief Asks gcs::solve_with() to minimise by probing bounds on the
+     * objective, rather than by tightening it one solution at a time.
+     *
+     * Search first looks for a solution in the usual way, using
+     * SolveCallbacks::restarts if it is set, and stops that search at the
+     * first solution it finds. From then on, each probe picks a value \c mid
+     * below the best solution so far, as \ref strategy says, and searches
+     * with the objective at most \c mid, and bounded by the best solution so
+     * far as usual, until it finds a solution or has seen as many conflicts
+     * as the limit allows. A probe that finds a solution is stopped there, so
+     * that the next probe can bisect again. A probe that searches everything
+     * proves that no better solution is at most \c mid, and so raises the
+     * lower bound on the objective to \c mid plus one. A probe that is cut
+     * off proves nothing, and the limit then grows by \ref
+     * conflict_limit_growth. A probe whose \c mid is one less than the best
+     * solution so far is no different from branch and bound, and is never
+     * cut off, so search always ends.
+     *
+     * Each probe is searched as a child of the root, so with proof logging,
+     * the negation of a refuted probe stays in the proof, and if search is
+     * stopped early, the proof concludes with the best lower bound proved so
+     * far rather than with the bound at the root. Each new lower bound is
+     * written to the proof as soon as it is proved, and is also given to
+     * SolveCallbacks::objective_bound and reported as a StatsLevel::Detailed
+     * note.
+     *
+     * Only minimisation problems are supported, and neither
+     * SolveCallbacks::parallel nor SolveCallbacks::lns may be used with it.
+     * Nogoods are learned only by the first search, because they would not
+     * hold without the bound that a probe assumed.
+     *
+     * \ingroup SolveCallbacks
+     */
+    struct ObjectiveSearch final
+    {
+        /**
+         * \brief Which bounds to probe.
+         */
+        ObjectiveStrategy strategy = ObjectiveStrategy::Dichotomic;
+
+        /**
+         * \brief How many conflicts the first probe may see.
+         */
+        unsigned long long conflict_limit = 1000;
+
+        /**
+         * \brief What the limit is multiplied by after each probe that is cut
+         * off without finding a solution.
+         *
+         * A lower-bounding search only ends once a probe at the lower bound
+         * is given enough conflicts to search everything, so this must be
+         * more than one, and gcs::solve_with() throws UnexpectedException if
+         * it is not.
+         */
+        double conflict_limit_growth = 2.0;
+    };
+
     /**
      * \brief Callbacks for gcs::solve_with().
      *
@@ -112,6 +297,7 @@ namespace gcs
         BranchHeuristic branch = BranchHeuristic{};
         AfterProofStartedCallback after_proof_started = AfterProofStartedCallback{};
         CompletedCallback completed = CompletedCallback{};
+        ObjectiveBoundCallback objective_bound = ObjectiveBoundCallback{};
 
         /**
          * \brief Where a component's decisions go, as they are decided.
@@ -139,6 +325,74 @@ namespace gcs
          * gcs::RestartSchedule.
          */
         std::optional<RestartSchedule> restarts = std::nullopt;
+
+        /**
+         * \brief How the nogoods learned at restarts are kept in check.
+         *
+         * Default (unset) keeps every one for the rest of the search. Has no
+         * effect without \ref restarts.
+         * \sa gcs::NogoodReduction
+         */
+        std::optional<NogoodReduction> nogood_reduction = std::nullopt;
+
+        /**
+         * \brief If set, search on several threads.
+         *
+         * Default (unset) searches on the calling thread only.
+         * \sa gcs::ParallelSearch
+         */
+        std::optional<ParallelSearch> parallel = std::nullopt;
+
+        /**
+         * \brief If set, minimise by large neighbourhood search.
+         *
+         * Default (unset) minimises by branch and bound alone.
+         * \sa gcs::LargeNeighbourhoodSearch
+         */
+        std::optional<LargeNeighbourhoodSearch> lns = std::nullopt;
+
+        /**
+         * \brief If set, minimise by probing bounds on the objective.
+         *
+         * Default (unset) minimises by branch and bound, requiring each
+         * solution to be better than the last.
+         * \sa gcs::ObjectiveSearch
+         */
+        std::optional<ObjectiveSearch> objective_search = std::nullopt;
+
+        /**
+         * \brief If set, propagation is profiled, and the profile is written
+         * here when search finishes.
+         *
+         * Default (unset) does no profiling, unless the
+         * `GCS_PROPAGATION_PROFILE` environment variable asks for it.
+         * \sa gcs::PropagationProfile
+         */
+        std::shared_ptr<PropagationProfile> propagation_profile = nullptr;
+
+        /**
+         * \brief Whether propagation runs cheap propagators, such as binary
+         * comparisons, to a fixpoint before it runs expensive ones, such as
+         * edge finding, or runs every woken propagator first-in first-out.
+         *
+         * Default (true) orders by cost. Either way gives the same search
+         * tree, but not necessarily the same amount of work or the same proof.
+         * \sa gcs::innards::PropagatorCost
+         */
+        bool order_propagation_by_cost = true;
+
+        /**
+         * \brief Whether backtracking undoes a trail of the domains that
+         * changed, rather than throwing away a copy of every domain taken at
+         * every node.
+         *
+         * Search is identical either way; only the cost of a node differs,
+         * which trailing makes depend upon how many domains change rather than
+         * upon how many variables there are. Default (unset) copies, unless
+         * the `GCS_TRAILED_STATE` environment variable asks for trailing.
+         * \sa gcs::innards::BacktrackingMode
+         */
+        std::optional<bool> trail_domains = std::nullopt;
     };
 
     /**
@@ -17,7 +17,10 @@
 #include <gcs/solve.cc>
 
 #include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
 
+#include <algorithm>
+#include <cstdint>
 #include <cstdlib>
 #include <map>
 #include <memory>
@@ -26,6 +29,7 @@
 #include <sstream>
 #include <string>
 #include <tuple>
+#include <utility>
 #include <vector>
 
 using namespace gcs;
@@ -33,8 +37,10 @@ using namespace gcs::innards;
 using namespace gcs::test_innards;
 
 using std::function;
+using std::make_optional;
 using std::nullopt;
 using std::optional;
+using std::pair;
 using std::string;
 using std::vector;
 
@@ -316,6 +322,542 @@ TEST_CASE("Learned nogoods: refined matches scan under restarts")
     CHECK(refined.solutions == scan.solutions);
 }
 
+// Copying-vs-trailing differential for State's backtracking modes. Trailing
+// only changes how a domain is restored, so an all-solutions Langford search
+// (AllDifferent and Element prune interior values as well as bounds, and the
+// tree backtracks through every depth) must see the identical tree and the
+// identical solutions either way. The trailed run is also proof-logged and
+// verified, since a domain left unrestored would surface as a bogus inference.
+TEST_CASE("Trailed state matches copying state")
+{
+    const auto proof_name = "solve_test_trailed_state";
+
+    auto run = [&](bool trailed, bool prove) -> pair<Stats, vector<vector<Integer>>> {
+        Problem p;
+        const int k = 7;
+        vector<IntegerVariableID> position, solution;
+        for (int i = 0; i < 2 * k; ++i) {
+            position.emplace_back(p.create_integer_variable(0_i, Integer{2 * k - 1}));
+            solution.emplace_back(p.create_integer_variable(1_i, Integer{k}));
+        }
+        p.post(AllDifferent{position});
+        for (int i = 0; i < k; ++i) {
+            auto i_var = p.create_integer_variable(Integer{i + 1}, Integer{i + 1});
+            p.post(Element{i_var, position[i], &solution});
+            p.post(Element{i_var, position[i + k], &solution});
+            p.post(Equals{position[i + k], position[i] + Integer{i + 2}});
+        }
+
+        vector<vector<Integer>> solutions;
+        auto stats = solve_with(p,
+            SolveCallbacks{
+                .solution = [&](const CurrentState & s) -> bool {
+                    solutions.push_back(s(solution));
+                    return true;
+                },
+                .branch = branch_with(variable_order::dom(p), value_order::smallest_in()),
+                .trail_domains = trailed},
+            prove ? make_optional(ProofOptions{proof_name}) : nullopt);
+        return pair{stats, solutions};
+    };
+
+    auto [copying, copying_solutions] = run(false, false);
+    auto [trailed, trailed_solutions] = run(true, true);
+
+    CHECK(copying.solutions > 0);
+    CHECK(trailed.recursions == copying.recursions);
+    CHECK(trailed.failures == copying.failures);
+    CHECK(trailed.propagations == copying.propagations);
+    CHECK(trailed.solutions == copying.solutions);
+    CHECK(trailed_solutions == copying_solutions);
+    CHECK(verify_proof_and_dispose(proof_name));
+}
+
+// Search keeps its open nodes on an explicit stack rather than recursing, so
+// a chain of decisions far deeper than any thread's stack allows is fine.
+// Branching x != lb before x == lb walks one decision per value down to the
+// only solution.
+TEST_CASE("Search depth is not limited by the thread's stack")
+{
+    const int depth = 200'000;
+
+    Problem p;
+    auto x = p.create_integer_variable(0_i, Integer{depth});
+
+    optional<Integer> found;
+    auto stats = solve_with(p,
+        SolveCallbacks{
+            .solution = [&](const CurrentState & s) -> bool {
+                found = s(x);
+                return false;
+            },
+            .branch = branch_with(variable_order::in_order({x}), value_order::smallest_out())});
+
+    CHECK(found == Integer{depth});
+    CHECK(stats.max_depth == depth);
+    CHECK(stats.recursions == depth + 1);
+}
+
+namespace
+{
+    auto post_queens(Problem & p, int n) -> vector<IntegerVariableID>
+    {
+        vector<IntegerVariableID> queens;
+        for (int i = 0; i < n; ++i)
+            queens.push_back(p.create_integer_variable(0_i, Integer{n - 1}));
+        for (int i = 0; i < n; ++i)
+            for (int j = i + 1; j < n; ++j) {
+                p.post(NotEquals{queens[i], queens[j]});
+                p.post(NotEquals{queens[i] + Integer{j - i}, queens[j]});
+                p.post(NotEquals{queens[i] - Integer{j - i}, queens[j]});
+            }
+        return queens;
+    }
+}
+
+// Parallel search splits the tree into subproblems and hands them out to
+// threads, so it must find exactly the solutions a sequential search finds,
+// each once, in whatever order.
+TEST_CASE("Parallel search enumerates every solution exactly once")
+{
+    auto run = [](optional<ParallelSearch> parallel) -> pair<Stats, std::multiset<vector<Integer>>> {
+        Problem p;
+        auto queens = post_queens(p, 8);
+        std::multiset<vector<Integer>> solutions;
+        auto stats = solve_with(p, SolveCallbacks{.solution = [&](const CurrentState & s) -> bool {
+                                                      solutions.insert(s(queens));
+                                                      return true;
+                                                  },
+                                       .parallel = parallel});
+        return pair{stats, solutions};
+    };
+
+    auto [sequential, sequential_solutions] = run(nullopt);
+    auto [parallel, parallel_solutions] = run(ParallelSearch{.threads = 4});
+
+    CHECK(sequential.solutions == 92);
+    CHECK(parallel.solutions == 92);
+    CHECK(parallel_solutions == sequential_solutions);
+}
+
+TEST_CASE("Parallel search finds the optimum and shares the incumbent")
+{
+    Problem p;
+    auto queens = post_queens(p, 8);
+    auto cost = p.create_integer_variable(0_i, 1000_i);
+    WeightedSum sum;
+    for (int i = 0; i < 8; ++i)
+        sum += Integer{i + 1} * queens[i];
+    p.post(sum + -1_i * cost == 0_i);
+    p.minimise(cost);
+
+    auto solve_for_best = [&](optional<ParallelSearch> parallel) -> pair<optional<Integer>, bool> {
+        optional<Integer> best;
+        bool completed = false;
+        solve_with(p, SolveCallbacks{.solution = [&](const CurrentState & s) -> bool {
+                                         // Every reported solution improves on the last.
+                                         CHECK((! best || s(cost) < *best));
+                                         best = s(cost);
+                                         return true;
+                                     },
+                          .completed = [&]() { completed = true; },
+                          .parallel = parallel});
+        return pair{best, completed};
+    };
+
+    auto [sequential_best, sequential_completed] = solve_for_best(nullopt);
+    auto [parallel_best, parallel_completed] = solve_for_best(ParallelSearch{.threads = 4});
+    CHECK(sequential_completed);
+    CHECK(parallel_completed);
+    CHECK(parallel_best == sequential_best);
+}
+
+TEST_CASE("Parallel search stops every thread when a callback says so")
+{
+    Problem p;
+    auto queens = post_queens(p, 10);
+    unsigned long long calls = 0;
+    bool completed = false;
+    auto stats = solve_with(p, SolveCallbacks{.solution = [&](const CurrentState &) -> bool {
+                                                  ++calls;
+                                                  return false;
+                                              },
+                                   .completed = [&]() { completed = true; },
+                                   .parallel = ParallelSearch{.threads = 4}});
+    CHECK(calls == 1);
+    CHECK(stats.solutions == 1);
+    CHECK(! completed);
+}
+
+TEST_CASE("Parallel search refuses to write a proof")
+{
+    Problem p;
+    post_queens(p, 4);
+    CHECK_THROWS_AS(solve_with(p, SolveCallbacks{.parallel = ParallelSearch{.threads = 2}}, ProofOptions{"solve_test_parallel_proof"}),
+        UnimplementedException);
+}
+
+TEST_CASE("Portfolio search proves the optimum")
+{
+    Problem p;
+    auto queens = post_queens(p, 8);
+    auto cost = p.create_integer_variable(0_i, 1000_i);
+    WeightedSum sum;
+    for (int i = 0; i < 8; ++i)
+        sum += Integer{i + 1} * queens[i];
+    p.post(sum + -1_i * cost == 0_i);
+    p.minimise(cost);
+
+    auto solve_for_best = [&](optional<ParallelSearch> parallel) -> pair<optional<Integer>, bool> {
+        optional<Integer> best;
+        bool completed = false;
+        solve_with(p, SolveCallbacks{.solution = [&](const CurrentState & s) -> bool {
+                                         CHECK((! best || s(cost) < *best));
+                                         best = s(cost);
+                                         return true;
+                                     },
+                          .branch = branch_with(variable_order::dom_wdeg(p), value_order::smallest_first()),
+                          .completed = [&]() { completed = true; },
+                          .restarts = RestartSchedule::luby(1),
+                          .parallel = parallel});
+        return pair{best, completed};
+    };
+
+    auto [sequential_best, sequential_completed] = solve_for_best(nullopt);
+    auto [portfolio_best, portfolio_completed] = solve_for_best(ParallelSearch{.threads = 4, .portfolio_seed = 7});
+    CHECK(sequential_completed);
+    CHECK(portfolio_completed);
+    CHECK(portfolio_best == sequential_best);
+}
+
+TEST_CASE("Portfolio search stops a satisfaction problem when the callback says so")
+{
+    Problem p;
+    post_queens(p, 8);
+    unsigned long long calls = 0;
+    auto stats = solve_with(p, SolveCallbacks{.solution = [&](const CurrentState &) -> bool {
+                                                  ++calls;
+                                                  return false;
+                                              },
+                                   .restarts = RestartSchedule::luby(10),
+                                   .parallel = ParallelSearch{.threads = 4}});
+    CHECK(calls == 1);
+    CHECK(stats.solutions == 1);
+}
+
+// Every thread of a portfolio finds every solution, but each is reported once,
+// and the first thread to finish has seen them all.
+TEST_CASE("Portfolio search enumerates every solution exactly once")
+{
+    Problem p;
+    auto queens = post_queens(p, 8);
+    std::multiset<vector<Integer>> solutions;
+    bool completed = false;
+    auto stats = solve_with(p, SolveCallbacks{.solution = [&](const CurrentState & s) -> bool {
+                                                  solutions.insert(s(queens));
+                                                  return true;
+                                              },
+                                   .completed = [&]() { completed = true; },
+                                   .restarts = RestartSchedule::luby(10),
+                                   .parallel = ParallelSearch{.threads = 4}});
+    CHECK(completed);
+    CHECK(solutions.size() == 92);
+    CHECK(std::set<vector<Integer>>(solutions.begin(), solutions.end()).size() == 92);
+    CHECK(stats.solutions == 92);
+}
+
+TEST_CASE("Portfolio search proves unsatisfiability")
+{
+    Problem p;
+    vector<IntegerVariableID> xs;
+    for (int i = 0; i < 6; ++i)
+        xs.push_back(p.create_integer_variable(0_i, 4_i));
+    for (unsigned i = 0; i < xs.size(); ++i)
+        for (unsigned j = i + 1; j < xs.size(); ++j)
+            p.post(NotEquals{xs[i], xs[j]});
+
+    bool found_solution = false, completed = false;
+    auto stats = solve_with(p, SolveCallbacks{.solution = [&](const CurrentState &) -> bool {
+                                                  found_solution = true;
+                                                  return true;
+                                              },
+                                   .completed = [&]() { completed = true; },
+                                   .restarts = RestartSchedule::luby(1),
+                                   .parallel = ParallelSearch{.threads = 3, .portfolio_merge = WeightingState::MergePolicy::Average}});
+    CHECK(! found_solution);
+    CHECK(completed);
+    CHECK(stats.restarts > 0);
+}
+
+TEST_CASE("Portfolio search gives the same answers with and without sharing nogoods")
+{
+    Problem p;
+    auto queens = post_queens(p, 8);
+    auto cost = p.create_integer_variable(0_i, 1000_i);
+    WeightedSum sum;
+    for (int i = 0; i < 8; ++i)
+        sum += Integer{(i * 5) % 8 + 1} * queens[i];
+    p.post(sum + -1_i * cost == 0_i);
+    p.minimise(cost);
+
+    auto solve_for_best = [&](std::size_t max_shared_nogood_length) -> pair<optional<Integer>, Stats> {
+        optional<Integer> best;
+        auto stats = solve_with(p, SolveCallbacks{.solution = [&](const CurrentState & s) -> bool {
+                                                      best = s(cost);
+                                                      return true;
+                                                  },
+                                       .restarts = RestartSchedule::luby(1),
+                                       .parallel = ParallelSearch{.threads = 4, .max_shared_nogood_length = max_shared_nogood_length}});
+        return pair{best, stats};
+    };
+
+    auto [unshared_best, unshared_stats] = solve_for_best(0);
+    auto [shared_best, shared_stats] = solve_for_best(100);
+    CHECK(unshared_best.has_value());
+    CHECK(shared_best == unshared_best);
+    CHECK(unshared_stats.imported_nogoods == 0);
+    CHECK(unshared_stats.learned_nogoods > 0);
+}
+
+// Large neighbourhood search only ever reports a better solution, and an
+// exhausted neighbourhood makes the next one bigger, until one of them is the
+// whole problem. With a conflict limit big enough to search all of that, it
+// proves optimality.
+TEST_CASE("Large neighbourhood search finds and proves the optimum")
+{
+    auto which = GENERATE(0, 1, 2, 3);
+    vector<NeighbourhoodGenerator> neighbourhoods;
+    switch (which) {
+    case 0: neighbourhoods = {neighbourhood::random(1)}; break;
+    case 1: neighbourhoods = {neighbourhood::propagation_guided(2)}; break;
+    case 2: neighbourhoods = {neighbourhood::constraint_structured(3)}; break;
+    case 3: break;
+    }
+
+    Problem p;
+    auto queens = post_queens(p, 8);
+    auto cost = p.create_integer_variable(0_i, 1000_i);
+    WeightedSum sum;
+    for (int i = 0; i < 8; ++i)
+        sum += Integer{(i * 5) % 8 + 1} * queens[i];
+    p.post(sum + -1_i * cost == 0_i);
+    p.minimise(cost);
+
+    auto solve_for_best = [&](optional<LargeNeighbourhoodSearch> lns) -> pair<optional<Integer>, Stats> {
+        optional<Integer> best;
+        bool completed = false;
+        auto stats = solve_with(p, SolveCallbacks{.solution = [&](const CurrentState & s) -> bool {
+                                                      CHECK((! best || s(cost) < *best));
+                                                      best = s(cost);
+                                                      return true;
+                                                  },
+                                       .completed = [&]() { completed = true; },
+                                       .lns = lns});
+        CHECK(completed);
+        return pair{best, stats};
+    };
+
+    auto [bnb_best, bnb_stats] = solve_for_best(nullopt);
+    auto [lns_best, lns_stats] =
+        solve_for_best(LargeNeighbourhoodSearch{.neighbourhoods = neighbourhoods, .conflict_limit = 10000, .iteration_limit = 1000});
+    CHECK(lns_best == bnb_best);
+    CHECK(lns_stats.lns_iterations > 0);
+    CHECK(lns_stats.lns_improvements > 0);
+    CHECK(lns_stats.lns_exhausted_neighbourhoods > 0);
+    CHECK(bnb_stats.lns_iterations == 0);
+}
+
+TEST_CASE("Large neighbourhood search stops at its iteration limit")
+{
+    Problem p;
+    auto queens = post_queens(p, 12);
+    auto cost = p.create_integer_variable(0_i, 1000_i);
+    WeightedSum sum;
+    for (int i = 0; i < 12; ++i)
+        sum += Integer{i + 1} * queens[i];
+    p.post(sum + -1_i * cost == 0_i);
+    p.minimise(cost);
+
+    bool completed = false;
+    auto stats = solve_with(p, SolveCallbacks{.completed = [&]() { completed = true; },
+                                   .lns = LargeNeighbourhoodSearch{.fix_fraction = 0.9, .adapt_fix_fraction = false, .iteration_limit = 5}});
+    CHECK(stats.lns_iterations == 5);
+    CHECK(! completed);
+}
+
+TEST_CASE("Large neighbourhood search refuses a satisfaction problem or a proof")
+{
+    Problem p;
+    auto queens = post_queens(p, 4);
+    CHECK_THROWS_AS(solve_with(p, SolveCallbacks{.lns = LargeNeighbourhoodSearch{}}), UnimplementedException);
+    p.minimise(queens[0]);
+    CHECK_THROWS_AS(solve_with(p, SolveCallbacks{.lns = LargeNeighbourhoodSearch{}}, ProofOptions{"solve_test_lns_proof"}), UnimplementedException);
+}
+
+// A chain of four variables, and two that share no constraint with anything.
+// Whichever variable the search starts from comes last, those it cannot reach
+// come first, and the rest come furthest first.
+TEST_CASE("Constraint structured neighbourhoods fix unreachable and then further variables first")
+{
+    Problem p;
+    auto vs = p.create_integer_variable_vector(6, 0_i, 3_i);
+    for (int i = 0; i < 3; ++i)
+        p.post(NotEquals{vs[i], vs[i + 1]});
+
+    Stats stats;
+    auto state = p.create_state_for_new_search(nullptr);
+    auto propagators = p.create_propagators(state, stats, nullptr);
+    CurrentState current{state};
+    vector<IntegerVariableID> vars(vs.begin(), vs.end());
+
+    auto distance = [](int a, int b) -> optional<int> {
+        if (a == b)
+            return 0;
+        if (a < 4 && b < 4)
+            return std::abs(a - b);
+        return nullopt;
+    };
+
+    for (std::uint_fast32_t seed = 1; seed <= 8; ++seed) {
+        vector<int> order;
+        for (const auto & v : neighbourhood::constraint_structured(seed)(vars, current, current, propagators))
+            order.push_back(static_cast<int>(std::find(vars.begin(), vars.end(), v) - vars.begin()));
+        REQUIRE(order.size() == vars.size());
+        CHECK(std::set<int>(order.begin(), order.end()).size() == vars.size());
+
+        auto start = order.back();
+        optional<int> last_distance;
+        bool reached_any = false;
+        for (auto v : order) {
+            auto d = distance(start, v);
+            if (! d) {
+                CHECK(! reached_any);
+                continue;
+            }
+            CHECK((! last_distance || *d <= *last_distance));
+            reached_any = true;
+            last_distance = d;
+        }
+    }
+}
+
+// Each probe either refutes a bound, and raises the lower bound, or is cut
+// off, and gives the next one more conflicts, so however the probes are chosen
+// the search ends at the optimum that branch and bound finds.
+TEST_CASE("Objective search finds the same optimum as branch and bound")
+{
+    auto strategy = GENERATE(ObjectiveStrategy::Dichotomic, ObjectiveStrategy::LowerBounding);
+    auto with_restarts = GENERATE(false, true);
+
+    Problem p;
+    auto queens = post_queens(p, 8);
+    auto cost = p.create_integer_variable(0_i, 1000_i);
+    WeightedSum sum;
+    for (int i = 0; i < 8; ++i)
+        sum += Integer{(i * 5) % 8 + 1} * queens[i];
+    p.post(sum + -1_i * cost == 0_i);
+    p.minimise(cost);
+
+    auto solve_for_best = [&](optional<ObjectiveSearch> objective_search) -> pair<optional<Integer>, Stats> {
+        optional<Integer> best;
+        bool completed = false;
+        auto stats = solve_with(p, SolveCallbacks{.solution = [&](const CurrentState & s) -> bool {
+                                                      CHECK((! best || s(cost) < *best));
+                                                      best = s(cost);
+                                                      return true;
+                                                  },
+                                       .completed = [&]() { completed = true; },
+                                       .restarts = with_restarts ? optional{RestartSchedule::luby(1)} : nullopt,
+                                       .objective_search = objective_search});
+        CHECK(completed);
+        return pair{best, stats};
+    };
+
+    auto [bnb_best, bnb_stats] = solve_for_best(nullopt);
+    auto [probe_best, probe_stats] = solve_for_best(ObjectiveSearch{.strategy = strategy, .conflict_limit = 5});
+    CHECK(probe_best == bnb_best);
+    CHECK(probe_stats.objective_probes > 0);
+    CHECK(probe_stats.refuted_objective_probes > 0);
+    CHECK(bnb_stats.objective_probes == 0);
+}
+
+// The bound that each refuted probe proves is written to the proof and given
+// to the callback as soon as it is proved, and is what the proof concludes
+// with, whether or not search gets as far as optimality.
+TEST_CASE("Objective search proves the optimum")
+{
+    auto strategy = GENERATE(ObjectiveStrategy::Dichotomic, ObjectiveStrategy::LowerBounding);
+    const auto proof_name = strategy == ObjectiveStrategy::Dichotomic ? "solve_test_objective_search_dichotomic"
+                                                                      : "solve_test_objective_search_lower_bounding";
+
+    Problem p;
+    auto queens = post_queens(p, 6);
+    auto cost = p.create_integer_variable(0_i, 1000_i);
+    WeightedSum sum;
+    for (int i = 0; i < 6; ++i)
+        sum += Integer{i + 1} * queens[i];
+    p.post(sum + -1_i * cost == 0_i);
+    p.minimise(cost);
+
+    optional<Integer> best;
+    bool completed = false;
+    vector<Integer> bounds;
+    auto stats = solve_with(p,
+        SolveCallbacks{.solution = [&](const CurrentState & s) -> bool {
+                           best = s(cost);
+                           return true;
+                       },
+            .completed = [&]() { completed = true; },
+            .objective_bound =
+                [&](Integer bound) {
+                    CHECK((bounds.empty() || bound > bounds.back()));
+                    CHECK((! best || bound <= *best));
+                    bounds.push_back(bound);
+                },
+            .restarts = RestartSchedule::luby(1),
+            .objective_search = ObjectiveSearch{.strategy = strategy, .conflict_limit = 2}},
+        ProofOptions{proof_name});
+
+    CHECK(best.has_value());
+    CHECK(completed);
+    CHECK(stats.objective_probes > 0);
+    REQUIRE(! bounds.empty());
+    CHECK(bounds.back() == *best);
+    CHECK(verify_proof_and_dispose(proof_name));
+}
+
+TEST_CASE("Objective search refuses a satisfaction problem, parallel search, large neighbourhood search, or a limit that does not grow")
+{
+    Problem p;
+    auto queens = post_queens(p, 4);
+    CHECK_THROWS_AS(solve_with(p, SolveCallbacks{.objective_search = ObjectiveSearch{}}), UnimplementedException);
+    p.minimise(queens[0]);
+    CHECK_THROWS_AS(solve_with(p, SolveCallbacks{.parallel = ParallelSearch{.threads = 2}, .objective_search = ObjectiveSearch{}}),
+        UnimplementedException);
+    CHECK_THROWS_AS(solve_with(p, SolveCallbacks{.lns = LargeNeighbourhoodSearch{}, .objective_search = ObjectiveSearch{}}), UnimplementedException);
+    CHECK_THROWS_AS(solve_with(p, SolveCallbacks{.objective_search = ObjectiveSearch{.conflict_limit_growth = 1.0}}), UnexpectedException);
+    CHECK_THROWS_AS(solve_with(p, SolveCallbacks{.objective_search = ObjectiveSearch{.conflict_limit_growth = 0.5}}), UnexpectedException);
+}
+
+// Stopping at the first solution ends objective search before any probe, and
+// the search arena's use is still reported.
+TEST_CASE("Objective search reports the search arena however it ends")
+{
+    Problem p;
+    auto queens = post_queens(p, 8);
+    p.minimise(queens[0]);
+
+    unsigned solutions = 0;
+    auto stats = solve_with(p, SolveCallbacks{.solution = [&](const CurrentState &) -> bool {
+                                                  ++solutions;
+                                                  return false;
+                                              },
+                                   .objective_search = ObjectiveSearch{}});
+    CHECK(solutions == 1);
+    CHECK(stats.objective_probes == 0);
+    CHECK(stats.search_arena_allocations > 0);
+}
+
 // An unsatisfiable Langford-pairing instance (size 5): rich enough that
 // AllDifferent and Element prune at the root, so the root node emits
 // guess-independent propagation that later restart passes do not re-derive.
@@ -401,6 +943,78 @@ TEST_CASE("Enumerate all solutions with restarts")
     CHECK(verify_proof_and_dispose(proof_name));
 }
 
+// As "Solve unsat with restarts and binary branching", but optimising, with a
+// nogood reduction after every pass: an objective lets the reduction delete as
+// well as minimise, so the proof must survive nogood lines being deleted and
+// strengthened ones being derived, all at Top between passes.
+TEST_CASE("Reducing learned nogoods keeps the proof valid")
+{
+    const auto proof_name = "solve_test_reduce_nogoods";
+
+    Problem p;
+    vector<IntegerVariableID> xs;
+    for (int i = 0; i < 5; ++i)
+        xs.push_back(p.create_integer_variable(0_i, 3_i));
+    for (unsigned i = 0; i < xs.size(); ++i)
+        for (unsigned j = i + 1; j < xs.size(); ++j)
+            p.post(NotEquals{xs[i], xs[j]});
+    p.minimise(xs[0]);
+
+    bool found_solution = false;
+    auto stats = solve_with(p,
+        SolveCallbacks{.solution = [&](const CurrentState &) -> bool {
+                           found_solution = true;
+                           return true;
+                       },
+            .branch = branch_with(variable_order::dom(p), value_order::smallest_in()),
+            .restarts = RestartSchedule::luby(1),
+            .nogood_reduction = NogoodReduction{.limit = 1, .limit_growth = 1.0, .keep_length = 0}},
+        ProofOptions{proof_name});
+
+    CHECK(! found_solution);
+    CHECK(stats.nogood_reductions > 0);
+    CHECK(stats.deleted_nogoods > 0);
+    CHECK(stats.held_nogoods < stats.learned_nogoods);
+    CHECK(verify_proof_and_dispose(proof_name));
+}
+
+// As "Enumerate all solutions with restarts", reducing after every pass.
+// Without an objective the reduction must not delete a nogood for being
+// inactive, since that nogood may be what stops a solution being counted
+// twice, so every solution is still reported exactly once.
+TEST_CASE("Reducing learned nogoods never re-counts solutions")
+{
+    const auto proof_name = "solve_test_reduce_nogoods_enumerate";
+
+    Problem p;
+    auto a = p.create_integer_variable(1_i, 4_i);
+    auto b = p.create_integer_variable(1_i, 3_i);
+    auto c = p.create_integer_variable(1_i, 3_i);
+    auto d = p.create_integer_variable(1_i, 3_i);
+    p.post(NotEquals{a, b});
+    p.post(NotEquals{a, c});
+    p.post(NotEquals{a, d});
+    p.post(NotEquals{b, c});
+    p.post(NotEquals{b, d});
+    p.post(NotEquals{c, d});
+
+    unsigned long long callbacks = 0;
+    auto stats = solve_with(p,
+        SolveCallbacks{.solution = [&](const CurrentState &) -> bool {
+                           ++callbacks;
+                           return true;
+                       },
+            .branch = branch_with(variable_order::random(p, 1234), value_order::random_out(5678)),
+            .restarts = RestartSchedule::luby(1),
+            .nogood_reduction = NogoodReduction{.limit = 1, .limit_growth = 1.0, .keep_length = 0}},
+        ProofOptions{proof_name});
+
+    CHECK(callbacks == 6);
+    CHECK(stats.solutions == 6);
+    CHECK(stats.nogood_reductions > 0);
+    CHECK(verify_proof_and_dispose(proof_name));
+}
+
 TEST_CASE("Solve unsat optimisation presolving")
 {
     const auto proof_name = "solve_test_unsat_optimisation_presolving";
@@ -670,6 +1284,28 @@ TEST_CASE("Stats accumulates notes and forwards them as they happen")
     CHECK(captured.str() == "loud\n");
 }
 
+TEST_CASE("Adding Stats sums the counters and keeps the deepest search")
+{
+    Stats total, share;
+    total.recursions = 3;
+    total.max_depth = 7;
+    total.n_propagators = 5;
+    share.recursions = 4;
+    share.max_depth = 2;
+    share.lns_iterations = 1;
+    share.objective_probes = 2;
+    share.n_propagators = 5;
+    share.report(StatsNote{StatsLevel::Debug, "a", nullopt, "one"});
+
+    total += share;
+    CHECK(total.recursions == 7);
+    CHECK(total.max_depth == 7);
+    CHECK(total.lns_iterations == 1);
+    CHECK(total.objective_probes == 2);
+    CHECK(total.n_propagators == 5);
+    CHECK(total.notes().empty());
+}
+
 TEST_CASE("Registering the same component block twice reports it once")
 {
     // A constraint installed many times, or a presolver whose block is shared
@@ -835,3 +1471,77 @@ TEST_CASE("A constraint that is trivially unsatisfiable at install time says whi
         CHECK(render(important[0]).ends_with(" (_1)"));
     }
 }
+
+TEST_CASE("A propagation profile counts calls by constraint and by type")
+{
+    auto build = [](Problem & p) {
+        auto vs = p.create_integer_variable_vector(5, 0_i, 5_i);
+        p.post(AllDifferent{vs});
+        for (unsigned i = 0; i + 1 < vs.size(); ++i)
+            p.post(LessThan{vs[i], vs[i + 1]});
+    };
+
+    for (auto parallel : {optional<ParallelSearch>{}, optional{ParallelSearch{.threads = 3}}}) {
+        Problem p;
+        build(p);
+        auto profile = std::make_shared<PropagationProfile>();
+        auto stats = solve_with(p, SolveCallbacks{.solution = [](const CurrentState &) -> bool { return true; }, .parallel = parallel,
+                                       .propagation_profile = profile});
+
+        // One entry per posted constraint, and each of them was run.
+        REQUIRE(profile->by_constraint.size() == 5);
+        unsigned long long calls = 0;
+        for (const auto & entry : profile->by_constraint) {
+            CHECK(entry.calls > 0);
+            CHECK(entry.effectful_calls <= entry.calls);
+            calls += entry.calls;
+        }
+
+        auto types = profile->by_constraint_type();
+        CHECK(std::ranges::count(types, string{"all_different"}, &PropagationProfileEntry::constraint_type) == 1);
+        CHECK(std::ranges::count(types, string{"unknown"}, &PropagationProfileEntry::constraint_type) == 0);
+
+        // Under parallel search some propagator calls are the workers', so
+        // only the one-thread total can be checked against the stats.
+        if (! parallel)
+            CHECK(calls == stats.propagations);
+        CHECK(component_named(stats, "propagation_profile").get() == static_cast<const ComponentStats *>(profile.get()));
+
+        std::stringstream csv;
+        profile->write_csv(csv);
+        string line;
+        unsigned lines = 0;
+        while (getline(csv, line))
+            ++lines;
+        CHECK(lines == 6);
+    }
+}
+
+// Checked on the propagators themselves, since solve_with() profiles every
+// search when GCS_PROPAGATION_PROFILE is set, and that is read only once.
+TEST_CASE("Without a propagation profile, nothing is profiled")
+{
+    Problem p;
+    auto vs = p.create_integer_variable_vector(4, 0_i, 3_i);
+    p.post(AllDifferent{vs});
+
+    Stats stats;
+    auto state = p.create_state_for_new_search(nullptr);
+    auto propagators = p.create_propagators(state, stats, nullptr);
+    REQUIRE(propagators.initialise(state, nullptr));
+    REQUIRE(propagators.propagate(Literals{}, state, nullptr));
+    propagators.fill_in_constraint_stats(stats);
+    CHECK(stats.propagations > 0);
+
+    // The constraint is there, but none of its calls were counted or timed.
+    PropagationProfile profile;
+    propagators.fill_in_propagation_profile(profile);
+    REQUIRE(profile.by_constraint.size() == 1);
+    CHECK(profile.by_constraint[0].calls == 0);
+    CHECK(profile.by_constraint[0].time == std::chrono::nanoseconds{0});
+
+    if (! std::getenv("GCS_PROPAGATION_PROFILE")) {
+        auto solved = solve_with(p, SolveCallbacks{.solution = [](const CurrentState &) -> bool { return true; }});
+        CHECK(! component_named(solved, "propagation_profile"));
+    }
+}
@@ -63,6 +63,34 @@ auto Stats::set_report_handler(StatsReportCallback handler) -> void
     _handler = move(handler);
 }
 
+auto Stats::operator+=(const Stats & other) -> Stats &
+{
+    recursions += other.recursions;
+    failures += other.failures;
+    propagations += other.propagations;
+    effectful_propagations += other.effectful_propagations;
+    contradicting_propagations += other.contradicting_propagations;
+    solutions += other.solutions;
+    max_depth = std::max(max_depth, other.max_depth);
+    restarts += other.restarts;
+    learned_nogoods += other.learned_nogoods;
+    imported_nogoods += other.imported_nogoods;
+    nogood_reductions += other.nogood_reductions;
+    deleted_nogoods += other.deleted_nogoods;
+    strengthened_nogoods += other.strengthened_nogoods;
+    held_nogoods += other.held_nogoods;
+    held_nogood_literals += other.held_nogood_literals;
+    search_arena_allocations += other.search_arena_allocations;
+    search_arena_heap_allocations += other.search_arena_heap_allocations;
+    lns_iterations += other.lns_iterations;
+    lns_improvements += other.lns_improvements;
+    lns_exhausted_neighbourhoods += other.lns_exhausted_neighbourhoods;
+    objective_probes += other.objective_probes;
+    refuted_objective_probes += other.refuted_objective_probes;
+    idempotence_downgrades += other.idempotence_downgrades;
+    return *this;
+}
+
 auto Stats::components() const -> const vector<shared_ptr<const ComponentStats>> &
 {
     return _components;
@@ -84,6 +112,19 @@ auto gcs::operator<<(ostream & o, const Stats & s) -> ostream &
     o << "max depth:  " << s.max_depth << '\n';
     o << "restarts: " << s.restarts << '\n';
     o << "learned nogoods: " << s.learned_nogoods << '\n';
+    if (0 != s.imported_nogoods)
+        o << "imported nogoods: " << s.imported_nogoods << '\n';
+    if (0 != s.nogood_reductions)
+        o << "nogood reductions: " << s.nogood_reductions << " deleted " << s.deleted_nogoods << " strengthened " << s.strengthened_nogoods << '\n';
+    if (0 != s.held_nogoods)
+        o << "held nogoods: " << s.held_nogoods << " with " << s.held_nogood_literals << " literals" << '\n';
+    if (0 != s.lns_iterations)
+        o << "lns iterations: " << s.lns_iterations << " improvements " << s.lns_improvements << " exhausted " << s.lns_exhausted_neighbourhoods
+          << '\n';
+    if (0 != s.objective_probes)
+        o << "objective probes: " << s.objective_probes << " refuted " << s.refuted_objective_probes << '\n';
+    if (0 != s.search_arena_allocations)
+        o << "search arena allocations: " << s.search_arena_allocations << " with " << s.search_arena_heap_allocations << " from the heap" << '\n';
     o << "solutions: " << s.solutions << '\n';
     o << "solve time: " << (s.solve_time.count() / 1'000'000.0) << "s" << '\n';
 
@@ -240,6 +240,36 @@ namespace gcs
         unsigned long long max_depth = 0;
         unsigned long long restarts = 0;
         unsigned long long learned_nogoods = 0;
+        unsigned long long imported_nogoods = 0;
+
+        /// Reductions of the learned nogoods (see gcs::NogoodReduction), the
+        /// nogoods they deleted and strengthened, and how many nogoods, and
+        /// literals over them, were held when search ended.
+        unsigned long long nogood_reductions = 0;
+        unsigned long long deleted_nogoods = 0;
+        unsigned long long strengthened_nogoods = 0;
+        unsigned long long held_nogoods = 0;
+        unsigned long long held_nogood_literals = 0;
+
+        /// Allocations served by the search arena (see innards::SearchArena),
+        /// such as the branching heuristics' coroutine frames, and how many of
+        /// those had to go to the heap for a new block.
+        unsigned long long search_arena_allocations = 0;
+        unsigned long long search_arena_heap_allocations = 0;
+
+        /// Iterations of large neighbourhood search (see
+        /// gcs::LargeNeighbourhoodSearch), how many of them found a better
+        /// solution, and how many searched everything that was left without
+        /// finding one.
+        unsigned long long lns_iterations = 0;
+        unsigned long long lns_improvements = 0;
+        unsigned long long lns_exhausted_neighbourhoods = 0;
+
+        /// Probes of a bound on the objective (see gcs::ObjectiveSearch), and
+        /// how many of them searched everything without a better solution,
+        /// so raising the lower bound.
+        unsigned long long objective_probes = 0;
+        unsigned long long refuted_objective_probes = 0;
 
         unsigned long long n_propagators = 0;
 
@@ -281,6 +311,18 @@ namespace gcs
          */
         auto set_report_handler(StatsReportCallback) -> void;
 
+        /**
+         * \brief Add in the counters from another search over the same
+         * problem, such as another thread's share of a parallel search.
+         *
+         * Every counter is summed, except that max_depth takes the larger of
+         * the two, and n_propagators and solve_time, which describe the
+         * problem and the whole solve rather than one search's share of it,
+         * are left alone. Components and notes stay with the Stats that
+         * registered or reported them.
+         */
+        auto operator+=(const Stats &) -> Stats &;
+
         [[nodiscard]] auto components() const GCS_LIFETIME_BOUND -> const std::vector<std::shared_ptr<const ComponentStats>> &;
 
         [[nodiscard]] auto notes() const GCS_LIFETIME_BOUND -> const std::vector<StatsNote> &;
@@ -1,6 +1,7 @@
 #include <gcs/constraints/all_different.hh>
 #include <gcs/constraints/element.hh>
 #include <gcs/constraints/equals.hh>
+#include <gcs/presolvers/binary_network.hh>
 #include <gcs/problem.hh>
 #include <gcs/search_heuristics.hh>
 #include <gcs/solve.hh>
@@ -45,7 +46,8 @@ auto main(int argc, char * argv[]) -> int
             ("timeout", "Abort the solve after this many seconds (0 = no limit)",    //
                 cxxopts::value<double>()->default_value("0"))                        //
             ("restarts", "Restart on a Luby schedule with the given conflict scale", //
-                cxxopts::value<unsigned long long>()->implicit_value("100"));
+                cxxopts::value<unsigned long long>()->implicit_value("100"))         //
+            ("binary-network", "Propagate the not-equals with one fused propagator");
 
         options.add_options()("size", "Size of the problem to solve (max 12)", cxxopts::value<int>()->default_value("12"));
 
@@ -137,6 +139,9 @@ auto main(int argc, char * argv[]) -> int
         for (int j = i + 1; j < size; ++j)
             p.post(NotEquals{xs[i], xs[j]});
 
+    if (options_vars.contains("binary-network"))
+        p.add_presolver(BinaryNetwork{}.disabling_lifted_donors());
+
     WeightedSum wcosts;
     for (int i = 0; i < size; ++i) {
         for (int j = 0; j < size; ++j) {
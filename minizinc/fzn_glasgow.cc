@@ -271,7 +271,7 @@ auto main(int argc, char * argv[]) -> int
             ("all-solutions,a", "Print all solutions, or solve an optimisation problem to optimality") //
             ("intermediate,i", "Print intermediate solutions of an optimisation problem")              //
             ("free-search,f", "Ignore the model's search annotations")                                 //
-            ("parallel,p", "Number of parallel threads (accepted but ignored; search is sequential)",  //
+            ("parallel,p", "Parallel search threads (a portfolio with --restarts; not with proofs)",   //
                 cxxopts::value<unsigned long long>())                                                  //
             ("random-seed,r", "Random seed for randomised search heuristics",                          //
                 cxxopts::value<unsigned long long>())                                                  //
@@ -1073,9 +1073,14 @@ auto main(int argc, char * argv[]) -> int
         BranchHeuristic brancher = branch_sequence(branch_with(variable_order::dom_then_deg(data.branch_variables), value_order::smallest_first()),
             branch_with(variable_order::dom_then_deg(data.all_variables), value_order::smallest_first()));
 
+        // The randomised value orders share one generator between every thread's
+        // brancher, so a model that asks for one searches sequentially.
+        bool uses_random_heuristic = false;
+
         if ((! free_search) && fzn["solve"].contains("ann")) {
             function<optional<BranchHeuristic>(const nlohmann::json &)> parse_search;
-            parse_search = [&data, &parse_search, &random_seed](const nlohmann::json & ann) -> optional<BranchHeuristic> {
+            parse_search = [&data, &parse_search, &random_seed, &uses_random_heuristic](
+                               const nlohmann::json & ann) -> optional<BranchHeuristic> {
                 if (ann["id"] == "bool_search" || ann["id"] == "int_search") {
                     auto args = ann["args"];
                     vector<IntegerVariableID> vars = arg_as_array_of_var(data, args, 0);
@@ -1112,10 +1117,14 @@ auto main(int argc, char * argv[]) -> int
                         val = value_order::smallest_out();
                     else if (val_heuristic == "indomain_split")
                         val = value_order::split_smallest_first();
-                    else if (val_heuristic == "indomain_split_random")
+                    else if (val_heuristic == "indomain_split_random") {
                         val = random_seed ? value_order::split_random(*random_seed) : value_order::split_random();
-                    else if (val_heuristic == "indomain_random")
+                        uses_random_heuristic = true;
+                    }
+                    else if (val_heuristic == "indomain_random") {
                         val = random_seed ? value_order::random(*random_seed) : value_order::random();
+                        uses_random_heuristic = true;
+                    }
                     else {
                         println(cerr, "Warning: treating unknown int_search value heuristic {} as indomain instead", val_heuristic);
                         val = value_order::smallest_first();
@@ -1177,6 +1186,20 @@ auto main(int argc, char * argv[]) -> int
                 restart_schedule = RestartSchedule::luby(scale);
         }
 
+        optional<ParallelSearch> parallel;
+        if (options_vars.contains("parallel")) {
+            auto threads = options_vars["parallel"].as<unsigned long long>();
+            if (threads > 1) {
+                // With restarts each thread searches everything in a portfolio,
+                // and only the first uses the model's own search annotation, so a
+                // random one is safe there.
+                if (proof_options || (uses_random_heuristic && ! restart_schedule))
+                    println(cerr, "warning: --parallel is ignored with --prove, or with a random search annotation and no --restarts");
+                else
+                    parallel = ParallelSearch{.threads = static_cast<unsigned>(threads), .portfolio_seed = random_seed.value_or(0)};
+            }
+        }
+
         bool completed = false, any_solution = false;
         auto stats = solve_with(problem, //
             SolveCallbacks{              //
@@ -1229,7 +1252,8 @@ auto main(int argc, char * argv[]) -> int
                 },
                 .branch = brancher,
                 .completed = [&] { completed = true; },
-                .restarts = restart_schedule},
+                .restarts = restart_schedule,
+                .parallel = parallel},
             proof_options, &abort_flag);
 
         if (timeout_thread.joinable()) {
@@ -0,0 +1,72 @@
+#!/bin/bash
+#
+# Usage: proof_writer_bench.bash [runs]
+#
+# Times proof writing with the synchronous and the asynchronous proof writer
+# (GCS_PROOF_WRITER=sync and async) on the group B instances of
+# dev_docs/proof-benchmarks.md, which are the ones where emission cost
+# dominates. Reports the minimum wall time over the given number of runs
+# (three by default) for each, and checks that both writers produce a
+# byte-identical .pbp: anything else is a bug, not a performance difference.
+#
+# This is a developer tool for proof-writing changes; it is not a ctest.
+
+set -u
+
+root=$(cd "$(dirname "$0")/.." && pwd)
+build=$root/build
+runs=${1:-3}
+
+work=$(mktemp -d)
+trap 'rm -rf "$work"' EXIT
+
+benchmarks=(
+    "polynomial10;random_polynomial -n 10 -d 5 --seed 1 --stats"
+    "nfractions;n_fractions --unsat --stats"
+    "knapsack2;knapsack_bench --instance 2 --stats"
+)
+
+# Minimum wall time, in seconds, over $runs runs of one writer.
+time_writer()
+{
+    local writer=$1 name=$2
+    shift 2
+    local best="" t
+    for (( i = 0 ; i < runs ; ++i )) ; do
+        rm -f "$work/$name-$writer".*
+        t=$( { /usr/bin/time -f %e env GCS_PROOF_WRITER="$writer" "$@" \
+            --prove --proof-files-basename "$work/$name-$writer" >/dev/null 2>/dev/null ; } 2>&1 ) || return 1
+        if [[ -z $best ]] || (( $(echo "$t < $best" | bc) )) ; then
+            best=$t
+        fi
+    done
+    echo "$best"
+}
+
+status=0
+printf "%-14s %10s %10s %10s  %s\n" benchmark sync async ratio pbp
+for entry in "${benchmarks[@]}" ; do
+    name=${entry%%;*}
+    read -r -a argv <<< "${entry#*;}"
+    argv[0]=$build/${argv[0]}
+    if [[ ! -x ${argv[0]} ]] ; then
+        echo "skip: $name (${argv[0]} not built)" >&2
+        continue
+    fi
+
+    if ! sync=$(time_writer sync "$name" "${argv[@]}") || ! async=$(time_writer async "$name" "${argv[@]}") ; then
+        echo "fail: $name did not run" >&2
+        status=1
+        continue
+    fi
+
+    if cmp -s "$work/$name-sync.pbp" "$work/$name-async.pbp" ; then
+        same="identical"
+    else
+        same="DIFFERENT"
+        status=1
+    fi
+    printf "%-14s %9ss %9ss %10s  %s\n" "$name" "$sync" "$async" "$(echo "scale=2; $sync / $async" | bc)" "$same"
+done
+
+exit $status
@@ -1857,9 +1857,9 @@ namespace
     }
 
     // Build the brancher named by --branch: "dom-then-deg" (the default, over
-    // all variables, as solve_with would otherwise pick), or "dom-wdeg" (the
+    // all variables, as solve_with would otherwise pick), "dom-wdeg" (the
     // library default scheme) optionally suffixed with a scheme, e.g.
-    // "dom-wdeg:classic".
+    // "dom-wdeg:classic", or "activity" or "impact".
     auto brancher_from_string(const string & spec, const Problem & problem) -> optional<BranchHeuristic>
     {
         if (spec == "dom-then-deg")
@@ -1872,6 +1872,10 @@ namespace
                 return nullopt;
             return branch_with(variable_order::dom_wdeg(problem, *scheme), value_order::smallest_first());
         }
+        if (spec == "activity")
+            return branch_with(variable_order::activity(problem), value_order::smallest_first());
+        if (spec == "impact")
+            return branch_with(variable_order::impact(problem), value_order::smallest_first());
         return nullopt;
     }
 }
@@ -1888,8 +1892,9 @@ auto main(int argc, char * argv[]) -> int
                 cxxopts::value<string>()->default_value("xcsp"))             //
             ("all", "Find all solutions")                                    //
             ("branch",
-                "Branching heuristic: dom-then-deg, or dom-wdeg[:VARIANT] "          //
-                "(VARIANT one of classic, ia, ca, id, cd, ca.cd, chs)",              //
+                "Branching heuristic: dom-then-deg, dom-wdeg[:VARIANT] "             //
+                "(VARIANT one of classic, ia, ca, id, cd, ca.cd, chs), activity, "   //
+                "or impact",                                                         //
                 cxxopts::value<string>()->default_value("dom-then-deg"))             //
             ("restarts", "Restart on a Luby schedule with the given conflict scale", //
                 cxxopts::value<unsigned long long>()->implicit_value("100"))         //